@@ -27,7 +27,11 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "Core/API/Shader.h"
+#include "Core/Program/ShaderCache.h"
 #include <slang/slang.h>
+#include <d3dcompiler.h>
+
+#pragma comment(lib, "d3dcompiler.lib")
 
 namespace Falcor
 {
@@ -45,8 +49,21 @@ namespace Falcor
     {
     }
 
-    bool Shader::init(ComPtr<slang::IComponentType> slangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log)
+    bool Shader::init(ComPtr<slang::IComponentType> slangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log, const SHA1::MD* pCacheKey)
     {
+        // Try to load the kernel from the persistent shader cache.
+        if (pCacheKey)
+        {
+            std::vector<uint8_t> data;
+            ID3DBlobPtr pBlob;
+            if (ShaderCache::read(*pCacheKey, data) && SUCCEEDED(D3DCreateBlob(data.size(), &pBlob)))
+            {
+                std::memcpy(pBlob->GetBufferPointer(), data.data(), data.size());
+                mpPrivateData->pBlob = pBlob;
+                return true;
+            }
+        }
+
         // Compile the shader kernel.
         ComPtr<slang::IBlob> pSlangDiagnostics;
         ComPtr<slang::IBlob> pShaderBlob;
@@ -63,6 +80,7 @@ namespace Falcor
         if (succeeded)
         {
             mpPrivateData->pBlob = pShaderBlob.get();
+            if (pCacheKey) ShaderCache::write(*pCacheKey, pShaderBlob->getBufferPointer(), pShaderBlob->getBufferSize());
         }
         return succeeded;
     }
@@ -402,6 +402,7 @@ namespace Falcor
 
     protected:
         friend class VariablesBufferUI;
+        friend class ShaderConstantWriter;
 
         ParameterBlock(
             const std::shared_ptr<const ProgramVersion>& pProgramVersion,
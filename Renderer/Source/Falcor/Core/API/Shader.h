@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Core/Framework.h"
+#include "Utils/CryptoUtils.h"
 #include <map>
 #include <initializer_list>
 
@@ -257,13 +258,14 @@ namespace Falcor
             \param[in] linkedSlangEntryPoint The Slang IComponentType that defines the shader entry point.
             \param[in] type The Type of the shader
             \param[out] log This string will contain the error log message in case shader compilation failed
+            \param[in] pCacheKey Optional. Key identifying the kernel in the persistent shader cache (see `ShaderCache`). If nullptr, the cache is bypassed.
             \return If success, a new shader object, otherwise nullptr
         */
-        static SharedPtr create(ComPtr<slang::IComponentType> linkedSlangEntryPoint, ShaderType type, std::string const&  entryPointName, CompilerFlags flags, std::string& log)
+        static SharedPtr create(ComPtr<slang::IComponentType> linkedSlangEntryPoint, ShaderType type, std::string const&  entryPointName, CompilerFlags flags, std::string& log, const SHA1::MD* pCacheKey = nullptr)
         {
             SharedPtr pShader = SharedPtr(new Shader(type));
             pShader->mEntryPointName = entryPointName;
-            return pShader->init(linkedSlangEntryPoint, entryPointName, flags, log) ? pShader : nullptr;
+            return pShader->init(linkedSlangEntryPoint, entryPointName, flags, log, pCacheKey) ? pShader : nullptr;
         }
 
         virtual ~Shader();
@@ -287,7 +289,7 @@ namespace Falcor
 
     protected:
         // API handle depends on the shader Type, so it stored be stored as part of the private data
-        bool init(ComPtr<slang::IComponentType> linkedSlangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log);
+        bool init(ComPtr<slang::IComponentType> linkedSlangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log, const SHA1::MD* pCacheKey);
         Shader(ShaderType Type);
         ShaderType mType;
         std::string mEntryPointName;
@@ -26,6 +26,8 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "stdafx.h"
+#include <sys/resource.h>
+#include <fstream>
 // #include "Utils/StringUtils.h"
 // #include "Utils/Platform/OS.h"
 // #include "Utils/Logger.h"
@@ -437,6 +439,26 @@ namespace Falcor
         return s.st_mtime;
     }
 
+    uint64_t getProcessResidentMemory()
+    {
+        // The resident set size is reported in kB by /proc/self/status.
+        std::ifstream fs("/proc/self/status");
+        std::string line;
+        while (std::getline(fs, line))
+        {
+            if (line.compare(0, 6, "VmRSS:") == 0) return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+        }
+        return 0;
+    }
+
+    uint64_t getProcessPeakResidentMemory()
+    {
+        // ru_maxrss is reported in kB on Linux.
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+        return (uint64_t)usage.ru_maxrss * 1024;
+    }
+
     uint32_t bitScanReverse(uint32_t a)
     {
         // __builtin_clz counts 0's from the MSB, convert to index from the LSB
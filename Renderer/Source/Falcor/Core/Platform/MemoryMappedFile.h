@@ -0,0 +1,69 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <filesystem>
+
+namespace Falcor
+{
+    /** Read-only memory mapping of a whole file.
+        The mapping is released when the object is destroyed or close() is called.
+    */
+    class FALCOR_API MemoryMappedFile
+    {
+    public:
+        MemoryMappedFile() = default;
+        ~MemoryMappedFile() { close(); }
+
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+        /** Map a file into memory, closing any previously mapped file.
+            \param[in] path The path of the file to map.
+            \return true if the file was mapped, otherwise false.
+        */
+        bool open(const std::filesystem::path& path);
+
+        /** Unmap the file.
+        */
+        void close();
+
+        bool isOpen() const { return mpData != nullptr; }
+
+        /** Returns a pointer to the first byte of the file, or nullptr if no file is mapped.
+        */
+        const uint8_t* getData() const { return static_cast<const uint8_t*>(mpData); }
+
+        /** Returns the size of the mapped file in bytes.
+        */
+        size_t getSize() const { return mSize; }
+
+    private:
+        void* mpData = nullptr;
+        size_t mSize = 0;
+    };
+}
@@ -358,6 +358,14 @@ namespace Falcor
     */
     FALCOR_API uint64_t  getProcessUsedVirtualMemory();
 
+    /** Get the physical memory currently used by this process (working set / resident set size) in bytes.
+    */
+    FALCOR_API uint64_t getProcessResidentMemory();
+
+    /** Get the peak physical memory used by this process since it started (peak working set / resident set size) in bytes.
+    */
+    FALCOR_API uint64_t getProcessPeakResidentMemory();
+
     /** Returns index of most significant set bit, or 0 if no bits were set.
     */
     FALCOR_API uint32_t bitScanReverse(uint32_t a);
@@ -732,6 +732,20 @@ namespace Falcor
         return virtualMemUsedByMe;
     }
 
+    uint64_t getProcessResidentMemory()
+    {
+        PROCESS_MEMORY_COUNTERS pmc;
+        GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+        return pmc.WorkingSetSize;
+    }
+
+    uint64_t getProcessPeakResidentMemory()
+    {
+        PROCESS_MEMORY_COUNTERS pmc;
+        GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+        return pmc.PeakWorkingSetSize;
+    }
+
     uint32_t bitScanReverse(uint32_t a)
     {
         unsigned long index;
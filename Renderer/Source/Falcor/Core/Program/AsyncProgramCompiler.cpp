@@ -0,0 +1,262 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "AsyncProgramCompiler.h"
+#include <charconv>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Header line of prewarm list files.
+            This needs to be changed every time the file format changes!
+        */
+        const std::string kPrewarmListHeader = "# Falcor shader prewarm list v1";
+
+        /** Split a line into tab separated fields.
+        */
+        std::vector<std::string> splitFields(const std::string& line)
+        {
+            std::vector<std::string> fields;
+            size_t start = 0;
+            while (true)
+            {
+                size_t end = line.find('\t', start);
+                fields.push_back(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+                if (end == std::string::npos) break;
+                start = end + 1;
+            }
+            return fields;
+        }
+
+        /** Parse an unsigned integer field. Returns false if the field is not a valid number.
+        */
+        bool parseUint(const std::string& field, uint32_t& value)
+        {
+            auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+            return ec == std::errc() && ptr == field.data() + field.size() && !field.empty();
+        }
+    }
+
+    AsyncProgramCompiler::SharedPtr AsyncProgramCompiler::create(size_t threadCount)
+    {
+        return SharedPtr(new AsyncProgramCompiler(std::max<size_t>(threadCount, 1)));
+    }
+
+    AsyncProgramCompiler::AsyncProgramCompiler(size_t threadCount)
+    {
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            mThreads.emplace_back(&AsyncProgramCompiler::runWorker, this);
+        }
+    }
+
+    AsyncProgramCompiler::~AsyncProgramCompiler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+
+        mCondition.notify_all();
+
+        for (auto& thread : mThreads) thread.join();
+    }
+
+    void AsyncProgramCompiler::enqueue(std::function<void()> job)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobQueue.push(std::move(job));
+        mCondition.notify_one();
+    }
+
+    void AsyncProgramCompiler::waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mIdleCondition.wait(lock, [&]() { return mJobQueue.empty() && mRunningCount == 0; });
+    }
+
+    size_t AsyncProgramCompiler::getPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mJobQueue.size() + mRunningCount;
+    }
+
+    void AsyncProgramCompiler::runWorker()
+    {
+        // This function is the entry point for worker threads.
+        // The workers wait on the job queue and run a job when woken up.
+
+        while (true)
+        {
+            // Wait on condition until more work is ready.
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mTerminate || !mJobQueue.empty(); });
+
+            // Terminate thread unless there is more work to do.
+            if (mJobQueue.empty())
+            {
+                if (mTerminate) break;
+                continue;
+            }
+
+            auto job = std::move(mJobQueue.front());
+            mJobQueue.pop();
+            mRunningCount++;
+
+            lock.unlock();
+
+            // Run the job (this part is running in parallel).
+            // The job is released before re-entering the critical section, as it may hold the last reference to a program.
+            job();
+            job = nullptr;
+
+            lock.lock();
+            if (--mRunningCount == 0 && mJobQueue.empty()) mIdleCondition.notify_all();
+        }
+    }
+
+    void AsyncProgramCompiler::setRecordingEnabled(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRecordingEnabled = enabled;
+    }
+
+    bool AsyncProgramCompiler::isRecordingEnabled() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mRecordingEnabled;
+    }
+
+    void AsyncProgramCompiler::record(const PrewarmEntry& entry)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mRecordingEnabled) mPrewarmList.insert(entry);
+    }
+
+    std::vector<AsyncProgramCompiler::PrewarmEntry> AsyncProgramCompiler::getPrewarmEntries(const std::string& program) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::vector<PrewarmEntry> entries;
+        // Entries are sorted by program first, so all matching entries are consecutive.
+        auto it = mPrewarmList.lower_bound(PrewarmEntry{ program });
+        for (; it != mPrewarmList.end() && it->program == program; ++it) entries.push_back(*it);
+        return entries;
+    }
+
+    size_t AsyncProgramCompiler::getPrewarmEntryCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mPrewarmList.size();
+    }
+
+    bool AsyncProgramCompiler::loadPrewarmList(const std::filesystem::path& path)
+    {
+        std::ifstream fs(path);
+        std::string line;
+        if (!std::getline(fs, line) || line != kPrewarmListHeader)
+        {
+            logWarning("Failed to load shader prewarm list from '{}'.", path);
+            return false;
+        }
+
+        std::vector<PrewarmEntry> entries;
+        PrewarmEntry entry;
+        bool inEntry = false;
+        uint32_t lineNumber = 1;
+        while (std::getline(fs, line))
+        {
+            lineNumber++;
+            if (line.empty()) continue;
+
+            auto fields = splitFields(line);
+            bool valid = true;
+            if (fields[0] == "program" && fields.size() == 2 && !inEntry)
+            {
+                entry = PrewarmEntry{ fields[1] };
+                inEntry = true;
+            }
+            else if (fields[0] == "define" && fields.size() == 3 && inEntry)
+            {
+                entry.defines.add(fields[1], fields[2]);
+            }
+            else if (fields[0] == "conformance" && fields.size() == 4 && inEntry)
+            {
+                // The list is only an optimization, so a bad conformance ID just skips the line.
+                uint32_t id = 0;
+                if (parseUint(fields[3], id)) entry.typeConformances.add(fields[1], fields[2], id);
+                else logWarning("Ignoring invalid type conformance ID '{}' in shader prewarm list '{}' (line {}).", fields[3], path, lineNumber);
+            }
+            else if (fields[0] == "end" && fields.size() == 1 && inEntry)
+            {
+                entries.push_back(std::move(entry));
+                inEntry = false;
+            }
+            else
+            {
+                valid = false;
+            }
+
+            if (!valid)
+            {
+                logWarning("Invalid shader prewarm list '{}' (line {}).", path, lineNumber);
+                return false;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPrewarmList.insert(entries.begin(), entries.end());
+        logInfo("Loaded {} entries from shader prewarm list '{}'.", entries.size(), path);
+        return true;
+    }
+
+    bool AsyncProgramCompiler::savePrewarmList(const std::filesystem::path& path) const
+    {
+        std::ofstream fs(path, std::ios_base::trunc);
+        if (!fs)
+        {
+            logWarning("Failed to write shader prewarm list to '{}'.", path);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        fs << kPrewarmListHeader << "\n";
+        for (const auto& entry : mPrewarmList)
+        {
+            fs << "program\t" << entry.program << "\n";
+            for (const auto& [name, value] : entry.defines) fs << "define\t" << name << "\t" << value << "\n";
+            for (const auto& [conformance, id] : entry.typeConformances)
+            {
+                fs << "conformance\t" << conformance.mTypeName << "\t" << conformance.mInterfaceName << "\t" << id << "\n";
+            }
+            fs << "end\n";
+        }
+        return fs.good();
+    }
+}
@@ -0,0 +1,147 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/API/Shader.h"
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace Falcor
+{
+    /** Worker pool compiling program versions in the background.
+
+        Programs submit their compilation jobs through `Program::requestVersion()` once a compiler is
+        installed with `Program::setAsyncCompiler()`. Independent program versions compile in parallel,
+        each worker uses its own Slang global session.
+
+        The compiler also maintains a prewarm list: a recorded set of (program, defines, type conformances)
+        tuples that were compiled in a previous session. When a program is created, all recorded versions
+        for it are queued for compilation, so they are ready by the time they are first used.
+    */
+    class FALCOR_API AsyncProgramCompiler
+    {
+    public:
+        using SharedPtr = std::shared_ptr<AsyncProgramCompiler>;
+        using DefineList = Shader::DefineList;
+        using TypeConformanceList = Shader::TypeConformanceList;
+
+        struct PrewarmEntry
+        {
+            std::string program;                    ///< Program description string identifying the program.
+            DefineList defines;                     ///< Macro definitions of the version.
+            TypeConformanceList typeConformances;   ///< Type conformances linked into the kernels.
+
+            bool operator<(const PrewarmEntry& other) const
+            {
+                return std::tie(program, defines, typeConformances) < std::tie(other.program, other.defines, other.typeConformances);
+            }
+        };
+
+        /** Create a compiler.
+            \param[in] threadCount Number of worker threads.
+        */
+        static SharedPtr create(size_t threadCount = std::thread::hardware_concurrency());
+
+        /** Destructor.
+            Blocks until all queued jobs have finished.
+        */
+        ~AsyncProgramCompiler();
+
+        /** Queue a job for execution on a worker thread.
+        */
+        void enqueue(std::function<void()> job);
+
+        /** Block until all queued jobs have finished.
+        */
+        void waitIdle();
+
+        /** Get the number of jobs that are queued or running.
+        */
+        size_t getPendingCount() const;
+
+        /** Get the number of worker threads.
+        */
+        size_t getThreadCount() const { return mThreads.size(); }
+
+        /** Enable/disable recording of compiled program versions into the prewarm list.
+        */
+        void setRecordingEnabled(bool enabled);
+
+        /** Check if recording is enabled.
+        */
+        bool isRecordingEnabled() const;
+
+        /** Record a compiled program version. Ignored if recording is disabled.
+        */
+        void record(const PrewarmEntry& entry);
+
+        /** Get all prewarm entries for a program.
+            \param[in] program Program description string.
+        */
+        std::vector<PrewarmEntry> getPrewarmEntries(const std::string& program) const;
+
+        /** Get the number of entries in the prewarm list.
+        */
+        size_t getPrewarmEntryCount() const;
+
+        /** Load a prewarm list. Entries are added to the current list.
+            \param[in] path File path.
+            \return Returns true if successful.
+        */
+        bool loadPrewarmList(const std::filesystem::path& path);
+
+        /** Save the prewarm list.
+            \param[in] path File path.
+            \return Returns true if successful.
+        */
+        bool savePrewarmList(const std::filesystem::path& path) const;
+
+    private:
+        AsyncProgramCompiler(size_t threadCount);
+
+        void runWorker();
+
+        mutable std::mutex mMutex;                  ///< Mutex for synchronizing access to shared state.
+        std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
+        std::condition_variable mIdleCondition;     ///< Condition variable signaled when all jobs finished.
+        std::vector<std::thread> mThreads;          ///< Worker threads.
+
+        // Internal state. Do not access outside of critical section.
+        std::queue<std::function<void()>> mJobQueue;
+        size_t mRunningCount = 0;
+        bool mTerminate = false;
+        bool mRecordingEnabled = false;
+        std::set<PrewarmEntry> mPrewarmList;
+    };
+}
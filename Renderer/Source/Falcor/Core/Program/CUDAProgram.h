@@ -79,6 +79,9 @@ namespace Falcor
             std::string& log,
             const std::string& name = "") const override;
 
+        // CUDA modules are loaded into the context current on the calling thread.
+        virtual bool supportsAsyncCompilation() const override { return false; }
+
     private:
         CUDAProgram(const Desc& desc, const DefineList& programDefines);
     };
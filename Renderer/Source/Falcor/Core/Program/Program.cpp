@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "Program.h"
+#include "ShaderCache.h"
 #include "Utils/StringUtils.h"
 #include <slang/slang.h>
 
@@ -39,8 +40,48 @@ namespace Falcor
     };
 
     static Program::DefineList sGlobalDefineList;
+    static std::mutex sGlobalDefineListMutex;   // Guards sGlobalDefineList. Compilation uses a copy, as it may run on worker threads.
     static bool sGenerateDebugInfo;
 
+    /** Specifies the layout of the shader cache keys.
+        This needs to be incremented every time the set of inputs hashed into the keys changes!
+    */
+    static const uint32_t kShaderCacheKeyVersion = 1;
+
+    static Program::DefineList getGlobalDefineList()
+    {
+        std::lock_guard<std::mutex> lock(sGlobalDefineListMutex);
+        return sGlobalDefineList;
+    }
+
+    static void hashString(SHA1& sha1, const std::string& str)
+    {
+        uint64_t length = str.size();
+        sha1.update(&length, sizeof(length));
+        sha1.update(str.data(), str.size());
+    }
+
+    static void hashDefineList(SHA1& sha1, const Program::DefineList& defineList)
+    {
+        for (const auto& [name, value] : defineList)
+        {
+            hashString(sha1, name);
+            hashString(sha1, value);
+        }
+        hashString(sha1, "");
+    }
+
+    static void hashTypeConformances(SHA1& sha1, const Program::TypeConformanceList& typeConformances)
+    {
+        for (const auto& [conformance, id] : typeConformances)
+        {
+            hashString(sha1, conformance.mTypeName);
+            hashString(sha1, conformance.mInterfaceName);
+            sha1.update(&id, sizeof(id));
+        }
+        hashString(sha1, "");
+    }
+
     Program::Desc::Desc() = default;
 
     Program::Desc::Desc(const std::filesystem::path& path)
@@ -163,10 +204,13 @@ namespace Falcor
     // Program
     std::vector<std::weak_ptr<Program>> Program::sProgramsForReload;
     Program::CompilationStats Program::sCompilationStats;
+    std::mutex Program::sCompilationStatsMutex;
+    AsyncProgramCompiler::SharedPtr Program::sAsyncCompiler;
 
     void Program::registerProgramForReload(const SharedPtr& pProg)
     {
         sProgramsForReload.push_back(pProg);
+        if (sAsyncCompiler) pProg->prewarm();
     }
 
     Program::Program(Desc const& desc, DefineList const& defineList)
@@ -232,6 +276,49 @@ namespace Falcor
         return desc;
     }
 
+    SHA1::MD Program::computeShaderCacheKey(const DefineList& globalDefineList, const DefineList& defineList, std::vector<std::string> dependencyFiles) const
+    {
+        SHA1 sha1;
+        sha1.update(&kShaderCacheKeyVersion, sizeof(kShaderCacheKeyVersion));
+        hashString(sha1, spGetBuildTagString());
+
+        // Hash the contents of all transitively included files. Slang reports the dependencies
+        // in include order, sort them to make the key independent of the traversal order.
+        std::sort(dependencyFiles.begin(), dependencyFiles.end());
+        for (const auto& path : dependencyFiles)
+        {
+            hashString(sha1, path);
+            auto fileHash = ShaderCache::hashFile(path);
+            sha1.update(fileHash.data(), fileHash.size());
+        }
+
+        // Hash the program description. Sources from files are covered by the dependency list above.
+        for (const auto& src : mDesc.mSources)
+        {
+            hashString(sha1, src.type == Desc::Source::Type::File ? src.pLibrary->getPath().string() : src.str);
+        }
+        for (const auto& entryPoint : mDesc.mEntryPoints)
+        {
+            hashString(sha1, entryPoint.name);
+            hashString(sha1, entryPoint.exportName);
+            sha1.update(&entryPoint.stage, sizeof(entryPoint.stage));
+            sha1.update(&entryPoint.sourceIndex, sizeof(entryPoint.sourceIndex));
+            sha1.update(&entryPoint.groupIndex, sizeof(entryPoint.groupIndex));
+        }
+        for (const auto& group : mDesc.mGroups) hashString(sha1, group.nameSuffix);
+
+        // Hash the compiler configuration.
+        hashDefineList(sha1, globalDefineList);
+        hashDefineList(sha1, defineList);
+        hashString(sha1, mDesc.mShaderModel);
+        auto flags = mDesc.getCompilerFlags();
+        sha1.update(&flags, sizeof(flags));
+        for (const auto& arg : mDesc.getCompilerArguments()) hashString(sha1, arg);
+        sha1.update(&sGenerateDebugInfo, sizeof(sGenerateDebugInfo));
+
+        return sha1.final();
+    }
+
     bool Program::addDefine(const std::string& name, const std::string& value)
     {
         // Make sure that it doesn't exist already
@@ -374,9 +461,21 @@ namespace Falcor
 
     const ProgramVersion::SharedConstPtr& Program::getActiveVersion() const
     {
+        if (!mPendingVersions.empty()) collectPendingVersions();
+
         if (mLinkRequired)
         {
-            const auto& it = mProgramVersions.find(mDefineList);
+            auto it = mProgramVersions.find(mDefineList);
+
+            // If the version is being compiled in the background, wait for it instead of compiling it again.
+            auto pendingIt = mPendingVersions.find(mDefineList);
+            if (it == mProgramVersions.end() && pendingIt != mPendingVersions.end())
+            {
+                pendingIt->second.wait();
+                collectPendingVersions();
+                it = mProgramVersions.find(mDefineList);
+            }
+
             if (it == mProgramVersions.end())
             {
                 // Note that link() updates mActiveProgram only if the operation was successful.
@@ -400,19 +499,26 @@ namespace Falcor
         return mpActiveVersion;
     }
 
-    slang::IGlobalSession* createSlangGlobalSession()
+    ComPtr<slang::IGlobalSession> createSlangGlobalSession()
     {
-        slang::IGlobalSession* result = nullptr;
-        slang::createGlobalSession(&result);
+        ComPtr<slang::IGlobalSession> result;
+        slang::createGlobalSession(result.writeRef());
         return result;
     }
 
     slang::IGlobalSession* getSlangGlobalSession()
     {
-        static slang::IGlobalSession* pSlangGlobalSession = createSlangGlobalSession();
+        // Each thread uses its own session, which is released when the thread exits.
+        static thread_local ComPtr<slang::IGlobalSession> pSlangGlobalSession = createSlangGlobalSession();
         return pSlangGlobalSession;
     }
 
+    const std::shared_ptr<std::recursive_mutex>& getSlangGlobalSessionMutex()
+    {
+        static thread_local std::shared_ptr<std::recursive_mutex> pMutex = std::make_shared<std::recursive_mutex>();
+        return pMutex;
+    }
+
     // Translation a Falcor `ShaderType` to the corresponding `SlangStage`
     SlangStage getSlangStage(ShaderType type)
     {
@@ -466,6 +572,7 @@ namespace Falcor
     }
 
     SlangCompileRequest* Program::createSlangCompileRequest(
+        const DefineList& globalDefineList,
         const DefineList& defineList) const
     {
         slang::IGlobalSession* pSlangGlobalSession = getSlangGlobalSession();
@@ -531,13 +638,13 @@ namespace Falcor
         };
 
         // Add global defines.
-        for (const auto& shaderDefine : sGlobalDefineList)
+        for (const auto& shaderDefine : globalDefineList)
         {
             addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
         }
 
         // Add program specific defines.
-        for (const auto& shaderDefine : getDefineList())
+        for (const auto& shaderDefine : defineList)
         {
             addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
         }
@@ -567,8 +674,6 @@ namespace Falcor
             pSlangSession.writeRef());
         FALCOR_ASSERT(pSlangSession);
 
-        mFileTimeMap.clear();
-
         SlangCompileRequest* pSlangRequest = nullptr;
         pSlangSession->createCompileRequest(
             &pSlangRequest);
@@ -708,9 +813,10 @@ namespace Falcor
     }
 
     ProgramKernels::SharedPtr Program::preprocessAndCreateProgramKernels(
-        ProgramVersion const* pVersion,
-        ProgramVars    const* pVars,
-        std::string         & log) const
+        ProgramVersion      const* pVersion,
+        ProgramVars         const* pVars,
+        TypeConformanceList const& typeConformanceList,
+        std::string              & log) const
     {
         CpuTimer timer;
         timer.update();
@@ -724,7 +830,7 @@ namespace Falcor
         // parameters here, using the global `ProgramVars`.
         //
         ParameterBlock::SpecializationArgs specializationArgs;
-        pVars->collectSpecializationArgs(specializationArgs);
+        if (pVars) pVars->collectSpecializationArgs(specializationArgs);
 
         // Next we instruct Slang to specialize the global scope based on
         // the global specialization arguments.
@@ -794,7 +900,7 @@ namespace Falcor
         typeConformancesCompositeComponents.reserve(getEntryPointGroupCount());
         for (const auto& group : mDesc.mGroups)
         {
-            TypeConformanceList typeConformances = mTypeConformanceList;
+            TypeConformanceList typeConformances = typeConformanceList;
             typeConformances.add(group.typeConformances);
             typeConformancesCompositeComponents.emplace_back(createTypeConformanceComponentList(typeConformances));
         }
@@ -919,6 +1025,13 @@ namespace Falcor
         ProgramReflection::SharedPtr pReflector;
         doSlangReflection(pVersion, pSpecializedSlangProgram, pLinkedEntryPoints, pReflector, log);
 
+        // Kernels can only be loaded from the persistent shader cache if they don't depend on
+        // global specialization arguments, as those are not part of the cache key.
+        bool useShaderCache = pVersion->mShaderCacheKey.has_value();
+#ifdef FALCOR_D3D12
+        useShaderCache = useShaderCache && specializationArgs.empty();
+#endif
+
         // Create Shader objects for each entry point and cache them here.
         std::vector<Shader::SharedPtr> allShaders;
         for (uint32_t i = 0; i < allEntryPointCount; i++)
@@ -926,7 +1039,22 @@ namespace Falcor
             auto pLinkedEntryPoint = pLinkedEntryPoints[i];
             auto entryPointDesc = mDesc.mEntryPoints[i];
 
-            Shader::SharedPtr shader = Shader::create(pLinkedEntryPoint, entryPointDesc.stage, entryPointDesc.exportName, mDesc.getCompilerFlags(), log);
+            // The kernel key extends the version key with the type conformances linked into the entry point.
+            std::optional<SHA1::MD> shaderCacheKey;
+            if (useShaderCache)
+            {
+                SHA1 sha1;
+                sha1.update(pVersion->mShaderCacheKey->data(), pVersion->mShaderCacheKey->size());
+                TypeConformanceList typeConformances = typeConformanceList;
+                typeConformances.add(mDesc.mGroups[entryPointDesc.groupIndex].typeConformances);
+                hashTypeConformances(sha1, typeConformances);
+                hashString(sha1, entryPointDesc.name);
+                hashString(sha1, entryPointDesc.exportName);
+                sha1.update(&entryPointDesc.stage, sizeof(entryPointDesc.stage));
+                shaderCacheKey = sha1.final();
+            }
+
+            Shader::SharedPtr shader = Shader::create(pLinkedEntryPoint, entryPointDesc.stage, entryPointDesc.exportName, mDesc.getCompilerFlags(), log, shaderCacheKey ? &*shaderCacheKey : nullptr);
             if (!shader) return nullptr;
 
             allShaders.push_back(std::move(shader));
@@ -972,6 +1100,7 @@ namespace Falcor
 
         timer.update();
         double time = timer.delta();
+        std::lock_guard<std::mutex> statsLock(sCompilationStatsMutex);
         sCompilationStats.programKernelsCount++;
         sCompilationStats.programKernelsTotalTime += time;
         sCompilationStats.programKernelsMaxTime = std::max(sCompilationStats.programKernelsMaxTime, time);
@@ -1000,12 +1129,15 @@ namespace Falcor
     }
 
     ProgramVersion::SharedPtr Program::preprocessAndCreateProgramVersion(
-        std::string& log) const
+        DefineList const&   globalDefineList,
+        DefineList const&   defineList,
+        string_time_map&    fileTimeMap,
+        std::string&        log) const
     {
         CpuTimer timer;
         timer.update();
 
-        auto pSlangRequest = createSlangCompileRequest(mDefineList);
+        auto pSlangRequest = createSlangCompileRequest(globalDefineList, defineList);
         if (pSlangRequest == nullptr) return nullptr;
 
         SlangResult slangResult = spCompile(pSlangRequest);
@@ -1052,10 +1184,12 @@ namespace Falcor
 
         // Extract list of files referenced, for dependency-tracking purposes.
         int depFileCount = spGetDependencyFileCount(pSlangRequest);
+        std::vector<std::string> depFilePaths;
         for (int ii = 0; ii < depFileCount; ++ii)
         {
             std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
-            mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            fileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            depFilePaths.push_back(depFilePath);
         }
 
         // Note: the `ProgramReflection` needs to be able to refer back to the
@@ -1069,6 +1203,13 @@ namespace Falcor
         // of Falcor they could be the same object.
         //
         ProgramVersion::SharedPtr pVersion = ProgramVersion::createEmpty(const_cast<Program*>(this), pSlangGlobalScope);
+        pVersion->mpSlangMutex = getSlangGlobalSessionMutex();
+
+        // Kernels are not cached when intermediates are requested, as the dump is a side effect of compilation.
+        if (ShaderCache::isEnabled() && !is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::DumpIntermediates))
+        {
+            pVersion->mShaderCacheKey = computeShaderCacheKey(globalDefineList, defineList, std::move(depFilePaths));
+        }
 
         // Note: Because of interactions between how `SV_Target` outputs
         // and `u` register bindings work in Slang today (as a compatibility
@@ -1093,13 +1234,14 @@ namespace Falcor
 
         auto descStr = getProgramDescString();
         pVersion->init(
-            mDefineList,
+            defineList,
             pReflector,
             descStr,
             pSlangEntryPoints);
 
         timer.update();
         double time = timer.delta();
+        std::lock_guard<std::mutex> statsLock(sCompilationStatsMutex);
         sCompilationStats.programVersionCount++;
         sCompilationStats.programVersionTotalTime += time;
         sCompilationStats.programVersionMaxTime = std::max(sCompilationStats.programVersionMaxTime, time);
@@ -1121,7 +1263,8 @@ namespace Falcor
         {
             // Create the program
             std::string log;
-            auto pVersion = preprocessAndCreateProgramVersion(log);
+            string_time_map fileTimeMap;
+            auto pVersion = preprocessAndCreateProgramVersion(getGlobalDefineList(), mDefineList, fileTimeMap, log);
 
             if (pVersion == nullptr)
             {
@@ -1139,6 +1282,9 @@ namespace Falcor
                 }
 
                 mpActiveVersion = pVersion;
+                mFileTimeMap.insert(fileTimeMap.begin(), fileTimeMap.end());
+                mFailedVersions.erase(mDefineList);
+                recordVersion(mDefineList, mTypeConformanceList);
                 return true;
             }
         }
@@ -1148,10 +1294,137 @@ namespace Falcor
     {
         mpActiveVersion = nullptr;
         mProgramVersions.clear();
+        mPendingVersions.clear();
+        mFailedVersions.clear();
         mFileTimeMap.clear();
         mLinkRequired = true;
     }
 
+    bool Program::requestVersion(const DefineList& defines) const
+    {
+        if (!mPendingVersions.empty()) collectPendingVersions();
+        if (mProgramVersions.find(defines) != mProgramVersions.end()) return true;
+        enqueueVersion(defines, mTypeConformanceList);
+        return false;
+    }
+
+    bool Program::isCompiling() const
+    {
+        if (!mPendingVersions.empty()) collectPendingVersions();
+        return !mPendingVersions.empty();
+    }
+
+    void Program::setAsyncCompiler(const AsyncProgramCompiler::SharedPtr& pCompiler)
+    {
+        // Let the previous compiler finish its jobs before the pending versions are collected.
+        if (sAsyncCompiler && sAsyncCompiler != pCompiler) sAsyncCompiler->waitIdle();
+        sAsyncCompiler = pCompiler;
+    }
+
+    Program::CompileResult Program::compileVersion(const DefineList& globalDefineList, const DefineList& defineList, const TypeConformanceList& typeConformances) const
+    {
+        // This function runs on a worker thread and has exclusive access to the thread's Slang global session.
+        std::lock_guard<std::recursive_mutex> lock(*getSlangGlobalSessionMutex());
+
+        CompileResult result;
+        result.typeConformances = typeConformances;
+        result.pVersion = preprocessAndCreateProgramVersion(globalDefineList, defineList, result.fileTimeMap, result.log);
+
+        // Also create the kernels for the unspecialized program (the common case), so that the version
+        // is ready to use without further compilation on the main thread.
+        if (result.pVersion)
+        {
+            auto pKernels = preprocessAndCreateProgramKernels(result.pVersion.get(), nullptr, typeConformances, result.log);
+            if (!pKernels) result.pVersion = nullptr;
+            else result.pVersion->mpKernels[""] = pKernels;
+        }
+        return result;
+    }
+
+    bool Program::enqueueVersion(const DefineList& defineList, const TypeConformanceList& typeConformances) const
+    {
+#ifdef FALCOR_D3D12
+        // Kernels are generated lazily by GFX using the device's Slang session, so compilation is always synchronous there.
+        if (!sAsyncCompiler || !supportsAsyncCompilation()) return false;
+        if (mPendingVersions.find(defineList) != mPendingVersions.end()) return true;
+        if (mProgramVersions.find(defineList) != mProgramVersions.end()) return false;
+
+        // Versions that failed in the background are compiled synchronously to report the errors.
+        if (mFailedVersions.find(defineList) != mFailedVersions.end()) return false;
+
+        // The global defines are copied here, as they may change on the main thread while the job runs.
+        auto pProgram = shared_from_this();
+        auto pTask = std::make_shared<std::packaged_task<CompileResult()>>([pProgram, globalDefineList = getGlobalDefineList(), defineList, typeConformances]()
+        {
+            return pProgram->compileVersion(globalDefineList, defineList, typeConformances);
+        });
+        mPendingVersions[defineList] = pTask->get_future().share();
+        sAsyncCompiler->enqueue([pTask]() { (*pTask)(); });
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void Program::collectPendingVersions() const
+    {
+        for (auto it = mPendingVersions.begin(); it != mPendingVersions.end();)
+        {
+            if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                ++it;
+                continue;
+            }
+
+            const auto& defineList = it->first;
+            CompileResult result;
+            try
+            {
+                result = it->second.get();
+            }
+            catch (const std::exception& e)
+            {
+                result.log = e.what();
+            }
+
+            if (result.pVersion)
+            {
+                if (!result.log.empty())
+                {
+                    logWarning("Warnings in program:\n" + getProgramDescString() + "\n" + result.log);
+                }
+
+                // Drop the kernels if the type conformances changed during compilation.
+                if (result.typeConformances != mTypeConformanceList) result.pVersion->mpKernels.clear();
+
+                mProgramVersions.emplace(defineList, result.pVersion);
+                mFileTimeMap.insert(result.fileTimeMap.begin(), result.fileTimeMap.end());
+                recordVersion(defineList, result.typeConformances);
+            }
+            else
+            {
+                // The version is compiled again synchronously when it is used, which reports the errors.
+                logDebug("Background compilation failed for program: {}", getProgramDescString());
+                mFailedVersions.insert(defineList);
+            }
+
+            it = mPendingVersions.erase(it);
+        }
+    }
+
+    void Program::recordVersion(const DefineList& defineList, const TypeConformanceList& typeConformances) const
+    {
+        if (sAsyncCompiler) sAsyncCompiler->record({ getProgramDescString(), defineList, typeConformances });
+    }
+
+    void Program::prewarm() const
+    {
+        for (const auto& entry : sAsyncCompiler->getPrewarmEntries(getProgramDescString()))
+        {
+            enqueueVersion(entry.defines, entry.typeConformances);
+        }
+    }
+
     bool Program::reloadAllPrograms(bool forceReload)
     {
         bool hasReloaded = false;
@@ -1214,13 +1487,19 @@ namespace Falcor
 
     void Program::addGlobalDefines(const DefineList& defineList)
     {
-        sGlobalDefineList.add(defineList);
+        {
+            std::lock_guard<std::mutex> lock(sGlobalDefineListMutex);
+            sGlobalDefineList.add(defineList);
+        }
         reloadAllPrograms(true);
     }
 
     void Program::removeGlobalDefines(const DefineList& defineList)
     {
-        sGlobalDefineList.remove(defineList);
+        {
+            std::lock_guard<std::mutex> lock(sGlobalDefineListMutex);
+            sGlobalDefineList.remove(defineList);
+        }
         reloadAllPrograms(true);
     }
 
@@ -29,6 +29,8 @@
 #include "Core/API/Shader.h"
 #include "Core/Program/ShaderLibrary.h"
 #include "Core/Program/ProgramVersion.h"
+#include "Core/Program/AsyncProgramCompiler.h"
+#include <future>
 
 namespace Falcor
 {
@@ -293,6 +295,35 @@ namespace Falcor
             return mDesc.mGroups[groupIndex].entryPoints[entryPointIndexInGroup];
         }
 
+        /** Request the program version for a list of macro definitions, using the current type conformances.
+            If an asynchronous compiler is installed (see `setAsyncCompiler()`), a missing version is compiled on a
+            worker thread and this call returns immediately. Callers can keep using the current defines (and thus
+            the current version) until the request returns true, and then switch with `setDefines()` without stalling.
+            Without a compiler, the version is compiled on first use as usual.
+            \param[in] defines List of macro definitions.
+            \return True if the version is compiled and ready to use.
+        */
+        bool requestVersion(const DefineList& defines) const;
+
+        /** Request the program version for the current macro definitions. See `requestVersion()`.
+            This is useful to compile many programs in parallel before they are first used.
+            \return True if the version is compiled and ready to use.
+        */
+        bool requestActiveVersion() const { return requestVersion(mDefineList); }
+
+        /** Check if any versions of this program are being compiled in the background.
+        */
+        bool isCompiling() const;
+
+        /** Install a compiler used for background compilation of all programs, or nullptr to disable background compilation.
+            When a program is created, all versions recorded for it in the compiler's prewarm list are requested.
+        */
+        static void setAsyncCompiler(const AsyncProgramCompiler::SharedPtr& pCompiler);
+
+        /** Get the compiler used for background compilation.
+        */
+        static const AsyncProgramCompiler::SharedPtr& getAsyncCompiler() { return sAsyncCompiler; }
+
         static const CompilationStats& getGlobalCompilationStats() { return sCompilationStats; }
         static void resetGlobalCompilationStats() { sCompilationStats = {}; }
 
@@ -307,6 +338,7 @@ namespace Falcor
         bool link() const;
 
         SlangCompileRequest* createSlangCompileRequest(
+            DefineList  const& globalDefineList,
             DefineList  const& defineList) const;
 
         virtual void setUpSlangCompilationTarget(
@@ -320,12 +352,40 @@ namespace Falcor
             ProgramReflection::SharedPtr&               pReflector,
             std::string&                                log) const;
 
-        ProgramVersion::SharedPtr preprocessAndCreateProgramVersion(std::string& log) const;
+        using string_time_map = std::unordered_map<std::string, time_t>;
+
+        ProgramVersion::SharedPtr preprocessAndCreateProgramVersion(
+            DefineList const&   globalDefineList,
+            DefineList const&   defineList,
+            string_time_map&    fileTimeMap,
+            std::string&        log) const;
 
         ProgramKernels::SharedPtr preprocessAndCreateProgramKernels(
-            ProgramVersion const* pVersion,
-            ProgramVars    const* pVars,
-            std::string         & log) const;
+            ProgramVersion      const* pVersion,
+            ProgramVars         const* pVars,
+            TypeConformanceList const& typeConformances,
+            std::string              & log) const;
+
+        /** Result of a background compilation job.
+        */
+        struct CompileResult
+        {
+            ProgramVersion::SharedPtr pVersion;     ///< Compiled version, or nullptr on failure.
+            TypeConformanceList typeConformances;   ///< Type conformances the kernels were compiled with.
+            string_time_map fileTimeMap;            ///< Files the version depends on.
+            std::string log;
+        };
+
+        /** Check if versions of this program can be compiled on worker threads.
+            Programs whose kernels require thread-local API state must override this to return false.
+        */
+        virtual bool supportsAsyncCompilation() const { return true; }
+
+        CompileResult compileVersion(const DefineList& globalDefineList, const DefineList& defineList, const TypeConformanceList& typeConformances) const;
+        bool enqueueVersion(const DefineList& defineList, const TypeConformanceList& typeConformances) const;
+        void collectPendingVersions() const;
+        void recordVersion(const DefineList& defineList, const TypeConformanceList& typeConformances) const;
+        void prewarm() const;
 
         virtual EntryPointGroupKernels::SharedPtr createEntryPointGroupKernels(
             const std::vector<Shader::SharedPtr>& shaders,
@@ -352,16 +412,30 @@ namespace Falcor
         mutable ProgramVersion::SharedConstPtr mpActiveVersion;
         void markDirty() { mLinkRequired = true; }
 
+        // Versions being compiled in the background, and versions that failed to compile in the background
+        mutable std::map<DefineList, std::shared_future<CompileResult>> mPendingVersions;
+        mutable std::set<DefineList> mFailedVersions;
+
         std::string getProgramDescString() const;
+        SHA1::MD computeShaderCacheKey(const DefineList& globalDefineList, const DefineList& defineList, std::vector<std::string> dependencyFiles) const;
         static std::vector<std::weak_ptr<Program>> sProgramsForReload;
         static CompilationStats sCompilationStats;
+        static std::mutex sCompilationStatsMutex;
+        static AsyncProgramCompiler::SharedPtr sAsyncCompiler;
 
-        using string_time_map = std::unordered_map<std::string, time_t>;
         mutable string_time_map mFileTimeMap;
 
         bool checkIfFilesChanged();
         void reset();
     };
 
+    /** Get the Slang global session of the calling thread.
+        Slang global sessions are not thread-safe, so each thread compiling programs uses its own session.
+    */
     slang::IGlobalSession* getSlangGlobalSession();
+
+    /** Get the mutex guarding the Slang global session of the calling thread.
+        Objects created from a session may be used on other threads after compilation, which must hold this mutex.
+    */
+    const std::shared_ptr<std::recursive_mutex>& getSlangGlobalSessionMutex();
 }
@@ -211,6 +211,18 @@ namespace Falcor
         return SharedPtr(new ProgramVersion(pProgram, pSlangGlobalScope));
     }
 
+    ProgramVersion::~ProgramVersion()
+    {
+        // Slang objects must not be released while their global session is in use on another thread.
+        if (mpSlangMutex)
+        {
+            std::lock_guard<std::recursive_mutex> lock(*mpSlangMutex);
+            mpKernels.clear();
+            mpSlangEntryPoints.clear();
+            mpSlangGlobalScope.setNull();
+        }
+    }
+
     ProgramKernels::SharedConstPtr ProgramVersion::getKernels(ProgramVars const* pVars) const
     {
         // We need are going to look up or create specialized kernels
@@ -246,7 +258,11 @@ namespace Falcor
         for(;;)
         {
             std::string log;
-            auto pKernels = mpProgram->preprocessAndCreateProgramKernels(this, pVars, log);
+            ProgramKernels::SharedPtr pKernels;
+            {
+                std::lock_guard<std::recursive_mutex> lock(*mpSlangMutex);
+                pKernels = mpProgram->preprocessAndCreateProgramKernels(this, pVars, mpProgram->mTypeConformanceList, log);
+            }
             if( pKernels )
             {
                 // Success
@@ -34,6 +34,8 @@
 #endif
 
 #include <slang/slang.h>
+#include <mutex>
+#include <optional>
 
 namespace Falcor
 {
@@ -242,6 +244,8 @@ namespace Falcor
         slang::IComponentType* getSlangGlobalScope() const;
         slang::IComponentType* getSlangEntryPoint(uint32_t index) const;
 
+        ~ProgramVersion();
+
     protected:
         friend class Program;
         friend class RtProgram;
@@ -263,6 +267,12 @@ namespace Falcor
         ComPtr<slang::IComponentType>   mpSlangGlobalScope;
         std::vector<ComPtr<slang::IComponentType>> mpSlangEntryPoints;
 
+        // Persistent shader cache key covering all inputs of this version, or empty if the cache is bypassed
+        std::optional<SHA1::MD> mShaderCacheKey;
+
+        // Mutex guarding the Slang global session the version was created from
+        std::shared_ptr<std::recursive_mutex> mpSlangMutex;
+
         // Cached version of compiled kernels for this program version
         mutable std::unordered_map<std::string, ProgramKernels::SharedPtr> mpKernels;
     };
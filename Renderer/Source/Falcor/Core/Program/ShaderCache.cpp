@@ -0,0 +1,431 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "ShaderCache.h"
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Specifies the current cache file version.
+            This needs to be incremented every time the file format changes!
+        */
+        const uint32_t kVersion = 1;
+
+        /** Shader cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/ShaderCache";
+
+        const std::string kEntryExtension = ".bin";
+        const std::string kTempExtension = ".tmp";
+
+        const uint64_t kDefaultMaxSize = 1ull << 30;
+
+        /** When the size limit is exceeded, entries are evicted until the cache is at this fraction of the limit.
+            This avoids running the eviction pass on every write once the cache is full.
+        */
+        const double kEvictionTargetFraction = 0.75;
+
+        const char* kMagic = "FalcorK$";
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t reserved{};
+            ShaderCache::Key key{};
+            uint64_t dataSize{};
+            ShaderCache::Key dataHash{};
+
+            bool isValid(const ShaderCache::Key& expectedKey) const
+            {
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion && key == expectedKey;
+            }
+        };
+
+        struct FileHash
+        {
+            std::filesystem::file_time_type modifiedTime;
+            uint64_t size;
+            ShaderCache::Key hash;
+        };
+
+        struct State
+        {
+            std::mutex mutex;
+            bool enabled = true;
+            std::filesystem::path directory;
+            uint64_t maxSize = kDefaultMaxSize;
+            uint64_t currentSize = 0;           ///< Estimated total size of all entries.
+            bool currentSizeValid = false;      ///< True if the directory was scanned to initialize `currentSize`.
+            ShaderCache::Stats stats;
+            std::unordered_map<std::string, FileHash> fileHashes;
+        };
+
+        State& getState()
+        {
+            static State sState;
+            return sState;
+        }
+
+        const std::filesystem::path& getDirectoryLocked(State& state)
+        {
+            if (state.directory.empty()) state.directory = getAppDataDirectory() / kDirectory;
+            return state.directory;
+        }
+
+        std::string toHexString(const ShaderCache::Key& key)
+        {
+            static const char* kDigits = "0123456789abcdef";
+            std::string str;
+            str.reserve(key.size() * 2);
+            for (auto c : key)
+            {
+                str.push_back(kDigits[c >> 4]);
+                str.push_back(kDigits[c & 0xf]);
+            }
+            return str;
+        }
+
+        struct EntryInfo
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type lastUsed;
+            uint64_t size;
+        };
+
+        std::vector<EntryInfo> listEntries(const std::filesystem::path& directory)
+        {
+            std::vector<EntryInfo> entries;
+            std::error_code ec;
+            for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+            {
+                if (!it->is_regular_file(ec) || it->path().extension() != kEntryExtension) continue;
+                EntryInfo info;
+                info.path = it->path();
+                info.lastUsed = it->last_write_time(ec);
+                info.size = it->file_size(ec);
+                if (!ec) entries.push_back(std::move(info));
+                ec.clear();
+            }
+            return entries;
+        }
+    }
+
+    void ShaderCache::setEnabled(bool enabled)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.enabled = enabled;
+    }
+
+    bool ShaderCache::isEnabled()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.enabled;
+    }
+
+    void ShaderCache::setDirectory(const std::filesystem::path& path)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.directory = path;
+        state.currentSize = 0;
+        state.currentSizeValid = false;
+    }
+
+    std::filesystem::path ShaderCache::getDirectory()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return getDirectoryLocked(state);
+    }
+
+    void ShaderCache::setMaxSize(uint64_t maxSize)
+    {
+        auto& state = getState();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.maxSize = maxSize;
+        }
+        evict();
+    }
+
+    uint64_t ShaderCache::getMaxSize()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.maxSize;
+    }
+
+    bool ShaderCache::read(const Key& key, std::vector<uint8_t>& data)
+    {
+        // File I/O and hashing are done without holding the lock, it only protects the state bookkeeping.
+        auto& state = getState();
+        std::filesystem::path path;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (!state.enabled) return false;
+            path = getDirectoryLocked(state) / (toHexString(key) + kEntryExtension);
+        }
+
+        std::vector<uint8_t> buffer;
+        bool valid = false;
+        {
+            std::ifstream fs(path, std::ios_base::binary);
+            if (!fs)
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.stats.missCount++;
+                return false;
+            }
+
+            Header header;
+            if (fs.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.isValid(key))
+            {
+                buffer.resize(header.dataSize);
+                valid = fs.read(reinterpret_cast<char*>(buffer.data()), buffer.size()) && fs.peek() == std::char_traits<char>::eof() &&
+                    SHA1::compute(buffer.data(), buffer.size()) == header.dataHash;
+            }
+        }
+
+        std::error_code ec;
+        if (!valid)
+        {
+            // Delete the entry so it gets rewritten by the caller.
+            logWarning("Deleting invalid shader cache entry '{}'.", path);
+            uint64_t size = std::filesystem::file_size(path, ec);
+            bool removed = std::filesystem::remove(path, ec);
+
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (removed && state.currentSizeValid) state.currentSize -= std::min(size, state.currentSize);
+            state.stats.invalidCount++;
+            state.stats.missCount++;
+            data.clear();
+            return false;
+        }
+
+        // Touch the entry to mark it as recently used for eviction.
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.stats.hitCount++;
+            state.stats.bytesRead += buffer.size();
+        }
+        data = std::move(buffer);
+        return true;
+    }
+
+    void ShaderCache::write(const Key& key, const void* data, size_t size)
+    {
+        // File I/O and hashing are done without holding the lock, it only protects the state bookkeeping.
+        auto& state = getState();
+        std::filesystem::path directory;
+        bool scanDirectory = false;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (!state.enabled) return;
+            directory = getDirectoryLocked(state);
+            scanDirectory = !state.currentSizeValid;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        uint64_t scannedSize = 0;
+        if (scanDirectory)
+        {
+            for (const auto& entry : listEntries(directory)) scannedSize += entry.size;
+        }
+
+        // Write to a temporary file first and then rename it, so that concurrent readers
+        // (possibly in other processes) never observe a partially written entry.
+        auto path = directory / (toHexString(key) + kEntryExtension);
+        auto tempPath = directory / fmt::format("{}.{}{}", toHexString(key), std::hash<std::thread::id>()(std::this_thread::get_id()), kTempExtension);
+
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+        header.version = kVersion;
+        header.key = key;
+        header.dataSize = size;
+        header.dataHash = SHA1::compute(data, size);
+
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary | std::ios_base::trunc);
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(data), size);
+            if (!fs)
+            {
+                fs.close();
+                std::filesystem::remove(tempPath, ec);
+                logWarning("Failed to write shader cache entry '{}'.", path);
+                return;
+            }
+        }
+
+        uint64_t oldSize = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tempPath, ec);
+            logWarning("Failed to write shader cache entry '{}'.", path);
+            return;
+        }
+
+        bool needsEviction = false;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            // Skip the size bookkeeping if the directory was changed in the meantime.
+            if (getDirectoryLocked(state) == directory)
+            {
+                if (scanDirectory && !state.currentSizeValid)
+                {
+                    state.currentSize = scannedSize;
+                    state.currentSizeValid = true;
+                }
+                state.currentSize = state.currentSize - std::min(oldSize, state.currentSize) + sizeof(header) + size;
+                needsEviction = state.currentSizeValid && state.currentSize > state.maxSize;
+            }
+            state.stats.writeCount++;
+            state.stats.bytesWritten += size;
+        }
+
+        if (needsEviction) evict();
+    }
+
+    void ShaderCache::clear()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        std::error_code ec;
+        for (const auto& entry : listEntries(getDirectoryLocked(state))) std::filesystem::remove(entry.path, ec);
+        state.currentSize = 0;
+        state.currentSizeValid = true;
+        state.fileHashes.clear();
+    }
+
+    ShaderCache::Stats ShaderCache::getStats()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.stats;
+    }
+
+    void ShaderCache::resetStats()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stats = {};
+    }
+
+    ShaderCache::Key ShaderCache::hashFile(const std::filesystem::path& path)
+    {
+        auto& state = getState();
+        std::error_code ec;
+        auto modifiedTime = std::filesystem::last_write_time(path, ec);
+        uint64_t size = std::filesystem::file_size(path, ec);
+        if (ec) return {};
+        auto pathString = path.string();
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            auto it = state.fileHashes.find(pathString);
+            if (it != state.fileHashes.end() && it->second.modifiedTime == modifiedTime && it->second.size == size) return it->second.hash;
+        }
+
+        Key hash{};
+        std::ifstream fs(path, std::ios_base::binary);
+        if (fs)
+        {
+            SHA1 sha1;
+            std::vector<char> buffer(64 * 1024);
+            while (fs)
+            {
+                fs.read(buffer.data(), buffer.size());
+                sha1.update(buffer.data(), (size_t)fs.gcount());
+            }
+            hash = sha1.final();
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.fileHashes[pathString] = { modifiedTime, size, hash };
+        return hash;
+    }
+
+    void ShaderCache::evict()
+    {
+        auto& state = getState();
+        std::filesystem::path directory;
+        uint64_t maxSize = 0;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            directory = getDirectoryLocked(state);
+            maxSize = state.maxSize;
+        }
+
+        auto entries = listEntries(directory);
+        uint64_t currentSize = 0;
+        for (const auto& entry : entries) currentSize += entry.size;
+
+        uint64_t evictedCount = 0;
+        if (currentSize > maxSize)
+        {
+            // Evict least recently used entries first.
+            std::sort(entries.begin(), entries.end(), [](const EntryInfo& a, const EntryInfo& b) { return a.lastUsed < b.lastUsed; });
+
+            const uint64_t targetSize = (uint64_t)(maxSize * kEvictionTargetFraction);
+            std::error_code ec;
+            for (const auto& entry : entries)
+            {
+                if (currentSize <= targetSize) break;
+                if (std::filesystem::remove(entry.path, ec))
+                {
+                    currentSize -= entry.size;
+                    evictedCount++;
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (getDirectoryLocked(state) == directory)
+            {
+                state.currentSize = currentSize;
+                state.currentSizeValid = true;
+            }
+            state.stats.evictionCount += evictedCount;
+        }
+        if (evictedCount > 0) logInfo("Evicted {} shader cache entries, cache size is now {} bytes.", evictedCount, currentSize);
+    }
+}
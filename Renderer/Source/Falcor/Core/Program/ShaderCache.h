@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+    /** Persistent on-disk cache for compiled shader kernels.
+
+        Each cache entry stores the downstream compiler output for a single entry point.
+        Entries are addressed by a key that is computed by the caller (see `Program`) and must cover
+        everything that influences code generation: the contents of all transitively included source files,
+        the define list, the type conformances, the shader model and the compiler flags/arguments.
+
+        Entries are self-validating: every file stores a header with the key and a hash of the payload.
+        Entries that fail validation (truncated, corrupted or written by an incompatible version) are deleted
+        and treated as a miss. The total size of the cache is bounded, when the limit is exceeded the least
+        recently used entries are evicted. All functions are thread-safe.
+    */
+    class FALCOR_API ShaderCache
+    {
+    public:
+        using Key = SHA1::MD;
+
+        struct Stats
+        {
+            uint64_t hitCount = 0;          ///< Number of lookups that returned a valid entry.
+            uint64_t missCount = 0;         ///< Number of lookups that did not find a valid entry.
+            uint64_t writeCount = 0;        ///< Number of entries written.
+            uint64_t evictionCount = 0;     ///< Number of entries evicted to stay within the size limit.
+            uint64_t invalidCount = 0;      ///< Number of entries deleted because they failed validation.
+            uint64_t bytesRead = 0;         ///< Total size of payloads returned by hits.
+            uint64_t bytesWritten = 0;      ///< Total size of payloads written.
+        };
+
+        /** Enable/disable the cache. If disabled, all lookups miss and nothing is written.
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled.
+        */
+        static bool isEnabled();
+
+        /** Set the cache directory. Defaults to a subdirectory in the application data directory.
+        */
+        static void setDirectory(const std::filesystem::path& path);
+
+        /** Get the cache directory.
+        */
+        static std::filesystem::path getDirectory();
+
+        /** Set the maximum total size of the cache in bytes.
+            When a write exceeds the limit, the least recently used entries are evicted.
+        */
+        static void setMaxSize(uint64_t maxSize);
+
+        /** Get the maximum total size of the cache in bytes.
+        */
+        static uint64_t getMaxSize();
+
+        /** Look up an entry.
+            \param[in] key Cache key.
+            \param[out] data Cached payload, only valid on hit.
+            \return Returns true if a valid entry was found.
+        */
+        static bool read(const Key& key, std::vector<uint8_t>& data);
+
+        /** Write an entry. Existing entries with the same key are replaced.
+            Failures are reported as warnings, the cache is an optimization only.
+            \param[in] key Cache key.
+            \param[in] data Payload.
+            \param[in] size Payload size in bytes.
+        */
+        static void write(const Key& key, const void* data, size_t size);
+
+        /** Delete all entries in the cache directory.
+        */
+        static void clear();
+
+        /** Get the cache statistics.
+        */
+        static Stats getStats();
+
+        /** Reset the cache statistics.
+        */
+        static void resetStats();
+
+        /** Compute the SHA-1 hash of a file's contents.
+            Results are memoized by path and modification time, so hashing the include set of a program is cheap
+            as long as the files don't change.
+            \param[in] path File path.
+            \return Returns the hash, or an all-zero hash if the file doesn't exist.
+        */
+        static Key hashFile(const std::filesystem::path& path);
+
+    private:
+        static void evict();
+    };
+}
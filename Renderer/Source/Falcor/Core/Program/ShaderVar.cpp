@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "ShaderVar.h"
+#include "ShaderVarHandle.h"
 
 namespace Falcor
 {
@@ -278,6 +279,23 @@ namespace Falcor
         return ShaderVar();
     }
 
+    ShaderVar ShaderVar::operator[](ShaderVarHandle const& handle) const
+    {
+        if (!isValid() || !handle.isValid()) return ShaderVar();
+        FALCOR_ASSERT(handle.isValidFor(*this));
+
+        // Each offset is applied within its enclosing block, constant buffers are dereferenced implicitly.
+        ParameterBlock* pBlock = mpBlock;
+        TypedShaderVarOffset offset = mOffset;
+        for (const auto& segment : handle.getSegments())
+        {
+            ShaderVar var = ShaderVar(pBlock, offset)[segment];
+            pBlock = var.mpBlock;
+            offset = var.mOffset;
+        }
+        return ShaderVar(pBlock, offset);
+    }
+
     bool ShaderVar::isValid() const
     {
         return mOffset.isValid();
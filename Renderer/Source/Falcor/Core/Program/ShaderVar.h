@@ -37,6 +37,7 @@ namespace Falcor
     class ParameterBlock;
     template<typename T>
     class ParameterBlockSharedPtr;
+    class ShaderVarHandle;
 
     /** A "pointer" to a shader variable stored in some parameter block.
 
@@ -329,6 +330,13 @@ namespace Falcor
         */
         ShaderVar operator[](UniformShaderVarOffset const& offset) const;
 
+        /** Create a shader variable from a handle resolved against this one.
+
+            This is equivalent to looking up the path of the handle by name, but does not perform any string operations.
+            The handle must have been resolved against a shader variable of the same type, see `ShaderVarHandle::isValidFor()`.
+        */
+        ShaderVar operator[](ShaderVarHandle const& handle) const;
+
         /** Implicit conversion from a shader variable to a texture.
             This operation allows a bound texture to be queried using the `[]` syntax:
                 pTexture = pVars["someTexture"];
@@ -360,6 +368,7 @@ namespace Falcor
 
     private:
         friend class VariablesBufferUI;
+        friend class ShaderConstantWriter;
         /** The parameter block that is being pointed into.
 
             Note: this is an unowned pointer, so it is *not* safe to hold onto a `ShaderVar` for long periods
@@ -0,0 +1,163 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "ShaderVarHandle.h"
+#include <charconv>
+
+namespace Falcor
+{
+    namespace
+    {
+        bool isConstantBuffer(const ReflectionType* pType)
+        {
+            auto pResourceType = pType->asResourceType();
+            return pResourceType && pResourceType->getType() == ReflectionResourceType::Type::ConstantBuffer;
+        }
+
+        /** Get the offset of the contents of a constant buffer or parameter block, relative to the block itself.
+        */
+        TypedShaderVarOffset getContentsOffset(const ReflectionType* pType)
+        {
+            FALCOR_ASSERT(isConstantBuffer(pType));
+            return pType->asResourceType()->getParameterBlockReflector()->getElementType()->getZeroOffset();
+        }
+    }
+
+    ShaderVarHandle::ShaderVarHandle(const ShaderVar& var, std::string_view path)
+    {
+        if (!var.isValid()) return;
+
+        auto reportPathError = [path](const std::string& msg)
+        {
+            reportError(fmt::format("Failed to resolve shader variable '{}'. {}", path, msg));
+        };
+
+        // Applying an offset to a variable of constant buffer type implicitly dereferences it (see `ShaderVar::operator[]`),
+        // so the first offset is relative to the contents of the buffer in that case.
+        auto pRootType = var.getType();
+        TypedShaderVarOffset offset = isConstantBuffer(pRootType.get()) ? getContentsOffset(pRootType.get()) : pRootType->getZeroOffset();
+        std::vector<TypedShaderVarOffset> segments;
+
+        size_t pos = 0;
+        while (pos < path.size())
+        {
+            // Step into constant buffers along the path. The following offsets are relative to the buffer contents.
+            if (isConstantBuffer(offset.getType().get()))
+            {
+                segments.push_back(offset);
+                offset = getContentsOffset(offset.getType().get());
+            }
+            const ReflectionType* pType = offset.getType().get();
+
+            if (path[pos] == '[')
+            {
+                size_t end = path.find(']', pos);
+                size_t index = 0;
+                if (end == std::string_view::npos || std::from_chars(path.data() + pos + 1, path.data() + end, index).ptr != path.data() + end)
+                {
+                    reportPathError("Invalid array index.");
+                    return;
+                }
+                pos = end + 1;
+
+                auto pArrayType = pType->asArrayType();
+                if (!pArrayType)
+                {
+                    reportPathError("Variable is not an array.");
+                    return;
+                }
+                auto elementCount = pArrayType->getElementCount();
+                if (elementCount && index >= elementCount)
+                {
+                    reportPathError(fmt::format("Array index {} is out of bounds.", index));
+                    return;
+                }
+
+                // Same offset computation as `ShaderVar::operator[](size_t)`.
+                UniformShaderVarOffset uniformOffset = offset.getUniform() + index * pArrayType->getElementByteStride();
+                ResourceShaderVarOffset resourceOffset(offset.getResource().getRangeIndex(), offset.getResource().getArrayIndex() * elementCount + ResourceShaderVarOffset::ArrayIndex(index));
+                offset = TypedShaderVarOffset(pArrayType->getElementType().get(), ShaderVarOffset(uniformOffset, resourceOffset));
+            }
+            else
+            {
+                size_t end = std::min(path.find_first_of(".[", pos), path.size());
+                std::string name(path.substr(pos, end - pos));
+                pos = end;
+
+                auto pStructType = pType->asStructType();
+                auto pMember = pStructType && !name.empty() ? pStructType->findMember(name) : nullptr;
+                if (!pMember)
+                {
+                    reportPathError(fmt::format("No member named '{}' found.", name));
+                    return;
+                }
+                offset = TypedShaderVarOffset(pMember->getType().get(), offset + pMember->getBindLocation());
+            }
+
+            if (pos < path.size() && path[pos] == '.')
+            {
+                if (++pos == path.size())
+                {
+                    reportPathError("Path ends with '.'.");
+                    return;
+                }
+            }
+        }
+        segments.push_back(offset);
+
+        mpRootType = pRootType;
+        mSegments = std::move(segments);
+    }
+
+    void ShaderConstantWriter::setBlob(const ShaderVarHandle& handle, const void* pData, size_t size)
+    {
+        FALCOR_ASSERT(handle.isValidFor(mVar));
+        FALCOR_ASSERT(size <= handle.getType()->getByteSize());
+        FALCOR_ASSERT(!isConstantBuffer(handle.getType().get()));
+
+        ShaderVar var = mVar[handle];
+        if (!var.isValid()) return;
+
+        ParameterBlock* pBlock = var.mpBlock;
+        size_t offset = var.getByteOffset();
+
+#ifdef FALCOR_D3D12
+        FALCOR_ASSERT(offset + size <= pBlock->mData.size());
+        std::memcpy(pBlock->mData.data() + offset, pData, size);
+        if (std::find(mDirtyBlocks.begin(), mDirtyBlocks.end(), pBlock) == mDirtyBlocks.end()) mDirtyBlocks.push_back(pBlock);
+#else
+        pBlock->setBlob(pData, offset, size);
+#endif
+    }
+
+    void ShaderConstantWriter::flush()
+    {
+        for (auto pBlock : mDirtyBlocks) pBlock->markUniformDataDirty();
+        mDirtyBlocks.clear();
+    }
+}
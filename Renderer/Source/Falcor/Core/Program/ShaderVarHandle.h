@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ShaderVar.h"
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+    /** Shader variable path resolved once against the reflection of a shader variable.
+
+        Looking up `var["CB"]["outputDim"]` walks the reflection by name on every call. A handle
+        performs the name lookup once and stores the resulting offsets, so the variable can be accessed
+        each frame without any string operations:
+
+            ShaderVarHandle outputDim(pPass->getRootVar(), "CB.outputDim");
+            ...
+            pPass->getRootVar()[outputDim] = uint2(1920, 1080);
+
+        The path uses the same syntax as shader code. Members are separated by '.' and array elements
+        are accessed with '[index]'. Members of constant buffers and parameter blocks are accessed directly,
+        e.g. "gScene.camera.data".
+
+        A handle stays valid as long as the shader variable it was resolved against keeps the same type,
+        i.e. until the program is recompiled and its vars are recreated. Use `isValidFor()` to check if the
+        handle needs to be resolved again.
+    */
+    class FALCOR_API ShaderVarHandle
+    {
+    public:
+        /** Create an invalid handle.
+        */
+        ShaderVarHandle() = default;
+
+        /** Resolve a path relative to a shader variable.
+            An error is reported if the path does not exist.
+            \param[in] var Shader variable the path is relative to.
+            \param[in] path Path of the variable, e.g. "CB.outputDim" or "lights[2].posW".
+        */
+        ShaderVarHandle(const ShaderVar& var, std::string_view path);
+
+        /** Check if the handle was resolved successfully.
+        */
+        bool isValid() const { return !mSegments.empty(); }
+
+        /** Check if the handle can be applied to a shader variable.
+            \param[in] var Shader variable.
+            \return True if the handle was resolved against a shader variable of the same type.
+        */
+        bool isValidFor(const ShaderVar& var) const { return isValid() && var.getType().get() == mpRootType.get(); }
+
+        /** Get the type of the variable the handle points to.
+        */
+        ReflectionType::SharedConstPtr getType() const { return isValid() ? mSegments.back().getType() : nullptr; }
+
+        /** Get the resolved offsets.
+            There is one offset per parameter block along the path, each one relative to its enclosing block.
+            The last offset is the offset of the variable itself.
+        */
+        const std::vector<TypedShaderVarOffset>& getSegments() const { return mSegments; }
+
+    private:
+        ReflectionType::SharedConstPtr mpRootType;      ///< Type of the shader variable the handle was resolved against.
+        std::vector<TypedShaderVarOffset> mSegments;    ///< Offsets of the variable, one per parameter block along the path.
+    };
+
+    /** Writes uniform values through shader variable handles.
+
+        Values are copied directly into the parameter blocks without type validation by offset,
+        and each parameter block is marked dirty only once when the writer is flushed or destroyed.
+
+            ShaderConstantWriter writer(pPass->getRootVar());
+            writer.set(mHandles.outputDim, uint2(1920, 1080));
+            writer.set(mHandles.invSamples, 0.25f);
+
+        The writer holds an unowned pointer to the parameter block of the shader variable, same as `ShaderVar`,
+        so it must not outlive the parameter block.
+    */
+    class FALCOR_API ShaderConstantWriter
+    {
+    public:
+        /** Create a writer.
+            \param[in] var Shader variable the handles were resolved against.
+        */
+        explicit ShaderConstantWriter(const ShaderVar& var) : mVar(var) {}
+
+        /** Destructor. Flushes all writes.
+        */
+        ~ShaderConstantWriter() { flush(); }
+
+        ShaderConstantWriter(const ShaderConstantWriter&) = delete;
+        ShaderConstantWriter& operator=(const ShaderConstantWriter&) = delete;
+
+        /** Write a value.
+            \param[in] handle Handle of the variable, resolved against the shader variable of the writer.
+            \param[in] value Value. Its size must not exceed the size of the variable.
+        */
+        template<typename T>
+        void set(const ShaderVarHandle& handle, const T& value)
+        {
+            setBlob(handle, &value, sizeof(value));
+        }
+
+        /** Write raw bytes.
+            \param[in] handle Handle of the variable, resolved against the shader variable of the writer.
+            \param[in] pData Data to write.
+            \param[in] size Size of the data in bytes. Must not exceed the size of the variable.
+        */
+        void setBlob(const ShaderVarHandle& handle, const void* pData, size_t size);
+
+        /** Mark all parameter blocks written to since the last flush as dirty.
+        */
+        void flush();
+
+    private:
+        ShaderVar mVar;
+        std::vector<ParameterBlock*> mDirtyBlocks;      ///< Parameter blocks written to since the last flush.
+    };
+}
@@ -558,6 +558,8 @@ namespace Falcor
         desc.width = pSwapChainFbo->getWidth();
         desc.bitrateMbps = mVideoCapture.pUI->getBitrate();
         desc.gopSize = mVideoCapture.pUI->getGopSize();
+        desc.preset = mVideoCapture.pUI->getPreset();
+        desc.threadCount = mVideoCapture.pUI->getThreadCount();
 
         mVideoCapture.pVideoCapture = VideoEncoder::create(desc);
         if (!mVideoCapture.pVideoCapture) return false;
@@ -591,7 +593,7 @@ namespace Falcor
     {
         if (mVideoCapture.pVideoCapture)
         {
-            mVideoCapture.pVideoCapture->appendFrame(getRenderContext()->readTextureSubresource(gpDevice->getSwapChainFbo()->getColorTexture(0).get(), 0).data());
+            mVideoCapture.pVideoCapture->appendFrame(getRenderContext()->readTextureSubresource(gpDevice->getSwapChainFbo()->getColorTexture(0).get(), 0));
 
             if (mVideoCapture.pUI->useTimeRange())
             {
@@ -70,6 +70,7 @@
 #include "Core/Platform/ProgressBar.h"
 
 // Core/Program
+#include "Core/Program/AsyncProgramCompiler.h"
 #include "Core/Program/ComputeProgram.h"
 #include "Core/Program/GraphicsProgram.h"
 #include "Core/Program/CUDAProgram.h"
@@ -78,7 +79,9 @@
 #include "Core/Program/ProgramVars.h"
 #include "Core/Program/ProgramVersion.h"
 #include "Core/Program/RtProgram.h"
+#include "Core/Program/ShaderCache.h"
 #include "Core/Program/ShaderLibrary.h"
+#include "Core/Program/ShaderVarHandle.h"
 
 // Core/State
 #include "Core/State/ComputeState.h"
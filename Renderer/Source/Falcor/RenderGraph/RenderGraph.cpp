@@ -381,6 +381,13 @@ namespace Falcor
         return outputs;
     }
 
+    void RenderGraph::setResourceAliasingEnabled(bool enabled)
+    {
+        if (mCompilerDeps.enableResourceAliasing == enabled) return;
+        mCompilerDeps.enableResourceAliasing = enabled;
+        mRecompile = true;
+    }
+
     bool RenderGraph::compile(RenderContext* pRenderContext, std::string& log)
     {
         if (!mRecompile) return true;
@@ -665,6 +672,7 @@ namespace Falcor
         pybind11::class_<RenderGraph, RenderGraph::SharedPtr> renderGraph(m, "RenderGraph");
         renderGraph.def(pybind11::init(&RenderGraph::create));
         renderGraph.def_property("name", &RenderGraph::getName, &RenderGraph::setName);
+        renderGraph.def_property("resourceAliasing", &RenderGraph::isResourceAliasingEnabled, &RenderGraph::setResourceAliasingEnabled);
         renderGraph.def(RenderGraphIR::kAddPass, &RenderGraph::addPass, "pass"_a, "name"_a);
         renderGraph.def(RenderGraphIR::kRemovePass, &RenderGraph::removePass, "name"_a);
         renderGraph.def(RenderGraphIR::kAddEdge, &RenderGraph::addEdge, "src"_a, "dst"_a);
@@ -218,6 +218,18 @@ namespace Falcor
         */
         void setName(const std::string& name) { mName = name; }
 
+        /** Enable/disable sharing of resources between fields with disjoint lifetimes. Disabled by default.
+            When enabled, the contents of a field are only valid between the pass that writes it and the last pass that reads it during an execution.
+            Passes that read their outputs from the previous execution (accumulation, history buffers etc.) must mark those fields as Persistent,
+            otherwise another field may overwrite them. Only enable it for graphs whose passes follow this rule.
+            The graph is recompiled on the next execution if the setting changes.
+        */
+        void setResourceAliasingEnabled(bool enabled);
+
+        /** Check if resource sharing between fields is enabled.
+        */
+        bool isResourceAliasingEnabled() const { return mCompilerDeps.enableResourceAliasing; }
+
         /** Compile the graph.
         */
         bool compile(RenderContext* pRenderContext, std::string& log);
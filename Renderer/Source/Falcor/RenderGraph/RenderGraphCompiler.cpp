@@ -65,6 +65,9 @@ namespace Falcor
         }
         c.restoreCompilationChanges();
         pExe->mpResourceCache = pResourcesCache;
+
+        // Resolve the passes' resource slots now that all resources are allocated.
+        for (auto& pass : pExe->mExecutionList) pExe->resolveSlots(pass);
         return pExe;
     }
 
@@ -278,11 +281,12 @@ namespace Falcor
                 {
                     if (isResourceUsed(field) == false) continue;
 
-                    // Resource lifetime for graph outputs must extend to end of graph execution
                     bool graphOutput = mGraph.isGraphOutput({ nodeIndex, field.getName() });
-                    uint32_t lifetime = graphOutput ? uint32_t(-1) : uint32_t(i);
                     if (graphOutput && field.getBindFlags() != ResourceBindFlags::None) field.bindFlags(field.getBindFlags() | ResourceBindFlags::ShaderResource); // Adding ShaderResource for graph outputs
-                    pResourceCache->registerField(fullFieldName, field, lifetime);
+                    pResourceCache->registerField(fullFieldName, field, uint32_t(i));
+
+                    // Resource lifetime for graph outputs must extend to end of graph execution
+                    if (graphOutput) pResourceCache->extendLifetime(fullFieldName, uint32_t(-1));
                 }
             }
 
@@ -309,11 +313,17 @@ namespace Falcor
 
                 const auto& pSrcPass = mGraph.mNodeData[pEdge->getSourceNode()].pPass.get();
                 const auto& srcReflection = mExecutionList[passToIndex.at(pSrcPass)].reflector;
-                pResourceCache->registerField(dstFieldName, dstField, passToIndex[pSrcPass], srcFieldName);
+                pResourceCache->registerField(dstFieldName, dstField, uint32_t(i), srcFieldName);
             }
         }
 
-        pResourceCache->allocateResources(mDependencies.defaultResourceProps);
+        pResourceCache->allocateResources(mDependencies.defaultResourceProps, mDependencies.enableResourceAliasing);
+
+        const auto& stats = pResourceCache->getAllocationStats();
+        const double kMB = 1024.0 * 1024.0;
+        logInfo("Render graph '{}' uses {} resources for {} fields ({:.1f} MB, {:.1f} MB without aliasing, {:.1f} MB peak live, aliasing {}).", mGraph.getName(),
+            stats.resourceCount, stats.fieldCount, stats.sizeWithAliasing / kMB, stats.sizeWithoutAliasing / kMB, stats.peakLiveSize / kMB,
+            stats.aliasingEnabled ? "enabled" : "disabled");
     }
 
 
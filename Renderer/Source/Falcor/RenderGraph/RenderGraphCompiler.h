@@ -40,6 +40,7 @@ namespace Falcor
         {
             ResourceCache::DefaultProperties defaultResourceProps;
             ResourceCache::ResourcesMap externalResources;
+            bool enableResourceAliasing = false;    ///< Let fields with disjoint lifetimes share resources. Off by default, see RenderGraph::setResourceAliasingEnabled().
         };
         static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies);
 
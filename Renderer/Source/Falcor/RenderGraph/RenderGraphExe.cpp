@@ -34,11 +34,17 @@ namespace Falcor
     {
         FALCOR_PROFILE("RenderGraphExe::execute()");
 
-        for (const auto& pass : mExecutionList)
+        for (auto& pass : mExecutionList)
         {
             FALCOR_PROFILE(pass.name);
 
-            RenderData renderData(pass.name, mpResourceCache, ctx.pGraphDictionary, ctx.defaultTexDims, ctx.defaultTexFormat);
+            // Slots are resolved at compile time. Re-resolve if the pass declared new slots or external inputs were added/removed since.
+            if (pass.slotResourceIndices.size() != pass.pPass->mSlotNames.size() || pass.externalResourceVersion != mpResourceCache->getExternalResourceVersion())
+            {
+                resolveSlots(pass);
+            }
+
+            RenderData renderData(pass.name, mpResourceCache, ctx.pGraphDictionary, ctx.defaultTexDims, ctx.defaultTexFormat, &pass.slotResourceIndices);
             pass.pPass->execute(ctx.pRenderContext, renderData);
         }
     }
@@ -97,6 +103,18 @@ namespace Falcor
         mExecutionList.push_back(Pass(name, pPass));
     }
 
+    void RenderGraphExe::resolveSlots(Pass& pass) const
+    {
+        FALCOR_ASSERT(mpResourceCache);
+        const auto& slotNames = pass.pPass->mSlotNames;
+        pass.slotResourceIndices.resize(slotNames.size());
+        for (size_t i = 0; i < slotNames.size(); i++)
+        {
+            pass.slotResourceIndices[i] = mpResourceCache->getResourceIndex(pass.name + '.' + slotNames[i]);
+        }
+        pass.externalResourceVersion = mpResourceCache->getExternalResourceVersion();
+    }
+
     Resource::SharedPtr RenderGraphExe::getResource(const std::string& name) const
     {
         FALCOR_ASSERT(mpResourceCache);
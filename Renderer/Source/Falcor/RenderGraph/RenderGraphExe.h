@@ -91,11 +91,15 @@ namespace Falcor
         {
             std::string name;
             RenderPass::SharedPtr pPass;
+            std::vector<uint32_t> slotResourceIndices;          ///< Resource cache index for each slot declared by the pass.
+            uint32_t externalResourceVersion = uint32_t(-1);    ///< Version of the cache's external resources when the slots were resolved.
         private:
             friend class RenderGraphExe; // Force RenderGraphCompiler to use insertPass() by hiding this Ctor from it
             Pass(const std::string& name_, const RenderPass::SharedPtr& pPass_) : name(name_), pPass(pPass_) {}
         };
 
+        void resolveSlots(Pass& pass) const;
+
         std::vector<Pass> mExecutionList;
         ResourceCache::SharedPtr mpResourceCache;
     };
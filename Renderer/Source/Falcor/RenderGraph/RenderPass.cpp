@@ -30,9 +30,10 @@
 
 namespace Falcor
 {
-    RenderData::RenderData(const std::string& passName, const ResourceCache::SharedPtr& pResourceCache, const InternalDictionary::SharedPtr& pDict, const uint2& defaultTexDims, ResourceFormat defaultTexFormat)
+    RenderData::RenderData(const std::string& passName, const ResourceCache::SharedPtr& pResourceCache, const InternalDictionary::SharedPtr& pDict, const uint2& defaultTexDims, ResourceFormat defaultTexFormat, const std::vector<uint32_t>* pSlotResourceIndices)
         : mName(passName)
         , mpResources(pResourceCache)
+        , mpSlotResourceIndices(pSlotResourceIndices)
         , mpDictionary(pDict)
         , mDefaultTexDims(defaultTexDims)
         , mDefaultTexFormat(defaultTexFormat)
@@ -44,4 +45,13 @@ namespace Falcor
     {
         return mpResources->getResource(mName + '.' + name);
     }
+
+    RenderData::Slot RenderPass::declareSlot(const std::string& fieldName)
+    {
+        auto it = std::find(mSlotNames.begin(), mSlotNames.end(), fieldName);
+        if (it != mSlotNames.end()) return { (uint32_t)std::distance(mSlotNames.begin(), it) };
+
+        mSlotNames.push_back(fieldName);
+        return { (uint32_t)mSlotNames.size() - 1 };
+    }
 }
@@ -43,18 +43,43 @@ namespace Falcor
     class FALCOR_API RenderData
     {
     public:
+        /** Handle to a pass' resource, created with RenderPass::declareSlot().
+            The render graph resolves slots to resource indices at compile time, so looking up a resource by slot avoids building and hashing the full resource name.
+        */
+        struct Slot
+        {
+            uint32_t index = uint32_t(-1);  ///< Index into the pass' list of declared slots.
+            bool isValid() const { return index != uint32_t(-1); }
+        };
+
         /** Get a resource
             \param[in] name The name of the pass' resource (i.e. "outputColor"). No need to specify the pass' name
             \return If the name exists, a pointer to the resource. Otherwise, nullptr
         */
         const Resource::SharedPtr& operator[](const std::string& name) const { return getResource(name); }
 
+        /** Get a resource
+            \param[in] slot A slot declared by the pass using RenderPass::declareSlot().
+            \return If the resource exists, a pointer to the resource. Otherwise, nullptr
+        */
+        const Resource::SharedPtr& operator[](Slot slot) const { return getResource(slot); }
+
         /** Get a resource
             \param[in] name The name of the pass' resource (i.e. "outputColor"). No need to specify the pass' name
             \return If the name exists, a pointer to the resource. Otherwise, nullptr
         */
         const Resource::SharedPtr& getResource(const std::string& name) const;
 
+        /** Get a resource
+            \param[in] slot A slot declared by the pass using RenderPass::declareSlot().
+            \return If the resource exists, a pointer to the resource. Otherwise, nullptr
+        */
+        const Resource::SharedPtr& getResource(Slot slot) const
+        {
+            uint32_t resourceIndex = (mpSlotResourceIndices && slot.index < mpSlotResourceIndices->size()) ? (*mpSlotResourceIndices)[slot.index] : ResourceCache::kInvalidResourceIndex;
+            return mpResources->getResource(resourceIndex);
+        }
+
         /** Get the global dictionary. You can use it to pass data between different passes
         */
         InternalDictionary& getDictionary() const { return (*mpDictionary); }
@@ -72,10 +97,11 @@ namespace Falcor
         ResourceFormat getDefaultTextureFormat() const { return mDefaultTexFormat; }
 
     protected:
-        RenderData(const std::string& passName, const ResourceCache::SharedPtr& pResourceCache, const InternalDictionary::SharedPtr& pDict, const uint2& defaultTexDims, ResourceFormat defaultTexFormat);
+        RenderData(const std::string& passName, const ResourceCache::SharedPtr& pResourceCache, const InternalDictionary::SharedPtr& pDict, const uint2& defaultTexDims, ResourceFormat defaultTexFormat, const std::vector<uint32_t>* pSlotResourceIndices = nullptr);
 
         const std::string& mName;
         ResourceCache::SharedPtr mpResources;
+        const std::vector<uint32_t>* mpSlotResourceIndices;     ///< Resource cache index for each of the pass' declared slots, or nullptr if slots are not resolved.
         InternalDictionary::SharedPtr mpDictionary;
         uint2 mDefaultTexDims;
         ResourceFormat mDefaultTexFormat;
@@ -181,11 +207,23 @@ namespace Falcor
         */
         void requestRecompile() { mPassChangedCB(); }
 
+        /** Declare a slot for fast resource lookups during execute().
+            Slots are typically declared in the constructor, one per field the pass reads or writes, and the name should match the field name used in reflect().
+            Declaring the same name twice returns the same slot. A slot whose field doesn't exist in the compiled graph returns nullptr, like the string lookup.
+            \param[in] fieldName The name of the pass' field (i.e. "outputColor").
+            \return A slot that can be passed to RenderData::operator[].
+        */
+        RenderData::Slot declareSlot(const std::string& fieldName);
+
         const Info mInfo;
         std::string mName;
 
         std::function<void(void)> mPassChangedCB = [] {};
 
         friend class RenderGraph;
+        friend class RenderGraphExe;
+
+    private:
+        std::vector<std::string> mSlotNames;
     };
 }
@@ -0,0 +1,133 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "ResourceAliasingPlanner.h"
+#include <numeric>
+#include <queue>
+#include <set>
+
+namespace Falcor
+{
+    ResourceAliasingPlanner::Plan ResourceAliasingPlanner::plan(const std::vector<Request>& requests)
+    {
+        Plan plan;
+        plan.resourceIndices.resize(requests.size());
+
+        // Process requests class by class, in order of first use.
+        std::vector<uint32_t> order(requests.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+        {
+            const Request& ra = requests[a];
+            const Request& rb = requests[b];
+            return std::tie(ra.compatibilityClass, ra.firstUse, ra.lastUse, a) < std::tie(rb.compatibilityClass, rb.firstUse, rb.lastUse, b);
+        });
+
+        using LiveResource = std::pair<uint32_t, uint32_t>; // Last use and resource index.
+        std::priority_queue<LiveResource, std::vector<LiveResource>, std::greater<LiveResource>> liveResources;
+        std::set<uint32_t> freeResources;
+
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const uint32_t requestIndex = order[i];
+            const Request& request = requests[requestIndex];
+            FALCOR_ASSERT(request.firstUse <= request.lastUse);
+
+            // Start over when entering a new compatibility class.
+            if (i > 0 && requests[order[i - 1]].compatibilityClass != request.compatibilityClass)
+            {
+                liveResources = {};
+                freeResources.clear();
+            }
+
+            // Release resources whose requests ended before this one starts.
+            while (!liveResources.empty() && liveResources.top().first < request.firstUse)
+            {
+                freeResources.insert(liveResources.top().second);
+                liveResources.pop();
+            }
+
+            uint32_t resourceIndex;
+            if (request.allowAliasing && !freeResources.empty())
+            {
+                resourceIndex = *freeResources.begin();
+                freeResources.erase(freeResources.begin());
+            }
+            else
+            {
+                resourceIndex = (uint32_t)plan.resourceSizes.size();
+                plan.resourceSizes.push_back(0);
+            }
+
+            if (request.allowAliasing) liveResources.push({ request.lastUse, resourceIndex });
+
+            plan.resourceIndices[requestIndex] = resourceIndex;
+            plan.resourceSizes[resourceIndex] = std::max(plan.resourceSizes[resourceIndex], request.size);
+            plan.sizeWithoutAliasing += request.size;
+        }
+
+        // Renumber the resources in order of their first assignment to get a plan independent of the class ordering.
+        std::vector<uint32_t> remap(plan.resourceSizes.size(), std::numeric_limits<uint32_t>::max());
+        std::vector<uint64_t> resourceSizes;
+        resourceSizes.reserve(plan.resourceSizes.size());
+        for (auto& resourceIndex : plan.resourceIndices)
+        {
+            if (remap[resourceIndex] == std::numeric_limits<uint32_t>::max())
+            {
+                remap[resourceIndex] = (uint32_t)resourceSizes.size();
+                resourceSizes.push_back(plan.resourceSizes[resourceIndex]);
+            }
+            resourceIndex = remap[resourceIndex];
+        }
+        plan.resourceSizes = std::move(resourceSizes);
+
+        for (uint64_t size : plan.resourceSizes) plan.sizeWithAliasing += size;
+
+        // Sweep over the lifetimes to find the peak size of live requests. Requests end after their last use.
+        std::vector<std::pair<uint64_t, int64_t>> events;
+        events.reserve(2 * requests.size());
+        for (const Request& request : requests)
+        {
+            events.push_back({ request.firstUse, (int64_t)request.size });
+            events.push_back({ uint64_t(request.lastUse) + 1, -(int64_t)request.size });
+        }
+        std::sort(events.begin(), events.end());
+
+        int64_t liveSize = 0;
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            liveSize += events[i].second;
+            if (i + 1 == events.size() || events[i + 1].first != events[i].first)
+            {
+                plan.peakLiveSize = std::max(plan.peakLiveSize, (uint64_t)liveSize);
+            }
+        }
+
+        return plan;
+    }
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <vector>
+
+namespace Falcor
+{
+    /** Plans sharing of render graph resources between fields with non-overlapping lifetimes.
+
+        Each request describes a resource that is needed during an inclusive range of time points (typically indices into the execution order).
+        Requests can only share a resource if they belong to the same compatibility class, i.e., if they need resources with identical properties.
+        Within a class, lifetimes form an interval graph which is colored greedily in order of first use. This is optimal for interval graphs,
+        so each class uses as many resources as the largest number of its requests that are live at the same time.
+    */
+    class FALCOR_API ResourceAliasingPlanner
+    {
+    public:
+        struct Request
+        {
+            uint32_t compatibilityClass = 0;    ///< Requests can only share a resource if they are in the same compatibility class.
+            uint64_t size = 0;                  ///< Size of the resource in bytes.
+            uint32_t firstUse = 0;              ///< First time point where the resource is used.
+            uint32_t lastUse = 0;               ///< Last time point where the resource is used (inclusive).
+            bool allowAliasing = true;          ///< If false, the request is assigned a dedicated resource.
+        };
+
+        struct Plan
+        {
+            std::vector<uint32_t> resourceIndices;  ///< Index of the resource assigned to each request.
+            std::vector<uint64_t> resourceSizes;    ///< Size of each resource, the largest size of the requests assigned to it.
+            uint64_t sizeWithoutAliasing = 0;       ///< Total size if every request is assigned a dedicated resource.
+            uint64_t sizeWithAliasing = 0;          ///< Total size of the planned resources.
+            uint64_t peakLiveSize = 0;              ///< Largest total size of requests live at the same time point. A lower bound for any plan.
+
+            uint32_t getResourceCount() const { return (uint32_t)resourceSizes.size(); }
+        };
+
+        /** Assign resources to requests.
+            \param[in] requests The resource requests.
+            \return The plan. Resources are numbered in order of their first assignment.
+        */
+        static Plan plan(const std::vector<Request>& requests);
+    };
+}
@@ -27,10 +27,127 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "ResourceCache.h"
+#include "ResourceAliasingPlanner.h"
 #include "Core/API/Texture.h"
 
 namespace Falcor
 {
+    namespace
+    {
+        /** Fully resolved properties of a resource to create for a field.
+        */
+        struct ResourceDesc
+        {
+            RenderPassReflection::Field::Type type;
+            uint32_t width;
+            uint32_t height;
+            uint32_t depth;
+            uint32_t sampleCount;
+            uint32_t arraySize;
+            uint32_t mipLevels;
+            ResourceFormat format;
+            ResourceBindFlags bindFlags;
+
+            auto asTuple() const { return std::make_tuple(type, width, height, depth, sampleCount, arraySize, mipLevels, format, bindFlags); }
+            bool operator<(const ResourceDesc& other) const { return asTuple() < other.asTuple(); }
+        };
+
+        ResourceDesc resolveResourceDesc(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags)
+        {
+            ResourceDesc desc;
+            desc.type = field.getType();
+            desc.width = field.getWidth() ? field.getWidth() : params.dims.x;
+            desc.height = field.getHeight() ? field.getHeight() : params.dims.y;
+            desc.depth = field.getDepth() ? field.getDepth() : 1;
+            desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+            desc.arraySize = field.getArraySize();
+            desc.mipLevels = field.getMipCount();
+            desc.format = ResourceFormat::Unknown;
+            desc.bindFlags = field.getBindFlags();
+
+            if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
+            {
+                desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+                if (resolveBindFlags)
+                {
+                    ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+                    bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
+                    bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+                    if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
+                    auto supported = getFormatBindFlags(desc.format);
+                    mask &= supported;
+                    desc.bindFlags |= mask;
+                }
+            }
+            else // RawBuffer
+            {
+                if (resolveBindFlags) desc.bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+            }
+            return desc;
+        }
+
+        /** Estimates the memory required by a resource, ignoring alignment and padding.
+        */
+        uint64_t estimateResourceSize(const ResourceDesc& desc)
+        {
+            if (desc.type == RenderPassReflection::Field::Type::RawBuffer) return desc.width;
+
+            const bool is3D = desc.type == RenderPassReflection::Field::Type::Texture3D;
+            const uint32_t height = desc.type == RenderPassReflection::Field::Type::Texture1D ? 1 : desc.height;
+            const uint32_t depth = is3D ? desc.depth : 1;
+            const uint32_t maxMipLevels = bitScanReverse(std::max({ desc.width, height, depth })) + 1;
+            const uint32_t mipLevels = std::min(desc.mipLevels, maxMipLevels);
+
+            uint64_t size = 0;
+            for (uint32_t mip = 0; mip < mipLevels; mip++)
+            {
+                uint32_t blocksX = div_round_up(std::max(desc.width >> mip, 1u), getFormatWidthCompressionRatio(desc.format));
+                uint32_t blocksY = div_round_up(std::max(height >> mip, 1u), getFormatHeightCompressionRatio(desc.format));
+                uint32_t mipDepth = std::max(depth >> mip, 1u);
+                size += uint64_t(blocksX) * blocksY * mipDepth * getFormatBytesPerBlock(desc.format);
+            }
+
+            const uint32_t faceCount = desc.type == RenderPassReflection::Field::Type::TextureCube ? 6 : 1;
+            return size * (is3D ? 1 : desc.arraySize) * faceCount * desc.sampleCount;
+        }
+
+        Resource::SharedPtr createResource(const ResourceDesc& desc, const std::string& resourceName)
+        {
+            Resource::SharedPtr pResource;
+
+            switch (desc.type)
+            {
+            case RenderPassReflection::Field::Type::RawBuffer:
+                pResource = Buffer::create(desc.width, desc.bindFlags, Buffer::CpuAccess::None);
+                break;
+            case RenderPassReflection::Field::Type::Texture1D:
+                pResource = Texture::create1D(desc.width, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::Texture2D:
+                if (desc.sampleCount > 1)
+                {
+                    pResource = Texture::create2DMS(desc.width, desc.height, desc.format, desc.sampleCount, desc.arraySize, desc.bindFlags);
+                }
+                else
+                {
+                    pResource = Texture::create2D(desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                }
+                break;
+            case RenderPassReflection::Field::Type::Texture3D:
+                pResource = Texture::create3D(desc.width, desc.height, desc.depth, desc.format, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::TextureCube:
+                pResource = Texture::createCube(desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+                return nullptr;
+            }
+            pResource->setName(resourceName);
+            return pResource;
+        }
+    }
+
     ResourceCache::SharedPtr ResourceCache::create()
     {
         return SharedPtr(new ResourceCache());
@@ -40,22 +157,22 @@ namespace Falcor
     {
         mNameToIndex.clear();
         mResourceData.clear();
+        mAllocationStats = {};
     }
 
     const Resource::SharedPtr& ResourceCache::getResource(const std::string& name) const
     {
-        static const Resource::SharedPtr pNull;
-        auto extIt = mExternalResources.find(name);
+        return getResource(getResourceIndex(name));
+    }
 
-        // Search external resources if not found in render graph resources
-        if (extIt == mExternalResources.end())
-        {
-            const auto& it = mNameToIndex.find(name);
-            if (it == mNameToIndex.end()) return pNull;
-            return mResourceData[it->second].pResource;
-        }
+    uint32_t ResourceCache::getResourceIndex(const std::string& name) const
+    {
+        // Search external resources first, then render graph resources
+        auto extIt = mExternalNameToIndex.find(name);
+        if (extIt != mExternalNameToIndex.end()) return extIt->second | kExternalIndexBit;
 
-        return extIt->second;
+        auto it = mNameToIndex.find(name);
+        return it == mNameToIndex.end() ? kInvalidResourceIndex : it->second;
     }
 
     const RenderPassReflection::Field& ResourceCache::getResourceReflection(const std::string& name) const
@@ -66,17 +183,32 @@ namespace Falcor
 
     void ResourceCache::registerExternalResource(const std::string& name, const Resource::SharedPtr& pResource)
     {
-        if(pResource) mExternalResources[name] = pResource;
+        auto it = mExternalNameToIndex.find(name);
+        if (pResource)
+        {
+            if (it != mExternalNameToIndex.end())
+            {
+                mExternalResources[it->second] = pResource;
+            }
+            else
+            {
+                mExternalNameToIndex[name] = (uint32_t)mExternalResources.size();
+                mExternalResources.push_back(pResource);
+                mExternalResourceVersion++;
+            }
+        }
         else
         {
-            auto it = mExternalResources.find(name);
-            if (it == mExternalResources.end())
+            if (it == mExternalNameToIndex.end())
             {
                 logWarning("ResourceCache::registerExternalResource: '{}' does not exist.", name);
                 return;
             }
 
-            mExternalResources.erase(it);
+            // Keep the slot so that other indices stay valid, but release the resource.
+            mExternalResources[it->second] = nullptr;
+            mExternalNameToIndex.erase(it);
+            mExternalResourceVersion++;
         }
     }
 
@@ -86,6 +218,12 @@ namespace Falcor
         range.second = std::max(range.second, newTime);
     }
 
+    void ResourceCache::extendLifetime(const std::string& name, uint32_t timePoint)
+    {
+        uint32_t index = mNameToIndex.at(name);
+        mergeTimePoint(mResourceData[index].lifetime, timePoint);
+    }
+
     void ResourceCache::registerField(const std::string& name, const RenderPassReflection::Field& field, uint32_t timePoint, const std::string& alias)
     {
         FALCOR_ASSERT(mNameToIndex.find(name) == mNameToIndex.end());
@@ -115,78 +253,62 @@ namespace Falcor
         }
     }
 
-    Resource::SharedPtr createResourceForPass(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags, const std::string& resourceName)
+    void ResourceCache::allocateResources(const DefaultProperties& params, bool enableAliasing)
     {
-        uint32_t width = field.getWidth() ? field.getWidth() : params.dims.x;
-        uint32_t height = field.getHeight() ? field.getHeight() : params.dims.y;
-        uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-        uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-        auto bindFlags = field.getBindFlags();
-        auto arraySize = field.getArraySize();
-        auto mipLevels = field.getMipCount();
+        // Gather the fields that need a resource. Fields with identical resource properties form a compatibility class.
+        std::vector<uint32_t> dataIndices;
+        std::vector<ResourceDesc> descs;
+        std::vector<ResourceAliasingPlanner::Request> requests;
+        std::map<ResourceDesc, uint32_t> descToClass;
 
-        ResourceFormat format = ResourceFormat::Unknown;
-
-        if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
-        {
-            format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
-            if (resolveBindFlags)
-            {
-                ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
-                bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
-                bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
-                if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
-                auto supported = getFormatBindFlags(format);
-                mask &= supported;
-                bindFlags |= mask;
-            }
-        }
-        else // RawBuffer
+        for (uint32_t i = 0; i < (uint32_t)mResourceData.size(); i++)
         {
-            if (resolveBindFlags) bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+            const auto& data = mResourceData[i];
+            if ((data.pResource != nullptr) || (data.field.isValid() == false)) continue;
+
+            ResourceDesc desc = resolveResourceDesc(params, data.field, data.resolveBindFlags);
+            auto classIt = descToClass.emplace(desc, (uint32_t)descToClass.size()).first;
+
+            // Persistent fields must keep their contents between executions, and internal fields are owned by a single pass which may rely on that too.
+            bool isPersistent = is_set(data.field.getFlags(), RenderPassReflection::Field::Flags::Persistent);
+            bool isInternal = is_set(data.field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+
+            ResourceAliasingPlanner::Request request;
+            request.compatibilityClass = classIt->second;
+            request.size = estimateResourceSize(desc);
+            request.firstUse = data.lifetime.first;
+            request.lastUse = data.lifetime.second;
+            request.allowAliasing = enableAliasing && !isPersistent && !isInternal;
+
+            dataIndices.push_back(i);
+            descs.push_back(desc);
+            requests.push_back(request);
         }
-        Resource::SharedPtr pResource;
 
-        switch (field.getType())
+        // Create one resource per planned resource and share it between all fields assigned to it.
+        ResourceAliasingPlanner::Plan plan = ResourceAliasingPlanner::plan(requests);
+
+        std::vector<std::string> resourceNames(plan.getResourceCount());
+        for (size_t r = 0; r < requests.size(); r++)
         {
-        case RenderPassReflection::Field::Type::RawBuffer:
-            pResource = Buffer::create(width, bindFlags, Buffer::CpuAccess::None);
-            break;
-        case RenderPassReflection::Field::Type::Texture1D:
-            pResource = Texture::create1D(width, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::Texture2D:
-            if (sampleCount > 1)
-            {
-                pResource = Texture::create2DMS(width, height, format, sampleCount, arraySize, bindFlags);
-            }
-            else
-            {
-                pResource = Texture::create2D(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
-            }
-            break;
-        case RenderPassReflection::Field::Type::Texture3D:
-            pResource = Texture::create3D(width, height, depth, format, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::TextureCube:
-            pResource = Texture::createCube(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        default:
-            FALCOR_UNREACHABLE();
-            return nullptr;
+            std::string& resourceName = resourceNames[plan.resourceIndices[r]];
+            if (!resourceName.empty()) resourceName += ", ";
+            resourceName += mResourceData[dataIndices[r]].name;
         }
-        pResource->setName(resourceName);
-        return pResource;
-    }
 
-    void ResourceCache::allocateResources(const DefaultProperties& params)
-    {
-        for (auto& data : mResourceData)
+        std::vector<Resource::SharedPtr> resources(plan.getResourceCount());
+        for (size_t r = 0; r < requests.size(); r++)
         {
-            if ((data.pResource == nullptr) && (data.field.isValid()))
-            {
-                data.pResource = createResourceForPass(params, data.field, data.resolveBindFlags, data.name);
-            }
+            uint32_t resourceIndex = plan.resourceIndices[r];
+            if (!resources[resourceIndex]) resources[resourceIndex] = createResource(descs[r], resourceNames[resourceIndex]);
+            mResourceData[dataIndices[r]].pResource = resources[resourceIndex];
         }
+
+        mAllocationStats.fieldCount = (uint32_t)requests.size();
+        mAllocationStats.resourceCount = plan.getResourceCount();
+        mAllocationStats.sizeWithoutAliasing = plan.sizeWithoutAliasing;
+        mAllocationStats.sizeWithAliasing = plan.sizeWithAliasing;
+        mAllocationStats.peakLiveSize = plan.peakLiveSize;
+        mAllocationStats.aliasingEnabled = enableAliasing;
     }
 }
@@ -37,6 +37,8 @@ namespace Falcor
         using SharedPtr = std::shared_ptr<ResourceCache>;
         using ResourcesMap = std::unordered_map<std::string, Resource::SharedPtr>;
 
+        static constexpr uint32_t kInvalidResourceIndex = uint32_t(-1);
+
         /** Create a new object
         */
         static SharedPtr create();
@@ -64,18 +66,65 @@ namespace Falcor
         */
         void registerField(const std::string& name, const RenderPassReflection::Field& field, uint32_t timePoint, const std::string& alias = "");
 
+        /** Extend the lifetime of a registered field to include a time point.
+            \param[in] name The name of a registered field.
+            \param[in] timePoint The point in time to include. Use uint32_t(-1) to keep the resource alive until the end of graph execution.
+        */
+        void extendLifetime(const std::string& name, uint32_t timePoint);
+
         /** Get a resource by name. Includes external resources known by the cache.
         */
         const Resource::SharedPtr& getResource(const std::string& name) const;
 
+        /** Get the index of a resource, for fast repeated lookups using getResource(uint32_t). Includes external resources known by the cache.
+            Indices remain valid until the cache is reset or the set of external resource names changes (see getExternalResourceVersion()).
+            \return The resource index, or kInvalidResourceIndex if the name is unknown.
+        */
+        uint32_t getResourceIndex(const std::string& name) const;
+
+        /** Get a resource by index.
+            \param[in] index A resource index returned by getResourceIndex().
+            \return The resource, or nullptr if the index is kInvalidResourceIndex.
+        */
+        const Resource::SharedPtr& getResource(uint32_t index) const
+        {
+            static const Resource::SharedPtr pNull;
+            if (index == kInvalidResourceIndex) return pNull;
+            if (index & kExternalIndexBit) return mExternalResources[index & ~kExternalIndexBit];
+            return mResourceData[index].pResource;
+        }
+
+        /** Get a counter that is incremented whenever the set of external resource names changes, which invalidates resource indices.
+        */
+        uint32_t getExternalResourceVersion() const { return mExternalResourceVersion; }
+
         /** Get the field-reflection of a resource
         */
         const RenderPassReflection::Field& getResourceReflection(const std::string& name) const;
 
+        /** Statistics from the last call to allocateResources().
+        */
+        struct AllocationStats
+        {
+            uint32_t fieldCount = 0;                ///< Number of fields that required a resource.
+            uint32_t resourceCount = 0;             ///< Number of resources created for these fields.
+            uint64_t sizeWithoutAliasing = 0;       ///< Estimated memory in bytes if every field had a dedicated resource.
+            uint64_t sizeWithAliasing = 0;          ///< Estimated memory in bytes of the created resources.
+            uint64_t peakLiveSize = 0;              ///< Estimated memory in bytes of the fields that are live at the same time, at the worst time point. A lower bound for sizeWithAliasing.
+            bool aliasingEnabled = false;           ///< True if fields were allowed to share resources.
+        };
+
         /** Allocate all resources that need to be created/updated.
             This includes new resources, resources whose properties have been updated since last allocation call.
+            If aliasing is enabled, fields with identical resource properties and non-overlapping lifetimes share a resource, unless they are persistent or internal.
+            \param[in] params Default resource properties.
+            \param[in] enableAliasing If true, fields may share resources. Otherwise every field gets a dedicated resource.
+        */
+        void allocateResources(const DefaultProperties& params, bool enableAliasing = false);
+
+        /** Get statistics from the last call to allocateResources().
         */
-        void allocateResources(const DefaultProperties& params);
+        const AllocationStats& getAllocationStats() const { return mAllocationStats; }
 
         /** Clears all registered field/resource properties and allocated resources.
         */
@@ -97,8 +146,14 @@ namespace Falcor
         std::unordered_map<std::string, uint32_t> mNameToIndex;
         std::vector<ResourceData> mResourceData;
 
-        // References to output resources not to be allocated by the render graph
-        ResourcesMap mExternalResources;
+        // References to output resources not to be allocated by the render graph.
+        // Indices of external resources are marked with kExternalIndexBit.
+        static constexpr uint32_t kExternalIndexBit = 0x80000000u;
+        std::unordered_map<std::string, uint32_t> mExternalNameToIndex;
+        std::vector<Resource::SharedPtr> mExternalResources;
+        uint32_t mExternalResourceVersion = 0;
+
+        AllocationStats mAllocationStats;
     };
 
 }
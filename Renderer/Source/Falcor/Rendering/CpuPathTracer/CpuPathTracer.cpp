@@ -0,0 +1,1115 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "CpuPathTracer.h"
+#include "Scene/Material/BasicMaterial.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Math/MathHelpers.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/NumericRange.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "glm/gtx/euler_angles.hpp"
+#include <algorithm>
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kPi = (float)M_PI;
+        const float kMinCosTheta = 1e-6f;
+        const float kMinGGXAlpha = 0.0064f;     ///< Same clamp as the GPU BSDF to avoid numerical issues with near-specular GGX.
+
+        uint32_t pcgHash(uint32_t v)
+        {
+            uint32_t state = v * 747796405u + 2891336453u;
+            uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+            return (word >> 22u) ^ word;
+        }
+
+        bool isBlack(const float3& v)
+        {
+            return v.x == 0.f && v.y == 0.f && v.z == 0.f;
+        }
+
+        float3 transformPoint(const float4x4& m, const float3& p)
+        {
+            return float3(m * float4(p, 1.f));
+        }
+
+        float3 transformVector(const float4x4& m, const float3& v)
+        {
+            return float3(m * float4(v, 0.f));
+        }
+
+        float powerHeuristic(float pdfA, float pdfB)
+        {
+            float a = pdfA * pdfA;
+            float b = pdfB * pdfB;
+            return a + b > 0.f ? a / (a + b) : 0.f;
+        }
+
+        /** Offset a ray origin along the normal to avoid self-intersection (see computeRayOrigin in GeometryHelpers.slang).
+        */
+        float3 computeRayOrigin(const float3& pos, const float3& normal)
+        {
+            const float origin = 1.f / 32.f;
+            const float fScale = 1.f / 65536.f;
+            const float iScale = 256.f;
+
+            float3 result;
+            for (int i = 0; i < 3; i++)
+            {
+                int32_t iOff = (int32_t)(normal[i] * iScale);
+                float iPos = asfloat(asint(pos[i]) + (pos[i] < 0.f ? -iOff : iOff));
+                result[i] = std::abs(pos[i]) < origin ? pos[i] + normal[i] * fScale : iPos;
+            }
+            return result;
+        }
+
+        float2 sampleDiskConcentric(float2 u)
+        {
+            u = 2.f * u - 1.f;
+            if (u.x == 0.f && u.y == 0.f) return u;
+            float phi, r;
+            if (std::abs(u.x) > std::abs(u.y))
+            {
+                r = u.x;
+                phi = (u.y / u.x) * (kPi / 4.f);
+            }
+            else
+            {
+                r = u.y;
+                phi = kPi / 2.f - (u.x / u.y) * (kPi / 4.f);
+            }
+            return r * float2(std::cos(phi), std::sin(phi));
+        }
+
+        float3 sampleCosineHemisphere(float2 u)
+        {
+            float2 d = sampleDiskConcentric(u);
+            return float3(d, std::sqrt(std::max(0.f, 1.f - dot(d, d))));
+        }
+
+        float evalNdfGGX(float alpha, float cosTheta)
+        {
+            float a2 = alpha * alpha;
+            float d = ((cosTheta * a2 - cosTheta) * cosTheta + 1.f);
+            return a2 / (d * d * kPi);
+        }
+
+        float evalLambdaGGX(float alpha, float cosTheta)
+        {
+            if (cosTheta <= 0.f) return 0.f;
+            float cos2 = cosTheta * cosTheta;
+            float tan2 = std::max(1.f - cos2, 0.f) / cos2;
+            return 0.5f * (-1.f + std::sqrt(1.f + alpha * alpha * tan2));
+        }
+
+        float evalMaskingSmithGGX(float alpha, float cosTheta)
+        {
+            return 1.f / (1.f + evalLambdaGGX(alpha, cosTheta));
+        }
+
+        /** Height-correlated masking-shadowing function.
+        */
+        float evalG2SmithGGX(float alpha, float cosThetaI, float cosThetaO)
+        {
+            return 1.f / (1.f + evalLambdaGGX(alpha, cosThetaI) + evalLambdaGGX(alpha, cosThetaO));
+        }
+
+        /** Sample the distribution of visible normals [Heitz 2018].
+        */
+        float3 sampleGGXVNDF(float alpha, const float3& wo, float2 u)
+        {
+            float3 Vh = normalize(float3(alpha * wo.x, alpha * wo.y, wo.z));
+            float lenSqr = Vh.x * Vh.x + Vh.y * Vh.y;
+            float3 T1 = lenSqr > 0.f ? float3(-Vh.y, Vh.x, 0.f) / std::sqrt(lenSqr) : float3(1.f, 0.f, 0.f);
+            float3 T2 = cross(Vh, T1);
+
+            float r = std::sqrt(u.x);
+            float phi = 2.f * kPi * u.y;
+            float t1 = r * std::cos(phi);
+            float t2 = r * std::sin(phi);
+            float s = 0.5f * (1.f + Vh.z);
+            t2 = (1.f - s) * std::sqrt(std::max(0.f, 1.f - t1 * t1)) + s * t2;
+
+            float3 Nh = t1 * T1 + t2 * T2 + std::sqrt(std::max(0.f, 1.f - t1 * t1 - t2 * t2)) * Vh;
+            return normalize(float3(alpha * Nh.x, alpha * Nh.y, std::max(0.f, Nh.z)));
+        }
+
+        float3 evalFresnelSchlick(const float3& F0, float cosTheta)
+        {
+            float m = std::clamp(1.f - cosTheta, 0.f, 1.f);
+            float m5 = m * m * m * m * m;
+            return F0 + (float3(1.f) - F0) * m5;
+        }
+
+        /** Fresnel reflectance of an unpolarized dielectric interface.
+            \param[in] eta Relative index of refraction (incident / transmitted).
+            \param[in] cosThetaI Cosine of the incident angle (positive).
+            \param[out] cosThetaT Cosine of the transmitted angle (positive), or 0 on total internal reflection.
+        */
+        float evalFresnelDielectric(float eta, float cosThetaI, float& cosThetaT)
+        {
+            float sin2ThetaT = eta * eta * (1.f - cosThetaI * cosThetaI);
+            if (sin2ThetaT >= 1.f)
+            {
+                cosThetaT = 0.f;
+                return 1.f;
+            }
+            cosThetaT = std::sqrt(1.f - sin2ThetaT);
+            float rs = (eta * cosThetaI - cosThetaT) / (eta * cosThetaI + cosThetaT);
+            float rp = (cosThetaI - eta * cosThetaT) / (cosThetaI + eta * cosThetaT);
+            return 0.5f * (rs * rs + rp * rp);
+        }
+
+        /** Decode a bitmap to linear RGBA float texels.
+            Single and dual channel formats are expanded with zeros like a GPU texture fetch.
+        */
+        bool decodeBitmap(const Bitmap& bitmap, bool isSrgb, std::vector<float4>& texels)
+        {
+            const uint32_t width = bitmap.getWidth();
+            const uint32_t height = bitmap.getHeight();
+            texels.resize((size_t)width * height);
+
+            auto decode8 = [isSrgb](float r, float g, float b, float a)
+            {
+                float3 rgb = float3(r, g, b) * (1.f / 255.f);
+                if (isSrgb) rgb = sRGBToLinear(rgb);
+                return float4(rgb, a * (1.f / 255.f));
+            };
+
+            for (uint32_t y = 0; y < height; y++)
+            {
+                const uint8_t* pRow = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+                float4* pDst = texels.data() + (size_t)y * width;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    switch (bitmap.getFormat())
+                    {
+                    case ResourceFormat::RGBA32Float:
+                    {
+                        const float* p = reinterpret_cast<const float*>(pRow) + 4 * x;
+                        pDst[x] = float4(p[0], p[1], p[2], p[3]);
+                        break;
+                    }
+                    case ResourceFormat::RGB32Float:
+                    {
+                        const float* p = reinterpret_cast<const float*>(pRow) + 3 * x;
+                        pDst[x] = float4(p[0], p[1], p[2], 1.f);
+                        break;
+                    }
+                    case ResourceFormat::RGBA16Float:
+                    {
+                        const uint16_t* p = reinterpret_cast<const uint16_t*>(pRow) + 4 * x;
+                        pDst[x] = float4(f16tof32(p[0]), f16tof32(p[1]), f16tof32(p[2]), f16tof32(p[3]));
+                        break;
+                    }
+                    case ResourceFormat::RGB16Float:
+                    {
+                        const uint16_t* p = reinterpret_cast<const uint16_t*>(pRow) + 3 * x;
+                        pDst[x] = float4(f16tof32(p[0]), f16tof32(p[1]), f16tof32(p[2]), 1.f);
+                        break;
+                    }
+                    case ResourceFormat::BGRA8Unorm:
+                    {
+                        const uint8_t* p = pRow + 4 * x;
+                        pDst[x] = decode8(p[2], p[1], p[0], p[3]);
+                        break;
+                    }
+                    case ResourceFormat::BGRX8Unorm:
+                    {
+                        const uint8_t* p = pRow + 4 * x;
+                        pDst[x] = decode8(p[2], p[1], p[0], 255.f);
+                        break;
+                    }
+                    case ResourceFormat::R16Unorm:
+                    {
+                        const uint16_t* p = reinterpret_cast<const uint16_t*>(pRow) + x;
+                        pDst[x] = float4(p[0] * (1.f / 65535.f), 0.f, 0.f, 1.f);
+                        break;
+                    }
+                    case ResourceFormat::RG8Unorm:
+                    {
+                        const uint8_t* p = pRow + 2 * x;
+                        pDst[x] = float4(p[0] * (1.f / 255.f), p[1] * (1.f / 255.f), 0.f, 1.f);
+                        break;
+                    }
+                    case ResourceFormat::R8Unorm:
+                    {
+                        pDst[x] = float4(pRow[x] * (1.f / 255.f), 0.f, 0.f, 1.f);
+                        break;
+                    }
+                    default:
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    /** Random number generator. The state is derived from the pixel and sample index only.
+    */
+    struct CpuPathTracer::SampleGenerator
+    {
+        uint32_t state;
+
+        SampleGenerator(uint32_t pixelIndex, uint32_t sampleIndex, uint32_t seed)
+            : state(pcgHash(pixelIndex ^ pcgHash(sampleIndex ^ pcgHash(seed))))
+        {}
+
+        float next1D()
+        {
+            state = state * 747796405u + 2891336453u;
+            uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+            word = (word >> 22u) ^ word;
+            return (word >> 8) * (1.f / 16777216.f);
+        }
+
+        float2 next2D()
+        {
+            float x = next1D();
+            float y = next1D();
+            return float2(x, y);
+        }
+    };
+
+    struct CpuPathTracer::ShadingPoint
+    {
+        float3 posW;
+        float3 V;                   ///< Direction to the viewer.
+        float3 N;                   ///< Shading normal.
+        float3 faceN;               ///< Face normal, flipped to the same side as the shading normal.
+        float2 uv;
+        uint32_t triangleIndex;
+        uint32_t materialID;
+        bool frontFacing;
+    };
+
+    /** Standard BSDF with a Lambertian diffuse lobe, a GGX specular lobe and a smooth dielectric transmission lobe.
+    */
+    struct CpuPathTracer::BSDF
+    {
+        float3 diffuse = float3(0.f);           ///< Diffuse albedo, already weighted by (1 - specular transmission).
+        float3 F0 = float3(0.f);                ///< Specular reflectance at normal incidence.
+        float3 transmission = float3(0.f);      ///< Transmission tint.
+        float alpha = 1.f;                      ///< GGX width parameter.
+        float specularReflection = 1.f;         ///< Weight of the specular reflection lobe.
+        float specularTransmission = 0.f;       ///< Weight of the dielectric transmission lobe.
+        float eta = 1.f;                        ///< Relative index of refraction (incident / transmitted).
+        float pDiffuse = 0.f;
+        float pSpecular = 0.f;
+        float pTransmission = 0.f;
+        float3 T, B, N;
+
+        float3 toLocal(const float3& v) const { return float3(dot(v, T), dot(v, B), dot(v, N)); }
+        float3 fromLocal(const float3& v) const { return T * v.x + B * v.y + N * v.z; }
+
+        bool hasLobes() const { return pDiffuse + pSpecular + pTransmission > 0.f; }
+        bool hasNonDeltaLobes() const { return pDiffuse + pSpecular > 0.f; }
+
+        /** Evaluate the non-delta lobes times the cosine term.
+            \param[in] wo Outgoing (view) direction in world space.
+            \param[in] wi Incident (light) direction in world space.
+            \param[out] pdf Sampling pdf of wi with respect to solid angle.
+        */
+        float3 eval(const float3& wo, const float3& wi, float& pdf) const
+        {
+            return evalLocal(toLocal(wo), toLocal(wi), pdf);
+        }
+
+        float3 evalLocal(const float3& wo, const float3& wi, float& pdf) const
+        {
+            pdf = 0.f;
+            if (wo.z < kMinCosTheta || wi.z < kMinCosTheta) return float3(0.f);
+
+            float3 f = diffuse * (wi.z / kPi);
+            pdf = pDiffuse * wi.z / kPi;
+
+            if (pSpecular > 0.f)
+            {
+                float3 h = normalize(wo + wi);
+                float woDotH = dot(wo, h);
+                float D = evalNdfGGX(alpha, h.z);
+                float G = evalG2SmithGGX(alpha, wo.z, wi.z);
+                float3 F = evalFresnelSchlick(F0, woDotH);
+                f += specularReflection * F * (D * G / (4.f * wo.z));
+                pdf += pSpecular * D * evalMaskingSmithGGX(alpha, wo.z) / (4.f * wo.z);
+            }
+            return f;
+        }
+
+        /** Sample an incident direction.
+            \param[in] wo Outgoing (view) direction in world space.
+            \param[in] sg Sample generator.
+            \param[out] wi Incident direction in world space.
+            \param[out] weight Sample weight (BSDF times cosine divided by pdf).
+            \param[out] pdf Sampling pdf, zero for delta lobes.
+            \param[out] isDelta True if a delta lobe was sampled.
+            \return True if a sample was generated.
+        */
+        bool sample(const float3& wo, SampleGenerator& sg, float3& wi, float3& weight, float& pdf, bool& isDelta) const
+        {
+            const float3 woLocal = toLocal(wo);
+            float lobe = sg.next1D();
+            float2 u = sg.next2D();
+            float3 wiLocal;
+
+            if (lobe < pTransmission)
+            {
+                // Smooth dielectric: choose between reflection and refraction by the Fresnel term.
+                if (woLocal.z < kMinCosTheta) return false;
+                float cosThetaT;
+                float F = evalFresnelDielectric(eta, woLocal.z, cosThetaT);
+                if (u.x < F)
+                {
+                    wiLocal = float3(-woLocal.x, -woLocal.y, woLocal.z);
+                    weight = float3(specularTransmission / pTransmission);
+                }
+                else
+                {
+                    wiLocal = -eta * woLocal + float3(0.f, 0.f, eta * woLocal.z - cosThetaT);
+                    weight = transmission * (specularTransmission / pTransmission);
+                }
+                wi = normalize(fromLocal(wiLocal));
+                pdf = 0.f;
+                isDelta = true;
+                return true;
+            }
+
+            if (lobe < pTransmission + pDiffuse)
+            {
+                wiLocal = sampleCosineHemisphere(u);
+            }
+            else
+            {
+                if (woLocal.z < kMinCosTheta) return false;
+                float3 h = sampleGGXVNDF(alpha, woLocal, u);
+                wiLocal = 2.f * dot(woLocal, h) * h - woLocal;
+            }
+
+            float3 f = evalLocal(woLocal, wiLocal, pdf);
+            if (pdf <= 0.f) return false;
+
+            wi = fromLocal(wiLocal);
+            weight = f / pdf;
+            isDelta = false;
+            return true;
+        }
+    };
+
+    float4 CpuPathTracer::TextureData::sample(float2 uv) const
+    {
+        if (!std::isfinite(uv.x) || !std::isfinite(uv.y)) return texels[0];
+
+        float x = (uv.x - std::floor(uv.x)) * width - 0.5f;
+        float y = (uv.y - std::floor(uv.y)) * height - 0.5f;
+        float fx = std::floor(x);
+        float fy = std::floor(y);
+        float tx = x - fx;
+        float ty = y - fy;
+
+        auto wrap = [](int i, uint32_t n) { return (uint32_t)(i < 0 ? i + (int)n : (i >= (int)n ? i - (int)n : i)); };
+        uint32_t x0 = wrap((int)fx, width), x1 = wrap((int)fx + 1, width);
+        uint32_t y0 = wrap((int)fy, height), y1 = wrap((int)fy + 1, height);
+
+        const float4& t00 = texels[(size_t)y0 * width + x0];
+        const float4& t10 = texels[(size_t)y0 * width + x1];
+        const float4& t01 = texels[(size_t)y1 * width + x0];
+        const float4& t11 = texels[(size_t)y1 * width + x1];
+        return glm::mix(glm::mix(t00, t10, tx), glm::mix(t01, t11, tx), ty);
+    }
+
+    CpuPathTracer::SharedPtr CpuPathTracer::create(const Scene::SceneData& sceneData, const Options& options)
+    {
+        return SharedPtr(new CpuPathTracer(sceneData, options));
+    }
+
+    CpuPathTracer::CpuPathTracer(const Scene::SceneData& sceneData, const Options& options)
+        : mOptions(options)
+    {
+        checkArgument(options.frameDim.x > 0 && options.frameDim.y > 0, "'frameDim' must be non-zero");
+        checkArgument(options.tileSize > 0, "'tileSize' must be non-zero");
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        setupMaterials(sceneData);
+        setupGeometry(sceneData);
+        setupLights(sceneData);
+        setupCamera(sceneData);
+        reset();
+
+        logInfo("CpuPathTracer: Prepared {} triangles, {} emissive triangles, {} analytic lights and {} textures in {:.2f} ms (BVH {:.1f} MB).",
+            mTriangles.size(), mEmissiveTriangles.size(), mLights.size(), mTextures.size(),
+            CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()), mBVH.getMemoryUsageInBytes() / (1024.0 * 1024.0));
+    }
+
+    void CpuPathTracer::setupMaterials(const Scene::SceneData& sceneData)
+    {
+        if (!sceneData.pMaterials) return;
+
+        for (const auto& pMaterial : sceneData.pMaterials->getMaterials())
+        {
+            MaterialParams m;
+            m.isDoubleSided = pMaterial->isDoubleSided();
+            m.isAlphaTested = pMaterial->getAlphaMode() == AlphaMode::Mask;
+            m.alphaThreshold = pMaterial->getAlphaThreshold();
+
+            if (auto pBasicMaterial = pMaterial->toBasicMaterial())
+            {
+                m.baseColor = pBasicMaterial->getBaseColor();
+                m.specular = pBasicMaterial->getSpecularParams();
+                m.transmission = pBasicMaterial->getTransmissionColor();
+                m.specularTransmission = pBasicMaterial->getSpecularTransmission();
+                m.ior = pBasicMaterial->getIndexOfRefraction();
+                m.baseColorTexture = loadTexture(pBasicMaterial->getBaseColorTexture());
+                m.specularTexture = loadTexture(pBasicMaterial->getSpecularTexture());
+                m.transmissionTexture = loadTexture(pBasicMaterial->getTransmissionTexture());
+
+                if (pMaterial->getType() == MaterialType::Standard)
+                {
+                    auto pStandardMaterial = std::static_pointer_cast<StandardMaterial>(pBasicMaterial);
+                    m.isSpecGloss = pStandardMaterial->getShadingModel() == ShadingModel::SpecGloss;
+                    m.emissive = pStandardMaterial->getEmissiveColor();
+                    m.emissiveFactor = pStandardMaterial->getEmissiveFactor();
+                    m.emissiveTexture = loadTexture(pStandardMaterial->getEmissiveTexture());
+                    m.isEmissive = pMaterial->isEmissive();
+                }
+                else
+                {
+                    logWarning("CpuPathTracer: Material '{}' of type '{}' is approximated by the standard material model.", pMaterial->getName(), to_string(pMaterial->getType()));
+                }
+            }
+            else
+            {
+                logWarning("CpuPathTracer: Material '{}' of type '{}' is not supported. Using a grey diffuse material instead.", pMaterial->getName(), to_string(pMaterial->getType()));
+            }
+
+            mHasAlphaTest |= m.isAlphaTested;
+            mMaterials.push_back(m);
+        }
+    }
+
+    uint32_t CpuPathTracer::loadTexture(const Texture::SharedPtr& pTexture)
+    {
+        if (!pTexture) return kInvalidIndex;
+
+        const auto& path = pTexture->getSourcePath();
+        if (path.empty())
+        {
+            logWarning("CpuPathTracer: Texture '{}' has no source file and is ignored.", pTexture->getName());
+            return kInvalidIndex;
+        }
+
+        auto key = std::make_pair(path, isSrgbFormat(pTexture->getFormat()));
+        if (auto it = mTextureIndices.find(key); it != mTextureIndices.end()) return it->second;
+
+        uint32_t index = kInvalidIndex;
+        TextureData texture;
+        if (auto pBitmap = Bitmap::createFromFile(path, true))
+        {
+            texture.width = pBitmap->getWidth();
+            texture.height = pBitmap->getHeight();
+            if (texture.width > 0 && texture.height > 0 && decodeBitmap(*pBitmap, key.second, texture.texels))
+            {
+                double sum = 0.0;
+                for (const auto& t : texture.texels) sum += luminance(float3(t));
+                texture.averageLuminance = (float)(sum / texture.texels.size());
+                index = (uint32_t)mTextures.size();
+                mTextures.push_back(std::move(texture));
+            }
+            else
+            {
+                logWarning("CpuPathTracer: Texture '{}' has unsupported format '{}' and is ignored.", path, to_string(pBitmap->getFormat()));
+            }
+        }
+        else
+        {
+            logWarning("CpuPathTracer: Failed to load texture '{}'. It is ignored.", path);
+        }
+
+        mTextureIndices[key] = index;
+        return index;
+    }
+
+    void CpuPathTracer::setupGeometry(const Scene::SceneData& sceneData)
+    {
+        if (!sceneData.curveInstanceData.empty() || !sceneData.sdfGridInstances.empty() || !sceneData.customPrimitiveDesc.empty() || !sceneData.gridVolumes.empty())
+        {
+            logWarning("CpuPathTracer: Curves, SDF grids, custom primitives and volumes are not supported and are ignored.");
+        }
+
+        // Compute global transforms. Parent nodes are always stored before their children.
+        const auto& sceneGraph = sceneData.sceneGraph;
+        std::vector<float4x4> globalMatrices(sceneGraph.size());
+        for (size_t i = 0; i < sceneGraph.size(); i++)
+        {
+            const auto& node = sceneGraph[i];
+            FALCOR_ASSERT(node.parent == Scene::kInvalidNode || node.parent < i);
+            globalMatrices[i] = node.parent == Scene::kInvalidNode ? node.transform : globalMatrices[node.parent] * node.transform;
+        }
+
+        // Collect triangle mesh instances and compute their offsets in the flattened triangle list.
+        std::vector<uint32_t> instances;
+        std::vector<uint32_t> triangleOffsets;
+        uint32_t triangleCount = 0;
+        bool hasSkinnedMeshes = false;
+        for (uint32_t i = 0; i < (uint32_t)sceneData.meshInstanceData.size(); i++)
+        {
+            const auto& instance = sceneData.meshInstanceData[i];
+            if (instance.getType() != GeometryType::TriangleMesh && instance.getType() != GeometryType::DisplacedTriangleMesh) continue;
+            const auto& mesh = sceneData.meshDesc[instance.geometryID];
+            hasSkinnedMeshes |= mesh.isSkinned();
+            instances.push_back(i);
+            triangleOffsets.push_back(triangleCount);
+            triangleCount += mesh.getTriangleCount();
+        }
+        if (hasSkinnedMeshes) logWarning("CpuPathTracer: Skinned meshes are rendered in their bind pose.");
+
+        mPositions.resize((size_t)triangleCount * 3);
+        mTriangles.resize(triangleCount);
+
+        // Transform all instances to world space.
+        auto range = NumericRange<size_t>(0, instances.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            const auto& instance = sceneData.meshInstanceData[instances[i]];
+            const auto& mesh = sceneData.meshDesc[instance.geometryID];
+            const float4x4& worldMat = globalMatrices[instance.globalMatrixID];
+            const float3x3 normalMat = glm::inverse(glm::transpose(float3x3(worldMat)));
+            const bool use16BitIndices = mesh.use16BitIndices();
+            const uint32_t* pIndices = mesh.indexCount > 0 ? &sceneData.meshIndexData[mesh.ibOffset] : nullptr;
+
+            for (uint32_t t = 0; t < mesh.getTriangleCount(); t++)
+            {
+                uint32_t triangleIndex = triangleOffsets[i] + t;
+                TriangleData& tri = mTriangles[triangleIndex];
+                float3* p = &mPositions[(size_t)triangleIndex * 3];
+
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    uint32_t index = 3 * t + k;
+                    if (pIndices) index = use16BitIndices ? reinterpret_cast<const uint16_t*>(pIndices)[index] : pIndices[index];
+                    const PackedStaticVertexData& v = sceneData.meshStaticData[mesh.vbOffset + index];
+
+                    // Unpack the normal (see PackedStaticVertexData::pack).
+                    float2 nxy = glm::unpackHalf2x16(asuint(v.packedNormalTangentCurveRadius.x));
+                    float2 nzw = glm::unpackHalf2x16(asuint(v.packedNormalTangentCurveRadius.y));
+
+                    p[k] = transformPoint(worldMat, v.position);
+                    tri.normals[k] = normalMat * float3(nxy.x, nxy.y, nzw.x);
+                    tri.texCrds[k] = v.texCrd;
+                }
+
+                // Compute the face normal. Flip it depending on the final winding order in world space.
+                float3 N = cross(p[1] - p[0], p[2] - p[0]);
+                float len = glm::length(N);
+                tri.area = 0.5f * len;
+                tri.faceNormal = len > 0.f ? N / len : float3(0.f, 0.f, 1.f);
+                if (instance.isWorldFrontFaceCW()) tri.faceNormal = -tri.faceNormal;
+                tri.materialID = instance.materialID;
+            }
+        });
+
+        mBVH.build(mPositions.data(), triangleCount);
+    }
+
+    void CpuPathTracer::setupLights(const Scene::SceneData& sceneData)
+    {
+        // Analytic lights.
+        for (const auto& pLight : sceneData.lights)
+        {
+            if (pLight->isActive()) mLights.push_back(pLight->getData());
+        }
+
+        // Emissive triangles, sampled proportional to their approximate power.
+        std::vector<float> weights;
+        for (uint32_t i = 0; i < (uint32_t)mTriangles.size(); i++)
+        {
+            TriangleData& tri = mTriangles[i];
+            if (tri.materialID >= mMaterials.size()) continue;
+            const MaterialParams& m = mMaterials[tri.materialID];
+            if (!m.isEmissive) continue;
+
+            float radiance = m.emissiveTexture != kInvalidIndex ? mTextures[m.emissiveTexture].averageLuminance : luminance(m.emissive);
+            float weight = tri.area * radiance * m.emissiveFactor;
+            if (!(weight > 0.f)) continue;
+
+            tri.emissiveIndex = (uint32_t)mEmissiveTriangles.size();
+            mEmissiveTriangles.push_back(i);
+            weights.push_back(weight);
+        }
+
+        if (!weights.empty())
+        {
+            double total = 0.0;
+            for (float w : weights) total += w;
+            mEmissiveCDF.resize(weights.size());
+            mEmissivePmf.resize(weights.size());
+            double sum = 0.0;
+            for (size_t i = 0; i < weights.size(); i++)
+            {
+                sum += weights[i];
+                mEmissiveCDF[i] = (float)(sum / total);
+                mEmissivePmf[i] = (float)(weights[i] / total);
+            }
+            mEmissiveCDF.back() = 1.f;
+        }
+
+        // Environment map.
+        if (sceneData.pEnvMap)
+        {
+            mEnvMapTexture = loadTexture(sceneData.pEnvMap->getEnvMap());
+            mEnvMapRadianceScale = sceneData.pEnvMap->getIntensity() * sceneData.pEnvMap->getTint();
+            float3 rotation = glm::radians(sceneData.pEnvMap->getRotation());
+            mEnvMapWorldToLocal = float3x3(glm::inverse(glm::eulerAngleXYZ(rotation.x, rotation.y, rotation.z)));
+        }
+    }
+
+    void CpuPathTracer::setupCamera(const Scene::SceneData& sceneData)
+    {
+        Camera::SharedPtr pCamera = sceneData.cameras.empty() ? Camera::create() : sceneData.cameras[std::min(sceneData.selectedCamera, (uint32_t)sceneData.cameras.size() - 1)];
+        mCameraData = pCamera->getData();
+
+        // Match the aspect ratio of the output without modifying the scene camera.
+        float aspectRatio = (float)mOptions.frameDim.x / mOptions.frameDim.y;
+        mCameraData.cameraU = normalize(mCameraData.cameraU) * glm::length(mCameraData.cameraV) * aspectRatio;
+    }
+
+    void CpuPathTracer::reset()
+    {
+        mAccumulation.assign((size_t)mOptions.frameDim.x * mOptions.frameDim.y * 3, 0.0);
+        mSampleCount = 0;
+    }
+
+    void CpuPathTracer::renderPass()
+    {
+        uint32_t tileCount = div_round_up(mOptions.frameDim.x, mOptions.tileSize) * div_round_up(mOptions.frameDim.y, mOptions.tileSize);
+        auto range = NumericRange<uint32_t>(0, tileCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [this](uint32_t tileIndex) { renderTile(tileIndex); });
+        mSampleCount++;
+    }
+
+    void CpuPathTracer::render(uint32_t sampleCount, const std::filesystem::path& path, uint32_t saveInterval)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        for (uint32_t i = 0; i < sampleCount; i++)
+        {
+            renderPass();
+            if (!path.empty() && saveInterval > 0 && (i + 1) % saveInterval == 0 && i + 1 < sampleCount) saveImage(path);
+        }
+        if (!path.empty()) saveImage(path);
+
+        double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        logInfo("CpuPathTracer: Rendered {} samples per pixel at {}x{} in {:.2f} s ({} spp total).",
+            sampleCount, mOptions.frameDim.x, mOptions.frameDim.y, duration / 1000.0, mSampleCount);
+    }
+
+    std::vector<float4> CpuPathTracer::getImage() const
+    {
+        std::vector<float4> image((size_t)mOptions.frameDim.x * mOptions.frameDim.y, float4(0.f, 0.f, 0.f, 1.f));
+        if (mSampleCount == 0) return image;
+
+        double scale = 1.0 / mSampleCount;
+        for (size_t i = 0; i < image.size(); i++)
+        {
+            image[i] = float4((float)(mAccumulation[3 * i] * scale), (float)(mAccumulation[3 * i + 1] * scale), (float)(mAccumulation[3 * i + 2] * scale), 1.f);
+        }
+        return image;
+    }
+
+    void CpuPathTracer::saveImage(const std::filesystem::path& path) const
+    {
+        auto image = getImage();
+        Bitmap::saveImage(path, mOptions.frameDim.x, mOptions.frameDim.y, Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA32Float, true, image.data());
+    }
+
+    void CpuPathTracer::renderTile(uint32_t tileIndex)
+    {
+        const uint2 frameDim = mOptions.frameDim;
+        const uint32_t tilesX = div_round_up(frameDim.x, mOptions.tileSize);
+        const uint2 tileStart = uint2(tileIndex % tilesX, tileIndex / tilesX) * mOptions.tileSize;
+        const uint2 tileEnd = glm::min(tileStart + mOptions.tileSize, frameDim);
+
+        for (uint32_t y = tileStart.y; y < tileEnd.y; y++)
+        {
+            for (uint32_t x = tileStart.x; x < tileEnd.x; x++)
+            {
+                uint32_t pixelIndex = y * frameDim.x + x;
+                SampleGenerator sg(pixelIndex, mSampleCount, mOptions.seed);
+                float3 L = tracePath(uint2(x, y), sg);
+
+                // Discard invalid samples so that a single bad path doesn't ruin the image.
+                if (!std::isfinite(L.x) || !std::isfinite(L.y) || !std::isfinite(L.z)) L = float3(0.f);
+
+                double* pDst = &mAccumulation[3 * (size_t)pixelIndex];
+                pDst[0] += L.x;
+                pDst[1] += L.y;
+                pDst[2] += L.z;
+            }
+        }
+    }
+
+    float3 CpuPathTracer::tracePath(uint2 pixel, SampleGenerator& sg) const
+    {
+        // Generate the primary ray (see Camera::computeRayPinhole/computeRayThinlens).
+        const CameraData& camera = mCameraData;
+        float2 p = (float2(pixel) + sg.next2D()) / float2(mOptions.frameDim);
+        float2 ndc = float2(2.f, -2.f) * p + float2(-1.f, 1.f);
+        float3 origin = camera.posW;
+        float3 dir = ndc.x * camera.cameraU + ndc.y * camera.cameraV + camera.cameraW;
+        if (camera.apertureRadius > 0.f)
+        {
+            float2 lens = sampleDiskConcentric(sg.next2D()) * camera.apertureRadius;
+            origin += lens.x * normalize(camera.cameraU) + lens.y * normalize(camera.cameraV);
+            dir = camera.posW + dir - origin;
+        }
+
+        TriangleBVH::Ray ray(origin, normalize(dir));
+        TriangleBVH::HitFilter filter = mOptions.useAlphaTest && mHasAlphaTest ? alphaTestFilter : nullptr;
+
+        float3 L = float3(0.f);
+        float3 throughput = float3(1.f);
+        bool isLastDelta = true;
+        float lastPdf = 0.f;
+
+        for (uint32_t depth = 0;; depth++)
+        {
+            TriangleBVH::Hit hit;
+            if (!mBVH.intersect(ray, hit, filter, this))
+            {
+                L += throughput * evalEnvMap(ray.dir);
+                break;
+            }
+
+            ShadingPoint sp = getShadingPoint(ray, hit);
+
+            // Add emission. Hits found by BSDF sampling are weighted against emissive light sampling.
+            if (sp.frontFacing && sp.materialID < mMaterials.size() && mMaterials[sp.materialID].isEmissive)
+            {
+                float3 Le = evalEmission(sp.materialID, sp.uv);
+                float misWeight = 1.f;
+                const uint32_t emissiveIndex = mTriangles[sp.triangleIndex].emissiveIndex;
+                if (depth > 0 && !isLastDelta && mOptions.useNEE && emissiveIndex != kInvalidIndex)
+                {
+                    misWeight = mOptions.useMIS ? powerHeuristic(lastPdf, evalEmissivePdf(sp.triangleIndex, hit.t, ray.dir)) : 0.f;
+                }
+                L += throughput * Le * misWeight;
+            }
+
+            if (depth >= mOptions.maxBounces + 1) break;
+
+            BSDF bsdf = getBSDF(sp);
+            if (!bsdf.hasLobes()) break;
+
+            if (mOptions.useNEE && bsdf.hasNonDeltaLobes())
+            {
+                L += throughput * sampleAnalyticLight(sp, bsdf, sg);
+                L += throughput * sampleEmissiveTriangle(sp, bsdf, sg);
+            }
+
+            float3 wi, weight;
+            float pdf;
+            bool isDelta;
+            if (!bsdf.sample(sp.V, sg, wi, weight, pdf, isDelta)) break;
+
+            throughput *= weight;
+            if (isBlack(throughput)) break;
+
+            float3 rayOriginNormal = dot(wi, sp.faceN) >= 0.f ? sp.faceN : -sp.faceN;
+            ray = TriangleBVH::Ray(computeRayOrigin(sp.posW, rayOriginNormal), wi);
+            isLastDelta = isDelta;
+            lastPdf = pdf;
+        }
+
+        return L;
+    }
+
+    CpuPathTracer::ShadingPoint CpuPathTracer::getShadingPoint(const TriangleBVH::Ray& ray, const TriangleBVH::Hit& hit) const
+    {
+        const TriangleData& tri = mTriangles[hit.primitiveIndex];
+        const float3* p = &mPositions[(size_t)hit.primitiveIndex * 3];
+        const float3 b = float3(1.f - hit.barycentrics.x - hit.barycentrics.y, hit.barycentrics.x, hit.barycentrics.y);
+
+        ShadingPoint sp;
+        sp.triangleIndex = hit.primitiveIndex;
+        sp.materialID = tri.materialID;
+        sp.posW = p[0] * b.x + p[1] * b.y + p[2] * b.z;
+        sp.uv = tri.texCrds[0] * b.x + tri.texCrds[1] * b.y + tri.texCrds[2] * b.z;
+        sp.V = -ray.dir;
+        sp.faceN = tri.faceNormal;
+        sp.frontFacing = dot(sp.V, sp.faceN) >= 0.f;
+
+        float3 N = tri.normals[0] * b.x + tri.normals[1] * b.y + tri.normals[2] * b.z;
+        float lenSqr = dot(N, N);
+        sp.N = lenSqr > 0.f ? N / std::sqrt(lenSqr) : sp.faceN;
+        if (dot(sp.N, sp.faceN) < 0.f) sp.N = sp.faceN;
+
+        // Flip the normals for back-facing hits on double-sided materials.
+        bool isDoubleSided = sp.materialID < mMaterials.size() && mMaterials[sp.materialID].isDoubleSided;
+        if (!sp.frontFacing && isDoubleSided)
+        {
+            sp.N = -sp.N;
+            sp.faceN = -sp.faceN;
+        }
+        return sp;
+    }
+
+    CpuPathTracer::BSDF CpuPathTracer::getBSDF(const ShadingPoint& sp) const
+    {
+        static const MaterialParams kDefaultMaterial;
+        const MaterialParams& m = sp.materialID < mMaterials.size() ? mMaterials[sp.materialID] : kDefaultMaterial;
+
+        auto fetch = [&](uint32_t texture, const float4& value) { return texture != kInvalidIndex ? mTextures[texture].sample(sp.uv) : value; };
+        const float3 baseColor = float3(fetch(m.baseColorTexture, m.baseColor));
+        const float4 spec = fetch(m.specularTexture, m.specular);
+
+        BSDF bsdf;
+        float roughness;
+        float metallic = 0.f;
+        if (m.isSpecGloss)
+        {
+            bsdf.diffuse = baseColor;
+            bsdf.F0 = float3(spec);
+            roughness = 1.f - spec.a;
+        }
+        else
+        {
+            // G - Roughness; B - Metallic. The dielectric F0 is derived from the IoR as on the GPU.
+            float f = (m.ior - 1.f) / (m.ior + 1.f);
+            metallic = spec.b;
+            bsdf.diffuse = glm::mix(baseColor, float3(0.f), metallic);
+            bsdf.F0 = glm::mix(float3(f * f), baseColor, metallic);
+            roughness = spec.g;
+        }
+
+        bsdf.alpha = std::max(roughness * roughness, kMinGGXAlpha);
+        bsdf.specularTransmission = m.specularTransmission * (1.f - metallic);
+        bsdf.specularReflection = 1.f - bsdf.specularTransmission;
+        bsdf.diffuse *= 1.f - bsdf.specularTransmission;
+        if (bsdf.specularTransmission > 0.f) bsdf.transmission = float3(fetch(m.transmissionTexture, float4(m.transmission, 0.f)));
+        bsdf.eta = sp.frontFacing ? 1.f / m.ior : m.ior;
+
+        bsdf.N = sp.N;
+        buildFrame(bsdf.N, bsdf.T, bsdf.B);
+
+        // Select lobes proportional to their approximate albedo.
+        float cosTheta = std::max(dot(sp.V, sp.N), 0.f);
+        float wDiffuse = luminance(bsdf.diffuse);
+        float wSpecular = luminance(evalFresnelSchlick(bsdf.F0, cosTheta)) * bsdf.specularReflection;
+        float wTransmission = bsdf.specularTransmission;
+        float total = wDiffuse + wSpecular + wTransmission;
+        if (total > 0.f)
+        {
+            bsdf.pDiffuse = wDiffuse / total;
+            bsdf.pSpecular = wSpecular / total;
+            bsdf.pTransmission = wTransmission / total;
+        }
+        return bsdf;
+    }
+
+    float3 CpuPathTracer::evalEmission(uint32_t materialID, float2 uv) const
+    {
+        const MaterialParams& m = mMaterials[materialID];
+        float3 emissive = m.emissiveTexture != kInvalidIndex ? float3(mTextures[m.emissiveTexture].sample(uv)) : m.emissive;
+        return emissive * m.emissiveFactor;
+    }
+
+    float3 CpuPathTracer::evalEnvMap(const float3& dir) const
+    {
+        if (mEnvMapTexture == kInvalidIndex) return float3(0.f);
+
+        // Lat-long lookup (see world_to_latlong_map in MathHelpers.slang).
+        float3 p = normalize(mEnvMapWorldToLocal * dir);
+        float2 uv;
+        uv.x = std::atan2(p.x, -p.z) * (0.5f / kPi) + 0.5f;
+        uv.y = std::acos(std::clamp(p.y, -1.f, 1.f)) / kPi;
+        return float3(mTextures[mEnvMapTexture].sample(uv)) * mEnvMapRadianceScale;
+    }
+
+    float3 CpuPathTracer::sampleAnalyticLight(const ShadingPoint& sp, const BSDF& bsdf, SampleGenerator& sg) const
+    {
+        if (mLights.empty()) return float3(0.f);
+
+        // Pick a light uniformly (see LightHelpers.slang for the individual sampling functions).
+        const uint32_t lightCount = (uint32_t)mLights.size();
+        const LightData& light = mLights[std::min((uint32_t)(sg.next1D() * lightCount), lightCount - 1)];
+        const float2 u = sg.next2D();
+
+        float3 dir = float3(0.f);
+        float distance = std::numeric_limits<float>::infinity();
+        float3 Li = float3(0.f);
+
+        auto sampleArea = [&](const float3& posW, const float3& normalW)
+        {
+            float3 toLight = posW - sp.posW;
+            float distSqr = std::max(dot(toLight, toLight), 1e-9f);
+            distance = std::sqrt(distSqr);
+            dir = toLight / distance;
+            float cosTheta = dot(normalW, -dir);
+            if (cosTheta > 0.f) Li = light.intensity * (light.surfaceArea * cosTheta / distSqr);
+        };
+
+        switch ((LightType)light.type)
+        {
+        case LightType::Point:
+        {
+            float3 toLight = light.posW - sp.posW;
+            float distSqr = std::max(dot(toLight, toLight), 1e-9f);
+            distance = std::sqrt(distSqr);
+            dir = toLight / distance;
+            float cosTheta = -dot(dir, light.dirW);
+            float falloff = 1.f;
+            if (cosTheta < light.cosOpeningAngle) falloff = 0.f;
+            else if (light.penumbraAngle > 0.f) falloff = glm::smoothstep(0.f, light.penumbraAngle, light.openingAngle - std::acos(cosTheta));
+            Li = light.intensity * falloff / distSqr;
+            break;
+        }
+        case LightType::Directional:
+            dir = -light.dirW;
+            Li = light.intensity;
+            break;
+        case LightType::Distant:
+        {
+            float z = u.x * (1.f - light.cosSubtendedAngle) + light.cosSubtendedAngle;
+            float r = std::sqrt(std::max(0.f, 1.f - z * z));
+            float phi = 2.f * kPi * u.y;
+            dir = normalize(transformVector(light.transMat, float3(r * std::cos(phi), r * std::sin(phi), z)));
+            Li = light.intensity;
+            break;
+        }
+        case LightType::Rect:
+            sampleArea(transformPoint(light.transMat, float3(2.f * u.x - 1.f, 2.f * u.y - 1.f, 0.f)), normalize(transformVector(light.transMatIT, float3(0.f, 0.f, 1.f))));
+            break;
+        case LightType::Disc:
+        {
+            float r = std::sqrt(u.x);
+            float phi = 2.f * kPi * u.y;
+            sampleArea(transformPoint(light.transMat, float3(r * std::cos(phi), r * std::sin(phi), 0.f)), normalize(transformVector(light.transMatIT, float3(0.f, 0.f, 1.f))));
+            break;
+        }
+        case LightType::Sphere:
+        {
+            float z = 1.f - 2.f * u.x;
+            float r = std::sqrt(std::max(0.f, 1.f - z * z));
+            float phi = 2.f * kPi * u.y;
+            float3 pos = float3(r * std::cos(phi), r * std::sin(phi), z);
+            sampleArea(transformPoint(light.transMat, pos), normalize(transformVector(light.transMatIT, pos)));
+            break;
+        }
+        default:
+            FALCOR_UNREACHABLE();
+        }
+
+        if (isBlack(Li)) return float3(0.f);
+
+        float pdf;
+        float3 f = bsdf.eval(sp.V, dir, pdf);
+        if (isBlack(f) || !isVisible(sp, dir, distance)) return float3(0.f);
+
+        return f * Li * (float)lightCount;
+    }
+
+    float3 CpuPathTracer::sampleEmissiveTriangle(const ShadingPoint& sp, const BSDF& bsdf, SampleGenerator& sg) const
+    {
+        if (mEmissiveTriangles.empty()) return float3(0.f);
+
+        // Select a triangle proportional to its power, then a uniform point on it.
+        const uint32_t emissiveIndex = std::min((uint32_t)(std::upper_bound(mEmissiveCDF.begin(), mEmissiveCDF.end(), sg.next1D()) - mEmissiveCDF.begin()), (uint32_t)mEmissiveCDF.size() - 1);
+        const uint32_t triangleIndex = mEmissiveTriangles[emissiveIndex];
+        const TriangleData& tri = mTriangles[triangleIndex];
+        const float3* p = &mPositions[(size_t)triangleIndex * 3];
+
+        const float2 u = sg.next2D();
+        const float su = std::sqrt(u.x);
+        const float3 b = float3(1.f - su, su * (1.f - u.y), su * u.y);
+        const float3 posW = p[0] * b.x + p[1] * b.y + p[2] * b.z;
+
+        float3 toLight = posW - sp.posW;
+        float distSqr = dot(toLight, toLight);
+        if (!(distSqr > 0.f)) return float3(0.f);
+        float distance = std::sqrt(distSqr);
+        float3 dir = toLight / distance;
+
+        // Emission is one-sided.
+        float cosTheta = dot(tri.faceNormal, -dir);
+        if (cosTheta <= 0.f) return float3(0.f);
+
+        float lightPdf = mEmissivePmf[emissiveIndex] * distSqr / (cosTheta * tri.area);
+        float bsdfPdf;
+        float3 f = bsdf.eval(sp.V, dir, bsdfPdf);
+        if (isBlack(f)) return float3(0.f);
+
+        const float2 uv = tri.texCrds[0] * b.x + tri.texCrds[1] * b.y + tri.texCrds[2] * b.z;
+        float3 Le = evalEmission(tri.materialID, uv);
+        if (isBlack(Le) || !isVisible(sp, dir, distance)) return float3(0.f);
+
+        float misWeight = mOptions.useMIS ? powerHeuristic(lightPdf, bsdfPdf) : 1.f;
+        return f * Le * (misWeight / lightPdf);
+    }
+
+    float CpuPathTracer::evalEmissivePdf(uint32_t triangleIndex, float distance, const float3& dir) const
+    {
+        const TriangleData& tri = mTriangles[triangleIndex];
+        float cosTheta = std::abs(dot(tri.faceNormal, dir));
+        if (cosTheta <= 0.f || tri.area <= 0.f) return 0.f;
+        return mEmissivePmf[tri.emissiveIndex] * distance * distance / (cosTheta * tri.area);
+    }
+
+    float CpuPathTracer::getAlpha(uint32_t triangleIndex, float2 barycentrics) const
+    {
+        const TriangleData& tri = mTriangles[triangleIndex];
+        const MaterialParams& m = mMaterials[tri.materialID];
+        if (m.baseColorTexture == kInvalidIndex) return m.baseColor.a;
+
+        float2 uv = tri.texCrds[0] * (1.f - barycentrics.x - barycentrics.y) + tri.texCrds[1] * barycentrics.x + tri.texCrds[2] * barycentrics.y;
+        return mTextures[m.baseColorTexture].sample(uv).a;
+    }
+
+    bool CpuPathTracer::isVisible(const ShadingPoint& sp, const float3& dir, float distance) const
+    {
+        float3 normal = dot(dir, sp.faceN) >= 0.f ? sp.faceN : -sp.faceN;
+        float3 origin = computeRayOrigin(sp.posW, normal);
+
+        // Shorten the ray slightly so that it doesn't hit the light geometry itself.
+        TriangleBVH::Ray ray(origin, dir, 0.f, std::isinf(distance) ? std::numeric_limits<float>::max() : distance * 0.999f);
+        TriangleBVH::HitFilter filter = mOptions.useAlphaTest && mHasAlphaTest ? alphaTestFilter : nullptr;
+        return !mBVH.occluded(ray, filter, this);
+    }
+
+    bool CpuPathTracer::alphaTestFilter(const void* pUserData, uint32_t primitiveIndex, float2 barycentrics)
+    {
+        const CpuPathTracer* pThis = static_cast<const CpuPathTracer*>(pUserData);
+        const MaterialParams& m = pThis->mMaterials[pThis->mTriangles[primitiveIndex].materialID];
+        return !m.isAlphaTested || pThis->getAlpha(primitiveIndex, barycentrics) >= m.alphaThreshold;
+    }
+}
@@ -0,0 +1,216 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Framework.h"
+#include "Scene/Scene.h"
+#include "Utils/Geometry/TriangleBVH.h"
+#include <filesystem>
+#include <map>
+#include <vector>
+
+namespace Falcor
+{
+    /** Progressive path tracer running entirely on the CPU.
+
+        The path tracer consumes the same Scene::SceneData that a Scene is created from,
+        which makes it usable for producing reference images without a GPU ray tracer,
+        e.g. as ground truth for ErrorMeasurePass or for regression baselines.
+
+        Supported features:
+        - Triangle meshes (static pose), with vertex normals and texture coordinates.
+        - BasicMaterial parameters with the StandardMaterial metal-rough and spec-gloss models,
+          base color/specular/emissive textures, alpha masking and specular transmission.
+        - Analytic lights (point, spot, directional, distant, rect, disc, sphere),
+          emissive triangles and the environment map.
+
+        The image is split into tiles that are rendered in parallel on all cores.
+        Each call to renderPass() adds one sample per pixel. Random numbers are derived
+        from the pixel coordinate and sample index only, so the result is deterministic
+        and independent of the number of threads.
+    */
+    class FALCOR_API CpuPathTracer
+    {
+    public:
+        using SharedPtr = std::shared_ptr<CpuPathTracer>;
+
+        /** Configuration options.
+        */
+        struct Options
+        {
+            uint2 frameDim = { 512, 512 };  ///< Output resolution in pixels.
+            uint32_t maxBounces = 8;        ///< Max number of indirect bounces (0 = direct illumination only).
+            uint32_t tileSize = 32;         ///< Tile size in pixels. Tiles are the unit of parallel work.
+            uint32_t seed = 0;              ///< Seed for the random number generator.
+            bool useNEE = true;             ///< Use next-event estimation (light sampling).
+            bool useMIS = true;             ///< Use multiple importance sampling for emissive triangles when NEE is enabled.
+            bool useAlphaTest = true;       ///< Use alpha testing for materials with alpha mode 'Mask'.
+        };
+
+        /** Create a CPU path tracer.
+            The scene data is flattened into internal structures, so it does not need to stay alive after this call.
+            \param[in] sceneData Scene data, e.g. from SceneBuilder::getSceneData().
+            \param[in] options Configuration options.
+            \return New object, or throws an exception on error.
+        */
+        static SharedPtr create(const Scene::SceneData& sceneData, const Options& options = Options());
+
+        /** Discard all accumulated samples.
+        */
+        void reset();
+
+        /** Render one sample per pixel and accumulate it.
+        */
+        void renderPass();
+
+        /** Render a number of samples per pixel.
+            \param[in] sampleCount Number of samples per pixel to add.
+            \param[in] path Optional EXR output path. If non-empty, the image is written when done.
+            \param[in] saveInterval If non-zero, the image is also written every saveInterval samples.
+        */
+        void render(uint32_t sampleCount, const std::filesystem::path& path = {}, uint32_t saveInterval = 0);
+
+        /** Get the accumulated image (average of all samples), top row first.
+        */
+        std::vector<float4> getImage() const;
+
+        /** Write the accumulated image to an EXR file.
+        */
+        void saveImage(const std::filesystem::path& path) const;
+
+        uint32_t getSampleCount() const { return mSampleCount; }
+        const Options& getOptions() const { return mOptions; }
+        const TriangleBVH& getBVH() const { return mBVH; }
+
+    private:
+        CpuPathTracer(const Scene::SceneData& sceneData, const Options& options);
+
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+        /** Texture decoded to linear RGBA float texels, top row first.
+        */
+        struct TextureData
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<float4> texels;
+            float averageLuminance = 0.f;
+
+            /** Bilinear lookup with wrap addressing.
+            */
+            float4 sample(float2 uv) const;
+        };
+
+        /** Material parameters in the BasicMaterial/StandardMaterial parameterization.
+            A texture replaces the corresponding constant parameter, as on the GPU.
+        */
+        struct MaterialParams
+        {
+            float4 baseColor = float4(0.5f, 0.5f, 0.5f, 1.f);
+            float4 specular = float4(0.f);
+            float3 transmission = float3(0.f);
+            float3 emissive = float3(0.f);
+            float emissiveFactor = 1.f;
+            float specularTransmission = 0.f;
+            float ior = 1.5f;
+            float alphaThreshold = 0.5f;
+            bool isSpecGloss = false;
+            bool isDoubleSided = false;
+            bool isAlphaTested = false;
+            bool isEmissive = false;
+            uint32_t baseColorTexture = kInvalidIndex;
+            uint32_t specularTexture = kInvalidIndex;
+            uint32_t transmissionTexture = kInvalidIndex;
+            uint32_t emissiveTexture = kInvalidIndex;
+        };
+
+        /** Per-triangle shading data in world space.
+        */
+        struct TriangleData
+        {
+            float3 normals[3];
+            float2 texCrds[3];
+            float3 faceNormal;                              ///< Normalized face normal, pointing to the front-facing side.
+            float area = 0.f;
+            uint32_t materialID = 0;
+            uint32_t emissiveIndex = kInvalidIndex;         ///< Index into the emissive triangle list, or kInvalidIndex.
+        };
+
+        struct ShadingPoint;
+        struct BSDF;
+        struct SampleGenerator;
+
+        void setupGeometry(const Scene::SceneData& sceneData);
+        void setupMaterials(const Scene::SceneData& sceneData);
+        void setupLights(const Scene::SceneData& sceneData);
+        void setupCamera(const Scene::SceneData& sceneData);
+        uint32_t loadTexture(const Texture::SharedPtr& pTexture);
+
+        void renderTile(uint32_t tileIndex);
+        float3 tracePath(uint2 pixel, SampleGenerator& sg) const;
+        ShadingPoint getShadingPoint(const TriangleBVH::Ray& ray, const TriangleBVH::Hit& hit) const;
+        BSDF getBSDF(const ShadingPoint& sp) const;
+        float3 evalEmission(uint32_t materialID, float2 uv) const;
+        float3 evalEnvMap(const float3& dir) const;
+        float3 sampleAnalyticLight(const ShadingPoint& sp, const BSDF& bsdf, SampleGenerator& sg) const;
+        float3 sampleEmissiveTriangle(const ShadingPoint& sp, const BSDF& bsdf, SampleGenerator& sg) const;
+        float evalEmissivePdf(uint32_t triangleIndex, float distance, const float3& dir) const;
+        float getAlpha(uint32_t triangleIndex, float2 barycentrics) const;
+        bool isVisible(const ShadingPoint& sp, const float3& dir, float distance) const;
+
+        static bool alphaTestFilter(const void* pUserData, uint32_t primitiveIndex, float2 barycentrics);
+
+        Options mOptions;
+
+        // Geometry
+        TriangleBVH mBVH;
+        std::vector<float3> mPositions;                     ///< World-space positions, three per triangle.
+        std::vector<TriangleData> mTriangles;
+        bool mHasAlphaTest = false;
+
+        // Materials
+        std::vector<MaterialParams> mMaterials;
+        std::vector<TextureData> mTextures;
+        std::map<std::pair<std::filesystem::path, bool>, uint32_t> mTextureIndices;   ///< Maps (path, sRGB) to texture index.
+
+        // Lights
+        std::vector<LightData> mLights;
+        std::vector<uint32_t> mEmissiveTriangles;           ///< Triangle indices of emissive triangles.
+        std::vector<float> mEmissiveCDF;                    ///< Normalized CDF over emissive triangles, proportional to power.
+        std::vector<float> mEmissivePmf;                    ///< Selection probability per emissive triangle.
+        uint32_t mEnvMapTexture = kInvalidIndex;
+        float3 mEnvMapRadianceScale = float3(1.f);
+        float3x3 mEnvMapWorldToLocal = float3x3(1.f);
+
+        // Camera
+        CameraData mCameraData;
+
+        // Accumulation
+        std::vector<double> mAccumulation;                  ///< Sum of all samples per pixel (RGB). Double precision keeps high sample counts accurate.
+        uint32_t mSampleCount = 0;
+    };
+}
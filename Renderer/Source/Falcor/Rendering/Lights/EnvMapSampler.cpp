@@ -49,14 +49,25 @@ namespace Falcor
     {
         FALCOR_ASSERT(var.isValid());
 
+        // Resolve the variables once per program, this is called every frame.
+        auto& handles = mShaderDataHandles;
+        if (!handles.importanceBaseMip.isValidFor(var))
+        {
+            handles.importanceBaseMip = ShaderVarHandle(var, "importanceBaseMip");
+            handles.importanceInvDim = ShaderVarHandle(var, "importanceInvDim");
+            handles.importanceMap = ShaderVarHandle(var, "importanceMap");
+            handles.importanceSampler = ShaderVarHandle(var, "importanceSampler");
+        }
+
         // Set variables.
         float2 invDim = 1.f / float2(mpImportanceMap->getWidth(), mpImportanceMap->getHeight());
-        var["importanceBaseMip"] = mpImportanceMap->getMipCount() - 1; // The base mip is 1x1 texels
-        var["importanceInvDim"] = invDim;
+        ShaderConstantWriter writer(var);
+        writer.set(handles.importanceBaseMip, mpImportanceMap->getMipCount() - 1); // The base mip is 1x1 texels
+        writer.set(handles.importanceInvDim, invDim);
 
         // Bind resources.
-        var["importanceMap"] = mpImportanceMap;
-        var["importanceSampler"] = mpImportanceSampler;
+        var[handles.importanceMap] = mpImportanceMap;
+        var[handles.importanceSampler] = mpImportanceSampler;
     }
 
     EnvMapSampler::EnvMapSampler(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap)
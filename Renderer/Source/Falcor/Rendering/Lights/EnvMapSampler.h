@@ -28,6 +28,7 @@
 #pragma once
 
 #include "Scene/Lights/EnvMap.h"
+#include "Core/Program/ShaderVarHandle.h"
 
 namespace Falcor
 {
@@ -67,5 +68,16 @@ namespace Falcor
 
         Texture::SharedPtr      mpImportanceMap;    ///< Hierarchical importance map (luminance).
         Sampler::SharedPtr      mpImportanceSampler;
+
+        /** Handles of the variables set in `setShaderData()`.
+        */
+        struct ShaderDataHandles
+        {
+            ShaderVarHandle importanceBaseMip;
+            ShaderVarHandle importanceInvDim;
+            ShaderVarHandle importanceMap;
+            ShaderVarHandle importanceSampler;
+        };
+        mutable ShaderDataHandles mShaderDataHandles;   ///< Handles resolved against the most recently used shader variable type.
     };
 }
@@ -129,6 +129,9 @@ namespace Falcor
         // Reset all CPU data.
         mNodes.clear();
         mNodeIndices.clear();
+        mTriangleIndices.clear();
+        mTriangleBitmasks.clear();
+        mNodeCosts.clear();
         mPerDepthRefitEntryInfo.clear();
         mMaxTriangleCountPerLeaf = 0;
         mBVHStats = BVHStats();
@@ -270,7 +273,7 @@ namespace Falcor
         mpNodeIndicesBuffer->setBlob(mNodeIndices.data(), 0, mNodeIndices.size() * sizeof(uint32_t));
     }
 
-    void LightBVH::uploadCPUBuffers(const std::vector<uint32_t>& triangleIndices, const std::vector<uint64_t>& triangleBitmasks)
+    void LightBVH::uploadCPUBuffers()
     {
         // Reallocate buffers if size requirements have changed.
         auto var = mLeafUpdater->getRootVar()["CB"]["gLightBVH"];
@@ -279,14 +282,14 @@ namespace Falcor
             mpBVHNodesBuffer = Buffer::createStructured(var["nodes"], (uint32_t)mNodes.size(), Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr, false);
             mpBVHNodesBuffer->setName("LightBVH::mpBVHNodesBuffer");
         }
-        if (!mpTriangleIndicesBuffer || mpTriangleIndicesBuffer->getElementCount() < triangleIndices.size())
+        if (!mpTriangleIndicesBuffer || mpTriangleIndicesBuffer->getElementCount() < mTriangleIndices.size())
         {
-            mpTriangleIndicesBuffer = Buffer::createStructured(var["triangleIndices"], (uint32_t)triangleIndices.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+            mpTriangleIndicesBuffer = Buffer::createStructured(var["triangleIndices"], (uint32_t)mTriangleIndices.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
             mpTriangleIndicesBuffer->setName("LightBVH::mpTriangleIndicesBuffer");
         }
-        if (!mpTriangleBitmasksBuffer || mpTriangleBitmasksBuffer->getElementCount() < triangleBitmasks.size())
+        if (!mpTriangleBitmasksBuffer || mpTriangleBitmasksBuffer->getElementCount() < mTriangleBitmasks.size())
         {
-            mpTriangleBitmasksBuffer = Buffer::createStructured(var["triangleBitmasks"], (uint32_t)triangleBitmasks.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+            mpTriangleBitmasksBuffer = Buffer::createStructured(var["triangleBitmasks"], (uint32_t)mTriangleBitmasks.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
             mpTriangleBitmasksBuffer->setName("LightBVH::mpTriangleBitmasksBuffer");
         }
 
@@ -295,11 +298,11 @@ namespace Falcor
         FALCOR_ASSERT(mpBVHNodesBuffer->getStructSize() == sizeof(mNodes[0]));
         mpBVHNodesBuffer->setBlob(mNodes.data(), 0, mNodes.size() * sizeof(mNodes[0]));
 
-        FALCOR_ASSERT(mpTriangleIndicesBuffer->getSize() >= triangleIndices.size() * sizeof(triangleIndices[0]));
-        mpTriangleIndicesBuffer->setBlob(triangleIndices.data(), 0, triangleIndices.size() * sizeof(triangleIndices[0]));
+        FALCOR_ASSERT(mpTriangleIndicesBuffer->getSize() >= mTriangleIndices.size() * sizeof(mTriangleIndices[0]));
+        mpTriangleIndicesBuffer->setBlob(mTriangleIndices.data(), 0, mTriangleIndices.size() * sizeof(mTriangleIndices[0]));
 
-        FALCOR_ASSERT(mpTriangleBitmasksBuffer->getSize() >= triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
-        mpTriangleBitmasksBuffer->setBlob(triangleBitmasks.data(), 0, triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
+        FALCOR_ASSERT(mpTriangleBitmasksBuffer->getSize() >= mTriangleBitmasks.size() * sizeof(mTriangleBitmasks[0]));
+        mpTriangleBitmasksBuffer->setBlob(mTriangleBitmasks.data(), 0, mTriangleBitmasks.size() * sizeof(mTriangleBitmasks[0]));
 
         mIsCpuDataValid = true;
     }
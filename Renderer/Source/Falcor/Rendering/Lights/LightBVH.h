@@ -129,7 +129,7 @@ namespace Falcor
         void updateNodeIndices();
         void renderStats(Gui::Widgets& widget, const BVHStats& stats) const;
 
-        void uploadCPUBuffers(const std::vector<uint32_t>& triangleIndices, const std::vector<uint64_t>& triangleBitmasks);
+        void uploadCPUBuffers();
         void syncDataToCPU() const;
 
         /** Invalidate the BVH.
@@ -151,6 +151,9 @@ namespace Falcor
         // CPU resources
         mutable std::vector<PackedNode>       mNodes;                   ///< CPU-side copy of packed BVH nodes.
         std::vector<uint32_t>                 mNodeIndices;             ///< Array of all node indices sorted by tree depth.
+        std::vector<uint32_t>                 mTriangleIndices;         ///< CPU-side copy of the triangle indices sorted by leaf node.
+        std::vector<uint64_t>                 mTriangleBitmasks;        ///< CPU-side copy of the per triangle traversal bit patterns.
+        std::vector<float>                    mNodeCosts;               ///< Per node SAH cost recorded at build time. Used to monitor quality when refitting on the CPU.
         std::vector<RefitEntryInfo>           mPerDepthRefitEntryInfo;  ///< Array containing for each level the number of internal nodes as well as the corresponding offset into 'mpNodeIndicesBuffer'; the very last entry contains the same data, but for all leaf nodes instead.
         uint32_t                              mMaxTriangleCountPerLeaf = 0; ///< After the BVH is built, this contains the maximum light count per leaf node.
         BVHStats                              mBVHStats;
@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "LightBVHBuilder.h"
 #include <algorithm>
+#include <stack>
 
 namespace
 {
@@ -83,6 +84,37 @@ namespace
         return cosResult;
     }
 
+    /** Computes a normal bounding cone around a set of flat emitters.
+        We use the average normal as cone direction and grow the cone to include all light normals.
+        TODO: Switch to a more sophisticated algorithm to compute tighter bounding cones.
+        \param[in] count Number of emitters.
+        \param[in] getNormal Function returning the normal of the i:th emitter.
+        \param[out] cosTheta Cosine of the cone angle, or kInvalidCosConeAngle if the cone is invalid.
+        \return Direction of the cone.
+    */
+    template<typename GetNormal>
+    float3 computeNormalBoundingCone(uint32_t count, const GetNormal& getNormal, float& cosTheta)
+    {
+        float3 coneDirection = float3(0.0f);
+        cosTheta = kInvalidCosConeAngle;
+
+        float3 coneDirectionSum = float3(0.0f);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            coneDirectionSum += getNormal(i);
+        }
+        if (glm::length(coneDirectionSum) >= FLT_MIN)
+        {
+            coneDirection = glm::normalize(coneDirectionSum);
+            cosTheta = 1.f;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                cosTheta = computeCosConeAngle(coneDirection, cosTheta, getNormal(i), 1.f); // Single flat emitter => normal bounding cone angle is zero.
+            }
+        }
+        return coneDirection;
+    }
+
     /** Given two cones specified by direction vectors and the cosine of
         their spread angles, returns a cone that bounds both of them. This
         is what was used previously; the cones it returns aren't as tight as
@@ -240,41 +272,84 @@ namespace Falcor
         // Get global list of emissive triangles.
         FALCOR_ASSERT(bvh.mpLightCollection);
         const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles();
+
+        // Build the tree on the CPU.
+        BVHData data;
+        buildNodes(triangles, data);
+
+        // If there are no non-culled triangles, we're done.
+        if (data.nodes.empty()) return;
+
+        // The BVH is ready, mark it as valid and upload the data.
+        bvh.mNodes = std::move(data.nodes);
+        bvh.mTriangleIndices = std::move(data.triangleIndices);
+        bvh.mTriangleBitmasks = std::move(data.triangleBitmasks);
+        bvh.mNodeCosts = std::move(data.nodeCosts);
+        bvh.mIsValid = true;
+        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
+        bvh.uploadCPUBuffers();
+
+        // Computate metadata.
+        bvh.finalize();
+    }
+
+    LightBVHBuilder::RefitStats LightBVHBuilder::refit(LightBVH& bvh)
+    {
+        FALCOR_PROFILE("LightBVHBuilder::refit()");
+
+        FALCOR_ASSERT(bvh.isValid());
+        FALCOR_ASSERT(bvh.mpLightCollection);
+        const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles();
+
+        // The hierarchy stored on the CPU is always up-to-date. The node attributes may be stale after a GPU refit,
+        // but these are all recomputed here so there is no need to read the nodes back from the GPU.
+        BVHData data;
+        data.nodes = std::move(bvh.mNodes);
+        data.triangleIndices = std::move(bvh.mTriangleIndices);
+        data.triangleBitmasks = std::move(bvh.mTriangleBitmasks);
+        data.nodeCosts = std::move(bvh.mNodeCosts);
+
+        RefitStats stats = refitNodes(triangles, data);
+
+        bvh.mNodes = std::move(data.nodes);
+        bvh.mTriangleIndices = std::move(data.triangleIndices);
+        bvh.mTriangleBitmasks = std::move(data.triangleBitmasks);
+        bvh.mNodeCosts = std::move(data.nodeCosts);
+        bvh.uploadCPUBuffers();
+
+        // Rebuilt subtrees change the hierarchy, so the metadata needs to be recomputed.
+        if (stats.rebuiltSubtreeCount > 0) bvh.finalize();
+
+        return stats;
+    }
+
+    void LightBVHBuilder::buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, BVHData& data) const
+    {
+        data = BVHData();
         if (triangles.empty()) return;
 
         // Create list of triangles that should be included in BVH.
         // For each triangle, precompute data we need for the build.
-        BuildingData data(bvh.mNodes);
-        data.trianglesData.reserve(triangles.size());
+        BuildingData buildData(data.nodes, data.triangleIndices, data.triangleBitmasks);
+        buildData.trianglesData.reserve(triangles.size());
 
         for (size_t i = 0; i < triangles.size(); i++)
         {
             if (!mOptions.usePreintegration || triangles[i].flux > 0.f)
             {
-                LightBVHBuilder::TriangleSortData tri;
-                for (uint32_t j = 0; j < 3; j++)
-                {
-                    tri.bounds |= triangles[i].vtx[j].pos;
-                }
-                tri.center = triangles[i].getCenter();
-                tri.coneDirection = triangles[i].normal;
-                tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
-                tri.flux = triangles[i].flux;
-                tri.triangleIndex = static_cast<uint32_t>(i);
-
-                data.trianglesData.push_back(tri);
+                buildData.trianglesData.push_back(getTriangleSortData(triangles[i], static_cast<uint32_t>(i)));
             }
         }
 
         // If there are no non-culled triangles, we're done.
-        if (data.trianglesData.empty()) return;
+        if (buildData.trianglesData.empty()) return;
 
         // Validate options.
         if (mOptions.maxTriangleCountPerLeaf > kMaxLeafTriangleCount)
         {
             throw RuntimeError("Max triangle count per leaf exceeds the maximum supported ({})", kMaxLeafTriangleCount);
         }
-        if (data.trianglesData.size() > kMaxLeafTriangleOffset + kMaxLeafTriangleCount)
+        if (buildData.trianglesData.size() > kMaxLeafTriangleOffset + kMaxLeafTriangleCount)
         {
             throw RuntimeError("Emissive triangle count exceeds the maximum supported ({})", kMaxLeafTriangleOffset + kMaxLeafTriangleCount);
         }
@@ -283,34 +358,96 @@ namespace Falcor
         // To be grossly conservative, assume each triangle requires two nodes.
         // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
         // TODO: Better estimate of how many nodes we will need.
-        data.nodes.clear();
-        data.nodes.reserve(2 * data.trianglesData.size());
-        data.triangleIndices.reserve(data.trianglesData.size());
+        buildData.nodes.reserve(2 * buildData.trianglesData.size());
+        buildData.triangleIndices.reserve(buildData.trianglesData.size());
 
         const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
-        data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
+        buildData.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
-        FALCOR_ASSERT(!data.nodes.empty());
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(buildData.trianglesData.size())), buildData);
+        FALCOR_ASSERT(!buildData.nodes.empty());
 
         size_t numValid = 0;
-        for (auto mask : data.triangleBitmasks)
+        for (auto mask : buildData.triangleBitmasks)
             if (mask != invalidBitmask) numValid++;
-        FALCOR_ASSERT(numValid == data.trianglesData.size());
+        FALCOR_ASSERT(numValid == buildData.trianglesData.size());
 
         // Compute per-node light bounding cones.
         float cosConeAngle;
-        computeLightingConesInternal(0, data, cosConeAngle);
+        computeLightingConesInternal(0, buildData, cosConeAngle);
 
-        // The BVH is ready, mark it as valid and upload the data.
-        bvh.mIsValid = true;
-        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
+        // Record the SAH cost of the built tree for monitoring quality when refitting.
+        data.nodeCosts = computeNodeCosts(data.nodes);
+    }
 
-        // Computate metadata.
-        bvh.finalize();
+    LightBVHBuilder::RefitStats LightBVHBuilder::refitNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, BVHData& data) const
+    {
+        RefitStats stats;
+        if (data.nodes.empty()) return stats;
+
+        FALCOR_ASSERT(data.nodeCosts.size() == data.nodes.size());
+        FALCOR_ASSERT(data.triangleBitmasks.size() == triangles.size());
+
+        refitAllNodes(triangles, data);
+
+        // Compare the SAH cost of each subtree against its cost at build time.
+        const std::vector<float> costs = computeNodeCosts(data.nodes);
+        auto getCostRatio = [&](uint32_t nodeIndex)
+        {
+            const float buildCost = data.nodeCosts[nodeIndex];
+            return buildCost > 0.f ? costs[nodeIndex] / buildCost : 1.f;
+        };
+        for (uint32_t nodeIndex = 0; nodeIndex < (uint32_t)data.nodes.size(); ++nodeIndex)
+        {
+            stats.maxCostRatio = std::max(stats.maxCostRatio, getCostRatio(nodeIndex));
+        }
+
+        const float maxCostRatio = mOptions.maxRefitCostRatio;
+        if (maxCostRatio <= 0.f || stats.maxCostRatio <= maxCostRatio) return stats;
+
+        // Find the subtrees to rebuild. Starting at the root, we descend into degraded children to localize
+        // the rebuild to the smallest subtrees. A degraded node is only rebuilt if none of its children are
+        // degraded, i.e., when it is the split at the node itself that has become poor.
+        // Leaf nodes always have the same cost, so they are never selected.
+        struct Subtree
+        {
+            uint32_t nodeIndex;
+            uint64_t bitmask;
+            uint32_t depth;
+        };
+        std::vector<Subtree> subtrees;
+        std::stack<Subtree> stack({ Subtree{ 0, 0ull, 0 } });
+        while (!stack.empty())
+        {
+            const Subtree subtree = stack.top();
+            stack.pop();
+
+            if (data.nodes[subtree.nodeIndex].isLeaf() || getCostRatio(subtree.nodeIndex) <= maxCostRatio) continue;
+
+            const uint32_t leftIndex = subtree.nodeIndex + 1;
+            const uint32_t rightIndex = data.nodes[subtree.nodeIndex].getInternalNode().rightChildIdx;
+            const bool leftDegraded = getCostRatio(leftIndex) > maxCostRatio;
+            const bool rightDegraded = getCostRatio(rightIndex) > maxCostRatio;
+
+            if (leftDegraded) stack.push(Subtree{ leftIndex, subtree.bitmask | (0ull << subtree.depth), subtree.depth + 1 });
+            if (rightDegraded) stack.push(Subtree{ rightIndex, subtree.bitmask | (1ull << subtree.depth), subtree.depth + 1 });
+            if (!leftDegraded && !rightDegraded) subtrees.push_back(subtree);
+        }
+
+        // Rebuild the subtrees in order of decreasing node index, so that the nodes still to be processed don't move.
+        std::sort(subtrees.begin(), subtrees.end(), [](const Subtree& a, const Subtree& b) { return a.nodeIndex > b.nodeIndex; });
+        for (const Subtree& subtree : subtrees)
+        {
+            stats.rebuiltTriangleCount += rebuildSubtree(triangles, subtree.nodeIndex, subtree.bitmask, subtree.depth, data);
+            stats.rebuiltSubtreeCount++;
+        }
+
+        // Refit again to update the ancestors of the rebuilt subtrees.
+        if (!subtrees.empty()) refitAllNodes(triangles, data);
+
+        return stats;
     }
 
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
@@ -324,6 +461,15 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        if (options.allowRefitting)
+        {
+            optionsChanged |= widget.checkbox("Refit on CPU", options.refitOnCPU);
+            if (options.refitOnCPU)
+            {
+                optionsChanged |= widget.var("Max refit cost ratio", options.maxRefitCostRatio, 0.f, 100.f);
+                widget.tooltip("Subtrees whose SAH cost has grown by more than this factor since they were built are rebuilt after refitting. Set to 0 to disable.");
+            }
+        }
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
         optionsChanged |= widget.dropdown("Split heuristic", kSplitHeuristicList, (uint32_t&)options.splitHeuristicSelection);
 
@@ -483,27 +629,201 @@ namespace Falcor
 
     float3 LightBVHBuilder::computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta)
     {
-        float3 coneDirection = float3(0.0f);
-        cosTheta = kInvalidCosConeAngle;
+        // Note the triangle sort data always has a zero cone angle, which is assumed by computeNormalBoundingCone().
+        auto getNormal = [&](uint32_t i) { return data.trianglesData[triangleRange.begin + i].coneDirection; };
+        return computeNormalBoundingCone(triangleRange.length(), getNormal, cosTheta);
+    }
 
-        // We use the average normal as cone direction and grow the cone to include all light normals.
-        // TODO: Switch to a more sophisticated algorithm to compute tighter bounding cones.
-        float3 coneDirectionSum = float3(0.0f);
-        for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
+    void LightBVHBuilder::refitAllNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, BVHData& data)
+    {
+        const uint32_t nodeCount = (uint32_t)data.nodes.size();
+
+        // The packed node extents are quantized, so we keep track of the exact bounds for computing the parent bounds.
+        std::vector<AABB> nodeBounds(nodeCount);
+
+        // Children are stored after their parent, so iterating backwards processes all children before their parents.
+        for (uint32_t nodeIndex = nodeCount; nodeIndex-- > 0;)
         {
-            coneDirectionSum += data.trianglesData[triangleIdx].coneDirection;
+            PackedNode& packedNode = data.nodes[nodeIndex];
+            if (packedNode.isLeaf())
+            {
+                LeafNode node = packedNode.getLeafNode();
+                auto getTriangle = [&](uint32_t i) -> const LightCollection::MeshLightTriangle& { return triangles[data.triangleIndices[node.triangleOffset + i]]; };
+
+                float nodeFlux = 0.f;
+                for (uint32_t i = 0; i < node.triangleCount; ++i)
+                {
+                    const auto& triangle = getTriangle(i);
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        nodeBounds[nodeIndex] |= triangle.vtx[j].pos;
+                    }
+                    nodeFlux += triangle.flux;
+                }
+
+                node.attribs.setAABB(nodeBounds[nodeIndex].minPoint, nodeBounds[nodeIndex].maxPoint);
+                node.attribs.flux = nodeFlux;
+                float cosTheta;
+                node.attribs.coneDirection = computeNormalBoundingCone(node.triangleCount, [&](uint32_t i) { return getTriangle(i).normal; }, cosTheta);
+                node.attribs.cosConeAngle = cosTheta;
+                packedNode.setLeafNode(node);
+            }
+            else
+            {
+                InternalNode node = packedNode.getInternalNode();
+                const uint32_t leftIndex = nodeIndex + 1;
+                const uint32_t rightIndex = node.rightChildIdx;
+                const SharedNodeAttributes leftAttribs = data.nodes[leftIndex].getNodeAttributes();
+                const SharedNodeAttributes rightAttribs = data.nodes[rightIndex].getNodeAttributes();
+
+                nodeBounds[nodeIndex] = nodeBounds[leftIndex] | nodeBounds[rightIndex];
+                node.attribs.setAABB(nodeBounds[nodeIndex].minPoint, nodeBounds[nodeIndex].maxPoint);
+                node.attribs.flux = leftAttribs.flux + rightAttribs.flux;
+
+                // Use the same cone union as computeLightingConesInternal().
+                float cosConeAngle;
+                node.attribs.coneDirection = coneUnionOld(leftAttribs.coneDirection, leftAttribs.cosConeAngle, rightAttribs.coneDirection, rightAttribs.cosConeAngle, cosConeAngle);
+                node.attribs.cosConeAngle = cosConeAngle;
+                packedNode.setInternalNode(node);
+            }
         }
-        if (glm::length(coneDirectionSum) >= FLT_MIN)
+    }
+
+    std::vector<float> LightBVHBuilder::computeNodeCosts(const std::vector<PackedNode>& nodes)
+    {
+        // The SAH cost of a subtree is the sum over its nodes of the node area, weighted by the triangle count
+        // for leaf nodes, normalized by the area of the subtree root. See also evalSAH().
+        const uint32_t nodeCount = (uint32_t)nodes.size();
+        std::vector<float> costs(nodeCount, 0.f);
+        std::vector<float> weightedAreas(nodeCount, 0.f);
+
+        for (uint32_t nodeIndex = nodeCount; nodeIndex-- > 0;)
         {
-            coneDirection = glm::normalize(coneDirectionSum);
-            cosTheta = 1.f;
-            for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
+            const PackedNode& packedNode = nodes[nodeIndex];
+            const SharedNodeAttributes attribs = packedNode.getNodeAttributes();
+            const float area = AABB(attribs.origin - attribs.extent, attribs.origin + attribs.extent).area();
+
+            if (packedNode.isLeaf())
+            {
+                weightedAreas[nodeIndex] = area * (float)packedNode.getLeafNode().triangleCount;
+            }
+            else
             {
-                const TriangleSortData& td = data.trianglesData[triangleIdx];
-                cosTheta = computeCosConeAngle(coneDirection, cosTheta, td.coneDirection, td.cosConeAngle);
+                weightedAreas[nodeIndex] = area + weightedAreas[nodeIndex + 1] + weightedAreas[packedNode.getInternalNode().rightChildIdx];
             }
+            costs[nodeIndex] = area > 0.f ? weightedAreas[nodeIndex] / area : 0.f;
         }
-        return coneDirection;
+        return costs;
+    }
+
+    uint32_t LightBVHBuilder::rebuildSubtree(const std::vector<LightCollection::MeshLightTriangle>& triangles, uint32_t nodeIndex, uint64_t bitmask, uint32_t depth, BVHData& data) const
+    {
+        // Find the extent of the subtree. The nodes and the triangle indices of a subtree are stored contiguously.
+        uint32_t subtreeNodeCount = 0;
+        uint32_t triangleBegin = std::numeric_limits<uint32_t>::max();
+        uint32_t triangleEnd = 0;
+        std::stack<uint32_t> stack({ nodeIndex });
+        while (!stack.empty())
+        {
+            const uint32_t index = stack.top();
+            stack.pop();
+            subtreeNodeCount++;
+
+            if (data.nodes[index].isLeaf())
+            {
+                const LeafNode leaf = data.nodes[index].getLeafNode();
+                triangleBegin = std::min(triangleBegin, leaf.triangleOffset);
+                triangleEnd = std::max(triangleEnd, leaf.triangleOffset + leaf.triangleCount);
+            }
+            else
+            {
+                stack.push(index + 1);
+                stack.push(data.nodes[index].getInternalNode().rightChildIdx);
+            }
+        }
+        FALCOR_ASSERT(triangleBegin < triangleEnd);
+        const uint32_t nodeEnd = nodeIndex + subtreeNodeCount;
+
+        // Build a new subtree over the same triangles. The triangle bitmasks are updated in place.
+        std::vector<PackedNode> nodes;
+        std::vector<uint32_t> triangleIndices;
+        BuildingData buildData(nodes, triangleIndices, data.triangleBitmasks);
+        buildData.trianglesData.reserve(triangleEnd - triangleBegin);
+        for (uint32_t i = triangleBegin; i < triangleEnd; ++i)
+        {
+            const uint32_t triangleIndex = data.triangleIndices[i];
+            buildData.trianglesData.push_back(getTriangleSortData(triangles[triangleIndex], triangleIndex));
+        }
+
+        SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
+        buildInternal(mOptions, splitFunc, bitmask, depth, Range(0, triangleEnd - triangleBegin), buildData);
+        float cosConeAngle;
+        computeLightingConesInternal(0, buildData, cosConeAngle);
+        FALCOR_ASSERT(triangleIndices.size() == triangleEnd - triangleBegin);
+
+        std::vector<float> nodeCosts = computeNodeCosts(nodes);
+
+        // Relocate the new nodes to the position of the subtree.
+        // Note that repacking may change the quantized attributes slightly, but these are recomputed by the refit that follows.
+        for (PackedNode& packedNode : nodes)
+        {
+            if (packedNode.isLeaf())
+            {
+                LeafNode leaf = packedNode.getLeafNode();
+                leaf.triangleOffset += triangleBegin;
+                FALCOR_ASSERT(leaf.triangleOffset < kMaxLeafTriangleOffset);
+                packedNode.setLeafNode(leaf);
+            }
+            else
+            {
+                InternalNode node = packedNode.getInternalNode();
+                node.rightChildIdx += nodeIndex;
+                packedNode.setInternalNode(node);
+            }
+        }
+
+        // Update references to nodes stored after the subtree, as these move if the node count changed.
+        const int64_t nodeCountDelta = (int64_t)nodes.size() - (int64_t)subtreeNodeCount;
+        if (nodeCountDelta != 0)
+        {
+            for (uint32_t index = 0; index < (uint32_t)data.nodes.size(); ++index)
+            {
+                // Skip the old subtree, it is replaced below.
+                if (index >= nodeIndex && index < nodeEnd) continue;
+                if (data.nodes[index].isLeaf()) continue;
+
+                InternalNode node = data.nodes[index].getInternalNode();
+                if (node.rightChildIdx >= nodeEnd)
+                {
+                    node.rightChildIdx = (uint32_t)((int64_t)node.rightChildIdx + nodeCountDelta);
+                    data.nodes[index].setInternalNode(node);
+                }
+            }
+        }
+
+        // Splice the new subtree into the tree.
+        data.nodes.erase(data.nodes.begin() + nodeIndex, data.nodes.begin() + nodeEnd);
+        data.nodes.insert(data.nodes.begin() + nodeIndex, nodes.begin(), nodes.end());
+        data.nodeCosts.erase(data.nodeCosts.begin() + nodeIndex, data.nodeCosts.begin() + nodeEnd);
+        data.nodeCosts.insert(data.nodeCosts.begin() + nodeIndex, nodeCosts.begin(), nodeCosts.end());
+        std::copy(triangleIndices.begin(), triangleIndices.end(), data.triangleIndices.begin() + triangleBegin);
+
+        return triangleEnd - triangleBegin;
+    }
+
+    LightBVHBuilder::TriangleSortData LightBVHBuilder::getTriangleSortData(const LightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex)
+    {
+        TriangleSortData tri;
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            tri.bounds |= triangle.vtx[j].pos;
+        }
+        tri.center = triangle.getCenter();
+        tri.coneDirection = triangle.normal;
+        tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
+        tri.flux = triangle.flux;
+        tri.triangleIndex = triangleIndex;
+        return tri;
     }
 
     LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
@@ -910,6 +1230,8 @@ namespace Falcor
         options.field(allowRefitting);
         options.field(usePreintegration);
         options.field(useLightingCones);
+        options.field(refitOnCPU);
+        options.field(maxRefitCostRatio);
 #undef field
     }
 }
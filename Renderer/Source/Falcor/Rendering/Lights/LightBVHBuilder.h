@@ -71,6 +71,27 @@ namespace Falcor
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            bool           refitOnCPU = false;                                   ///< Refit the BVH on the CPU rather than on the GPU. This allows rebuilding subtrees whose quality has degraded. Only used when 'allowRefitting' is enabled.
+            float          maxRefitCostRatio = 1.5f;                             ///< Rebuild a subtree after a CPU refit when its SAH cost exceeds the cost at build time by this factor. Set to 0 to disable subtree rebuilds.
+        };
+
+        /** CPU-side BVH data produced by the builder.
+        */
+        struct BVHData
+        {
+            std::vector<PackedNode> nodes;                  ///< BVH nodes in depth-first order. The left child is stored immediately after its parent.
+            std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
+            std::vector<uint64_t> triangleBitmasks;         ///< Per triangle bit pattern retracing the tree traversal to reach the triangle. Indexed by global triangle index.
+            std::vector<float> nodeCosts;                   ///< Per node SAH cost of the subtree rooted at the node, recorded when the subtree was built.
+        };
+
+        /** Results of a CPU refit.
+        */
+        struct RefitStats
+        {
+            float maxCostRatio = 1.f;                       ///< Largest ratio between the refitted and the built SAH cost over all nodes.
+            uint32_t rebuiltSubtreeCount = 0;               ///< Number of subtrees that were rebuilt.
+            uint32_t rebuiltTriangleCount = 0;              ///< Number of triangles in the rebuilt subtrees.
         };
 
         /** Creates a new object.
@@ -83,6 +104,28 @@ namespace Falcor
         */
         void build(LightBVH& bvh);
 
+        /** Refit the BVH on the CPU to the current emissive triangles.
+            Subtrees whose SAH cost has degraded by more than Options::maxRefitCostRatio are rebuilt.
+            The BVH needs to have been built with this builder before.
+            \param[in,out] bvh The light BVH to refit.
+            \return Stats about the refit.
+        */
+        RefitStats refit(LightBVH& bvh);
+
+        /** Build the BVH nodes on the CPU only. This is what build() uses internally.
+            \param[in] triangles Emissive triangles in world space.
+            \param[out] data The built BVH data. The node list is empty if there are no triangles to build over.
+        */
+        void buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, BVHData& data) const;
+
+        /** Refit the BVH nodes on the CPU only, without changing the hierarchy except for rebuilt subtrees.
+            Node bounds, flux and lighting cones are recomputed bottom-up in the same way as during the build.
+            \param[in] triangles Emissive triangles in world space. The triangle count must match the one used for building.
+            \param[in,out] data The BVH data to refit.
+            \return Stats about the refit.
+        */
+        RefitStats refitNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, BVHData& data) const;
+
         virtual bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -124,13 +167,20 @@ namespace Falcor
         {
             std::vector<PackedNode>& nodes;                 ///< BVH nodes generated by the builder.
             std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
-            std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
-            std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
+            std::vector<uint32_t>& triangleIndices;         ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
+            std::vector<uint64_t>& triangleBitmasks;        ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
             float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
 
-            BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
+            BuildingData(std::vector<PackedNode>& bvhNodes, std::vector<uint32_t>& bvhTriangleIndices, std::vector<uint64_t>& bvhTriangleBitmasks)
+                : nodes(bvhNodes), triangleIndices(bvhTriangleIndices), triangleBitmasks(bvhTriangleBitmasks) {}
         };
 
+        /** Prepare the per-triangle data needed for building.
+            \param[in] triangle Emissive triangle in world space.
+            \param[in] triangleIndex Global index of the triangle.
+        */
+        static TriangleSortData getTriangleSortData(const LightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex);
+
         /** Compute the split according to a specified heuristic.
             \param[in] data Prepared light data.
             \param[in] triangleRange Range of triangles to process.
@@ -171,6 +221,28 @@ namespace Falcor
         */
         static float3 computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta);
 
+        /** Refit all nodes bottom-up to the given triangles, keeping the hierarchy.
+            \param[in] triangles Emissive triangles in world space.
+            \param[in,out] data The BVH data to refit.
+        */
+        static void refitAllNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, BVHData& data);
+
+        /** Compute the SAH cost of the subtree rooted at each node.
+            \param[in] nodes BVH nodes.
+            \return Per node SAH cost normalized by the node's surface area.
+        */
+        static std::vector<float> computeNodeCosts(const std::vector<PackedNode>& nodes);
+
+        /** Rebuild the subtree rooted at a given node in place.
+            \param[in] triangles Emissive triangles in world space.
+            \param[in] nodeIndex Index of the subtree root node.
+            \param[in] bitmask Bit pattern retracing the tree traversal to reach the node.
+            \param[in] depth Depth of the node.
+            \param[in,out] data The BVH data to update.
+            \return Number of triangles in the rebuilt subtree.
+        */
+        uint32_t rebuildSubtree(const std::vector<LightCollection::MeshLightTriangle>& triangles, uint32_t nodeIndex, uint64_t bitmask, uint32_t depth, BVHData& data) const;
+
         // See the documentation of SplitHeuristicFunction.
         static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/);
         static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
@@ -72,7 +72,8 @@ namespace Falcor
         }
         else if (needsRefit)
         {
-            mpBVH->refit(pRenderContext);
+            if (mOptions.buildOptions.refitOnCPU) mpBVHBuilder->refit(*mpBVH);
+            else mpBVH->refit(pRenderContext);
             samplerChanged = true;
         }
 
@@ -52,22 +52,26 @@ namespace Falcor
         // Prepare state.
         FALCOR_ASSERT(!mRunning);
         mRunning = true;
-        mWaitingForData = false;
         mFrameDim = frameDim;
 
-        // Mark previously stored data as invalid. The config may have changed, so this is the safe bet.
-        mStats = Stats();
-        mStatsValid = false;
+        // Mark per-pixel data as invalid. Stats read back from earlier frames stay valid
+        // as they are stored with their own frame dimensions.
         mStatsBuffersValid = false;
         mRayCountTextureValid = false;
 
-        if (mEnabled)
+        if (!mEnabled)
+        {
+            mReadbackRing.clear();
+            mStats = Stats();
+            mStatsValid = false;
+        }
+        else
         {
             // Create parallel reduction helper.
             if (!mpParallelReduction)
             {
                 mpParallelReduction = ComputeParallelReduction::create();
-                mpReductionResult = Buffer::create((kRayTypeCount + 3) * sizeof(uint4), ResourceBindFlags::None, Buffer::CpuAccess::Read);
+                mpReductionResult = Buffer::create(kReadbackSlotCount * kResultCount * sizeof(uint4), ResourceBindFlags::None, Buffer::CpuAccess::Read);
             }
 
             // Prepare stats buffers.
@@ -102,21 +106,31 @@ namespace Falcor
             // Create fence first time we need it.
             if (!mpFence) mpFence = GpuFence::create();
 
-            // Sum of the per-pixel counters. The results are copied to a GPU buffer.
+            // Free up the oldest readback slot. This only stalls if the stats have not been fetched for a few frames.
+            if (mReadbackRing.isFull())
+            {
+                mpFence->syncCpu(mReadbackRing.front().fenceValue);
+                copyStatsToCPU(false);
+            }
+
+            // Sum of the per-pixel counters. The results are copied to the next readback slot.
+            const uint32_t slot = mReadbackRing.getNextSlot();
+            const uint64_t offset = slot * kResultCount * sizeof(uint4);
             for (uint32_t i = 0; i < kRayTypeCount; i++)
             {
-                mpParallelReduction->execute<uint4>(pRenderContext, mpStatsRayCount[i], ComputeParallelReduction::Type::Sum, nullptr, mpReductionResult, i * sizeof(uint4));
+                mpParallelReduction->execute<uint4>(pRenderContext, mpStatsRayCount[i], ComputeParallelReduction::Type::Sum, nullptr, mpReductionResult, offset + i * sizeof(uint4));
             }
-            mpParallelReduction->execute<uint4>(pRenderContext, mpStatsPathLength, ComputeParallelReduction::Type::Sum, nullptr, mpReductionResult, kRayTypeCount * sizeof(uint4));
-            mpParallelReduction->execute<uint4>(pRenderContext, mpStatsPathVertexCount, ComputeParallelReduction::Type::Sum, nullptr, mpReductionResult, (kRayTypeCount + 1) * sizeof(uint4));
-            mpParallelReduction->execute<uint4>(pRenderContext, mpStatsVolumeLookupCount, ComputeParallelReduction::Type::Sum, nullptr, mpReductionResult, (kRayTypeCount + 2) * sizeof(uint4));
+            mpParallelReduction->execute<uint4>(pRenderContext, mpStatsPathLength, ComputeParallelReduction::Type::Sum, nullptr, mpReductionResult, offset + kRayTypeCount * sizeof(uint4));
+            mpParallelReduction->execute<uint4>(pRenderContext, mpStatsPathVertexCount, ComputeParallelReduction::Type::Sum, nullptr, mpReductionResult, offset + (kRayTypeCount + 1) * sizeof(uint4));
+            mpParallelReduction->execute<uint4>(pRenderContext, mpStatsVolumeLookupCount, ComputeParallelReduction::Type::Sum, nullptr, mpReductionResult, offset + (kRayTypeCount + 2) * sizeof(uint4));
+            mSlotPixelCount[slot] = mFrameDim.x * mFrameDim.y;
 
             // Submit command list and insert signal.
             pRenderContext->flush(false);
-            mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+            uint64_t fenceValue = mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+            mReadbackRing.push(mFrameCount++, fenceValue);
 
             mStatsBuffersValid = true;
-            mWaitingForData = true;
         }
     }
 
@@ -148,7 +162,7 @@ namespace Falcor
         widget.tooltip("Collects ray tracing traversal stats on the GPU.\nNote that this option slows down the performance.");
 
         // Fetch data and show stats if available.
-        copyStatsToCPU();
+        copyStatsToCPU(false);
         if (mStatsValid)
         {
             widget.text("Stats:");
@@ -183,7 +197,7 @@ namespace Falcor
 
     bool PixelStats::getStats(PixelStats::Stats& stats)
     {
-        copyStatsToCPU();
+        copyStatsToCPU(true);
         if (!mStatsValid)
         {
             logWarning("PixelStats::getStats() - Stats are not valid. Ignoring.");
@@ -245,43 +259,45 @@ namespace Falcor
         return mStatsBuffersValid ? mpStatsVolumeLookupCount : nullptr;
     }
 
-    void PixelStats::copyStatsToCPU()
+    void PixelStats::copyStatsToCPU(bool waitForLastFrame)
     {
         FALCOR_ASSERT(!mRunning);
-        if (mWaitingForData)
-        {
-            // Wait for signal.
-            mpFence->syncCpu();
-            mWaitingForData = false;
-
-            if (mEnabled)
-            {
-                // Map the stats buffer.
-                const uint4* result = static_cast<const uint4*>(mpReductionResult->map(Buffer::MapType::Read));
-                FALCOR_ASSERT(result);
-
-                const uint32_t totalPathLength = result[kRayTypeCount].x;
-                const uint32_t totalPathVertices = result[kRayTypeCount + 1].x;
-                const uint32_t totalVolumeLookups = result[kRayTypeCount + 2].x;
-                const uint32_t numPixels = mFrameDim.x * mFrameDim.y;
-                FALCOR_ASSERT(numPixels > 0);
-
-                mStats.visibilityRays = result[(uint32_t)PixelStatsRayType::Visibility].x;
-                mStats.closestHitRays = result[(uint32_t)PixelStatsRayType::ClosestHit].x;
-                mStats.totalRays = mStats.visibilityRays + mStats.closestHitRays;
-                mStats.pathVertices = totalPathVertices;
-                mStats.volumeLookups = totalVolumeLookups;
-                mStats.avgVisibilityRays = (float)mStats.visibilityRays / numPixels;
-                mStats.avgClosestHitRays = (float)mStats.closestHitRays / numPixels;
-                mStats.avgTotalRays = (float)mStats.totalRays / numPixels;
-                mStats.avgPathLength = (float)totalPathLength / numPixels;
-                mStats.avgPathVertices = (float)totalPathVertices / numPixels;
-                mStats.avgVolumeLookups = (float)totalVolumeLookups / numPixels;
-
-                mpReductionResult->unmap();
-                mStatsValid = true;
-            }
-        }
+        if (mReadbackRing.isEmpty()) return;
+
+        // Wait for signal.
+        if (waitForLastFrame) mpFence->syncCpu(mReadbackRing.back().fenceValue);
+
+        // Only the most recent finished frame is of interest.
+        std::optional<ReadbackRing::Entry> latest;
+        const uint64_t completedFenceValue = mpFence->getGpuValue();
+        while (auto entry = mReadbackRing.pop(completedFenceValue)) latest = entry;
+        if (!latest) return;
+
+        // Map the stats buffer.
+        const uint4* pData = static_cast<const uint4*>(mpReductionResult->map(Buffer::MapType::Read));
+        FALCOR_ASSERT(pData);
+        const uint4* result = pData + latest->slot * kResultCount;
+
+        const uint32_t totalPathLength = result[kRayTypeCount].x;
+        const uint32_t totalPathVertices = result[kRayTypeCount + 1].x;
+        const uint32_t totalVolumeLookups = result[kRayTypeCount + 2].x;
+        const uint32_t numPixels = mSlotPixelCount[latest->slot];
+        FALCOR_ASSERT(numPixels > 0);
+
+        mStats.visibilityRays = result[(uint32_t)PixelStatsRayType::Visibility].x;
+        mStats.closestHitRays = result[(uint32_t)PixelStatsRayType::ClosestHit].x;
+        mStats.totalRays = mStats.visibilityRays + mStats.closestHitRays;
+        mStats.pathVertices = totalPathVertices;
+        mStats.volumeLookups = totalVolumeLookups;
+        mStats.avgVisibilityRays = (float)mStats.visibilityRays / numPixels;
+        mStats.avgClosestHitRays = (float)mStats.closestHitRays / numPixels;
+        mStats.avgTotalRays = (float)mStats.totalRays / numPixels;
+        mStats.avgPathLength = (float)totalPathLength / numPixels;
+        mStats.avgPathVertices = (float)totalPathVertices / numPixels;
+        mStats.avgVolumeLookups = (float)totalVolumeLookups / numPixels;
+
+        mpReductionResult->unmap();
+        mStatsValid = true;
     }
 
     pybind11::dict PixelStats::Stats::toPython() const
@@ -29,6 +29,7 @@
 #include "Falcor.h"
 #include "PixelStatsShared.slang"
 #include "Utils/Algorithm/ComputeParallelReduction.h"
+#include "Utils/Algorithm/ReadbackRing.h"
 
 namespace Falcor
 {
@@ -37,6 +38,10 @@ namespace Falcor
         Per-pixel stats are logged in buffers on the GPU, which are immediately ready for consumption
         after end() is called. These stats are summarized in a reduction pass, which are
         available in getStats() or printStats() after async readback to the CPU.
+
+        The reduction results of the last few frames are kept in a readback ring. The UI
+        shows the latest results that are available without stalling, while getStats()
+        waits for the results of the last frame.
     */
     class FALCOR_API PixelStats
     {
@@ -107,15 +112,20 @@ namespace Falcor
 
     protected:
         PixelStats();
-        void copyStatsToCPU();
+        void copyStatsToCPU(bool waitForLastFrame);
         void computeRayCountTexture(RenderContext* pRenderContext);
 
         static const uint32_t kRayTypeCount = (uint32_t)PixelStatsRayType::Count;
+        static const uint32_t kResultCount = kRayTypeCount + 3;     ///< Number of reduction results per frame.
+        static const uint32_t kReadbackSlotCount = 3;               ///< Number of frames that can be in flight for readback.
 
         // Internal state
         ComputeParallelReduction::SharedPtr mpParallelReduction;            ///< Helper for parallel reduction on the GPU.
-        Buffer::SharedPtr                   mpReductionResult;              ///< Results buffer for stats readback (CPU mappable).
+        Buffer::SharedPtr                   mpReductionResult;              ///< Results buffer for stats readback with one slot per frame in flight (CPU mappable).
         GpuFence::SharedPtr                 mpFence;                        ///< GPU fence for sychronizing readback.
+        ReadbackRing                        mReadbackRing = ReadbackRing(kReadbackSlotCount); ///< Bookkeeping for pending readback slots.
+        uint32_t                            mSlotPixelCount[kReadbackSlotCount] = {}; ///< Number of pixels of the frame stored in each readback slot.
+        uint64_t                            mFrameCount = 0;                ///< Number of frames with stats collected.
 
         // Configuration
         bool                                mEnabled = false;               ///< Enable pixel statistics.
@@ -123,7 +133,6 @@ namespace Falcor
 
         // Runtime data
         bool                                mRunning = false;               ///< True inbetween begin() / end() calls.
-        bool                                mWaitingForData = false;        ///< True if we are waiting for data to become available on the GPU.
         uint2                               mFrameDim = { 0, 0 };           ///< Frame dimensions at last call to begin().
 
         bool                                mStatsValid = false;            ///< True if stats have been read back and are valid.
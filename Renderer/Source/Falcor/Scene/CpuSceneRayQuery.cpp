@@ -0,0 +1,571 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "CpuSceneRayQuery.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kBatchChunkSize = 64;      ///< Number of rays per parallel work item in batch queries.
+        const uint32_t kCompactLeafSize = 4;    ///< Max number of triangles per leaf of the bottom-level BVHs in compact mode.
+
+        float3 transformPoint(const float4x4& m, const float3& p)
+        {
+            return float3(m * float4(p, 1.f));
+        }
+
+        float3 transformVector(const float4x4& m, const float3& v)
+        {
+            return float3(m * float4(v, 0.f));
+        }
+    }
+
+    CpuSceneRayQuery::SharedPtr CpuSceneRayQuery::create(const Scene::SceneData& sceneData, const Options& options)
+    {
+        return SharedPtr(new CpuSceneRayQuery(sceneData, options));
+    }
+
+    CpuSceneRayQuery::CpuSceneRayQuery(const Scene::SceneData& sceneData, const Options& options)
+        : mOptions(options)
+    {
+        checkArgument(options.width == 4 || options.width == 8, "'width' must be 4 or 8 (got {}).", options.width);
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        // Compute global transforms. Parent nodes are always stored before their children.
+        const auto& sceneGraph = sceneData.sceneGraph;
+        std::vector<float4x4> globalMatrices(sceneGraph.size());
+        for (size_t i = 0; i < sceneGraph.size(); i++)
+        {
+            const auto& node = sceneGraph[i];
+            FALCOR_ASSERT(node.parent == Scene::kInvalidNode || node.parent < i);
+            globalMatrices[i] = node.parent == Scene::kInvalidNode ? node.transform : globalMatrices[node.parent] * node.transform;
+        }
+
+        for (size_t i = 0; i < sceneData.meshInstanceData.size(); i++)
+        {
+            const GeometryInstanceData& instanceData = sceneData.meshInstanceData[i];
+            FALCOR_ASSERT(instanceData.getType() == GeometryType::TriangleMesh || instanceData.getType() == GeometryType::DisplacedTriangleMesh);
+            checkArgument(instanceData.geometryID < sceneData.meshDesc.size(), "Mesh instance {} references invalid mesh ID {}.", i, instanceData.geometryID);
+            checkArgument(instanceData.globalMatrixID < globalMatrices.size(), "Mesh instance {} references invalid node ID {}.", i, instanceData.globalMatrixID);
+        }
+
+        // Build the bottom level and setup the instances.
+        if (mOptions.compact) setupMeshGroups(sceneData, globalMatrices);
+        else setupMeshes(sceneData, globalMatrices);
+
+        if (mOptions.width == 8) buildTopLevel(mTopNodes8);
+        else buildTopLevel(mTopNodes4);
+
+        logInfo("CpuSceneRayQuery: Built {}{}-wide BVHs for {} meshes, {} instances and {} triangles in {:.2f} ms ({:.1f} MB).",
+            mOptions.compact ? "compact " : "", mOptions.width, mMeshes.size(), mInstances.size(), getTriangleCount(),
+            CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()), getMemoryUsageInBytes() / (1024.0 * 1024.0));
+    }
+
+    void CpuSceneRayQuery::updateTransforms(const std::vector<float4x4>& globalMatrices)
+    {
+        auto range = NumericRange<size_t>(0, mInstances.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            Instance& instance = mInstances[i];
+            if (instance.globalMatrixID == kInvalidIndex) return;
+            FALCOR_ASSERT(instance.globalMatrixID < globalMatrices.size());
+            updateInstanceBounds(instance, globalMatrices[instance.globalMatrixID]);
+        });
+
+        if (mOptions.width == 8) refitTopLevel(mTopNodes8);
+        else refitTopLevel(mTopNodes4);
+    }
+
+    void CpuSceneRayQuery::updateMeshPositions(uint32_t meshID, const float3* positions)
+    {
+        checkArgument(meshID < mMeshes.size(), "'meshID' is out of range.");
+        Mesh& mesh = mMeshes[meshID];
+        checkArgument(mesh.isDynamic, "Mesh {} is not dynamic and can't be refit.", meshID);
+        FALCOR_ASSERT(positions);
+
+        uint32_t blasID = meshID;
+        if (mOptions.compact)
+        {
+            // Dynamic meshes are never in static groups, so the positions are stored in object space.
+            FALCOR_ASSERT(mesh.positionOffset != kInvalidIndex);
+            std::copy(positions, positions + mesh.vertexCount, mPositions.begin() + mesh.positionOffset);
+            if (mesh.groupID == kInvalidIndex) return;
+
+            MeshGroup& group = mMeshGroups[mesh.groupID];
+            std::vector<AABB> primBounds = computeTriangleBounds(group);
+            group.bvh.refit(primBounds.data());
+            blasID = mesh.groupID;
+        }
+        else
+        {
+            std::vector<float3> trianglePositions(mesh.indices.size());
+            for (size_t i = 0; i < mesh.indices.size(); i++) trianglePositions[i] = positions[mesh.indices[i]];
+            mesh.bvh.refit(trianglePositions.data());
+        }
+
+        for (auto& instance : mInstances)
+        {
+            if (instance.blasID == blasID) updateInstanceBounds(instance, instance.objectToWorld);
+        }
+
+        if (mOptions.width == 8) refitTopLevel(mTopNodes8);
+        else refitTopLevel(mTopNodes4);
+    }
+
+    bool CpuSceneRayQuery::intersect(const Ray& ray, Hit& hit) const
+    {
+        hit = Hit();
+        return mOptions.width == 8 ? traverse<8, false>(mTopNodes8, ray, hit) : traverse<4, false>(mTopNodes4, ray, hit);
+    }
+
+    bool CpuSceneRayQuery::intersectAny(const Ray& ray, Hit& hit) const
+    {
+        hit = Hit();
+        return mOptions.width == 8 ? traverse<8, true>(mTopNodes8, ray, hit) : traverse<4, true>(mTopNodes4, ray, hit);
+    }
+
+    bool CpuSceneRayQuery::occluded(const Ray& ray) const
+    {
+        Hit hit;
+        return mOptions.width == 8 ? traverse<8, true>(mTopNodes8, ray, hit) : traverse<4, true>(mTopNodes4, ray, hit);
+    }
+
+    void CpuSceneRayQuery::intersect(const Ray* rays, Hit* hits, size_t count) const
+    {
+        auto range = NumericRange<size_t>(0, div_round_up(count, kBatchChunkSize));
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t chunk)
+        {
+            const size_t end = std::min(count, (chunk + 1) * kBatchChunkSize);
+            for (size_t i = chunk * kBatchChunkSize; i < end; i++) intersect(rays[i], hits[i]);
+        });
+    }
+
+    void CpuSceneRayQuery::intersectAny(const Ray* rays, Hit* hits, size_t count) const
+    {
+        auto range = NumericRange<size_t>(0, div_round_up(count, kBatchChunkSize));
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t chunk)
+        {
+            const size_t end = std::min(count, (chunk + 1) * kBatchChunkSize);
+            for (size_t i = chunk * kBatchChunkSize; i < end; i++) intersectAny(rays[i], hits[i]);
+        });
+    }
+
+    void CpuSceneRayQuery::occluded(const Ray* rays, bool* occluded, size_t count) const
+    {
+        auto range = NumericRange<size_t>(0, div_round_up(count, kBatchChunkSize));
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t chunk)
+        {
+            const size_t end = std::min(count, (chunk + 1) * kBatchChunkSize);
+            for (size_t i = chunk * kBatchChunkSize; i < end; i++) occluded[i] = this->occluded(rays[i]);
+        });
+    }
+
+    uint64_t CpuSceneRayQuery::getTriangleCount() const
+    {
+        uint64_t count = 0;
+        for (const auto& instance : mInstances)
+        {
+            count += mOptions.compact ? mMeshGroups[instance.blasID].triangleOffsets.back() : mMeshes[instance.blasID].triangleCount;
+        }
+        return count;
+    }
+
+    AABB CpuSceneRayQuery::getBounds() const
+    {
+        AABB bounds;
+        for (const auto& instance : mInstances) bounds.include(instance.worldBounds);
+        return bounds;
+    }
+
+    uint64_t CpuSceneRayQuery::getMemoryUsageInBytes() const
+    {
+        uint64_t size = mInstances.size() * sizeof(Instance) + mTopNodes4.size() * sizeof(WideBVHNode<4>) + mTopNodes8.size() * sizeof(WideBVHNode<8>);
+        size += mMeshes.size() * sizeof(Mesh) + mPositions.size() * sizeof(float3) + mIndexData.size() * sizeof(uint32_t) + mMeshTransforms.size() * sizeof(float4x4);
+        for (const auto& mesh : mMeshes) size += mesh.bvh.getMemoryUsageInBytes() + mesh.indices.size() * sizeof(uint32_t);
+        for (const auto& group : mMeshGroups)
+        {
+            size += sizeof(MeshGroup) + group.bvh.getMemoryUsageInBytes() + (group.meshList.size() + group.triangleOffsets.size()) * sizeof(uint32_t);
+        }
+        return size;
+    }
+
+    void CpuSceneRayQuery::setupMeshes(const Scene::SceneData& sceneData, const std::vector<float4x4>& globalMatrices)
+    {
+        // Each mesh gets its own BVH in object space.
+        mMeshes.resize(sceneData.meshDesc.size());
+        auto meshRange = NumericRange<uint32_t>(0, (uint32_t)mMeshes.size());
+        std::for_each(std::execution::par, meshRange.begin(), meshRange.end(), [&](uint32_t meshID)
+        {
+            const MeshDesc& meshDesc = sceneData.meshDesc[meshID];
+            const uint32_t vertexCount = 3 * meshDesc.getTriangleCount();
+            const uint32_t* pIndices = meshDesc.indexCount > 0 ? &sceneData.meshIndexData[meshDesc.ibOffset] : nullptr;
+            const bool use16BitIndices = meshDesc.use16BitIndices();
+
+            std::vector<uint32_t> indices(vertexCount);
+            std::vector<float3> positions(vertexCount);
+            for (uint32_t i = 0; i < vertexCount; i++)
+            {
+                uint32_t index = i;
+                if (pIndices) index = use16BitIndices ? reinterpret_cast<const uint16_t*>(pIndices)[i] : pIndices[i];
+                indices[i] = index;
+                positions[i] = sceneData.meshStaticData[meshDesc.vbOffset + index].position;
+            }
+
+            Mesh& mesh = mMeshes[meshID];
+            mesh.triangleCount = meshDesc.getTriangleCount();
+            mesh.isDynamic = meshDesc.isDynamic();
+            mesh.bvh.build(positions.data(), mesh.triangleCount, mOptions.width);
+            if (mesh.isDynamic) mesh.indices = std::move(indices);
+        });
+
+        // One instance per mesh instance.
+        mInstances.resize(sceneData.meshInstanceData.size());
+        for (size_t i = 0; i < mInstances.size(); i++)
+        {
+            const GeometryInstanceData& instanceData = sceneData.meshInstanceData[i];
+            Instance& instance = mInstances[i];
+            instance.blasID = instanceData.geometryID;
+            instance.instanceID = (uint32_t)i;
+            instance.globalMatrixID = instanceData.globalMatrixID;
+            updateInstanceBounds(instance, globalMatrices[instance.globalMatrixID]);
+        }
+    }
+
+    void CpuSceneRayQuery::setupMeshGroups(const Scene::SceneData& sceneData, const std::vector<float4x4>& globalMatrices)
+    {
+        checkArgument(!sceneData.meshGroups.empty() || sceneData.meshDesc.empty(), "Compact mode requires the scene's mesh groups.");
+
+        // Either copy the positions and the packed index data, or reference the scene data and only copy the positions of dynamic meshes.
+        const bool copySceneData = mOptions.copySceneData;
+        if (copySceneData)
+        {
+            mPositions.resize(sceneData.meshStaticData.size());
+            for (size_t i = 0; i < mPositions.size(); i++) mPositions[i] = sceneData.meshStaticData[i].position;
+            mIndexData = sceneData.meshIndexData;
+        }
+        else
+        {
+            size_t dynamicVertexCount = 0;
+            for (const auto& meshDesc : sceneData.meshDesc) dynamicVertexCount += meshDesc.isDynamic() ? meshDesc.vertexCount : 0;
+            mPositions.reserve(dynamicVertexCount);
+        }
+        const uint32_t* pIndexData = copySceneData ? mIndexData.data() : sceneData.meshIndexData.data();
+
+        std::vector<std::vector<uint32_t>> meshInstances(sceneData.meshDesc.size());
+        for (uint32_t i = 0; i < (uint32_t)sceneData.meshInstanceData.size(); i++) meshInstances[sceneData.meshInstanceData[i].geometryID].push_back(i);
+
+        mMeshes.resize(sceneData.meshDesc.size());
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
+        {
+            const MeshDesc& meshDesc = sceneData.meshDesc[meshID];
+            Mesh& mesh = mMeshes[meshID];
+            mesh.triangleCount = meshDesc.getTriangleCount();
+            mesh.isDynamic = meshDesc.isDynamic();
+            mesh.vertexCount = meshDesc.vertexCount;
+            checkArgument((size_t)meshDesc.vbOffset + meshDesc.vertexCount <= sceneData.meshStaticData.size(), "Mesh {} references vertices out of range.", meshID);
+
+            if (copySceneData || mesh.isDynamic)
+            {
+                mesh.positionOffset = copySceneData ? meshDesc.vbOffset : (uint32_t)mPositions.size();
+                if (!copySceneData)
+                {
+                    for (uint32_t i = 0; i < meshDesc.vertexCount; i++) mPositions.push_back(sceneData.meshStaticData[meshDesc.vbOffset + i].position);
+                }
+                // mPositions doesn't grow beyond its reserved size, so the pointer stays valid.
+                mesh.pPositions = reinterpret_cast<const uint8_t*>(mPositions.data() + mesh.positionOffset);
+                mesh.positionStride = (uint32_t)sizeof(float3);
+            }
+            else
+            {
+                mesh.pPositions = reinterpret_cast<const uint8_t*>(&sceneData.meshStaticData[meshDesc.vbOffset].position);
+                mesh.positionStride = (uint32_t)sizeof(PackedStaticVertexData);
+            }
+
+            if (meshDesc.indexCount > 0) mesh.pIndices = pIndexData + meshDesc.ibOffset;
+            mesh.use16BitIndices = meshDesc.use16BitIndices();
+        }
+
+        // Setup the groups and their instances with the same layout as the TLAS instance descs built by the scene.
+        // The instance ID of a group instance is the global geometry instance index of its first mesh.
+        mMeshGroups.resize(sceneData.meshGroups.size());
+        uint32_t instanceID = 0;
+        for (uint32_t groupID = 0; groupID < (uint32_t)mMeshGroups.size(); groupID++)
+        {
+            const auto& meshGroup = sceneData.meshGroups[groupID];
+            checkArgument(!meshGroup.meshList.empty(), "Mesh group {} is empty.", groupID);
+
+            MeshGroup& group = mMeshGroups[groupID];
+            group.triangleOffsets.push_back(0);
+            for (uint32_t meshID : meshGroup.meshList)
+            {
+                checkArgument(meshID < mMeshes.size() && mMeshes[meshID].groupID == kInvalidIndex, "Mesh group {} references invalid mesh ID {}.", groupID, meshID);
+                checkArgument(!meshGroup.isStatic || !mMeshes[meshID].isDynamic, "Mesh group {} is static but contains dynamic mesh {}.", groupID, meshID);
+                mMeshes[meshID].groupID = groupID;
+                group.meshList.push_back(meshID);
+                group.triangleOffsets.push_back(group.triangleOffsets.back() + mMeshes[meshID].triangleCount);
+            }
+
+            const uint32_t geometryCount = (uint32_t)group.meshList.size();
+            const uint32_t instanceCount = (uint32_t)meshInstances[group.meshList[0]].size();
+            checkArgument(!meshGroup.isStatic || instanceCount == 1, "Static mesh group {} must have a single instance.", groupID);
+
+            for (uint32_t instanceIndex = 0; instanceIndex < instanceCount; instanceIndex++)
+            {
+                for (uint32_t geometryIndex = 0; geometryIndex < geometryCount; geometryIndex++)
+                {
+                    const auto& instances = meshInstances[group.meshList[geometryIndex]];
+                    checkArgument(instanceIndex < instances.size() && instances[instanceIndex] == instanceID + geometryIndex,
+                        "Mesh instances don't follow the layout of mesh group {}.", groupID);
+                }
+
+                Instance instance;
+                instance.blasID = groupID;
+                instance.instanceID = instanceID;
+                instance.globalMatrixID = meshGroup.isStatic ? kInvalidIndex : sceneData.meshInstanceData[instanceID].globalMatrixID;
+                mInstances.push_back(instance);
+                instanceID += geometryCount;
+            }
+
+            // Meshes in static groups are in world space. Copied positions are pre-transformed, referenced ones are transformed on access.
+            // Static meshes from SceneBuilder are already pre-transformed and have an identity transform.
+            if (meshGroup.isStatic)
+            {
+                for (uint32_t meshID : group.meshList)
+                {
+                    Mesh& mesh = mMeshes[meshID];
+                    const float4x4& transform = globalMatrices[sceneData.meshInstanceData[meshInstances[meshID][0]].globalMatrixID];
+                    if (transform == float4x4(1.f)) continue;
+
+                    if (copySceneData)
+                    {
+                        for (uint32_t i = mesh.positionOffset; i < mesh.positionOffset + mesh.vertexCount; i++) mPositions[i] = transformPoint(transform, mPositions[i]);
+                    }
+                    else
+                    {
+                        mesh.transformID = (uint32_t)mMeshTransforms.size();
+                        mMeshTransforms.push_back(transform);
+                    }
+                }
+            }
+        }
+        checkArgument(instanceID == sceneData.meshInstanceData.size(), "Mesh groups don't cover all mesh instances.");
+
+        auto groupRange = NumericRange<uint32_t>(0, (uint32_t)mMeshGroups.size());
+        std::for_each(std::execution::par, groupRange.begin(), groupRange.end(), [&](uint32_t groupID)
+        {
+            MeshGroup& group = mMeshGroups[groupID];
+            std::vector<AABB> primBounds = computeTriangleBounds(group);
+            group.bvh.build(primBounds.data(), (uint32_t)primBounds.size(), mOptions.width, kCompactLeafSize);
+        });
+
+        for (auto& instance : mInstances)
+        {
+            updateInstanceBounds(instance, instance.globalMatrixID == kInvalidIndex ? float4x4(1.f) : globalMatrices[instance.globalMatrixID]);
+        }
+    }
+
+    std::vector<AABB> CpuSceneRayQuery::computeTriangleBounds(const MeshGroup& group) const
+    {
+        std::vector<AABB> primBounds(group.triangleOffsets.back());
+        for (size_t geometryIndex = 0; geometryIndex < group.meshList.size(); geometryIndex++)
+        {
+            const Mesh& mesh = mMeshes[group.meshList[geometryIndex]];
+            for (uint32_t triangleIndex = 0; triangleIndex < mesh.triangleCount; triangleIndex++)
+            {
+                float3 vertices[3];
+                getTriangleVertices(mesh, triangleIndex, vertices);
+                AABB& bounds = primBounds[group.triangleOffsets[geometryIndex] + triangleIndex];
+                for (const float3& v : vertices) bounds.include(v);
+            }
+        }
+        return primBounds;
+    }
+
+    void CpuSceneRayQuery::getTriangleVertices(const Mesh& mesh, uint32_t triangleIndex, float3 vertices[3]) const
+    {
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            uint32_t index = 3 * triangleIndex + i;
+            if (mesh.pIndices) index = mesh.use16BitIndices ? reinterpret_cast<const uint16_t*>(mesh.pIndices)[index] : mesh.pIndices[index];
+            vertices[i] = *reinterpret_cast<const float3*>(mesh.pPositions + (size_t)index * mesh.positionStride);
+        }
+
+        if (mesh.transformID != kInvalidIndex)
+        {
+            const float4x4& transform = mMeshTransforms[mesh.transformID];
+            for (uint32_t i = 0; i < 3; i++) vertices[i] = transformPoint(transform, vertices[i]);
+        }
+    }
+
+    const AABB& CpuSceneRayQuery::getBottomLevelBounds(uint32_t blasID) const
+    {
+        return mOptions.compact ? mMeshGroups[blasID].bvh.getBounds() : mMeshes[blasID].bvh.getBounds();
+    }
+
+    void CpuSceneRayQuery::updateInstanceBounds(Instance& instance, const float4x4& objectToWorld)
+    {
+        instance.objectToWorld = objectToWorld;
+        instance.worldToObject = glm::inverse(objectToWorld);
+        instance.worldBounds = getBottomLevelBounds(instance.blasID).transform(objectToWorld);
+    }
+
+    template<uint32_t kWidth>
+    void CpuSceneRayQuery::buildTopLevel(std::vector<WideBVHNode<kWidth>>& nodes)
+    {
+        std::vector<AABB> instanceBounds(mInstances.size());
+        for (size_t i = 0; i < mInstances.size(); i++) instanceBounds[i] = mInstances[i].worldBounds;
+
+        // Each leaf holds a single instance, which lets the leaf index be the instance index.
+        std::vector<uint32_t> instanceRefs;
+        buildWideBVH(instanceBounds.data(), (uint32_t)instanceBounds.size(), 1, nodes, instanceRefs);
+        for (auto& node : nodes)
+        {
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                if (node.isValid(i) && node.count[i] > 0) node.index[i] = instanceRefs[node.index[i]];
+            }
+        }
+    }
+
+    template<uint32_t kWidth>
+    void CpuSceneRayQuery::refitTopLevel(std::vector<WideBVHNode<kWidth>>& nodes)
+    {
+        // Child nodes are always allocated after their parent, so a reverse sweep visits children first.
+        for (size_t n = nodes.size(); n-- > 0;)
+        {
+            auto& node = nodes[n];
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                if (!node.isValid(i)) continue;
+                node.setChildBounds(i, node.count[i] > 0 ? mInstances[node.index[i]].worldBounds : nodes[node.index[i]].getBounds());
+            }
+        }
+    }
+
+    template<uint32_t kWidth, bool kAnyHit>
+    bool CpuSceneRayQuery::traverse(const std::vector<WideBVHNode<kWidth>>& nodes, const Ray& ray, Hit& hit) const
+    {
+        if (nodes.empty()) return false;
+
+        const float3 invDir = ray.getInvDir();
+        const float3 originScaled = -ray.origin * invDir;
+        float tMax = ray.tMax;
+        bool found = false;
+
+        BVHStackEntry stack[BVHStackEntry::kMaxSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = { 0, 0, ray.tMin };
+
+        while (stackSize > 0)
+        {
+            const BVHStackEntry entry = stack[--stackSize];
+            if (entry.tNear > tMax) continue;
+
+            if (entry.count > 0)
+            {
+                // Instance leaf: continue in the bottom level with the ray in object space.
+                // The direction is not normalized, so hit distances stay in world space units.
+                const Instance& instance = mInstances[entry.index];
+                const Ray localRay(transformPoint(instance.worldToObject, ray.origin), transformVector(instance.worldToObject, ray.dir), ray.tMin, tMax);
+
+                if (mOptions.compact)
+                {
+                    if (intersectMeshGroup<kAnyHit>(instance, localRay, hit))
+                    {
+                        if (kAnyHit) return true;
+                        found = true;
+                        tMax = hit.t;
+                    }
+                    continue;
+                }
+
+                const TriangleBVH& bvh = mMeshes[instance.blasID].bvh;
+                TriangleBVH::Hit localHit;
+                if (kAnyHit ? bvh.intersectAny(localRay, localHit) : bvh.intersect(localRay, localHit))
+                {
+                    found = true;
+                    tMax = localHit.t;
+                    hit.instanceID.index = instance.instanceID;
+                    hit.primitiveIndex = localHit.primitiveIndex;
+                    hit.barycentrics = localHit.barycentrics;
+                    hit.t = localHit.t;
+                    if (kAnyHit) return true;
+                }
+                continue;
+            }
+
+            const auto& node = nodes[entry.index];
+            float tNear[kWidth];
+            const uint32_t hitMask = node.intersect(invDir, originScaled, ray.tMin, tMax, tNear);
+
+            pushHitChildren<kWidth>(node, hitMask, tNear, stack, stackSize);
+        }
+
+        return found;
+    }
+
+    template<bool kAnyHit>
+    bool CpuSceneRayQuery::intersectMeshGroup(const Instance& instance, const Ray& ray, Hit& hit) const
+    {
+        const MeshGroup& group = mMeshGroups[instance.blasID];
+
+        auto intersectTriangle = [&](uint32_t groupTriangleIndex, float& tMax)
+        {
+            // Find the mesh containing the triangle. Most groups hold a single mesh.
+            uint32_t geometryIndex = 0;
+            if (group.meshList.size() > 1)
+            {
+                auto it = std::upper_bound(group.triangleOffsets.begin(), group.triangleOffsets.end(), groupTriangleIndex);
+                geometryIndex = (uint32_t)(it - group.triangleOffsets.begin()) - 1;
+            }
+            const uint32_t triangleIndex = groupTriangleIndex - group.triangleOffsets[geometryIndex];
+
+            float3 vertices[3];
+            getTriangleVertices(mMeshes[group.meshList[geometryIndex]], triangleIndex, vertices);
+
+            float t;
+            float2 barycentrics;
+            if (!TriangleBVH::intersectTriangle(ray, vertices[0], vertices[1] - vertices[0], vertices[2] - vertices[0], tMax, t, barycentrics)) return false;
+
+            tMax = t;
+            hit.instanceID.index = instance.instanceID + geometryIndex;
+            hit.primitiveIndex = triangleIndex;
+            hit.barycentrics = barycentrics;
+            hit.t = t;
+            return true;
+        };
+
+        return group.bvh.traverse<kAnyHit>(ray, intersectTriangle);
+    }
+}
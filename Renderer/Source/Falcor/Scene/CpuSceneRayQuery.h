@@ -0,0 +1,239 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Framework.h"
+#include "Scene/Scene.h"
+#include "Utils/Geometry/QuantizedBVH.h"
+#include "Utils/Geometry/TriangleBVH.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** Ray queries against the triangle meshes of a scene on the CPU.
+
+        This is meant for tools that need a handful to a few million ray queries without
+        a round trip to the GPU, e.g. picking, scene validation or probe placement.
+
+        The acceleration structure has two levels like the DXR one. Each mesh has its own
+        TriangleBVH in object space, shared by all instances of the mesh. The top level is
+        a wide BVH over the world-space bounds of the mesh instances. Rays are transformed
+        into object space at the instance leaves. Both levels use the same branching factor,
+        which is 4 or 8.
+
+        Hits report the same IDs as TriangleHit in HitInfo.slang: the global geometry
+        instance index (mesh instances come first in the scene's instance list) and the
+        triangle index within the mesh. All geometry is treated as opaque and displacement
+        mapping is ignored.
+
+        The compact mode is meant for very large scenes and trades traversal speed for memory.
+        The bottom level then mirrors the scene's mesh groups, i.e. the BLASes of the GPU
+        acceleration structure: there is one QuantizedBVH per mesh group, shared by all
+        instances of the group, and meshes in static groups are pre-transformed to world space.
+        The leaves reference triangles by index and no per-triangle data is stored. By default,
+        vertex indices and positions are read directly from the scene's packed index and vertex
+        data, so the scene data must stay alive and unchanged while the object is used. Only the
+        positions of dynamic meshes are copied, to support refitting. With Options::copySceneData,
+        the index data and a position-only copy of the vertex data are kept instead, and meshes
+        in static groups are pre-transformed to world space in the copy.
+
+        For animation, the top level can be refit to new instance transforms, and the
+        bottom level of dynamic meshes can be refit to new vertex positions. Refitting keeps
+        the tree topologies, so queries get slower if the geometry moves far from its
+        build-time configuration.
+    */
+    class FALCOR_API CpuSceneRayQuery
+    {
+    public:
+        using SharedPtr = std::shared_ptr<CpuSceneRayQuery>;
+        using Ray = TriangleBVH::Ray;
+
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+        /** Configuration options.
+        */
+        struct Options
+        {
+            uint32_t width = 4;     ///< Branching factor of the BVHs, either 4 or 8.
+            bool compact = false;   ///< Use the compact mode with quantized BVHs per mesh group that reference the mesh index data.
+            bool copySceneData = false; ///< In compact mode, copy the index data and vertex positions instead of referencing the scene data.
+        };
+
+        /** Triangle hit. The fields match TriangleHit in HitInfo.slang.
+        */
+        struct Hit
+        {
+            GeometryInstanceID instanceID = { kInvalidIndex };  ///< Global geometry instance index.
+            uint32_t primitiveIndex = kInvalidIndex;            ///< Triangle index within the mesh.
+            float2 barycentrics;                                ///< Barycentrics (u, v) of the hit w.r.t. vertices 1 and 2.
+            float t = 0.f;                                      ///< Hit distance along the ray.
+
+            bool isValid() const { return instanceID.index != kInvalidIndex; }
+        };
+
+        /** Create the ray query structure.
+            In compact mode without Options::copySceneData, the object references the index and vertex data of the scene data,
+            which must stay alive and unchanged for the lifetime of the object. Otherwise the scene data can be released after this call.
+            \param[in] sceneData Scene data, e.g. from SceneBuilder::getSceneData().
+            \param[in] options Configuration options.
+            \return New object, or throws an exception on error.
+        */
+        static SharedPtr create(const Scene::SceneData& sceneData, const Options& options = Options());
+
+        /** Refit the top level to new instance transforms.
+            \param[in] globalMatrices Global matrices of all scene graph nodes, e.g. from AnimationController::getGlobalMatrices().
+        */
+        void updateTransforms(const std::vector<float4x4>& globalMatrices);
+
+        /** Refit the bottom level of a dynamic (skinned or vertex-animated) mesh to new vertex positions.
+            The top level is refit as well if the bounds of the mesh changed.
+            \param[in] meshID Mesh ID.
+            \param[in] positions Object-space vertex positions, mesh.vertexCount elements in the order of the mesh's vertex data.
+        */
+        void updateMeshPositions(uint32_t meshID, const float3* positions);
+
+        /** Find the closest hit along a ray.
+            \param[in] ray Ray in world space. Only hits in [tMin, tMax] are reported.
+            \param[out] hit Closest hit, invalid if nothing was hit.
+            \return True if a hit was found.
+        */
+        bool intersect(const Ray& ray, Hit& hit) const;
+
+        /** Find any hit along a ray. Traversal stops at the first hit found, which is not necessarily the closest one.
+            This is as fast as occluded() but also reports which instance and triangle blocked the ray.
+            \param[in] ray Ray in world space. Only hits in [tMin, tMax] are reported.
+            \param[out] hit First hit found, invalid if nothing was hit.
+            \return True if a hit was found.
+        */
+        bool intersectAny(const Ray& ray, Hit& hit) const;
+
+        /** Check if anything is hit along a ray.
+            \param[in] ray Ray in world space. Only hits in [tMin, tMax] are considered.
+            \return True if any hit was found.
+        */
+        bool occluded(const Ray& ray) const;
+
+        /** Find the closest hits for a batch of rays. The batch is split into chunks that are processed in parallel.
+            \param[in] rays Rays in world space.
+            \param[out] hits Closest hit for each ray.
+            \param[in] count Number of rays.
+        */
+        void intersect(const Ray* rays, Hit* hits, size_t count) const;
+
+        /** Find any hit for a batch of rays. The batch is split into chunks that are processed in parallel.
+            \param[in] rays Rays in world space.
+            \param[out] hits First hit found for each ray.
+            \param[in] count Number of rays.
+        */
+        void intersectAny(const Ray* rays, Hit* hits, size_t count) const;
+
+        /** Check visibility for a batch of rays. The batch is split into chunks that are processed in parallel.
+            \param[in] rays Rays in world space.
+            \param[out] occluded True for each ray that hits anything.
+            \param[in] count Number of rays.
+        */
+        void occluded(const Ray* rays, bool* occluded, size_t count) const;
+
+        const Options& getOptions() const { return mOptions; }
+        uint32_t getMeshCount() const { return (uint32_t)mMeshes.size(); }
+        uint32_t getInstanceCount() const { return (uint32_t)mInstances.size(); }
+        uint64_t getTriangleCount() const;
+        AABB getBounds() const;
+        uint64_t getMemoryUsageInBytes() const;
+
+    private:
+        CpuSceneRayQuery(const Scene::SceneData& sceneData, const Options& options);
+
+        struct Mesh
+        {
+            uint32_t triangleCount = 0;
+            bool isDynamic = false;
+
+            // Standard mode.
+            TriangleBVH bvh;                    ///< Bottom-level BVH in object space.
+            std::vector<uint32_t> indices;      ///< Vertex indices, three per triangle. Only kept for dynamic meshes to support refit.
+
+            // Compact mode.
+            uint32_t groupID = kInvalidIndex;   ///< Mesh group that contains the mesh.
+            uint32_t vertexCount = 0;
+            const uint8_t* pPositions = nullptr;        ///< Position of the first vertex, in the scene's vertex data or in mPositions.
+            uint32_t positionStride = 0;                ///< Distance between the positions of consecutive vertices in bytes.
+            uint32_t positionOffset = kInvalidIndex;    ///< Offset into mPositions, or kInvalidIndex if the positions are read from the scene data.
+            uint32_t transformID = kInvalidIndex;       ///< Index into mMeshTransforms if the positions must be transformed to the space of the group.
+            const uint32_t* pIndices = nullptr;         ///< Index data of the mesh, or nullptr if non-indexed.
+            bool use16BitIndices = false;
+        };
+
+        /** Bottom level in compact mode. Mirrors a mesh group of the scene.
+        */
+        struct MeshGroup
+        {
+            QuantizedBVH bvh;                       ///< BVH over all triangles of the group. Primitives are triangle indices within the group.
+            std::vector<uint32_t> meshList;         ///< Mesh IDs, indexed by geometry index.
+            std::vector<uint32_t> triangleOffsets;  ///< Index of the first triangle of each mesh within the group, followed by the total count.
+        };
+
+        struct Instance
+        {
+            uint32_t blasID;                ///< Mesh ID, or mesh group ID in compact mode.
+            uint32_t instanceID;            ///< Global geometry instance index of the first geometry in the bottom level.
+            uint32_t globalMatrixID;        ///< Node ID, or kInvalidIndex if the bottom level is in world space.
+            float4x4 objectToWorld;
+            float4x4 worldToObject;
+            AABB worldBounds;
+        };
+
+        void setupMeshes(const Scene::SceneData& sceneData, const std::vector<float4x4>& globalMatrices);
+        void setupMeshGroups(const Scene::SceneData& sceneData, const std::vector<float4x4>& globalMatrices);
+        std::vector<AABB> computeTriangleBounds(const MeshGroup& group) const;
+        void getTriangleVertices(const Mesh& mesh, uint32_t triangleIndex, float3 vertices[3]) const;
+        const AABB& getBottomLevelBounds(uint32_t blasID) const;
+        void updateInstanceBounds(Instance& instance, const float4x4& objectToWorld);
+
+        template<uint32_t kWidth>
+        void buildTopLevel(std::vector<WideBVHNode<kWidth>>& nodes);
+
+        template<uint32_t kWidth>
+        void refitTopLevel(std::vector<WideBVHNode<kWidth>>& nodes);
+
+        template<uint32_t kWidth, bool kAnyHit>
+        bool traverse(const std::vector<WideBVHNode<kWidth>>& nodes, const Ray& ray, Hit& hit) const;
+
+        template<bool kAnyHit>
+        bool intersectMeshGroup(const Instance& instance, const Ray& ray, Hit& hit) const;
+
+        Options mOptions;
+        std::vector<Mesh> mMeshes;
+        std::vector<MeshGroup> mMeshGroups;         ///< Bottom level in compact mode.
+        std::vector<float3> mPositions;             ///< Vertex positions owned by the object in compact mode. All positions if the scene data is copied, otherwise those of dynamic meshes.
+        std::vector<uint32_t> mIndexData;           ///< Copy of the scene's packed index data in compact mode, if the scene data is copied.
+        std::vector<float4x4> mMeshTransforms;      ///< Object-to-world transforms of referenced meshes in static groups in compact mode.
+        std::vector<Instance> mInstances;           ///< Bottom-level instances.
+        std::vector<WideBVHNode<4>> mTopNodes4;     ///< Top-level nodes if the width is 4.
+        std::vector<WideBVHNode<8>> mTopNodes8;     ///< Top-level nodes if the width is 8.
+    };
+}
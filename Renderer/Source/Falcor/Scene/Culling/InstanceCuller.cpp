@@ -0,0 +1,331 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "InstanceCuller.h"
+#include "Utils/NumericRange.h"
+#include <execution>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBlocksPerChunk = 64;    ///< Number of blocks culled per parallel work item.
+        const float kMinClipW = 1e-5f;          ///< Minimum clip space w of points in front of the camera.
+        const uint32_t kCoverageGridSize = 5;   ///< Occluder coverage is sampled on a grid of kCoverageGridSize^2 points per pixel, including the pixel corners.
+
+        struct FrustumPlane
+        {
+            float3 normal;
+            float w;
+        };
+
+        /** Extract the frustum planes from a view-projection matrix. Points p inside the frustum satisfy dot(p, normal) + w > 0 for all planes.
+            See: https://fgiesen.wordpress.com/2012/08/31/frustum-planes-from-the-projection-matrix/
+        */
+        void extractFrustumPlanes(const glm::mat4& viewProj, FrustumPlane planes[6])
+        {
+            glm::mat4 tempMat = glm::transpose(viewProj);
+            for (int i = 0; i < 6; i++)
+            {
+                float4 plane = (i & 1) ? tempMat[i >> 1] : -tempMat[i >> 1];
+                if (i != 5) // Z range is [0, w]. For the 0 <= z plane we don't need to add w
+                {
+                    plane += tempMat[3];
+                }
+                planes[i] = { float3(plane), plane.w };
+            }
+        }
+
+        float3 projectToScreen(const float4& clipPos, uint32_t width, uint32_t height)
+        {
+            float3 ndc = float3(clipPos) / clipPos.w;
+            return float3((ndc.x * 0.5f + 0.5f) * width, (0.5f - ndc.y * 0.5f) * height, ndc.z);
+        }
+    }
+
+    OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+        : mWidth(width)
+        , mHeight(height)
+        , mDepth((size_t)width * height, 1.f)
+    {
+        checkArgument(width > 0 && height > 0, "'width' and 'height' must be non-zero.");
+    }
+
+    void OcclusionBuffer::reset(const glm::mat4& viewProj)
+    {
+        mViewProj = viewProj;
+        std::fill(mDepth.begin(), mDepth.end(), 1.f);
+    }
+
+    void OcclusionBuffer::rasterizeTriangles(const float3* pPositions, const uint32_t* pIndices, uint32_t triangleCount, const glm::mat4& transform)
+    {
+        const glm::mat4 objectToClip = mViewProj * transform;
+
+        // Project the triangles to screen space and find the screen region they cover.
+        struct ScreenTriangle
+        {
+            float3 v[3];
+            float maxDepth;
+        };
+        std::vector<ScreenTriangle> triangles;
+        triangles.reserve(triangleCount);
+        float2 regionMin = float2(std::numeric_limits<float>::infinity());
+        float2 regionMax = float2(-std::numeric_limits<float>::infinity());
+
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            ScreenTriangle tri;
+            tri.maxDepth = 0.f;
+            bool clipped = false;
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                uint32_t index = pIndices ? pIndices[t * 3 + i] : t * 3 + i;
+                float4 clipPos = objectToClip * float4(pPositions[index], 1.f);
+                if (clipPos.w < kMinClipW)
+                {
+                    clipped = true;
+                    break;
+                }
+                tri.v[i] = projectToScreen(clipPos, mWidth, mHeight);
+                tri.maxDepth = std::max(tri.maxDepth, tri.v[i].z);
+                regionMin = glm::min(regionMin, float2(tri.v[i]));
+                regionMax = glm::max(regionMax, float2(tri.v[i]));
+            }
+            if (!clipped) triangles.push_back(tri);
+        }
+
+        const int x0 = std::max(0, (int)std::floor(regionMin.x));
+        const int x1 = std::min((int)mWidth, (int)std::ceil(regionMax.x));
+        const int y0 = std::max(0, (int)std::floor(regionMin.y));
+        const int y1 = std::min((int)mHeight, (int)std::ceil(regionMax.y));
+        if (triangles.empty() || x0 >= x1 || y0 >= y1) return;
+
+        // Accumulate per-pixel coverage of a grid of sample points (including the pixel corners) over all triangles,
+        // and the farthest depth of the triangles touching the pixel.
+        const uint32_t regionWidth = uint32_t(x1 - x0);
+        std::vector<uint32_t> coverage(regionWidth * uint32_t(y1 - y0), 0);
+        std::vector<float> maxDepth(coverage.size(), 0.f);
+
+        for (const auto& tri : triangles)
+        {
+            // Edge functions E(p) = (a * p.x + b * p.y + c) * s, oriented to be non-negative inside the triangle.
+            // The coefficients are computed from the edge endpoints in a canonical order, so that triangles sharing an edge evaluate it
+            // to exactly opposite values and points on the edge are covered by at least one of them.
+            const float3* v = tri.v;
+            float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+            if (area == 0.f) continue;
+            const float orientation = area > 0.f ? 1.f : -1.f;
+
+            float a[3], b[3], c[3], sign[3];
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                float2 p0 = float2(v[i]);
+                float2 p1 = float2(v[(i + 1) % 3]);
+                sign[i] = orientation;
+                if (p1.x < p0.x || (p1.x == p0.x && p1.y < p0.y))
+                {
+                    std::swap(p0, p1);
+                    sign[i] = -orientation;
+                }
+                a[i] = -(p1.y - p0.y);
+                b[i] = p1.x - p0.x;
+                c[i] = -(a[i] * p0.x + b[i] * p0.y);
+            }
+
+            const int tx0 = std::max(x0, (int)std::floor(std::min({ v[0].x, v[1].x, v[2].x })));
+            const int tx1 = std::min(x1, (int)std::ceil(std::max({ v[0].x, v[1].x, v[2].x })));
+            const int ty0 = std::max(y0, (int)std::floor(std::min({ v[0].y, v[1].y, v[2].y })));
+            const int ty1 = std::min(y1, (int)std::ceil(std::max({ v[0].y, v[1].y, v[2].y })));
+
+            for (int y = ty0; y < ty1; y++)
+            {
+                for (int x = tx0; x < tx1; x++)
+                {
+                    uint32_t mask = 0;
+                    for (uint32_t sy = 0; sy < kCoverageGridSize; sy++)
+                    {
+                        for (uint32_t sx = 0; sx < kCoverageGridSize; sx++)
+                        {
+                            const float px = (float)x + (float)sx / (kCoverageGridSize - 1);
+                            const float py = (float)y + (float)sy / (kCoverageGridSize - 1);
+                            bool inside = true;
+                            for (uint32_t i = 0; i < 3; i++) inside = inside && ((a[i] * px + b[i] * py + c[i]) * sign[i] >= 0.f);
+                            if (inside) mask |= 1u << (sy * kCoverageGridSize + sx);
+                        }
+                    }
+                    if (mask == 0) continue;
+
+                    const size_t i = (size_t)(y - y0) * regionWidth + (x - x0);
+                    coverage[i] |= mask;
+                    maxDepth[i] = std::max(maxDepth[i], tri.maxDepth);
+                }
+            }
+        }
+
+        const uint32_t kFullCoverage = (1u << (kCoverageGridSize * kCoverageGridSize)) - 1;
+        for (int y = y0; y < y1; y++)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                const size_t i = (size_t)(y - y0) * regionWidth + (x - x0);
+                if (coverage[i] != kFullCoverage) continue;
+                float& depth = mDepth[(size_t)y * mWidth + x];
+                depth = std::min(depth, maxDepth[i]);
+            }
+        }
+    }
+
+    bool OcclusionBuffer::isOccluded(const AABB& box) const
+    {
+        if (!box.valid()) return false;
+
+        float3 screenMin = float3(std::numeric_limits<float>::infinity());
+        float3 screenMax = float3(-std::numeric_limits<float>::infinity());
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            float3 corner = float3((i & 1) ? box.maxPoint.x : box.minPoint.x, (i & 2) ? box.maxPoint.y : box.minPoint.y, (i & 4) ? box.maxPoint.z : box.minPoint.z);
+            float4 clipPos = mViewProj * float4(corner, 1.f);
+            if (clipPos.w < kMinClipW) return false; // Box crosses the near plane.
+            float3 p = projectToScreen(clipPos, mWidth, mHeight);
+            screenMin = glm::min(screenMin, p);
+            screenMax = glm::max(screenMax, p);
+        }
+
+        // Only the on-screen part of the box can be visible.
+        const int x0 = std::max(0, (int)std::floor(screenMin.x));
+        const int x1 = std::min((int)mWidth - 1, (int)std::floor(screenMax.x));
+        const int y0 = std::max(0, (int)std::floor(screenMin.y));
+        const int y1 = std::min((int)mHeight - 1, (int)std::floor(screenMax.y));
+        if (x0 > x1 || y0 > y1) return false;
+
+        for (int y = y0; y <= y1; y++)
+        {
+            const float* pRow = mDepth.data() + (size_t)y * mWidth;
+            for (int x = x0; x <= x1; x++)
+            {
+                if (screenMin.z <= pRow[x]) return false;
+            }
+        }
+        return true;
+    }
+
+    void InstanceCuller::setBounds(const std::vector<AABB>& bounds)
+    {
+        FALCOR_ASSERT(bounds.size() <= std::numeric_limits<uint32_t>::max());
+        mBoundsCount = (uint32_t)bounds.size();
+        mBlocks.resize(div_round_up(mBoundsCount, kBlockSize));
+
+        // Invalid boxes are replaced by a box covering all of space so that they pass all plane tests.
+        const float kMax = std::numeric_limits<float>::max();
+        for (uint32_t i = 0; i < (uint32_t)mBlocks.size() * kBlockSize; i++)
+        {
+            BoundsBlock& block = mBlocks[i / kBlockSize];
+            const uint32_t lane = i % kBlockSize;
+            AABB box = i < mBoundsCount ? bounds[i] : AABB(float3(0.f));
+            block.cullable[lane] = box.valid() ? 1 : 0;
+            if (!box.valid()) box = AABB(float3(-kMax), float3(kMax));
+            block.minX[lane] = box.minPoint.x;
+            block.minY[lane] = box.minPoint.y;
+            block.minZ[lane] = box.minPoint.z;
+            block.maxX[lane] = box.maxPoint.x;
+            block.maxY[lane] = box.maxPoint.y;
+            block.maxZ[lane] = box.maxPoint.z;
+        }
+    }
+
+    uint32_t InstanceCuller::cull(const glm::mat4& viewProj, std::vector<uint8_t>& visible, const OcclusionBuffer* pOcclusionBuffer) const
+    {
+        visible.resize(mBoundsCount);
+        if (mBoundsCount == 0) return 0;
+
+        FrustumPlane planes[6];
+        extractFrustumPlanes(viewProj, planes);
+
+        const uint32_t blockCount = (uint32_t)mBlocks.size();
+        const uint32_t chunkCount = div_round_up(blockCount, kBlocksPerChunk);
+        std::vector<uint32_t> chunkVisibleCounts(chunkCount, 0);
+
+        auto range = NumericRange<uint32_t>(0, chunkCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t chunk)
+        {
+            uint32_t visibleCount = 0;
+            const uint32_t blockEnd = std::min(blockCount, (chunk + 1) * kBlocksPerChunk);
+            for (uint32_t blockIndex = chunk * kBlocksPerChunk; blockIndex < blockEnd; blockIndex++)
+            {
+                const BoundsBlock& block = mBlocks[blockIndex];
+
+                // For each plane, test the box corner farthest along the plane normal (the "positive vertex").
+                // See method 4b: https://fgiesen.wordpress.com/2010/10/17/view-frustum-culling/
+                uint32_t inside[kBlockSize];
+                for (uint32_t lane = 0; lane < kBlockSize; lane++) inside[lane] = 1;
+                for (const auto& plane : planes)
+                {
+                    const float* pX = plane.normal.x >= 0.f ? block.maxX : block.minX;
+                    const float* pY = plane.normal.y >= 0.f ? block.maxY : block.minY;
+                    const float* pZ = plane.normal.z >= 0.f ? block.maxZ : block.minZ;
+                    for (uint32_t lane = 0; lane < kBlockSize; lane++)
+                    {
+                        float d = pX[lane] * plane.normal.x + pY[lane] * plane.normal.y + pZ[lane] * plane.normal.z + plane.w;
+                        inside[lane] &= d > 0.f ? 1u : 0u;
+                    }
+                }
+
+                const uint32_t laneCount = std::min(kBlockSize, mBoundsCount - blockIndex * kBlockSize);
+                for (uint32_t lane = 0; lane < laneCount; lane++)
+                {
+                    bool isVisible = inside[lane] != 0;
+                    if (isVisible && pOcclusionBuffer && block.cullable[lane])
+                    {
+                        AABB box(float3(block.minX[lane], block.minY[lane], block.minZ[lane]), float3(block.maxX[lane], block.maxY[lane], block.maxZ[lane]));
+                        isVisible = !pOcclusionBuffer->isOccluded(box);
+                    }
+                    visible[blockIndex * kBlockSize + lane] = isVisible ? 1 : 0;
+                    visibleCount += isVisible ? 1 : 0;
+                }
+            }
+            chunkVisibleCounts[chunk] = visibleCount;
+        });
+
+        return std::accumulate(chunkVisibleCounts.begin(), chunkVisibleCounts.end(), 0u);
+    }
+
+    uint32_t InstanceCuller::compactDrawArgs(const void* pArgs, size_t argStride, const uint32_t* pInstanceIDs, uint32_t drawCount, const uint8_t* pVisible, void* pDstArgs)
+    {
+        const uint8_t* pSrc = static_cast<const uint8_t*>(pArgs);
+        uint8_t* pDst = static_cast<uint8_t*>(pDstArgs);
+        uint32_t visibleCount = 0;
+        for (uint32_t i = 0; i < drawCount; i++)
+        {
+            if (!pVisible[pInstanceIDs[i]]) continue;
+            std::memcpy(pDst + visibleCount * argStride, pSrc + i * argStride, argStride);
+            visibleCount++;
+        }
+        return visibleCount;
+    }
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/AABB.h"
+
+namespace Falcor
+{
+    /** Low-resolution CPU depth buffer for conservative occlusion culling.
+
+        Occluders are rasterized into the buffer one mesh at a time. A pixel is covered by a mesh if the mesh's triangles cover a grid
+        of sample points that includes the pixel corners, and stores the farthest depth of the triangles touching it. This is exact
+        for convex occluders such as quads and boxes, while gaps between samples are ignored for other shapes. A box is reported as
+        occluded only if its nearest depth is behind the stored depth in every pixel it overlaps.
+        Depth is normalized device depth in [0,1] with 0 at the near plane.
+    */
+    class FALCOR_API OcclusionBuffer
+    {
+    public:
+        OcclusionBuffer(uint32_t width = 256, uint32_t height = 128);
+
+        /** Clear the buffer and set the view-projection matrix used for rasterization and occlusion tests.
+        */
+        void reset(const glm::mat4& viewProj);
+
+        /** Rasterize the triangles of an occluder mesh.
+            Triangles that cross the near plane are skipped.
+            \param[in] pPositions Object space vertex positions.
+            \param[in] pIndices Vertex indices, three per triangle, or nullptr if the triangles are not indexed.
+            \param[in] triangleCount Number of triangles.
+            \param[in] transform Object to world transform.
+        */
+        void rasterizeTriangles(const float3* pPositions, const uint32_t* pIndices, uint32_t triangleCount, const glm::mat4& transform);
+
+        /** Test if a box is hidden behind the occluders rasterized so far.
+            \param[in] box World space box.
+            \return True if the box is guaranteed to be occluded.
+        */
+        bool isOccluded(const AABB& box) const;
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getHeight() const { return mHeight; }
+        const std::vector<float>& getDepth() const { return mDepth; }
+
+    private:
+        uint32_t mWidth;
+        uint32_t mHeight;
+        glm::mat4 mViewProj = glm::mat4(1.f);
+        std::vector<float> mDepth;
+    };
+
+    /** CPU culling of instance bounding boxes against a view frustum and, optionally, an occlusion buffer.
+
+        Boxes are stored in blocks of kBlockSize in structure-of-arrays layout, so that the frustum planes are tested against a whole
+        block per iteration with code the compiler vectorizes. Blocks are processed in parallel.
+    */
+    class FALCOR_API InstanceCuller
+    {
+    public:
+        static constexpr uint32_t kBlockSize = 8;
+
+        /** Set the world space bounding boxes to cull.
+            Invalid boxes (see AABB::valid()) are never culled. Use them for instances whose bounds are not known on the CPU.
+        */
+        void setBounds(const std::vector<AABB>& bounds);
+
+        /** Get the number of boxes.
+        */
+        uint32_t getBoundsCount() const { return mBoundsCount; }
+
+        /** Cull the boxes.
+            \param[in] viewProj View-projection matrix. Clip space depth is expected in [0,w].
+            \param[out] visible Visibility of each box, 1 if visible and 0 if culled.
+            \param[in] pOcclusionBuffer Optional occlusion buffer that boxes inside the frustum are tested against.
+            \return Number of visible boxes.
+        */
+        uint32_t cull(const glm::mat4& viewProj, std::vector<uint8_t>& visible, const OcclusionBuffer* pOcclusionBuffer = nullptr) const;
+
+        /** Compact draw arguments to the draws whose instance is visible, preserving their order.
+            \param[in] pArgs Draw arguments, argStride bytes per draw.
+            \param[in] argStride Size in bytes of the arguments of a draw.
+            \param[in] pInstanceIDs Index into 'visible' for each draw.
+            \param[in] drawCount Number of draws.
+            \param[in] pVisible Visibility of each instance, as returned by cull().
+            \param[out] pDstArgs Compacted draw arguments. Must have space for drawCount draws.
+            \return Number of visible draws written to pDstArgs.
+        */
+        static uint32_t compactDrawArgs(const void* pArgs, size_t argStride, const uint32_t* pInstanceIDs, uint32_t drawCount, const uint8_t* pVisible, void* pDstArgs);
+
+    private:
+        struct alignas(32) BoundsBlock
+        {
+            float minX[kBlockSize];
+            float minY[kBlockSize];
+            float minZ[kBlockSize];
+            float maxX[kBlockSize];
+            float maxY[kBlockSize];
+            float maxZ[kBlockSize];
+            uint32_t cullable[kBlockSize];  ///< 0 for boxes that are never culled.
+        };
+
+        std::vector<BoundsBlock> mBlocks;
+        uint32_t mBoundsCount = 0;
+    };
+}
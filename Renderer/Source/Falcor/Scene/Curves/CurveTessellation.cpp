@@ -28,8 +28,10 @@
 #include "stdafx.h"
 #include "CurveTessellation.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/NumericRange.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <execution>
 
 namespace Falcor
 {
@@ -39,6 +41,9 @@ namespace Falcor
         // This scaling factor is trying to bring their width on average back to curveWidth.
         const float kMeshCompensationScale = 1.207f;
 
+        // Number of strands tessellated by each parallel task. Scratch memory is allocated once per task.
+        const uint32_t kStrandsPerTask = 256;
+
         float4 transformSphere(const glm::mat4& xform, const float4& sphere)
         {
             // Spheres are represented as (center.x, center.y, center.z, radius).
@@ -49,68 +54,172 @@ namespace Falcor
             float xr = glm::length(xq.xyz - xp.xyz);
             return float4(xp.xyz, xr);
         }
-    }
 
-    CurveTessellation::SweptSphereResult CurveTessellation::convertToLinearSweptSphere(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const glm::mat4& xform)
-    {
-        SweptSphereResult result;
+        /** Location of the kept strands in the input and output arrays.
+        */
+        struct StrandLayout
+        {
+            std::vector<size_t> inputOffsets;       ///< Offset of the first control point of each kept strand.
+            std::vector<uint32_t> pointOffsets;     ///< Offset of the first tessellated point of each kept strand. The last element holds the total point count.
 
-        // Only support linear tube segments now.
-        // TODO: Add quadratic or cubic tube segments if necessary.
-        FALCOR_ASSERT(degree == 1);
-        result.degree = degree;
+            uint32_t getStrandCount() const { return (uint32_t)inputOffsets.size(); }
+            uint32_t getPointCount() const { return pointOffsets.back(); }
+        };
 
-        uint32_t pointCounts = 0;
-        uint32_t segCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        /** Scratch memory for tessellating a single strand. Reused across the strands of a task.
+        */
+        struct StrandScratch
         {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            pointCounts += tmpPointCount;
-            segCounts += tmpPointCount - 1;
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, static_cast<uint32_t>(vertexCountsPerStrand[i]));
-        }
-        result.indices.reserve(segCounts);
-        result.points.reserve(pointCounts);
-        result.radius.reserve(pointCounts);
-        result.texCrds.reserve(pointCounts);
+            std::vector<float3> controlPoints;
+            std::vector<float> widths;
+            std::vector<float2> UVs;
+
+            CubicSpline<float3> splinePoints;
+            CubicSpline<float> splineWidths;
+            CubicSpline<float2> splineUVs;
+
+            std::vector<float3> curvePoints;
+            std::vector<float> curveWidths;
+            std::vector<float2> curveUVs;
+        };
+
+        /** Computes where each kept strand is read from and written to.
+            The number of tessellated points only depends on the number of unique control points, so all output arrays can be allocated upfront.
+        */
+        StrandLayout computeStrandLayout(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand)
+        {
+            const uint32_t keptStrandCount = (uint32_t)div_round_up(strandCount, (size_t)keepOneEveryXStrands);
+
+            StrandLayout layout;
+            layout.inputOffsets.resize(keptStrandCount);
+            layout.pointOffsets.resize(keptStrandCount + 1);
+
+            // Skipped strands still advance the input offset.
+            size_t inputOffset = 0;
+            for (size_t i = 0; i < strandCount; i++)
+            {
+                if (i % keepOneEveryXStrands == 0) layout.inputOffsets[i / keepOneEveryXStrands] = inputOffset;
+                inputOffset += vertexCountsPerStrand[i];
+            }
+
+            // Count the tessellated points of each strand, skipping duplicated control points.
+            auto range = NumericRange<uint32_t>(0, keptStrandCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t strandIndex)
+            {
+                const float3* strandPoints = controlPoints + layout.inputOffsets[strandIndex];
+                const uint32_t vertexCount = (uint32_t)vertexCountsPerStrand[(size_t)strandIndex * keepOneEveryXStrands];
 
-        uint32_t pointOffset = 0;
+                uint32_t optimizedVertexCount = 1;
+                for (uint32_t j = 0; j < vertexCount - 1; j++)
+                {
+                    if (strandPoints[j] != strandPoints[j + 1]) optimizedVertexCount++;
+                }
+                layout.pointOffsets[strandIndex] = div_round_up(subdivPerSegment * (optimizedVertexCount - 1), keepOneEveryXVerticesPerStrand) + 1;
+            });
 
-        std::vector<float3> strandControlPoints;
-        std::vector<float> strandWidths;
-        std::vector<float2> strandUVs;
+            // Exclusive prefix sum over the point counts.
+            uint32_t pointCount = 0;
+            for (uint32_t strandIndex = 0; strandIndex < keptStrandCount; strandIndex++)
+            {
+                const uint32_t strandPointCount = layout.pointOffsets[strandIndex];
+                layout.pointOffsets[strandIndex] = pointCount;
+                pointCount += strandPointCount;
+            }
+            layout.pointOffsets[keptStrandCount] = pointCount;
 
-        strandControlPoints.reserve(maxVertexCountsPerStrand);
-        strandWidths.reserve(maxVertexCountsPerStrand);
-        strandUVs.reserve(maxVertexCountsPerStrand);
+            return layout;
+        }
 
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        /** Loads the control points of a strand into the scratch memory, removing duplicates, and sets up the splines.
+        */
+        void loadStrand(StrandScratch& scratch, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t vertexCount)
         {
-            strandControlPoints.clear();
-            strandWidths.clear();
-            strandUVs.clear();
+            scratch.controlPoints.clear();
+            scratch.widths.clear();
+            scratch.UVs.clear();
 
             // Optimize geometry by removing duplicates.
-            for (uint32_t j = 0; j < (uint32_t)vertexCountsPerStrand[i] - 1; j++)
+            for (uint32_t j = 0; j < vertexCount - 1; j++)
             {
-                if (controlPoints[pointOffset + j] != controlPoints[pointOffset + j + 1])
+                if (controlPoints[j] != controlPoints[j + 1])
                 {
-                    strandControlPoints.push_back(controlPoints[pointOffset + j]);
-                    strandWidths.push_back(widths[pointOffset + j]);
-                    if (UVs) strandUVs.push_back(UVs[pointOffset + j]);
+                    scratch.controlPoints.push_back(controlPoints[j]);
+                    scratch.widths.push_back(widths[j]);
+                    if (UVs) scratch.UVs.push_back(UVs[j]);
                 }
             }
 
             // Add the last control point.
-            strandControlPoints.push_back(controlPoints[pointOffset + vertexCountsPerStrand[i] - 1]);
-            strandWidths.push_back(widths[pointOffset + vertexCountsPerStrand[i] - 1]);
-            if (UVs) strandUVs.push_back(UVs[pointOffset + vertexCountsPerStrand[i] - 1]);
+            scratch.controlPoints.push_back(controlPoints[vertexCount - 1]);
+            scratch.widths.push_back(widths[vertexCount - 1]);
+            if (UVs) scratch.UVs.push_back(UVs[vertexCount - 1]);
+
+            const uint32_t optimizedVertexCount = (uint32_t)scratch.controlPoints.size();
+            scratch.splinePoints.setControlPoints(scratch.controlPoints.data(), optimizedVertexCount);
+            scratch.splineWidths.setControlPoints(scratch.widths.data(), optimizedVertexCount);
+            if (UVs) scratch.splineUVs.setControlPoints(scratch.UVs.data(), optimizedVertexCount);
+        }
+
+        /** Tessellates the kept strands in parallel.
+            \param[in] layout Strand layout.
+            \param[in] func Function called as func(strandIndex, scratch) for each kept strand.
+        */
+        template<typename Func>
+        void forEachStrand(const StrandLayout& layout, Func func)
+        {
+            const uint32_t strandCount = layout.getStrandCount();
+            auto range = NumericRange<uint32_t>(0, div_round_up(strandCount, kStrandsPerTask));
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t taskIndex)
+            {
+                StrandScratch scratch;
+                const uint32_t strandEnd = std::min(strandCount, (taskIndex + 1) * kStrandsPerTask);
+                for (uint32_t strandIndex = taskIndex * kStrandsPerTask; strandIndex < strandEnd; strandIndex++)
+                {
+                    func(strandIndex, scratch);
+                }
+            });
+        }
+    }
+
+    CurveTessellation::SweptSphereResult CurveTessellation::convertToLinearSweptSphere(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const glm::mat4& xform)
+    {
+        SweptSphereResult result;
+
+        // Only support linear tube segments now.
+        // TODO: Add quadratic or cubic tube segments if necessary.
+        FALCOR_ASSERT(degree == 1);
+        result.degree = degree;
 
-            uint32_t optimizedVertexCount = static_cast<uint32_t>(strandControlPoints.size());
+        // First pass: count the points of each strand and allocate the output.
+        const StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint32_t pointCount = layout.getPointCount();
 
-            CubicSpline splinePoints(strandControlPoints.data(), optimizedVertexCount);
-            CubicSpline splineWidths(strandWidths.data(), optimizedVertexCount);
+        result.indices.resize(pointCount - layout.getStrandCount());
+        result.points.resize(pointCount);
+        result.radius.resize(pointCount);
+        if (UVs) result.texCrds.resize(pointCount);
+
+        // Second pass: tessellate the strands directly into the output.
+        forEachStrand(layout, [&](uint32_t strandIndex, StrandScratch& scratch)
+        {
+            const size_t inputOffset = layout.inputOffsets[strandIndex];
+            loadStrand(scratch, controlPoints + inputOffset, widths + inputOffset, UVs ? UVs + inputOffset : nullptr, (uint32_t)vertexCountsPerStrand[(size_t)strandIndex * keepOneEveryXStrands]);
+            const uint32_t optimizedVertexCount = (uint32_t)scratch.controlPoints.size();
+
+            // Each strand has one segment less than points.
+            uint32_t pointIndex = layout.pointOffsets[strandIndex];
+            uint32_t segmentIndex = pointIndex - strandIndex;
+
+            auto addPoint = [&](uint32_t j, float t)
+            {
+                // Pre-transform curve points.
+                float4 sph = transformSphere(xform, float4(scratch.splinePoints.interpolate(j, t), scratch.splineWidths.interpolate(j, t) * 0.5f * widthScale));
+
+                result.points[pointIndex] = sph.xyz;
+                result.radius[pointIndex] = sph.w;
+                if (UVs) result.texCrds[pointIndex] = scratch.splineUVs.interpolate(j, t);
+                pointIndex++;
+            };
 
             uint32_t tmpCount = 0;
             for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
@@ -120,47 +229,17 @@ namespace Falcor
                     if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                     {
                         float t = (float)k / (float)subdivPerSegment;
-                        result.indices.push_back((uint32_t)result.points.size());
-
-                        // Pre-transform curve points.
-                        float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), splineWidths.interpolate(j, t) * 0.5f * widthScale));
-
-                        result.points.push_back(sph.xyz);
-                        result.radius.push_back(sph.w);
+                        result.indices[segmentIndex++] = pointIndex;
+                        addPoint(j, t);
                     }
                     tmpCount++;
                 }
             }
 
             // Always keep the last vertex.
-            float4 sph = transformSphere(xform, float4(splinePoints.interpolate(optimizedVertexCount - 2, 1.f), splineWidths.interpolate(optimizedVertexCount - 2, 1.f) * 0.5f * widthScale));
-            result.points.push_back(sph.xyz);
-            result.radius.push_back(sph.w);
-
-            // Texture coordinates.
-            if (UVs)
-            {
-                CubicSpline splineUVs(strandUVs.data(), optimizedVertexCount);
-                tmpCount = 0;
-                for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
-                {
-                    for (uint32_t k = 0; k < subdivPerSegment; k++)
-                    {
-                        if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                        {
-                            float t = (float)k / (float)subdivPerSegment;
-                            result.texCrds.push_back(splineUVs.interpolate(j, t));
-                        }
-                        tmpCount++;
-                    }
-                }
-
-                // Always keep the last vertex.
-                result.texCrds.push_back(splineUVs.interpolate(optimizedVertexCount - 2, 1.f));
-            }
-
-            for (uint32_t j = i; j < std::min((uint32_t)strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
-        }
+            addPoint(optimizedVertexCount - 2, 1.f);
+            FALCOR_ASSERT(pointIndex == layout.pointOffsets[strandIndex + 1]);
+        });
 
         return result;
     }
@@ -168,64 +247,40 @@ namespace Falcor
     CurveTessellation::MeshResult CurveTessellation::convertToMesh(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
     {
         MeshResult result;
-        uint32_t vertexCounts = 0;
-        uint32_t faceCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            vertexCounts += pointCountPerCrossSection * tmpPointCount;
-            faceCounts += 2 * pointCountPerCrossSection * (tmpPointCount - 1);
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, static_cast<uint32_t>(vertexCountsPerStrand[i]));
-        }
-        result.vertices.reserve(vertexCounts);
-        result.normals.reserve(vertexCounts);
-        result.tangents.reserve(vertexCounts);
-        result.texCrds.reserve(vertexCounts);
-        result.radii.reserve(vertexCounts);
-        result.faceVertexCounts.reserve(faceCounts);
-        result.faceVertexIndices.reserve(faceCounts * 3);
-
-        uint32_t pointOffset = 0;
-        uint32_t meshVertexOffset = 0;
-
-        std::vector<float3> strandControlPoints;
-        std::vector<float> strandWidths;
-        std::vector<float2> strandUVs;
-
-        strandControlPoints.reserve(maxVertexCountsPerStrand);
-        strandWidths.reserve(maxVertexCountsPerStrand);
-        strandUVs.reserve(maxVertexCountsPerStrand);
-
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            strandControlPoints.clear();
-            strandWidths.clear();
-            strandUVs.clear();
 
-            // Optimize geometry by removing duplicates.
-            for (uint32_t j = 0; j < (uint32_t)vertexCountsPerStrand[i] - 1; j++)
+        // First pass: count the cross-sections of each strand and allocate the output.
+        const StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint32_t vertexCount = pointCountPerCrossSection * layout.getPointCount();
+        const uint32_t faceCount = 2 * pointCountPerCrossSection * (layout.getPointCount() - layout.getStrandCount());
+
+        result.vertices.resize(vertexCount);
+        result.normals.resize(vertexCount);
+        result.tangents.resize(vertexCount);
+        if (UVs) result.texCrds.resize(vertexCount);
+        result.radii.resize(vertexCount);
+        result.faceVertexCounts.assign(faceCount, 3);
+        result.faceVertexIndices.resize(faceCount * 3);
+
+        // Second pass: tessellate the strands directly into the output.
+        forEachStrand(layout, [&](uint32_t strandIndex, StrandScratch& scratch)
+        {
+            const size_t inputOffset = layout.inputOffsets[strandIndex];
+            loadStrand(scratch, controlPoints + inputOffset, widths + inputOffset, UVs ? UVs + inputOffset : nullptr, (uint32_t)vertexCountsPerStrand[(size_t)strandIndex * keepOneEveryXStrands]);
+            const uint32_t optimizedVertexCount = (uint32_t)scratch.controlPoints.size();
+
+            auto& curvePoints = scratch.curvePoints;
+            auto& curveWidths = scratch.curveWidths;
+            auto& curveUVs = scratch.curveUVs;
+            curvePoints.clear();
+            curveWidths.clear();
+            curveUVs.clear();
+
+            auto addPoint = [&](uint32_t j, float t)
             {
-                if (controlPoints[pointOffset + j] != controlPoints[pointOffset + j + 1])
-                {
-                    strandControlPoints.push_back(controlPoints[pointOffset + j]);
-                    strandWidths.push_back(widths[pointOffset + j]);
-                    if (UVs) strandUVs.push_back(UVs[pointOffset + j]);
-                }
-            }
-
-            // Add the last control point.
-            strandControlPoints.push_back(controlPoints[pointOffset + vertexCountsPerStrand[i] - 1]);
-            strandWidths.push_back(widths[pointOffset + vertexCountsPerStrand[i] - 1]);
-            if (UVs) strandUVs.push_back(UVs[pointOffset + vertexCountsPerStrand[i] - 1]);
-
-            uint32_t optimizedVertexCount = static_cast<uint32_t>(strandControlPoints.size());
-
-            CubicSpline splinePoints(strandControlPoints.data(), optimizedVertexCount);
-            CubicSpline splineWidths(strandWidths.data(), optimizedVertexCount);
-
-            std::vector<float3> curvePoints;
-            std::vector<float> curveWidths;
+                curvePoints.push_back(scratch.splinePoints.interpolate(j, t));
+                curveWidths.push_back(kMeshCompensationScale * widthScale * scratch.splineWidths.interpolate(j, t));
+                if (UVs) curveUVs.push_back(scratch.splineUVs.interpolate(j, t));
+            };
 
             uint32_t tmpCount = 0;
             for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
@@ -235,42 +290,19 @@ namespace Falcor
                     if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                     {
                         float t = (float)k / (float)subdivPerSegment;
-                        curvePoints.push_back(splinePoints.interpolate(j, t));
-                        curveWidths.push_back(kMeshCompensationScale * widthScale * splineWidths.interpolate(j, t));
+                        addPoint(j, t);
                     }
                     tmpCount++;
                 }
             }
 
             // Always keep the last vertex.
-            curvePoints.push_back(splinePoints.interpolate(optimizedVertexCount - 2, 1.f));
-            curveWidths.push_back(kMeshCompensationScale * widthScale * splineWidths.interpolate(optimizedVertexCount - 2, 1.f));
-
-            std::vector<float2> curveUVs;
+            addPoint(optimizedVertexCount - 2, 1.f);
+            FALCOR_ASSERT(curvePoints.size() == layout.pointOffsets[strandIndex + 1] - layout.pointOffsets[strandIndex]);
 
-            // Texture coordinates.
-            if (UVs)
-            {
-                CubicSpline splineUVs(strandUVs.data(), optimizedVertexCount);
-                tmpCount = 0;
-                for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
-                {
-                    for (uint32_t k = 0; k < subdivPerSegment; k++)
-                    {
-                        if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                        {
-                            float t = (float)k / (float)subdivPerSegment;
-                            curveUVs.push_back(splineUVs.interpolate(j, t));
-                        }
-                        tmpCount++;
-                    }
-                }
-
-                // Always keep the last vertex.
-                curveUVs.push_back(splineUVs.interpolate(optimizedVertexCount - 2, 1.f));
-            }
-
-            for (uint32_t j = i; j < std::min((uint32_t)strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+            // Each strand has one cross-section less with faces than cross-sections.
+            const uint32_t meshVertexOffset = pointCountPerCrossSection * layout.pointOffsets[strandIndex];
+            uint32_t faceIndex = 2 * pointCountPerCrossSection * (layout.pointOffsets[strandIndex] - strandIndex);
 
             // Build the initial frame.
             float3 prevFwd, s, t;
@@ -306,40 +338,40 @@ namespace Falcor
                     float phi = (float)k / (float)pointCountPerCrossSection * (float)M_PI * 2.f;
                     float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
 
+                    const uint32_t vertexIndex = meshVertexOffset + j * pointCountPerCrossSection + k;
                     float curveRadius = 0.5f * curveWidths[j];
-                    result.vertices.push_back(curvePoints[j] + curveRadius * vNormal);
-                    result.normals.push_back(vNormal);
-                    result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
-                    result.radii.push_back(curveRadius);
+                    result.vertices[vertexIndex] = curvePoints[j] + curveRadius * vNormal;
+                    result.normals[vertexIndex] = vNormal;
+                    result.tangents[vertexIndex] = float4(fwd.x, fwd.y, fwd.z, 1);
+                    result.radii[vertexIndex] = curveRadius;
 
                     if (UVs)
                     {
-                        result.texCrds.push_back(curveUVs[j]);
+                        result.texCrds[vertexIndex] = curveUVs[j];
                     }
                 }
 
                 // Mesh faces.
                 if (j < curvePoints.size() - 1)
                 {
+                    uint32_t* pFaceVertexIndices = result.faceVertexIndices.data() + 3 * faceIndex;
                     for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
                     {
-                        result.faceVertexCounts.push_back(3);
-                        result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + k);
-                        result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
-                        result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
-
-                        result.faceVertexCounts.push_back(3);
-                        result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + k);
-                        result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
-                        result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + k);
+                        *pFaceVertexIndices++ = meshVertexOffset + j * pointCountPerCrossSection + k;
+                        *pFaceVertexIndices++ = meshVertexOffset + j * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection;
+                        *pFaceVertexIndices++ = meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection;
+
+                        *pFaceVertexIndices++ = meshVertexOffset + j * pointCountPerCrossSection + k;
+                        *pFaceVertexIndices++ = meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection;
+                        *pFaceVertexIndices++ = meshVertexOffset + (j + 1) * pointCountPerCrossSection + k;
                     }
+                    faceIndex += 2 * pointCountPerCrossSection;
                 }
 
                 prevFwd = fwd;
             }
+        });
 
-            meshVertexOffset += pointCountPerCrossSection * (uint32_t)curvePoints.size();
-        }
         return result;
     }
 }
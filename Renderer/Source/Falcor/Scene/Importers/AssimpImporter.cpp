@@ -47,6 +47,11 @@ namespace Falcor
         static const Animation::InterpolationMode kCameraInterpolationMode = Animation::InterpolationMode::Linear;
         static const bool kCameraEnableWarping = true;
 
+        // Import options that can be passed in the import dictionary.
+        const char kStreaming[] = "streaming";                  ///< Process meshes in groups and release Assimp mesh data as soon as it is converted.
+        const char kMemoryBudgetMB[] = "memoryBudgetMB";        ///< Memory budget in MB for processing a group of meshes in streaming mode.
+        const size_t kDefaultMemoryBudgetMB = 1024;
+
         using BoneMeshMap = std::map<std::string, std::vector<uint32_t>>;
         using MeshInstanceList = std::vector<std::vector<const aiNode*>>;
 
@@ -506,12 +511,90 @@ namespace Falcor
             }
         }
 
-        void createMeshes(ImporterData& data)
+        // Approximate memory in bytes needed to convert and process an Assimp mesh, including temporary buffers.
+        size_t estimateMeshProcessingMemory(const aiMesh* pAiMesh)
+        {
+            size_t vertexSize = 2 * sizeof(StaticVertexData) + sizeof(float2) + sizeof(float4);
+            if (pAiMesh->HasBones()) vertexSize += sizeof(SkinningVertexData) + sizeof(float4) + sizeof(uint4);
+            size_t indexCount = (size_t)pAiMesh->mNumFaces * pAiMesh->mFaces[0].mNumIndices;
+            return pAiMesh->mNumVertices * vertexSize + 2 * indexCount * sizeof(uint32_t);
+        }
+
+        SceneBuilder::ProcessedMesh processMesh(ImporterData& data, const aiMesh* pAiMesh, bool loadTangents)
+        {
+            const uint32_t perFaceIndexCount = pAiMesh->mFaces[0].mNumIndices;
+
+            SceneBuilder::Mesh mesh;
+            mesh.name = pAiMesh->mName.C_Str();
+            mesh.faceCount = pAiMesh->mNumFaces;
+
+            // Temporary memory for the vertex and index data.
+            std::vector<uint32_t> indexList;
+            std::vector<float2> texCrds;
+            std::vector<float4> tangents;
+            std::vector<uint4> boneIds;
+            std::vector<float4> boneWeights;
+
+            // Indices
+            createIndexList(pAiMesh, indexList);
+            FALCOR_ASSERT(indexList.size() <= std::numeric_limits<uint32_t>::max());
+            mesh.indexCount = (uint32_t)indexList.size();
+            mesh.pIndices = indexList.data();
+            mesh.topology = Vao::Topology::TriangleList;
+
+            // Vertices
+            FALCOR_ASSERT(pAiMesh->mVertices);
+            mesh.vertexCount = pAiMesh->mNumVertices;
+            static_assert(sizeof(pAiMesh->mVertices[0]) == sizeof(mesh.positions.pData[0]));
+            static_assert(sizeof(pAiMesh->mNormals[0]) == sizeof(mesh.normals.pData[0]));
+            mesh.positions.pData = reinterpret_cast<float3*>(pAiMesh->mVertices);
+            mesh.positions.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+            mesh.normals.pData = reinterpret_cast<float3*>(pAiMesh->mNormals);
+            mesh.normals.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+
+            if (pAiMesh->HasTextureCoords(0))
+            {
+                createTexCrdList(pAiMesh->mTextureCoords[0], pAiMesh->mNumVertices, texCrds);
+                FALCOR_ASSERT(!texCrds.empty());
+                mesh.texCrds.pData = texCrds.data();
+                mesh.texCrds.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+            }
+
+            if (loadTangents && pAiMesh->HasTangentsAndBitangents())
+            {
+                createTangentList(pAiMesh->mTangents, pAiMesh->mBitangents, pAiMesh->mNormals, pAiMesh->mNumVertices, tangents);
+                FALCOR_ASSERT(!tangents.empty());
+                mesh.tangents.pData = tangents.data();
+                mesh.tangents.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+            }
+
+            if (pAiMesh->HasBones())
+            {
+                loadBones(pAiMesh, data, boneWeights, boneIds);
+                mesh.boneIDs.pData = boneIds.data();
+                mesh.boneIDs.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                mesh.boneWeights.pData = boneWeights.data();
+                mesh.boneWeights.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+            }
+
+            mesh.pMaterial = data.materialMap.at(pAiMesh->mMaterialIndex);
+
+            return data.builder.processMesh(mesh);
+        }
+
+        /** Create the meshes of the scene.
+            Meshes are processed in parallel in groups whose estimated processing memory fits the memory budget,
+            and each group is added to the scene builder before the next one is processed.
+            \param[in] data Importer data.
+            \param[in] memoryBudget Memory budget in bytes for processing a group of meshes, or zero to process all meshes at once.
+            \param[in] pOwnedScene If non-null, the scene owned by the importer. The Assimp meshes are released after each group is added.
+        */
+        void createMeshes(ImporterData& data, size_t memoryBudget, aiScene* pOwnedScene)
         {
             const aiScene* pScene = data.pScene;
             const bool loadTangents = is_set(data.builder.getFlags(), SceneBuilder::Flags::UseOriginalTangentSpace);
 
-            std::vector<const aiMesh*> meshes;
+            std::vector<uint32_t> meshIndices;
             for (uint32_t i = 0; i < pScene->mNumMeshes; ++i) {
                 const aiMesh* pMesh = pScene->mMeshes[i];
                 if (!pMesh->HasFaces())
@@ -524,82 +607,59 @@ namespace Falcor
                     logWarning("AssimpImporter: Mesh '{}' is not a triangle mesh, ignoring.", pMesh->mName.C_Str());
                     continue;
                 }
-                meshes.push_back(pMesh);
+                meshIndices.push_back(i);
             }
 
-            // Pre-process meshes.
-            std::vector<SceneBuilder::ProcessedMesh> processedMeshes(meshes.size());
-            auto range = NumericRange<size_t>(0, meshes.size());
-            std::for_each(std::execution::par, range.begin(), range.end(), [&] (size_t i) {
-                const aiMesh* pAiMesh = meshes[i];
-                const uint32_t perFaceIndexCount = pAiMesh->mFaces[0].mNumIndices;
-
-                SceneBuilder::Mesh mesh;
-                mesh.name = pAiMesh->mName.C_Str();
-                mesh.faceCount = pAiMesh->mNumFaces;
-
-                // Temporary memory for the vertex and index data.
-                std::vector<uint32_t> indexList;
-                std::vector<float2> texCrds;
-                std::vector<float4> tangents;
-                std::vector<uint4> boneIds;
-                std::vector<float4> boneWeights;
-
-                // Indices
-                createIndexList(pAiMesh, indexList);
-                FALCOR_ASSERT(indexList.size() <= std::numeric_limits<uint32_t>::max());
-                mesh.indexCount = (uint32_t)indexList.size();
-                mesh.pIndices = indexList.data();
-                mesh.topology = Vao::Topology::TriangleList;
-
-                // Vertices
-                FALCOR_ASSERT(pAiMesh->mVertices);
-                mesh.vertexCount = pAiMesh->mNumVertices;
-                static_assert(sizeof(pAiMesh->mVertices[0]) == sizeof(mesh.positions.pData[0]));
-                static_assert(sizeof(pAiMesh->mNormals[0]) == sizeof(mesh.normals.pData[0]));
-                mesh.positions.pData = reinterpret_cast<float3*>(pAiMesh->mVertices);
-                mesh.positions.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-                mesh.normals.pData = reinterpret_cast<float3*>(pAiMesh->mNormals);
-                mesh.normals.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-
-                if (pAiMesh->HasTextureCoords(0))
+            uint32_t meshCount = 0;
+            size_t groupStart = 0;
+            while (groupStart < meshIndices.size())
+            {
+                // Collect the next group of meshes. A group contains at least one mesh.
+                size_t groupEnd = groupStart + 1;
+                if (memoryBudget == 0)
                 {
-                    createTexCrdList(pAiMesh->mTextureCoords[0], pAiMesh->mNumVertices, texCrds);
-                    FALCOR_ASSERT(!texCrds.empty());
-                    mesh.texCrds.pData = texCrds.data();
-                    mesh.texCrds.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                    groupEnd = meshIndices.size();
                 }
-
-                if (loadTangents && pAiMesh->HasTangentsAndBitangents())
+                else
                 {
-                    createTangentList(pAiMesh->mTangents, pAiMesh->mBitangents, pAiMesh->mNormals, pAiMesh->mNumVertices, tangents);
-                    FALCOR_ASSERT(!tangents.empty());
-                    mesh.tangents.pData = tangents.data();
-                    mesh.tangents.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                    size_t groupMemory = estimateMeshProcessingMemory(pScene->mMeshes[meshIndices[groupStart]]);
+                    while (groupEnd < meshIndices.size())
+                    {
+                        size_t meshMemory = estimateMeshProcessingMemory(pScene->mMeshes[meshIndices[groupEnd]]);
+                        if (groupMemory + meshMemory > memoryBudget) break;
+                        groupMemory += meshMemory;
+                        groupEnd++;
+                    }
                 }
 
-                if (pAiMesh->HasBones())
+                // Pre-process meshes.
+                std::vector<SceneBuilder::ProcessedMesh> processedMeshes(groupEnd - groupStart);
+                auto range = NumericRange<size_t>(0, processedMeshes.size());
+                std::for_each(std::execution::par, range.begin(), range.end(), [&] (size_t i) {
+                    processedMeshes[i] = processMesh(data, pScene->mMeshes[meshIndices[groupStart + i]], loadTangents);
+                });
+
+                // Add meshes to the scene.
+                // We retain a deterministic order of the meshes in the global scene buffer by adding
+                // them sequentially after being processed in parallel.
+                for (const auto& mesh : processedMeshes)
                 {
-                    loadBones(pAiMesh, data, boneWeights, boneIds);
-                    mesh.boneIDs.pData = boneIds.data();
-                    mesh.boneIDs.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-                    mesh.boneWeights.pData = boneWeights.data();
-                    mesh.boneWeights.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                    uint32_t meshID = data.builder.addProcessedMesh(mesh);
+                    data.meshMap[meshCount++] = meshID;
                 }
+                processedMeshes.clear();
 
-                mesh.pMaterial = data.materialMap.at(pAiMesh->mMaterialIndex);
-
-                processedMeshes[i] = data.builder.processMesh(mesh);
-            });
+                // Release the Assimp data of the converted meshes.
+                if (pOwnedScene)
+                {
+                    for (size_t i = groupStart; i < groupEnd; i++)
+                    {
+                        delete pOwnedScene->mMeshes[meshIndices[i]];
+                        pOwnedScene->mMeshes[meshIndices[i]] = nullptr;
+                    }
+                }
 
-            // Add meshes to the scene.
-            // We retain a deterministic order of the meshes in the global scene buffer by adding
-            // them sequentially after being processed in parallel.
-            uint32_t i = 0;
-            for (const auto& mesh : processedMeshes)
-            {
-                uint32_t meshID = data.builder.addProcessedMesh(mesh);
-                data.meshMap[i++] = meshID;
+                groupStart = groupEnd;
             }
         }
 
@@ -1015,8 +1075,19 @@ namespace Falcor
         Assimp::Importer importer;
         importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, removeFlags);
 
+        const bool streaming = dict.keyExists(kStreaming) ? (bool)dict[kStreaming] : false;
+        const size_t memoryBudgetMB = dict.keyExists(kMemoryBudgetMB) ? (uint32_t)dict[kMemoryBudgetMB] : kDefaultMemoryBudgetMB;
+
         const aiScene* pScene = importer.ReadFile(fullPath.string().c_str(), assimpFlags);
         if (!pScene) throw ImporterError(path, "Failed to open scene: {}", importer.GetErrorString());
+
+        // In streaming mode we take ownership of the scene, so that mesh data can be released once converted.
+        std::unique_ptr<aiScene> pOwnedScene;
+        if (streaming)
+        {
+            pOwnedScene.reset(importer.GetOrphanedScene());
+            pScene = pOwnedScene.get();
+        }
         timeReport.measure("Loading asset file");
 
         ImporterData data(path, pScene, builder, instances);
@@ -1038,7 +1109,7 @@ namespace Falcor
         createSceneGraph(data);
         timeReport.measure("Creating scene graph");
 
-        createMeshes(data);
+        createMeshes(data, streaming ? memoryBudgetMB * 1024 * 1024 : 0, pOwnedScene.get());
         addMeshInstances(data, data.pScene->mRootNode);
         timeReport.measure("Creating meshes");
 
@@ -1058,7 +1129,6 @@ namespace Falcor
         AssimpImporter,
         Importer::ExtensionList({
             "fbx",
-            "gltf",
             "obj",
             "dae",
             "x",
@@ -1086,8 +1156,7 @@ namespace Falcor
             "smd",
             "vta",
             "raw",
-            "ter",
-            "glb"
+            "ter"
         })
     )
 }
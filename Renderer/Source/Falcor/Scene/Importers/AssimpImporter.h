@@ -33,6 +33,11 @@ namespace Falcor
     class FALCOR_API AssimpImporter
     {
     public:
+        /** Import a scene using Assimp.
+            The following options are read from the import dictionary:
+            - streaming (bool): Convert meshes in groups and release the Assimp mesh data of each group once it is added to the builder. Default false.
+            - memoryBudgetMB (int): Memory budget in MB for converting a group of meshes in streaming mode. Default 1024.
+        */
         static void import(const std::filesystem::path& path, SceneBuilder& builder, const SceneBuilder::InstanceMatrices& instances, const Dictionary& dict);
     private:
         AssimpImporter() = default;
@@ -0,0 +1,1042 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "GLTFImporter.h"
+#include "AssimpImporter.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Timing/TimeReport.h"
+#include "rapidjson/document.h"
+#include "glm/gtc/type_ptr.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "glm/gtx/transform.hpp"
+#include <execution>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        using Json = rapidjson::Value;
+
+        const uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+        const uint32_t kGlbChunkJson = 0x4E4F534A;  // "JSON"
+        const uint32_t kGlbChunkBin = 0x004E4942;   // "BIN\0"
+
+        // Accessor component types.
+        const uint32_t kByte = 5120;
+        const uint32_t kUnsignedByte = 5121;
+        const uint32_t kShort = 5122;
+        const uint32_t kUnsignedShort = 5123;
+        const uint32_t kUnsignedInt = 5125;
+        const uint32_t kFloat = 5126;
+
+        const uint32_t kModeTriangles = 4;
+
+        // Extensions that are either supported or can be ignored without affecting the imported geometry.
+        const std::vector<std::string> kSupportedExtensions =
+        {
+            "KHR_lights_punctual",
+            "KHR_materials_emissive_strength",
+        };
+
+        struct BufferView
+        {
+            const uint8_t* pData = nullptr;
+            size_t size = 0;
+        };
+
+        /** Typed view of an accessor into a buffer.
+        */
+        struct Accessor
+        {
+            const uint8_t* pData = nullptr;     ///< Pointer to the first element.
+            size_t count = 0;                   ///< Number of elements.
+            size_t stride = 0;                  ///< Byte stride between elements.
+            uint32_t componentType = 0;         ///< Component type.
+            uint32_t componentCount = 0;        ///< Number of components per element.
+            bool normalized = false;            ///< True if integer components are normalized.
+        };
+
+        class ImporterData
+        {
+        public:
+            ImporterData(const std::filesystem::path& path, SceneBuilder& builder, const SceneBuilder::InstanceMatrices& modelInstances)
+                : path(path)
+                , builder(builder)
+                , modelInstances(modelInstances)
+            {}
+
+            std::filesystem::path path;
+            std::filesystem::path searchPath;
+            SceneBuilder& builder;
+            const SceneBuilder::InstanceMatrices& modelInstances;
+
+            rapidjson::Document doc;
+            std::vector<std::unique_ptr<MemoryMappedFile>> mappedFiles;     ///< Mapped glTF file and external buffers.
+            std::vector<std::vector<uint8_t>> decodedBuffers;               ///< Buffers decoded from data URIs.
+            std::vector<BufferView> buffers;
+
+            std::vector<Material::SharedPtr> materials;
+            Material::SharedPtr pDefaultMaterial;
+            std::vector<std::vector<uint32_t>> meshIDs;                     ///< Falcor mesh IDs per glTF mesh, one per primitive.
+            std::vector<uint32_t> nodeIDs;                                  ///< Falcor node ID per glTF node.
+
+            Accessor getAccessor(uint32_t index) const;
+        };
+
+        const Json& getEmptyArray()
+        {
+            static const Json kEmptyArray(rapidjson::kArrayType);
+            return kEmptyArray;
+        }
+
+        const Json* findMember(const Json& obj, const char* name)
+        {
+            if (!obj.IsObject()) return nullptr;
+            auto it = obj.FindMember(name);
+            return it != obj.MemberEnd() ? &it->value : nullptr;
+        }
+
+        const Json& getArray(const Json& obj, const char* name)
+        {
+            const Json* pValue = findMember(obj, name);
+            return pValue && pValue->IsArray() ? *pValue : getEmptyArray();
+        }
+
+        uint32_t getUint(const Json& obj, const char* name, uint32_t defaultValue)
+        {
+            const Json* pValue = findMember(obj, name);
+            return pValue && pValue->IsUint() ? pValue->GetUint() : defaultValue;
+        }
+
+        float getFloat(const Json& obj, const char* name, float defaultValue)
+        {
+            const Json* pValue = findMember(obj, name);
+            return pValue && pValue->IsNumber() ? (float)pValue->GetDouble() : defaultValue;
+        }
+
+        bool getBool(const Json& obj, const char* name, bool defaultValue)
+        {
+            const Json* pValue = findMember(obj, name);
+            return pValue && pValue->IsBool() ? pValue->GetBool() : defaultValue;
+        }
+
+        std::string getString(const Json& obj, const char* name, const std::string& defaultValue = {})
+        {
+            const Json* pValue = findMember(obj, name);
+            return pValue && pValue->IsString() ? std::string(pValue->GetString(), pValue->GetStringLength()) : defaultValue;
+        }
+
+        // Read an array of numbers. Returns false and leaves the values unchanged if the member does not exist or has a different size.
+        bool getFloats(const Json& obj, const char* name, float* pValues, uint32_t count)
+        {
+            const Json& array = getArray(obj, name);
+            if (array.Size() != count) return false;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (!array[i].IsNumber()) return false;
+                pValues[i] = (float)array[i].GetDouble();
+            }
+            return true;
+        }
+
+        const Json* getExtension(const Json& obj, const char* name)
+        {
+            const Json* pExtensions = findMember(obj, "extensions");
+            return pExtensions ? findMember(*pExtensions, name) : nullptr;
+        }
+
+        size_t getComponentSize(uint32_t componentType)
+        {
+            switch (componentType)
+            {
+            case kByte:
+            case kUnsignedByte:
+                return 1;
+            case kShort:
+            case kUnsignedShort:
+                return 2;
+            case kUnsignedInt:
+            case kFloat:
+                return 4;
+            default:
+                return 0;
+            }
+        }
+
+        uint32_t getComponentCount(const std::string& type)
+        {
+            if (type == "SCALAR") return 1;
+            if (type == "VEC2") return 2;
+            if (type == "VEC3") return 3;
+            if (type == "VEC4") return 4;
+            if (type == "MAT2") return 4;
+            if (type == "MAT3") return 9;
+            if (type == "MAT4") return 16;
+            return 0;
+        }
+
+        float readComponent(const uint8_t* pData, uint32_t componentType, bool normalized)
+        {
+            switch (componentType)
+            {
+            case kFloat:
+            {
+                float value;
+                std::memcpy(&value, pData, sizeof(value));
+                return value;
+            }
+            case kUnsignedByte:
+                return normalized ? *pData / 255.f : (float)*pData;
+            case kByte:
+            {
+                int8_t value = (int8_t)*pData;
+                return normalized ? std::max(value / 127.f, -1.f) : (float)value;
+            }
+            case kUnsignedShort:
+            {
+                uint16_t value;
+                std::memcpy(&value, pData, sizeof(value));
+                return normalized ? value / 65535.f : (float)value;
+            }
+            case kShort:
+            {
+                int16_t value;
+                std::memcpy(&value, pData, sizeof(value));
+                return normalized ? std::max(value / 32767.f, -1.f) : (float)value;
+            }
+            case kUnsignedInt:
+            {
+                uint32_t value;
+                std::memcpy(&value, pData, sizeof(value));
+                return (float)value;
+            }
+            default:
+                FALCOR_UNREACHABLE();
+                return 0.f;
+            }
+        }
+
+        uint32_t readIndex(const uint8_t* pData, uint32_t componentType)
+        {
+            switch (componentType)
+            {
+            case kUnsignedByte:
+                return *pData;
+            case kUnsignedShort:
+            {
+                uint16_t value;
+                std::memcpy(&value, pData, sizeof(value));
+                return value;
+            }
+            case kUnsignedInt:
+            {
+                uint32_t value;
+                std::memcpy(&value, pData, sizeof(value));
+                return value;
+            }
+            default:
+                FALCOR_UNREACHABLE();
+                return 0;
+            }
+        }
+
+        bool isAligned(const void* pData, size_t alignment)
+        {
+            return reinterpret_cast<uintptr_t>(pData) % alignment == 0;
+        }
+
+        /** Get float vector data of an accessor.
+            If the accessor holds tightly packed floats of the requested type, a pointer into the buffer is returned.
+            Otherwise the data is converted into the storage vector.
+        */
+        template<typename T>
+        const T* getFloatData(const Accessor& accessor, std::vector<T>& storage, bool forceCopy = false)
+        {
+            const uint32_t N = sizeof(T) / sizeof(float);
+            if (!forceCopy && accessor.componentType == kFloat && accessor.componentCount == N && accessor.stride == sizeof(T) && isAligned(accessor.pData, alignof(float)))
+            {
+                return reinterpret_cast<const T*>(accessor.pData);
+            }
+
+            const size_t componentSize = getComponentSize(accessor.componentType);
+            const uint32_t componentCount = std::min(N, accessor.componentCount);
+            storage.resize(accessor.count);
+            for (size_t i = 0; i < accessor.count; i++)
+            {
+                const uint8_t* pElement = accessor.pData + i * accessor.stride;
+                T value(0.f);
+                for (uint32_t c = 0; c < componentCount; c++)
+                {
+                    value[c] = readComponent(pElement + c * componentSize, accessor.componentType, accessor.normalized);
+                }
+                storage[i] = value;
+            }
+            return storage.data();
+        }
+
+        /** Get index data of an accessor.
+            Tightly packed 32-bit indices are returned as a pointer into the buffer, other index types are converted.
+        */
+        const uint32_t* getIndexData(const Accessor& accessor, std::vector<uint32_t>& storage)
+        {
+            if (accessor.componentType == kUnsignedInt && accessor.stride == sizeof(uint32_t) && isAligned(accessor.pData, alignof(uint32_t)))
+            {
+                return reinterpret_cast<const uint32_t*>(accessor.pData);
+            }
+
+            storage.resize(accessor.count);
+            for (size_t i = 0; i < accessor.count; i++)
+            {
+                storage[i] = readIndex(accessor.pData + i * accessor.stride, accessor.componentType);
+            }
+            return storage.data();
+        }
+
+        Accessor ImporterData::getAccessor(uint32_t index) const
+        {
+            const Json& accessors = getArray(doc, "accessors");
+            if (index >= accessors.Size()) throw ImporterError(path, "Accessor {} is out of range.", index);
+            const Json& accessor = accessors[index];
+
+            Accessor result;
+            result.count = getUint(accessor, "count", 0);
+            result.componentType = getUint(accessor, "componentType", 0);
+            result.componentCount = getComponentCount(getString(accessor, "type"));
+            result.normalized = getBool(accessor, "normalized", false);
+
+            if (getComponentSize(result.componentType) == 0) throw ImporterError(path, "Accessor {} has an unsupported component type {}.", index, result.componentType);
+            if (result.componentCount == 0) throw ImporterError(path, "Accessor {} has an unsupported type '{}'.", index, getString(accessor, "type"));
+            const size_t elementSize = result.componentCount * getComponentSize(result.componentType);
+
+            const uint32_t bufferViewIndex = getUint(accessor, "bufferView", std::numeric_limits<uint32_t>::max());
+            const Json& bufferViews = getArray(doc, "bufferViews");
+            if (bufferViewIndex >= bufferViews.Size()) throw ImporterError(path, "Accessor {} has no valid buffer view.", index);
+            const Json& bufferView = bufferViews[bufferViewIndex];
+
+            const uint32_t bufferIndex = getUint(bufferView, "buffer", 0);
+            if (bufferIndex >= buffers.size()) throw ImporterError(path, "Buffer view {} refers to an invalid buffer.", bufferViewIndex);
+            const BufferView& buffer = buffers[bufferIndex];
+
+            const size_t viewOffset = getUint(bufferView, "byteOffset", 0);
+            const size_t viewSize = getUint(bufferView, "byteLength", 0);
+            const size_t accessorOffset = getUint(accessor, "byteOffset", 0);
+            result.stride = getUint(bufferView, "byteStride", 0);
+            if (result.stride == 0) result.stride = elementSize;
+
+            if (viewOffset + viewSize > buffer.size) throw ImporterError(path, "Buffer view {} is out of bounds.", bufferViewIndex);
+            if (result.count > 0 && accessorOffset + (result.count - 1) * result.stride + elementSize > viewSize)
+            {
+                throw ImporterError(path, "Accessor {} is out of bounds of its buffer view.", index);
+            }
+
+            result.pData = buffer.pData + viewOffset + accessorOffset;
+            return result;
+        }
+
+        int getHexDigitValue(char c)
+        {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        std::string decodeUri(const std::filesystem::path& path, const std::string& uri)
+        {
+            std::string result;
+            result.reserve(uri.size());
+            for (size_t i = 0; i < uri.size(); i++)
+            {
+                if (uri[i] == '%')
+                {
+                    int hi = i + 2 < uri.size() ? getHexDigitValue(uri[i + 1]) : -1;
+                    int lo = i + 2 < uri.size() ? getHexDigitValue(uri[i + 2]) : -1;
+                    if (hi < 0 || lo < 0) throw ImporterError(path, "Invalid escape sequence in URI '{}'.", uri);
+                    result.push_back((char)(hi * 16 + lo));
+                    i += 2;
+                }
+                else result.push_back(uri[i]);
+            }
+            return result;
+        }
+
+        bool isBase64Char(char c)
+        {
+            return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '+' || c == '/';
+        }
+
+        // Decode the payload of a base64 data URI. The input is checked here, as decodeBase64() does not validate the characters.
+        std::vector<uint8_t> decodeDataUri(const std::filesystem::path& path, const std::string& str)
+        {
+            size_t padding = 0;
+            while (padding < 2 && padding < str.size() && str[str.size() - 1 - padding] == '=') padding++;
+            bool valid = str.size() % 4 == 0;
+            for (size_t i = 0; valid && i < str.size() - padding; i++) valid = isBase64Char(str[i]);
+            if (!valid) throw ImporterError(path, "Invalid base64 data in buffer URI.");
+
+            try
+            {
+                return decodeBase64(str);
+            }
+            catch (const std::exception& e)
+            {
+                throw ImporterError(path, "Failed to decode buffer URI: {}", e.what());
+            }
+        }
+
+        bool isDataUri(const std::string& uri)
+        {
+            return uri.compare(0, 5, "data:") == 0;
+        }
+
+        // Returns a description of the first feature in the document that this importer doesn't support, or an empty string.
+        std::string findUnsupportedFeature(const rapidjson::Document& doc)
+        {
+            if (!getArray(doc, "skins").Empty()) return "skins";
+            if (!getArray(doc, "animations").Empty()) return "animations";
+
+            for (const auto& extension : getArray(doc, "extensionsRequired").GetArray())
+            {
+                std::string name = extension.IsString() ? extension.GetString() : "";
+                if (std::find(kSupportedExtensions.begin(), kSupportedExtensions.end(), name) == kSupportedExtensions.end()) return "required extension '" + name + "'";
+            }
+
+            for (const auto& accessor : getArray(doc, "accessors").GetArray())
+            {
+                if (findMember(accessor, "sparse")) return "sparse accessors";
+                if (!findMember(accessor, "bufferView")) return "accessors without buffer views";
+            }
+
+            for (const auto& mesh : getArray(doc, "meshes").GetArray())
+            {
+                for (const auto& primitive : getArray(mesh, "primitives").GetArray())
+                {
+                    if (getUint(primitive, "mode", kModeTriangles) != kModeTriangles) return "non-triangle primitives";
+                    if (!getArray(primitive, "targets").Empty()) return "morph targets";
+                }
+            }
+
+            return {};
+        }
+
+        void loadDocument(ImporterData& data, const std::filesystem::path& fullPath)
+        {
+            auto pFile = std::make_unique<MemoryMappedFile>();
+            if (!pFile->open(fullPath)) throw ImporterError(data.path, "Failed to open file.");
+
+            const uint8_t* pData = pFile->getData();
+            const size_t size = pFile->getSize();
+            auto readUint = [&](size_t offset)
+            {
+                uint32_t value;
+                std::memcpy(&value, pData + offset, sizeof(value));
+                return value;
+            };
+
+            const char* pJson = reinterpret_cast<const char*>(pData);
+            size_t jsonSize = size;
+            BufferView glbBuffer;
+
+            if (size >= 12 && readUint(0) == kGlbMagic)
+            {
+                // Binary glTF: 12 byte header followed by a JSON chunk and an optional binary chunk.
+                if (readUint(4) != 2) throw ImporterError(data.path, "Unsupported GLB version {}.", readUint(4));
+                const size_t length = std::min<size_t>(readUint(8), size);
+                if (length < 20 || readUint(16) != kGlbChunkJson) throw ImporterError(data.path, "GLB file has no JSON chunk.");
+
+                jsonSize = readUint(12);
+                pJson = reinterpret_cast<const char*>(pData + 20);
+                if (20 + jsonSize > length) throw ImporterError(data.path, "GLB JSON chunk is out of bounds.");
+
+                const size_t binOffset = 20 + ((jsonSize + 3) & ~size_t(3));
+                if (binOffset + 8 <= length && readUint(binOffset + 4) == kGlbChunkBin)
+                {
+                    glbBuffer.pData = pData + binOffset + 8;
+                    glbBuffer.size = std::min<size_t>(readUint(binOffset), length - binOffset - 8);
+                }
+            }
+
+            data.doc.Parse(pJson, jsonSize);
+            if (data.doc.HasParseError() || !data.doc.IsObject())
+            {
+                throw ImporterError(data.path, "Failed to parse glTF JSON (error {} at offset {}).", (int)data.doc.GetParseError(), data.doc.GetErrorOffset());
+            }
+
+            const Json* pAsset = findMember(data.doc, "asset");
+            if (!pAsset || getString(*pAsset, "version").compare(0, 2, "2.") != 0)
+            {
+                throw ImporterError(data.path, "Only glTF 2.0 files are supported.");
+            }
+
+            data.mappedFiles.push_back(std::move(pFile));
+
+            // Resolve buffers. Buffers without a URI refer to the GLB binary chunk.
+            for (const auto& buffer : getArray(data.doc, "buffers").GetArray())
+            {
+                const std::string uri = getString(buffer, "uri");
+                const size_t byteLength = getUint(buffer, "byteLength", 0);
+                BufferView view;
+                if (uri.empty())
+                {
+                    view = glbBuffer;
+                }
+                else if (isDataUri(uri))
+                {
+                    size_t dataPos = uri.find(";base64,");
+                    if (dataPos == std::string::npos) throw ImporterError(data.path, "Unsupported data URI in buffer.");
+                    data.decodedBuffers.push_back(decodeDataUri(data.path, uri.substr(dataPos + 8)));
+                    view.pData = data.decodedBuffers.back().data();
+                    view.size = data.decodedBuffers.back().size();
+                }
+                else
+                {
+                    auto pBufferFile = std::make_unique<MemoryMappedFile>();
+                    auto bufferPath = data.searchPath / decodeUri(data.path, uri);
+                    if (!pBufferFile->open(bufferPath)) throw ImporterError(data.path, "Failed to open buffer '{}'.", bufferPath.string());
+                    view.pData = pBufferFile->getData();
+                    view.size = pBufferFile->getSize();
+                    data.mappedFiles.push_back(std::move(pBufferFile));
+                }
+                if (view.size < byteLength) throw ImporterError(data.path, "Buffer '{}' is smaller than its declared length.", uri);
+                data.buffers.push_back(view);
+            }
+        }
+
+        void loadTexture(ImporterData& data, const Json* pTextureInfo, const Material::SharedPtr& pMaterial, Material::TextureSlot slot)
+        {
+            if (!pTextureInfo) return;
+
+            const Json& textures = getArray(data.doc, "textures");
+            const uint32_t textureIndex = getUint(*pTextureInfo, "index", std::numeric_limits<uint32_t>::max());
+            if (textureIndex >= textures.Size()) return;
+
+            const Json& images = getArray(data.doc, "images");
+            const uint32_t imageIndex = getUint(textures[textureIndex], "source", std::numeric_limits<uint32_t>::max());
+            if (imageIndex >= images.Size()) return;
+
+            const std::string uri = getString(images[imageIndex], "uri");
+            if (uri.empty() || isDataUri(uri))
+            {
+                logWarning("GLTFImporter: Material '{}' uses an embedded image, which Falcor doesn't load.", pMaterial->getName());
+                return;
+            }
+
+            data.builder.loadMaterialTexture(pMaterial, slot, data.searchPath / decodeUri(data.path, uri));
+        }
+
+        Material::SharedPtr createMaterial(ImporterData& data, const Json& material, uint32_t index)
+        {
+            std::string name = getString(material, "name", "material" + std::to_string(index));
+
+            ShadingModel shadingModel = is_set(data.builder.getFlags(), SceneBuilder::Flags::UseSpecGlossMaterials) ? ShadingModel::SpecGloss : ShadingModel::MetalRough;
+            StandardMaterial::SharedPtr pMaterial = StandardMaterial::create(name, shadingModel);
+
+            if (const Json* pPbr = findMember(material, "pbrMetallicRoughness"))
+            {
+                float4 baseColor(1.f);
+                getFloats(*pPbr, "baseColorFactor", &baseColor.x, 4);
+                pMaterial->setBaseColor(baseColor);
+
+                float4 specularParams = pMaterial->getSpecularParams();
+                specularParams.g = getFloat(*pPbr, "roughnessFactor", 1.f);
+                specularParams.b = getFloat(*pPbr, "metallicFactor", 1.f);
+                pMaterial->setSpecularParams(specularParams);
+
+                loadTexture(data, findMember(*pPbr, "baseColorTexture"), pMaterial, Material::TextureSlot::BaseColor);
+                loadTexture(data, findMember(*pPbr, "metallicRoughnessTexture"), pMaterial, Material::TextureSlot::Specular);
+            }
+
+            loadTexture(data, findMember(material, "normalTexture"), pMaterial, Material::TextureSlot::Normal);
+            loadTexture(data, findMember(material, "emissiveTexture"), pMaterial, Material::TextureSlot::Emissive);
+
+            float3 emissive(0.f);
+            if (getFloats(material, "emissiveFactor", &emissive.x, 3))
+            {
+                if (const Json* pStrength = getExtension(material, "KHR_materials_emissive_strength"))
+                {
+                    pMaterial->setEmissiveFactor(getFloat(*pStrength, "emissiveStrength", 1.f));
+                }
+                pMaterial->setEmissiveColor(emissive);
+            }
+
+            pMaterial->setDoubleSided(getBool(material, "doubleSided", false));
+
+            const std::string alphaMode = getString(material, "alphaMode", "OPAQUE");
+            if (alphaMode == "OPAQUE")
+            {
+                pMaterial->setAlphaMode(AlphaMode::Opaque);
+            }
+            else
+            {
+                // Blending is not supported, treat it as alpha masking.
+                pMaterial->setAlphaMode(AlphaMode::Mask);
+                pMaterial->setAlphaThreshold(getFloat(material, "alphaCutoff", 0.5f));
+            }
+
+            return pMaterial;
+        }
+
+        void createMaterials(ImporterData& data)
+        {
+            const Json& materials = getArray(data.doc, "materials");
+            for (uint32_t i = 0; i < materials.Size(); i++)
+            {
+                data.materials.push_back(createMaterial(data, materials[i], i));
+            }
+
+            // Default material for primitives without a material, as defined by the specification.
+            data.pDefaultMaterial = StandardMaterial::create("default");
+        }
+
+        // Compute per-face normals. The specification requires flat normals for primitives without normals.
+        void computeFlatNormals(const float3* pPositions, size_t vertexCount, const uint32_t* pIndices, uint32_t faceCount, std::vector<float3>& normals)
+        {
+            normals.resize(faceCount);
+            for (uint32_t i = 0; i < faceCount; i++)
+            {
+                uint32_t i0 = pIndices[i * 3 + 0], i1 = pIndices[i * 3 + 1], i2 = pIndices[i * 3 + 2];
+                if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount) continue;
+                float3 n = cross(pPositions[i1] - pPositions[i0], pPositions[i2] - pPositions[i0]);
+                float len = length(n);
+                normals[i] = len > 0.f ? n / len : float3(0.f, 0.f, 1.f);
+            }
+        }
+
+        SceneBuilder::ProcessedMesh processPrimitive(const ImporterData& data, const Json& primitive, const std::string& name)
+        {
+            const Json* pAttributes = findMember(primitive, "attributes");
+            const uint32_t kNone = std::numeric_limits<uint32_t>::max();
+            auto getAttributeIndex = [&](const char* attribute) { return pAttributes ? getUint(*pAttributes, attribute, kNone) : kNone; };
+
+            // Get the accessor of a vertex attribute and check that it matches the mesh, so that processMesh() stays within the buffers.
+            auto getAttributeAccessor = [&](const char* attribute, uint32_t accessorIndex, uint32_t componentCount, size_t vertexCount)
+            {
+                Accessor accessor = data.getAccessor(accessorIndex);
+                if (accessor.componentCount != componentCount)
+                {
+                    throw ImporterError(data.path, "Mesh '{}' has a {} attribute with {} components, expected {}.", name, attribute, accessor.componentCount, componentCount);
+                }
+                if (accessor.count != vertexCount)
+                {
+                    throw ImporterError(data.path, "Mesh '{}' has {} {} elements, but {} vertices.", name, accessor.count, attribute, vertexCount);
+                }
+                return accessor;
+            };
+
+            const uint32_t positionIndex = getAttributeIndex("POSITION");
+            if (positionIndex == kNone) throw ImporterError(data.path, "Mesh '{}' has no positions.", name);
+
+            // Temporary memory for attributes that can't be used directly from the buffers.
+            std::vector<float3> positions;
+            std::vector<float3> normals;
+            std::vector<float2> texCrds;
+            std::vector<float4> tangents;
+            std::vector<uint32_t> indices;
+
+            SceneBuilder::Mesh mesh;
+            mesh.name = name;
+            mesh.topology = Vao::Topology::TriangleList;
+
+            const Accessor positionAccessor = data.getAccessor(positionIndex);
+            if (positionAccessor.componentCount != 3) throw ImporterError(data.path, "Mesh '{}' has positions with {} components, expected 3.", name, positionAccessor.componentCount);
+            mesh.vertexCount = (uint32_t)positionAccessor.count;
+            mesh.positions.pData = getFloatData(positionAccessor, positions);
+            mesh.positions.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+
+            const uint32_t indicesIndex = getUint(primitive, "indices", kNone);
+            if (indicesIndex != kNone)
+            {
+                const Accessor indexAccessor = data.getAccessor(indicesIndex);
+                const bool isIndexType = indexAccessor.componentType == kUnsignedByte || indexAccessor.componentType == kUnsignedShort || indexAccessor.componentType == kUnsignedInt;
+                if (indexAccessor.componentCount != 1 || !isIndexType)
+                {
+                    throw ImporterError(data.path, "Mesh '{}' has indices of unsupported type (component type {}, {} components).", name, indexAccessor.componentType, indexAccessor.componentCount);
+                }
+                mesh.pIndices = getIndexData(indexAccessor, indices);
+                mesh.indexCount = (uint32_t)indexAccessor.count;
+
+                for (uint32_t i = 0; i < mesh.indexCount; i++)
+                {
+                    if (mesh.pIndices[i] >= mesh.vertexCount)
+                    {
+                        throw ImporterError(data.path, "Mesh '{}' has vertex index {} out of range (vertex count is {}).", name, mesh.pIndices[i], mesh.vertexCount);
+                    }
+                }
+            }
+            else
+            {
+                indices.resize(mesh.vertexCount);
+                std::iota(indices.begin(), indices.end(), 0);
+                mesh.pIndices = indices.data();
+                mesh.indexCount = mesh.vertexCount;
+            }
+            if (mesh.indexCount % 3 != 0) throw ImporterError(data.path, "Mesh '{}' has an index count that is not a multiple of 3.", name);
+            mesh.faceCount = mesh.indexCount / 3;
+
+            const uint32_t normalIndex = getAttributeIndex("NORMAL");
+            if (normalIndex != kNone)
+            {
+                mesh.normals.pData = getFloatData(getAttributeAccessor("NORMAL", normalIndex, 3, mesh.vertexCount), normals);
+                mesh.normals.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+            }
+            else
+            {
+                computeFlatNormals(mesh.positions.pData, mesh.vertexCount, mesh.pIndices, mesh.faceCount, normals);
+                mesh.normals.pData = normals.data();
+                mesh.normals.frequency = SceneBuilder::Mesh::AttributeFrequency::Uniform;
+            }
+
+            const uint32_t texCrdIndex = getAttributeIndex("TEXCOORD_0");
+            if (texCrdIndex != kNone)
+            {
+                // Flip the texture coordinates to Falcor's convention, so they always need to be copied.
+                getFloatData(getAttributeAccessor("TEXCOORD_0", texCrdIndex, 2, mesh.vertexCount), texCrds, true);
+                for (auto& texCrd : texCrds) texCrd.y = 1.f - texCrd.y;
+                mesh.texCrds.pData = texCrds.data();
+                mesh.texCrds.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+            }
+
+            const uint32_t tangentIndex = getAttributeIndex("TANGENT");
+            if (tangentIndex != kNone && is_set(data.builder.getFlags(), SceneBuilder::Flags::UseOriginalTangentSpace))
+            {
+                mesh.tangents.pData = getFloatData(getAttributeAccessor("TANGENT", tangentIndex, 4, mesh.vertexCount), tangents);
+                mesh.tangents.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+            }
+
+            const uint32_t materialIndex = getUint(primitive, "material", kNone);
+            mesh.pMaterial = materialIndex < data.materials.size() ? data.materials[materialIndex] : data.pDefaultMaterial;
+
+            return data.builder.processMesh(mesh);
+        }
+
+        void createMeshes(ImporterData& data)
+        {
+            struct PrimitiveRef
+            {
+                const Json* pPrimitive;
+                std::string name;
+            };
+
+            // Collect the primitives of all meshes. Each primitive is imported as a separate Falcor mesh.
+            const Json& meshes = getArray(data.doc, "meshes");
+            std::vector<PrimitiveRef> primitives;
+            std::vector<uint32_t> meshPrimitiveCounts;
+            for (uint32_t i = 0; i < meshes.Size(); i++)
+            {
+                std::string meshName = getString(meshes[i], "name", "mesh" + std::to_string(i));
+                const Json& meshPrimitives = getArray(meshes[i], "primitives");
+                for (uint32_t j = 0; j < meshPrimitives.Size(); j++)
+                {
+                    primitives.push_back({ &meshPrimitives[j], meshPrimitives.Size() > 1 ? meshName + "." + std::to_string(j) : meshName });
+                }
+                meshPrimitiveCounts.push_back(meshPrimitives.Size());
+            }
+
+            // Pre-process meshes.
+            // Exceptions must not escape the parallel loop, so errors are collected and the first one is rethrown.
+            std::vector<SceneBuilder::ProcessedMesh> processedMeshes(primitives.size());
+            std::vector<std::exception_ptr> errors(primitives.size());
+            auto range = NumericRange<size_t>(0, primitives.size());
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) {
+                try
+                {
+                    processedMeshes[i] = processPrimitive(data, *primitives[i].pPrimitive, primitives[i].name);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+            for (const auto& pError : errors)
+            {
+                if (pError) std::rethrow_exception(pError);
+            }
+
+            // Add meshes to the scene.
+            // We retain a deterministic order of the meshes in the global scene buffer by adding
+            // them sequentially after being processed in parallel.
+            size_t primitiveIndex = 0;
+            data.meshIDs.resize(meshes.Size());
+            for (uint32_t i = 0; i < meshes.Size(); i++)
+            {
+                for (uint32_t j = 0; j < meshPrimitiveCounts[i]; j++)
+                {
+                    data.meshIDs[i].push_back(data.builder.addProcessedMesh(processedMeshes[primitiveIndex++]));
+                }
+            }
+        }
+
+        glm::mat4 getNodeTransform(const Json& node)
+        {
+            float matrix[16];
+            if (getFloats(node, "matrix", matrix, 16)) return glm::make_mat4(matrix);
+
+            float3 translation(0.f);
+            float4 rotation(0.f, 0.f, 0.f, 1.f);
+            float3 scale(1.f);
+            getFloats(node, "translation", &translation.x, 3);
+            getFloats(node, "rotation", &rotation.x, 4);
+            getFloats(node, "scale", &scale.x, 3);
+            glm::quat q(rotation.w, rotation.x, rotation.y, rotation.z);
+            return glm::translate(translation) * glm::mat4_cast(q) * glm::scale(scale);
+        }
+
+        void createCamera(ImporterData& data, uint32_t cameraIndex, uint32_t nodeID)
+        {
+            const Json& cameras = getArray(data.doc, "cameras");
+            if (cameraIndex >= cameras.Size()) return;
+            const Json& camera = cameras[cameraIndex];
+
+            const std::string name = getString(camera, "name", "camera" + std::to_string(cameraIndex));
+            const Json* pPerspective = findMember(camera, "perspective");
+            if (!pPerspective)
+            {
+                logWarning("GLTFImporter: Camera '{}' is not a perspective camera, ignoring.", name);
+                return;
+            }
+
+            Camera::SharedPtr pCamera = Camera::create(name);
+            float aspectRatio = getFloat(*pPerspective, "aspectRatio", pCamera->getAspectRatio());
+            pCamera->setFocalLength(fovYToFocalLength(getFloat(*pPerspective, "yfov", 0.8f), pCamera->getFrameHeight()));
+            pCamera->setAspectRatio(aspectRatio);
+            pCamera->setDepthRange(getFloat(*pPerspective, "znear", 0.1f), getFloat(*pPerspective, "zfar", 1000.f));
+
+            // glTF cameras look down -Z in the local space of their node.
+            pCamera->setPosition(float3(0.f));
+            pCamera->setTarget(float3(0.f, 0.f, -1.f));
+            pCamera->setUpVector(float3(0.f, 1.f, 0.f));
+
+            SceneBuilder::Node n;
+            n.name = "Camera.BaseMatrix";
+            n.parent = nodeID;
+            n.transform = pCamera->getViewMatrix();
+            pCamera->setNodeID(data.builder.addNode(n));
+
+            data.builder.addCamera(pCamera);
+        }
+
+        void createLight(ImporterData& data, uint32_t lightIndex, uint32_t nodeID)
+        {
+            const Json* pLights = getExtension(data.doc, "KHR_lights_punctual");
+            const Json& lights = pLights ? getArray(*pLights, "lights") : getEmptyArray();
+            if (lightIndex >= lights.Size()) return;
+            const Json& light = lights[lightIndex];
+
+            const std::string name = getString(light, "name", "light" + std::to_string(lightIndex));
+            const std::string type = getString(light, "type");
+            float3 color(1.f);
+            getFloats(light, "color", &color.x, 3);
+            const float3 intensity = color * getFloat(light, "intensity", 1.f);
+
+            // Punctual lights are located at the origin of their node and point down -Z.
+            Light::SharedPtr pLight;
+            if (type == "directional")
+            {
+                DirectionalLight::SharedPtr pDirLight = DirectionalLight::create(name);
+                pDirLight->setWorldDirection(float3(0.f, 0.f, -1.f));
+                pLight = pDirLight;
+            }
+            else if (type == "point" || type == "spot")
+            {
+                PointLight::SharedPtr pPointLight = PointLight::create(name);
+                pPointLight->setWorldPosition(float3(0.f));
+                pPointLight->setWorldDirection(float3(0.f, 0.f, -1.f));
+                if (const Json* pSpot = findMember(light, "spot"))
+                {
+                    float outerConeAngle = getFloat(*pSpot, "outerConeAngle", glm::quarter_pi<float>());
+                    float innerConeAngle = getFloat(*pSpot, "innerConeAngle", 0.f);
+                    pPointLight->setOpeningAngle(outerConeAngle);
+                    pPointLight->setPenumbraAngle(outerConeAngle - innerConeAngle);
+                }
+                pLight = pPointLight;
+            }
+            else
+            {
+                logWarning("GLTFImporter: Light '{}' has unsupported type '{}', ignoring.", name, type);
+                return;
+            }
+
+            pLight->setIntensity(intensity);
+
+            SceneBuilder::Node n;
+            n.name = name + ".BaseMatrix";
+            n.parent = nodeID;
+            pLight->setHasAnimation(true);
+            pLight->setNodeID(data.builder.addNode(n));
+            data.builder.addLight(pLight);
+        }
+
+        void addMeshInstances(ImporterData& data, uint32_t meshIndex, uint32_t nodeID)
+        {
+            if (meshIndex >= data.meshIDs.size()) return;
+
+            for (uint32_t meshID : data.meshIDs[meshIndex])
+            {
+                if (data.modelInstances.size())
+                {
+                    for (size_t instance = 0; instance < data.modelInstances.size(); instance++)
+                    {
+                        uint32_t instanceNodeID = nodeID;
+                        if (data.modelInstances[instance] != glm::mat4())
+                        {
+                            SceneBuilder::Node n;
+                            n.name = "Node" + std::to_string(nodeID) + ".instance" + std::to_string(instance);
+                            n.parent = nodeID;
+                            n.transform = data.modelInstances[instance];
+                            instanceNodeID = data.builder.addNode(n);
+                        }
+                        data.builder.addMeshInstance(instanceNodeID, meshID);
+                    }
+                }
+                else data.builder.addMeshInstance(nodeID, meshID);
+            }
+        }
+
+        void createNode(ImporterData& data, uint32_t nodeIndex, uint32_t parentID)
+        {
+            const Json& nodes = getArray(data.doc, "nodes");
+            if (nodeIndex >= nodes.Size()) return;
+            if (data.nodeIDs[nodeIndex] != SceneBuilder::kInvalidNode)
+            {
+                logWarning("GLTFImporter: Node {} is referenced more than once, ignoring.", nodeIndex);
+                return;
+            }
+            const Json& node = nodes[nodeIndex];
+
+            SceneBuilder::Node n;
+            n.name = getString(node, "name", "node" + std::to_string(nodeIndex));
+            n.transform = getNodeTransform(node);
+            n.parent = parentID;
+            const uint32_t nodeID = data.builder.addNode(n);
+            data.nodeIDs[nodeIndex] = nodeID;
+
+            const uint32_t kNone = std::numeric_limits<uint32_t>::max();
+            if (uint32_t meshIndex = getUint(node, "mesh", kNone); meshIndex != kNone) addMeshInstances(data, meshIndex, nodeID);
+            if (uint32_t cameraIndex = getUint(node, "camera", kNone); cameraIndex != kNone) createCamera(data, cameraIndex, nodeID);
+            if (const Json* pLight = getExtension(node, "KHR_lights_punctual")) createLight(data, getUint(*pLight, "light", kNone), nodeID);
+
+            for (const auto& child : getArray(node, "children").GetArray())
+            {
+                if (child.IsUint()) createNode(data, child.GetUint(), nodeID);
+            }
+        }
+
+        void createSceneGraph(ImporterData& data)
+        {
+            const Json& nodes = getArray(data.doc, "nodes");
+            data.nodeIDs.assign(nodes.Size(), SceneBuilder::kInvalidNode);
+
+            // Use the root nodes of the default scene, or of the first scene if no default is given.
+            std::vector<uint32_t> rootNodes;
+            const Json& scenes = getArray(data.doc, "scenes");
+            const uint32_t sceneIndex = getUint(data.doc, "scene", 0);
+            if (sceneIndex < scenes.Size())
+            {
+                for (const auto& node : getArray(scenes[sceneIndex], "nodes").GetArray())
+                {
+                    if (node.IsUint()) rootNodes.push_back(node.GetUint());
+                }
+            }
+            else
+            {
+                // Without scenes, all nodes that are not children of other nodes are roots.
+                std::vector<bool> isChild(nodes.Size(), false);
+                for (const auto& node : nodes.GetArray())
+                {
+                    for (const auto& child : getArray(node, "children").GetArray())
+                    {
+                        if (child.IsUint() && child.GetUint() < nodes.Size()) isChild[child.GetUint()] = true;
+                    }
+                }
+                for (uint32_t i = 0; i < nodes.Size(); i++)
+                {
+                    if (!isChild[i]) rootNodes.push_back(i);
+                }
+            }
+
+            for (uint32_t nodeIndex : rootNodes)
+            {
+                createNode(data, nodeIndex, SceneBuilder::kInvalidNode);
+            }
+        }
+    }
+
+    void GLTFImporter::import(const std::filesystem::path& path, SceneBuilder& builder, const SceneBuilder::InstanceMatrices& instances, const Dictionary& dict)
+    {
+        TimeReport timeReport;
+
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath))
+        {
+            throw ImporterError(path, "File not found.");
+        }
+
+        ImporterData data(path, builder, instances);
+        data.searchPath = fullPath.parent_path();
+
+        loadDocument(data, fullPath);
+
+        if (auto feature = findUnsupportedFeature(data.doc); !feature.empty())
+        {
+            logInfo("GLTFImporter: '{}' uses {}, importing with AssimpImporter.", path.string(), feature);
+            AssimpImporter::import(path, builder, instances, dict);
+            return;
+        }
+
+        // Optional extensions may be ignored, but the result can differ from the intended look (e.g. without texture transforms).
+        for (const auto& extension : getArray(data.doc, "extensionsUsed").GetArray())
+        {
+            std::string name = extension.IsString() ? extension.GetString() : "";
+            if (std::find(kSupportedExtensions.begin(), kSupportedExtensions.end(), name) == kSupportedExtensions.end())
+            {
+                logWarning("GLTFImporter: '{}' uses extension '{}', which is ignored.", path.string(), name);
+            }
+        }
+        timeReport.measure("Loading asset file");
+
+        createMaterials(data);
+        timeReport.measure("Creating materials");
+
+        createMeshes(data);
+        timeReport.measure("Creating meshes");
+
+        createSceneGraph(data);
+        timeReport.measure("Creating scene graph");
+
+        timeReport.printToLog();
+    }
+
+    FALCOR_REGISTER_IMPORTER(
+        GLTFImporter,
+        Importer::ExtensionList({
+            "gltf",
+            "glb",
+        })
+    )
+}
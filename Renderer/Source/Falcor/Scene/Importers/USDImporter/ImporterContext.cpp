@@ -68,6 +68,7 @@
 #pragma warning(pop)
 #include "glm/gtx/matrix_decompose.hpp"
 #include "Scene/Curves/CurveConfig.h"
+#include <map>
 
 namespace Falcor
 {
@@ -81,6 +82,9 @@ namespace Falcor
         const float kDefaultCurveAzimuthalRoughness = 0.3f;
         const float kDefaultScaleAngleDegree = 1.f;
 
+        // Version of the prototype cache key. Increment when mesh conversion changes.
+        const uint32_t kPrototypeCacheKeyVersion = 1;
+
         // Data required to instantiate a UsdGeomSubset
         struct GeomSubset
         {
@@ -802,6 +806,154 @@ namespace Falcor
             }
         }
 
+        template<typename T>
+        bool hashArrayValue(const VtValue& value, SHA1& sha1)
+        {
+            if (!value.IsHolding<VtArray<T>>()) return false;
+            const auto& array = value.UncheckedGet<VtArray<T>>();
+            uint64_t count = array.size();
+            sha1.update(&count, sizeof(count));
+            sha1.update(array.cdata(), array.size() * sizeof(T));
+            return true;
+        }
+
+        void hashString(const std::string& str, SHA1& sha1)
+        {
+            sha1.update(str.data(), str.size() + 1);
+        }
+
+        // Hash the authored attribute values of a prim that affect the converted geometry.
+        void hashPrimAttributes(const UsdPrim& prim, UsdTimeCode timeCode, SHA1& sha1)
+        {
+            for (const UsdAttribute& attr : prim.GetAuthoredAttributes())
+            {
+                // Transforms and visibility are applied per instance and don't affect the processed geometry.
+                const std::string name = attr.GetName().GetString();
+                if (name.rfind("xformOp", 0) == 0 || name == "visibility" || name == "purpose") continue;
+
+                hashString(name, sha1);
+                hashString(attr.GetTypeName().GetAsToken().GetString(), sha1);
+
+                UsdGeomPrimvar primvar(attr);
+                if (primvar)
+                {
+                    hashString(primvar.GetInterpolation().GetString(), sha1);
+                    int elementSize = primvar.GetElementSize();
+                    sha1.update(&elementSize, sizeof(elementSize));
+                }
+
+                // Hash the raw data of the common array types, fall back to the value hash for everything else.
+                VtValue value;
+                attr.Get(&value, timeCode);
+                if (!hashArrayValue<GfVec3f>(value, sha1) && !hashArrayValue<GfVec2f>(value, sha1) && !hashArrayValue<GfVec4f>(value, sha1) &&
+                    !hashArrayValue<int>(value, sha1) && !hashArrayValue<float>(value, sha1))
+                {
+                    size_t hash = value.GetHash();
+                    sha1.update(&hash, sizeof(hash));
+                }
+            }
+        }
+
+        // Compute the prototype cache key of a mesh.
+        // Returns an empty key if the mesh can't be cached. Only static, non-skinned UsdGeomMeshes are cached,
+        // as keyframes and skinning data refer to stage-specific state.
+        std::optional<PrototypeCache::Key> computeMeshCacheKey(const Mesh& mesh, ImporterContext& ctx)
+        {
+            if (!PrototypeCache::isEnabled()) return {};
+            if (!mesh.prim.IsA<UsdGeomMesh>()) return {};
+            if (mesh.timeSamples.size() > 1 || isTimeSampled(UsdGeomPointBased(mesh.prim))) return {};
+            if (ctx.meshSkelMap.find(mesh.prim) != ctx.meshSkelMap.end()) return {};
+
+            UsdTimeCode timeCode(mesh.timeSamples[0]);
+            SceneBuilder::Flags flags = ctx.builder.getFlags();
+
+            SHA1 sha1;
+            sha1.update(&kPrototypeCacheKeyVersion, sizeof(kPrototypeCacheKeyVersion));
+            sha1.update(&flags, sizeof(flags));
+            hashPrimAttributes(mesh.prim, timeCode, sha1);
+            for (const UsdGeomSubset& geomSubset : UsdGeomSubset::GetAllGeomSubsets(UsdGeomMesh(mesh.prim)))
+            {
+                hashString(geomSubset.GetPrim().GetName().GetString(), sha1);
+                hashPrimAttributes(geomSubset.GetPrim(), timeCode, sha1);
+            }
+            return sha1.final();
+        }
+
+        // Check if the texture coordinates of a processed mesh are independent of its material.
+        bool hasIdentityTextureTransform(const Material::SharedPtr& pMaterial)
+        {
+            return pMaterial->getTextureTransform().getMatrix() == glm::identity<glm::mat4>();
+        }
+
+        // Reference the geometry of a prototype cache entry from a mesh.
+        // Names and materials are resolved from the stage. Returns false if the entry can't be used.
+        bool usePrototype(Mesh& mesh, const std::shared_ptr<const PrototypeCache::MeshEntry>& pEntry, ImporterContext& ctx)
+        {
+            const std::string primName = mesh.prim.GetPath().GetString();
+
+            ProcessedMeshList processedMeshes;
+            processedMeshes.reserve(pEntry->subsets.size());
+            for (const auto& subset : pEntry->subsets)
+            {
+                SceneBuilder::ProcessedMesh processedMesh;
+                UsdShadeMaterial material;
+                if (subset.name.empty())
+                {
+                    processedMesh.name = primName;
+                    material = ctx.getBoundMaterial(UsdGeomMesh(mesh.prim));
+                }
+                else
+                {
+                    UsdGeomSubset geomSubset(mesh.prim.GetChild(TfToken(subset.name)));
+                    if (!geomSubset) return false;
+                    processedMesh.name = geomSubset.GetPath().GetString();
+                    material = ctx.getBoundMaterial(geomSubset);
+                }
+                processedMesh.pMaterial = ctx.resolveMaterial(mesh.prim, material, processedMesh.name);
+                if (!hasIdentityTextureTransform(processedMesh.pMaterial)) return false;
+                processedMeshes.push_back(std::move(processedMesh));
+            }
+
+            mesh.processedMeshes = std::move(processedMeshes);
+            mesh.pPrototype = pEntry;
+            return true;
+        }
+
+        // Move the processed geometry of a mesh into a prototype cache entry and reference that entry.
+        // The processed meshes keep their names and materials only.
+        void storePrototype(const PrototypeCache::Key& key, Mesh& mesh)
+        {
+            // Texture coordinates are pre-transformed by the material's texture transform.
+            for (const auto& processedMesh : mesh.processedMeshes)
+            {
+                if (!hasIdentityTextureTransform(processedMesh.pMaterial)) return;
+            }
+
+            const std::string primName = mesh.prim.GetPath().GetString();
+
+            PrototypeCache::MeshEntry entry;
+            entry.subsets.reserve(mesh.processedMeshes.size());
+            for (auto& processedMesh : mesh.processedMeshes)
+            {
+                PrototypeCache::MeshEntry::Subset subset;
+                if (processedMesh.name != primName)
+                {
+                    FALCOR_ASSERT(processedMesh.name.size() > primName.size() && processedMesh.name.compare(0, primName.size(), primName) == 0);
+                    subset.name = processedMesh.name.substr(primName.size() + 1);
+                }
+                subset.mesh = std::move(processedMesh);
+                processedMesh = {};
+                processedMesh.name = std::move(subset.mesh.name);
+                processedMesh.pMaterial = std::move(subset.mesh.pMaterial);
+                subset.mesh.name.clear();
+                subset.mesh.pMaterial = nullptr;
+                entry.subsets.push_back(std::move(subset));
+            }
+
+            // If another thread added the same geometry in the meantime, the existing entry is referenced and ours is released.
+            mesh.pPrototype = PrototypeCache::addMesh(key, std::move(entry));
+        }
+
         bool processMesh(Mesh& mesh, ImporterContext& ctx)
         {
             FALCOR_ASSERT(mesh.prim.IsA<UsdGeomMesh>() || mesh.prim.IsA<UsdGeomBasisCurves>());
@@ -809,6 +961,15 @@ namespace Falcor
 
             std::string primName = mesh.prim.GetPath().GetString();
 
+            // Reuse the processed geometry if the same mesh was processed before, e.g., by another prim or stage referencing the same asset.
+            auto cacheKey = computeMeshCacheKey(mesh, ctx);
+            if (cacheKey)
+            {
+                mesh.prototypeKey = cacheKey;
+                auto pEntry = PrototypeCache::findMesh(*cacheKey);
+                if (pEntry && usePrototype(mesh, pEntry, ctx)) return true;
+            }
+
             // First, convert USD data to Falcor-friendly data, based on the underlying prim type.
             MeshGeomData geomData;
 
@@ -860,6 +1021,8 @@ namespace Falcor
                 mesh.processedMeshes.push_back(ctx.builder.processMesh(sbMesh, pAttributeIndices));
             }
 
+            if (cacheKey) storePrototype(*cacheKey, mesh);
+
             return true;
         }
 
@@ -1056,6 +1219,7 @@ namespace Falcor
         void addMeshesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
             // Process collected mesh tasks.
+            const auto prevCacheStats = PrototypeCache::getStats();
             NumericRange<size_t> meshRange(0, ctx.meshTasks.size());
             std::for_each(std::execution::par, meshRange.begin(), meshRange.end(),
                 [&](size_t i)
@@ -1067,13 +1231,44 @@ namespace Falcor
 
             // Add processed meshes to scene builder.
             // This is done sequentially after being processed in parallel to ensure a deterministic ordering.
+            // Prims with the same prototype geometry and materials become instances of the same scene builder meshes.
+            const bool shareMeshes = !is_set(ctx.builder.getFlags(), SceneBuilder::Flags::DontMergeMeshes);
+            std::map<std::pair<PrototypeCache::Key, std::vector<const Material*>>, std::vector<uint32_t>> sharedMeshIDs;
+            size_t sharedMeshCount = 0;
             for (auto& mesh : ctx.meshes)
             {
                 FALCOR_ASSERT(mesh.meshIDs.empty());
-                for (auto& m : mesh.processedMeshes)
+                if (!mesh.pPrototype)
                 {
-                    mesh.meshIDs.push_back(ctx.builder.addProcessedMesh(m));
+                    for (auto& m : mesh.processedMeshes)
+                    {
+                        mesh.meshIDs.push_back(ctx.builder.addProcessedMesh(m));
+                    }
+                    continue;
+                }
+
+                std::vector<const Material*> materials;
+                for (const auto& m : mesh.processedMeshes) materials.push_back(m.pMaterial.get());
+                auto sharedKey = std::make_pair(*mesh.prototypeKey, std::move(materials));
+                if (auto it = sharedMeshIDs.find(sharedKey); shareMeshes && it != sharedMeshIDs.end())
+                {
+                    mesh.meshIDs = it->second;
+                    sharedMeshCount++;
+                }
+                else
+                {
+                    FALCOR_ASSERT(mesh.pPrototype->subsets.size() == mesh.processedMeshes.size());
+                    for (size_t i = 0; i < mesh.processedMeshes.size(); i++)
+                    {
+                        SceneBuilder::ProcessedMesh m = mesh.pPrototype->subsets[i].mesh;
+                        m.name = mesh.processedMeshes[i].name;
+                        m.pMaterial = mesh.processedMeshes[i].pMaterial;
+                        mesh.meshIDs.push_back(ctx.builder.addProcessedMesh(m));
+                    }
+                    if (shareMeshes) sharedMeshIDs.emplace(std::move(sharedKey), mesh.meshIDs);
                 }
+                mesh.processedMeshes.clear();
+                mesh.pPrototype = nullptr;
             }
 
             if (kLoadMeshVertexAnimations)
@@ -1119,6 +1314,13 @@ namespace Falcor
 
             timeReport.measure("Process meshes");
 
+            if (PrototypeCache::isEnabled())
+            {
+                const auto cacheStats = PrototypeCache::getStats();
+                logInfo("USD prototype cache: reused the geometry of {} of {} meshes, {} meshes added as instances of another prim's mesh, reused {} textures.",
+                    cacheStats.meshHitCount - prevCacheStats.meshHitCount, ctx.meshTasks.size(), sharedMeshCount, cacheStats.textureHitCount - prevCacheStats.textureHitCount);
+            }
+
             // Helper function to add all submeshes associated with the given UsdGeomMesh to SceneBuilder
             auto addSubmeshes = [&](const UsdPrim& meshPrim, const std::string& name, const float4x4& xform, const float4x4& bindXform, uint32_t parentId)
             {
@@ -1817,20 +2019,29 @@ namespace Falcor
 
 
     void ImporterContext::addMesh(const UsdPrim& prim)
+    {
+        if (geomMap.find(prim) == geomMap.end())
+        {
+            // Get time samples from the points attribute
+            std::vector<double> timeSamples;
+            UsdGeomPointBased geomPointBased(prim);
+            geomPointBased.GetPointsAttr().GetTimeSamples(&timeSamples);
+            addMesh(prim, std::move(timeSamples));
+        }
+    }
+
+    void ImporterContext::addMesh(const UsdPrim& prim, std::vector<double> timeSamples)
     {
         // It's possible that the same mesh gprim may be appear both as a regular Mesh and as part of a prototype.
         // Make sure to only add it once to meshes and meshMap.
         if (geomMap.find(prim) == geomMap.end())
         {
             Mesh mesh{ prim };
+            mesh.timeSamples = std::move(timeSamples);
 
             // Mesh will be added at the next index
             size_t index = meshes.size();
 
-            // Get time samples from the points attribute
-            UsdGeomPointBased geomPointBased(prim);
-            geomPointBased.GetPointsAttr().GetTimeSamples(&mesh.timeSamples);
-
             if (mesh.timeSamples.size() == 0)
             {
                 mesh.timeSamples.push_back(0.0);
@@ -2248,10 +2459,26 @@ namespace Falcor
         return rootXform * localToWorld;
     }
 
+    LocalXform ImporterContext::readLocalXform(const UsdGeomXformable& prim)
+    {
+        LocalXform localXform;
+        localXform.timeVarying = prim.TransformMightBeTimeVarying();
+        if (!localXform.timeVarying)
+        {
+            localXform.resetsXformStack = getLocalTransform(prim, localXform.transform);
+        }
+        return localXform;
+    }
+
     void ImporterContext::pushNode(const UsdGeomXformable& prim)
+    {
+        pushNode(prim, readLocalXform(prim));
+    }
+
+    void ImporterContext::pushNode(const UsdGeomXformable& prim, const LocalXform& localXform)
     {
         uint32_t nodeID;
-        if (prim.TransformMightBeTimeVarying())
+        if (localXform.timeVarying)
         {
             nodeID = createAnimation(prim);
         }
@@ -2259,12 +2486,10 @@ namespace Falcor
         {
             // The node stack should at least contain the root node.
             FALCOR_ASSERT(nodeStack.size() > 0);
-            float4x4 localTransform;
-            bool resets = getLocalTransform(prim, localTransform);
             SceneBuilder::Node node;
             node.name = prim.GetPath().GetString();
-            node.transform = localTransform;
-            node.parent = resets ? getRootNodeID() : nodeStack.back();
+            node.transform = localXform.transform;
+            node.parent = localXform.resetsXformStack ? getRootNodeID() : nodeStack.back();
             nodeID = builder.addNode(node);
         }
         nodeStack.push_back(nodeID);
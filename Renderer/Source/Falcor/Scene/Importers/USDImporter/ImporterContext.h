@@ -33,6 +33,7 @@
 #include <filesystem>
 #include <numeric>
 #include <execution>
+#include <optional>
 
 #include "pxr/usd/usdGeom/xformCommonAPI.h"
 #include "pxr/usd/usd/prim.h"
@@ -42,6 +43,7 @@
 #include "pxr/usd/usdGeom/pointInstancer.h"
 
 #include "PreviewSurfaceConverter.h"
+#include "PrototypeCache.h"
 
 using namespace pxr;
 
@@ -71,6 +73,15 @@ namespace Falcor
         std::vector<Animation::Keyframe> keyframes;     ///< Keyframes for animated instance transformation, if any.
     };
 
+    /** Local transform of an xformable prim, read ahead of adding its node to the scene builder.
+    */
+    struct LocalXform
+    {
+        bool timeVarying = false;                       ///< True if the transform might be time-varying. The transform is then sampled by createAnimation() instead.
+        bool resetsXformStack = false;                  ///< True if the prim resets the transform stack.
+        float4x4 transform = float4x4(1.f);             ///< Local transform at the earliest time code.
+    };
+
     /** Mesh processing task parameters
     */
     struct MeshProcessingTask
@@ -93,6 +104,9 @@ namespace Falcor
         UsdPrim prim;                       ///< UsdGeomMesh prim, or UsdGeomBasisCurves prim to be tessellated into into a mesh.
         std::vector<double> timeSamples;    ///< Animation time samples.
 
+        std::optional<PrototypeCache::Key> prototypeKey;                ///< Content key of the processed geometry if it can be shared (see PrototypeCache).
+        std::shared_ptr<const PrototypeCache::MeshEntry> pPrototype;    ///< Shared processed geometry. If set, processedMeshes only hold the names and materials.
+
         // Per GeomSubset
         ProcessedMeshList processedMeshes;          ///< Temporary list of pre-processed meshes
         std::vector<CachedMesh> cachedMeshes;       ///< Keyframe data for vertex-animated meshes per processed mesh
@@ -238,6 +252,7 @@ namespace Falcor
 
         // Meshes
         void addMesh(const UsdPrim& prim);
+        void addMesh(const UsdPrim& prim, std::vector<double> timeSamples);     ///< Add a mesh using time samples of its points attribute that were read ahead.
         const Mesh& getMesh(const UsdPrim& meshPrim) { return meshes[geomMap.at(meshPrim)]; }
         void addGeomInstance(const std::string& name, const UsdPrim& prim, const float4x4& xform, const float4x4& bindxform);
 
@@ -285,6 +300,8 @@ namespace Falcor
         float4x4 getLocalToWorldXform(const UsdGeomXformable& prim, UsdTimeCode time = UsdTimeCode::EarliestTime());
         size_t getNodeStackDepth() const { return nodeStack.size(); }
         void pushNode(const UsdGeomXformable& prim);
+        void pushNode(const UsdGeomXformable& prim, const LocalXform& localXform);
+        static LocalXform readLocalXform(const UsdGeomXformable& prim);        ///< Read the local transform of a prim. Thread-safe.
         void popNode() { nodeStack.pop_back(); }
         uint32_t getRootNodeID() const { return nodeStack[nodeStackStartDepth.back()]; }
         float4x4 getGeomBindTransform(const UsdPrim& usdPrim) const;
@@ -323,6 +340,7 @@ namespace Falcor
         float4x4 rootXform;                                                                          ///< Pseudoroot xform, correcting for world unit scaling and up vector orientation.
         uint32_t rootXformNodeId = Scene::kInvalidNode;                                              ///< Get the node ID containing the scene root transform in the builder's scene graph
         bool useInstanceProxies = false;                                                             ///< If true, traverse instances as if they were non-instances (debugging feature).
+        bool parallelTraversal = true;                                                               ///< If true, read prims of independent subtrees in parallel during stage traversal.
 
         std::unordered_map<std::string, Material::SharedPtr> materialMap;                            ///< Created material instances, indexed by material instance name.
         std::unordered_map<float3, Material::SharedPtr, Float3Hash> defaultMaterialMap;              ///< Default materials, indexed by base color.
@@ -41,6 +41,7 @@
 #pragma warning(pop)
 
 #include "Utils.h"
+#include "PrototypeCache.h"
 
 using namespace pxr;
 
@@ -323,6 +324,10 @@ namespace Falcor
                 }
             }
 
+            // Reuse the texture if the same file is already loaded by another stage.
+            ret.pTexture = PrototypeCache::findTexture(filename, loadSRGB);
+            if (ret.pTexture) return ret;
+
             // Create the texture by first reading the image (which is relatively slow) outside of the mutex,
             // and then creating the texture itself inside it.
             Bitmap::UniqueConstPtr pBitmap(Bitmap::createFromFile(filename, false));
@@ -333,6 +338,7 @@ namespace Falcor
                     std::scoped_lock lock(mMutex);
                     ret.pTexture = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), format, 1, Texture::kMaxPossible, pBitmap->getData());
                 }
+                if (ret.pTexture) PrototypeCache::addTexture(filename, loadSRGB, ret.pTexture);
             }
             // Else, a warning will have been emitted by Bitmap::createFromFile(), and the fallback value will be used.
         }
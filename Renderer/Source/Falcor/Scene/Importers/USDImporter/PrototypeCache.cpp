@@ -0,0 +1,222 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "PrototypeCache.h"
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kDefaultMaxMemoryUsage = size_t(256) << 20;
+
+        struct MeshSlot
+        {
+            std::shared_ptr<const PrototypeCache::MeshEntry> pEntry;
+            std::list<PrototypeCache::Key>::iterator lruIt;
+            size_t memoryUsage = 0;
+        };
+
+        struct State
+        {
+            std::mutex mutex;
+            bool enabled = true;
+            size_t maxMemoryUsage = kDefaultMaxMemoryUsage;
+            std::map<PrototypeCache::Key, MeshSlot> meshes;
+            std::list<PrototypeCache::Key> meshLru;                         ///< Mesh keys, most recently used first.
+            std::unordered_map<std::string, std::weak_ptr<Texture>> textures;
+            PrototypeCache::Stats stats;
+        };
+
+        State& getState()
+        {
+            static State sState;
+            return sState;
+        }
+
+        /** Create the texture key. The file's modification time and size are included so that edited files are reloaded.
+        */
+        std::string getTextureKey(const std::filesystem::path& path, bool srgb)
+        {
+            std::error_code ec;
+            auto modifiedTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+            auto size = std::filesystem::file_size(path, ec);
+            return fmt::format("{}|{}|{}|{}", path.string(), srgb, modifiedTime, ec ? 0 : size);
+        }
+
+        void evictMeshesLocked(State& state)
+        {
+            while (state.stats.meshMemoryUsage > state.maxMemoryUsage && !state.meshLru.empty())
+            {
+                auto it = state.meshes.find(state.meshLru.back());
+                FALCOR_ASSERT(it != state.meshes.end());
+                state.stats.meshMemoryUsage -= it->second.memoryUsage;
+                state.stats.meshEvictionCount++;
+                state.meshes.erase(it);
+                state.meshLru.pop_back();
+            }
+            state.stats.meshEntryCount = state.meshes.size();
+        }
+    }
+
+    size_t PrototypeCache::MeshEntry::getMemoryUsage() const
+    {
+        size_t size = sizeof(MeshEntry);
+        for (const auto& subset : subsets)
+        {
+            size += sizeof(Subset) + subset.name.size();
+            size += subset.mesh.indexData.size() * sizeof(uint32_t);
+            size += subset.mesh.staticData.size() * sizeof(StaticVertexData);
+            size += subset.mesh.skinningData.size() * sizeof(SkinningVertexData);
+        }
+        return size;
+    }
+
+    void PrototypeCache::setEnabled(bool enabled)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.enabled = enabled;
+    }
+
+    bool PrototypeCache::isEnabled()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.enabled;
+    }
+
+    void PrototypeCache::setMaxMemoryUsage(size_t maxMemoryUsage)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.maxMemoryUsage = maxMemoryUsage;
+        evictMeshesLocked(state);
+    }
+
+    size_t PrototypeCache::getMaxMemoryUsage()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.maxMemoryUsage;
+    }
+
+    std::shared_ptr<const PrototypeCache::MeshEntry> PrototypeCache::findMesh(const Key& key)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.enabled) return nullptr;
+
+        auto it = state.meshes.find(key);
+        if (it == state.meshes.end())
+        {
+            state.stats.meshMissCount++;
+            return nullptr;
+        }
+
+        state.meshLru.splice(state.meshLru.begin(), state.meshLru, it->second.lruIt);
+        state.stats.meshHitCount++;
+        return it->second.pEntry;
+    }
+
+    std::shared_ptr<const PrototypeCache::MeshEntry> PrototypeCache::addMesh(const Key& key, MeshEntry&& entry)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        auto pEntry = std::make_shared<const MeshEntry>(std::move(entry));
+        if (!state.enabled) return pEntry;
+
+        auto it = state.meshes.find(key);
+        if (it != state.meshes.end()) return it->second.pEntry;
+
+        size_t memoryUsage = pEntry->getMemoryUsage();
+        if (memoryUsage > state.maxMemoryUsage) return pEntry;
+
+        state.meshLru.push_front(key);
+        state.meshes[key] = MeshSlot{ pEntry, state.meshLru.begin(), memoryUsage };
+        state.stats.meshMemoryUsage += memoryUsage;
+        evictMeshesLocked(state);
+        return pEntry;
+    }
+
+    Texture::SharedPtr PrototypeCache::findTexture(const std::filesystem::path& path, bool srgb)
+    {
+        if (!isEnabled()) return nullptr;
+        auto textureKey = getTextureKey(path, srgb);
+
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.enabled) return nullptr;
+
+        auto it = state.textures.find(textureKey);
+        Texture::SharedPtr pTexture = it != state.textures.end() ? it->second.lock() : nullptr;
+        if (pTexture) state.stats.textureHitCount++;
+        else state.stats.textureMissCount++;
+        return pTexture;
+    }
+
+    void PrototypeCache::addTexture(const std::filesystem::path& path, bool srgb, const Texture::SharedPtr& pTexture)
+    {
+        if (!isEnabled()) return;
+        auto textureKey = getTextureKey(path, srgb);
+
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.enabled) return;
+
+        // Drop entries of released textures.
+        for (auto it = state.textures.begin(); it != state.textures.end();)
+        {
+            if (it->second.expired()) it = state.textures.erase(it);
+            else ++it;
+        }
+        state.textures[textureKey] = pTexture;
+    }
+
+    void PrototypeCache::clear()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.meshes.clear();
+        state.meshLru.clear();
+        state.textures.clear();
+        state.stats.meshEntryCount = 0;
+        state.stats.meshMemoryUsage = 0;
+    }
+
+    PrototypeCache::Stats PrototypeCache::getStats()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.stats;
+    }
+}
@@ -0,0 +1,149 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Scene/SceneBuilder.h"
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Process-wide cache for prototype assets imported from USD stages.
+
+        Environment sets tend to reuse the same prototypes (trees, rocks, props) across many stages.
+        The cache stores the processed geometry of these prototypes independently of the stage they
+        were imported from, so that importing another stage that uses the same assets skips mesh conversion,
+        triangulation, tangent generation and vertex deduplication.
+
+        Meshes are content-addressed: the key is computed from the authored attribute values of the mesh prim
+        and its geometry subsets (see `ImporterContext`), not from prim paths or layer identifiers. Entries are
+        immutable and do not hold any stage-specific data; names and materials are resolved by the importer.
+        During an import, all prims with the same key reference the same entry instead of holding their own copy
+        of the processed geometry, and prims that also bind the same materials are added as instances of a single
+        scene builder mesh. Entries are retained across imports within a memory budget (256 MB by default), least
+        recently used entries are evicted first. A budget of zero only shares geometry within each import.
+
+        Source textures of materials are shared by file, keyed by resolved path, color space, modification time and size.
+        Textures are held weakly, so they are deduplicated within a scene and between scenes that are loaded at the
+        same time, but released with the last scene using them.
+
+        Materials are not shared across scenes, as they are bound to the material system of a single scene.
+        Within a scene, identical materials are merged by SceneBuilder (see SceneBuilder::Flags::DontMergeMaterials).
+
+        All functions are thread-safe.
+    */
+    class FALCOR_API PrototypeCache
+    {
+    public:
+        using Key = SHA1::MD;
+
+        /** Processed geometry of a mesh prim.
+        */
+        struct MeshEntry
+        {
+            struct Subset
+            {
+                std::string name;                   ///< Name of the GeomSubset child prim, or empty if the entry covers the mesh prim itself.
+                SceneBuilder::ProcessedMesh mesh;   ///< Processed mesh. The name and material are not set.
+            };
+
+            std::vector<Subset> subsets;            ///< Processed mesh per non-empty geometry subset.
+
+            /** Get the approximate memory usage in bytes.
+            */
+            size_t getMemoryUsage() const;
+        };
+
+        struct Stats
+        {
+            uint64_t meshHitCount = 0;              ///< Number of mesh lookups that returned an entry.
+            uint64_t meshMissCount = 0;             ///< Number of mesh lookups that did not find an entry.
+            uint64_t meshEvictionCount = 0;         ///< Number of mesh entries evicted to stay within the memory budget.
+            uint64_t textureHitCount = 0;           ///< Number of texture lookups that returned a live texture.
+            uint64_t textureMissCount = 0;          ///< Number of texture lookups that did not find a live texture.
+            size_t meshEntryCount = 0;              ///< Number of mesh entries.
+            size_t meshMemoryUsage = 0;             ///< Approximate memory usage of all mesh entries in bytes.
+        };
+
+        /** Enable/disable the cache. If disabled, all lookups miss, nothing is added and the importer doesn't share
+            geometry between prims. The cache is enabled by default.
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled.
+        */
+        static bool isEnabled();
+
+        /** Set the memory budget for mesh entries that are retained across imports in bytes.
+            Least recently used entries are evicted when the budget is exceeded. Entries that don't fit are
+            returned by addMesh() without being retained.
+        */
+        static void setMaxMemoryUsage(size_t maxMemoryUsage);
+
+        /** Get the memory budget for mesh entries in bytes.
+        */
+        static size_t getMaxMemoryUsage();
+
+        /** Look up a mesh entry.
+            \param[in] key Content key of the mesh.
+            \return The entry, or nullptr if not found.
+        */
+        static std::shared_ptr<const MeshEntry> findMesh(const Key& key);
+
+        /** Add a mesh entry. If an entry with the same key exists (e.g., added concurrently by another thread) it is kept.
+            \param[in] key Content key of the mesh.
+            \param[in] entry Processed geometry.
+            \return The entry stored in the cache, or the new entry if it is not retained. Callers should reference this entry.
+        */
+        static std::shared_ptr<const MeshEntry> addMesh(const Key& key, MeshEntry&& entry);
+
+        /** Look up a texture created from a file.
+            \param[in] path Resolved file path.
+            \param[in] srgb True if the texture was created with an sRGB format.
+            \return The texture, or nullptr if not found or no longer in use.
+        */
+        static Texture::SharedPtr findTexture(const std::filesystem::path& path, bool srgb);
+
+        /** Add a texture created from a file.
+            \param[in] path Resolved file path.
+            \param[in] srgb True if the texture was created with an sRGB format.
+            \param[in] pTexture Texture.
+        */
+        static void addTexture(const std::filesystem::path& path, bool srgb, const Texture::SharedPtr& pTexture);
+
+        /** Remove all entries.
+        */
+        static void clear();
+
+        /** Get the cache statistics.
+        */
+        static Stats getStats();
+    };
+}
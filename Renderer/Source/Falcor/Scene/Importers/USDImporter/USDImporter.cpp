@@ -53,148 +53,312 @@
 
 namespace Falcor
 {
-    // Traverse scene graph, converting supported prims from USD to Falcor equivalents
-    void traversePrims(const UsdPrim& rootPrim, ImporterContext& ctx)
+    namespace
     {
-        Usd_PrimFlagsPredicate pred = UsdPrimDefaultPredicate;
-        if (ctx.useInstanceProxies)
-        {
-            // Treat instances as if they were unique prims (primarily for debugging)
-            pred.TraverseInstanceProxies(true);
-        }
+        // Maximum depth at which the stage is split into subtrees for parallel traversal.
+        const uint32_t kMaxTraversalSplitDepth = 3;
 
-        UsdPrimRange range = UsdPrimRange::PreAndPostVisit(rootPrim, pred);
+        // Import options.
+        const char kParallelTraversal[] = "parallelTraversal";  ///< Read prims of independent subtrees in parallel during stage traversal (default true).
 
-        for (auto it = range.begin(); it != range.end(); ++it)
+        enum class PrimKind
         {
-            UsdPrim prim = *it;
-            std::string primName = prim.GetPath().GetString();
+            Other,
+            NonRenderable,
+            Instance,
+            InvalidInstance,
+            PointInstancer,
+            Mesh,
+            Curve,
+            SkelRoot,
+            DistantLight,
+            RectLight,
+            SphereLight,
+            DiskLight,
+            DomeLight,
+            Camera,
+            Xform,
+            Ignored,
+            Scope,
+            Unsupported,
+        };
+
+        // Data read from a prim during traversal.
+        // Records are read per subtree, possibly in parallel, and then applied to the importer context in stage order.
+        struct PrimRecord
+        {
+            UsdPrim prim;
+            bool postVisit = false;                 ///< True if this is the post visit of the prim.
+            bool xformable = false;                 ///< True if the prim is a UsdGeomXformable.
+            PrimKind kind = PrimKind::Other;
+            LocalXform localXform;                  ///< Local transform, if xformable.
+            UsdPrim protoPrim;                      ///< Prototype prim, if an instance.
+            std::vector<double> timeSamples;        ///< Time samples of the points attribute, if a mesh.
+            float4x4 bindXform = float4x4(1.f);     ///< Geometry bind transform, if a mesh.
+        };
+
+        // Sequence of records of the stage, either for a whole subtree, or for the pre or post visit of a prim whose children are split.
+        struct TraversalFragment
+        {
+            UsdPrim subtreeRoot;                    ///< Root of the subtree to read, or invalid if the records are already read.
+            std::vector<PrimRecord> records;
+        };
 
-            if (!it.IsPostVisit())
+        Usd_PrimFlagsPredicate getTraversalPredicate(const ImporterContext& ctx)
+        {
+            Usd_PrimFlagsPredicate pred = UsdPrimDefaultPredicate;
+            if (ctx.useInstanceProxies)
             {
-                // Pre visits
+                // Treat instances as if they were unique prims (primarily for debugging)
+                pred.TraverseInstanceProxies(true);
+            }
+            return pred;
+        }
 
-                // If this prim has an xform associated with it, push it onto the xform stack
-                if (prim.IsA<UsdGeomXformable>())
-                {
-                    ctx.pushNode(UsdGeomXformable(prim));
-                }
+        // Read the pre visit record of a prim. Thread-safe.
+        PrimRecord readPrim(const UsdPrim& prim, const ImporterContext& ctx, bool& pruneChildren)
+        {
+            PrimRecord record;
+            record.prim = prim;
+            pruneChildren = false;
 
-                if (prim.IsA<UsdGeomImageable>() && !isRenderable(UsdGeomImageable(prim)))
-                {
-                    logDebug("Pruning non-renderable prim '{}'.", primName);
-                    it.PruneChildren();
-                    continue;
-                }
+            // If this prim has an xform associated with it, it is pushed onto the xform stack
+            if (prim.IsA<UsdGeomXformable>())
+            {
+                record.xformable = true;
+                record.localXform = ImporterContext::readLocalXform(UsdGeomXformable(prim));
+            }
 
-                if (prim.IsInstance() && !ctx.useInstanceProxies)
-                {
-                    const UsdPrim protoPrim(prim.GetMaster());
+            if (prim.IsA<UsdGeomImageable>() && !isRenderable(UsdGeomImageable(prim)))
+            {
+                record.kind = PrimKind::NonRenderable;
+                pruneChildren = true;
+            }
+            else if (prim.IsInstance() && !ctx.useInstanceProxies)
+            {
+                record.protoPrim = prim.GetMaster();
+                record.kind = record.protoPrim.IsValid() ? PrimKind::Instance : PrimKind::InvalidInstance;
+                pruneChildren = !record.protoPrim.IsValid();
+            }
+            else if (prim.IsA<UsdGeomPointInstancer>())
+            {
+                record.kind = PrimKind::PointInstancer;
+                pruneChildren = true;
+            }
+            else if (prim.IsA<UsdGeomMesh>())
+            {
+                record.kind = PrimKind::Mesh;
+                UsdGeomPointBased(prim).GetPointsAttr().GetTimeSamples(&record.timeSamples);
+                record.bindXform = ctx.getGeomBindTransform(prim);
+            }
+            else if (prim.IsA<UsdGeomBasisCurves>()) record.kind = PrimKind::Curve;
+            else if (prim.IsA<UsdSkelRoot>()) record.kind = PrimKind::SkelRoot;
+            else if (prim.IsA<UsdLuxDistantLight>()) record.kind = PrimKind::DistantLight;
+            else if (prim.IsA<UsdLuxRectLight>()) record.kind = PrimKind::RectLight;
+            else if (prim.IsA<UsdLuxSphereLight>()) record.kind = PrimKind::SphereLight;
+            else if (prim.IsA<UsdLuxDiskLight>()) record.kind = PrimKind::DiskLight;
+            else if (prim.IsA<UsdLuxDomeLight>()) record.kind = PrimKind::DomeLight;
+            else if (prim.IsA<UsdGeomCamera>()) record.kind = PrimKind::Camera;
+            else if (prim.IsA<UsdGeomXform>()) record.kind = PrimKind::Xform;
+            else if (prim.IsA<UsdShadeMaterial>() ||
+                prim.IsA<UsdShadeShader>() ||
+                prim.IsA<UsdGeomSubset>())
+            {
+                // No processing to do; ignore without issuing a warning.
+                record.kind = PrimKind::Ignored;
+                pruneChildren = true;
+            }
+            else if (prim.IsA<UsdGeomScope>()) record.kind = PrimKind::Scope;
+            else if (!prim.GetTypeName().GetString().empty())
+            {
+                record.kind = PrimKind::Unsupported;
+                pruneChildren = true;
+            }
 
-                    if (protoPrim.IsValid())
-                    {
-                        logDebug("Adding instance '{}' of '{}'.", primName, protoPrim.GetPath().GetString());
-                        PrototypeInstance protoInst = { primName, protoPrim, ctx.nodeStack.back() };
+            return record;
+        }
 
-                        ctx.addPrototypeInstance(protoInst);
-                    }
-                    else
-                    {
-                        logError("No valid prototype prim for instance '{}'.", primName);
-                        it.PruneChildren();
-                        continue;
-                    }
-                }
-                else if (prim.IsA<UsdGeomPointInstancer>())
-                {
-                    logDebug("Processing point instancer '{}'.", primName);
-                    ctx.createPointInstances(prim);
-                    it.PruneChildren();
-                }
-                else if (prim.IsA<UsdGeomMesh>())
-                {
-                    logDebug("Adding mesh '{}'.", primName);
-                    ctx.addMesh(prim);
-                    float4x4 bindXform = ctx.getGeomBindTransform(prim);
-                    ctx.addGeomInstance(primName, prim, float4x4(1.f), bindXform);
-                }
-                else if (prim.IsA<UsdGeomBasisCurves>())
-                {
-                    logDebug("Adding curve '{}' for linear swept sphere tessellation.", primName);
-                    ctx.addCurve(prim);
+        PrimRecord makePostVisitRecord(const UsdPrim& prim)
+        {
+            PrimRecord record;
+            record.prim = prim;
+            record.postVisit = true;
+            record.xformable = prim.IsA<UsdGeomXformable>();
+            return record;
+        }
 
-                    // TODO: Add support for curve instancing
-                    // Now we assume each curve has only one instance.
-                    ctx.addCurveInstance(primName, prim, float4x4(1.f), ctx.nodeStack.back());
-                }
-                else if (prim.IsA<UsdSkelRoot>())
-                {
-                    logDebug("Processing Skeleton '{}'.", primName);
-                    ctx.createSkeleton(prim);
-                }
-                else if (prim.IsA<UsdLuxDistantLight>())
-                {
-                    logDebug("Processing distant light '{}'.", primName);
-                    ctx.createDistantLight(prim);
-                }
-                else if (prim.IsA<UsdLuxRectLight>())
-                {
-                    logDebug("Processing rect light '{}'.", primName);
-                    ctx.createRectLight(prim);
-                }
-                else if (prim.IsA<UsdLuxSphereLight>())
-                {
-                    logDebug("Processing sphere light '{}'.", primName);
-                    ctx.createSphereLight(prim);
-                }
-                else if (prim.IsA<UsdLuxDiskLight>())
-                {
-                    logDebug("Processing disk light '{}'.", primName);
-                    ctx.createDiskLight(prim);
-                }
-                else if (prim.IsA<UsdLuxDomeLight>())
-                {
-                    logDebug("Processing dome light '{}'.", primName);
-                    ctx.createEnvMap(prim);
-                }
-                else if (prim.IsA<UsdGeomCamera>())
-                {
-                    logDebug("Processing camera '{}'.", primName);
-                    ctx.createCamera(prim);
-                }
-                else if (prim.IsA<UsdGeomXform>())
-                {
-                    logDebug("Processing xform '{}'.", primName);
-                    // Processing of this UsdGeomXformable performed above
-                }
-                else if (prim.IsA<UsdShadeMaterial>() ||
-                    prim.IsA<UsdShadeShader>() ||
-                    prim.IsA<UsdGeomSubset>())
+        // Read the records of a subtree in pre and post visit order. Thread-safe.
+        void readSubtree(const UsdPrim& rootPrim, const ImporterContext& ctx, std::vector<PrimRecord>& records)
+        {
+            UsdPrimRange range = UsdPrimRange::PreAndPostVisit(rootPrim, getTraversalPredicate(ctx));
+            for (auto it = range.begin(); it != range.end(); ++it)
+            {
+                if (it.IsPostVisit())
                 {
-                    // No processing to do; ignore without issuing a warning.
-                    it.PruneChildren();
+                    records.push_back(makePostVisitRecord(*it));
                 }
-                else if (prim.IsA<UsdGeomScope>())
+                else
                 {
-                    logDebug("Processing scope '{}'.", primName);
+                    bool pruneChildren = false;
+                    records.push_back(readPrim(*it, ctx, pruneChildren));
+                    if (pruneChildren) it.PruneChildren();
                 }
-                else if (!prim.GetTypeName().GetString().empty())
+            }
+        }
+
+        // Split the stage into fragments in stage order. Only grouping prims are split, all other prims are read with their subtree.
+        void splitTraversal(const UsdPrim& prim, const ImporterContext& ctx, uint32_t depth, std::vector<TraversalFragment>& fragments)
+        {
+            if (depth < kMaxTraversalSplitDepth)
+            {
+                auto children = prim.GetFilteredChildren(getTraversalPredicate(ctx));
+                if (!children.empty())
                 {
-                    logWarning("Ignoring prim '{}' of unsupported type {}.", primName, prim.GetTypeName().GetString());
-                    it.PruneChildren();
+                    bool pruneChildren = false;
+                    PrimRecord record = readPrim(prim, ctx, pruneChildren);
+                    if (!pruneChildren && (record.kind == PrimKind::Other || record.kind == PrimKind::Xform || record.kind == PrimKind::Scope))
+                    {
+                        fragments.push_back(TraversalFragment{ UsdPrim(), { std::move(record) } });
+                        for (const UsdPrim& child : children)
+                        {
+                            splitTraversal(child, ctx, depth + 1, fragments);
+                        }
+                        fragments.push_back(TraversalFragment{ UsdPrim(), { makePostVisitRecord(prim) } });
+                        return;
+                    }
                 }
             }
-            else
+            fragments.push_back(TraversalFragment{ prim, {} });
+        }
+
+        // Apply a record to the importer context, converting supported prims from USD to Falcor equivalents.
+        void applyRecord(PrimRecord& record, ImporterContext& ctx)
+        {
+            const UsdPrim& prim = record.prim;
+            std::string primName = prim.GetPath().GetString();
+
+            if (record.postVisit)
             {
-                // Post visits
-                if (prim.IsA<UsdGeomXformable>())
+                if (record.xformable)
                 {
                     ctx.popNode();
                 }
+                return;
+            }
+
+            if (record.xformable)
+            {
+                ctx.pushNode(UsdGeomXformable(prim), record.localXform);
+            }
+
+            switch (record.kind)
+            {
+            case PrimKind::NonRenderable:
+                logDebug("Pruning non-renderable prim '{}'.", primName);
+                break;
+            case PrimKind::Instance:
+            {
+                logDebug("Adding instance '{}' of '{}'.", primName, record.protoPrim.GetPath().GetString());
+                PrototypeInstance protoInst = { primName, record.protoPrim, ctx.nodeStack.back() };
+                ctx.addPrototypeInstance(protoInst);
+                break;
+            }
+            case PrimKind::InvalidInstance:
+                logError("No valid prototype prim for instance '{}'.", primName);
+                break;
+            case PrimKind::PointInstancer:
+                logDebug("Processing point instancer '{}'.", primName);
+                ctx.createPointInstances(prim);
+                break;
+            case PrimKind::Mesh:
+                logDebug("Adding mesh '{}'.", primName);
+                ctx.addMesh(prim, std::move(record.timeSamples));
+                ctx.addGeomInstance(primName, prim, float4x4(1.f), record.bindXform);
+                break;
+            case PrimKind::Curve:
+                logDebug("Adding curve '{}' for linear swept sphere tessellation.", primName);
+                ctx.addCurve(prim);
+
+                // TODO: Add support for curve instancing
+                // Now we assume each curve has only one instance.
+                ctx.addCurveInstance(primName, prim, float4x4(1.f), ctx.nodeStack.back());
+                break;
+            case PrimKind::SkelRoot:
+                logDebug("Processing Skeleton '{}'.", primName);
+                ctx.createSkeleton(prim);
+                break;
+            case PrimKind::DistantLight:
+                logDebug("Processing distant light '{}'.", primName);
+                ctx.createDistantLight(prim);
+                break;
+            case PrimKind::RectLight:
+                logDebug("Processing rect light '{}'.", primName);
+                ctx.createRectLight(prim);
+                break;
+            case PrimKind::SphereLight:
+                logDebug("Processing sphere light '{}'.", primName);
+                ctx.createSphereLight(prim);
+                break;
+            case PrimKind::DiskLight:
+                logDebug("Processing disk light '{}'.", primName);
+                ctx.createDiskLight(prim);
+                break;
+            case PrimKind::DomeLight:
+                logDebug("Processing dome light '{}'.", primName);
+                ctx.createEnvMap(prim);
+                break;
+            case PrimKind::Camera:
+                logDebug("Processing camera '{}'.", primName);
+                ctx.createCamera(prim);
+                break;
+            case PrimKind::Xform:
+                logDebug("Processing xform '{}'.", primName);
+                // Processing of this UsdGeomXformable performed above
+                break;
+            case PrimKind::Scope:
+                logDebug("Processing scope '{}'.", primName);
+                break;
+            case PrimKind::Unsupported:
+                logWarning("Ignoring prim '{}' of unsupported type {}.", primName, prim.GetTypeName().GetString());
+                break;
+            default:
+                break;
             }
         }
     }
 
+    // Traverse scene graph, converting supported prims from USD to Falcor equivalents.
+    // Reading the prims (transforms, time samples, classification) is done per subtree in parallel if enabled.
+    // The records are then applied to the scene builder sequentially in stage order, so that scene IDs are
+    // identical to a serial traversal.
+    void traversePrims(const UsdPrim& rootPrim, ImporterContext& ctx)
+    {
+        std::vector<TraversalFragment> fragments;
+        if (ctx.parallelTraversal) splitTraversal(rootPrim, ctx, 0, fragments);
+        else fragments.push_back(TraversalFragment{ rootPrim, {} });
+
+        auto readFragment = [&](TraversalFragment& fragment)
+        {
+            if (fragment.subtreeRoot) readSubtree(fragment.subtreeRoot, ctx, fragment.records);
+        };
+        if (ctx.parallelTraversal) std::for_each(std::execution::par, fragments.begin(), fragments.end(), readFragment);
+        else std::for_each(fragments.begin(), fragments.end(), readFragment);
+
+        ctx.timeReport.measure("Read prims");
+
+        for (auto& fragment : fragments)
+        {
+            for (auto& record : fragment.records)
+            {
+                applyRecord(record, ctx);
+            }
+            fragment.records.clear();
+            fragment.records.shrink_to_fit();
+        }
+
+        logDebug("Traversed stage in {} fragments.", fragments.size());
+    }
+
     template <typename T>
     T getMetadata(VtDictionary& renderDict, const std::string& key, T defaultValue)
     {
@@ -303,6 +467,7 @@ namespace Falcor
         timeReport.measure("Open stage");
 
         ImporterContext ctx(path, pStage, builder, dict, timeReport);
+        if (dict.keyExists(kParallelTraversal)) ctx.parallelTraversal = (bool)dict[kParallelTraversal];
 
         // Falcor uses meter scene unit; scale if necessary. Note that Omniverse uses cm by default.
         ctx.metersPerUnit = float(UsdGeomGetStageMetersPerUnit(pStage));
@@ -29,6 +29,8 @@
 #include "LightCollection.h"
 #include "LightCollectionShared.slang"
 #include "Scene/Scene.h"
+#include "Utils/NumericRange.h"
+#include <execution>
 #include <sstream>
 
 namespace Falcor
@@ -43,6 +45,9 @@ namespace Falcor
         const char kBuildTriangleListFile[] = "Scene/Lights/BuildTriangleList.cs.slang";
         const char kUpdateTriangleVerticesFile[] = "Scene/Lights/UpdateTriangleVertices.cs.slang";
         const char kFinalizeIntegrationFile[] = "Scene/Lights/FinalizeIntegration.cs.slang";
+
+        // Fraction of triangles that can be out of date before an incremental CPU sync falls back to syncing everything.
+        const float kFullSyncThreshold = 0.5f;
     }
 
     LightCollection::SharedPtr LightCollection::create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene)
@@ -81,6 +86,11 @@ namespace Falcor
         auto pScene = mpScene.lock();
         if (!pScene) return false;
 
+        // Reset the per-frame sync stats.
+        const uint64_t totalBytesTransferred = mCPUSyncStats.totalBytesTransferred;
+        mCPUSyncStats = CPUSyncStats();
+        mCPUSyncStats.totalBytesTransferred = totalBytesTransferred;
+
         if (pUpdateStatus)
         {
             pUpdateStatus->lightsUpdateInfo.clear();
@@ -249,6 +259,7 @@ namespace Falcor
 
             // Build list of active triangles.
             mCPUInvalidData = CPUOutOfDateFlags::All;
+            mDirtyTriangleRanges.clear();
             mStagingBufferValid = false;
             mStatsValid = false;
 
@@ -565,10 +576,58 @@ namespace Falcor
         // Run compute pass to update all triangles.
         mpTrianglePositionUpdater->execute(pRenderContext, mTriangleCount, 1u, 1u);
 
-        mCPUInvalidData |= CPUOutOfDateFlags::TriangleData;
+        // Only the triangles of the updated lights have changed, so only those need to be transferred to the CPU.
+        markTrianglesDirty(updatedLights);
         mStagingBufferValid = false;
     }
 
+    void LightCollection::markTrianglesDirty(const std::vector<uint32_t>& updatedLights)
+    {
+        // Nothing to track if all triangle data is already out of date.
+        if (is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData)) return;
+
+        for (uint32_t lightIdx : updatedLights)
+        {
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            if (meshLight.triangleCount > 0) mDirtyTriangleRanges.push_back(uint2(meshLight.triangleOffset, meshLight.triangleCount));
+        }
+
+        // Sort and merge overlapping or adjacent ranges to minimize the number of copies.
+        std::sort(mDirtyTriangleRanges.begin(), mDirtyTriangleRanges.end(), [](const uint2& a, const uint2& b) { return a.x < b.x; });
+
+        size_t mergedCount = 0;
+        uint64_t dirtyTriangleCount = 0;
+        for (const uint2& range : mDirtyTriangleRanges)
+        {
+            if (mergedCount > 0)
+            {
+                uint2& last = mDirtyTriangleRanges[mergedCount - 1];
+                if (range.x <= last.x + last.y)
+                {
+                    const uint32_t end = std::max(last.x + last.y, range.x + range.y);
+                    dirtyTriangleCount += end - (last.x + last.y);
+                    last.y = end - last.x;
+                    continue;
+                }
+            }
+            mDirtyTriangleRanges[mergedCount++] = range;
+            dirtyTriangleCount += range.y;
+        }
+        mDirtyTriangleRanges.resize(mergedCount);
+
+        // Fall back to syncing all triangles if most of them are out of date anyway.
+        if (dirtyTriangleCount > (uint64_t)(kFullSyncThreshold * mTriangleCount))
+        {
+            mDirtyTriangleRanges.clear();
+            mCPUInvalidData |= CPUOutOfDateFlags::TriangleData;
+            mCPUInvalidData &= ~CPUOutOfDateFlags::TriangleDataRanges;
+        }
+        else if (!mDirtyTriangleRanges.empty())
+        {
+            mCPUInvalidData |= CPUOutOfDateFlags::TriangleDataRanges;
+        }
+    }
+
     void LightCollection::setShaderData(const ShaderVar& var) const
     {
         FALCOR_ASSERT(var.isValid());
@@ -622,15 +681,39 @@ namespace Falcor
         // TODO: Update this code if we start removing geometry dynamically.
         FALCOR_ASSERT(mCPUInvalidData != CPUOutOfDateFlags::None); // We shouldn't get here unless at least some data is out of date.
         bool copyTriangleData = is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData);
+        bool copyTriangleRanges = !copyTriangleData && is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleDataRanges);
         bool copyFluxData = is_set(mCPUInvalidData, CPUOutOfDateFlags::FluxData);
 
         uint64_t offset = 0;
-        if (copyTriangleData) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpTriangleData.get(), 0, mpTriangleData->getSize());
+        uint64_t bytesCopied = 0;
+        if (copyTriangleData)
+        {
+            pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpTriangleData.get(), 0, mpTriangleData->getSize());
+            bytesCopied += mpTriangleData->getSize();
+        }
+        else if (copyTriangleRanges)
+        {
+            // The staging buffer mirrors the layout of the GPU buffer, so the updated ranges are copied in place.
+            for (const uint2& range : mDirtyTriangleRanges)
+            {
+                const uint64_t rangeOffset = (uint64_t)range.x * sizeof(PackedEmissiveTriangle);
+                const uint64_t rangeSize = (uint64_t)range.y * sizeof(PackedEmissiveTriangle);
+                pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset + rangeOffset, mpTriangleData.get(), rangeOffset, rangeSize);
+                bytesCopied += rangeSize;
+            }
+        }
         offset += mpTriangleData->getSize();
-        if (copyFluxData) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpFluxData.get(), 0, mpFluxData->getSize());
+        if (copyFluxData)
+        {
+            pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpFluxData.get(), 0, mpFluxData->getSize());
+            bytesCopied += mpFluxData->getSize();
+        }
         offset += mpFluxData->getSize();
         FALCOR_ASSERT(offset == stagingSize);
 
+        mCPUSyncStats.bytesTransferred += bytesCopied;
+        mCPUSyncStats.totalBytesTransferred += bytesCopied;
+
         // Submit command list and insert signal.
         pRenderContext->flush(false);
         mpStagingFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
@@ -668,36 +751,61 @@ namespace Falcor
         FALCOR_ASSERT(offset <= mpStagingBuffer->getSize());
 
         bool updateTriangleData = is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData);
+        bool updateTriangleRanges = !updateTriangleData && is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleDataRanges);
         bool updateFluxData = is_set(mCPUInvalidData, CPUOutOfDateFlags::FluxData);
 
         FALCOR_ASSERT(mTriangleCount > 0);
         FALCOR_ASSERT(mMeshLightTriangles.size() == (size_t)mTriangleCount);
-        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
-        {
-            const auto tri = triangleData[triIdx].unpack();
-            auto& meshLightTri = mMeshLightTriangles[triIdx];
 
-            if (updateTriangleData)
+        // Unpack a range of triangles in parallel. Each triangle is written independently, which allows vectorization.
+        auto unpackTriangles = [&](uint32_t first, uint32_t count, bool unpackTriangleData, bool unpackFluxData)
+        {
+            auto range = NumericRange<uint32_t>(first, first + count);
+            std::for_each(std::execution::par_unseq, range.begin(), range.end(), [&](uint32_t triIdx)
             {
-                meshLightTri.lightIdx = tri.lightIdx;
-                meshLightTri.normal = tri.normal;
-                meshLightTri.area = tri.area;
+                auto& meshLightTri = mMeshLightTriangles[triIdx];
 
-                for (uint32_t j = 0; j < 3; j++)
+                if (unpackTriangleData)
                 {
-                    meshLightTri.vtx[j].pos = tri.posW[j];
-                    meshLightTri.vtx[j].uv = tri.texCoords[j];
+                    const auto tri = triangleData[triIdx].unpack();
+                    meshLightTri.lightIdx = tri.lightIdx;
+                    meshLightTri.normal = tri.normal;
+                    meshLightTri.area = tri.area;
+
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        meshLightTri.vtx[j].pos = tri.posW[j];
+                        meshLightTri.vtx[j].uv = tri.texCoords[j];
+                    }
                 }
-            }
 
-            if (updateFluxData)
+                if (unpackFluxData)
+                {
+                    meshLightTri.flux = fluxData[triIdx].flux;
+                    meshLightTri.averageRadiance = fluxData[triIdx].averageRadiance;
+                }
+            });
+        };
+
+        if (updateTriangleData || updateFluxData)
+        {
+            unpackTriangles(0, mTriangleCount, updateTriangleData, updateFluxData);
+            if (updateTriangleData) mCPUSyncStats.trianglesSynced += mTriangleCount;
+            mCPUSyncStats.fullSyncCount++;
+        }
+
+        if (updateTriangleRanges)
+        {
+            for (const uint2& range : mDirtyTriangleRanges)
             {
-                meshLightTri.flux = fluxData[triIdx].flux;
-                meshLightTri.averageRadiance = fluxData[triIdx].averageRadiance;
+                unpackTriangles(range.x, range.y, true, false);
+                mCPUSyncStats.trianglesSynced += range.y;
             }
+            mCPUSyncStats.partialSyncCount++;
         }
 
         mpStagingBuffer->unmap();
+        mDirtyTriangleRanges.clear();
         mCPUInvalidData = CPUOutOfDateFlags::None;
     }
 
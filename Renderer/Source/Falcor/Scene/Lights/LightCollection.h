@@ -73,6 +73,18 @@ namespace Falcor
             uint32_t trianglesActiveTextured = 0;       ///< Number of active triangles with textured radiance.
         };
 
+        /** Stats for the GPU to CPU transfers done to keep the CPU-side triangle data in sync.
+            The per-frame counters are reset at the start of each call to update().
+        */
+        struct CPUSyncStats
+        {
+            uint64_t bytesTransferred = 0;              ///< Number of bytes copied to the staging buffer this frame.
+            uint32_t trianglesSynced = 0;               ///< Number of triangles unpacked into the CPU-side buffer this frame.
+            uint32_t fullSyncCount = 0;                 ///< Number of syncs this frame that transferred all triangle data.
+            uint32_t partialSyncCount = 0;              ///< Number of syncs this frame that transferred only the updated triangles.
+            uint64_t totalBytesTransferred = 0;         ///< Number of bytes copied to the staging buffer since creation.
+        };
+
         /** Represents one mesh light triangle vertex.
         */
         struct MeshLightVertex
@@ -156,6 +168,10 @@ namespace Falcor
         */
         void prepareSyncCPUData(RenderContext* pRenderContext) const { copyDataToStagingBuffer(pRenderContext); }
 
+        /** Returns stats on the GPU to CPU data transfers.
+        */
+        const CPUSyncStats& getCPUSyncStats() const { return mCPUSyncStats; }
+
         /** Get the total GPU memory usage in bytes.
         */
         uint64_t getMemoryUsageInBytes() const;
@@ -163,11 +179,12 @@ namespace Falcor
         // Internal update flags. This only public for FALCOR_ENUM_CLASS_OPERATORS() to work.
         enum class CPUOutOfDateFlags : uint32_t
         {
-            None         = 0,
-            TriangleData = 0x1,
-            FluxData     = 0x2,
+            None                = 0,
+            TriangleData        = 0x1,
+            FluxData            = 0x2,
+            TriangleDataRanges  = 0x4,  ///< Only the triangles in mDirtyTriangleRanges are out of date. Superseded by TriangleData.
 
-            All          = TriangleData | FluxData
+            All                 = TriangleData | FluxData
         };
 
     protected:
@@ -186,6 +203,7 @@ namespace Falcor
 
         void copyDataToStagingBuffer(RenderContext* pRenderContext) const;
         void syncCPUData() const;
+        void markTrianglesDirty(const std::vector<uint32_t>& updatedLights);
 
         // Internal state
         std::weak_ptr<Scene>                    mpScene;                ///< Weak pointer to scene (scene owns LightCollection).
@@ -196,9 +214,11 @@ namespace Falcor
         mutable std::vector<MeshLightTriangle>  mMeshLightTriangles;    ///< List of all pre-processed mesh light triangles.
         mutable std::vector<uint32_t>           mActiveTriangleList;    ///< List of active (non-culled) emissive triangles.
         mutable std::vector<uint32_t>           mTriToActiveList;       ///< Mapping of all light triangles to index in mActiveTriangleList.
+        mutable std::vector<uint2>              mDirtyTriangleRanges;   ///< Ranges (offset, count) of triangles that are out of date on the CPU. Only used with CPUOutOfDateFlags::TriangleDataRanges.
 
         mutable MeshLightStats                  mMeshLightStats;        ///< Stats before/after pre-processing of mesh lights. Do not access this directly, use getStats() which ensures the stats are up-to-date.
         mutable bool                            mStatsValid = false;    ///< True when stats are valid.
+        mutable CPUSyncStats                    mCPUSyncStats;          ///< Stats on the GPU to CPU data transfers.
 
         // GPU resources for the mesh lights and emissive triangles.
         Buffer::SharedPtr                       mpTriangleData;         ///< Per-triangle geometry data for emissive triangles (mTriangleCount elements).
@@ -0,0 +1,762 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "MikkTSpaceGenerator.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Algorithm/ParallelAlgorithms.h"
+#include <mikktspace.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <execution>
+#include <limits>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        using MeshData = MikkTSpaceGenerator::MeshData;
+
+        const uint32_t kInvalidIndex = 0xffffffff;
+
+        // Constants of the reference implementation.
+        const int32_t kGridCellCount = 2048;
+        const uint32_t kSortSeed = 39871946;
+        const float kAngularThreshold = 180.f;
+
+        const uint32_t kGroupWithAny = 0x1;         ///< The triangle has no usable texture space and can join any group.
+        const uint32_t kOrientPreserving = 0x2;     ///< The texture space of the triangle has positive orientation.
+
+        // Vector math that does the operations in the same order as the reference implementation.
+        // The results must be bit-identical, which is why the glm functions aren't used.
+
+        float3 vscale(float s, const float3& v) { return float3(s * v.x, s * v.y, s * v.z); }
+        float vdot(const float3& a, const float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        float vlength(const float3& v) { return std::sqrt(vdot(v, v)); }
+        float3 vnormalize(const float3& v) { return vscale(1.f / vlength(v), v); }
+        bool vequal(const float3& a, const float3& b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+        bool notZero(float x) { return std::fabs(x) > FLT_MIN; }
+        bool notZero(const float3& v) { return notZero(v.x) || notZero(v.y) || notZero(v.z); }
+
+        /** Project a vector onto the plane with the given normal and normalize it, unless the result is zero.
+        */
+        float3 projectToPlane(const float3& n, const float3& v)
+        {
+            float3 r = v - vscale(vdot(n, v), n);
+            return notZero(r) ? vnormalize(r) : r;
+        }
+
+        /** Grid cell of a coordinate along the bucketing axis.
+            The float to int conversion mimics x64, which converts NaN and out-of-range values to INT_MIN, i.e. to cell 0.
+        */
+        int32_t findGridCell(float minValue, float maxValue, float value)
+        {
+            const float index = (float)kGridCellCount * ((value - minValue) / (maxValue - minValue));
+            if (!(index >= 0.f && index < 2147483648.f)) return 0;
+            return std::min((int32_t)index, kGridCellCount - 1);
+        }
+
+        struct TmpVertex
+        {
+            float3 position;
+            uint32_t corner;
+        };
+
+        /** Weld the corners of one grid cell. This follows MergeVertsFast() of the reference exactly.
+            The vertices are split recursively at the center of the largest extent. In the leaves, each corner
+            is welded to the first preceding corner that has the same position, normal and texture coordinate.
+        */
+        void mergeVertices(const MeshData& mesh, TmpVertex* pVerts, int32_t left, int32_t right, uint32_t* pReps)
+        {
+            float3 minPos = pVerts[left].position;
+            float3 maxPos = minPos;
+            for (int32_t l = left + 1; l <= right; l++)
+            {
+                for (int c = 0; c < 3; c++)
+                {
+                    if (minPos[c] > pVerts[l].position[c]) minPos[c] = pVerts[l].position[c];
+                    if (maxPos[c] < pVerts[l].position[c]) maxPos[c] = pVerts[l].position[c];
+                }
+            }
+
+            const float3 dim = maxPos - minPos;
+            int channel = 0;
+            if (dim.y > dim.x && dim.y > dim.z) channel = 1;
+            else if (dim.z > dim.x) channel = 2;
+
+            const float sep = 0.5f * (maxPos[channel] + minPos[channel]);
+            if (!std::isfinite(sep)) return;
+
+            if (sep >= maxPos[channel] || sep <= minPos[channel])
+            {
+                for (int32_t l = left; l <= right; l++)
+                {
+                    const uint32_t i = pVerts[l].corner;
+                    for (int32_t l2 = left; l2 < l; l2++)
+                    {
+                        const uint32_t i2 = pVerts[l2].corner;
+                        if (vequal(mesh.pPositions[i], mesh.pPositions[i2]) && vequal(mesh.pNormals[i], mesh.pNormals[i2]) &&
+                            mesh.pTexCrds[i].x == mesh.pTexCrds[i2].x && mesh.pTexCrds[i].y == mesh.pTexCrds[i2].y)
+                        {
+                            pReps[i] = pReps[i2];
+                            break;
+                        }
+                    }
+                }
+                return;
+            }
+
+            int32_t l = left;
+            int32_t r = right;
+            while (l < r)
+            {
+                bool readyLeft = false;
+                bool readyRight = false;
+                while (!readyLeft && l < r)
+                {
+                    readyLeft = !(pVerts[l].position[channel] < sep);
+                    if (!readyLeft) l++;
+                }
+                while (!readyRight && l < r)
+                {
+                    readyRight = pVerts[r].position[channel] < sep;
+                    if (!readyRight) r--;
+                }
+                if (readyLeft && readyRight)
+                {
+                    std::swap(pVerts[l], pVerts[r]);
+                    l++;
+                    r--;
+                }
+            }
+
+            if (l == r)
+            {
+                if (pVerts[r].position[channel] < sep) l++;
+                else r--;
+            }
+
+            if (left < r) mergeVertices(mesh, pVerts, left, r, pReps);
+            if (l < right) mergeVertices(mesh, pVerts, l, right, pReps);
+        }
+
+        /** Find the representative of each corner, i.e. the corner it is welded to. This is GenerateSharedVerticesIndexList() of the reference.
+            The reference buckets the corners into a grid along the axis of largest extent and welds each cell separately.
+            The results depend on the order of the corners in a cell. We sort by cell and corner index, which gives the
+            same order as the reference's hash table, and process the cells in parallel.
+        */
+        std::vector<uint32_t> weldCorners(const MeshData& mesh)
+        {
+            const uint32_t cornerCount = 3 * mesh.faceCount;
+            std::vector<uint32_t> reps(cornerCount);
+            std::iota(reps.begin(), reps.end(), 0u);
+
+            // Compute the bounds, seeded with the first corner. NaNs are skipped like in the reference.
+            struct Bounds
+            {
+                float3 minPos;
+                float3 maxPos;
+            };
+            const float kInf = std::numeric_limits<float>::infinity();
+            auto range = NumericRange<uint32_t>(1, cornerCount);
+            Bounds bounds = std::transform_reduce(std::execution::par, range.begin(), range.end(), Bounds{ float3(kInf), float3(-kInf) },
+                [](const Bounds& a, const Bounds& b) { return Bounds{ glm::min(a.minPos, b.minPos), glm::max(a.maxPos, b.maxPos) }; },
+                [&](uint32_t i)
+                {
+                    Bounds b;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        float x = mesh.pPositions[i][c];
+                        b.minPos[c] = std::isnan(x) ? kInf : x;
+                        b.maxPos[c] = std::isnan(x) ? -kInf : x;
+                    }
+                    return b;
+                });
+
+            float3 minPos = mesh.pPositions[0];
+            float3 maxPos = minPos;
+            for (int c = 0; c < 3; c++)
+            {
+                if (minPos[c] > bounds.minPos[c]) minPos[c] = bounds.minPos[c];
+                if (maxPos[c] < bounds.maxPos[c]) maxPos[c] = bounds.maxPos[c];
+            }
+
+            const float3 dim = maxPos - minPos;
+            int channel = 0;
+            if (dim.y > dim.x && dim.y > dim.z) channel = 1;
+            else if (dim.z > dim.x) channel = 2;
+
+            // Sort the corners by grid cell. The sort is stable, so the corners in each cell stay in order.
+            std::vector<uint32_t> cells(cornerCount);
+            std::vector<uint32_t> corners(cornerCount);
+            auto cornerRange = NumericRange<uint32_t>(0, cornerCount);
+            std::for_each(std::execution::par, cornerRange.begin(), cornerRange.end(), [&](uint32_t i)
+            {
+                cells[i] = (uint32_t)findGridCell(minPos[channel], maxPos[channel], mesh.pPositions[i][channel]);
+                corners[i] = i;
+            });
+            parallelRadixSort(cells.data(), corners.data(), cornerCount);
+
+            std::vector<uint32_t> cellOffsets(kGridCellCount + 1);
+            for (uint32_t k = 0; k <= (uint32_t)kGridCellCount; k++)
+            {
+                cellOffsets[k] = (uint32_t)(std::lower_bound(cells.begin(), cells.end(), k) - cells.begin());
+            }
+
+            auto cellRange = NumericRange<uint32_t>(0, kGridCellCount);
+            std::for_each(std::execution::par, cellRange.begin(), cellRange.end(), [&](uint32_t k)
+            {
+                const uint32_t count = cellOffsets[k + 1] - cellOffsets[k];
+                if (count < 2) return;
+
+                std::vector<TmpVertex> verts(count);
+                for (uint32_t e = 0; e < count; e++)
+                {
+                    const uint32_t i = corners[cellOffsets[k] + e];
+                    verts[e] = { mesh.pPositions[i], i };
+                }
+                mergeVertices(mesh, verts.data(), 0, (int32_t)count - 1, reps.data());
+            });
+
+            return reps;
+        }
+
+        struct TriInfo
+        {
+            int32_t neighbors[3] = { -1, -1, -1 };  ///< Neighboring triangle across the edge starting at each corner, or -1.
+            float3 os = float3(0.f);                ///< Normalized derivative of the position w.r.t. the first texture coordinate.
+            float3 ot = float3(0.f);                ///< Normalized derivative of the position w.r.t. the second texture coordinate.
+            uint32_t flags = 0;
+        };
+
+        /** Compute the texture space of a triangle. This is InitTriInfo() of the reference.
+        */
+        void initTriInfo(const MeshData& mesh, const uint32_t* pCorners, TriInfo& tri)
+        {
+            const float3 v1 = mesh.pPositions[pCorners[0]];
+            const float3 v2 = mesh.pPositions[pCorners[1]];
+            const float3 v3 = mesh.pPositions[pCorners[2]];
+            const float2 t1 = mesh.pTexCrds[pCorners[0]];
+            const float2 t2 = mesh.pTexCrds[pCorners[1]];
+            const float2 t3 = mesh.pTexCrds[pCorners[2]];
+
+            const float t21x = t2.x - t1.x;
+            const float t21y = t2.y - t1.y;
+            const float t31x = t3.x - t1.x;
+            const float t31y = t3.y - t1.y;
+            const float3 d1 = v2 - v1;
+            const float3 d2 = v3 - v1;
+
+            const float signedAreaSTx2 = t21x * t31y - t21y * t31x;
+            const float3 os = vscale(t31y, d1) - vscale(t21y, d2);
+            const float3 ot = vscale(-t31x, d1) + vscale(t21x, d2);
+
+            tri.flags = kGroupWithAny | (signedAreaSTx2 > 0 ? kOrientPreserving : 0);
+            if (notZero(signedAreaSTx2))
+            {
+                const float absArea = std::fabs(signedAreaSTx2);
+                const float lenOs = vlength(os);
+                const float lenOt = vlength(ot);
+                const float s = (tri.flags & kOrientPreserving) ? 1.f : -1.f;
+                if (notZero(lenOs)) tri.os = vscale(s / lenOs, os);
+                if (notZero(lenOt)) tri.ot = vscale(s / lenOt, ot);
+                if (notZero(lenOs / absArea) && notZero(lenOt / absArea)) tri.flags &= ~kGroupWithAny;
+            }
+        }
+
+        /** Find the edge of a triangle with the given vertices. This is GetEdge() of the reference.
+            \return Edge number. The vertices are returned in the winding order of the triangle.
+        */
+        uint32_t getEdge(const uint32_t* pVerts, uint32_t i0, uint32_t i1, uint32_t& out0, uint32_t& out1)
+        {
+            if (pVerts[0] == i0 || pVerts[0] == i1)
+            {
+                if (pVerts[1] == i0 || pVerts[1] == i1)
+                {
+                    out0 = pVerts[0];
+                    out1 = pVerts[1];
+                    return 0;
+                }
+                out0 = pVerts[2];
+                out1 = pVerts[0];
+                return 2;
+            }
+            out0 = pVerts[1];
+            out1 = pVerts[2];
+            return 1;
+        }
+
+        using KeyedEdge = std::pair<uint32_t, uint32_t>; // Key and edge index.
+
+        /** Replay the quicksort of the reference (QuickSortEdges()) on the edges with the largest key.
+            Only the subranges that contain the largest key are sorted, which is enough to find the order
+            the reference leaves these edges in.
+        */
+        void quickSortLargestKey(KeyedEdge* pEdges, int64_t left, int64_t right, uint32_t maxKey, uint32_t seed)
+        {
+            const int64_t count = right - left + 1;
+            if (count < 2) return;
+            if (count == 2)
+            {
+                if (pEdges[left].first > pEdges[right].first) std::swap(pEdges[left], pEdges[right]);
+                return;
+            }
+
+            uint32_t t = seed & 31;
+            t = (seed << t) | (seed >> ((32 - t) & 31));
+            seed = seed + t + 3;
+
+            const uint32_t pivot = pEdges[left + (int64_t)(seed % (uint32_t)count)].first;
+            int64_t l = left;
+            int64_t r = right;
+            do
+            {
+                while (pEdges[l].first < pivot) l++;
+                while (pEdges[r].first > pivot) r--;
+                if (l <= r)
+                {
+                    std::swap(pEdges[l], pEdges[r]);
+                    l++;
+                    r--;
+                }
+            } while (l <= r);
+
+            // The right part holds the keys >= pivot, so it contains all edges with the largest key unless the pivot is the largest key.
+            if (pivot == maxKey && left < r && std::any_of(pEdges + left, pEdges + r + 1, [maxKey](const KeyedEdge& e) { return e.first == maxKey; }))
+            {
+                quickSortLargestKey(pEdges, left, r, maxKey, seed);
+            }
+            if (l < right) quickSortLargestKey(pEdges, l, right, maxKey, seed);
+        }
+
+        /** Find the neighbors of the triangles. This is BuildNeighborsFast() of the reference.
+            The reference sorts the edges by their vertices and triangle index, and then pairs up oppositely
+            oriented edges greedily within each run of edges with the same vertices. Due to how the sort passes
+            are set up, it doesn't sort the edges of the largest first vertex beyond the first pass. We sort
+            the edges in parallel, replay the reference for the last group, and pair up the runs in parallel.
+        */
+        void buildNeighbors(const std::vector<uint32_t>& triReps, std::vector<TriInfo>& tris)
+        {
+            struct Edge
+            {
+                uint32_t i0;
+                uint32_t i1;
+                uint32_t tri;
+            };
+
+            const uint32_t edgeCount = (uint32_t)triReps.size();
+            if (edgeCount == 0) return;
+
+            std::vector<Edge> edges(edgeCount);
+            std::vector<uint64_t> keys(edgeCount);
+            std::vector<uint32_t> order(edgeCount);
+            auto edgeRange = NumericRange<uint32_t>(0, edgeCount);
+            std::for_each(std::execution::par, edgeRange.begin(), edgeRange.end(), [&](uint32_t e)
+            {
+                const uint32_t a = triReps[e];
+                const uint32_t b = triReps[e % 3 < 2 ? e + 1 : e - 2];
+                edges[e] = { std::min(a, b), std::max(a, b), e / 3 };
+                keys[e] = ((uint64_t)edges[e].i0 << 32) | edges[e].i1;
+                order[e] = e;
+            });
+
+            // Sort by vertices. The sort is stable, so edges with the same vertices stay sorted by triangle.
+            parallelRadixSort(keys.data(), order.data(), edgeCount);
+
+            // Fix up the order of the last group.
+            const uint32_t maxKey = edges[order.back()].i0;
+            uint32_t groupStart = edgeCount;
+            while (groupStart > 0 && edges[order[groupStart - 1]].i0 == maxKey) groupStart--;
+            if (edgeCount - groupStart > 2)
+            {
+                std::vector<KeyedEdge> keyedEdges(edgeCount);
+                for (uint32_t e = 0; e < edgeCount; e++) keyedEdges[e] = { edges[e].i0, e };
+                quickSortLargestKey(keyedEdges.data(), 0, (int64_t)edgeCount - 1, maxKey, kSortSeed);
+
+                uint32_t k = groupStart;
+                for (const auto& e : keyedEdges)
+                {
+                    if (e.first == maxKey) order[k++] = e.second;
+                }
+
+                // Runs with the same second vertex are sorted by triangle, except for the last one.
+                uint32_t runStart = groupStart;
+                for (uint32_t i = groupStart + 1; i < edgeCount; i++)
+                {
+                    if (edges[order[i]].i1 != edges[order[runStart]].i1)
+                    {
+                        std::sort(order.begin() + runStart, order.begin() + i, [&](uint32_t a, uint32_t b) { return edges[a].tri < edges[b].tri; });
+                        runStart = i;
+                    }
+                }
+            }
+
+            // Pair up the edges within each run of edges with the same vertices.
+            std::vector<uint32_t> runOffsets;
+            for (uint32_t i = 0; i < edgeCount; i++)
+            {
+                if (i == 0 || edges[order[i]].i0 != edges[order[i - 1]].i0 || edges[order[i]].i1 != edges[order[i - 1]].i1) runOffsets.push_back(i);
+            }
+            runOffsets.push_back(edgeCount);
+
+            auto runRange = NumericRange<size_t>(0, runOffsets.size() - 1);
+            std::for_each(std::execution::par, runRange.begin(), runRange.end(), [&](size_t run)
+            {
+                const uint32_t end = runOffsets[run + 1];
+                for (uint32_t i = runOffsets[run]; i + 1 < end; i++)
+                {
+                    const Edge& a = edges[order[i]];
+                    uint32_t a0, a1;
+                    const uint32_t edgeA = getEdge(&triReps[3 * a.tri], a.i0, a.i1, a0, a1);
+                    if (tris[a.tri].neighbors[edgeA] != -1) continue;
+
+                    for (uint32_t j = i + 1; j < end; j++)
+                    {
+                        const Edge& b = edges[order[j]];
+                        uint32_t b0, b1;
+                        const uint32_t edgeB = getEdge(&triReps[3 * b.tri], b.i0, b.i1, b1, b0);
+                        if (a0 == b0 && a1 == b1 && tris[b.tri].neighbors[edgeB] == -1)
+                        {
+                            tris[a.tri].neighbors[edgeA] = (int32_t)b.tri;
+                            tris[b.tri].neighbors[edgeB] = (int32_t)a.tri;
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+
+        /** Assign a corner and all corners around the same vertex that can be reached across edges to a new group.
+            This is the group creation of Build4RuleGroups() and AssignRecur() of the reference.
+            A triangle is only added if its orientation matches. Triangles with the kGroupWithAny flag take the
+            orientation of the first group that reaches them, if none of their corners is assigned yet.
+            The group is identified by its first corner.
+        */
+        void assignGroup(uint32_t seed, const std::vector<uint32_t>& triReps, std::vector<TriInfo>& tris, std::vector<uint32_t>& cornerGroups, std::vector<uint32_t>& stack)
+        {
+            const uint32_t rep = triReps[seed];
+            const bool orient = (tris[seed / 3].flags & kOrientPreserving) != 0;
+
+            auto pushNeighbors = [&](uint32_t corner)
+            {
+                const uint32_t i = corner % 3;
+                const TriInfo& tri = tris[corner / 3];
+                if (tri.neighbors[i] >= 0) stack.push_back((uint32_t)tri.neighbors[i]);
+                if (tri.neighbors[i > 0 ? i - 1 : 2] >= 0) stack.push_back((uint32_t)tri.neighbors[i > 0 ? i - 1 : 2]);
+            };
+
+            cornerGroups[seed] = seed;
+            stack.clear();
+            pushNeighbors(seed);
+
+            while (!stack.empty())
+            {
+                const uint32_t t = stack.back();
+                stack.pop_back();
+
+                const uint32_t* pVerts = &triReps[3 * t];
+                const uint32_t corner = 3 * t + (pVerts[0] == rep ? 0 : (pVerts[1] == rep ? 1 : 2));
+                if (cornerGroups[corner] != kInvalidIndex) continue;
+
+                TriInfo& tri = tris[t];
+                if ((tri.flags & kGroupWithAny) && cornerGroups[3 * t] == kInvalidIndex && cornerGroups[3 * t + 1] == kInvalidIndex && cornerGroups[3 * t + 2] == kInvalidIndex)
+                {
+                    tri.flags = (tri.flags & ~kOrientPreserving) | (orient ? kOrientPreserving : 0);
+                }
+                if (((tri.flags & kOrientPreserving) != 0) != orient) continue;
+
+                cornerGroups[corner] = seed;
+                pushNeighbors(corner);
+            }
+        }
+
+        /** Compute the tangent of a subgroup. This is EvalTspace() of the reference, restricted to the tangent.
+            \param[in] members Indices of the subgroup's corners into groupCorners, sorted by triangle.
+        */
+        float3 evalTangent(const MeshData& mesh, const std::vector<uint32_t>& triReps, const std::vector<TriInfo>& tris, const uint32_t* pGroupCorners,
+            const std::vector<float3>& groupOs, const std::vector<uint32_t>& members, const float3& n)
+        {
+            float3 os(0.f);
+            for (uint32_t m : members)
+            {
+                const uint32_t corner = pGroupCorners[m];
+                const uint32_t t = corner / 3;
+                const uint32_t i = corner % 3;
+                if (tris[t].flags & kGroupWithAny) continue;
+
+                const float3 p0 = mesh.pPositions[triReps[3 * t + (i > 0 ? i - 1 : 2)]];
+                const float3 p1 = mesh.pPositions[triReps[corner]];
+                const float3 p2 = mesh.pPositions[triReps[3 * t + (i < 2 ? i + 1 : 0)]];
+                const float3 v1 = projectToPlane(n, p0 - p1);
+                const float3 v2 = projectToPlane(n, p2 - p1);
+
+                float cosAngle = vdot(v1, v2);
+                cosAngle = cosAngle > 1.f ? 1.f : (cosAngle < -1.f ? -1.f : cosAngle);
+                const float angle = (float)std::acos((double)cosAngle);
+
+                os = os + vscale(angle, groupOs[m]);
+            }
+            return notZero(os) ? vnormalize(os) : os;
+        }
+    }
+
+    bool MikkTSpaceGenerator::generateTangents(const MeshData& mesh, float4* pTangents)
+    {
+        checkArgument(mesh.pPositions && mesh.pNormals && mesh.pTexCrds, "'mesh' must have positions, normals and texture coordinates.");
+        checkArgument(pTangents != nullptr, "'pTangents' must not be nullptr.");
+        checkArgument(mesh.faceCount <= kInvalidIndex / 3, "'mesh' has too many faces ({}).", mesh.faceCount);
+        if (mesh.faceCount == 0) return false;
+
+        const uint32_t cornerCount = 3 * mesh.faceCount;
+
+        // Weld identical corners to vertices.
+        const std::vector<uint32_t> reps = weldCorners(mesh);
+
+        // Move the degenerate triangles to the end, keeping the others in order.
+        std::vector<uint32_t> faces(mesh.faceCount);
+        std::iota(faces.begin(), faces.end(), 0u);
+        const uint32_t triCount = (uint32_t)parallelPartition(faces.data(), faces.size(), [&](uint32_t f)
+        {
+            const float3& p0 = mesh.pPositions[reps[3 * f]];
+            const float3& p1 = mesh.pPositions[reps[3 * f + 1]];
+            const float3& p2 = mesh.pPositions[reps[3 * f + 2]];
+            return !(vequal(p0, p1) || vequal(p0, p2) || vequal(p1, p2));
+        });
+
+        // Setup the non-degenerate triangles.
+        std::vector<uint32_t> triReps(3 * triCount);
+        std::vector<TriInfo> tris(triCount);
+        auto triRange = NumericRange<uint32_t>(0, triCount);
+        std::for_each(std::execution::par, triRange.begin(), triRange.end(), [&](uint32_t t)
+        {
+            for (uint32_t i = 0; i < 3; i++) triReps[3 * t + i] = reps[3 * faces[t] + i];
+            initTriInfo(mesh, &triReps[3 * t], tris[t]);
+        });
+
+        buildNeighbors(triReps, tris);
+
+        // Sort the corners by vertex. The sort is stable, so the corners of each vertex stay in order.
+        std::vector<uint32_t> vertexKeys(triReps);
+        std::vector<uint32_t> vertexCorners(triReps.size());
+        std::iota(vertexCorners.begin(), vertexCorners.end(), 0u);
+        parallelRadixSort(vertexKeys.data(), vertexCorners.data(), vertexKeys.size());
+
+        std::vector<uint32_t> vertexOffsets;
+        for (uint32_t i = 0; i < (uint32_t)vertexKeys.size(); i++)
+        {
+            if (i == 0 || vertexKeys[i] != vertexKeys[i - 1]) vertexOffsets.push_back(i);
+        }
+        vertexOffsets.push_back((uint32_t)vertexKeys.size());
+        const uint32_t vertexCount = (uint32_t)vertexOffsets.size() - 1;
+
+        // Create the groups. Triangles with the kGroupWithAny flag take the orientation of the first group that reaches them,
+        // so the vertices that touch such triangles are processed serially in the order of the reference. The others are independent.
+        std::vector<uint32_t> cornerGroups(triReps.size(), kInvalidIndex);
+        std::vector<uint8_t> vertexIsOrdered(cornerCount, 0); // Indexed by representative corner.
+        ParallelAlgorithms::forEachChunk(vertexCount, ParallelAlgorithms::getChunkCount(vertexCount, 0), [&](uint32_t, size_t chunkBegin, size_t chunkEnd)
+        {
+            std::vector<uint32_t> stack;
+            for (size_t v = chunkBegin; v < chunkEnd; v++)
+            {
+                const uint32_t begin = vertexOffsets[v];
+                const uint32_t end = vertexOffsets[v + 1];
+                bool touchesAny = false;
+                for (uint32_t i = begin; i < end && !touchesAny; i++) touchesAny = (tris[vertexCorners[i] / 3].flags & kGroupWithAny) != 0;
+
+                if (touchesAny)
+                {
+                    vertexIsOrdered[vertexKeys[begin]] = 1;
+                    continue;
+                }
+
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    if (cornerGroups[vertexCorners[i]] == kInvalidIndex) assignGroup(vertexCorners[i], triReps, tris, cornerGroups, stack);
+                }
+            }
+        });
+
+        {
+            std::vector<uint32_t> stack;
+            for (uint32_t c = 0; c < (uint32_t)triReps.size(); c++)
+            {
+                if (vertexIsOrdered[triReps[c]] && !(tris[c / 3].flags & kGroupWithAny) && cornerGroups[c] == kInvalidIndex)
+                {
+                    assignGroup(c, triReps, tris, cornerGroups, stack);
+                }
+            }
+        }
+
+        // Sort the corners by group. The sort is stable, so the corners of each group stay sorted by triangle.
+        std::vector<uint32_t> groupKeys(cornerGroups);
+        std::vector<uint32_t> groupCorners(cornerGroups.size());
+        std::iota(groupCorners.begin(), groupCorners.end(), 0u);
+        parallelRadixSort(groupKeys.data(), groupCorners.data(), groupKeys.size());
+
+        std::vector<uint32_t> groupOffsets;
+        for (uint32_t i = 0; i < (uint32_t)groupKeys.size() && groupKeys[i] != kInvalidIndex; i++)
+        {
+            if (i == 0 || groupKeys[i] != groupKeys[i - 1]) groupOffsets.push_back(i);
+        }
+        groupOffsets.push_back(groupOffsets.empty() ? 0 : (uint32_t)(std::lower_bound(groupKeys.begin(), groupKeys.end(), kInvalidIndex) - groupKeys.begin()));
+        const uint32_t groupCount = (uint32_t)groupOffsets.size() - 1;
+
+        // Compute the tangents of each group. This is GenerateTSpaces() of the reference. Each corner gets the tangent of the
+        // subgroup of triangles whose texture spaces are within the angular threshold of its own. With the default threshold
+        // of 180 degrees, these are all the triangles of the group, except for ones whose texture space is exactly opposite.
+        const float thresCos = (float)std::cos((double)((kAngularThreshold * (float)M_PI) / 180.f));
+        std::vector<float3> cornerTangents(cornerCount, float3(1.f, 0.f, 0.f));
+        std::vector<uint8_t> cornerOrients(cornerCount, 0);
+
+        ParallelAlgorithms::forEachChunk(groupCount, ParallelAlgorithms::getChunkCount(groupCount, 0), [&](uint32_t, size_t chunkBegin, size_t chunkEnd)
+        {
+            std::vector<float3> groupOs;
+            std::vector<float3> groupOt;
+            std::vector<uint32_t> members;
+            std::vector<uint32_t> subgroupMembers;     // Members of all subgroups, concatenated.
+            std::vector<uint32_t> subgroupOffsets;
+            std::vector<float3> subgroupTangents;
+
+            for (size_t g = chunkBegin; g < chunkEnd; g++)
+            {
+                const uint32_t* pGroupCorners = &groupCorners[groupOffsets[g]];
+                const uint32_t count = groupOffsets[g + 1] - groupOffsets[g];
+                const uint32_t seed = groupKeys[groupOffsets[g]];
+                const float3 n = mesh.pNormals[triReps[seed]];
+                const bool orient = (tris[seed / 3].flags & kOrientPreserving) != 0;
+
+                groupOs.resize(count);
+                groupOt.resize(count);
+                for (uint32_t m = 0; m < count; m++)
+                {
+                    const TriInfo& tri = tris[pGroupCorners[m] / 3];
+                    groupOs[m] = projectToPlane(n, tri.os);
+                    groupOt[m] = projectToPlane(n, tri.ot);
+                }
+
+                subgroupMembers.clear();
+                subgroupOffsets.assign(1, 0);
+                subgroupTangents.clear();
+                for (uint32_t m = 0; m < count; m++)
+                {
+                    const uint32_t flags = tris[pGroupCorners[m] / 3].flags;
+                    members.clear();
+                    for (uint32_t m2 = 0; m2 < count; m2++)
+                    {
+                        const bool any = ((flags | tris[pGroupCorners[m2] / 3].flags) & kGroupWithAny) != 0;
+                        const float cosS = vdot(groupOs[m], groupOs[m2]);
+                        const float cosT = vdot(groupOt[m], groupOt[m2]);
+                        if (any || m == m2 || (cosS > thresCos && cosT > thresCos)) members.push_back(m2);
+                    }
+
+                    // Reuse the tangent of an identical subgroup.
+                    size_t s = 0;
+                    for (; s < subgroupTangents.size(); s++)
+                    {
+                        const uint32_t* pBegin = subgroupMembers.data() + subgroupOffsets[s];
+                        const uint32_t* pEnd = subgroupMembers.data() + subgroupOffsets[s + 1];
+                        if (std::equal(pBegin, pEnd, members.begin(), members.end())) break;
+                    }
+                    if (s == subgroupTangents.size())
+                    {
+                        subgroupMembers.insert(subgroupMembers.end(), members.begin(), members.end());
+                        subgroupOffsets.push_back((uint32_t)subgroupMembers.size());
+                        subgroupTangents.push_back(evalTangent(mesh, triReps, tris, pGroupCorners, groupOs, members, n));
+                    }
+
+                    const uint32_t corner = pGroupCorners[m];
+                    const uint32_t outCorner = 3 * faces[corner / 3] + corner % 3;
+                    cornerTangents[outCorner] = subgroupTangents[s];
+                    cornerOrients[outCorner] = orient ? 1 : 0;
+                }
+            }
+        });
+
+        // Degenerate triangles take the tangent of the first corner of a non-degenerate triangle at the same vertex (DegenEpilogue() of the reference).
+        std::vector<uint32_t> firstCorners(cornerCount, kInvalidIndex); // Indexed by representative corner.
+        auto vertexRange = NumericRange<uint32_t>(0, vertexCount);
+        std::for_each(std::execution::par, vertexRange.begin(), vertexRange.end(), [&](uint32_t v)
+        {
+            const uint32_t corner = vertexCorners[vertexOffsets[v]];
+            firstCorners[vertexKeys[vertexOffsets[v]]] = 3 * faces[corner / 3] + corner % 3;
+        });
+
+        auto degenerateRange = NumericRange<uint32_t>(triCount, mesh.faceCount);
+        std::for_each(std::execution::par, degenerateRange.begin(), degenerateRange.end(), [&](uint32_t t)
+        {
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const uint32_t corner = 3 * faces[t] + i;
+                const uint32_t src = firstCorners[reps[corner]];
+                if (src == kInvalidIndex) continue;
+                cornerTangents[corner] = cornerTangents[src];
+                cornerOrients[corner] = cornerOrients[src];
+            }
+        });
+
+        auto cornerRange = NumericRange<uint32_t>(0, cornerCount);
+        std::for_each(std::execution::par, cornerRange.begin(), cornerRange.end(), [&](uint32_t c)
+        {
+            pTangents[c] = float4(glm::normalize(cornerTangents[c]), cornerOrients[c] ? 1.f : -1.f);
+        });
+
+        return true;
+    }
+
+    bool MikkTSpaceGenerator::generateTangentsReference(const MeshData& mesh, float4* pTangents)
+    {
+        checkArgument(mesh.pPositions && mesh.pNormals && mesh.pTexCrds, "'mesh' must have positions, normals and texture coordinates.");
+        checkArgument(pTangents != nullptr, "'pTangents' must not be nullptr.");
+
+        struct Context
+        {
+            const MeshData& mesh;
+            float4* pTangents;
+        };
+
+        SMikkTSpaceInterface mikktspace = {};
+        mikktspace.m_getNumFaces = [](const SMikkTSpaceContext* pContext) { return (int32_t)((Context*)(pContext->m_pUserData))->mesh.faceCount; };
+        mikktspace.m_getNumVerticesOfFace = [](const SMikkTSpaceContext* pContext, int32_t face) { return 3; };
+        mikktspace.m_getPosition = [](const SMikkTSpaceContext* pContext, float position[], int32_t face, int32_t vert) { *reinterpret_cast<float3*>(position) = ((Context*)(pContext->m_pUserData))->mesh.pPositions[face * 3 + vert]; };
+        mikktspace.m_getNormal = [](const SMikkTSpaceContext* pContext, float normal[], int32_t face, int32_t vert) { *reinterpret_cast<float3*>(normal) = ((Context*)(pContext->m_pUserData))->mesh.pNormals[face * 3 + vert]; };
+        mikktspace.m_getTexCoord = [](const SMikkTSpaceContext* pContext, float texCrd[], int32_t face, int32_t vert) { *reinterpret_cast<float2*>(texCrd) = ((Context*)(pContext->m_pUserData))->mesh.pTexCrds[face * 3 + vert]; };
+        mikktspace.m_setTSpaceBasic = [](const SMikkTSpaceContext* pContext, const float tangent[], float sign, int32_t face, int32_t vert)
+        {
+            float3 T = *reinterpret_cast<const float3*>(tangent);
+            ((Context*)(pContext->m_pUserData))->pTangents[face * 3 + vert] = float4(glm::normalize(T), sign);
+        };
+
+        Context userData = { mesh, pTangents };
+        SMikkTSpaceContext context = {};
+        context.m_pInterface = &mikktspace;
+        context.m_pUserData = &userData;
+
+        return genTangSpaceDefault(&context) != 0;
+    }
+}
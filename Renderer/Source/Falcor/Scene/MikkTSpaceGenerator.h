@@ -0,0 +1,74 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Framework.h"
+#include "Utils/Math/Vector.h"
+
+namespace Falcor
+{
+    /** Tangent space generation with the MikkTSpace algorithm.
+
+        The mesh is given as face-varying attribute arrays (one array per attribute) with three
+        elements per triangle, where element 3 * face + vert holds the attribute of the given
+        corner. The output tangent of each corner is float4(T, sign), where the bitangent is
+        sign * cross(N, T). This is the convention of the scene's vertex data.
+
+        generateTangents() is a parallel implementation that produces results bit-identical to
+        genTangSpaceDefault() of the MikkTSpace library. It runs the same algorithm, but does the
+        per-vertex and per-triangle work in parallel, and replaces the library's sequential
+        quicksorts by sorts that preserve the order they produce. The library version is
+        available as generateTangentsReference() for validation and benchmarks.
+    */
+    class FALCOR_API MikkTSpaceGenerator
+    {
+    public:
+        /** Face-varying mesh data. Each array has 3 * faceCount elements.
+        */
+        struct MeshData
+        {
+            uint32_t faceCount = 0;
+            const float3* pPositions = nullptr;
+            const float3* pNormals = nullptr;
+            const float2* pTexCrds = nullptr;
+        };
+
+        /** Generate tangents in parallel.
+            \param[in] mesh Mesh data.
+            \param[out] pTangents Tangent of each corner, 3 * faceCount elements.
+            \return True if successful, false if the mesh has no faces.
+        */
+        static bool generateTangents(const MeshData& mesh, float4* pTangents);
+
+        /** Generate tangents with the MikkTSpace library.
+            \param[in] mesh Mesh data.
+            \param[out] pTangents Tangent of each corner, 3 * faceCount elements.
+            \return True if successful, false if the library failed.
+        */
+        static bool generateTangentsReference(const MeshData& mesh, float4* pTangents);
+    };
+}
@@ -0,0 +1,597 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "SDF3DPrimitiveEvaluator.h"
+#include <execution>
+#include <atomic>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Margin used when comparing intervals, as the interval arithmetic below is not rounded outwards.
+        const float kIntervalMargin = 1e-5f;
+
+        float saturate(float x)
+        {
+            return glm::clamp(x, 0.0f, 1.0f);
+        }
+
+        /** Transforms a point into the local space of a primitive.
+            The matrix is read as row-major by the shaders, so mul(invRotationScale, p) in SDF3DPrimitive.slang corresponds to p * invRotationScale here.
+        */
+        float3 toLocal(const SDF3DPrimitive& primitive, const float3& p)
+        {
+            return (p - primitive.translation) * primitive.invRotationScale;
+        }
+
+        // Host versions of the shapes in Utils/SDF/SDF3DShapes.slang.
+
+        float sdfSphere(const float3& p, float r)
+        {
+            return glm::length(p) - r;
+        }
+
+        float sdfEllipsoid(const float3& p, const float3& r)
+        {
+            float k0 = glm::length(p / r);
+            float k1 = glm::length(p / (r * r));
+            return k0 * (k0 - 1.0f) / k1;
+        }
+
+        float sdfBox(const float3& p, const float3& b)
+        {
+            float3 q = glm::abs(p) - b;
+            return glm::length(glm::max(q, 0.0f)) + std::min(std::max(std::max(q.x, q.y), q.z), 0.0f);
+        }
+
+        float sdfTorus(const float3& p, float r)
+        {
+            return glm::length(float2(glm::length(float2(p.x, p.z)) - r, p.y));
+        }
+
+        float sdfCone(const float3& p, float tan, float h)
+        {
+            float2 q = h * float2(tan, -1.0f);
+            float2 w = float2(glm::length(float2(p.x, p.z)), p.y - 0.5f * h);
+            float2 a = w - q * saturate(glm::dot(w, q) / glm::dot(q, q));
+            float2 b = w - q * float2(saturate(w.x / q.x), 1.0f);
+            float k = glm::sign(q.y);
+            float d = std::min(glm::dot(a, a), glm::dot(b, b));
+            float s = std::max(k * (w.x * q.y - w.y * q.x), k * (w.y - q.y));
+            return std::sqrt(d) * glm::sign(s);
+        }
+
+        float sdfCapsule(float3 p, float hl)
+        {
+            p.y -= glm::clamp(p.y, -hl, hl);
+            return glm::length(p);
+        }
+
+        // Host versions of the operations in Utils/SDF/SDFOperations.slang.
+
+        float smin(float a, float b, float k)
+        {
+            float h = std::max(k - std::abs(a - b), 0.0f);
+            return std::min(a, b) - h * h * 0.25f / k;
+        }
+
+        float smax(float a, float b, float k)
+        {
+            float h = std::max(k - std::abs(a - b), 0.0f);
+            return std::max(a, b) + h * h * 0.25f / k;
+        }
+
+        float evalOperation(SDFOperationType operationType, float d, float dShape, float smoothing)
+        {
+            switch (operationType)
+            {
+            case SDFOperationType::Union:                 return std::min(d, dShape);
+            case SDFOperationType::Subtraction:           return std::max(d, -dShape);
+            case SDFOperationType::Intersection:          return std::max(d, dShape);
+            case SDFOperationType::SmoothUnion:           return smin(d, dShape, smoothing);
+            case SDFOperationType::SmoothSubtraction:     return smax(d, -dShape, smoothing);
+            case SDFOperationType::SmoothIntersection:    return smax(d, dShape, smoothing);
+            default:                                      return d;
+            }
+        }
+
+        /** Calls func(shapeFunc) with a function evaluating the unblobbed shape of a primitive in local space.
+            Resolving the shape type once per primitive keeps the switch out of the per-value loops.
+        */
+        template<typename Func>
+        void dispatchShape(const SDF3DPrimitive& primitive, Func func)
+        {
+            const float3 data = primitive.shapeData;
+
+            switch (primitive.shapeType)
+            {
+            case SDF3DShapeType::Sphere:    func([=](const float3& p) { return sdfSphere(p, data.x); }); break;
+            case SDF3DShapeType::Ellipsoid: func([=](const float3& p) { return sdfEllipsoid(p, data); }); break;
+            case SDF3DShapeType::Box:       func([=](const float3& p) { return sdfBox(p, data); }); break;
+            case SDF3DShapeType::Torus:     func([=](const float3& p) { return sdfTorus(p, data.x); }); break;
+            case SDF3DShapeType::Cone:      func([=](const float3& p) { return sdfCone(p, data.x, data.y); }); break;
+            case SDF3DShapeType::Capsule:   func([=](const float3& p) { return sdfCapsule(p, data.x); }); break;
+            default:                        func([](const float3&) { return FLT_MAX; }); break;
+            }
+        }
+
+        /** Calls func(operationFunc) with a function applying the operation of a primitive.
+        */
+        template<typename Func>
+        void dispatchOperation(const SDF3DPrimitive& primitive, Func func)
+        {
+            const float k = primitive.operationSmoothing;
+
+            switch (primitive.operationType)
+            {
+            case SDFOperationType::Union:                 func([](float d, float s) { return std::min(d, s); }); break;
+            case SDFOperationType::Subtraction:           func([](float d, float s) { return std::max(d, -s); }); break;
+            case SDFOperationType::Intersection:          func([](float d, float s) { return std::max(d, s); }); break;
+            case SDFOperationType::SmoothUnion:           func([=](float d, float s) { return smin(d, s, k); }); break;
+            case SDFOperationType::SmoothSubtraction:     func([=](float d, float s) { return smax(d, -s, k); }); break;
+            case SDFOperationType::SmoothIntersection:    func([=](float d, float s) { return smax(d, s, k); }); break;
+            default:                                      break;
+            }
+        }
+
+        // Host versions of the interval functions in Utils/Math/IntervalArithmetic.slang, intervals are stored as (min, max).
+
+        float2 ivlAdd(const float2& a, float s) { return a + s; }
+        float2 ivlAdd(const float2& a, const float2& b) { return a + b; }
+        float2 ivlSub(const float2& a, float s) { return a - s; }
+        float2 ivlSub(const float2& a, const float2& b) { return float2(a.x - b.y, a.y - b.x); }
+        float2 ivlNegate(const float2& a) { return float2(-a.y, -a.x); }
+        float2 ivlMin(const float2& a, const float2& b) { return glm::min(a, b); }
+        float2 ivlMin(const float2& a, float s) { return glm::min(a, float2(s)); }
+        float2 ivlMax(const float2& a, const float2& b) { return glm::max(a, b); }
+        float2 ivlMax(const float2& a, float s) { return glm::max(a, float2(s)); }
+        float2 ivlClamp(const float2& a, float lo, float hi) { return glm::clamp(a, float2(lo), float2(hi)); }
+        float2 ivlSaturate(const float2& a) { return ivlClamp(a, 0.0f, 1.0f); }
+        bool ivlContainsZero(const float2& a) { return a.x <= 0.0f && a.y >= 0.0f; }
+
+        float2 ivlMul(const float2& a, float s)
+        {
+            float2 prod = a * s;
+            return float2(std::min(prod.x, prod.y), std::max(prod.x, prod.y));
+        }
+
+        float2 ivlMul(const float2& a, const float2& b)
+        {
+            float p0 = a.x * b.x, p1 = a.y * b.y, p2 = a.y * b.x, p3 = a.x * b.y;
+            return float2(std::min(std::min(p0, p1), std::min(p2, p3)), std::max(std::max(p0, p1), std::max(p2, p3)));
+        }
+
+        float2 ivlDiv(const float2& a, float s)
+        {
+            float2 fract = a / s;
+            return float2(std::min(fract.x, fract.y), std::max(fract.x, fract.y));
+        }
+
+        float2 ivlDiv(const float2& a, const float2& b)
+        {
+            float2 denom = ivlContainsZero(b) ? float2(-FLT_MAX, FLT_MAX) : 1.0f / b;
+            return ivlMul(a, denom);
+        }
+
+        float2 ivlAbs(const float2& a)
+        {
+            return float2(std::max(std::max(a.x, -a.y), 0.0f), std::max(-a.x, a.y));
+        }
+
+        float2 ivlSquare(const float2& a)
+        {
+            float2 absA = ivlAbs(a);
+            return absA * absA;
+        }
+
+        float2 ivlSqrt(const float2& a)
+        {
+            return float2(std::sqrt(std::max(a.x, 0.0f)), std::sqrt(std::max(a.y, 0.0f)));
+        }
+
+        float2 ivlLength(const float2& x, const float2& y)
+        {
+            return ivlSqrt(ivlAdd(ivlSquare(x), ivlSquare(y)));
+        }
+
+        float2 ivlLength(const float2& x, const float2& y, const float2& z)
+        {
+            return ivlSqrt(ivlAdd(ivlAdd(ivlSquare(x), ivlSquare(y)), ivlSquare(z)));
+        }
+
+        /** Bounds the signed distance of the shape of a primitive over a box.
+            Unlike SDF3DPrimitive::evalIntervalShape(), the box is transformed into the local space of the primitive,
+            so the bounds are also conservative for rotated and scaled primitives.
+        */
+        float2 evalIntervalShape(const SDF3DPrimitive& primitive, const float3& center, const float3& halfExtent)
+        {
+            const float3x3& m = primitive.invRotationScale;
+            const float3 localCenter = toLocal(primitive, center);
+            const float3 localHalfExtent = float3(glm::dot(halfExtent, glm::abs(m[0])), glm::dot(halfExtent, glm::abs(m[1])), glm::dot(halfExtent, glm::abs(m[2])));
+            const float3 pMin = localCenter - localHalfExtent;
+            const float3 pMax = localCenter + localHalfExtent;
+
+            float2 x = float2(pMin.x, pMax.x);
+            float2 y = float2(pMin.y, pMax.y);
+            float2 z = float2(pMin.z, pMax.z);
+            const float3 data = primitive.shapeData;
+            float2 d = float2(FLT_MAX);
+
+            switch (primitive.shapeType)
+            {
+            case SDF3DShapeType::Sphere:
+                d = ivlSub(ivlLength(x, y, z), data.x);
+                break;
+            case SDF3DShapeType::Ellipsoid:
+            {
+                float3 rSqrd = data * data;
+                float2 k0 = ivlLength(ivlDiv(x, data.x), ivlDiv(y, data.y), ivlDiv(z, data.z));
+                float2 k1 = ivlLength(ivlDiv(x, rSqrd.x), ivlDiv(y, rSqrd.y), ivlDiv(z, rSqrd.z));
+                d = ivlDiv(ivlMul(k0, ivlSub(k0, 1.0f)), k1);
+                break;
+            }
+            case SDF3DShapeType::Box:
+            {
+                float2 qx = ivlSub(ivlAbs(x), data.x);
+                float2 qy = ivlSub(ivlAbs(y), data.y);
+                float2 qz = ivlSub(ivlAbs(z), data.z);
+                d = ivlAdd(ivlLength(ivlMax(qx, 0.0f), ivlMax(qy, 0.0f), ivlMax(qz, 0.0f)), ivlMin(ivlMax(ivlMax(qx, qy), qz), 0.0f));
+                break;
+            }
+            case SDF3DShapeType::Torus:
+                d = ivlLength(ivlSub(ivlLength(x, z), data.x), y);
+                break;
+            case SDF3DShapeType::Cone:
+            {
+                float tan = data.x;
+                float h = data.y;
+                y = ivlSub(y, 0.5f * h);
+
+                float2 q = h * float2(tan, -1.0f);
+                float2 wX = ivlLength(x, z);
+
+                float dotQQ = glm::dot(q, q);
+                float2 dotWQ = ivlAdd(ivlMul(wX, q.x), ivlMul(y, q.y));
+                float2 satDotWQDivDotQQ = ivlSaturate(ivlDiv(dotWQ, dotQQ));
+                float2 satWxDivQx = ivlSaturate(ivlDiv(wX, q.x));
+
+                float2 aX = ivlSub(wX, ivlMul(satDotWQDivDotQQ, q.x));
+                float2 aY = ivlSub(y, ivlMul(satDotWQDivDotQQ, q.y));
+                float2 bX = ivlSub(wX, ivlMul(satWxDivQx, q.x));
+                float2 bY = ivlSub(y, q.y);
+
+                float k = glm::sign(q.y);
+                float2 dd = ivlMin(ivlAdd(ivlSquare(aX), ivlSquare(aY)), ivlAdd(ivlSquare(bX), ivlSquare(bY)));
+                float2 s = ivlMax(ivlMul(ivlSub(ivlMul(wX, q.y), ivlMul(y, q.x)), k), ivlMul(ivlSub(y, q.y), k));
+                d = ivlMul(ivlSqrt(dd), glm::sign(s));
+                break;
+            }
+            case SDF3DShapeType::Capsule:
+                y = ivlSub(y, ivlClamp(y, -data.x, data.x));
+                d = ivlLength(x, y, z);
+                break;
+            }
+
+            return ivlSub(d, primitive.shapeBlobbing);
+        }
+
+        float2 evalIntervalOperation(SDFOperationType operationType, const float2& d, const float2& dShape, float smoothing)
+        {
+            auto smoothTerm = [&]()
+            {
+                float2 h = ivlMax(ivlAdd(ivlNegate(ivlAbs(ivlSub(d, operationType == SDFOperationType::SmoothSubtraction ? ivlNegate(dShape) : dShape))), smoothing), 0.0f);
+                return ivlDiv(ivlMul(h * h, 0.25f), smoothing);
+            };
+
+            // Smooth operations without smoothing are bounded by the corresponding sharp operations.
+            const bool smooth = smoothing > 0.0f;
+
+            switch (operationType)
+            {
+            case SDFOperationType::Union:                 return ivlMin(d, dShape);
+            case SDFOperationType::Subtraction:           return ivlMax(d, ivlNegate(dShape));
+            case SDFOperationType::Intersection:          return ivlMax(d, dShape);
+            case SDFOperationType::SmoothUnion:           return smooth ? ivlSub(ivlMin(d, dShape), smoothTerm()) : ivlMin(d, dShape);
+            case SDFOperationType::SmoothSubtraction:     return smooth ? ivlAdd(ivlMax(d, ivlNegate(dShape)), smoothTerm()) : ivlMax(d, ivlNegate(dShape));
+            case SDFOperationType::SmoothIntersection:    return smooth ? ivlAdd(ivlMax(d, dShape), smoothTerm()) : ivlMax(d, dShape);
+            default:                                      return d;
+            }
+        }
+
+        /** Finds the primitives that can affect the signed distance in a box.
+            A primitive is skipped if its operation leaves all values in the box unchanged, e.g., a union with a shape that is further away than the current distance.
+            If a primitive replaces all values in the box, e.g., a union with a shape that is closer than the current distance, all preceding primitives are skipped.
+            Skipping primitives does not change any values, so the result is the same as evaluating all primitives.
+            \param[in] primitives All primitives.
+            \param[in] candidates Indices of the candidate primitives in evaluation order.
+            \param[in] center Center of the box.
+            \param[in] halfExtent Half extent of the box.
+            \param[out] active Indices of the primitives that need to be evaluated in the box, in evaluation order.
+            \return Interval bounding the signed distance in the box.
+        */
+        float2 prunePrimitives(const std::vector<SDF3DPrimitive>& primitives, const std::vector<uint32_t>& candidates, const float3& center, const float3& halfExtent, std::vector<uint32_t>& active)
+        {
+            active.clear();
+            float2 d = float2(FLT_MAX);
+
+            for (uint32_t primitiveIndex : candidates)
+            {
+                const SDF3DPrimitive& primitive = primitives[primitiveIndex];
+                const float2 s = evalIntervalShape(primitive, center, halfExtent);
+
+                // The smooth operations only reduce to the sharp ones if the distances are at least the smoothing distance apart.
+                const float k = primitive.operationSmoothing;
+                const bool smooth = k > 0.0f;
+                bool skip = false;
+                bool replace = false;
+
+                switch (primitive.operationType)
+                {
+                case SDFOperationType::Union:
+                    skip = s.x >= d.y + kIntervalMargin;
+                    replace = s.y + kIntervalMargin <= d.x;
+                    break;
+                case SDFOperationType::Subtraction:
+                    skip = -s.x <= d.x - kIntervalMargin;
+                    break;
+                case SDFOperationType::Intersection:
+                    skip = s.y <= d.x - kIntervalMargin;
+                    break;
+                case SDFOperationType::SmoothUnion:
+                    skip = smooth && s.x >= d.y + k + kIntervalMargin;
+                    replace = smooth && s.y + k + kIntervalMargin <= d.x;
+                    break;
+                case SDFOperationType::SmoothSubtraction:
+                    skip = smooth && -s.x <= d.x - k - kIntervalMargin;
+                    break;
+                case SDFOperationType::SmoothIntersection:
+                    skip = smooth && s.y <= d.x - k - kIntervalMargin;
+                    break;
+                default:
+                    skip = true;
+                    break;
+                }
+
+                if (skip) continue;
+
+                if (replace)
+                {
+                    active.clear();
+                    d = s;
+                }
+                else
+                {
+                    d = evalIntervalOperation(primitive.operationType, d, s, k);
+                }
+                active.push_back(primitiveIndex);
+            }
+
+            return d;
+        }
+
+        /** Evaluates primitives on a grid by recursively subdividing it into regions of chunks.
+        */
+        class GridEvaluator
+        {
+        public:
+            GridEvaluator(const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth, const SDF3DPrimitiveEvaluator::Options& options, std::vector<float>& values)
+                : mPrimitives(primitives)
+                , mGridWidth(gridWidth)
+                , mChunkWidth(std::min(options.chunkWidth, gridWidth))
+                , mChunkCount(gridWidth / mChunkWidth)
+                , mNarrowBand(options.narrowBandWidth / (float)gridWidth)
+                , mValues(values)
+            {}
+
+            void run()
+            {
+                std::vector<uint32_t> candidates(mPrimitives.size());
+                for (uint32_t i = 0; i < (uint32_t)candidates.size(); i++) candidates[i] = i;
+                evalRegion(uint3(0), mChunkCount, candidates);
+            }
+
+            SDF3DPrimitiveEvaluator::Stats getStats() const
+            {
+                SDF3DPrimitiveEvaluator::Stats stats;
+                stats.evaluatedValueCount = mEvaluatedValueCount;
+                stats.clampedValueCount = mClampedValueCount;
+                stats.primitiveEvaluationCount = mPrimitiveEvaluationCount;
+                return stats;
+            }
+
+        private:
+            float3 getPosition(const uint3& valueCoords) const
+            {
+                // Same as in EvaluateSDFPrimitives.cs.slang.
+                return -0.5f + float3(valueCoords) / (float)mGridWidth;
+            }
+
+            /** Returns the range of values owned by a region. The values on the upper boundary of the grid belong to the last chunk.
+            */
+            void getValueRange(const uint3& chunkOffset, uint32_t chunkExtent, uint3& valueBegin, uint3& valueEnd) const
+            {
+                valueBegin = chunkOffset * mChunkWidth;
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    valueEnd[i] = chunkOffset[i] + chunkExtent >= mChunkCount ? mGridWidth + 1 : (chunkOffset[i] + chunkExtent) * mChunkWidth;
+                }
+            }
+
+            void fillValues(const uint3& valueBegin, const uint3& valueEnd, float value)
+            {
+                const uint32_t gridWidthInValues = mGridWidth + 1;
+                for (uint32_t z = valueBegin.z; z < valueEnd.z; z++)
+                {
+                    for (uint32_t y = valueBegin.y; y < valueEnd.y; y++)
+                    {
+                        float* pValues = mValues.data() + (size_t)gridWidthInValues * (y + (size_t)gridWidthInValues * z);
+                        std::fill(pValues + valueBegin.x, pValues + valueEnd.x, value);
+                    }
+                }
+
+                const uint3 extent = valueEnd - valueBegin;
+                mClampedValueCount += (uint64_t)extent.x * extent.y * extent.z;
+            }
+
+            /** Evaluates all values in a chunk. The primitives are evaluated one at a time over all values, which keeps the inner loops free of branches.
+            */
+            void evalChunk(const uint3& valueBegin, const uint3& valueEnd, const std::vector<uint32_t>& active)
+            {
+                const uint3 extent = valueEnd - valueBegin;
+                const uint32_t valueCount = extent.x * extent.y * extent.z;
+
+                std::vector<float3> positions;
+                positions.reserve(valueCount);
+                for (uint32_t z = valueBegin.z; z < valueEnd.z; z++)
+                {
+                    for (uint32_t y = valueBegin.y; y < valueEnd.y; y++)
+                    {
+                        for (uint32_t x = valueBegin.x; x < valueEnd.x; x++) positions.push_back(getPosition(uint3(x, y, z)));
+                    }
+                }
+
+                std::vector<float> distances(valueCount, FLT_MAX);
+                std::vector<float> shapeDistances(valueCount);
+
+                for (uint32_t primitiveIndex : active)
+                {
+                    const SDF3DPrimitive& primitive = mPrimitives[primitiveIndex];
+
+                    dispatchShape(primitive, [&](auto shapeFunc)
+                    {
+                        for (uint32_t i = 0; i < valueCount; i++) shapeDistances[i] = shapeFunc(toLocal(primitive, positions[i])) - primitive.shapeBlobbing;
+                    });
+
+                    dispatchOperation(primitive, [&](auto operationFunc)
+                    {
+                        for (uint32_t i = 0; i < valueCount; i++) distances[i] = operationFunc(distances[i], shapeDistances[i]);
+                    });
+                }
+
+                // Write the values to the grid.
+                const uint32_t gridWidthInValues = mGridWidth + 1;
+                const float* pDistances = distances.data();
+                for (uint32_t z = valueBegin.z; z < valueEnd.z; z++)
+                {
+                    for (uint32_t y = valueBegin.y; y < valueEnd.y; y++)
+                    {
+                        float* pValues = mValues.data() + (size_t)gridWidthInValues * (y + (size_t)gridWidthInValues * z);
+                        for (uint32_t x = valueBegin.x; x < valueEnd.x; x++)
+                        {
+                            const float d = *pDistances++;
+                            pValues[x] = mNarrowBand > 0.0f ? glm::clamp(d, -mNarrowBand, mNarrowBand) : d;
+                        }
+                    }
+                }
+
+                mEvaluatedValueCount += valueCount;
+                mPrimitiveEvaluationCount += (uint64_t)valueCount * active.size();
+            }
+
+            void evalRegion(const uint3& chunkOffset, uint32_t chunkExtent, const std::vector<uint32_t>& candidates)
+            {
+                uint3 valueBegin, valueEnd;
+                getValueRange(chunkOffset, chunkExtent, valueBegin, valueEnd);
+
+                const float3 pMin = getPosition(valueBegin);
+                const float3 pMax = getPosition(valueEnd - 1u);
+
+                std::vector<uint32_t> active;
+                active.reserve(candidates.size());
+                const float2 d = prunePrimitives(mPrimitives, candidates, 0.5f * (pMin + pMax), 0.5f * (pMax - pMin), active);
+
+                // Regions entirely outside of the narrow band are clamped without evaluating them.
+                if (mNarrowBand > 0.0f && (d.x >= mNarrowBand || d.y <= -mNarrowBand))
+                {
+                    fillValues(valueBegin, valueEnd, d.x >= mNarrowBand ? mNarrowBand : -mNarrowBand);
+                    return;
+                }
+
+                if (chunkExtent == 1)
+                {
+                    evalChunk(valueBegin, valueEnd, active);
+                    return;
+                }
+
+                // Subdivide the region into octants and process them in parallel.
+                const uint32_t childExtent = chunkExtent / 2;
+                std::vector<uint3> childOffsets;
+                for (uint32_t i = 0; i < 8; i++)
+                {
+                    childOffsets.push_back(chunkOffset + childExtent * uint3(i & 1, (i >> 1) & 1, i >> 2));
+                }
+                std::for_each(std::execution::par, childOffsets.begin(), childOffsets.end(), [&](const uint3& childOffset)
+                {
+                    evalRegion(childOffset, childExtent, active);
+                });
+            }
+
+            const std::vector<SDF3DPrimitive>& mPrimitives;
+            uint32_t mGridWidth;
+            uint32_t mChunkWidth;
+            uint32_t mChunkCount;   ///< Number of chunks along each dimension.
+            float mNarrowBand;      ///< Narrow band width in grid space, zero if disabled.
+            std::vector<float>& mValues;
+
+            std::atomic<uint64_t> mEvaluatedValueCount = 0;
+            std::atomic<uint64_t> mClampedValueCount = 0;
+            std::atomic<uint64_t> mPrimitiveEvaluationCount = 0;
+        };
+    }
+
+    float SDF3DPrimitiveEvaluator::eval(const std::vector<SDF3DPrimitive>& primitives, const float3& p)
+    {
+        float d = FLT_MAX;
+
+        for (const SDF3DPrimitive& primitive : primitives)
+        {
+            float dShape = FLT_MAX;
+            dispatchShape(primitive, [&](auto shapeFunc) { dShape = shapeFunc(toLocal(primitive, p)) - primitive.shapeBlobbing; });
+            d = evalOperation(primitive.operationType, d, dShape, primitive.operationSmoothing);
+        }
+
+        return d;
+    }
+
+    std::vector<float> SDF3DPrimitiveEvaluator::evalGrid(const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth, const Options& options, Stats* pStats)
+    {
+        checkArgument(isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2.", gridWidth);
+        checkArgument(isPowerOf2(options.chunkWidth), "'chunkWidth' ({}) must be a power of 2.", options.chunkWidth);
+        checkArgument(options.narrowBandWidth >= 0.f, "'narrowBandWidth' ({}) must not be negative.", options.narrowBandWidth);
+
+        const size_t gridWidthInValues = (size_t)gridWidth + 1;
+        std::vector<float> values(gridWidthInValues * gridWidthInValues * gridWidthInValues);
+
+        GridEvaluator evaluator(primitives, gridWidth, options, values);
+        evaluator.run();
+
+        if (pStats) *pStats = evaluator.getStats();
+        return values;
+    }
+}
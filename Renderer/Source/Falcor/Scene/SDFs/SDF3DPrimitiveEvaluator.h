@@ -0,0 +1,79 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+
+#include "SDF3DPrimitiveCommon.slang"
+
+namespace Falcor
+{
+    /** Evaluates sets of SDF primitives on the CPU.
+        This produces the same corner values as EvaluateSDFPrimitives.cs.slang, but does not require a GPU,
+        which makes it possible to bake SDF grids offline. The output can be passed directly to SDFGrid::setValues().
+
+        The grid is recursively subdivided into regions, and each region is bounded using interval arithmetic,
+        similar to how SDFSBS creates chunks from primitives on the GPU. Primitives that cannot affect any value in a region
+        are removed from the primitive list of that region and all its subregions. The remaining primitives are evaluated
+        in batches over all values in a chunk, and chunks are evaluated in parallel.
+    */
+    class FALCOR_API SDF3DPrimitiveEvaluator
+    {
+    public:
+        struct Options
+        {
+            float narrowBandWidth = 0.f;    ///< Width of the narrow band around the surface in voxels. Values outside the band are clamped to +-narrowBandWidth voxels and regions outside the band are not evaluated. Set to zero to evaluate all values.
+            uint32_t chunkWidth = 8;        ///< Width of the chunks in voxels that are evaluated as a batch. Must be a power of 2.
+        };
+
+        struct Stats
+        {
+            uint64_t evaluatedValueCount = 0;       ///< Number of values that were evaluated.
+            uint64_t clampedValueCount = 0;         ///< Number of values that were set to the narrow band width without being evaluated.
+            uint64_t primitiveEvaluationCount = 0;  ///< Number of primitive evaluations, summed over all evaluated values.
+        };
+
+        /** Evaluates the signed distance of a set of primitives at a single point.
+            \param[in] primitives The SDF primitives, applied in order.
+            \param[in] p The point in the local space of the SDF grid.
+            \return The signed distance.
+        */
+        static float eval(const std::vector<SDF3DPrimitive>& primitives, const float3& p);
+
+        /** Evaluates a set of primitives at the corners of all voxels of a grid.
+            The narrow band width should be at least the normalization distance of the SDF grid, e.g., half a voxel diagonal for SDFSBS.
+            \param[in] primitives The SDF primitives, applied in order.
+            \param[in] gridWidth The grid width in voxels. Must be a power of 2.
+            \param[in] options Evaluation options.
+            \param[out] pStats Optional evaluation statistics.
+            \return The corner values, (gridWidth + 1)^3 values in the layout expected by SDFGrid::setValues().
+        */
+        static std::vector<float> evalGrid(const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth, const Options& options, Stats* pStats = nullptr);
+
+    private:
+        SDF3DPrimitiveEvaluator() = delete;
+    };
+}
@@ -625,6 +625,10 @@ namespace Falcor
         sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "path"_a, "gridWidth"_a, "dir"_a = "");
         sdfGrid.def("generateCheeseValues", &SDFGrid::generateCheeseValues, "gridWidth"_a, "seed"_a);
         sdfGrid.def_property("name", &SDFGrid::getName, &SDFGrid::setName);
+
+        pybind11::class_<SDFSBS, SDFGrid, SDFSBS::SharedPtr> sdfSBS(m, "SDFSBS");
+        sdfSBS.def("loadBricksFromFile", &SDFSBS::loadBricksFromFile, "path"_a);
+        sdfSBS.def("writeBricksToFile", &SDFSBS::writeBricksToFile, "path"_a);
     }
 
     void SDFGrid::updatePrimitivesBuffer()
@@ -101,9 +101,13 @@ namespace Falcor
         {
             createResourcesFromValues(pRenderContext, deleteScratchData);
         }
+        else if (mPrimitives.empty() && mBrickFile.isOpen())
+        {
+            createResourcesFromBricks(mFileBricks);
+        }
         else
         {
-            throw RuntimeError("SDFSBS::setValues() or SDFSBS::setPrimitives() must be called prior to calling SDFSBS::construct()");
+            throw RuntimeError("SDFSBS::setValues(), SDFSBS::setPrimitives() or SDFSBS::loadBricksFromFile() must be called prior to calling SDFSBS::construct()");
         }
 
         allocatePrimitiveBits();
@@ -129,6 +133,50 @@ namespace Falcor
         var["normalizationFactor"] = 0.5f * glm::root_three<float>() / mGridWidth;
     }
 
+    bool SDFSBS::loadBricksFromFile(const std::filesystem::path& path)
+    {
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath) || !mBrickFile.open(fullPath))
+        {
+            logWarning("SDFSBS::loadBricksFromFile() file '{}' could not be opened!", path);
+            return false;
+        }
+
+        SDFSBSBrickBuilder::BrickDataView bricks;
+        if (!SDFSBSBrickBuilder::parseFile(mBrickFile.getData(), mBrickFile.getSize(), bricks))
+        {
+            logWarning("SDFSBS::loadBricksFromFile() file '{}' is not a valid SDF sparse brick set!", path);
+            mBrickFile.close();
+            return false;
+        }
+
+        if (bricks.layout.brickWidth != mBrickWidth || bricks.layout.compressed != mCompressed)
+        {
+            logWarning("SDFSBS::loadBricksFromFile() file '{}' has brick width {} ({}), expected {} ({}).", path,
+                bricks.layout.brickWidth, bricks.layout.compressed ? "compressed" : "uncompressed", mBrickWidth, mCompressed ? "compressed" : "uncompressed");
+            mBrickFile.close();
+            return false;
+        }
+
+        mFileBricks = bricks;
+        mOriginalGridWidth = bricks.layout.gridWidth;
+        mGridWidth = bricks.layout.gridWidth;
+        mValues.clear();
+        return true;
+    }
+
+    bool SDFSBS::writeBricksToFile(const std::filesystem::path& path) const
+    {
+        if (mValues.empty())
+        {
+            logWarning("SDFSBS::writeBricksToFile() requires the SDF sparse brick set to be initialized using values!");
+            return false;
+        }
+
+        SDFSBSBrickBuilder::BrickData bricks = SDFSBSBrickBuilder::build(mValues, mGridWidth, mBrickWidth, mCompressed);
+        return SDFSBSBrickBuilder::writeToFile(path, bricks);
+    }
+
     SDFGrid::UpdateFlags SDFSBS::createResourcesFromPrimitives(RenderContext* pRenderContext, bool deleteScratchData)
     {
         // Assume AABBs will change.
@@ -703,6 +751,33 @@ namespace Falcor
         }
     }
 
+    void SDFSBS::createResourcesFromBricks(const SDFSBSBrickBuilder::BrickDataView& bricks)
+    {
+        const SDFSBSBrickBuilder::Layout& layout = bricks.layout;
+        if (layout.brickCount == 0)
+        {
+            throw RuntimeError("SDFSBS::createResourcesFromBricks() can't create resources for a brick set without bricks!");
+        }
+
+        // The brick set was built for a specific indirection texture size and brick texture layout, use them as is.
+        mVirtualBricksPerAxis = layout.virtualBricksPerAxis;
+        mBrickCount = layout.brickCount;
+        mBricksPerAxis = layout.bricksPerAxis;
+        mBrickTextureDimensions = layout.brickTextureDimensions;
+
+        mpIndirectionTexture = Texture::create3D(mVirtualBricksPerAxis, mVirtualBricksPerAxis, mVirtualBricksPerAxis, ResourceFormat::R32Uint, 1, bricks.pIndirection, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        mpBrickAABBsBuffer = Buffer::createStructured(sizeof(AABB), mBrickCount, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, bricks.pBrickAABBs, false);
+
+        if (mCompressed)
+        {
+            mpBrickTexture = Texture::create2D(mBrickTextureDimensions.x, mBrickTextureDimensions.y, ResourceFormat::BC4Snorm, 1, 1, bricks.pBrickTexture);
+        }
+        else
+        {
+            mpBrickTexture = Texture::create2D(mBrickTextureDimensions.x, mBrickTextureDimensions.y, ResourceFormat::R8Snorm, 1, 1, bricks.pBrickTexture, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource);
+        }
+    }
+
     void SDFSBS::allocatePrimitiveBits()
     {
         // Calculate bits required to encode brick coords and brick local voxel coords.
@@ -715,6 +790,7 @@ namespace Falcor
         uint32_t gridWidthInValues = mGridWidth + 1;
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mValues.resize(valueCount);
+        mBrickFile.close();
 
         float normalizationMultipler = 2.0f * mGridWidth / glm::root_three<float>();
         for (uint32_t v = 0; v < valueCount; v++)
@@ -27,7 +27,9 @@
  **************************************************************************/
 #pragma once
 
+#include "SDFSBSBrickBuilder.h"
 #include "Scene/SDFs/SDFGrid.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Algorithm/PrefixSum.h"
 
 namespace Falcor
@@ -63,9 +65,24 @@ namespace Falcor
 
         virtual void setShaderData(const ShaderVar& var) const override;
 
+        /** Set the bricks of the SDF sparse brick set from a .sdfbs file.
+            The file is memory-mapped and its contents are uploaded directly when the GPU resources are created.
+            \param[in] path The path of a .sdfbs file.
+            \return true if the bricks could be set, otherwise false.
+        */
+        bool loadBricksFromFile(const std::filesystem::path& path);
+
+        /** Build the bricks of the SDF sparse brick set on the CPU and write them to a .sdfbs file.
+            The SDF sparse brick set must have been initialized using values.
+            \param[in] path The path to the output file.
+            \return true if the bricks could be written, otherwise false.
+        */
+        bool writeBricksToFile(const std::filesystem::path& path) const;
+
     protected:
         UpdateFlags createResourcesFromPrimitives(RenderContext* pRenderContext, bool deleteScratchData);
         void createResourcesFromValues(RenderContext* pRenderContext, bool deleteScratchData);
+        void createResourcesFromBricks(const SDFSBSBrickBuilder::BrickDataView& bricks);
 
         void allocatePrimitiveBits();
 
@@ -76,6 +93,8 @@ namespace Falcor
 
         // CPU data.
         std::vector<int8_t> mValues;
+        MemoryMappedFile mBrickFile;                    ///< Memory-mapped .sdfbs file the bricks were loaded from.
+        SDFSBSBrickBuilder::BrickDataView mFileBricks;  ///< Bricks referencing the memory-mapped file.
 
         // Specs.
         uint32_t mVirtualBricksPerAxis = 0;
@@ -0,0 +1,484 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "SDFSBSBrickBuilder.h"
+#include "Utils/NumericRange.h"
+#include <execution>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kCompressionWidth = 4;
+
+        const uint32_t kFileMagic = 0x53425344; // "DSBS"
+        const uint32_t kFileVersion = 1;
+        const size_t kFileSectionAlignment = 16;
+
+        /** Header of a .sdfbs file. The header is followed by the indirection table, the brick AABBs and the brick texture,
+            each starting at an offset aligned to kFileSectionAlignment.
+        */
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t gridWidth;
+            uint32_t brickWidth;
+            uint32_t virtualBricksPerAxis;
+            uint32_t brickCount;
+            uint32_t bricksPerAxis[2];
+            uint32_t brickTextureDimensions[2];
+            uint32_t compressed;
+            uint32_t reserved;
+            uint64_t indirectionOffset;
+            uint64_t brickAABBsOffset;
+            uint64_t brickTextureOffset;
+            uint64_t brickTextureSize;
+        };
+
+        static_assert(sizeof(FileHeader) == 80);
+        static_assert(sizeof(AABB) == 24);
+
+        size_t alignSection(size_t offset)
+        {
+            return (offset + kFileSectionAlignment - 1) & ~(kFileSectionAlignment - 1);
+        }
+
+        /** Matches the conversion of a value stored in an R8Snorm texture, where -128 and -127 both map to -1.
+        */
+        int8_t loadSnorm(int8_t value)
+        {
+            return std::max(value, int8_t(-127));
+        }
+
+        /** Checks if any voxel of a brick contains surface.
+            Corner values along the edges of the brick voxels form a connected set, so a voxel with corners on both sides of the surface
+            exists exactly when the brick has corner values on both sides of the surface. This is equivalent to the per-voxel test
+            in SDFSBSAssignBrickValidityFromValuesPass.cs.slang.
+        */
+        bool brickContainsSurface(const int8_t* pValues, uint32_t gridWidth, uint3 voxelBegin, uint3 voxelEnd)
+        {
+            const uint32_t gridWidthInValues = gridWidth + 1;
+            const uint32_t rowLength = voxelEnd.x - voxelBegin.x + 1;
+
+            int minValue = INT8_MAX;
+            int maxValue = INT8_MIN;
+            for (uint32_t z = voxelBegin.z; z <= voxelEnd.z; ++z)
+            {
+                for (uint32_t y = voxelBegin.y; y <= voxelEnd.y; ++y)
+                {
+                    const int8_t* pRow = pValues + voxelBegin.x + size_t(gridWidthInValues) * (y + size_t(gridWidthInValues) * z);
+
+                    int8_t rowMin = INT8_MAX;
+                    int8_t rowMax = INT8_MIN;
+                    for (uint32_t x = 0; x < rowLength; ++x)
+                    {
+                        rowMin = std::min(rowMin, pRow[x]);
+                        rowMax = std::max(rowMax, pRow[x]);
+                    }
+
+                    minValue = std::min(minValue, int(rowMin));
+                    maxValue = std::max(maxValue, int(rowMax));
+                    if (minValue <= 0 && maxValue >= 0) return true;
+                }
+            }
+
+            return false;
+        }
+
+        // Host versions of the functions in BC4Encode.slang. The encoder must match the shader bit for bit.
+
+        void fixRange(int& minValue, int& maxValue, int steps)
+        {
+            if (maxValue - minValue < steps)
+            {
+                maxValue = std::min(minValue + steps, 127);
+                minValue = maxValue - minValue < steps ? std::max(-128, maxValue - steps) : minValue;
+            }
+        }
+
+        int fitCodes(const int block[16], const int codes[8], uint32_t indices[16])
+        {
+            int err = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                // Squared error against all codes. Kept separate from the search below so that it vectorizes.
+                int dist[8];
+                for (uint32_t j = 0; j < 8; ++j)
+                {
+                    int d = block[i] - codes[j];
+                    dist[j] = d * d;
+                }
+
+                // Find the first code with the least error.
+                int least = dist[0];
+                uint32_t index = 0;
+                for (uint32_t j = 1; j < 8; ++j)
+                {
+                    if (dist[j] < least)
+                    {
+                        least = dist[j];
+                        index = j;
+                    }
+                }
+
+                indices[i] = index;
+                err += least;
+            }
+            return err;
+        }
+
+        uint64_t writeAlphaBlock(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            uint64_t compressedBlock = 0;
+            compressedBlock |= uint64_t(alpha0 & 0xff);
+            compressedBlock |= uint64_t(alpha1 & 0xff) << 8;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                compressedBlock |= uint64_t(indices[i] & 0x7) << (3 * (i % 8) + 24 * (i / 8) + 16);
+            }
+            return compressedBlock;
+        }
+
+        uint64_t writeAlphaBlock5(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            if (alpha0 <= alpha1) return writeAlphaBlock(alpha0, alpha1, indices);
+
+            // Swap the endpoints and remap the indices.
+            uint32_t swappedIndices[16];
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t index = indices[i];
+                if (index == 0)         swappedIndices[i] = 1;
+                else if (index == 1)    swappedIndices[i] = 0;
+                else if (index <= 5)    swappedIndices[i] = 7 - index;
+                else                    swappedIndices[i] = index;
+            }
+            return writeAlphaBlock(alpha1, alpha0, swappedIndices);
+        }
+
+        uint64_t writeAlphaBlock7(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            if (alpha0 >= alpha1) return writeAlphaBlock(alpha0, alpha1, indices);
+
+            // Swap the endpoints and remap the indices.
+            uint32_t swappedIndices[16];
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t index = indices[i];
+                if (index == 0)         swappedIndices[i] = 1;
+                else if (index == 1)    swappedIndices[i] = 0;
+                else                    swappedIndices[i] = 9 - index;
+            }
+            return writeAlphaBlock(alpha1, alpha0, swappedIndices);
+        }
+
+        /** Writes the values of a brick to the brick texture, matching SDFSBSCreateBricksFromValues.cs.slang.
+            Values outside of the grid are set to 1.
+        */
+        void writeBrick(const int8_t* pValues, const SDFSBSBrickBuilder::Layout& layout, uint32_t brickID, uint3 virtualBrickCoords, uint8_t* pBrickTexture)
+        {
+            const uint32_t gridWidthInValues = layout.gridWidth + 1;
+            const uint32_t brickWidthInValues = layout.brickWidth + 1;
+            const uint3 brickGridCoords = virtualBrickCoords * layout.brickWidth;
+            const uint2 brickTextureCoords = uint2(brickID % layout.bricksPerAxis.x, brickID / layout.bricksPerAxis.x) * uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues);
+            const size_t rowPitch = layout.getBrickTextureRowPitch();
+
+            auto loadValue = [&](uint32_t x, uint32_t y, uint32_t z) -> int8_t
+            {
+                if (x >= layout.gridWidth || y >= layout.gridWidth || z >= layout.gridWidth) return INT8_MAX;
+                return loadSnorm(pValues[x + size_t(gridWidthInValues) * (y + size_t(gridWidthInValues) * z)]);
+            };
+
+            if (!layout.compressed)
+            {
+                for (uint32_t z = 0; z < brickWidthInValues; ++z)
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; ++y)
+                    {
+                        uint8_t* pRow = pBrickTexture + size_t(brickTextureCoords.y + y) * rowPitch + brickTextureCoords.x + z * brickWidthInValues;
+                        for (uint32_t x = 0; x < brickWidthInValues; ++x)
+                        {
+                            pRow[x] = (uint8_t)loadValue(brickGridCoords.x + x, brickGridCoords.y + y, brickGridCoords.z + z);
+                        }
+                    }
+                }
+                return;
+            }
+
+            for (uint32_t z = 0; z < brickWidthInValues; ++z)
+            {
+                for (uint32_t y = 0; y < brickWidthInValues; y += kCompressionWidth)
+                {
+                    for (uint32_t x = 0; x < brickWidthInValues; x += kCompressionWidth)
+                    {
+                        int8_t block[16];
+                        for (uint32_t bY = 0; bY < kCompressionWidth; ++bY)
+                        {
+                            for (uint32_t bX = 0; bX < kCompressionWidth; ++bX)
+                            {
+                                block[bY * kCompressionWidth + bX] = loadValue(brickGridCoords.x + x + bX, brickGridCoords.y + y + bY, brickGridCoords.z + z);
+                            }
+                        }
+
+                        uint2 blockTextureCoords = (brickTextureCoords + uint2(x + z * brickWidthInValues, y)) / kCompressionWidth;
+                        uint64_t compressedBlock = SDFSBSBrickBuilder::compressBC4Block(block);
+                        std::memcpy(pBrickTexture + blockTextureCoords.y * rowPitch + blockTextureCoords.x * sizeof(uint64_t), &compressedBlock, sizeof(uint64_t));
+                    }
+                }
+            }
+        }
+    }
+
+    SDFSBSBrickBuilder::BrickData SDFSBSBrickBuilder::build(const std::vector<int8_t>& values, uint32_t gridWidth, uint32_t brickWidth, bool compressed, uint32_t virtualBricksPerAxis)
+    {
+        checkArgument(gridWidth > 0, "'gridWidth' must be greater than zero");
+        checkArgument(brickWidth > 0, "'brickWidth' must be greater than zero");
+        checkArgument(!compressed || (brickWidth + 1) % 4 == 0, "'brickWidth' ({}) must be a multiple of 4 minus 1 for compressed SDFSBSs", brickWidth);
+
+        const size_t gridWidthInValues = gridWidth + 1;
+        checkArgument(values.size() == gridWidthInValues * gridWidthInValues * gridWidthInValues, "'values' must contain (gridWidth + 1)^3 values");
+
+        BrickData data;
+        Layout& layout = data.layout;
+        layout.gridWidth = gridWidth;
+        layout.brickWidth = brickWidth;
+        layout.virtualBricksPerAxis = std::max(virtualBricksPerAxis, (uint32_t)std::ceilf(float(gridWidth) / brickWidth));
+        layout.compressed = compressed;
+
+        const uint32_t virtualBricksPerAxisSq = layout.virtualBricksPerAxis * layout.virtualBricksPerAxis;
+        const uint32_t virtualBrickCount = layout.getVirtualBrickCount();
+        auto getVirtualBrickCoords = [&](uint32_t virtualBrickID)
+        {
+            return uint3(virtualBrickID % layout.virtualBricksPerAxis, (virtualBrickID % virtualBricksPerAxisSq) / layout.virtualBricksPerAxis, virtualBrickID / virtualBricksPerAxisSq);
+        };
+
+        // Assign brick validity. Bricks that lie entirely outside of the grid contain no voxels and are always invalid.
+        data.indirection.resize(virtualBrickCount);
+        {
+            auto range = NumericRange<uint32_t>(0, virtualBrickCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t virtualBrickID)
+            {
+                uint3 voxelBegin = getVirtualBrickCoords(virtualBrickID) * brickWidth;
+                uint3 voxelEnd = glm::min(voxelBegin + brickWidth, uint3(gridWidth));
+                bool valid = glm::all(glm::lessThan(voxelBegin, voxelEnd)) && brickContainsSurface(values.data(), gridWidth, voxelBegin, voxelEnd);
+                data.indirection[virtualBrickID] = valid ? 1 : 0;
+            });
+        }
+
+        // Compact the valid bricks, assigning brick IDs in virtual brick order.
+        std::vector<uint32_t> virtualBrickIDs;
+        for (uint32_t virtualBrickID = 0; virtualBrickID < virtualBrickCount; ++virtualBrickID)
+        {
+            if (data.indirection[virtualBrickID] != 0)
+            {
+                data.indirection[virtualBrickID] = (uint32_t)virtualBrickIDs.size();
+                virtualBrickIDs.push_back(virtualBrickID);
+            }
+            else
+            {
+                data.indirection[virtualBrickID] = kInvalidBrickID;
+            }
+        }
+        layout.brickCount = (uint32_t)virtualBrickIDs.size();
+
+        if (layout.brickCount == 0) return data;
+
+        // Size the brick texture the same way as SDFSBS::createResourcesFromValues() does.
+        const uint32_t brickWidthInValues = brickWidth + 1;
+        uint32_t bricksAlongX = (uint32_t)std::ceilf(std::sqrtf((float)layout.brickCount / brickWidthInValues));
+        uint32_t bricksAlongY = (uint32_t)std::ceilf((float)layout.brickCount / bricksAlongX);
+        layout.bricksPerAxis = uint2(bricksAlongX, bricksAlongY);
+        layout.brickTextureDimensions = uint2(brickWidthInValues * brickWidthInValues * bricksAlongX, brickWidthInValues * bricksAlongY);
+
+        // Create bricks and brick AABBs.
+        data.brickAABBs.resize(layout.brickCount);
+        data.brickTexture.resize(layout.getBrickTextureSize(), 0);
+        {
+            auto range = NumericRange<uint32_t>(0, layout.brickCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t brickID)
+            {
+                uint3 virtualBrickCoords = getVirtualBrickCoords(virtualBrickIDs[brickID]);
+
+                float3 brickAABBMin = -0.5f + float3(virtualBrickCoords * brickWidth) / float(gridWidth);
+                float3 brickAABBMax = glm::min(brickAABBMin + float(brickWidth) / float(gridWidth), float3(0.5f));
+                data.brickAABBs[brickID] = AABB(brickAABBMin, brickAABBMax);
+
+                writeBrick(values.data(), layout, brickID, virtualBrickCoords, data.brickTexture.data());
+            });
+        }
+
+        return data;
+    }
+
+    uint64_t SDFSBSBrickBuilder::compressBC4Block(const int8_t block[16])
+    {
+        int values[16];
+        for (uint32_t i = 0; i < 16; ++i) values[i] = block[i];
+
+        // Get the range for 5-alpha and 7-alpha interpolation.
+        int min5 = 127;
+        int max5 = -128;
+        int min7 = 127;
+        int max7 = -128;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            min7 = std::min(min7, values[i]);
+            max7 = std::max(max7, values[i]);
+            min5 = values[i] != -128 && values[i] < min5 ? values[i] : min5;
+            max5 = values[i] != 127 && values[i] > max5 ? values[i] : max5;
+        }
+
+        min5 = std::min(min5, max5);
+        min7 = std::min(min7, max7);
+
+        // Fix the range to be the minimum in each case.
+        fixRange(min5, max5, 5);
+        fixRange(min7, max7, 7);
+
+        // Set up the code books.
+        int codes5[8];
+        codes5[0] = min5;
+        codes5[1] = max5;
+        for (int i = 1; i < 5; ++i) codes5[1 + i] = ((5 - i) * min5 + i * max5) / 5;
+        codes5[6] = -128;
+        codes5[7] = 127;
+
+        int codes7[8];
+        codes7[0] = min7;
+        codes7[1] = max7;
+        for (int i = 1; i < 7; ++i) codes7[1 + i] = ((7 - i) * min7 + i * max7) / 7;
+
+        // Fit the data to both code books and keep the block with the least error.
+        uint32_t indices5[16];
+        uint32_t indices7[16];
+        int err5 = fitCodes(values, codes5, indices5);
+        int err7 = fitCodes(values, codes7, indices7);
+
+        return err5 <= err7 ? writeAlphaBlock5(min5, max5, indices5) : writeAlphaBlock7(min7, max7, indices7);
+    }
+
+    bool SDFSBSBrickBuilder::writeToFile(const std::filesystem::path& path, const BrickData& data)
+    {
+        const Layout& layout = data.layout;
+        FALCOR_ASSERT(data.indirection.size() == layout.getVirtualBrickCount());
+        FALCOR_ASSERT(data.brickAABBs.size() == layout.brickCount);
+        FALCOR_ASSERT(data.brickTexture.size() == layout.getBrickTextureSize());
+
+        FileHeader header = {};
+        header.magic = kFileMagic;
+        header.version = kFileVersion;
+        header.gridWidth = layout.gridWidth;
+        header.brickWidth = layout.brickWidth;
+        header.virtualBricksPerAxis = layout.virtualBricksPerAxis;
+        header.brickCount = layout.brickCount;
+        header.bricksPerAxis[0] = layout.bricksPerAxis.x;
+        header.bricksPerAxis[1] = layout.bricksPerAxis.y;
+        header.brickTextureDimensions[0] = layout.brickTextureDimensions.x;
+        header.brickTextureDimensions[1] = layout.brickTextureDimensions.y;
+        header.compressed = layout.compressed ? 1 : 0;
+        header.indirectionOffset = alignSection(sizeof(FileHeader));
+        header.brickAABBsOffset = alignSection(header.indirectionOffset + data.indirection.size() * sizeof(uint32_t));
+        header.brickTextureOffset = alignSection(header.brickAABBsOffset + data.brickAABBs.size() * sizeof(AABB));
+        header.brickTextureSize = data.brickTexture.size();
+
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        if (!file.is_open())
+        {
+            logWarning("SDFSBSBrickBuilder::writeToFile() file '{}' could not be opened!", path);
+            return false;
+        }
+
+        uint64_t fileOffset = 0;
+        auto writeSection = [&](uint64_t offset, const void* pData, size_t size)
+        {
+            static const char kPadding[kFileSectionAlignment] = {};
+            file.write(kPadding, offset - fileOffset);
+            file.write(reinterpret_cast<const char*>(pData), size);
+            fileOffset = offset + size;
+        };
+
+        writeSection(0, &header, sizeof(FileHeader));
+        writeSection(header.indirectionOffset, data.indirection.data(), data.indirection.size() * sizeof(uint32_t));
+        writeSection(header.brickAABBsOffset, data.brickAABBs.data(), data.brickAABBs.size() * sizeof(AABB));
+        writeSection(header.brickTextureOffset, data.brickTexture.data(), data.brickTexture.size());
+
+        if (!file.good())
+        {
+            logWarning("SDFSBSBrickBuilder::writeToFile() failed to write file '{}'!", path);
+            return false;
+        }
+        return true;
+    }
+
+    bool SDFSBSBrickBuilder::parseFile(const uint8_t* pData, size_t size, BrickDataView& view)
+    {
+        if (!pData || size < sizeof(FileHeader)) return false;
+
+        FileHeader header;
+        std::memcpy(&header, pData, sizeof(FileHeader));
+        if (header.magic != kFileMagic || header.version != kFileVersion) return false;
+
+        Layout layout;
+        layout.gridWidth = header.gridWidth;
+        layout.brickWidth = header.brickWidth;
+        layout.virtualBricksPerAxis = header.virtualBricksPerAxis;
+        layout.brickCount = header.brickCount;
+        layout.bricksPerAxis = uint2(header.bricksPerAxis[0], header.bricksPerAxis[1]);
+        layout.brickTextureDimensions = uint2(header.brickTextureDimensions[0], header.brickTextureDimensions[1]);
+        layout.compressed = header.compressed != 0;
+
+        // Validate the layout and the section bounds.
+        if (layout.gridWidth == 0 || layout.brickWidth == 0) return false;
+        if (layout.compressed && (layout.brickWidth + 1) % 4 != 0) return false;
+        if (layout.virtualBricksPerAxis < div_round_up(layout.gridWidth, layout.brickWidth)) return false;
+        if (uint64_t(layout.bricksPerAxis.x) * layout.bricksPerAxis.y < layout.brickCount) return false;
+        const uint32_t brickWidthInValues = layout.brickWidth + 1;
+        if (layout.brickTextureDimensions != uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues) * layout.bricksPerAxis) return false;
+        if (header.brickTextureSize != layout.getBrickTextureSize()) return false;
+
+        auto isValidSection = [size](uint64_t offset, uint64_t sectionSize)
+        {
+            return offset % kFileSectionAlignment == 0 && offset <= size && sectionSize <= size - offset;
+        };
+
+        if (!isValidSection(header.indirectionOffset, uint64_t(layout.getVirtualBrickCount()) * sizeof(uint32_t)) ||
+            !isValidSection(header.brickAABBsOffset, uint64_t(layout.brickCount) * sizeof(AABB)) ||
+            !isValidSection(header.brickTextureOffset, header.brickTextureSize))
+        {
+            return false;
+        }
+
+        view.layout = layout;
+        view.pIndirection = reinterpret_cast<const uint32_t*>(pData + header.indirectionOffset);
+        view.pBrickAABBs = reinterpret_cast<const AABB*>(pData + header.brickAABBsOffset);
+        view.pBrickTexture = pData + header.brickTextureOffset;
+        return true;
+    }
+}
@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/AABB.h"
+#include <filesystem>
+
+namespace Falcor
+{
+    /** CPU builder for SDF sparse brick sets.
+
+        Builds the brick indirection table, brick AABBs and the (optionally BC4 compressed) brick texture from normalized 8-bit corner values,
+        producing the same result as the GPU passes used by SDFSBS::createResourcesFromValues(). All arrays are laid out exactly like the
+        corresponding GPU resources, which allows them to be uploaded without further processing.
+
+        Brick sets can be serialized to .sdfbs files. Each section of the file is stored in its GPU layout, so a file can be memory-mapped
+        and its sections passed directly as initial resource data (see SDFSBS::loadBricksFromFile()).
+    */
+    class FALCOR_API SDFSBSBrickBuilder
+    {
+    public:
+        static constexpr uint32_t kInvalidBrickID = std::numeric_limits<uint32_t>::max();
+
+        /** Dimensions of a brick set.
+        */
+        struct Layout
+        {
+            uint32_t gridWidth = 0;                     ///< Width of the virtual grid in voxels.
+            uint32_t brickWidth = 0;                    ///< Width of a brick in voxels.
+            uint32_t virtualBricksPerAxis = 0;          ///< Width of the indirection table in bricks.
+            uint32_t brickCount = 0;                    ///< Number of bricks that contain surface.
+            uint2 bricksPerAxis = uint2(0);             ///< Number of bricks along each axis of the brick texture.
+            uint2 brickTextureDimensions = uint2(0);    ///< Dimensions of the brick texture in texels.
+            bool compressed = false;                    ///< True if the brick texture is BC4 compressed.
+
+            uint32_t getVirtualBrickCount() const { return virtualBricksPerAxis * virtualBricksPerAxis * virtualBricksPerAxis; }
+
+            /** Returns the size in bytes of a row of the brick texture (a row of blocks if the texture is compressed).
+            */
+            size_t getBrickTextureRowPitch() const { return compressed ? size_t(brickTextureDimensions.x / 4) * 8 : size_t(brickTextureDimensions.x); }
+
+            /** Returns the size in bytes of the brick texture.
+            */
+            size_t getBrickTextureSize() const { return getBrickTextureRowPitch() * (compressed ? brickTextureDimensions.y / 4 : brickTextureDimensions.y); }
+        };
+
+        /** A brick set built on the CPU.
+        */
+        struct BrickData
+        {
+            Layout layout;
+            std::vector<uint32_t> indirection;  ///< Brick ID of each virtual brick, or kInvalidBrickID if the virtual brick contains no surface.
+            std::vector<AABB> brickAABBs;       ///< Local space AABB of each brick.
+            std::vector<uint8_t> brickTexture;  ///< Brick texture data, either R8Snorm texels or BC4 blocks.
+        };
+
+        /** A brick set referencing externally owned memory, e.g., a memory-mapped .sdfbs file.
+        */
+        struct BrickDataView
+        {
+            Layout layout;
+            const uint32_t* pIndirection = nullptr;
+            const AABB* pBrickAABBs = nullptr;
+            const uint8_t* pBrickTexture = nullptr;
+        };
+
+        /** Build a sparse brick set from normalized corner values.
+            \param[in] values The normalized snorm corner values of the grid, (gridWidth + 1)^3 values stored in x, y, z order.
+            \param[in] gridWidth The width of the grid in voxels.
+            \param[in] brickWidth The width of a brick in voxels.
+            \param[in] compressed Selects if bricks should be BC4 compressed. brickWidth + 1 must be a multiple of 4 to enable compression.
+            \param[in] virtualBricksPerAxis Minimum width of the indirection table in bricks, it is never smaller than what is required to cover the grid.
+            \return The built brick set.
+        */
+        static BrickData build(const std::vector<int8_t>& values, uint32_t gridWidth, uint32_t brickWidth, bool compressed, uint32_t virtualBricksPerAxis = 0);
+
+        /** Compresses a 4x4 block of 8-bit snorm values using the same encoder as BC4Encode.slang.
+            \param[in] block The block values in row-major order.
+            \return The 8 byte BC4 block.
+        */
+        static uint64_t compressBC4Block(const int8_t block[16]);
+
+        /** Write a brick set to a .sdfbs file.
+            \param[in] path The path to the output file.
+            \param[in] data The brick set to write.
+            \return true if the file was written, otherwise false.
+        */
+        static bool writeToFile(const std::filesystem::path& path, const BrickData& data);
+
+        /** Parse the contents of a .sdfbs file.
+            \param[in] pData Pointer to the file contents, the returned view references this memory.
+            \param[in] size The size of the file contents in bytes.
+            \param[out] view The parsed brick set.
+            \return true if the contents form a valid brick set, otherwise false.
+        */
+        static bool parseFile(const uint8_t* pData, size_t size, BrickDataView& view);
+    };
+}
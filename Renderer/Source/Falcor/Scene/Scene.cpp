@@ -31,8 +31,11 @@
 #include "Scene/Curves/CurveConfig.h"
 #include "Utils/Math/MathHelpers.h"
 
+#include "Utils/NumericRange.h"
+
 #include <sstream>
 #include <numeric>
+#include <execution>
 
 namespace Falcor
 {
@@ -46,6 +49,11 @@ namespace Falcor
         // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
         const size_t kMaxBLASBuildMemory = 1ull << 29;
 
+        // Meshes with at most this many triangles are kept on the CPU as occluders for raster occlusion culling.
+        // Occluders are typically large, simple shapes like walls and floors. At most kMaxOccluderInstances are rasterized per view.
+        const uint32_t kMaxOccluderTriangles = 256;
+        const uint32_t kMaxOccluderInstances = 64;
+
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
         const std::string kMeshBufferName = "meshes";
@@ -67,6 +75,8 @@ namespace Falcor
         const std::string kBounds = "bounds";
         const std::string kAnimations = "animations";
         const std::string kLoopAnimations = "loopAnimations";
+        const std::string kRasterCulling = "rasterCulling";
+        const std::string kRasterOcclusionCulling = "rasterOcclusionCulling";
         const std::string kCamera = "camera";
         const std::string kCameras = "cameras";
         const std::string kCameraSpeed = "cameraSpeed";
@@ -152,10 +162,15 @@ namespace Falcor
 
         // Setup volume grid -> id map.
         for (size_t i = 0; i < mGrids.size(); ++i) mGridIDs.emplace(mGrids[i], (uint32_t)i);
+        mGridVolumeGridIDs.resize(mGridVolumes.size());
+        for (auto& gridIDs : mGridVolumeGridIDs) gridIDs.fill(kInvalidGrid);
 
         // Set default SDF grid config.
         setSDFGridConfig();
 
+        // Keep CPU copies of small static meshes for occlusion culling.
+        createOccluderMeshes(sceneData);
+
         // Create vertex array objects for meshes and curves.
         createMeshVao(sceneData.meshDrawCount, sceneData.meshIndexData, sceneData.meshStaticData, sceneData.meshSkinningData);
         createCurveVao(mCurveIndexData, mCurveStaticData);
@@ -295,10 +310,16 @@ namespace Falcor
         auto pCurrentRS = pState->getRasterizerState();
         bool isIndexed = hasIndexBuffer();
 
+        if (mRasterCulling.enabled) cullDrawList();
+
         for (const auto& draw : mDrawArgs)
         {
             FALCOR_ASSERT(draw.count > 0);
 
+            const Buffer* pArgBuffer = mRasterCulling.enabled ? draw.pCulledBuffer.get() : draw.pBuffer.get();
+            uint32_t drawCount = mRasterCulling.enabled ? draw.culledCount : draw.count;
+            if (drawCount == 0) continue;
+
             // Set state.
             pState->setVao(draw.ibFormat == ResourceFormat::R16Uint ? mpMeshVao16Bit : mpMeshVao);
 
@@ -308,11 +329,11 @@ namespace Falcor
             // Draw the primitives.
             if (isIndexed)
             {
-                pContext->drawIndexedIndirect(pState, pVars, draw.count, draw.pBuffer.get(), 0, nullptr, 0);
+                pContext->drawIndexedIndirect(pState, pVars, drawCount, pArgBuffer, 0, nullptr, 0);
             }
             else
             {
-                pContext->drawIndirect(pState, pVars, draw.count, draw.pBuffer.get(), 0, nullptr, 0);
+                pContext->drawIndirect(pState, pVars, drawCount, pArgBuffer, 0, nullptr, 0);
             }
         }
 
@@ -598,6 +619,12 @@ namespace Falcor
 
         mpSceneBlock = ParameterBlock::create(pReflection);
 
+        auto sceneVar = mpSceneBlock->getRootVar();
+        mSceneBlockHandles.cameraData = ShaderVarHandle(sceneVar, kCamera + ".data");
+        mSceneBlockHandles.lightCount = ShaderVarHandle(sceneVar, "lightCount");
+        mSceneBlockHandles.gridVolumeCount = ShaderVarHandle(sceneVar, "gridVolumeCount");
+        mSceneBlockHandles.rtAccel = ShaderVarHandle(sceneVar, "rtAccel");
+
         if (!mGeometryInstanceData.empty())
         {
             mpGeometryInstancesBuffer = Buffer::createStructured(mpSceneBlock[kGeometryInstanceBufferName], (uint32_t)mGeometryInstanceData.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
@@ -669,7 +696,7 @@ namespace Falcor
 
     void Scene::uploadSelectedCamera()
     {
-        getCamera()->setShaderData(mpSceneBlock[kCamera]);
+        mpSceneBlock->getRootVar()[mSceneBlockHandles.cameraData].setBlob(getCamera()->getData());
     }
 
     void Scene::updateBounds()
@@ -1408,7 +1435,7 @@ namespace Falcor
 
         if (combinedChanges != Light::Changes::None || forceUpdate)
         {
-            mpSceneBlock["lightCount"] = (uint32_t)mActiveLights.size();
+            mpSceneBlock->getRootVar()[mSceneBlockHandles.lightCount] = (uint32_t)mActiveLights.size();
             updateLightStats();
         }
 
@@ -1448,6 +1475,25 @@ namespace Falcor
             }
         }
 
+        // Get the grid ID of a volume slot.
+        // Streamed grid sequences replace their grids during playback. A new grid takes over the grid ID
+        // previously bound to the slot, as the number of grids in the scene is fixed.
+        auto getGridID = [&](uint32_t volumeIndex, GridVolume::GridSlot slot)
+        {
+            const auto& pGrid = mGridVolumes[volumeIndex]->getGrid(slot);
+            if (!pGrid) return kInvalidGrid;
+
+            uint32_t& boundGridID = mGridVolumeGridIDs[volumeIndex][(size_t)slot];
+            if (auto it = mGridIDs.find(pGrid); it != mGridIDs.end()) return boundGridID = it->second;
+            if (boundGridID == kInvalidGrid) return kInvalidGrid;
+
+            mGridIDs.erase(mGrids[boundGridID]);
+            mGrids[boundGridID] = pGrid;
+            mGridIDs.emplace(pGrid, boundGridID);
+            pGrid->setShaderData(mpSceneBlock["grids"][boundGridID]);
+            return boundGridID;
+        };
+
         // Upload volumes and clear updates.
         uint32_t volumeIndex = 0;
         for (const auto& pGridVolume : mGridVolumes)
@@ -1456,8 +1502,8 @@ namespace Falcor
             {
                 // Fetch copy of volume data.
                 auto data = pGridVolume->getData();
-                data.densityGrid = pGridVolume->getDensityGrid() ? mGridIDs.at(pGridVolume->getDensityGrid()) : kInvalidGrid;
-                data.emissionGrid = pGridVolume->getEmissionGrid() ? mGridIDs.at(pGridVolume->getEmissionGrid()) : kInvalidGrid;
+                data.densityGrid = getGridID(volumeIndex, GridVolume::GridSlot::Density);
+                data.emissionGrid = getGridID(volumeIndex, GridVolume::GridSlot::Emission);
                 // Merge grid and volume transforms.
                 const auto& densityGrid = pGridVolume->getDensityGrid();
                 if (densityGrid)
@@ -1471,7 +1517,7 @@ namespace Falcor
             volumeIndex++;
         }
 
-        mpSceneBlock["gridVolumeCount"] = (uint32_t)mGridVolumes.size();
+        mpSceneBlock->getRootVar()[mSceneBlockHandles.gridVolumeCount] = (uint32_t)mGridVolumes.size();
 
         UpdateFlags flags = UpdateFlags::None;
         if (is_set(combinedUpdates, GridVolume::UpdateFlags::TransformChanged)) flags |= UpdateFlags::GridVolumesMoved;
@@ -1594,6 +1640,7 @@ namespace Falcor
         {
             invalidateTlasCache();
             updateGeometryInstances(false);
+            mRasterCulling.boundsDirty = true;
         }
 
         // Update existing BLASes if skinned animation and/or procedural primitives moved.
@@ -1718,6 +1765,19 @@ namespace Falcor
             camera->renderUI(cameraGroup);
         }
 
+        if (auto cullingGroup = widget.group("Raster Culling"))
+        {
+            bool enabled = mRasterCulling.enabled;
+            if (cullingGroup.checkbox("Enable", enabled)) setRasterCullingEnabled(enabled);
+            cullingGroup.tooltip("Cull mesh instances against the selected camera's frustum on the CPU before rasterizing.", true);
+
+            bool occlusionEnabled = mRasterCulling.occlusionEnabled;
+            if (cullingGroup.checkbox("Occlusion culling", occlusionEnabled)) setRasterOcclusionCullingEnabled(occlusionEnabled);
+            cullingGroup.tooltip("Also cull mesh instances hidden behind small static meshes, using a low-resolution CPU depth buffer.", true);
+
+            if (mRasterCulling.enabled) cullingGroup.text(fmt::format("Visible instances: {} / {}", mRasterCulling.visibleCount, mRasterCulling.culler.getBoundsCount()));
+        }
+
         if (auto renderSettingsGroup = widget.group("Render Settings"))
         {
             renderSettingsGroup.checkbox("Use environment light", mRenderSettings.useEnvLight);
@@ -1894,6 +1954,10 @@ namespace Falcor
                     << "    Texture triangle count: " << stats.trianglesTextured << std::endl
                     << "    Culled triangle count: " << stats.trianglesCulled << std::endl
                     << "  Emissive lights memory: " << formatByteSize(s.emissiveMemoryInBytes) << std::endl;
+
+                const auto& syncStats = mpLightCollection->getCPUSyncStats();
+                oss << "  CPU sync (this frame): " << formatByteSize(syncStats.bytesTransferred) << ", " << syncStats.trianglesSynced << " triangles" << std::endl
+                    << "  CPU sync (total): " << formatByteSize(syncStats.totalBytesTransferred) << std::endl;
             }
             else
             {
@@ -2306,9 +2370,13 @@ namespace Falcor
         // TODO: Update the draw args if a mesh undergoes animation that flips the winding.
 
         mDrawArgs.clear();
+        mRasterCulling.resultValid = false;
+
+        // Geometry instance ID for each draw instance ID, used for culling.
+        std::vector<uint32_t> geometryInstanceIDs;
 
         // Helper to create the draw-indirect buffer.
-        auto createDrawBuffer = [this](const auto& drawMeshes, bool ccw, ResourceFormat ibFormat = ResourceFormat::Unknown)
+        auto createDrawBuffer = [this, &geometryInstanceIDs](const auto& drawMeshes, bool ccw, ResourceFormat ibFormat = ResourceFormat::Unknown)
         {
             if (drawMeshes.size() > 0)
             {
@@ -2319,6 +2387,13 @@ namespace Falcor
                 draw.count = (uint32_t)drawMeshes.size();
                 draw.ccw = ccw;
                 draw.ibFormat = ibFormat;
+
+                // Keep a CPU copy of the arguments for culling.
+                draw.argStride = (uint32_t)sizeof(drawMeshes[0]);
+                draw.args.resize(draw.pBuffer->getSize());
+                std::memcpy(draw.args.data(), drawMeshes.data(), draw.args.size());
+                for (const auto& drawMesh : drawMeshes) draw.instanceIDs.push_back(geometryInstanceIDs[drawMesh.StartInstanceLocation]);
+
                 mDrawArgs.push_back(draw);
             }
         };
@@ -2328,9 +2403,11 @@ namespace Falcor
             std::vector<DrawIndexedArguments> drawClockwiseMeshes[2], drawCounterClockwiseMeshes[2];
 
             uint32_t instanceID = 0;
-            for (const auto& instance : mGeometryInstanceData)
+            for (uint32_t geometryInstanceID = 0; geometryInstanceID < (uint32_t)mGeometryInstanceData.size(); geometryInstanceID++)
             {
+                const auto& instance = mGeometryInstanceData[geometryInstanceID];
                 if (instance.getType() != GeometryType::TriangleMesh) continue;
+                geometryInstanceIDs.push_back(geometryInstanceID);
 
                 const auto& mesh = mMeshDesc[instance.geometryID];
                 bool use16Bit = mesh.use16BitIndices();
@@ -2356,9 +2433,11 @@ namespace Falcor
             std::vector<DrawArguments> drawClockwiseMeshes, drawCounterClockwiseMeshes;
 
             uint32_t instanceID = 0;
-            for (const auto& instance : mGeometryInstanceData)
+            for (uint32_t geometryInstanceID = 0; geometryInstanceID < (uint32_t)mGeometryInstanceData.size(); geometryInstanceID++)
             {
+                const auto& instance = mGeometryInstanceData[geometryInstanceID];
                 if (instance.getType() != GeometryType::TriangleMesh) continue;
+                geometryInstanceIDs.push_back(geometryInstanceID);
 
                 const auto& mesh = mMeshDesc[instance.geometryID];
                 FALCOR_ASSERT(mesh.indexCount == 0);
@@ -2377,6 +2456,116 @@ namespace Falcor
         }
     }
 
+    void Scene::createOccluderMeshes(const SceneData& sceneData)
+    {
+        auto& culling = mRasterCulling;
+        culling.occluderMeshes.clear();
+        culling.meshOccluderIDs.assign(mMeshDesc.size(), uint32_t(-1));
+
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshDesc.size(); meshID++)
+        {
+            const auto& mesh = mMeshDesc[meshID];
+            const uint32_t triangleCount = mesh.getTriangleCount();
+            if (mesh.isDynamic() || triangleCount == 0 || triangleCount > kMaxOccluderTriangles) continue;
+
+            RasterCulling::OccluderMesh occluder;
+            occluder.positions.resize(mesh.vertexCount);
+            for (uint32_t i = 0; i < mesh.vertexCount; i++) occluder.positions[i] = sceneData.meshStaticData[mesh.vbOffset + i].position;
+
+            if (mesh.indexCount > 0)
+            {
+                // Index offsets are in 32-bit words. 16-bit indices are packed two per word.
+                occluder.indices.resize(mesh.indexCount);
+                const uint32_t* pIndices = sceneData.meshIndexData.data() + mesh.ibOffset;
+                for (uint32_t i = 0; i < mesh.indexCount; i++)
+                {
+                    occluder.indices[i] = mesh.use16BitIndices() ? reinterpret_cast<const uint16_t*>(pIndices)[i] : pIndices[i];
+                }
+            }
+
+            culling.meshOccluderIDs[meshID] = (uint32_t)culling.occluderMeshes.size();
+            culling.occluderMeshes.push_back(std::move(occluder));
+        }
+    }
+
+    void Scene::cullDrawList()
+    {
+        FALCOR_PROFILE("cullDrawList");
+
+        auto& culling = mRasterCulling;
+        const auto& camera = getCamera();
+        const glm::mat4& viewProj = camera->getViewProjMatrix();
+        if (culling.resultValid && !culling.boundsDirty && viewProj == culling.viewProj) return;
+
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        // Update the world space bounds of the instances. Instances that are not rasterized or whose bounds are unknown get an invalid box and are never culled.
+        if (culling.boundsDirty)
+        {
+            std::vector<AABB> bounds(mGeometryInstanceData.size());
+            auto range = NumericRange<uint32_t>(0, (uint32_t)mGeometryInstanceData.size());
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t instanceID)
+            {
+                const auto& instance = mGeometryInstanceData[instanceID];
+                if (instance.getType() != GeometryType::TriangleMesh || mMeshDesc[instance.geometryID].isDynamic()) return;
+                bounds[instanceID] = mMeshBBs[instance.geometryID].transform(globalMatrices[instance.globalMatrixID]);
+            });
+            culling.culler.setBounds(bounds);
+            culling.boundsDirty = false;
+        }
+
+        culling.visibleCount = culling.culler.cull(viewProj, culling.visible);
+
+        if (culling.occlusionEnabled && !culling.occluderMeshes.empty())
+        {
+            // Pick the visible occluders that cover the largest solid angle and rasterize them.
+            const float3 cameraPos = camera->getPosition();
+            std::vector<std::pair<float, uint32_t>> occluders;
+            for (uint32_t instanceID = 0; instanceID < (uint32_t)culling.visible.size(); instanceID++)
+            {
+                const auto& instance = mGeometryInstanceData[instanceID];
+                if (!culling.visible[instanceID] || instance.getType() != GeometryType::TriangleMesh) continue;
+                if (culling.meshOccluderIDs[instance.geometryID] == uint32_t(-1)) continue;
+
+                AABB box = mMeshBBs[instance.geometryID].transform(globalMatrices[instance.globalMatrixID]);
+                float distance = std::max(glm::length(box.center() - cameraPos), 1e-3f);
+                occluders.emplace_back(box.radius() / distance, instanceID);
+            }
+
+            const size_t occluderCount = std::min<size_t>(occluders.size(), kMaxOccluderInstances);
+            std::partial_sort(occluders.begin(), occluders.begin() + occluderCount, occluders.end(), std::greater<>());
+
+            culling.occlusionBuffer.reset(viewProj);
+            for (size_t i = 0; i < occluderCount; i++)
+            {
+                const auto& instance = mGeometryInstanceData[occluders[i].second];
+                const auto& occluder = culling.occluderMeshes[culling.meshOccluderIDs[instance.geometryID]];
+                const uint32_t triangleCount = mMeshDesc[instance.geometryID].getTriangleCount();
+                culling.occlusionBuffer.rasterizeTriangles(occluder.positions.data(), occluder.indices.empty() ? nullptr : occluder.indices.data(), triangleCount, globalMatrices[instance.globalMatrixID]);
+            }
+
+            culling.visibleCount = culling.culler.cull(viewProj, culling.visible, &culling.occlusionBuffer);
+        }
+
+        // Compact the draw arguments and upload them.
+        for (auto& draw : mDrawArgs)
+        {
+            culling.culledArgs.resize(draw.args.size());
+            draw.culledCount = InstanceCuller::compactDrawArgs(draw.args.data(), draw.argStride, draw.instanceIDs.data(), draw.count, culling.visible.data(), culling.culledArgs.data());
+            if (draw.culledCount == 0) continue;
+
+            if (!draw.pCulledBuffer)
+            {
+                draw.pCulledBuffer = Buffer::create(draw.args.size(), Resource::BindFlags::IndirectArg, Buffer::CpuAccess::None);
+                draw.pCulledBuffer->setName("Scene culled draw buffer");
+            }
+            draw.pCulledBuffer->setBlob(culling.culledArgs.data(), 0, (size_t)draw.culledCount * draw.argStride);
+        }
+
+        culling.viewProj = viewProj;
+        culling.resultValid = true;
+    }
+
     void Scene::initGeomDesc(RenderContext* pContext)
     {
         // This function initializes all geometry descs to prepare for BLAS build.
@@ -3452,10 +3641,10 @@ namespace Falcor
 
         // Bind TLAS.
         FALCOR_ASSERT(tlasIt != mTlasCache.end() && tlasIt->second.pTlasObject)
-        mpSceneBlock["rtAccel"].setAccelerationStructure(tlasIt->second.pTlasObject);
+        mpSceneBlock->getRootVar()[mSceneBlockHandles.rtAccel].setAccelerationStructure(tlasIt->second.pTlasObject);
 
         // Bind Scene parameter block.
-        getCamera()->setShaderData(mpSceneBlock[kCamera]); // TODO REMOVE: Shouldn't be needed anymore?
+        uploadSelectedCamera(); // TODO REMOVE: Shouldn't be needed anymore?
         var[kParameterBlockName] = mpSceneBlock;
     }
 
@@ -3772,6 +3961,8 @@ namespace Falcor
         scene.def_property(kCameraSpeed.c_str(), &Scene::getCameraSpeed, &Scene::setCameraSpeed);
         scene.def_property(kAnimated.c_str(), &Scene::isAnimated, &Scene::setIsAnimated);
         scene.def_property(kLoopAnimations.c_str(), &Scene::isLooped, &Scene::setIsLooped);
+        scene.def_property(kRasterCulling.c_str(), &Scene::isRasterCullingEnabled, &Scene::setRasterCullingEnabled);
+        scene.def_property(kRasterOcclusionCulling.c_str(), &Scene::isRasterOcclusionCullingEnabled, &Scene::setRasterOcclusionCullingEnabled);
         scene.def_property(kRenderSettings.c_str(), pybind11::overload_cast<void>(&Scene::getRenderSettings, pybind11::const_), &Scene::setRenderSettings);
         scene.def_property(kUpdateCallback.c_str(), &Scene::getUpdateCallback, &Scene::setUpdateCallback);
 
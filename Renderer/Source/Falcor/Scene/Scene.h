@@ -28,6 +28,7 @@
 #pragma once
 #include "Core/API/VAO.h"
 #include "Core/API/RtAccelerationStructure.h"
+#include "Core/Program/ShaderVarHandle.h"
 #include "Animation/Animation.h"
 #include "Lights/Light.h"
 #include "Lights/LightCollection.h"
@@ -48,6 +49,7 @@
 #include "Displacement/DisplacementUpdateTask.slang"
 #include "SceneTypes.slang"
 #include "HitInfo.h"
+#include "Culling/InstanceCuller.h"
 
 namespace Falcor
 {
@@ -900,6 +902,27 @@ namespace Falcor
         */
         void rasterize(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const RasterizerState::SharedPtr& pRasterizerStateCW, const RasterizerState::SharedPtr& pRasterizerStateCCW);
 
+        /** Enable/disable CPU culling of mesh instances in rasterize().
+            Instances are culled against the frustum of the selected camera, so culling should only be enabled if all
+            rasterization of the scene is done from the selected camera. Skinned and vertex-animated meshes are never culled.
+            Culling is disabled by default.
+        */
+        void setRasterCullingEnabled(bool enabled) { mRasterCulling.enabled = enabled; mRasterCulling.resultValid = false; }
+
+        /** Check if CPU culling of mesh instances in rasterize() is enabled.
+        */
+        bool isRasterCullingEnabled() const { return mRasterCulling.enabled; }
+
+        /** Enable/disable occlusion culling in addition to frustum culling.
+            Small static meshes close to the camera are rasterized as occluders into a low-resolution CPU depth buffer,
+            and instances hidden behind them are culled. Has no effect unless raster culling is enabled.
+        */
+        void setRasterOcclusionCullingEnabled(bool enabled) { mRasterCulling.occlusionEnabled = enabled; mRasterCulling.resultValid = false; }
+
+        /** Check if occlusion culling is enabled.
+        */
+        bool isRasterOcclusionCullingEnabled() const { return mRasterCulling.occlusionEnabled; }
+
         /** Get the required raytracing maximum attribute size for this scene.
             Note: This depends on what types of geometry are used in the scene.
             \return Max attribute size in bytes.
@@ -1078,6 +1101,14 @@ namespace Falcor
         */
         void createDrawList();
 
+        /** Create CPU copies of the meshes that can be used as occluders for raster culling.
+        */
+        void createOccluderMeshes(const SceneData& sceneData);
+
+        /** Cull the draw list against the selected camera. Does nothing if the camera and instances haven't changed since the last call.
+        */
+        void cullDrawList();
+
         /** Initialize geometry descs for each BLAS.
         */
         void initGeomDesc(RenderContext* pContext);
@@ -1152,6 +1183,11 @@ namespace Falcor
             uint32_t count = 0;             ///< Number of draws.
             bool ccw = true;                ///< True if counterclockwise triangle winding.
             ResourceFormat ibFormat = ResourceFormat::Unknown;  ///< Index buffer format.
+            std::vector<uint8_t> args;      ///< CPU copy of the draw-indirect arguments.
+            uint32_t argStride = 0;         ///< Size of the arguments of a draw in bytes.
+            std::vector<uint32_t> instanceIDs;  ///< Geometry instance ID for each draw.
+            Buffer::SharedPtr pCulledBuffer;    ///< Buffer holding the draw-indirect arguments of the visible draws when raster culling is enabled.
+            uint32_t culledCount = 0;           ///< Number of visible draws.
         };
 
         GeometryTypeFlags mGeometryTypes;                           ///< Set of geometry types that exist in the scene.
@@ -1167,6 +1203,28 @@ namespace Falcor
         Vao::SharedPtr mpCurveVao;                                  ///< Vertex array object for the global curve vertex/index buffers.
         std::vector<DrawArgs> mDrawArgs;                            ///< List of draw arguments for rasterizing the meshes in the scene.
 
+        struct RasterCulling
+        {
+            struct OccluderMesh
+            {
+                std::vector<float3> positions;
+                std::vector<uint32_t> indices;
+            };
+
+            bool enabled = false;                   ///< True if draws are culled in rasterize().
+            bool occlusionEnabled = false;          ///< True if occlusion culling is used in addition to frustum culling.
+            bool boundsDirty = true;                ///< True if the instance bounds need to be updated.
+            bool resultValid = false;               ///< True if the culled draw buffers are valid for 'viewProj'.
+            glm::mat4 viewProj;                     ///< View-projection matrix the draws were last culled with.
+            uint32_t visibleCount = 0;              ///< Number of visible geometry instances after the last culling.
+            InstanceCuller culler;
+            OcclusionBuffer occlusionBuffer;
+            std::vector<uint8_t> visible;           ///< Visibility of each geometry instance.
+            std::vector<uint8_t> culledArgs;        ///< Scratch buffer for compacted draw arguments.
+            std::vector<OccluderMesh> occluderMeshes;
+            std::vector<uint32_t> meshOccluderIDs;  ///< Index into 'occluderMeshes' for each mesh, or uint32_t(-1) if the mesh is not an occluder.
+        } mRasterCulling;
+
         // Triangle meshes
         std::vector<MeshDesc> mMeshDesc;                            ///< Copy of mesh data GPU buffer (mpMeshesBuffer).
         std::vector<MeshGroup> mMeshGroups;                         ///< Groups of meshes. Each group maps to a BLAS for ray tracing.
@@ -1217,6 +1275,7 @@ namespace Falcor
         std::vector<GridVolume::SharedPtr> mGridVolumes;            ///< All loaded grid volumes.
         std::vector<Grid::SharedPtr> mGrids;                        ///< All loaded grids.
         std::unordered_map<Grid::SharedPtr, uint32_t> mGridIDs;     ///< Lookup table for grid IDs.
+        std::vector<std::array<uint32_t, (size_t)GridVolume::GridSlot::Count>> mGridVolumeGridIDs; ///< Grid IDs last bound to the slots of each grid volume.
         LightCollection::SharedPtr mpLightCollection;               ///< Class for managing emissive geometry. This is created lazily upon first use.
         EnvMap::SharedPtr mpEnvMap;                                 ///< Environment map or nullptr if not loaded.
         bool mEnvMapChanged = false;                                ///< Flag indicating that the environment map has changed since last frame.
@@ -1243,6 +1302,17 @@ namespace Falcor
         Buffer::SharedPtr mpGridVolumesBuffer;
         ParameterBlock::SharedPtr mpSceneBlock;
 
+        /** Handles of the scene block variables that are updated every frame.
+        */
+        struct SceneBlockHandles
+        {
+            ShaderVarHandle cameraData;
+            ShaderVarHandle lightCount;
+            ShaderVarHandle gridVolumeCount;
+            ShaderVarHandle rtAccel;
+        };
+        SceneBlockHandles mSceneBlockHandles;                       ///< Handles resolved when the scene block is created.
+
         // Camera
         CameraControllerType mCamCtrlType = CameraControllerType::FirstPerson;
         CameraController::SharedPtr mpCamCtrl;
@@ -29,11 +29,13 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "MikkTSpaceGenerator.h"
 #include "Curves/CurveConfig.h"
 #include "Utils/Math/MathConstants.slangh"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Timing/TimeReport.h"
-#include <mikktspace.h>
+#include <execution>
 #include <filesystem>
 
 namespace Falcor
@@ -55,60 +57,6 @@ namespace Falcor
             else return 2;
         }
 
-        class MikkTSpaceWrapper
-        {
-        public:
-            static std::vector<float4> generateTangents(const SceneBuilder::Mesh& mesh)
-            {
-                if (!mesh.normals.pData || !mesh.positions.pData || !mesh.texCrds.pData || !mesh.pIndices)
-                {
-                    logWarning("Can't generate tangent space. The mesh '{}' doesn't have positions/normals/texCrd/indices.", mesh.name);
-                    return {};
-                }
-
-                // Generate new tangent space.
-                SMikkTSpaceInterface mikktspace = {};
-                mikktspace.m_getNumFaces = [](const SMikkTSpaceContext* pContext) { return ((MikkTSpaceWrapper*)(pContext->m_pUserData))->getFaceCount(); };
-                mikktspace.m_getNumVerticesOfFace = [](const SMikkTSpaceContext* pContext, int32_t face) { return 3; };
-                mikktspace.m_getPosition = [](const SMikkTSpaceContext* pContext, float position[], int32_t face, int32_t vert) { ((MikkTSpaceWrapper*)(pContext->m_pUserData))->getPosition(position, face, vert); };
-                mikktspace.m_getNormal = [](const SMikkTSpaceContext* pContext, float normal[], int32_t face, int32_t vert) { ((MikkTSpaceWrapper*)(pContext->m_pUserData))->getNormal(normal, face, vert); };
-                mikktspace.m_getTexCoord = [](const SMikkTSpaceContext* pContext, float texCrd[], int32_t face, int32_t vert) { ((MikkTSpaceWrapper*)(pContext->m_pUserData))->getTexCrd(texCrd, face, vert); };
-                mikktspace.m_setTSpaceBasic = [](const SMikkTSpaceContext* pContext, const float tangent[], float sign, int32_t face, int32_t vert) { ((MikkTSpaceWrapper*)(pContext->m_pUserData))->setTangent(tangent, sign, face, vert); };
-
-                MikkTSpaceWrapper wrapper(mesh);
-                SMikkTSpaceContext context = {};
-                context.m_pInterface = &mikktspace;
-                context.m_pUserData = &wrapper;
-
-                if (genTangSpaceDefault(&context) == false)
-                {
-                    throw RuntimeError("MikkTSpace failed to generate tangents for the mesh '{}'.", mesh.name);
-                }
-
-                return wrapper.mTangents;
-            }
-
-        private:
-            MikkTSpaceWrapper(const SceneBuilder::Mesh& mesh)
-                : mMesh(mesh)
-            {
-                FALCOR_ASSERT(mesh.indexCount > 0);
-                mTangents.resize(mesh.indexCount, float4(0));
-            }
-            const SceneBuilder::Mesh& mMesh;
-            std::vector<float4> mTangents;
-            int32_t getFaceCount() const { return (int32_t)mMesh.faceCount; }
-            void getPosition(float position[], int32_t face, int32_t vert) { *reinterpret_cast<float3*>(position) = mMesh.getPosition(face, vert); }
-            void getNormal(float normal[], int32_t face, int32_t vert) { *reinterpret_cast<float3*>(normal) = mMesh.getNormal(face, vert); }
-            void getTexCrd(float texCrd[], int32_t face, int32_t vert) { *reinterpret_cast<float2*>(texCrd) = mMesh.getTexCrd(face, vert); }
-
-            void setTangent(const float tangent[], float sign, int32_t face, int32_t vert)
-            {
-                float3 T = *reinterpret_cast<const float3*>(tangent);
-                mTangents[face * 3 + vert] = float4(glm::normalize(T), sign);
-            }
-        };
-
         void validateVertex(const SceneBuilder::Mesh::Vertex& v, size_t& invalidCount, size_t& zeroCount)
         {
             auto isInvalid = [](const auto& x)
@@ -202,7 +150,8 @@ namespace Falcor
         {
             try
             {
-                pBuilder->mpScene = Scene::create(SceneCache::readCache(pBuilder->mSceneCacheKey));
+                pBuilder->mSceneData = SceneCache::readCache(pBuilder->mSceneCacheKey);
+                pBuilder->mSceneDataFinalized = true;
                 return pBuilder;
             }
             catch (const std::exception& e)
@@ -225,6 +174,32 @@ namespace Falcor
     {
         if (mpScene) return mpScene;
 
+        finalizeSceneData();
+
+        // Create the scene object.
+        TimeReport timeReport;
+
+        mpScene = Scene::create(std::move(mSceneData));
+        mSceneData = {};
+
+        timeReport.measure("Creating resources");
+        timeReport.printToLog();
+
+        return mpScene;
+    }
+
+    const Scene::SceneData& SceneBuilder::getSceneData()
+    {
+        if (mpScene) throw RuntimeError("Scene data is no longer available after the scene has been created.");
+
+        finalizeSceneData();
+        return mSceneData;
+    }
+
+    void SceneBuilder::finalizeSceneData()
+    {
+        if (mSceneDataFinalized) return;
+
         // Finish loading textures. This blocks until all textures are loaded and assigned.
         mpMaterialTextureLoader.reset();
 
@@ -242,6 +217,16 @@ namespace Falcor
             addMeshInstance(nodeID, meshID);
         }
 
+        if (mVertexOrderStats.meshCount > 0)
+        {
+            const auto& stats = mVertexOrderStats;
+            const double triangleCount = (double)std::max(stats.triangleCount, uint64_t(1));
+            const double vertexCount = (double)std::max(stats.vertexCount, uint64_t(1));
+            logInfo("Optimized vertex order of {} meshes: ACMR {:.3f} -> {:.3f}, fetch ratio {:.3f} -> {:.3f}.", stats.meshCount,
+                stats.acmrBefore / triangleCount, stats.acmrAfter / triangleCount,
+                stats.fetchRatioBefore / vertexCount, stats.fetchRatioAfter / vertexCount);
+        }
+
         // Post-process the scene data.
         TimeReport timeReport;
 
@@ -296,14 +281,9 @@ namespace Falcor
             timeReport.measure("Writing cache");
         }
 
-        // Create the scene object.
-        mpScene = Scene::create(std::move(mSceneData));
-        mSceneData = {};
-
-        timeReport.measure("Creating resources");
         timeReport.printToLog();
 
-        return mpScene;
+        mSceneDataFinalized = true;
     }
 
     // Meshes
@@ -354,6 +334,7 @@ namespace Falcor
         //  - Compute tangent space if needed
         //  - Merge identical vertices, compute new indices (optional)
         //  - Validate final vertex data
+        //  - Reorder triangles/vertices for vertex cache and fetch efficiency (optional)
         //  - Compact vertices/indices into runtime format
 
         // Copy the mesh desc so we can update it. The caller retains the ownership of the data.
@@ -545,6 +526,38 @@ namespace Falcor
         const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
         const uint32_t vertexCount = isIndexed ? (uint32_t)vertices.size() : mesh.indexCount;
 
+        // Reorder the triangles for the post-transform vertex cache and the vertices for fetch locality.
+        // The attribute indices are reordered along with the vertices, so that data the importer derives
+        // from them (e.g. cached vertex animation) matches the final vertex order.
+        // Meshes with unmerged vertices keep their order, as importers may rely on it (e.g. curve poly-tubes).
+        if (is_set(mFlags, Flags::OptimizeVertexOrder) && isIndexed && mesh.mergeDuplicateVertices)
+        {
+            const uint32_t vertexStride = (uint32_t)sizeof(PackedStaticVertexData);
+            processedMesh.vertexOrderStatsBefore = MeshOptimizer::analyze(indices.data(), indices.size(), vertexCount, vertexStride);
+
+            MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+            std::vector<uint32_t> order = MeshOptimizer::optimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+
+            std::vector<std::pair<Mesh::Vertex, uint32_t>> reorderedVertices(vertexCount);
+            for (uint32_t i = 0; i < vertexCount; i++) reorderedVertices[i] = vertices[order[i]];
+            vertices = std::move(reorderedVertices);
+
+            if (pAttributeIndices)
+            {
+                FALCOR_ASSERT(pAttributeIndices->size() == vertexCount);
+                MeshAttributeIndices reorderedAttributeIndices(vertexCount);
+                for (uint32_t i = 0; i < vertexCount; i++) reorderedAttributeIndices[i] = (*pAttributeIndices)[order[i]];
+                *pAttributeIndices = std::move(reorderedAttributeIndices);
+            }
+
+            processedMesh.vertexOrderStatsAfter = MeshOptimizer::analyze(indices.data(), indices.size(), vertexCount, vertexStride);
+            processedMesh.isVertexOrderOptimized = true;
+
+            logDebug("Optimized vertex order of mesh '{}': ACMR {:.3f} -> {:.3f}, fetch ratio {:.3f} -> {:.3f}.", mesh.name,
+                processedMesh.vertexOrderStatsBefore.acmr, processedMesh.vertexOrderStatsAfter.acmr,
+                processedMesh.vertexOrderStatsBefore.fetchRatio, processedMesh.vertexOrderStatsAfter.fetchRatio);
+        }
+
         // Copy indices into processed mesh.
         if (isIndexed)
         {
@@ -590,7 +603,40 @@ namespace Falcor
 
     void SceneBuilder::generateTangents(Mesh& mesh, std::vector<float4>& tangents) const
     {
-        tangents = MikkTSpaceWrapper::generateTangents(mesh);
+        tangents.clear();
+        if (!mesh.normals.pData || !mesh.positions.pData || !mesh.texCrds.pData || !mesh.pIndices)
+        {
+            logWarning("Can't generate tangent space. The mesh '{}' doesn't have positions/normals/texCrd/indices.", mesh.name);
+        }
+        else
+        {
+            FALCOR_ASSERT(mesh.indexCount > 0);
+
+            // Gather the face-varying attributes.
+            std::vector<float3> positions(mesh.indexCount);
+            std::vector<float3> normals(mesh.indexCount);
+            std::vector<float2> texCrds(mesh.indexCount);
+            auto range = NumericRange<uint32_t>(0, mesh.indexCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i)
+            {
+                positions[i] = mesh.getPosition(i / 3, i % 3);
+                normals[i] = mesh.getNormal(i / 3, i % 3);
+                texCrds[i] = mesh.getTexCrd(i / 3, i % 3);
+            });
+
+            MikkTSpaceGenerator::MeshData meshData;
+            meshData.faceCount = mesh.faceCount;
+            meshData.pPositions = positions.data();
+            meshData.pNormals = normals.data();
+            meshData.pTexCrds = texCrds.data();
+
+            tangents.resize(mesh.indexCount);
+            if (!MikkTSpaceGenerator::generateTangents(meshData, tangents.data()))
+            {
+                throw RuntimeError("MikkTSpace failed to generate tangents for the mesh '{}'.", mesh.name);
+            }
+        }
+
         if (!tangents.empty())
         {
             FALCOR_ASSERT(tangents.size() == mesh.indexCount);
@@ -638,6 +684,18 @@ namespace Falcor
             spec.prevVertexCount = spec.skinningVertexCount;
         }
 
+        if (mesh.isVertexOrderOptimized)
+        {
+            const uint64_t triangleCount = mesh.indexCount / 3;
+            mVertexOrderStats.meshCount++;
+            mVertexOrderStats.triangleCount += triangleCount;
+            mVertexOrderStats.vertexCount += spec.vertexCount;
+            mVertexOrderStats.acmrBefore += mesh.vertexOrderStatsBefore.acmr * triangleCount;
+            mVertexOrderStats.acmrAfter += mesh.vertexOrderStatsAfter.acmr * triangleCount;
+            mVertexOrderStats.fetchRatioBefore += mesh.vertexOrderStatsBefore.fetchRatio * spec.vertexCount;
+            mVertexOrderStats.fetchRatioAfter += mesh.vertexOrderStatsAfter.fetchRatio * spec.vertexCount;
+        }
+
         mMeshes.push_back(spec);
 
         if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
@@ -2775,6 +2833,7 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("OptimizeVertexOrder", SceneBuilder::Flags::OptimizeVertexOrder);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
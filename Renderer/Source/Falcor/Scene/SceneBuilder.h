@@ -31,6 +31,7 @@
 #include "Transform.h"
 #include "TriangleMesh.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Utils/Geometry/MeshOptimizer.h"
 #include "VertexAttrib.slangh"
 
 namespace Falcor
@@ -50,7 +51,7 @@ namespace Falcor
             DontMergeMaterials              = 0x1,      ///< Don't merge materials that have the same properties. Use this option to preserve the original material names.
             UseOriginalTangentSpace         = 0x2,      ///< Use the original tangent space that was loaded with the mesh. By default, we will ignore it and use MikkTSpace to generate the tangent space. We will always generate tangent space if it is missing.
             AssumeLinearSpaceTextures       = 0x4,      ///< By default, textures representing colors (diffuse/specular) are interpreted as sRGB data. Use this flag to force linear space for color textures.
-            DontMergeMeshes                 = 0x8,      ///< Preserve the original list of meshes in the scene, don't merge meshes with the same material. This flag only applies to scenes imported by 'AssimpImporter'.
+            DontMergeMeshes                 = 0x8,      ///< Preserve the original list of meshes in the scene, don't merge meshes with the same material. This flag only applies to scenes imported by 'AssimpImporter', and to prims with identical geometry in 'USDImporter'.
             UseSpecGlossMaterials           = 0x10,     ///< Set materials to use Spec-Gloss shading model. Otherwise default is Spec-Gloss for OBJ, Metal-Rough for everything else.
             UseMetalRoughMaterials          = 0x20,     ///< Set materials to use Metal-Rough shading model. Otherwise default is Spec-Gloss for OBJ, Metal-Rough for everything else.
             NonIndexedVertices              = 0x40,     ///< Convert meshes to use non-indexed vertices. This requires more memory but may increase performance.
@@ -64,6 +65,7 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            OptimizeVertexOrder             = 0x20000,  ///< Reorder the triangles of each mesh for vertex cache efficiency and the vertices for fetch locality. Only applies to indexed meshes with merged duplicate vertices.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -263,6 +265,10 @@ namespace Falcor
             std::vector<uint32_t> indexData;    ///< Vertex indices in either 32-bit or 16-bit format packed tightly, or empty if non-indexed.
             std::vector<StaticVertexData> staticData;
             std::vector<SkinningVertexData> skinningData;
+
+            bool isVertexOrderOptimized = false;                ///< True if the triangles and vertices were reordered (see Flags::OptimizeVertexOrder).
+            MeshOptimizer::Stats vertexOrderStatsBefore;        ///< Vertex cache and fetch statistics before reordering.
+            MeshOptimizer::Stats vertexOrderStatsAfter;         ///< Vertex cache and fetch statistics after reordering.
         };
 
         using MeshAttributeIndices = std::vector<Mesh::VertexAttributeIndices>;
@@ -338,6 +344,14 @@ namespace Falcor
         */
         Scene::SharedPtr getScene();
 
+        /** Get the scene data without creating the scene.
+            This runs the same post-processing as getScene() and returns the data the scene would be created from.
+            It is useful for consumers that work on the scene data directly, such as the CPU path tracer.
+            The data stays valid until getScene() is called. Throws if the scene has already been created.
+            \return The finalized scene data.
+        */
+        const Scene::SceneData& getSceneData();
+
         /** Get the build flags
         */
         Flags getFlags() const { return mFlags; }
@@ -712,6 +726,7 @@ namespace Falcor
         Scene::SharedPtr mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        bool mSceneDataFinalized = false; ///< True if mSceneData has been post-processed and is ready for scene creation.
 
         SceneGraph mSceneGraph;
         const Flags mFlags;
@@ -721,6 +736,21 @@ namespace Falcor
 
         CurveList mCurves;
 
+        /** Vertex cache and fetch statistics accumulated over all meshes with optimized vertex order.
+            The ratios are summed up weighted by triangle and vertex count, respectively.
+        */
+        struct VertexOrderStats
+        {
+            uint32_t meshCount = 0;
+            uint64_t triangleCount = 0;
+            uint64_t vertexCount = 0;
+            double acmrBefore = 0.0;
+            double acmrAfter = 0.0;
+            double fetchRatioBefore = 0.0;
+            double fetchRatioAfter = 0.0;
+        };
+        VertexOrderStats mVertexOrderStats;
+
         std::unique_ptr<MaterialTextureLoader> mpMaterialTextureLoader;
         GpuFence::SharedPtr mpFence;
 
@@ -749,6 +779,7 @@ namespace Falcor
         MeshGroupList splitMeshGroupMidpointMeshes(MeshGroup& meshGroup);
 
         // Post processing
+        void finalizeSceneData();
         void prepareDisplacementMaps();
         void prepareSceneGraph();
         void prepareMeshes();
@@ -808,6 +808,10 @@ namespace Falcor
         stream.write(pGridVolume->mNodeID);
 
         stream.write(pGridVolume->mName);
+        if (std::any_of(pGridVolume->mStreams.begin(), pGridVolume->mStreams.end(), [](const auto& pStream) { return pStream != nullptr; }))
+        {
+            logWarning("Grid volume '{}' uses streamed grid sequences, which are not stored in the scene cache.", pGridVolume->mName);
+        }
         for (const auto& gridSequence : pGridVolume->mGrids)
         {
             stream.write((uint32_t)gridSequence.size());
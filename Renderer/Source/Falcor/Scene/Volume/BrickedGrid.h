@@ -35,4 +35,34 @@ namespace Falcor
         Texture::SharedPtr indirection;
         Texture::SharedPtr atlas;
     };
+
+    /** Host-side brick data of a grid.
+        This is the result of the brick conversion before any GPU resources are created,
+        which allows the conversion to run on worker threads.
+    */
+    struct BrickedGridData
+    {
+        uint3 leafDim = uint3(0);                   ///< Size of the range and indirection textures.
+        uint3 atlasSize = uint3(0);                 ///< Size of the atlas texture in pixels.
+        ResourceFormat atlasFormat = ResourceFormat::Unknown;
+        std::vector<uint32_t> rangeData;            ///< Range texture data, including 4 mip levels.
+        std::vector<uint32_t> indirectionData;      ///< Indirection texture data.
+        std::vector<uint8_t> atlasData;             ///< Atlas texture data.
+
+        uint64_t getSizeInBytes() const
+        {
+            return rangeData.size() * sizeof(uint32_t) + indirectionData.size() * sizeof(uint32_t) + atlasData.size();
+        }
+
+        /** Create the GPU textures. Must be called from the thread owning the render context.
+        */
+        BrickedGrid createTextures() const
+        {
+            BrickedGrid bricks;
+            bricks.range = Texture::create3D(leafDim.x, leafDim.y, leafDim.z, ResourceFormat::RG16Float, 4, rangeData.data(), ResourceBindFlags::ShaderResource, false);
+            bricks.indirection = Texture::create3D(leafDim.x, leafDim.y, leafDim.z, ResourceFormat::RGBA8Uint, 1, indirectionData.data(), ResourceBindFlags::ShaderResource, false);
+            bricks.atlas = Texture::create3D(atlasSize.x, atlasSize.y, atlasSize.z, atlasFormat, 1, atlasData.data(), ResourceBindFlags::ShaderResource, false);
+            return bricks;
+        }
+    };
 }
@@ -73,26 +73,19 @@ namespace Falcor
 
     Grid::SharedPtr Grid::createFromFile(const std::filesystem::path& path, const std::string& gridname)
     {
-        std::filesystem::path fullPath;
-        if (!findFileInDataDirectories(path, fullPath))
-        {
-            logWarning("Error when loading grid. Can't find grid file '{}'.", path);
-            return nullptr;
-        }
+        auto handle = readGridFromFile(path, gridname);
+        return handle ? SharedPtr(new Grid(std::move(handle))) : nullptr;
+    }
 
-        if (hasExtension(fullPath, "nvdb"))
-        {
-            return createFromNanoVDBFile(fullPath, gridname);
-        }
-        else if (hasExtension(fullPath, "vdb"))
-        {
-            return createFromOpenVDBFile(fullPath, gridname);
-        }
-        else
-        {
-            logWarning("Error when loading grid. Unsupported grid file '{}'.", fullPath);
-            return nullptr;
-        }
+    std::unique_ptr<Grid::HostData> Grid::loadHostData(const std::filesystem::path& path, const std::string& gridname)
+    {
+        auto handle = readGridFromFile(path, gridname);
+        return handle ? std::make_unique<HostData>(createHostData(std::move(handle))) : nullptr;
+    }
+
+    Grid::SharedPtr Grid::createFromHostData(HostData&& data)
+    {
+        return SharedPtr(new Grid(std::move(data)));
     }
 
     void Grid::renderUI(Gui::Widgets& widget)
@@ -186,15 +179,14 @@ namespace Falcor
     }
 
     Grid::Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
-        : mGridHandle(std::move(gridHandle))
+        : Grid(createHostData(std::move(gridHandle)))
+    {}
+
+    Grid::Grid(HostData&& data)
+        : mGridHandle(std::move(data.gridHandle))
         , mpFloatGrid(mGridHandle.grid<float>())
         , mAccessor(mpFloatGrid->getAccessor())
     {
-        if (!mpFloatGrid->hasMinMax())
-        {
-            nanovdb::gridStats(*mpFloatGrid);
-        }
-
         // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
         mpBuffer = Buffer::createStructured(
             sizeof(uint32_t),
@@ -203,42 +195,81 @@ namespace Falcor
             Buffer::CpuAccess::None,
             mGridHandle.data()
         );
+        mBrickedGrid = data.bricks.createTextures();
+    }
+
+    Grid::HostData Grid::createHostData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    {
+        HostData data;
+        data.gridHandle = std::move(gridHandle);
+
+        auto pFloatGrid = data.gridHandle.grid<float>();
+        if (!pFloatGrid->hasMinMax())
+        {
+            nanovdb::gridStats(*pFloatGrid);
+        }
+
         using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert();
+        data.bricks = NanoVDBGridConverter(pFloatGrid).convertToHost();
+        return data;
+    }
+
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readGridFromFile(const std::filesystem::path& path, const std::string& gridname)
+    {
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath))
+        {
+            logWarning("Error when loading grid. Can't find grid file '{}'.", path);
+            return {};
+        }
+
+        if (hasExtension(fullPath, "nvdb"))
+        {
+            return readNanoVDBFile(fullPath, gridname);
+        }
+        else if (hasExtension(fullPath, "vdb"))
+        {
+            return readOpenVDBFile(fullPath, gridname);
+        }
+        else
+        {
+            logWarning("Error when loading grid. Unsupported grid file '{}'.", fullPath);
+            return {};
+        }
     }
 
-    Grid::SharedPtr Grid::createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         auto handle = nanovdb::io::readGrid(path.string(), gridname);
         if (!handle)
         {
             logWarning("Error when loading grid.");
-            return nullptr;
+            return {};
         }
 
         auto floatGrid = handle.grid<float>();
         if (!floatGrid || floatGrid->gridType() != nanovdb::GridType::Float)
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (floatGrid->isEmpty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
-        return SharedPtr(new Grid(std::move(handle)));
+        return handle;
     }
 
-    Grid::SharedPtr Grid::createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         openvdb::initialize();
 
@@ -260,25 +291,23 @@ namespace Falcor
         if (!baseGrid)
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (!baseGrid->isType<openvdb::FloatGrid>())
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (baseGrid->empty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
-        auto handle = nanovdb::openToNanoVDB(floatGrid);
-
-        return SharedPtr(new Grid(std::move(handle)));
+        return nanovdb::openToNanoVDB(floatGrid);
     }
 
 
@@ -45,6 +45,19 @@ namespace Falcor
     public:
         using SharedPtr = std::shared_ptr<Grid>;
 
+        /** Grid data loaded and converted to bricks on the host.
+            Host data can be loaded on any thread. The GPU resources are created by createFromHostData().
+        */
+        struct HostData
+        {
+            nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle;
+            BrickedGridData bricks;
+
+            /** Get the size of the host data in bytes.
+            */
+            uint64_t getSizeInBytes() const { return gridHandle.size() + bricks.getSizeInBytes(); }
+        };
+
         /** Create a sphere voxel grid.
             \param[in] radius Radius of the sphere in world units.
             \param[in] voxelSize Size of a voxel in world units.
@@ -71,6 +84,20 @@ namespace Falcor
         */
         static SharedPtr createFromFile(const std::filesystem::path& path, const std::string& gridname);
 
+        /** Load a grid from a file and convert it to bricks without creating any GPU resources.
+            This function is thread-safe.
+            \param[in] path File path of the grid. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \return The host data, or nullptr if the grid failed to load.
+        */
+        static std::unique_ptr<HostData> loadHostData(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Create a grid from host data. This uploads the grid to the GPU.
+            \param[in] data Host data, see loadHostData().
+            \return A new grid.
+        */
+        static SharedPtr createFromHostData(HostData&& data);
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -128,9 +155,12 @@ namespace Falcor
 
     private:
         Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        Grid(HostData&& data);
 
-        static SharedPtr createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
-        static SharedPtr createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static HostData createHostData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readGridFromFile(const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
 
         // Host data.
         nanovdb::GridHandle<nanovdb::HostBuffer> mGridHandle;
@@ -49,8 +49,14 @@ namespace Falcor
         NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid);
         NanoVDBToBricksConverter(const NanoVDBToBricksConverter& rhs) = delete;
 
+        /** Convert the grid to bricks and create the GPU textures.
+        */
         BrickedGrid convert();
 
+        /** Convert the grid to bricks on the host only. This is safe to call from worker threads.
+        */
+        BrickedGridData convertToHost();
+
     private:
         const static uint kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int kBC4Compress = kBitsPerTexel == 4;
@@ -95,7 +101,7 @@ namespace Falcor
         uint32_t mLeafCount[4];
         std::vector<uint32_t> mRangeData;
         std::vector<uint32_t> mPtrData;
-        std::vector<TexelType> mAtlasData;
+        std::vector<uint8_t> mAtlasData; // Stored as bytes, accessed as TexelType.
         std::atomic_uint32_t mNonEmptyCount;
     };
 
@@ -122,7 +128,7 @@ namespace Falcor
         uint leafTexelCount = atlasSizePixels.x * atlasSizePixels.y * atlasSizePixels.z;
         mRangeData.resize(mLeafCount[3]);
         mPtrData.resize(mLeafCount[0]);
-        mAtlasData.resize(kBC4Compress ? (leafTexelCount / 16) : leafTexelCount);
+        mAtlasData.resize((kBC4Compress ? (leafTexelCount / 16) : leafTexelCount) * sizeof(TexelType));
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
@@ -268,8 +274,8 @@ namespace Falcor
         } // z
     }
 
-    template <typename TexelType, unsigned int kBitsPerTexel> typename
-    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert()
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGridData NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertToHost()
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
         auto range = NumericRange<int>(0, mLeafDim[0].z);
@@ -278,10 +284,19 @@ namespace Falcor
         double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
         logInfo("converted in {}ms: mNonEmptyCount {} vs max {}", dt, mNonEmptyCount, getAtlasMaxBrick());
 
-        BrickedGrid bricks;
-        bricks.range = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.indirection = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.atlas = Texture::create3D(getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource, false);
-        return bricks;
+        BrickedGridData data;
+        data.leafDim = uint3(mLeafDim[0]);
+        data.atlasSize = getAtlasSizePixels();
+        data.atlasFormat = getAtlasFormat();
+        data.rangeData = std::move(mRangeData);
+        data.indirectionData = std::move(mPtrData);
+        data.atlasData = std::move(mAtlasData);
+        return data;
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert()
+    {
+        return convertToHost().createTextures();
     }
 }
@@ -0,0 +1,297 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "GridSequenceStream.h"
+
+namespace Falcor
+{
+    GridSequenceStream::SharedPtr GridSequenceStream::create(const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options)
+    {
+        return SharedPtr(new GridSequenceStream(paths, gridname, options));
+    }
+
+    GridSequenceStream::GridSequenceStream(const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options)
+        : mPaths(paths)
+        , mGridname(gridname)
+        , mOptions(options)
+        , mFrames(paths.size())
+    {
+        for (uint32_t i = 0; i < std::max(1u, mOptions.threadCount); ++i)
+        {
+            mThreads.emplace_back(&GridSequenceStream::runWorker, this);
+        }
+    }
+
+    GridSequenceStream::~GridSequenceStream()
+    {
+        terminateWorkers();
+    }
+
+    void GridSequenceStream::renderUI(Gui::Widgets& widget)
+    {
+        std::ostringstream oss;
+        oss << "Resident frames: " << mStats.residentFrameCount << " / " << getFrameCount() << std::endl
+            << "Memory: " << formatByteSize(mStats.memoryUsage) << " / " << formatByteSize(mOptions.memoryBudget) << std::endl
+            << "Hits: " << mStats.hitCount << std::endl
+            << "Misses: " << mStats.missCount << std::endl
+            << "Prefetched: " << mStats.prefetchCount << std::endl
+            << "Evictions: " << mStats.evictionCount << std::endl;
+        widget.text(oss.str());
+
+        uint32_t memoryBudgetMB = (uint32_t)(mOptions.memoryBudget >> 20);
+        if (widget.var("Memory budget (MB)", memoryBudgetMB, 1u, std::numeric_limits<uint32_t>::max(), 64u)) setMemoryBudget((uint64_t)memoryBudgetMB << 20);
+    }
+
+    Grid::SharedPtr GridSequenceStream::getGrid(uint32_t frame, int direction)
+    {
+        checkArgument(frame < getFrameCount(), "'frame' ({}) is out of range.", frame);
+
+        mCurrentFrame = frame;
+        collectPendingFrames();
+
+        Frame& f = mFrames[frame];
+        if (f.state == FrameState::Resident || f.state == FrameState::Failed)
+        {
+            mStats.hitCount++;
+            if (f.state == FrameState::Resident) mLRU.splice(mLRU.end(), mLRU, f.lruIt);
+        }
+        else
+        {
+            mStats.missCount++;
+
+            // Load the frame on this thread unless a worker has already started loading it.
+            bool loadNow = f.state == FrameState::Empty;
+            if (f.state == FrameState::Pending)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                auto it = std::find_if(mLoadRequestQueue.begin(), mLoadRequestQueue.end(), [frame](const LoadRequest& r) { return r.frame == frame; });
+                if (it != mLoadRequestQueue.end())
+                {
+                    mLoadRequestQueue.erase(it);
+                    loadNow = true;
+                }
+            }
+
+            HostDataPtr pData;
+            try
+            {
+                pData = loadNow ? Grid::loadHostData(mPaths[frame], mGridname) : f.future.get();
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to load grid '{}' from '{}': {}", mGridname, mPaths[frame], e.what());
+            }
+            f.future = {};
+            makeResident(frame, std::move(pData));
+        }
+
+        evict(frame);
+        if (direction != 0) prefetch(frame, direction);
+
+        return f.pGrid;
+    }
+
+    bool GridSequenceStream::isResident(uint32_t frame) const
+    {
+        return frame < getFrameCount() && mFrames[frame].state == FrameState::Resident;
+    }
+
+    void GridSequenceStream::setMemoryBudget(uint64_t memoryBudget)
+    {
+        mOptions.memoryBudget = memoryBudget;
+        evict(mCurrentFrame);
+    }
+
+    void GridSequenceStream::makeResident(uint32_t frame, HostDataPtr pData)
+    {
+        Frame& f = mFrames[frame];
+        FALCOR_ASSERT(f.state != FrameState::Resident);
+
+        if (!pData)
+        {
+            f.state = FrameState::Failed;
+            return;
+        }
+
+        f.pGrid = Grid::createFromHostData(std::move(*pData));
+        f.memoryUsage = f.pGrid->getGridHandle().size() + f.pGrid->getGridSizeInBytes();
+        f.lruIt = mLRU.insert(mLRU.end(), frame);
+        f.state = FrameState::Resident;
+
+        mStats.memoryUsage += f.memoryUsage;
+        mStats.residentFrameCount++;
+    }
+
+    void GridSequenceStream::collectPendingFrames()
+    {
+        for (uint32_t frame = 0; frame < getFrameCount(); ++frame)
+        {
+            Frame& f = mFrames[frame];
+            if (f.state != FrameState::Pending || f.future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+
+            HostDataPtr pData;
+            try
+            {
+                pData = f.future.get();
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to load grid '{}' from '{}': {}", mGridname, mPaths[frame], e.what());
+            }
+            f.future = {};
+
+            // The upload to the GPU happens here, on the thread owning the render context.
+            makeResident(frame, std::move(pData));
+            mStats.prefetchCount++;
+        }
+    }
+
+    void GridSequenceStream::prefetch(uint32_t frame, int direction)
+    {
+        const int64_t frameCount = getFrameCount();
+
+        // Frames following the current frame in the playback direction, wrapping around like the playback does.
+        std::vector<uint32_t> window;
+        for (uint32_t i = 1; i <= mOptions.prefetchCount && i < frameCount; ++i)
+        {
+            int64_t index = ((int64_t)frame + (direction > 0 ? 1 : -1) * (int64_t)i) % frameCount;
+            window.push_back((uint32_t)(index < 0 ? index + frameCount : index));
+        }
+
+        // Use the size of the current frame as estimate so prefetching doesn't evict the frames it loads.
+        const uint64_t frameSize = mFrames[frame].memoryUsage;
+        uint64_t memoryUsage = mStats.memoryUsage;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // Drop queued requests for frames that are no longer in the window.
+        for (auto it = mLoadRequestQueue.begin(); it != mLoadRequestQueue.end();)
+        {
+            if (std::find(window.begin(), window.end(), it->frame) == window.end())
+            {
+                Frame& f = mFrames[it->frame];
+                f.state = FrameState::Empty;
+                f.future = {};
+                it = mLoadRequestQueue.erase(it);
+            }
+            else ++it;
+        }
+
+        for (uint32_t prefetchFrame : window)
+        {
+            Frame& f = mFrames[prefetchFrame];
+            if (f.state == FrameState::Resident)
+            {
+                // Upcoming frames are used after the current frame, so they are evicted after it.
+                mLRU.splice(mLRU.end(), mLRU, f.lruIt);
+            }
+            else if (f.state == FrameState::Pending)
+            {
+                memoryUsage += frameSize;
+            }
+            else if (f.state == FrameState::Empty)
+            {
+                if (memoryUsage + frameSize > mOptions.memoryBudget) break;
+                memoryUsage += frameSize;
+
+                LoadRequest request{ prefetchFrame };
+                f.future = request.promise.get_future();
+                f.state = FrameState::Pending;
+                mLoadRequestQueue.push_back(std::move(request));
+            }
+        }
+
+        mCondition.notify_all();
+    }
+
+    void GridSequenceStream::evict(uint32_t currentFrame)
+    {
+        auto it = mLRU.begin();
+        while (mStats.memoryUsage > mOptions.memoryBudget && it != mLRU.end())
+        {
+            uint32_t frame = *it;
+            if (frame == currentFrame)
+            {
+                ++it;
+                continue;
+            }
+
+            Frame& f = mFrames[frame];
+            it = mLRU.erase(it);
+            f.pGrid = nullptr;
+            f.state = FrameState::Empty;
+
+            mStats.memoryUsage -= f.memoryUsage;
+            mStats.residentFrameCount--;
+            mStats.evictionCount++;
+            f.memoryUsage = 0;
+        }
+    }
+
+    void GridSequenceStream::runWorker()
+    {
+        // This function is the entry point for worker threads.
+        // The workers wait on the load request queue and load and convert a grid when woken up.
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty(); });
+
+            if (mTerminate) break;
+
+            auto request = std::move(mLoadRequestQueue.front());
+            mLoadRequestQueue.pop_front();
+
+            lock.unlock();
+
+            // Load the grid (this part is running in parallel).
+            try
+            {
+                request.promise.set_value(Grid::loadHostData(mPaths[request.frame], mGridname));
+            }
+            catch (...)
+            {
+                request.promise.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    void GridSequenceStream::terminateWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+            mLoadRequestQueue.clear();
+        }
+
+        mCondition.notify_all();
+
+        for (auto& thread : mThreads) thread.join();
+    }
+}
@@ -0,0 +1,166 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Grid.h"
+#include <filesystem>
+#include <future>
+#include <deque>
+#include <list>
+
+namespace Falcor
+{
+    /** Streams a sequence of grids from files, keeping only a window of frames resident.
+
+        Frames ahead of the current frame in the playback direction are prefetched on worker threads.
+        The workers read the grid files and convert them to bricks, only the GPU upload happens on the
+        thread calling getGrid(). The memory used by resident frames (host and GPU) is bounded by a budget,
+        and the least recently used frames are evicted first. The current frame is never evicted.
+
+        All functions except the workers must be called from the same thread.
+    */
+    class FALCOR_API GridSequenceStream
+    {
+    public:
+        using SharedPtr = std::shared_ptr<GridSequenceStream>;
+
+        struct Options
+        {
+            uint64_t memoryBudget = 4ull << 30;     ///< Memory budget for resident frames in bytes.
+            uint32_t prefetchCount = 4;             ///< Number of frames to prefetch ahead of the current frame.
+            uint32_t threadCount = 2;               ///< Number of worker threads.
+        };
+
+        struct Stats
+        {
+            uint64_t hitCount = 0;                  ///< Number of requests for frames that were resident.
+            uint64_t missCount = 0;                 ///< Number of requests that had to wait for a frame to load.
+            uint64_t prefetchCount = 0;             ///< Number of frames loaded by prefetching.
+            uint64_t evictionCount = 0;             ///< Number of evicted frames.
+            uint64_t memoryUsage = 0;               ///< Memory used by resident frames in bytes.
+            uint32_t residentFrameCount = 0;        ///< Number of resident frames.
+        };
+
+        /** Create a grid sequence stream.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return A new object.
+        */
+        static SharedPtr create(const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options = Options());
+
+        /** Destructor.
+            Blocks until all worker threads have terminated.
+        */
+        ~GridSequenceStream();
+
+        /** Render the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+        /** Get the number of frames in the sequence.
+        */
+        uint32_t getFrameCount() const { return (uint32_t)mFrames.size(); }
+
+        /** Get the grid of a frame.
+            Loads the frame if it is not resident, and schedules prefetching of the frames following it.
+            \param[in] frame Frame index.
+            \param[in] direction Playback direction (1 = forward, -1 = backward, 0 = no prefetching).
+            \return The grid, or nullptr if the grid failed to load.
+        */
+        Grid::SharedPtr getGrid(uint32_t frame, int direction = 1);
+
+        /** Check if a frame is resident.
+        */
+        bool isResident(uint32_t frame) const;
+
+        /** Set the memory budget in bytes.
+        */
+        void setMemoryBudget(uint64_t memoryBudget);
+
+        /** Get the memory budget in bytes.
+        */
+        uint64_t getMemoryBudget() const { return mOptions.memoryBudget; }
+
+        /** Get the streaming statistics.
+        */
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        GridSequenceStream(const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options);
+
+        using HostDataPtr = std::unique_ptr<Grid::HostData>;
+
+        enum class FrameState
+        {
+            Empty,      ///< Frame is not loaded.
+            Pending,    ///< Frame is queued or being loaded by a worker.
+            Resident,   ///< Frame is resident.
+            Failed,     ///< Frame failed to load.
+        };
+
+        struct Frame
+        {
+            FrameState state = FrameState::Empty;
+            std::future<HostDataPtr> future;        ///< Future for pending frames.
+            Grid::SharedPtr pGrid;                  ///< Grid of resident frames.
+            uint64_t memoryUsage = 0;               ///< Memory usage of resident frames.
+            std::list<uint32_t>::iterator lruIt;    ///< Position in the LRU list of resident frames.
+        };
+
+        struct LoadRequest
+        {
+            uint32_t frame;
+            std::promise<HostDataPtr> promise;
+        };
+
+        void makeResident(uint32_t frame, HostDataPtr pData);
+        void collectPendingFrames();
+        void prefetch(uint32_t frame, int direction);
+        void evict(uint32_t currentFrame);
+
+        void runWorker();
+        void terminateWorkers();
+
+        std::vector<std::filesystem::path> mPaths;
+        std::string mGridname;
+        Options mOptions;
+        Stats mStats;
+
+        std::vector<Frame> mFrames;
+        std::list<uint32_t> mLRU;                   ///< Resident frames, least recently used first.
+        uint32_t mCurrentFrame = 0;                 ///< Most recently requested frame.
+
+        std::mutex mMutex;                          ///< Mutex for synchronizing access to the request queue.
+        std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
+        std::vector<std::thread> mThreads;          ///< Worker threads.
+
+        // Internal state. Do not access outside of critical section.
+        std::deque<LoadRequest> mLoadRequestQueue;  ///< Load request queue.
+        bool mTerminate = false;                    ///< Flag to terminate worker threads.
+    };
+}
@@ -44,6 +44,41 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+
+        const char* kSlotNames[] = { "Density", "Emission" };
+        static_assert(std::size(kSlotNames) == (size_t)GridVolume::GridSlot::Count);
+
+        bool findGridFiles(const std::filesystem::path& path, std::vector<std::filesystem::path>& paths)
+        {
+            std::filesystem::path fullPath;
+            if (!findFileInDataDirectories(path, fullPath))
+            {
+                logWarning("Cannot find directory '{}'.", path);
+                return false;
+            }
+            if (!std::filesystem::is_directory(fullPath))
+            {
+                logWarning("'{}' is not a directory.", path);
+                return false;
+            }
+
+            // Enumerate grid files.
+            for (auto p : std::filesystem::directory_iterator(fullPath))
+            {
+                const auto& path = p.path();
+                if (hasExtension(path, "nvdb") || hasExtension(path, "vdb")) paths.push_back(path);
+            }
+
+            // Sort by length first, then alpha-numerically.
+            auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
+                auto sa = a.string();
+                auto sb = b.string();
+                return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
+            };
+            std::sort(paths.begin(), paths.end(), cmp);
+
+            return true;
+        }
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -78,6 +113,12 @@ namespace Falcor
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
         }
 
+        for (size_t slotIndex = 0; slotIndex < mStreams.size(); ++slotIndex)
+        {
+            if (!mStreams[slotIndex]) continue;
+            if (auto group = widget.group(std::string(kSlotNames[slotIndex]) + " Grid Streaming")) mStreams[slotIndex]->renderUI(group);
+        }
+
         if (const auto& densityGrid = getDensityGrid())
         {
             if (auto group = widget.group("Density Grid")) densityGrid->renderUI(group);
@@ -137,35 +178,40 @@ namespace Falcor
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
     {
-        std::filesystem::path fullPath;
-        if (!findFileInDataDirectories(path, fullPath))
-        {
-            logWarning("Cannot find directory '{}'.", path);
-            return 0;
-        }
-        if (!std::filesystem::is_directory(fullPath))
-        {
-            logWarning("'{}' is not a directory.", path);
-            return 0;
-        }
+        std::vector<std::filesystem::path> paths;
+        if (!findGridFiles(path, paths)) return 0;
+        return loadGridSequence(slot, paths, gridname, keepEmpty);
+    }
 
-        // Enumerate grid files.
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridSequenceStream::Options& options)
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        mGrids[slotIndex].clear();
+        mStreams[slotIndex] = paths.empty() ? nullptr : GridSequenceStream::create(paths, gridname, options);
+        mStreamedGrids[slotIndex] = nullptr;
+        updateSequence();
+        updateStreamedGrids();
+        updateBounds();
+        markUpdates(UpdateFlags::GridsChanged);
+
+        return (uint32_t)paths.size();
+    }
+
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridSequenceStream::Options& options)
+    {
         std::vector<std::filesystem::path> paths;
-        for (auto p : std::filesystem::directory_iterator(fullPath))
-        {
-            const auto& path = p.path();
-            if (hasExtension(path, "nvdb") || hasExtension(path, "vdb")) paths.push_back(path);
-        }
+        if (!findGridFiles(path, paths)) return 0;
+        return streamGridSequence(slot, paths, gridname, options);
+    }
 
-        // Sort by length first, then alpha-numerically.
-        auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
-            auto sa = a.string();
-            auto sb = b.string();
-            return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
-        };
-        std::sort(paths.begin(), paths.end(), cmp);
+    const GridSequenceStream::SharedPtr& GridVolume::getGridSequenceStream(GridSlot slot) const
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        return loadGridSequence(slot, paths, gridname, keepEmpty);
+        return mStreams[slotIndex];
     }
 
     void GridVolume::setGridSequence(GridSlot slot, const GridSequence& grids)
@@ -173,9 +219,11 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        if (mGrids[slotIndex] != grids)
+        if (mGrids[slotIndex] != grids || mStreams[slotIndex])
         {
             mGrids[slotIndex] = grids;
+            mStreams[slotIndex] = nullptr;
+            mStreamedGrids[slotIndex] = nullptr;
             updateSequence();
             updateBounds();
             markUpdates(UpdateFlags::GridsChanged);
@@ -202,6 +250,8 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
+        if (mStreams[slotIndex]) return mStreamedGrids[slotIndex];
+
         const auto& gridSequence = mGrids[slotIndex];
         uint32_t gridIndex = std::min(mGridFrame, (uint32_t)gridSequence.size() - 1);
         return gridSequence.empty() ? kNullGrid : gridSequence[gridIndex];
@@ -214,6 +264,10 @@ namespace Falcor
         {
             std::copy_if(grids.begin(), grids.end(), std::inserter(uniqueGrids, uniqueGrids.begin()), [] (const auto& grid) { return grid != nullptr; });
         }
+        for (const auto& grid : mStreamedGrids)
+        {
+            if (grid) uniqueGrids.insert(grid);
+        }
         return std::vector<Grid::SharedPtr>(uniqueGrids.begin(), uniqueGrids.end());
     }
 
@@ -222,6 +276,7 @@ namespace Falcor
         if (mGridFrame != gridFrame)
         {
             mGridFrame = gridFrame;
+            updateStreamedGrids();
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -242,6 +297,8 @@ namespace Falcor
         uint32_t frameCount = getGridFrameCount();
         if (mPlaybackEnabled && frameCount > 0)
         {
+            if (currentTime != mPlaybackTime) mPlaybackDirection = currentTime > mPlaybackTime ? 1 : -1;
+            mPlaybackTime = currentTime;
             uint32_t frameIndex = (uint32_t)std::floor(std::max(0.0, currentTime) * mFrameRate) % frameCount;
             setGridFrame(frameIndex);
         }
@@ -323,9 +380,26 @@ namespace Falcor
     {
         mGridFrameCount = 1;
         for (const auto& grids : mGrids) mGridFrameCount = std::max(mGridFrameCount, (uint32_t)grids.size());
+        for (const auto& pStream : mStreams)
+        {
+            if (pStream) mGridFrameCount = std::max(mGridFrameCount, pStream->getFrameCount());
+        }
         setGridFrame(std::min(mGridFrame, mGridFrameCount - 1));
     }
 
+    void GridVolume::updateStreamedGrids()
+    {
+        for (size_t slotIndex = 0; slotIndex < mStreams.size(); ++slotIndex)
+        {
+            const auto& pStream = mStreams[slotIndex];
+            if (!pStream || pStream->getFrameCount() == 0) continue;
+
+            // Keep showing the last valid grid if the frame failed to load.
+            uint32_t frame = std::min(mGridFrame, pStream->getFrameCount() - 1);
+            if (auto pGrid = pStream->getGrid(frame, mPlaybackEnabled ? mPlaybackDirection : 0)) mStreamedGrids[slotIndex] = pGrid;
+        }
+    }
+
     void GridVolume::updateBounds()
     {
         AABB bounds;
@@ -386,6 +460,14 @@ namespace Falcor
         volume.def("loadGridSequence",
             pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, bool>(&GridVolume::loadGridSequence),
             "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
+        auto streamGridSequence = [](GridVolume& volume, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname, uint32_t memoryBudgetMB, uint32_t prefetchCount)
+        {
+            GridSequenceStream::Options options;
+            options.memoryBudget = (uint64_t)memoryBudgetMB << 20;
+            options.prefetchCount = prefetchCount;
+            return volume.streamGridSequence(slot, path, gridname, options);
+        };
+        volume.def("streamGridSequence", streamGridSequence, "slot"_a, "path"_a, "gridname"_a, "memoryBudgetMB"_a = 4096, "prefetchCount"_a = 4);
 
         pybind11::enum_<GridVolume::GridSlot> gridSlot(volume, "GridSlot");
         gridSlot.value("Density", GridVolume::GridSlot::Density);
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Grid.h"
+#include "GridSequenceStream.h"
 #include "GridVolumeData.slang"
 #include "Scene/Animation/Animatable.h"
 
@@ -38,7 +39,8 @@ namespace Falcor
         The absorbing/scattering medium is defined by a density voxel grid and additional parameters.
         The emission is defined by an emission voxel grid and additional parameters.
         Grids are stored in grid slots (density, emission) and can either be static, using one grid per slot,
-        or dynamic, using a sequence of grids per slot.
+        or dynamic, using a sequence of grids per slot. Long sequences can be streamed, in which case only
+        a window of frames around the current frame is resident (see GridSequenceStream).
     */
     class FALCOR_API GridVolume : public Animatable
     {
@@ -131,11 +133,38 @@ namespace Falcor
         */
         uint32_t loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty = true);
 
+        /** Stream a sequence of grids from files to a grid slot.
+            Only a window of frames around the current grid frame is kept resident, within the memory budget given in the options.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the sequence.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridSequenceStream::Options& options = {});
+
+        /** Stream a sequence of grids from a directory to a grid slot.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] path Directory containing grid files. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the sequence.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridSequenceStream::Options& options = {});
+
+        /** Get the grid sequence stream for the specified slot.
+            \return The stream, or nullptr if the slot is not streamed.
+        */
+        const GridSequenceStream::SharedPtr& getGridSequenceStream(GridSlot slot) const;
+
         /** Set the grid sequence for the specified slot.
         */
         void setGridSequence(GridSlot slot, const GridSequence& grids);
 
         /** Get the grid sequence for the specified slot.
+            Note: This is empty for streamed slots.
         */
         const GridSequence& getGridSequence(GridSlot slot) const;
 
@@ -149,6 +178,7 @@ namespace Falcor
         const Grid::SharedPtr& getGrid(GridSlot slot) const;
 
         /** Get a list of all grids used for this volume.
+            For streamed slots, only the grid of the current frame is included.
         */
         std::vector<Grid::SharedPtr> getAllGrids() const;
 
@@ -182,6 +212,7 @@ namespace Falcor
         bool isPlaybackEnabled() const { return mPlaybackEnabled; }
 
         /** Update the selected grid frame based on global time in seconds.
+            The direction of time also sets the direction in which streamed grid sequences are prefetched.
         */
         void updatePlayback(double curentTime);
 
@@ -263,6 +294,7 @@ namespace Falcor
         GridVolume(const std::string& name);
 
         void updateSequence();
+        void updateStreamedGrids();
         void updateBounds();
 
         void markUpdates(UpdateFlags updates);
@@ -270,10 +302,14 @@ namespace Falcor
 
         std::string mName;
         std::array<GridSequence, (size_t)GridSlot::Count> mGrids;
+        std::array<GridSequenceStream::SharedPtr, (size_t)GridSlot::Count> mStreams;
+        std::array<Grid::SharedPtr, (size_t)GridSlot::Count> mStreamedGrids;   ///< Grids of the current frame in streamed slots.
         uint32_t mGridFrame = 0;
         uint32_t mGridFrameCount = 1;
         double mFrameRate = 30.f;
         bool mPlaybackEnabled = false;
+        double mPlaybackTime = 0.0;
+        int mPlaybackDirection = 1;
         AABB mBounds;
         GridVolumeData mData;
         mutable UpdateFlags mUpdates = UpdateFlags::None;
@@ -32,6 +32,7 @@
 namespace Falcor
 {
     static const char kShaderFile[] = "Utils/Algorithm/ParallelReduction.cs.slang";
+    static const uint32_t kMaxResultSize = 2 * sizeof(uint4);
 
     ComputeParallelReduction::SharedPtr ComputeParallelReduction::create()
     {
@@ -201,8 +202,88 @@ namespace Falcor
         }
     }
 
+    template<typename T>
+    void ComputeParallelReduction::executeAsync(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, uint64_t tag)
+    {
+        if (!mpReadbackBuffer)
+        {
+            mpReadbackBuffer = Buffer::create(kAsyncSlotCount * kMaxResultSize, ResourceBindFlags::None, Buffer::CpuAccess::Read);
+            mpReadbackBuffer->setName("ComputeParallelReduction::mpReadbackBuffer");
+            mpReadbackFence = GpuFence::create();
+        }
+
+        // Free up the oldest slot. This only stalls if results are not fetched regularly.
+        if (mReadbackRing.isFull())
+        {
+            mpReadbackFence->syncCpu(mReadbackRing.front().fenceValue);
+            bool success = readAsyncResult(mReadbackRing.front().fenceValue);
+            FALCOR_ASSERT(success);
+        }
+
+        uint32_t slot = mReadbackRing.getNextSlot();
+        execute<T>(pRenderContext, pInput, operation, nullptr, mpReadbackBuffer, slot * kMaxResultSize);
+        mAsyncResultSizes[slot] = operation == Type::MinMax ? 2 * sizeof(T) : sizeof(T);
+
+        // Submit the work and signal the fence without waiting.
+        pRenderContext->flush(false);
+        uint64_t fenceValue = mpReadbackFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+        mReadbackRing.push(tag, fenceValue);
+    }
+
+    template<typename T>
+    bool ComputeParallelReduction::getAsyncResult(T* pResult, uint64_t* pTag)
+    {
+        FALCOR_ASSERT(pResult);
+        if (mReadyResults.empty() && !mReadbackRing.isEmpty())
+        {
+            readAsyncResult(mpReadbackFence->getGpuValue());
+        }
+        if (mReadyResults.empty()) return false;
+
+        const AsyncResult& result = mReadyResults.front();
+        FALCOR_ASSERT(result.size % sizeof(T) == 0);
+        std::memcpy(pResult, result.data, result.size);
+        if (pTag) *pTag = result.tag;
+        mReadyResults.pop_front();
+        return true;
+    }
+
+    void ComputeParallelReduction::discardAsyncResults()
+    {
+        // The GPU may still write to pending slots, but it does so in submission order,
+        // so slots reused by later calls to executeAsync() end up with the right data.
+        mReadbackRing.clear();
+        mReadyResults.clear();
+    }
+
+    bool ComputeParallelReduction::readAsyncResult(uint64_t completedFenceValue)
+    {
+        auto entry = mReadbackRing.pop(completedFenceValue);
+        if (!entry) return false;
+
+        AsyncResult result;
+        result.tag = entry->tag;
+        result.size = mAsyncResultSizes[entry->slot];
+
+        const uint8_t* pData = static_cast<const uint8_t*>(mpReadbackBuffer->map(Buffer::MapType::Read));
+        FALCOR_ASSERT(pData);
+        std::memcpy(result.data, pData + entry->slot * kMaxResultSize, result.size);
+        mpReadbackBuffer->unmap();
+
+        mReadyResults.push_back(result);
+        return true;
+    }
+
     // Explicit template instantiation of the supported types.
     template FALCOR_API void ComputeParallelReduction::execute<float4>(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, float4* pResult, Buffer::SharedPtr pResultBuffer, uint64_t resultOffset);
     template FALCOR_API void ComputeParallelReduction::execute<int4>(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, int4* pResult, Buffer::SharedPtr pResultBuffer, uint64_t resultOffset);
     template FALCOR_API void ComputeParallelReduction::execute<uint4>(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, uint4* pResult, Buffer::SharedPtr pResultBuffer, uint64_t resultOffset);
+
+    template FALCOR_API void ComputeParallelReduction::executeAsync<float4>(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, uint64_t tag);
+    template FALCOR_API void ComputeParallelReduction::executeAsync<int4>(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, uint64_t tag);
+    template FALCOR_API void ComputeParallelReduction::executeAsync<uint4>(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, uint64_t tag);
+
+    template FALCOR_API bool ComputeParallelReduction::getAsyncResult<float4>(float4* pResult, uint64_t* pTag);
+    template FALCOR_API bool ComputeParallelReduction::getAsyncResult<int4>(int4* pResult, uint64_t* pTag);
+    template FALCOR_API bool ComputeParallelReduction::getAsyncResult<uint4>(uint4* pResult, uint64_t* pTag);
 }
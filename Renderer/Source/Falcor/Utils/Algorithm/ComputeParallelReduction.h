@@ -29,7 +29,10 @@
 #include "Core/Program/ComputeProgram.h"
 #include "Core/Program/ProgramVars.h"
 #include "Core/State/ComputeState.h"
+#include "Core/API/GpuFence.h"
 #include "Utils/Math/Vector.h"
+#include "ReadbackRing.h"
+#include <deque>
 
 namespace Falcor
 {
@@ -41,6 +44,10 @@ namespace Falcor
 
         The numerical error for the summation operation lies between pairwise
         summation (blocks of size n = 2) and naive running summation.
+
+        Results can be read back synchronously via execute(), which flushes the GPU,
+        or asynchronously via executeAsync()/getAsyncResult(), which deliver the
+        result a few frames later from a ring of readback slots without stalling.
     */
     class FALCOR_API ComputeParallelReduction
     {
@@ -85,9 +92,51 @@ namespace Falcor
         template<typename T>
         void execute(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, T* pResult = nullptr, Buffer::SharedPtr pResultBuffer = nullptr, uint64_t resultOffset = 0);
 
+        /** Perform parallel reduction with asynchronous readback of the result.
+            The result is copied to a slot in a readback ring and the command list is submitted
+            without waiting. Use getAsyncResult() to fetch results once the GPU is done.
+
+            If all slots are pending, the call waits for the oldest result, which is then kept
+            until fetched. Fetch results every frame to avoid this stall.
+
+            \param[in] pRenderContext The render context.
+            \param[in] pInput Input texture.
+            \param[in] operation Reduction operation.
+            \param[in] tag User-defined tag returned with the result, typically the frame index.
+        */
+        template<typename T>
+        void executeAsync(RenderContext* pRenderContext, const Texture::SharedPtr& pInput, Type operation, uint64_t tag);
+
+        /** Fetch the oldest finished asynchronous result. This call never stalls.
+            Results are returned in the order they were issued by executeAsync().
+            \param[out] pResult The result is stored here (one element for Sum, two for MinMax).
+            \param[out] pTag (Optional) The tag passed to executeAsync() is stored here.
+            \return True if a result was available, false otherwise.
+        */
+        template<typename T>
+        bool getAsyncResult(T* pResult, uint64_t* pTag = nullptr);
+
+        /** Get the number of asynchronous results that have been issued but not fetched yet.
+        */
+        uint32_t getPendingAsyncResultCount() const { return mReadbackRing.getPendingCount() + (uint32_t)mReadyResults.size(); }
+
+        /** Discard all asynchronous results that have not been fetched yet.
+        */
+        void discardAsyncResults();
+
+        static const uint32_t kAsyncSlotCount = 4;      ///< Number of readback slots for asynchronous results.
+
     private:
         ComputeParallelReduction();
         void allocate(uint32_t elementCount, uint32_t elementSize);
+        bool readAsyncResult(uint64_t completedFenceValue);
+
+        struct AsyncResult
+        {
+            uint64_t tag = 0;
+            uint32_t size = 0;
+            uint4 data[2];
+        };
 
         ComputeState::SharedPtr             mpState;
         ComputeProgram::SharedPtr           mpInitialProgram;
@@ -95,5 +144,12 @@ namespace Falcor
         ComputeVars::SharedPtr              mpVars;
 
         Buffer::SharedPtr                   mpBuffers[2];       ///< Intermediate buffers for reduction iterations.
+
+        // Asynchronous readback
+        Buffer::SharedPtr                   mpReadbackBuffer;   ///< Readback buffer with one slot per pending result (CPU mappable).
+        GpuFence::SharedPtr                 mpReadbackFence;    ///< Fence signaled after each asynchronous result.
+        ReadbackRing                        mReadbackRing = ReadbackRing(kAsyncSlotCount); ///< Bookkeeping for pending readback slots.
+        uint32_t                            mAsyncResultSizes[kAsyncSlotCount] = {}; ///< Result size in bytes per slot.
+        std::deque<AsyncResult>             mReadyResults;      ///< Results read back but not fetched yet.
     };
 }
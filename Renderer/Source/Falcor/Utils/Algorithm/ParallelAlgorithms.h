@@ -0,0 +1,384 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <execution>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Falcor
+{
+    /** Parallel algorithms on the CPU.
+
+        These are host-side counterparts to the GPU algorithms in Utils/Algorithm (PrefixSum,
+        BitonicSort, ParallelReduction) for use in CPU-side builders. The input is split into
+        one chunk per thread and the chunks are processed with std::execution::par, so all
+        algorithms share the standard library's thread pool. Small inputs are processed serially.
+
+        The threadCount argument limits the number of chunks (and thereby threads).
+        0 uses all logical cores.
+    */
+    namespace ParallelAlgorithms
+    {
+        /** Inputs smaller than this are processed on the calling thread.
+        */
+        static constexpr size_t kMinParallelCount = 1 << 14;
+
+        /** Get the number of chunks to split an input of a given size into.
+        */
+        inline uint32_t getChunkCount(size_t count, uint32_t threadCount)
+        {
+            if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+            if (count < kMinParallelCount) return 1;
+            return (uint32_t)std::min<size_t>(threadCount, (count + kMinParallelCount / 2 - 1) / (kMinParallelCount / 2));
+        }
+
+        /** Call func(chunkIndex, begin, end) for each chunk of [0, count), in parallel.
+        */
+        template<typename Func>
+        void forEachChunk(size_t count, uint32_t chunkCount, Func func)
+        {
+            if (chunkCount <= 1)
+            {
+                func(0u, (size_t)0, count);
+                return;
+            }
+
+            auto range = NumericRange<uint32_t>(0, chunkCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t chunk)
+            {
+                size_t begin = count * chunk / chunkCount;
+                size_t end = count * (chunk + 1) / chunkCount;
+                func(chunk, begin, end);
+            });
+        }
+
+        /** Sum of a range of values.
+            Uses four independent accumulators so the loop vectorizes and isn't bound by the add latency.
+        */
+        template<typename T>
+        T sumRange(const T* pData, size_t count)
+        {
+            T s0 = T(0), s1 = T(0), s2 = T(0), s3 = T(0);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                s0 += pData[i + 0];
+                s1 += pData[i + 1];
+                s2 += pData[i + 2];
+                s3 += pData[i + 3];
+            }
+            for (; i < count; i++) s0 += pData[i];
+            return (s0 + s1) + (s2 + s3);
+        }
+    }
+
+    /** Compute the exclusive prefix sum in parallel.
+        Each output element is pOutput[i] = initialValue + pInput[0] + ... + pInput[i-1].
+        The operation may be done in place (pInput == pOutput).
+        \param[in] pInput Input values.
+        \param[out] pOutput Output values.
+        \param[in] count Number of elements.
+        \param[in] initialValue Value added to all outputs.
+        \param[in] threadCount Maximum number of threads (0 uses all logical cores).
+        \return The sum of all elements plus initialValue.
+    */
+    template<typename T>
+    T parallelExclusiveScan(const T* pInput, T* pOutput, size_t count, T initialValue = T(0), uint32_t threadCount = 0)
+    {
+        static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+        const uint32_t chunkCount = ParallelAlgorithms::getChunkCount(count, threadCount);
+
+        // Sum of each chunk.
+        std::vector<T> chunkOffsets(chunkCount);
+        if (chunkCount > 1)
+        {
+            ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+            {
+                chunkOffsets[chunk] = ParallelAlgorithms::sumRange(pInput + begin, end - begin);
+            });
+        }
+
+        // Offset of each chunk.
+        T total = initialValue;
+        for (auto& offset : chunkOffsets)
+        {
+            T sum = offset;
+            offset = total;
+            total += sum;
+        }
+
+        // Scan within each chunk.
+        ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+        {
+            T sum = chunkOffsets[chunk];
+            for (size_t i = begin; i < end; i++)
+            {
+                T value = pInput[i];
+                pOutput[i] = sum;
+                sum += value;
+            }
+            if (chunkCount == 1) total = sum;
+        });
+
+        return total;
+    }
+
+    /** Sort keys and associated values in parallel using a stable LSD radix sort.
+        The sort uses 8-bit digits. Passes where all keys have the same digit are skipped,
+        so keys using only the low bits sort faster.
+        \param[in,out] pKeys Keys, must be 32-bit or 64-bit unsigned integers.
+        \param[in,out] pValues Values to reorder along with the keys. May be nullptr.
+        \param[in] count Number of elements.
+        \param[in] threadCount Maximum number of threads (0 uses all logical cores).
+    */
+    template<typename Key, typename Value>
+    void parallelRadixSort(Key* pKeys, Value* pValues, size_t count, uint32_t threadCount = 0)
+    {
+        static_assert(std::is_unsigned<Key>::value && (sizeof(Key) == 4 || sizeof(Key) == 8), "Key must be a 32-bit or 64-bit unsigned integer");
+        static constexpr uint32_t kRadix = 256;
+        static constexpr uint32_t kPassCount = sizeof(Key);
+
+        if (count <= 1) return;
+
+        const uint32_t chunkCount = ParallelAlgorithms::getChunkCount(count, threadCount);
+        const bool hasValues = pValues != nullptr;
+
+        std::vector<Key> tempKeys(count);
+        std::vector<Value> tempValues(hasValues ? count : 0);
+        Key* pSrcKeys = pKeys;
+        Key* pDstKeys = tempKeys.data();
+        Value* pSrcValues = pValues;
+        Value* pDstValues = tempValues.data();
+
+        // Per-chunk histograms, converted in place to per-chunk scatter offsets.
+        std::vector<size_t> offsets((size_t)chunkCount * kRadix);
+
+        for (uint32_t pass = 0; pass < kPassCount; pass++)
+        {
+            const uint32_t shift = pass * 8;
+
+            // Build histograms.
+            ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+            {
+                size_t* pHistogram = &offsets[(size_t)chunk * kRadix];
+                std::fill(pHistogram, pHistogram + kRadix, 0);
+                for (size_t i = begin; i < end; i++) pHistogram[(pSrcKeys[i] >> shift) & (kRadix - 1)]++;
+            });
+
+            // Skip the pass if all keys share the same digit.
+            bool skipPass = false;
+            for (uint32_t digit = 0; digit < kRadix && !skipPass; digit++)
+            {
+                size_t digitCount = 0;
+                for (uint32_t chunk = 0; chunk < chunkCount; chunk++) digitCount += offsets[(size_t)chunk * kRadix + digit];
+                if (digitCount == count) skipPass = true;
+                else if (digitCount != 0) break;
+            }
+            if (skipPass) continue;
+
+            // Compute scatter offsets, ordered by digit first, then by chunk to keep the sort stable.
+            size_t sum = 0;
+            for (uint32_t digit = 0; digit < kRadix; digit++)
+            {
+                for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+                {
+                    size_t& offset = offsets[(size_t)chunk * kRadix + digit];
+                    size_t digitCount = offset;
+                    offset = sum;
+                    sum += digitCount;
+                }
+            }
+
+            // Scatter.
+            ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+            {
+                size_t* pOffsets = &offsets[(size_t)chunk * kRadix];
+                for (size_t i = begin; i < end; i++)
+                {
+                    size_t dst = pOffsets[(pSrcKeys[i] >> shift) & (kRadix - 1)]++;
+                    pDstKeys[dst] = pSrcKeys[i];
+                    if (hasValues) pDstValues[dst] = std::move(pSrcValues[i]);
+                }
+            });
+
+            std::swap(pSrcKeys, pDstKeys);
+            std::swap(pSrcValues, pDstValues);
+        }
+
+        // Copy back if the sorted data ended up in the temporary buffers.
+        if (pSrcKeys != pKeys)
+        {
+            ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+            {
+                std::copy(pSrcKeys + begin, pSrcKeys + end, pKeys + begin);
+                if (hasValues) std::move(pSrcValues + begin, pSrcValues + end, pValues + begin);
+            });
+        }
+    }
+
+    /** Sort keys in parallel using a stable LSD radix sort.
+        \param[in,out] pKeys Keys, must be 32-bit or 64-bit unsigned integers.
+        \param[in] count Number of elements.
+        \param[in] threadCount Maximum number of threads (0 uses all logical cores).
+    */
+    template<typename Key>
+    void parallelRadixSort(Key* pKeys, size_t count, uint32_t threadCount = 0)
+    {
+        parallelRadixSort<Key, uint8_t>(pKeys, nullptr, count, threadCount);
+    }
+
+    /** Reduce segments of an array in parallel.
+        Segment i covers the elements [pSegmentOffsets[i], pSegmentOffsets[i + 1]).
+        \param[in] pValues Input values.
+        \param[in] pSegmentOffsets Start offset of each segment, followed by the end offset of the last segment (segmentCount + 1 entries).
+        \param[in] segmentCount Number of segments.
+        \param[out] pResults Reduced value of each segment (identity for empty segments).
+        \param[in] identity Identity element of the reduction operation.
+        \param[in] op Associative reduction operation T op(T, T).
+        \param[in] threadCount Maximum number of threads (0 uses all logical cores).
+    */
+    template<typename T, typename Offset, typename Op>
+    void parallelSegmentedReduce(const T* pValues, const Offset* pSegmentOffsets, size_t segmentCount, T* pResults, T identity, Op op, uint32_t threadCount = 0)
+    {
+        if (segmentCount == 0) return;
+
+        // Split by elements rather than by segments to balance the work when segment sizes vary.
+        const size_t elementCount = (size_t)(pSegmentOffsets[segmentCount] - pSegmentOffsets[0]);
+        const uint32_t chunkCount = ParallelAlgorithms::getChunkCount(std::max(elementCount, segmentCount), threadCount);
+
+        auto range = NumericRange<uint32_t>(0, chunkCount);
+        auto reduceChunk = [&](uint32_t chunk)
+        {
+            // Each chunk handles the segments that start within its element range.
+            const Offset elementBegin = pSegmentOffsets[0] + (Offset)(elementCount * chunk / chunkCount);
+            const Offset elementEnd = pSegmentOffsets[0] + (Offset)(elementCount * (chunk + 1) / chunkCount);
+            size_t segment = std::lower_bound(pSegmentOffsets, pSegmentOffsets + segmentCount, elementBegin) - pSegmentOffsets;
+            size_t segmentEnd = chunk + 1 == chunkCount ? segmentCount : std::lower_bound(pSegmentOffsets, pSegmentOffsets + segmentCount, elementEnd) - pSegmentOffsets;
+
+            for (; segment < segmentEnd; segment++)
+            {
+                T value = identity;
+                for (Offset i = pSegmentOffsets[segment]; i < pSegmentOffsets[segment + 1]; i++) value = op(value, pValues[i]);
+                pResults[segment] = value;
+            }
+        };
+
+        if (chunkCount <= 1) reduceChunk(0);
+        else std::for_each(std::execution::par, range.begin(), range.end(), reduceChunk);
+    }
+
+    /** Copy the elements that satisfy a predicate to the output in parallel, preserving their order.
+        \param[in] pInput Input elements.
+        \param[in] count Number of input elements.
+        \param[out] pOutput Output elements. Must have room for count elements and must not overlap the input.
+        \param[in] pred Predicate bool pred(const T&).
+        \param[in] threadCount Maximum number of threads (0 uses all logical cores).
+        \return Number of elements written to the output.
+    */
+    template<typename T, typename Pred>
+    size_t parallelCompact(const T* pInput, size_t count, T* pOutput, Pred pred, uint32_t threadCount = 0)
+    {
+        const uint32_t chunkCount = ParallelAlgorithms::getChunkCount(count, threadCount);
+        if (chunkCount <= 1)
+        {
+            return std::copy_if(pInput, pInput + count, pOutput, pred) - pOutput;
+        }
+
+        // Count selected elements per chunk. The predicate is evaluated twice to avoid storing flags.
+        std::vector<size_t> chunkOffsets(chunkCount);
+        ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+        {
+            chunkOffsets[chunk] = std::count_if(pInput + begin, pInput + end, pred);
+        });
+        size_t total = parallelExclusiveScan(chunkOffsets.data(), chunkOffsets.data(), chunkCount);
+
+        ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+        {
+            std::copy_if(pInput + begin, pInput + end, pOutput + chunkOffsets[chunk], pred);
+        });
+
+        return total;
+    }
+
+    /** Partition elements in parallel so that all elements satisfying a predicate precede the others.
+        The partition is stable, i.e. the relative order within both groups is preserved.
+        \param[in,out] pData Elements.
+        \param[in] count Number of elements.
+        \param[in] pred Predicate bool pred(const T&).
+        \param[in] threadCount Maximum number of threads (0 uses all logical cores).
+        \return Number of elements satisfying the predicate.
+    */
+    template<typename T, typename Pred>
+    size_t parallelPartition(T* pData, size_t count, Pred pred, uint32_t threadCount = 0)
+    {
+        const uint32_t chunkCount = ParallelAlgorithms::getChunkCount(count, threadCount);
+        if (chunkCount <= 1)
+        {
+            return std::stable_partition(pData, pData + count, pred) - pData;
+        }
+
+        // Evaluate the predicate once per element and count selected elements per chunk.
+        std::vector<uint8_t> flags(count);
+        std::vector<size_t> chunkOffsets(chunkCount);
+        ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+        {
+            size_t selected = 0;
+            for (size_t i = begin; i < end; i++)
+            {
+                flags[i] = pred(pData[i]) ? 1 : 0;
+                selected += flags[i];
+            }
+            chunkOffsets[chunk] = selected;
+        });
+        size_t selectedCount = parallelExclusiveScan(chunkOffsets.data(), chunkOffsets.data(), chunkCount);
+
+        // Scatter to a temporary buffer. Unselected elements of a chunk go after all selected elements
+        // and the unselected elements of preceding chunks.
+        std::vector<T> temp(count);
+        ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+        {
+            size_t selectedOffset = chunkOffsets[chunk];
+            size_t unselectedOffset = selectedCount + (begin - chunkOffsets[chunk]);
+            for (size_t i = begin; i < end; i++)
+            {
+                temp[flags[i] ? selectedOffset++ : unselectedOffset++] = std::move(pData[i]);
+            }
+        });
+
+        ParallelAlgorithms::forEachChunk(count, chunkCount, [&](uint32_t chunk, size_t begin, size_t end)
+        {
+            std::move(temp.begin() + begin, temp.begin() + end, pData + begin);
+        });
+
+        return selectedCount;
+    }
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Framework.h"
+#include <optional>
+#include <vector>
+
+namespace Falcor
+{
+    /** Bookkeeping for a ring of readback slots.
+
+        Each pending entry refers to a slot in a user-managed readback buffer that
+        the GPU writes to, tagged with a user value (e.g. the frame index) and the
+        fence value signaled after the write. Entries are retired in submission
+        order once the GPU fence has reached their value, which lets the CPU pick
+        up results a few frames later without stalling.
+
+        The class only tracks slot indices and fence values and does not access
+        any GPU resources.
+    */
+    class ReadbackRing
+    {
+    public:
+        struct Entry
+        {
+            uint32_t slot = 0;          ///< Slot index in the readback buffer.
+            uint64_t tag = 0;           ///< User-defined tag.
+            uint64_t fenceValue = 0;    ///< Fence value that must be reached before the slot can be read.
+        };
+
+        /** Constructor.
+            \param[in] slotCount Number of slots in the ring.
+        */
+        explicit ReadbackRing(uint32_t slotCount = 3)
+            : mEntries(slotCount)
+        {
+            FALCOR_ASSERT(slotCount > 0);
+        }
+
+        uint32_t getSlotCount() const { return (uint32_t)mEntries.size(); }
+        uint32_t getPendingCount() const { return mCount; }
+        bool isEmpty() const { return mCount == 0; }
+        bool isFull() const { return mCount == getSlotCount(); }
+
+        /** Get the slot to use for the next push().
+            The ring must not be full.
+        */
+        uint32_t getNextSlot() const
+        {
+            FALCOR_ASSERT(!isFull());
+            return (mHead + mCount) % getSlotCount();
+        }
+
+        /** Add a pending entry using the slot returned by getNextSlot().
+            \param[in] tag User-defined tag.
+            \param[in] fenceValue Fence value signaled after the GPU writes the slot.
+            \return The slot index.
+        */
+        uint32_t push(uint64_t tag, uint64_t fenceValue)
+        {
+            uint32_t slot = getNextSlot();
+            FALCOR_ASSERT(mCount == 0 || fenceValue >= back().fenceValue);
+            mEntries[slot] = { slot, tag, fenceValue };
+            mCount++;
+            return slot;
+        }
+
+        /** Get the oldest pending entry. The ring must not be empty.
+        */
+        const Entry& front() const
+        {
+            FALCOR_ASSERT(!isEmpty());
+            return mEntries[mHead];
+        }
+
+        /** Get the newest pending entry. The ring must not be empty.
+        */
+        const Entry& back() const
+        {
+            FALCOR_ASSERT(!isEmpty());
+            return mEntries[(mHead + mCount - 1) % getSlotCount()];
+        }
+
+        /** Retire the oldest pending entry if the GPU has finished writing it.
+            \param[in] completedFenceValue Last fence value reached by the GPU.
+            \return The retired entry, or an empty optional if no entry is ready.
+        */
+        std::optional<Entry> pop(uint64_t completedFenceValue)
+        {
+            if (isEmpty() || front().fenceValue > completedFenceValue) return {};
+            Entry entry = mEntries[mHead];
+            mHead = (mHead + 1) % getSlotCount();
+            mCount--;
+            return entry;
+        }
+
+        /** Discard all pending entries.
+        */
+        void clear()
+        {
+            mHead = 0;
+            mCount = 0;
+        }
+
+    private:
+        std::vector<Entry> mEntries;
+        uint32_t mHead = 0;     ///< Index of the oldest pending entry.
+        uint32_t mCount = 0;    ///< Number of pending entries.
+    };
+}
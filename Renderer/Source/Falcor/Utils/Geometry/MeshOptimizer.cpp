@@ -0,0 +1,237 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "MeshOptimizer.h"
+#include <array>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidVertex = 0xffffffff;
+
+        // Vertex fetch cache used by analyze(). It is direct-mapped with 64 lines of 64 bytes.
+        const uint32_t kFetchCacheLineSize = 64;
+        const uint32_t kFetchCacheLineCount = 64;
+
+        void checkIndices(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount)
+        {
+            checkArgument(indexCount <= std::numeric_limits<uint32_t>::max(), "'indexCount' must fit in 32 bits (got {}).", indexCount);
+            checkArgument(indexCount == 0 || pIndices != nullptr, "'pIndices' must not be null.");
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                if (pIndices[i] >= vertexCount) throw ArgumentError("Vertex index {} at position {} is out of range (vertex count is {}).", pIndices[i], i, vertexCount);
+            }
+        }
+    }
+
+    void MeshOptimizer::optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        checkArgument(indexCount % 3 == 0, "'indexCount' must be a multiple of 3 (got {}).", indexCount);
+        checkArgument(cacheSize >= 3, "'cacheSize' must be at least 3 (got {}).", cacheSize);
+        checkIndices(pIndices, indexCount, vertexCount);
+
+        const uint32_t triangleCount = (uint32_t)(indexCount / 3);
+        if (triangleCount == 0) return;
+
+        // Build the vertex-triangle adjacency. The adjacent triangles of vertex v are
+        // adjacency[offsets[v]] to adjacency[offsets[v + 1] - 1], in input order.
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < indexCount; i++) offsets[pIndices[i] + 1]++;
+        for (uint32_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+
+        std::vector<uint32_t> adjacency(indexCount);
+        std::vector<uint32_t> liveCount(vertexCount);
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                for (uint32_t k = 0; k < 3; k++) adjacency[cursor[pIndices[3 * t + k]]++] = t;
+            }
+        }
+        for (uint32_t v = 0; v < vertexCount; v++) liveCount[v] = offsets[v + 1] - offsets[v];
+
+        // Cache timestamps. A vertex is in the simulated FIFO cache if fewer than
+        // cacheSize vertices have entered the cache after it.
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        std::vector<uint32_t> deadEndStack;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        deadEndStack.reserve(indexCount);
+        output.reserve(indexCount);
+
+        // Find the next fanning vertex when none of the candidates has live triangles left.
+        // Recently used vertices are tried first, then the vertices in input order.
+        uint32_t scanCursor = 0;
+        auto skipDeadEnd = [&]()
+        {
+            while (!deadEndStack.empty())
+            {
+                uint32_t v = deadEndStack.back();
+                deadEndStack.pop_back();
+                if (liveCount[v] > 0) return v;
+            }
+            while (scanCursor < vertexCount)
+            {
+                if (liveCount[scanCursor] > 0) return scanCursor;
+                scanCursor++;
+            }
+            return kInvalidVertex;
+        };
+
+        uint32_t fanningVertex = skipDeadEnd();
+        while (fanningVertex != kInvalidVertex)
+        {
+            // Emit all remaining triangles around the fanning vertex.
+            candidates.clear();
+            for (uint32_t j = offsets[fanningVertex]; j < offsets[fanningVertex + 1]; j++)
+            {
+                uint32_t t = adjacency[j];
+                if (emitted[t]) continue;
+                emitted[t] = 1;
+
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    uint32_t v = pIndices[3 * t + k];
+                    output.push_back(v);
+                    deadEndStack.push_back(v);
+                    candidates.push_back(v);
+                    liveCount[v]--;
+                    if (time - cacheTime[v] > cacheSize) cacheTime[v] = time++;
+                }
+            }
+
+            // Pick the candidate that entered the cache earliest among those that will still be
+            // in the cache after fanning them, or any candidate with live triangles otherwise.
+            uint32_t nextVertex = kInvalidVertex;
+            uint32_t bestPriority = 0;
+            for (uint32_t v : candidates)
+            {
+                if (liveCount[v] == 0) continue;
+                uint32_t age = time - cacheTime[v];
+                uint32_t priority = age + 2 * liveCount[v] <= cacheSize ? age : 0;
+                if (nextVertex == kInvalidVertex || priority > bestPriority)
+                {
+                    nextVertex = v;
+                    bestPriority = priority;
+                }
+            }
+
+            fanningVertex = nextVertex != kInvalidVertex ? nextVertex : skipDeadEnd();
+        }
+
+        FALCOR_ASSERT(output.size() == indexCount);
+        std::copy(output.begin(), output.end(), pIndices);
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeVertexFetch(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount)
+    {
+        checkIndices(pIndices, indexCount, vertexCount);
+
+        std::vector<uint32_t> remap(vertexCount, kInvalidVertex);
+        std::vector<uint32_t> order;
+        order.reserve(vertexCount);
+
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32_t& newIndex = remap[pIndices[i]];
+            if (newIndex == kInvalidVertex)
+            {
+                newIndex = (uint32_t)order.size();
+                order.push_back(pIndices[i]);
+            }
+            pIndices[i] = newIndex;
+        }
+
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            if (remap[v] == kInvalidVertex) order.push_back(v);
+        }
+
+        FALCOR_ASSERT(order.size() == vertexCount);
+        return order;
+    }
+
+    MeshOptimizer::Stats MeshOptimizer::analyze(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t vertexStride, uint32_t cacheSize)
+    {
+        checkArgument(indexCount % 3 == 0, "'indexCount' must be a multiple of 3 (got {}).", indexCount);
+        checkArgument(cacheSize > 0, "'cacheSize' must be positive.");
+        checkArgument(vertexStride > 0, "'vertexStride' must be positive.");
+        checkIndices(pIndices, indexCount, vertexCount);
+
+        Stats stats;
+        if (indexCount == 0) return stats;
+
+        // Simulate the post-transform cache (see optimizeVertexCache()). Vertices that miss
+        // are transformed and fetched from the vertex buffer through the fetch cache.
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+
+        std::array<uint64_t, kFetchCacheLineCount> lineTags;
+        lineTags.fill(std::numeric_limits<uint64_t>::max());
+
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        uint64_t referencedCount = 0;
+        uint64_t transformedCount = 0;
+        uint64_t fetchedLineCount = 0;
+
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32_t v = pIndices[i];
+            if (!referenced[v])
+            {
+                referenced[v] = 1;
+                referencedCount++;
+            }
+
+            if (time - cacheTime[v] <= cacheSize) continue;
+            cacheTime[v] = time++;
+            transformedCount++;
+
+            uint64_t firstLine = (uint64_t)v * vertexStride / kFetchCacheLineSize;
+            uint64_t lastLine = ((uint64_t)v * vertexStride + vertexStride - 1) / kFetchCacheLineSize;
+            for (uint64_t line = firstLine; line <= lastLine; line++)
+            {
+                uint64_t& tag = lineTags[line % kFetchCacheLineCount];
+                if (tag != line)
+                {
+                    tag = line;
+                    fetchedLineCount++;
+                }
+            }
+        }
+
+        stats.acmr = (float)((double)transformedCount / (double)(indexCount / 3));
+        stats.fetchRatio = (float)((double)(fetchedLineCount * kFetchCacheLineSize) / (double)(referencedCount * vertexStride));
+        return stats;
+    }
+}
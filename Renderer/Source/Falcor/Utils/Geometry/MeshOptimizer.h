@@ -0,0 +1,86 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Framework.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** Reordering of indexed triangle meshes for efficient rendering.
+
+        The triangle order is optimized for the post-transform vertex cache with
+        the Tipsify algorithm [Sander et al. 2007], which runs in linear time and
+        preserves the winding of each triangle. The vertex order is then optimized
+        for fetch locality by numbering the vertices in the order they are first
+        referenced by the index buffer.
+
+        The analysis functions simulate a FIFO post-transform cache and a small
+        direct-mapped vertex fetch cache to measure the effect of the reordering.
+    */
+    class FALCOR_API MeshOptimizer
+    {
+    public:
+        static constexpr uint32_t kDefaultCacheSize = 16;   ///< Post-transform cache size (in vertices) used by default for optimization and analysis.
+
+        /** Vertex cache and fetch statistics of an index buffer.
+        */
+        struct Stats
+        {
+            float acmr = 0.f;       ///< Average cache miss ratio, i.e. transformed vertices per triangle. Ranges from about 0.5 (best) to 3 (worst).
+            float fetchRatio = 0.f; ///< Bytes fetched from the vertex buffer divided by the size of the referenced vertices. 1 is optimal.
+        };
+
+        /** Reorder the triangles for post-transform vertex cache efficiency.
+            \param[in,out] pIndices Vertex indices, three per triangle.
+            \param[in] indexCount Number of indices. Must be a multiple of three.
+            \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+            \param[in] cacheSize Size of the targeted post-transform cache in vertices.
+        */
+        static void optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultCacheSize);
+
+        /** Reorder the vertices for fetch locality. The vertices are numbered in the order of
+            their first reference in the index buffer, and unreferenced vertices are moved to the end.
+            The triangle order is not changed.
+            \param[in,out] pIndices Vertex indices, rewritten to the new vertex order.
+            \param[in] indexCount Number of indices.
+            \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+            \return The old index of each vertex in the new order. The caller uses this to reorder the vertex data.
+        */
+        static std::vector<uint32_t> optimizeVertexFetch(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount);
+
+        /** Compute vertex cache and fetch statistics.
+            \param[in] pIndices Vertex indices, three per triangle.
+            \param[in] indexCount Number of indices. Must be a multiple of three.
+            \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+            \param[in] vertexStride Size of a vertex in bytes.
+            \param[in] cacheSize Size of the simulated post-transform cache in vertices.
+            \return Statistics. All zero if there are no triangles.
+        */
+        static Stats analyze(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t vertexStride, uint32_t cacheSize = kDefaultCacheSize);
+    };
+}
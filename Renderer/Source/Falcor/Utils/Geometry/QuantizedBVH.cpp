@@ -0,0 +1,119 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "QuantizedBVH.h"
+
+namespace Falcor
+{
+    void QuantizedBVH::build(const AABB* primBounds, uint32_t primCount, uint32_t width, uint32_t maxLeafSize)
+    {
+        checkArgument(width == 4 || width == 8, "'width' must be 4 or 8 (got {}).", width);
+        checkArgument(maxLeafSize > 0 && maxLeafSize <= kMaxLeafSize, "'maxLeafSize' must be in [1, {}] (got {}).", kMaxLeafSize, maxLeafSize);
+
+        mWidth = width;
+        mNodes4.clear();
+        mNodes8.clear();
+        mPrimRefs.clear();
+        mBounds = AABB();
+        if (primCount == 0) return;
+        FALCOR_ASSERT(primBounds);
+
+        for (uint32_t i = 0; i < primCount; i++) mBounds.include(primBounds[i]);
+
+        if (mWidth == 8)
+        {
+            std::vector<WideBVHNode<8>> nodes;
+            buildWideBVH(primBounds, primCount, maxLeafSize, nodes, mPrimRefs);
+            quantizeNodes(nodes, mNodes8);
+        }
+        else
+        {
+            std::vector<WideBVHNode<4>> nodes;
+            buildWideBVH(primBounds, primCount, maxLeafSize, nodes, mPrimRefs);
+            quantizeNodes(nodes, mNodes4);
+        }
+    }
+
+    void QuantizedBVH::refit(const AABB* primBounds)
+    {
+        if (mPrimRefs.empty()) return;
+        FALCOR_ASSERT(primBounds);
+
+        mBounds = AABB();
+        for (uint32_t prim : mPrimRefs) mBounds.include(primBounds[prim]);
+
+        if (mWidth == 8) refitNodes(mNodes8, primBounds);
+        else refitNodes(mNodes4, primBounds);
+    }
+
+    template<uint32_t kWidth>
+    void QuantizedBVH::quantizeNodes(const std::vector<WideBVHNode<kWidth>>& nodes, std::vector<QuantizedBVHNode<kWidth>>& quantizedNodes)
+    {
+        quantizedNodes.resize(nodes.size());
+        for (size_t n = 0; n < nodes.size(); n++)
+        {
+            const auto& node = nodes[n];
+            auto& quantizedNode = quantizedNodes[n];
+            AABB childBounds[kWidth];
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                if (!node.isValid(i)) continue;
+                FALCOR_ASSERT(node.count[i] <= kMaxLeafSize);
+                quantizedNode.index[i] = node.index[i];
+                quantizedNode.count[i] = (uint8_t)node.count[i];
+                childBounds[i] = AABB(float3(node.minX[i], node.minY[i], node.minZ[i]), float3(node.maxX[i], node.maxY[i], node.maxZ[i]));
+            }
+            quantizedNode.setBounds(childBounds);
+        }
+    }
+
+    template<uint32_t kWidth>
+    void QuantizedBVH::refitNodes(std::vector<QuantizedBVHNode<kWidth>>& nodes, const AABB* primBounds)
+    {
+        // Child nodes are always stored after their parent, so a reverse sweep visits children first.
+        // Inner children use the dequantized bounds of the child node, which are conservative.
+        for (size_t n = nodes.size(); n-- > 0;)
+        {
+            auto& node = nodes[n];
+            AABB childBounds[kWidth];
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                if (!node.isValid(i)) continue;
+                if (node.count[i] > 0)
+                {
+                    for (uint32_t j = node.index[i]; j < node.index[i] + node.count[i]; j++) childBounds[i].include(primBounds[mPrimRefs[j]]);
+                }
+                else
+                {
+                    childBounds[i] = nodes[node.index[i]].getBounds();
+                }
+            }
+            node.setBounds(childBounds);
+        }
+    }
+}
@@ -0,0 +1,265 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Framework.h"
+#include "WideBVH.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Vector.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** Node of a wide BVH with quantized child bounds.
+
+        The node stores its own bounds as an origin and a per-axis step size. The child bounds
+        are stored as 8-bit multiples of the step size, rounded outwards so that the dequantized
+        bounds always contain the exact ones. A child is a leaf if count > 0, in which case index
+        points to its first primitive reference. Otherwise index is the index of the child node.
+        Empty child slots have index kInvalidIndex and are encoded as qMin = 255, qMax = 0, which
+        the slab test treats as the whole node box, so traversal must skip them with isValid().
+    */
+    template<uint32_t kWidth>
+    struct QuantizedBVHNode
+    {
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+        float3 origin;          ///< Min corner of the node bounds.
+        float3 scale;           ///< Quantization step size per axis.
+        uint8_t qMinX[kWidth], qMinY[kWidth], qMinZ[kWidth];
+        uint8_t qMaxX[kWidth], qMaxY[kWidth], qMaxZ[kWidth];
+        uint8_t count[kWidth];
+        uint32_t index[kWidth];
+
+        QuantizedBVHNode()
+        {
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                index[i] = kInvalidIndex;
+                count[i] = 0;
+            }
+        }
+
+        bool isValid(uint32_t i) const { return index[i] != kInvalidIndex; }
+
+        static float dequantize(float origin, float scale, uint8_t q) { return origin + scale * (float)q; }
+
+        /** Set the bounds of all children. The node bounds are set to the union of the valid children.
+            \param[in] childBounds Bounds of each child slot. Ignored for empty slots.
+        */
+        void setBounds(const AABB childBounds[kWidth])
+        {
+            AABB bounds;
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                if (isValid(i)) bounds.include(childBounds[i]);
+            }
+            if (!bounds.valid()) bounds = AABB(float3(0.f));
+
+            origin = bounds.minPoint;
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                // Grow the step size until the max corner is representable.
+                float s = (bounds.maxPoint[axis] - bounds.minPoint[axis]) / 255.f;
+                while (dequantize(origin[axis], s, 255) < bounds.maxPoint[axis]) s = std::nextafter(s, std::numeric_limits<float>::infinity());
+                scale[axis] = s;
+            }
+
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                uint8_t qMin[3] = { 255, 255, 255 };
+                uint8_t qMax[3] = { 0, 0, 0 };
+                if (isValid(i) && childBounds[i].valid())
+                {
+                    for (uint32_t axis = 0; axis < 3; axis++)
+                    {
+                        const float o = origin[axis];
+                        const float s = scale[axis];
+                        if (s == 0.f)
+                        {
+                            qMin[axis] = qMax[axis] = 0;
+                            continue;
+                        }
+                        uint32_t lo = (uint32_t)std::clamp(std::floor((childBounds[i].minPoint[axis] - o) / s), 0.f, 255.f);
+                        uint32_t hi = (uint32_t)std::clamp(std::ceil((childBounds[i].maxPoint[axis] - o) / s), 0.f, 255.f);
+                        while (lo > 0 && dequantize(o, s, (uint8_t)lo) > childBounds[i].minPoint[axis]) lo--;
+                        while (hi < 255 && dequantize(o, s, (uint8_t)hi) < childBounds[i].maxPoint[axis]) hi++;
+                        qMin[axis] = (uint8_t)lo;
+                        qMax[axis] = (uint8_t)hi;
+                    }
+                }
+                qMinX[i] = qMin[0]; qMinY[i] = qMin[1]; qMinZ[i] = qMin[2];
+                qMaxX[i] = qMax[0]; qMaxY[i] = qMax[1]; qMaxZ[i] = qMax[2];
+            }
+        }
+
+        /** Get the dequantized bounds of a child.
+        */
+        AABB getChildBounds(uint32_t i) const
+        {
+            if (!isValid(i) || qMinX[i] > qMaxX[i]) return AABB();
+            return AABB(
+                float3(dequantize(origin.x, scale.x, qMinX[i]), dequantize(origin.y, scale.y, qMinY[i]), dequantize(origin.z, scale.z, qMinZ[i])),
+                float3(dequantize(origin.x, scale.x, qMaxX[i]), dequantize(origin.y, scale.y, qMaxY[i]), dequantize(origin.z, scale.z, qMaxZ[i])));
+        }
+
+        /** Get the union of the dequantized bounds of all valid children.
+        */
+        AABB getBounds() const
+        {
+            AABB bounds;
+            for (uint32_t i = 0; i < kWidth; i++) bounds.include(getChildBounds(i));
+            return bounds;
+        }
+
+        /** Intersect a ray with the dequantized bounds of all children.
+            \param[in] invDir Reciprocal of the ray direction.
+            \param[in] originScaled Ray origin multiplied by -invDir.
+            \param[in] tMin Ray min distance.
+            \param[in] tMax Ray max distance.
+            \param[out] tNear Entry distance for each child.
+            \return Bit mask of the children that are hit.
+        */
+        uint32_t intersect(const float3& invDir, const float3& originScaled, float tMin, float tMax, float tNear[kWidth]) const
+        {
+            uint32_t mask = 0;
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                float tx0 = dequantize(origin.x, scale.x, qMinX[i]) * invDir.x + originScaled.x;
+                float tx1 = dequantize(origin.x, scale.x, qMaxX[i]) * invDir.x + originScaled.x;
+                float ty0 = dequantize(origin.y, scale.y, qMinY[i]) * invDir.y + originScaled.y;
+                float ty1 = dequantize(origin.y, scale.y, qMaxY[i]) * invDir.y + originScaled.y;
+                float tz0 = dequantize(origin.z, scale.z, qMinZ[i]) * invDir.z + originScaled.z;
+                float tz1 = dequantize(origin.z, scale.z, qMaxZ[i]) * invDir.z + originScaled.z;
+                float t0 = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), tMin));
+                float t1 = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+                tNear[i] = t0;
+                mask |= (t0 <= t1 ? 1u : 0u) << i;
+            }
+            return mask;
+        }
+    };
+
+    /** Memory-efficient wide BVH over arbitrary primitives for ray queries on the CPU.
+
+        The topology is built with buildWideBVH() and stored as a 4- or 8-wide tree of
+        QuantizedBVHNode nodes, which are 40-50% smaller than WideBVHNode nodes.
+        The BVH only stores primitive references. Primitives are intersected by a callback,
+        so that they can be fetched from existing vertex and index data instead of being copied.
+    */
+    class FALCOR_API QuantizedBVH
+    {
+    public:
+        static constexpr uint32_t kMaxLeafSize = 255;   ///< Max supported number of primitives per leaf.
+
+        QuantizedBVH() = default;
+
+        /** Build the BVH.
+            \param[in] primBounds Bounds of each primitive.
+            \param[in] primCount Number of primitives.
+            \param[in] width Branching factor of the tree, either 4 or 8.
+            \param[in] maxLeafSize Max number of primitives per leaf, at most kMaxLeafSize.
+        */
+        void build(const AABB* primBounds, uint32_t primCount, uint32_t width = 4, uint32_t maxLeafSize = 4);
+
+        /** Refit the BVH to new primitive bounds, keeping the tree topology.
+            \param[in] primBounds Bounds of each primitive, same count as passed to build().
+        */
+        void refit(const AABB* primBounds);
+
+        /** Traverse the BVH.
+            The callback is invoked as bool intersectPrimitive(uint32_t primIndex, float& tMax) for each primitive
+            whose leaf is hit. It returns true if the primitive is hit closer than tMax, in which case it updates tMax.
+            \param[in] ray Ray. Only leaves overlapping [tMin, tMax] are visited.
+            \param[in] intersectPrimitive Primitive intersection callback.
+            \return True if any primitive was hit.
+        */
+        template<bool kAnyHit, typename IntersectPrimitive>
+        bool traverse(const BVHRay& ray, IntersectPrimitive&& intersectPrimitive) const
+        {
+            return mWidth == 8 ? traverseNodes<8, kAnyHit>(mNodes8, ray, intersectPrimitive) : traverseNodes<4, kAnyHit>(mNodes4, ray, intersectPrimitive);
+        }
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getPrimitiveCount() const { return (uint32_t)mPrimRefs.size(); }
+        uint32_t getNodeCount() const { return mWidth == 8 ? (uint32_t)mNodes8.size() : (uint32_t)mNodes4.size(); }
+        const AABB& getBounds() const { return mBounds; }
+        uint64_t getMemoryUsageInBytes() const { return mNodes4.size() * sizeof(QuantizedBVHNode<4>) + mNodes8.size() * sizeof(QuantizedBVHNode<8>) + mPrimRefs.size() * sizeof(uint32_t); }
+
+    private:
+        template<uint32_t kWidth>
+        void quantizeNodes(const std::vector<WideBVHNode<kWidth>>& nodes, std::vector<QuantizedBVHNode<kWidth>>& quantizedNodes);
+
+        template<uint32_t kWidth>
+        void refitNodes(std::vector<QuantizedBVHNode<kWidth>>& nodes, const AABB* primBounds);
+
+        template<uint32_t kWidth, bool kAnyHit, typename IntersectPrimitive>
+        bool traverseNodes(const std::vector<QuantizedBVHNode<kWidth>>& nodes, const BVHRay& ray, IntersectPrimitive& intersectPrimitive) const
+        {
+            if (nodes.empty()) return false;
+
+            const float3 invDir = ray.getInvDir();
+            const float3 originScaled = -ray.origin * invDir;
+            float tMax = ray.tMax;
+            bool found = false;
+
+            BVHStackEntry stack[BVHStackEntry::kMaxSize];
+            uint32_t stackSize = 0;
+            stack[stackSize++] = { 0, 0, ray.tMin };
+
+            while (stackSize > 0)
+            {
+                const BVHStackEntry entry = stack[--stackSize];
+                if (entry.tNear > tMax) continue;
+
+                if (entry.count > 0)
+                {
+                    for (uint32_t i = entry.index; i < entry.index + entry.count; i++)
+                    {
+                        if (!intersectPrimitive(mPrimRefs[i], tMax)) continue;
+                        found = true;
+                        if (kAnyHit) return true;
+                    }
+                    continue;
+                }
+
+                const auto& node = nodes[entry.index];
+                float tNear[kWidth];
+                const uint32_t hitMask = node.intersect(invDir, originScaled, ray.tMin, tMax, tNear);
+                pushHitChildren<kWidth>(node, hitMask, tNear, stack, stackSize);
+            }
+
+            return found;
+        }
+
+        uint32_t mWidth = 4;
+        std::vector<QuantizedBVHNode<4>> mNodes4;   ///< Nodes if mWidth == 4.
+        std::vector<QuantizedBVHNode<8>> mNodes8;   ///< Nodes if mWidth == 8.
+        std::vector<uint32_t> mPrimRefs;            ///< Primitive indices in leaf order.
+        AABB mBounds;
+    };
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "TriangleBVH.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    void TriangleBVH::build(const float3* positions, uint32_t triangleCount, uint32_t width)
+    {
+        checkArgument(width == 4 || width == 8, "'width' must be 4 or 8 (got {}).", width);
+
+        mWidth = width;
+        mNodes4.clear();
+        mNodes8.clear();
+        mTriangles.clear();
+        mBounds = AABB();
+        if (triangleCount == 0) return;
+        FALCOR_ASSERT(positions);
+
+        if (mWidth == 8) buildNodes(mNodes8, positions, triangleCount);
+        else buildNodes(mNodes4, positions, triangleCount);
+    }
+
+    void TriangleBVH::refit(const float3* positions)
+    {
+        if (mTriangles.empty()) return;
+        FALCOR_ASSERT(positions);
+
+        for (auto& tri : mTriangles)
+        {
+            const uint32_t prim = tri.primitiveIndex;
+            tri.v0 = positions[3 * prim];
+            tri.e1 = positions[3 * prim + 1] - tri.v0;
+            tri.e2 = positions[3 * prim + 2] - tri.v0;
+        }
+
+        if (mWidth == 8) refitNodes(mNodes8);
+        else refitNodes(mNodes4);
+    }
+
+    template<uint32_t kWidth>
+    void TriangleBVH::buildNodes(std::vector<WideBVHNode<kWidth>>& nodes, const float3* positions, uint32_t triangleCount)
+    {
+        std::vector<AABB> primBounds(triangleCount);
+        for (uint32_t i = 0; i < triangleCount; i++)
+        {
+            AABB b(positions[3 * i]);
+            b.include(positions[3 * i + 1]);
+            b.include(positions[3 * i + 2]);
+            primBounds[i] = b;
+            mBounds.include(b);
+        }
+
+        // Store the triangles in leaf order so that leaves reference them directly.
+        std::vector<uint32_t> primRefs;
+        buildWideBVH(primBounds.data(), triangleCount, kMaxLeafSize, nodes, primRefs);
+        mTriangles.reserve(triangleCount);
+        for (uint32_t prim : primRefs)
+        {
+            const float3& v0 = positions[3 * prim];
+            mTriangles.push_back({ v0, positions[3 * prim + 1] - v0, positions[3 * prim + 2] - v0, prim });
+        }
+    }
+
+    template<uint32_t kWidth>
+    void TriangleBVH::refitNodes(std::vector<WideBVHNode<kWidth>>& nodes)
+    {
+        // Child nodes are always allocated after their parent, so a reverse sweep visits children first.
+        for (size_t n = nodes.size(); n-- > 0;)
+        {
+            auto& node = nodes[n];
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                if (!node.isValid(i)) continue;
+                AABB bounds;
+                if (node.count[i] > 0)
+                {
+                    for (uint32_t j = node.index[i]; j < node.index[i] + node.count[i]; j++)
+                    {
+                        const Triangle& tri = mTriangles[j];
+                        bounds.include(tri.v0);
+                        bounds.include(tri.v0 + tri.e1);
+                        bounds.include(tri.v0 + tri.e2);
+                    }
+                }
+                else
+                {
+                    bounds = nodes[node.index[i]].getBounds();
+                }
+                node.setChildBounds(i, bounds);
+            }
+        }
+        mBounds = nodes[0].getBounds();
+    }
+
+    bool TriangleBVH::intersect(const Ray& ray, Hit& hit, HitFilter filter, const void* pUserData) const
+    {
+        hit = Hit();
+        return mWidth == 8 ? traverse<8, false>(mNodes8, ray, hit, filter, pUserData) : traverse<4, false>(mNodes4, ray, hit, filter, pUserData);
+    }
+
+    bool TriangleBVH::intersectAny(const Ray& ray, Hit& hit, HitFilter filter, const void* pUserData) const
+    {
+        hit = Hit();
+        return mWidth == 8 ? traverse<8, true>(mNodes8, ray, hit, filter, pUserData) : traverse<4, true>(mNodes4, ray, hit, filter, pUserData);
+    }
+
+    bool TriangleBVH::occluded(const Ray& ray, HitFilter filter, const void* pUserData) const
+    {
+        Hit hit;
+        return mWidth == 8 ? traverse<8, true>(mNodes8, ray, hit, filter, pUserData) : traverse<4, true>(mNodes4, ray, hit, filter, pUserData);
+    }
+
+    template<uint32_t kWidth, bool kAnyHit>
+    bool TriangleBVH::traverse(const std::vector<WideBVHNode<kWidth>>& nodes, const Ray& ray, Hit& hit, HitFilter filter, const void* pUserData) const
+    {
+        if (nodes.empty()) return false;
+
+        const float3 invDir = ray.getInvDir();
+        const float3 originScaled = -ray.origin * invDir;
+        float tMax = ray.tMax;
+        bool found = false;
+
+        BVHStackEntry stack[BVHStackEntry::kMaxSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = { 0, 0, ray.tMin };
+
+        while (stackSize > 0)
+        {
+            const BVHStackEntry entry = stack[--stackSize];
+            if (entry.tNear > tMax) continue;
+
+            if (entry.count > 0)
+            {
+                // Leaf: test all triangles.
+                for (uint32_t i = entry.index; i < entry.index + entry.count; i++)
+                {
+                    const Triangle& tri = mTriangles[i];
+                    float t;
+                    float2 barycentrics;
+                    if (!intersectTriangle(ray, tri.v0, tri.e1, tri.e2, tMax, t, barycentrics)) continue;
+                    if (filter && !filter(pUserData, tri.primitiveIndex, barycentrics)) continue;
+
+                    found = true;
+                    tMax = t;
+                    hit.primitiveIndex = tri.primitiveIndex;
+                    hit.t = t;
+                    hit.barycentrics = barycentrics;
+                    if (kAnyHit) return true;
+                }
+                continue;
+            }
+
+            // Inner node: slab test against all children at once.
+            const auto& node = nodes[entry.index];
+            float tNear[kWidth];
+            const uint32_t hitMask = node.intersect(invDir, originScaled, ray.tMin, tMax, tNear);
+
+            pushHitChildren<kWidth>(node, hitMask, tNear, stack, stackSize);
+        }
+
+        return found;
+    }
+}
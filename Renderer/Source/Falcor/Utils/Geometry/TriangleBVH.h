@@ -0,0 +1,168 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Framework.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Vector.h"
+#include "WideBVH.h"
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    /** Bounding volume hierarchy over a triangle soup for ray queries on the CPU.
+
+        The hierarchy is built with buildWideBVH() and stored as a 4- or 8-wide
+        tree of WideBVHNode nodes. Triangles are stored pre-transformed as (v0, e1, e2)
+        in leaf order and are intersected with the Moller-Trumbore test.
+
+        The topology is fixed at build time. The BVH can be refit to new vertex positions,
+        which is cheap but degrades traversal performance if the triangles move a lot.
+        Queries may be issued concurrently from any number of threads.
+    */
+    class FALCOR_API TriangleBVH
+    {
+    public:
+        static constexpr uint32_t kMaxLeafSize = 4;             ///< Max number of triangles per leaf.
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+        using Ray = BVHRay;
+
+        struct Hit
+        {
+            uint32_t primitiveIndex = kInvalidIndex;    ///< Index of the hit triangle in the input order.
+            float t = 0.f;                              ///< Hit distance along the ray.
+            float2 barycentrics;                        ///< Barycentrics (u, v) of the hit w.r.t. vertices 1 and 2.
+
+            bool isValid() const { return primitiveIndex != kInvalidIndex; }
+        };
+
+        /** Optional callback invoked for every candidate hit, e.g. for alpha testing.
+            Returns false if the candidate should be ignored.
+        */
+        using HitFilter = bool(*)(const void* pUserData, uint32_t primitiveIndex, float2 barycentrics);
+
+        TriangleBVH() = default;
+
+        /** Build the BVH.
+            \param[in] positions Vertex positions, three consecutive vertices per triangle.
+            \param[in] triangleCount Number of triangles.
+            \param[in] width Branching factor of the tree, either 4 or 8.
+        */
+        void build(const float3* positions, uint32_t triangleCount, uint32_t width = 4);
+
+        /** Refit the BVH to new vertex positions, keeping the tree topology.
+            \param[in] positions Vertex positions, same layout and triangle count as passed to build().
+        */
+        void refit(const float3* positions);
+
+        /** Find the closest hit along a ray.
+            \param[in] ray Ray. Only hits in [tMin, tMax] are reported.
+            \param[out] hit Closest hit, invalid if nothing was hit.
+            \param[in] filter Optional hit filter.
+            \param[in] pUserData User data passed to the hit filter.
+            \return True if a hit was found.
+        */
+        bool intersect(const Ray& ray, Hit& hit, HitFilter filter = nullptr, const void* pUserData = nullptr) const;
+
+        /** Find any hit along a ray. Traversal stops at the first hit found, which is not necessarily the closest one.
+            \param[in] ray Ray. Only hits in [tMin, tMax] are reported.
+            \param[out] hit First hit found, invalid if nothing was hit.
+            \param[in] filter Optional hit filter.
+            \param[in] pUserData User data passed to the hit filter.
+            \return True if a hit was found.
+        */
+        bool intersectAny(const Ray& ray, Hit& hit, HitFilter filter = nullptr, const void* pUserData = nullptr) const;
+
+        /** Check if anything is hit along a ray.
+            \param[in] ray Ray. Only hits in [tMin, tMax] are considered.
+            \param[in] filter Optional hit filter.
+            \param[in] pUserData User data passed to the hit filter.
+            \return True if any hit was found.
+        */
+        bool occluded(const Ray& ray, HitFilter filter = nullptr, const void* pUserData = nullptr) const;
+
+        /** Intersect a ray with a triangle given as (v0, e1 = v1 - v0, e2 = v2 - v0) using the Moller-Trumbore test.
+            \param[in] ray Ray.
+            \param[in] v0 First vertex.
+            \param[in] e1 First edge.
+            \param[in] e2 Second edge.
+            \param[in] tMax Max hit distance, overrides ray.tMax.
+            \param[out] t Hit distance.
+            \param[out] barycentrics Barycentrics (u, v) w.r.t. vertices 1 and 2.
+            \return True if the triangle is hit in [ray.tMin, tMax].
+        */
+        static bool intersectTriangle(const Ray& ray, const float3& v0, const float3& e1, const float3& e2, float tMax, float& t, float2& barycentrics)
+        {
+            float3 p = cross(ray.dir, e2);
+            float det = dot(e1, p);
+            if (det == 0.f) return false;
+            float invDet = 1.f / det;
+            float3 s = ray.origin - v0;
+            float u = dot(s, p) * invDet;
+            if (u < 0.f || u > 1.f) return false;
+            float3 q = cross(s, e1);
+            float v = dot(ray.dir, q) * invDet;
+            if (v < 0.f || u + v > 1.f) return false;
+            t = dot(e2, q) * invDet;
+            if (t < ray.tMin || t > tMax) return false;
+            barycentrics = float2(u, v);
+            return true;
+        }
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getTriangleCount() const { return (uint32_t)mTriangles.size(); }
+        uint32_t getNodeCount() const { return mWidth == 8 ? (uint32_t)mNodes8.size() : (uint32_t)mNodes4.size(); }
+        const AABB& getBounds() const { return mBounds; }
+        uint64_t getMemoryUsageInBytes() const { return mNodes4.size() * sizeof(WideBVHNode<4>) + mNodes8.size() * sizeof(WideBVHNode<8>) + mTriangles.size() * sizeof(Triangle); }
+
+    private:
+        struct Triangle
+        {
+            float3 v0;
+            float3 e1;
+            float3 e2;
+            uint32_t primitiveIndex;
+        };
+
+        template<uint32_t kWidth>
+        void buildNodes(std::vector<WideBVHNode<kWidth>>& nodes, const float3* positions, uint32_t triangleCount);
+
+        template<uint32_t kWidth>
+        void refitNodes(std::vector<WideBVHNode<kWidth>>& nodes);
+
+        template<uint32_t kWidth, bool kAnyHit>
+        bool traverse(const std::vector<WideBVHNode<kWidth>>& nodes, const Ray& ray, Hit& hit, HitFilter filter, const void* pUserData) const;
+
+        uint32_t mWidth = 4;
+        std::vector<WideBVHNode<4>> mNodes4;    ///< Nodes if mWidth == 4.
+        std::vector<WideBVHNode<8>> mNodes8;    ///< Nodes if mWidth == 8.
+        std::vector<Triangle> mTriangles;
+        AABB mBounds;
+    };
+}
@@ -0,0 +1,224 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "WideBVH.h"
+#include <algorithm>
+#include <array>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBinCount = 16;
+        const uint32_t kMaxSAHDepth = 48;       ///< Beyond this depth median splits are used to bound the tree depth.
+
+        struct BuildItem
+        {
+            uint32_t nodeIndex;
+            uint32_t begin;
+            uint32_t end;
+            uint32_t depth;
+        };
+
+        struct Range
+        {
+            uint32_t begin;
+            uint32_t end;
+            AABB bounds;
+
+            uint32_t count() const { return end - begin; }
+        };
+
+        template<uint32_t kWidth>
+        void buildWideBVHImpl(const AABB* primBounds, uint32_t primCount, uint32_t maxLeafSize, std::vector<WideBVHNode<kWidth>>& nodes, std::vector<uint32_t>& primRefs)
+        {
+            nodes.clear();
+            primRefs.resize(primCount);
+            if (primCount == 0) return;
+            FALCOR_ASSERT(primBounds);
+            FALCOR_ASSERT(maxLeafSize > 0);
+
+            std::vector<float3> centroids(primCount);
+            std::vector<uint32_t>& refs = primRefs;
+            for (uint32_t i = 0; i < primCount; i++)
+            {
+                centroids[i] = primBounds[i].valid() ? primBounds[i].center() : float3(0.f);
+                refs[i] = i;
+            }
+
+            auto computeBounds = [&](uint32_t begin, uint32_t end)
+            {
+                AABB b;
+                for (uint32_t i = begin; i < end; i++) b.include(primBounds[refs[i]]);
+                return b;
+            };
+
+            // Split a range in two. Returns the split position.
+            auto split = [&](uint32_t begin, uint32_t end, bool useSAH) -> uint32_t
+            {
+                AABB centroidBounds;
+                for (uint32_t i = begin; i < end; i++) centroidBounds.include(centroids[refs[i]]);
+                float3 extent = centroidBounds.extent();
+                uint32_t mid = begin + (end - begin) / 2;
+
+                auto medianSplit = [&](uint32_t axis)
+                {
+                    std::nth_element(refs.begin() + begin, refs.begin() + mid, refs.begin() + end,
+                        [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+                    return mid;
+                };
+
+                uint32_t largestAxis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+                if (extent[largestAxis] <= 0.f) return mid; // All centroids coincide, any split is as good as another.
+                if (!useSAH) return medianSplit(largestAxis);
+
+                // Binned SAH over all three axes.
+                float bestCost = std::numeric_limits<float>::infinity();
+                uint32_t bestAxis = largestAxis;
+                uint32_t bestBin = 0;
+                for (uint32_t axis = 0; axis < 3; axis++)
+                {
+                    if (extent[axis] <= 0.f) continue;
+                    float scale = kBinCount / extent[axis];
+                    std::array<AABB, kBinCount> binBounds;
+                    std::array<uint32_t, kBinCount> binCounts = {};
+                    for (uint32_t i = begin; i < end; i++)
+                    {
+                        uint32_t bin = std::min(kBinCount - 1, (uint32_t)((centroids[refs[i]][axis] - centroidBounds.minPoint[axis]) * scale));
+                        binBounds[bin].include(primBounds[refs[i]]);
+                        binCounts[bin]++;
+                    }
+
+                    // Sweep from the right to get the cost of the right side for each split plane.
+                    std::array<float, kBinCount> rightCost = {};
+                    AABB acc;
+                    uint32_t count = 0;
+                    for (uint32_t bin = kBinCount - 1; bin > 0; bin--)
+                    {
+                        acc.include(binBounds[bin]);
+                        count += binCounts[bin];
+                        rightCost[bin] = count > 0 ? acc.area() * count : 0.f;
+                    }
+
+                    acc = AABB();
+                    count = 0;
+                    for (uint32_t bin = 0; bin < kBinCount - 1; bin++)
+                    {
+                        acc.include(binBounds[bin]);
+                        count += binCounts[bin];
+                        float cost = (count > 0 ? acc.area() * count : 0.f) + rightCost[bin + 1];
+                        if (cost < bestCost)
+                        {
+                            bestCost = cost;
+                            bestAxis = axis;
+                            bestBin = bin;
+                        }
+                    }
+                }
+
+                float scale = kBinCount / extent[bestAxis];
+                float minPoint = centroidBounds.minPoint[bestAxis];
+                auto it = std::partition(refs.begin() + begin, refs.begin() + end, [&](uint32_t i)
+                {
+                    return std::min(kBinCount - 1, (uint32_t)((centroids[i][bestAxis] - minPoint) * scale)) <= bestBin;
+                });
+                uint32_t pos = (uint32_t)(it - refs.begin());
+                if (pos == begin || pos == end) return medianSplit(bestAxis);
+                return pos;
+            };
+
+            auto allocNode = [&]()
+            {
+                nodes.emplace_back();
+                return (uint32_t)nodes.size() - 1;
+            };
+
+            std::vector<BuildItem> work;
+            work.push_back({ allocNode(), 0, primCount, 0 });
+
+            while (!work.empty())
+            {
+                BuildItem item = work.back();
+                work.pop_back();
+
+                // Gather up to kWidth children by repeatedly splitting the child with the largest surface area.
+                std::array<Range, kWidth> children;
+                uint32_t childCount = 1;
+                children[0] = { item.begin, item.end, computeBounds(item.begin, item.end) };
+                while (childCount < kWidth)
+                {
+                    int best = -1;
+                    float bestArea = -1.f;
+                    for (uint32_t i = 0; i < childCount; i++)
+                    {
+                        if (children[i].count() > maxLeafSize && children[i].bounds.area() > bestArea)
+                        {
+                            best = (int)i;
+                            bestArea = children[i].bounds.area();
+                        }
+                    }
+                    if (best < 0) break;
+
+                    Range r = children[best];
+                    uint32_t pos = split(r.begin, r.end, item.depth < kMaxSAHDepth);
+                    children[best] = { r.begin, pos, computeBounds(r.begin, pos) };
+                    children[childCount++] = { pos, r.end, computeBounds(pos, r.end) };
+                }
+
+                for (uint32_t i = 0; i < childCount; i++)
+                {
+                    const Range& r = children[i];
+                    uint32_t index;
+                    uint32_t count = 0;
+                    if (r.count() <= maxLeafSize)
+                    {
+                        index = r.begin;
+                        count = r.count();
+                    }
+                    else
+                    {
+                        index = allocNode();
+                        work.push_back({ index, r.begin, r.end, item.depth + 1 });
+                    }
+
+                    nodes[item.nodeIndex].setChild(i, r.bounds, index, count);
+                }
+            }
+        }
+    }
+
+    void buildWideBVH(const AABB* primBounds, uint32_t primCount, uint32_t maxLeafSize, std::vector<WideBVHNode<4>>& nodes, std::vector<uint32_t>& primRefs)
+    {
+        buildWideBVHImpl(primBounds, primCount, maxLeafSize, nodes, primRefs);
+    }
+
+    void buildWideBVH(const AABB* primBounds, uint32_t primCount, uint32_t maxLeafSize, std::vector<WideBVHNode<8>>& nodes, std::vector<uint32_t>& primRefs)
+    {
+        buildWideBVHImpl(primBounds, primCount, maxLeafSize, nodes, primRefs);
+    }
+}
@@ -0,0 +1,211 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Framework.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Vector.h"
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    /** Ray for BVH traversal on the CPU.
+    */
+    struct BVHRay
+    {
+        float3 origin;
+        float tMin = 0.f;
+        float3 dir;
+        float tMax = std::numeric_limits<float>::max();
+
+        BVHRay() = default;
+        BVHRay(const float3& origin_, const float3& dir_, float tMin_ = 0.f, float tMax_ = std::numeric_limits<float>::max())
+            : origin(origin_), tMin(tMin_), dir(dir_), tMax(tMax_) {}
+
+        /** Get the reciprocal of the direction, with zero components replaced by a tiny value of the same sign.
+        */
+        float3 getInvDir() const
+        {
+            const float kEps = 1e-20f;
+            auto inv = [kEps](float x) { return 1.f / (std::abs(x) > kEps ? x : std::copysign(kEps, x)); };
+            return float3(inv(dir.x), inv(dir.y), inv(dir.z));
+        }
+    };
+
+    /** Node of a wide BVH.
+
+        The child bounds are stored in structure-of-arrays form, so that the slab tests
+        against all children of a node are evaluated together by the compiler's vectorizer.
+        Empty child slots have index kInvalidIndex. Their bounds are stored inverted, but the
+        slab test does not reliably reject them, so traversal must skip them with isValid().
+        A child is a leaf if count > 0, in which case index points to its first primitive.
+        Otherwise index is the index of the child node.
+    */
+    template<uint32_t kWidth>
+    struct WideBVHNode
+    {
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+        float minX[kWidth], minY[kWidth], minZ[kWidth];
+        float maxX[kWidth], maxY[kWidth], maxZ[kWidth];
+        uint32_t index[kWidth];
+        uint32_t count[kWidth];
+
+        WideBVHNode()
+        {
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                setChildBounds(i, AABB());
+                index[i] = kInvalidIndex;
+                count[i] = 0;
+            }
+        }
+
+        bool isValid(uint32_t i) const { return index[i] != kInvalidIndex; }
+
+        void setChild(uint32_t i, const AABB& bounds, uint32_t index_, uint32_t count_)
+        {
+            setChildBounds(i, bounds);
+            index[i] = index_;
+            count[i] = count_;
+        }
+
+        void setChildBounds(uint32_t i, const AABB& bounds)
+        {
+            if (!bounds.valid())
+            {
+                minX[i] = minY[i] = minZ[i] = std::numeric_limits<float>::infinity();
+                maxX[i] = maxY[i] = maxZ[i] = -std::numeric_limits<float>::infinity();
+                return;
+            }
+            minX[i] = bounds.minPoint.x;
+            minY[i] = bounds.minPoint.y;
+            minZ[i] = bounds.minPoint.z;
+            maxX[i] = bounds.maxPoint.x;
+            maxY[i] = bounds.maxPoint.y;
+            maxZ[i] = bounds.maxPoint.z;
+        }
+
+        /** Get the union of the bounds of all valid children.
+        */
+        AABB getBounds() const
+        {
+            AABB bounds;
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                if (!isValid(i)) continue;
+                bounds.include(float3(minX[i], minY[i], minZ[i]));
+                bounds.include(float3(maxX[i], maxY[i], maxZ[i]));
+            }
+            return bounds;
+        }
+
+        /** Intersect a ray with the bounds of all children.
+            \param[in] invDir Reciprocal of the ray direction.
+            \param[in] originScaled Ray origin multiplied by -invDir.
+            \param[in] tMin Ray min distance.
+            \param[in] tMax Ray max distance.
+            \param[out] tNear Entry distance for each child.
+            \return Bit mask of the children that are hit.
+        */
+        uint32_t intersect(const float3& invDir, const float3& originScaled, float tMin, float tMax, float tNear[kWidth]) const
+        {
+            uint32_t mask = 0;
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                float tx0 = minX[i] * invDir.x + originScaled.x;
+                float tx1 = maxX[i] * invDir.x + originScaled.x;
+                float ty0 = minY[i] * invDir.y + originScaled.y;
+                float ty1 = maxY[i] * invDir.y + originScaled.y;
+                float tz0 = minZ[i] * invDir.z + originScaled.z;
+                float tz1 = maxZ[i] * invDir.z + originScaled.z;
+                float t0 = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), tMin));
+                float t1 = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+                tNear[i] = t0;
+                mask |= (t0 <= t1 ? 1u : 0u) << i;
+            }
+            return mask;
+        }
+    };
+
+    /** Entry of a BVH traversal stack.
+    */
+    struct BVHStackEntry
+    {
+        static constexpr uint32_t kMaxSize = 1024;  ///< Stack size that is enough for 8-wide trees of the depth produced by buildWideBVH().
+
+        uint32_t index;     ///< Node index, or first primitive if count > 0.
+        uint32_t count;     ///< Number of primitives if the entry is a leaf, 0 otherwise.
+        float tNear;        ///< Entry distance of the ray.
+    };
+
+    /** Push the children of a node that are hit onto a traversal stack.
+        The children are sorted so that the nearest one is popped first.
+        \param[in] node Node with index/count arrays and isValid().
+        \param[in] hitMask Bit mask of the children that are hit.
+        \param[in] tNear Entry distance for each child.
+        \param[in,out] stack Traversal stack.
+        \param[in,out] stackSize Number of entries on the stack.
+    */
+    template<uint32_t kWidth, typename Node>
+    void pushHitChildren(const Node& node, uint32_t hitMask, const float tNear[kWidth], BVHStackEntry* stack, uint32_t& stackSize)
+    {
+        const uint32_t first = stackSize;
+        for (uint32_t i = 0; i < kWidth; i++)
+        {
+            if ((hitMask & (1u << i)) == 0 || !node.isValid(i)) continue;
+            FALCOR_ASSERT(stackSize < BVHStackEntry::kMaxSize);
+            BVHStackEntry e = { node.index[i], node.count[i], tNear[i] };
+            uint32_t j = stackSize++;
+            while (j > first && stack[j - 1].tNear < e.tNear)
+            {
+                stack[j] = stack[j - 1];
+                j--;
+            }
+            stack[j] = e;
+        }
+    }
+
+    /** Build the topology of a wide BVH over a set of primitives.
+
+        The builder uses binned SAH splits, falling back to median splits in degenerate cases
+        and beyond a fixed depth to bound the tree depth. A node's children are gathered by
+        repeatedly splitting the child with the largest surface area until kWidth children exist.
+
+        Leaf children reference a range [index, index + count) in primRefs, which holds the
+        primitive indices in leaf order. Child nodes are always stored after their parent.
+
+        \param[in] primBounds Bounds of each primitive. Invalid bounds are allowed and produce leaves that are never hit.
+        \param[in] primCount Number of primitives.
+        \param[in] maxLeafSize Max number of primitives per leaf.
+        \param[out] nodes Nodes, the root first. Empty if primCount is zero.
+        \param[out] primRefs Primitive indices in leaf order.
+    */
+    FALCOR_API void buildWideBVH(const AABB* primBounds, uint32_t primCount, uint32_t maxLeafSize, std::vector<WideBVHNode<4>>& nodes, std::vector<uint32_t>& primRefs);
+    FALCOR_API void buildWideBVH(const AABB* primBounds, uint32_t primCount, uint32_t maxLeafSize, std::vector<WideBVHNode<8>>& nodes, std::vector<uint32_t>& primRefs);
+}
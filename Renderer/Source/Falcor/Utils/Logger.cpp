@@ -27,18 +27,90 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "Logger.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace Falcor
 {
+    std::atomic<Logger::Level> Logger::sVerbosity = Logger::Level::Info;
+
     namespace
     {
-        Logger::Level sVerbosity = Logger::Level::Info;
-        Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
+        std::atomic<Logger::OutputFlags> sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
         std::filesystem::path sLogFilePath;
+        std::atomic<uint32_t> sRateLimit = 10;
 
 #if FALCOR_ENABLE_LOGGER
+        const std::chrono::milliseconds kWakeInterval(10);      ///< Maximum time the writer thread sleeps before checking the queue.
+        const std::chrono::milliseconds kSummaryInterval(2000); ///< Interval at which rate limiting summaries are written.
+
         bool sInitialized = false;
         FILE* sLogFile = nullptr;
+        std::filesystem::path sCreatedLogFilePath;  ///< Path of the log file created by this process, reopened in append mode after shutdown().
+
+        /** Queued log message. Messages form an intrusive singly-linked list.
+        */
+        struct Message
+        {
+            Logger::Level level;
+            size_t key;
+            std::string text;
+            Message* pNext = nullptr;
+        };
+
+        /** Rate limiting state for a single message key.
+        */
+        struct RateLimitEntry
+        {
+            uint32_t count = 0;         ///< Number of messages printed in the current interval.
+            uint64_t suppressed = 0;    ///< Number of messages suppressed in the current interval.
+            Logger::Level level = Logger::Level::Info;
+            std::string example;        ///< First suppressed message.
+        };
+
+        // Producer side. Messages are pushed to a lock-free stack, which the writer thread drains as a whole.
+        std::atomic<Message*> sQueueHead = nullptr;
+        std::atomic<uint64_t> sPushedCount = 0;
+        std::atomic<bool> sWriterRunning = false;
+
+        // The objects shared with the writer thread are allocated once and never freed. If the process
+        // exits without Logger::shutdown(), the thread may still be running during static destruction.
+
+        // Writer thread state, protected by sMutex.
+        std::mutex& sMutex = *new std::mutex();
+        std::condition_variable& sWakeCondition = *new std::condition_variable();
+        std::condition_variable& sFlushCondition = *new std::condition_variable();
+        std::thread& sWriterThread = *new std::thread();
+        bool sTerminate = false;
+        bool sForceSummary = false;
+        uint64_t sWrittenCount = 0;
+
+        // Output state, protected by sWriteMutex.
+        std::mutex& sWriteMutex = *new std::mutex();
+        std::unordered_map<size_t, RateLimitEntry>& sRateLimitEntries = *new std::unordered_map<size_t, RateLimitEntry>();
+        std::chrono::steady_clock::time_point sLastSummaryTime = std::chrono::steady_clock::now();
+
+        const char* getLogLevelString(Logger::Level level)
+        {
+            switch (level)
+            {
+            case Logger::Level::Fatal:
+                return "(Fatal)";
+            case Logger::Level::Error:
+                return "(Error)";
+            case Logger::Level::Warning:
+                return "(Warning)";
+            case Logger::Level::Info:
+                return "(Info)";
+            case Logger::Level::Debug:
+                return "(Debug)";
+            default:
+                FALCOR_UNREACHABLE();
+                return nullptr;
+            }
+        }
 
         std::filesystem::path generateLogFilePath()
         {
@@ -56,10 +128,12 @@ namespace Falcor
                 sLogFilePath = generateLogFilePath();
             }
 
-            pFile = std::fopen(sLogFilePath.string().c_str(), "w");
+            const bool append = sLogFilePath == sCreatedLogFilePath;
+            pFile = std::fopen(sLogFilePath.string().c_str(), append ? "a" : "w");
             if (pFile != nullptr)
             {
                 // Success
+                sCreatedLogFilePath = sLogFilePath;
                 return pFile;
             }
 
@@ -78,16 +152,219 @@ namespace Falcor
 
             if (sLogFile)
             {
-                std::fprintf(sLogFile, "%s", s.c_str());
+                std::fwrite(s.data(), 1, s.size(), sLogFile);
                 std::fflush(sLogFile);
             }
         }
+
+        /** Batch of formatted log lines, written to all outputs at once.
+        */
+        class OutputBatch
+        {
+        public:
+            void append(Logger::Level level, const std::string_view msg)
+            {
+                // Keep stdout/stderr ordering by switching console streams only between segments.
+                bool isError = level <= Logger::Level::Error;
+                if (isError != mConsoleIsError) flushConsole();
+                mConsoleIsError = isError;
+
+                size_t start = mText.size();
+                fmt::format_to(std::back_inserter(mText), "{} {}\n", getLogLevelString(level), msg);
+                mConsoleText.append(mText, start, std::string::npos);
+            }
+
+            void write()
+            {
+                flushConsole();
+                if (mText.empty()) return;
+
+                auto outputs = sOutputs.load();
+                if (is_set(outputs, Logger::OutputFlags::File)) printToLogFile(mText);
+                if (is_set(outputs, Logger::OutputFlags::DebugWindow) && isDebuggerPresent()) printToDebugWindow(mText);
+                mText.clear();
+            }
+
+        private:
+            void flushConsole()
+            {
+                if (mConsoleText.empty()) return;
+                if (is_set(sOutputs.load(), Logger::OutputFlags::Console))
+                {
+                    auto& stream = mConsoleIsError ? std::cerr : std::cout;
+                    stream << mConsoleText;
+                    stream.flush();
+                }
+                mConsoleText.clear();
+            }
+
+            std::string mText;
+            std::string mConsoleText;
+            bool mConsoleIsError = false;
+        };
+
+        /** Check if a message should be suppressed due to rate limiting.
+            Must be called with sWriteMutex held.
+        */
+        bool rateLimit(Message& msg)
+        {
+            uint32_t maxRepeats = sRateLimit.load(std::memory_order_relaxed);
+            if (maxRepeats == 0 || msg.level <= Logger::Level::Error) return false;
+
+            auto& entry = sRateLimitEntries[msg.key];
+            if (entry.count < maxRepeats)
+            {
+                entry.count++;
+                return false;
+            }
+
+            if (entry.suppressed++ == 0)
+            {
+                entry.level = msg.level;
+                entry.example = std::move(msg.text);
+            }
+            return true;
+        }
+
+        /** Write summaries for suppressed messages and reset rate limiting for keys that went quiet.
+            Must be called with sWriteMutex held.
+        */
+        void writeSummaries(OutputBatch& batch, bool force)
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (!force && now - sLastSummaryTime < kSummaryInterval) return;
+            sLastSummaryTime = now;
+
+            for (auto it = sRateLimitEntries.begin(); it != sRateLimitEntries.end();)
+            {
+                auto& entry = it->second;
+                if (entry.suppressed > 0)
+                {
+                    batch.append(entry.level, fmt::format("Suppressed {} similar message(s), e.g.: {}", entry.suppressed, entry.example));
+                    entry.suppressed = 0;
+                    entry.example.clear();
+                    ++it;
+                }
+                else
+                {
+                    // No messages were suppressed during the last interval, start over.
+                    it = sRateLimitEntries.erase(it);
+                }
+            }
+        }
+
+        /** Write all queued messages.
+            \return Number of messages taken from the queue.
+        */
+        uint64_t writeMessages(bool forceSummary)
+        {
+            // Take the whole queue and reverse it to restore submission order.
+            Message* pList = sQueueHead.exchange(nullptr, std::memory_order_acquire);
+            Message* pOrdered = nullptr;
+            while (pList)
+            {
+                Message* pNext = pList->pNext;
+                pList->pNext = pOrdered;
+                pOrdered = pList;
+                pList = pNext;
+            }
+
+            uint64_t count = 0;
+            std::lock_guard<std::mutex> lock(sWriteMutex);
+            OutputBatch batch;
+            while (pOrdered)
+            {
+                std::unique_ptr<Message> pMsg(pOrdered);
+                pOrdered = pOrdered->pNext;
+                if (!rateLimit(*pMsg)) batch.append(pMsg->level, pMsg->text);
+                count++;
+            }
+            writeSummaries(batch, forceSummary);
+            batch.write();
+            return count;
+        }
+
+        void runWriter()
+        {
+            while (true)
+            {
+                bool forceSummary = false;
+                {
+                    std::unique_lock<std::mutex> lock(sMutex);
+                    // Producers notify without holding the lock, so use a timeout to recover from missed wakeups.
+                    sWakeCondition.wait_for(lock, kWakeInterval, [] { return sTerminate || sForceSummary || sQueueHead.load() != nullptr; });
+                    if (sTerminate && sQueueHead.load() == nullptr) break;
+                    forceSummary = sForceSummary;
+                }
+
+                uint64_t count = writeMessages(forceSummary);
+
+                {
+                    std::lock_guard<std::mutex> lock(sMutex);
+                    sWrittenCount += count;
+                    if (forceSummary) sForceSummary = false;
+                }
+                sFlushCondition.notify_all();
+            }
+        }
+
+        void startWriter()
+        {
+            std::lock_guard<std::mutex> lock(sMutex);
+            if (sWriterRunning) return;
+            sTerminate = false;
+            sWriterThread = std::thread(runWriter);
+            sWriterRunning = true;
+        }
+
+        void stopWriter()
+        {
+            {
+                std::lock_guard<std::mutex> lock(sMutex);
+                if (!sWriterRunning) return;
+                sTerminate = true;
+            }
+            sWakeCondition.notify_one();
+            if (sWriterThread.joinable()) sWriterThread.join();
+            {
+                std::lock_guard<std::mutex> lock(sMutex);
+                sWriterRunning = false;
+                sTerminate = false;
+            }
+            sFlushCondition.notify_all();
+        }
+
+        void pushMessage(Logger::Level level, const std::string_view msg)
+        {
+            if (!sWriterRunning.load(std::memory_order_acquire)) startWriter();
+
+            // Identical messages of different levels are rate limited separately.
+            size_t key = std::hash<std::string_view>()(msg) ^ ((size_t)level * 0x9e3779b97f4a7c15ull);
+            Message* pMsg = new Message{ level, key, std::string(msg) };
+            Message* pHead = sQueueHead.load(std::memory_order_relaxed);
+            do
+            {
+                pMsg->pNext = pHead;
+            } while (!sQueueHead.compare_exchange_weak(pHead, pMsg, std::memory_order_release, std::memory_order_relaxed));
+            sPushedCount.fetch_add(1, std::memory_order_release);
+
+            // Only wake the writer when the queue was empty, it drains everything in one go.
+            if (pHead == nullptr) sWakeCondition.notify_one();
+        }
 #endif
     }
 
     void Logger::shutdown()
     {
 #if FALCOR_ENABLE_LOGGER
+        stopWriter();
+        uint64_t count = writeMessages(true);
+        {
+            std::lock_guard<std::mutex> lock(sMutex);
+            sWrittenCount += count;
+        }
+
+        std::lock_guard<std::mutex> lock(sWriteMutex);
         if(sLogFile)
         {
             fclose(sLogFile);
@@ -97,51 +374,27 @@ namespace Falcor
 #endif
     }
 
-    const char* getLogLevelString(Logger::Level level)
+    void Logger::flush()
     {
-        switch (level)
-        {
-        case Logger::Level::Fatal:
-            return "(Fatal)";
-        case Logger::Level::Error:
-            return "(Error)";
-        case Logger::Level::Warning:
-            return "(Warning)";
-        case Logger::Level::Info:
-            return "(Info)";
-        case Logger::Level::Debug:
-            return "(Debug)";
-        default:
-            FALCOR_UNREACHABLE();
-            return nullptr;
-        }
+#if FALCOR_ENABLE_LOGGER
+        uint64_t target = sPushedCount.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(sMutex);
+        if (!sWriterRunning) return;
+        sForceSummary = true;
+        sWakeCondition.notify_one();
+        sFlushCondition.wait(lock, [target] { return !sWriterRunning || (sWrittenCount >= target && !sForceSummary); });
+#endif
     }
 
     void Logger::log(Level level, const std::string_view msg)
     {
 #if FALCOR_ENABLE_LOGGER
-        if (level <= sVerbosity)
+        if (isEnabled(level))
         {
-            std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
-
-            // Write to console.
-            if (is_set(sOutputs, OutputFlags::Console))
-            {
-                if (level > Logger::Level::Error) std::cout << s;
-                else std::cerr << s;
-            }
+            pushMessage(level, msg);
 
-            // Write to file.
-            if (is_set(sOutputs, OutputFlags::File))
-            {
-                printToLogFile(s);
-            }
-
-            // Write to debug window if debugger is attached.
-            if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
-            {
-                printToDebugWindow(s);
-            }
+            // Make sure errors are visible before the caller potentially terminates.
+            if (level <= Level::Error) flush();
         }
 #endif
     }
@@ -149,6 +402,7 @@ namespace Falcor
     bool Logger::setLogFilePath(const std::filesystem::path& path)
     {
 #if FALCOR_ENABLE_LOGGER
+        std::lock_guard<std::mutex> lock(sWriteMutex);
         if (sLogFile)
         {
             return false;
@@ -170,4 +424,7 @@ namespace Falcor
     Logger::OutputFlags Logger::getOutputs() { return sOutputs; }
 
     const std::filesystem::path& Logger::getLogFilePath() { return sLogFilePath; }
+
+    void Logger::setRateLimit(uint32_t maxRepeats) { sRateLimit = maxRepeats; }
+    uint32_t Logger::getRateLimit() { return sRateLimit; }
 }
@@ -27,12 +27,25 @@
  **************************************************************************/
 #pragma once
 #include "Core/Framework.h"
+#include <atomic>
 
 namespace Falcor
 {
     /** Container class for logging messages.
         To enable log messages, make sure FALCOR_ENABLE_LOGGER is set to `1` in FalcorConfig.h.
         Messages are only printed to the selected outputs if they match the verbosity level.
+
+        Logging is thread-safe. Messages are pushed to a lock-free queue and written
+        in batches by a background thread, so callers never block on I/O.
+        Error and fatal messages are flushed before log() returns.
+
+        To avoid flooding the outputs, repeated messages below error level are rate limited.
+        Messages are considered repeated if they have the same level and the same formatted
+        text. Once the limit is reached, further copies are counted and a single summary
+        line is written periodically.
+
+        The writer thread is stopped by shutdown(), which must be called explicitly during
+        application teardown. Sample::run() does this.
     */
     class FALCOR_API Logger
     {
@@ -61,9 +74,15 @@ namespace Falcor
         };
 
         /** Shutdown the logger and close the log file.
+            All pending messages are written before returning. Logging again restarts the writer thread.
         */
         static void shutdown();
 
+        /** Block until all messages logged so far have been written.
+            This also writes summaries for messages that are currently being rate limited.
+        */
+        static void flush();
+
         /** Set the logger verbosity.
             \param level Log level.
         */
@@ -74,6 +93,13 @@ namespace Falcor
         */
         static Level getVerbosity();
 
+        /** Check if messages of a given level are printed.
+            This is cheap and can be used to skip building expensive log messages.
+            \param level Log level.
+            \return Returns true if messages of the given level are printed.
+        */
+        static bool isEnabled(Level level) { return enabled() && level <= sVerbosity.load(std::memory_order_relaxed); }
+
         /** Set the logger outputs.
             \param outputs Log outputs.
         */
@@ -96,6 +122,15 @@ namespace Falcor
         */
         static const std::filesystem::path& getLogFilePath();
 
+        /** Set the maximum number of identical messages printed before rate limiting kicks in.
+            \param[in] maxRepeats Maximum number of identical messages. 0 disables rate limiting.
+        */
+        static void setRateLimit(uint32_t maxRepeats);
+
+        /** Get the maximum number of identical messages printed before rate limiting kicks in.
+        */
+        static uint32_t getRateLimit();
+
         /** Check if the logger is enabled.
         */
         static constexpr bool enabled() { return FALCOR_ENABLE_LOGGER != 0; }
@@ -108,6 +143,8 @@ namespace Falcor
 
     private:
         Logger() = delete;
+
+        static std::atomic<Level> sVerbosity;
     };
 
     FALCOR_ENUM_CLASS_OPERATORS(Logger::OutputFlags);
@@ -124,7 +161,7 @@ namespace Falcor
     template<typename... Args>
     inline void logDebug(const std::string_view fmtString, Args&&... args)
     {
-        Logger::log(Logger::Level::Debug, fmt::format(fmtString, std::forward<Args>(args)...));
+        if (Logger::isEnabled(Logger::Level::Debug)) Logger::log(Logger::Level::Debug, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 
     inline void logInfo(const std::string_view msg)
@@ -135,7 +172,7 @@ namespace Falcor
     template<typename... Args>
     inline void logInfo(const std::string_view fmtString, Args&&... args)
     {
-        Logger::log(Logger::Level::Info, fmt::format(fmtString, std::forward<Args>(args)...));
+        if (Logger::isEnabled(Logger::Level::Info)) Logger::log(Logger::Level::Info, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 
     inline void logWarning(const std::string_view msg)
@@ -146,7 +183,7 @@ namespace Falcor
     template<typename... Args>
     inline void logWarning(const std::string_view fmtString, Args&&... args)
     {
-        Logger::log(Logger::Level::Warning, fmt::format(fmtString, std::forward<Args>(args)...));
+        if (Logger::isEnabled(Logger::Level::Warning)) Logger::log(Logger::Level::Warning, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 
     inline void logError(const std::string_view msg)
@@ -157,7 +194,7 @@ namespace Falcor
     template<typename... Args>
     inline void logError(const std::string_view fmtString, Args&&... args)
     {
-        Logger::log(Logger::Level::Error, fmt::format(fmtString, std::forward<Args>(args)...));
+        if (Logger::isEnabled(Logger::Level::Error)) Logger::log(Logger::Level::Error, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 
     inline void logFatal(const std::string_view msg)
@@ -168,6 +205,6 @@ namespace Falcor
     template<typename... Args>
     inline void logFatal(const std::string_view fmtString, Args&&... args)
     {
-        Logger::log(Logger::Level::Fatal, fmt::format(fmtString, std::forward<Args>(args)...));
+        if (Logger::isEnabled(Logger::Level::Fatal)) Logger::log(Logger::Level::Fatal, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 }
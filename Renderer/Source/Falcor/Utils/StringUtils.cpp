@@ -111,10 +111,10 @@ namespace Falcor
 
         for (size_t i = 0, j = 0; i < inLen;)
         {
-            uint32_t a = in[i] == '=' ? 0 & i++ : kDecodingTable[static_cast<uint32_t>(in[i++])];
-            uint32_t b = in[i] == '=' ? 0 & i++ : kDecodingTable[static_cast<uint32_t>(in[i++])];
-            uint32_t c = in[i] == '=' ? 0 & i++ : kDecodingTable[static_cast<uint32_t>(in[i++])];
-            uint32_t d = in[i] == '=' ? 0 & i++ : kDecodingTable[static_cast<uint32_t>(in[i++])];
+            uint32_t a = in[i] == '=' ? 0 & i++ : kDecodingTable[static_cast<uint8_t>(in[i++])];
+            uint32_t b = in[i] == '=' ? 0 & i++ : kDecodingTable[static_cast<uint8_t>(in[i++])];
+            uint32_t c = in[i] == '=' ? 0 & i++ : kDecodingTable[static_cast<uint8_t>(in[i++])];
+            uint32_t d = in[i] == '=' ? 0 & i++ : kDecodingTable[static_cast<uint8_t>(in[i++])];
 
             uint32_t triple = (a << 3 * 6) + (b << 2 * 6) + (c << 1 * 6) + (d << 0 * 6);
 
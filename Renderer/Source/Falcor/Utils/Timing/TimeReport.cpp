@@ -29,6 +29,7 @@
 #include "TimeReport.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include "Core/Platform/OS.h"
 #include <numeric>
 
 namespace Falcor
@@ -53,9 +54,10 @@ namespace Falcor
 
     void TimeReport::printToLog()
     {
-        for (const auto& [task, duration] : mMeasurements)
+        for (const auto& m : mMeasurements)
         {
-            logInfo(padStringToLength(task + ":", 25) + " " + std::to_string(duration) + " s" + (mTotal > 0.0 && !mMeasurements.empty() ? ", " + std::to_string(100.0 * duration / mTotal) + "% of total" : ""));
+            logInfo(padStringToLength(m.name + ":", 25) + " " + std::to_string(m.duration) + " s" + (mTotal > 0.0 && !mMeasurements.empty() ? ", " + std::to_string(100.0 * m.duration / mTotal) + "% of total" : "")
+                + (m.peakResidentMemory > 0 ? ", peak RSS " + formatByteSize(m.peakResidentMemory) : ""));
         }
     }
 
@@ -64,12 +66,12 @@ namespace Falcor
         auto currentTime = CpuTimer::getCurrentTimePoint();
         std::chrono::duration<double> duration = currentTime - mLastMeasureTime;
         mLastMeasureTime = currentTime;
-        mMeasurements.push_back({name, duration.count()});
+        mMeasurements.push_back({ name, duration.count(), getProcessPeakResidentMemory() });
     }
 
     void TimeReport::addTotal(const std::string name)
     {
-        mTotal = std::accumulate(mMeasurements.begin(), mMeasurements.end(), 0.0, [] (double t, auto &&m) { return t + m.second; });
-        mMeasurements.push_back({"Total", mTotal});
+        mTotal = std::accumulate(mMeasurements.begin(), mMeasurements.end(), 0.0, [] (double t, auto &&m) { return t + m.duration; });
+        mMeasurements.push_back({ "Total", mTotal, getProcessPeakResidentMemory() });
     }
 }
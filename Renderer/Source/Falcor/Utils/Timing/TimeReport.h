@@ -29,12 +29,12 @@
 #include "CpuTimer.h"
 #include <string>
 #include <vector>
-#include <utility>
 
 namespace Falcor
 {
     /** Utility class to record a number of timing measurements and print them afterwards.
         This is mainly intended for measuring longer running tasks on the CPU.
+        Each measurement also records the peak resident memory of the process at the time of the measurement.
     */
     class FALCOR_API TimeReport
     {
@@ -59,14 +59,25 @@ namespace Falcor
         */
         void measure(const std::string& name);
 
+        /** Get the peak resident memory of the process in bytes recorded by the last measurement, or zero if there are no measurements.
+        */
+        uint64_t getPeakResidentMemory() const { return mMeasurements.empty() ? 0 : mMeasurements.back().peakResidentMemory; }
+
         /** Add a record containing the total of all measurements.
             \param[in] name Name of the record.
         */
         void addTotal(const std::string name = "Total");
 
     private:
+        struct Measurement
+        {
+            std::string name;
+            double duration = 0.0;              ///< Duration in seconds.
+            uint64_t peakResidentMemory = 0;    ///< Peak resident memory of the process in bytes.
+        };
+
         CpuTimer::TimePoint mLastMeasureTime;
-        std::vector<std::pair<std::string, double>> mMeasurements;
+        std::vector<Measurement> mMeasurements;
         double mTotal = 0.0;
     };
 }
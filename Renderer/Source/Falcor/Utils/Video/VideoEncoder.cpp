@@ -91,13 +91,32 @@ namespace Falcor
             }
         }
 
+        const char* getPresetName(VideoEncoder::Preset preset)
+        {
+            switch (preset)
+            {
+            case VideoEncoder::Preset::UltraFast: return "ultrafast";
+            case VideoEncoder::Preset::SuperFast: return "superfast";
+            case VideoEncoder::Preset::VeryFast: return "veryfast";
+            case VideoEncoder::Preset::Faster: return "faster";
+            case VideoEncoder::Preset::Fast: return "fast";
+            case VideoEncoder::Preset::Medium: return "medium";
+            case VideoEncoder::Preset::Slow: return "slow";
+            case VideoEncoder::Preset::Slower: return "slower";
+            case VideoEncoder::Preset::VerySlow: return "veryslow";
+            default:
+                FALCOR_UNREACHABLE();
+                return "medium";
+            }
+        }
+
         static bool error(const std::filesystem::path& path, const std::string& msg)
         {
             reportError(fmt::format("Error when creating video capture file '{}'.\n{}", path, msg));
             return false;
         }
 
-        AVCodecContext* createCodecContext(AVFormatContext* pCtx, uint32_t width, uint32_t height, uint32_t fps, float bitrateMbps, uint32_t gopSize, AVCodecID codecID, AVCodec* pCodec)
+        AVCodecContext* createCodecContext(AVFormatContext* pCtx, uint32_t width, uint32_t height, uint32_t fps, float bitrateMbps, uint32_t gopSize, uint32_t threadCount, AVCodecID codecID, AVCodec* pCodec)
         {
             // Initialize the codec context
             AVCodecContext* pCodecCtx = avcodec_alloc_context3(pCodec);
@@ -108,6 +127,8 @@ namespace Falcor
             pCodecCtx->time_base = { 1, (int)fps };
             pCodecCtx->gop_size = gopSize;
             pCodecCtx->pix_fmt = getPictureFormatFromCodec(codecID);
+            pCodecCtx->thread_count = (int)threadCount;
+            pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
             // Some formats want stream headers to be separate
             if (pCtx->oformat->flags & AVFMT_GLOBALHEADER)
@@ -164,7 +185,7 @@ namespace Falcor
             return pFrame;
         }
 
-        bool openVideo(AVCodec* pCodec, AVCodecContext* pCodecCtx, AVFrame*& pFrame, const std::filesystem::path& path)
+        bool openVideo(AVCodec* pCodec, AVCodecContext* pCodecCtx, VideoEncoder::Preset preset, AVFrame*& pFrame, const std::filesystem::path& path)
         {
             AVDictionary* param = nullptr;
 
@@ -172,12 +193,11 @@ namespace Falcor
             {
                 // H.264 defaults to lossless currently. This should be changed in the future.
                 av_dict_set(&param, "qp", "0", 0);
-                /*
-                Change options to trade off compression efficiency against encoding speed. If you specify a preset, the changes it makes will be applied before all other parameters are applied.
-                You should generally set this option to the slowest you can bear.
-                Values available: ultrafast, superfast, veryfast, faster, fast, medium, slow, slower, veryslow, placebo.
-                */
-                av_dict_set(&param, "preset", "veryslow", 0);
+            }
+            if (pCodecCtx->codec_id == AV_CODEC_ID_H264 || pCodecCtx->codec_id == AV_CODEC_ID_HEVC)
+            {
+                // The preset trades off compression efficiency against encoding speed. It is applied before all other parameters.
+                av_dict_set(&param, "preset", getPresetName(preset), 0);
             }
 
             // Open the codec
@@ -251,14 +271,14 @@ namespace Falcor
             return false;
         }
 
-        mpCodecContext = createCodecContext(mpOutputContext, desc.width, desc.height, desc.fps, desc.bitrateMbps, desc.gopSize, getCodecID(desc.codec), pVideoCodec);
+        mpCodecContext = createCodecContext(mpOutputContext, desc.width, desc.height, desc.fps, desc.bitrateMbps, desc.gopSize, desc.threadCount, getCodecID(desc.codec), pVideoCodec);
         if(mpCodecContext == nullptr)
         {
             return false;
         }
 
         // Open the video stream
-        if(openVideo(pVideoCodec, mpCodecContext, mpFrame, mPath) == false)
+        if(openVideo(pVideoCodec, mpCodecContext, desc.preset, mpFrame, mPath) == false)
         {
             return false;
         }
@@ -286,10 +306,8 @@ namespace Falcor
 
         mFormat = desc.format;
         mRowPitch = getFormatBytesPerBlock(desc.format) * desc.width;
-        if(desc.flipY)
-        {
-            mpFlippedImage = new uint8_t[desc.height * mRowPitch];
-        }
+        mHeight = desc.height;
+        mFlipY = desc.flipY;
 
         FALCOR_ASSERT(isFormatSupported(desc.format));
         mpSwsContext = sws_getContext(desc.width, desc.height, getPictureFormatFromFalcorFormat(desc.format), desc.width, desc.height, mpCodecContext->pix_fmt, SWS_POINT, nullptr, nullptr, nullptr);
@@ -297,6 +315,10 @@ namespace Falcor
         {
             return error(mPath, "Failed to allocate SWScale context");
         }
+
+        mMaxQueuedFrames = desc.maxQueuedFrames;
+        if (mMaxQueuedFrames > 0) mEncoderThread = std::thread(&VideoEncoder::runEncoder, this);
+
         return true;
     }
 
@@ -334,6 +356,17 @@ namespace Falcor
 
     void VideoEncoder::endCapture()
     {
+        // Wait for the encoder thread to encode all queued frames.
+        if (mEncoderThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mTerminate = true;
+            }
+            mCondition.notify_all();
+            mEncoderThread.join();
+        }
+
         if(mpOutputContext)
         {
             // Flush the codex
@@ -350,47 +383,111 @@ namespace Falcor
             mpOutputContext = nullptr;
             mpOutputStream = nullptr;
         }
-        safe_delete(mpFlippedImage);
+        mFrameQueue.clear();
+        mFreeFrames.clear();
     }
 
     void VideoEncoder::appendFrame(const void* pData)
     {
-        if(mpFlippedImage)
+        std::vector<uint8_t> data;
         {
-            // Flip the image
-            for(int32_t h = 0; h < mpCodecContext->height; h++)
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mFreeFrames.empty())
             {
-                const uint8_t* pSrc = (uint8_t*)pData + h * mRowPitch;
-                uint8_t* pDst = mpFlippedImage + (mpCodecContext->height - 1 - h) * mRowPitch;
-                memcpy(pDst, pSrc, mRowPitch);
+                data = std::move(mFreeFrames.back());
+                mFreeFrames.pop_back();
             }
+        }
+        data.resize((size_t)mHeight * mRowPitch);
+        std::memcpy(data.data(), pData, data.size());
+        appendFrame(std::move(data));
+    }
+
+    void VideoEncoder::appendFrame(std::vector<uint8_t>&& data)
+    {
+        if (!mpOutputContext) return;
+        FALCOR_ASSERT(data.size() >= (size_t)mHeight * mRowPitch);
+
+        if (!mEncoderThread.joinable())
+        {
+            encodeFrame(data.data());
+            return;
+        }
+
+        // Wait for space in the queue. This throttles rendering to the encoding speed if the encoder can't keep up.
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [&]() { return mFrameQueue.size() < mMaxQueuedFrames; });
+        mFrameQueue.push_back(std::move(data));
+        lock.unlock();
+        mCondition.notify_all();
+    }
+
+    void VideoEncoder::runEncoder()
+    {
+        // This function is the entry point for the encoder thread.
+        // The thread converts and encodes queued frames in order, until terminated and the queue is empty.
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mTerminate || !mFrameQueue.empty(); });
 
-            pData = mpFlippedImage;
+            if (mFrameQueue.empty()) break;
+            std::vector<uint8_t> data = std::move(mFrameQueue.front());
+            mFrameQueue.pop_front();
+
+            lock.unlock();
+
+            encodeFrame(data.data());
+
+            // Keep the frame buffer for reuse and wake up a waiting producer.
+            lock.lock();
+            if (mFreeFrames.size() < mMaxQueuedFrames) mFreeFrames.push_back(std::move(data));
+            lock.unlock();
+            mCondition.notify_all();
         }
+    }
 
-        uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
+    void VideoEncoder::encodeFrame(const uint8_t* pData)
+    {
+        const uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
         int32_t rowPitch[AV_NUM_DATA_POINTERS] = {0};
-        src[0] = (uint8_t*)pData;
-        rowPitch[0] = (int32_t)mRowPitch;
+        if (mFlipY)
+        {
+            // Flip the image by reading rows bottom to top.
+            src[0] = pData + (mHeight - 1) * (size_t)mRowPitch;
+            rowPitch[0] = -(int32_t)mRowPitch;
+        }
+        else
+        {
+            src[0] = pData;
+            rowPitch[0] = (int32_t)mRowPitch;
+        }
+
+        // The codec may still reference the previous frame's buffers.
+        if (av_frame_make_writable(mpFrame) < 0)
+        {
+            logError("Error when encoding video '{}'. Can't make video frame writable.", mPath);
+            return;
+        }
 
         // Scale and convert the image
         sws_scale(mpSwsContext, src, rowPitch, 0, mpCodecContext->height, mpFrame->data, mpFrame->linesize);
 
-        // Encode the frame
+        // Encode the frame and write the available packets.
         int r = avcodec_send_frame(mpCodecContext, mpFrame);
-        mpFrame->pts++;
-        if(r == AVERROR(EAGAIN))
+        if (r == AVERROR(EAGAIN))
         {
-            if(flush(mpCodecContext, mpOutputContext, mpOutputStream, mPath) == false)
-            {
-                return;
-            }
+            if (flush(mpCodecContext, mpOutputContext, mpOutputStream, mPath) == false) return;
+            r = avcodec_send_frame(mpCodecContext, mpFrame);
         }
-        else if(r < 0)
+        mpFrame->pts++;
+        if (r < 0)
         {
-            error(mPath, "Can't send video frame");
+            logError("Error when encoding video '{}'. Can't send video frame.", mPath);
             return;
         }
+        flush(mpCodecContext, mpOutputContext, mpOutputStream, mPath);
     }
 
     FileDialogFilterVec VideoEncoder::getSupportedContainerForCodec(Codec codec)
@@ -430,5 +527,16 @@ namespace Falcor
         codec.value("MPEG2", VideoEncoder::Codec::MPEG2);
         codec.value("H264", VideoEncoder::Codec::H264);
         codec.value("HEVC", VideoEncoder::Codec::HEVC);
+
+        pybind11::enum_<VideoEncoder::Preset> preset(m, "VideoEncoderPreset");
+        preset.value("UltraFast", VideoEncoder::Preset::UltraFast);
+        preset.value("SuperFast", VideoEncoder::Preset::SuperFast);
+        preset.value("VeryFast", VideoEncoder::Preset::VeryFast);
+        preset.value("Faster", VideoEncoder::Preset::Faster);
+        preset.value("Fast", VideoEncoder::Preset::Fast);
+        preset.value("Medium", VideoEncoder::Preset::Medium);
+        preset.value("Slow", VideoEncoder::Preset::Slow);
+        preset.value("Slower", VideoEncoder::Preset::Slower);
+        preset.value("VerySlow", VideoEncoder::Preset::VerySlow);
     }
 }
@@ -26,6 +26,10 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 struct AVFormatContext;
 struct AVStream;
@@ -50,6 +54,21 @@ namespace Falcor
             MPEG4,
         };
 
+        /** Encoder presets for H.264 and HEVC, trading encoding speed against compression efficiency.
+        */
+        enum class Preset : int32_t
+        {
+            UltraFast,
+            SuperFast,
+            VeryFast,
+            Faster,
+            Fast,
+            Medium,
+            Slow,
+            Slower,
+            VerySlow,
+        };
+
         struct Desc
         {
             uint32_t fps = 60;
@@ -61,6 +80,9 @@ namespace Falcor
             ResourceFormat format = ResourceFormat::BGRA8UnormSrgb;
             bool flipY = false;
             std::filesystem::path path;
+            Preset preset = Preset::Medium;     ///< Encoder preset (H.264 and HEVC only).
+            uint32_t threadCount = 0;           ///< Number of codec threads. 0 lets the codec decide.
+            uint32_t maxQueuedFrames = 4;       ///< Maximum number of frames waiting to be encoded. 0 encodes frames synchronously in appendFrame().
         };
 
         ~VideoEncoder();
@@ -71,7 +93,20 @@ namespace Falcor
         */
         static UniquePtr create(const Desc& desc);
 
+        /** Append a frame. The data is copied, and the frame is converted and encoded on the encoder thread.
+            Blocks if the frame queue is full.
+            \param[in] pData Frame data. The size must be width * height * bytes per pixel of the format.
+        */
         void appendFrame(const void* pData);
+
+        /** Append a frame, taking ownership of the data to avoid the copy.
+            Blocks if the frame queue is full.
+            \param[in] data Frame data. The size must be at least width * height * bytes per pixel of the format.
+        */
+        void appendFrame(std::vector<uint8_t>&& data);
+
+        /** End the capture. Waits for all queued frames to be encoded and closes the file.
+        */
         void endCapture();
 
         static bool isFormatSupported(ResourceFormat format);
@@ -80,6 +115,8 @@ namespace Falcor
     private:
         VideoEncoder(const std::filesystem::path& path);
         bool init(const Desc& desc);
+        void encodeFrame(const uint8_t* pData);
+        void runEncoder();
 
         AVFormatContext* mpOutputContext = nullptr;
         AVStream*        mpOutputStream  = nullptr;
@@ -90,6 +127,17 @@ namespace Falcor
         const std::filesystem::path mPath;
         ResourceFormat mFormat;
         uint32_t mRowPitch = 0;
-        uint8_t* mpFlippedImage = nullptr; // Used in case the image memory layout if bottom->top
+        uint32_t mHeight = 0;
+        bool mFlipY = false;                    ///< Flip the image when converting, used in case the image memory layout is bottom->top.
+        uint32_t mMaxQueuedFrames = 0;
+
+        std::thread mEncoderThread;                     ///< Thread converting and encoding queued frames.
+        std::mutex mMutex;                              ///< Mutex for synchronizing access to the frame queue.
+        std::condition_variable mCondition;             ///< Condition variable signaling changes of the frame queue.
+
+        // Internal state. Do not access outside of critical section.
+        std::deque<std::vector<uint8_t>> mFrameQueue;   ///< Frames waiting to be encoded.
+        std::vector<std::vector<uint8_t>> mFreeFrames;  ///< Frame buffers for reuse.
+        bool mTerminate = false;                        ///< Flag to terminate the encoder thread once the queue is empty.
     };
 }
@@ -40,6 +40,19 @@ namespace Falcor
         { (uint32_t)VideoEncoder::Codec::MPEG4, std::string("MPEG4") }
     };
 
+    static const Gui::DropdownList kPreset =
+    {
+        { (uint32_t)VideoEncoder::Preset::UltraFast, std::string("Ultra fast") },
+        { (uint32_t)VideoEncoder::Preset::SuperFast, std::string("Super fast") },
+        { (uint32_t)VideoEncoder::Preset::VeryFast, std::string("Very fast") },
+        { (uint32_t)VideoEncoder::Preset::Faster, std::string("Faster") },
+        { (uint32_t)VideoEncoder::Preset::Fast, std::string("Fast") },
+        { (uint32_t)VideoEncoder::Preset::Medium, std::string("Medium") },
+        { (uint32_t)VideoEncoder::Preset::Slow, std::string("Slow") },
+        { (uint32_t)VideoEncoder::Preset::Slower, std::string("Slower") },
+        { (uint32_t)VideoEncoder::Preset::VerySlow, std::string("Very slow") }
+    };
+
     VideoEncoderUI::UniquePtr VideoEncoderUI::create(CallbackStart startCaptureCB, CallbackEnd endCaptureCB)
     {
         return UniquePtr(new VideoEncoderUI(startCaptureCB, endCaptureCB));
@@ -69,6 +82,13 @@ namespace Falcor
             g.var("Video FPS", mFPS, 0u, 240u, 1);
             g.var("Bitrate (Mbps)", mBitrate, 0.f, FLT_MAX, 0.01f);
             g.var("GOP Size", mGopSize, 0u, 100000u, 1);
+            if (mCodec == VideoEncoder::Codec::H264 || mCodec == VideoEncoder::Codec::HEVC)
+            {
+                g.dropdown("Preset", kPreset, (uint32_t&)mPreset);
+                g.tooltip("Trades off encoding speed against compression efficiency");
+            }
+            g.var("Encoder threads", mThreadCount, 0u, 256u, 1);
+            g.tooltip("Number of codec threads. 0 lets the codec decide");
         }
 
         if (codecOnly) return;
@@ -57,11 +57,15 @@ namespace Falcor
         uint32_t getFPS() const { return mFPS; }
         float getBitrate() const { return mBitrate; }
         uint32_t getGopSize() const { return mGopSize; }
+        VideoEncoder::Preset getPreset() const { return mPreset; }
+        uint32_t getThreadCount() const { return mThreadCount; }
 
         VideoEncoderUI& setCodec(VideoEncoder::Codec c) { mCodec = c; return *this; }
         VideoEncoderUI& setFPS(uint32_t fps) { mFPS = fps; return *this; }
         VideoEncoderUI& setBitrate(float bitrate) { mBitrate = bitrate; return *this; }
         VideoEncoderUI& setGopSize(uint32_t gopSize) { mGopSize = gopSize; return *this; }
+        VideoEncoderUI& setPreset(VideoEncoder::Preset preset) { mPreset = preset; return *this; }
+        VideoEncoderUI& setThreadCount(uint32_t threadCount) { mThreadCount = threadCount; return *this; }
 
         bool useTimeRange() const { return mUseTimeRange; }
         bool captureUI() const { return mCaptureUI; }
@@ -93,5 +97,7 @@ namespace Falcor
         std::filesystem::path mPath;
         float mBitrate = 30.f;
         uint32_t mGopSize = 10;
+        VideoEncoder::Preset mPreset = VideoEncoder::Preset::Medium;
+        uint32_t mThreadCount = 0;
     };
 }
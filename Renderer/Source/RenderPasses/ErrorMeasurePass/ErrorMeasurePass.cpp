@@ -160,13 +160,17 @@ void ErrorMeasurePass::execute(RenderContext* pRenderContext, const RenderData&
         mpDifferenceTexture = Texture::create2D(width, height, ResourceFormat::RGBA32Float, 1, 1, nullptr,
                                                 Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
         FALCOR_ASSERT(mpDifferenceTexture);
-    }
 
-    mMeasurements.valid = false;
+        // Pending results were computed at the old resolution.
+        mpParallelReduction->discardAsyncResults();
+    }
 
     Texture::SharedPtr pReference = getReference(renderData);
     if (!pReference)
     {
+        mMeasurements.valid = false;
+        mpParallelReduction->discardAsyncResults();
+
         // We don't have a reference image, so just copy the source image to the output.
         pRenderContext->blit(pSourceImageTexture->getSRV(), pOutputImageTexture->getRTV());
         return;
@@ -218,8 +222,24 @@ void ErrorMeasurePass::runDifferencePass(RenderContext* pRenderContext, const Re
 void ErrorMeasurePass::runReductionPasses(RenderContext* pRenderContext, const RenderData& renderData)
 {
     float4 error;
-    mpParallelReduction->execute(pRenderContext, mpDifferenceTexture, ComputeParallelReduction::Type::Sum, &error);
 
+    if (mMeasurementsFile.is_open())
+    {
+        // Measurements are written to file for every frame, so read back the result synchronously.
+        mpParallelReduction->discardAsyncResults();
+        mpParallelReduction->execute(pRenderContext, mpDifferenceTexture, ComputeParallelReduction::Type::Sum, &error);
+        updateMeasurements(error);
+    }
+    else
+    {
+        // Read back asynchronously to avoid stalling the GPU. The measurements lag a few frames behind.
+        while (mpParallelReduction->getAsyncResult(&error)) updateMeasurements(error);
+        mpParallelReduction->executeAsync<float4>(pRenderContext, mpDifferenceTexture, ComputeParallelReduction::Type::Sum, 0);
+    }
+}
+
+void ErrorMeasurePass::updateMeasurements(const float4& error)
+{
     const float pixelCountf = static_cast<float>(mpDifferenceTexture->getWidth() * mpDifferenceTexture->getHeight());
     mMeasurements.error = error / pixelCountf;
     mMeasurements.avgError = (mMeasurements.error.x + mMeasurements.error.y + mMeasurements.error.z) / 3.f;
@@ -400,7 +420,7 @@ void ErrorMeasurePass::openMeasurementsFile()
 
 void ErrorMeasurePass::saveMeasurementsToFile()
 {
-    if (!mMeasurementsFile) return;
+    if (!mMeasurementsFile.is_open()) return;
 
     FALCOR_ASSERT(mMeasurements.valid);
     mMeasurementsFile << mMeasurements.avgError << ",";
@@ -66,6 +66,7 @@ private:
 
     void runDifferencePass(RenderContext* pRenderContext, const RenderData& renderData);
     void runReductionPasses(RenderContext* pRenderContext, const RenderData& renderData);
+    void updateMeasurements(const float4& error);
 
     ComputePass::SharedPtr mpErrorMeasurerPass;
     ComputeParallelReduction::SharedPtr mpParallelReduction;
@@ -90,6 +90,20 @@ NRDPass::SharedPtr NRDPass::create(RenderContext* pRenderContext, const Dictiona
 NRDPass::NRDPass(const Dictionary& dict)
     : RenderPass(kInfo)
 {
+    // Declare slots for all fields used by any of the denoising methods. Slots of unused fields resolve to nullptr.
+    mSlotInputNormalRoughnessMaterialID = declareSlot(kInputNormalRoughnessMaterialID);
+    mSlotInputViewZ = declareSlot(kInputViewZ);
+    mSlotInputDiffuseRadianceHitDist = declareSlot(kInputDiffuseRadianceHitDist);
+    mSlotInputSpecularRadianceHitDist = declareSlot(kInputSpecularRadianceHitDist);
+    mSlotInputSpecularHitDist = declareSlot(kInputSpecularHitDist);
+    mSlotInputMotionVectors = declareSlot(kInputMotionVectors);
+    mSlotInputDeltaPrimaryPosW = declareSlot(kInputDeltaPrimaryPosW);
+    mSlotInputDeltaSecondaryPosW = declareSlot(kInputDeltaSecondaryPosW);
+    mSlotOutputFilteredDiffuseRadianceHitDist = declareSlot(kOutputFilteredDiffuseRadianceHitDist);
+    mSlotOutputFilteredSpecularRadianceHitDist = declareSlot(kOutputFilteredSpecularRadianceHitDist);
+    mSlotOutputReflectionMotionVectors = declareSlot(kOutputReflectionMotionVectors);
+    mSlotOutputDeltaMotionVectors = declareSlot(kOutputDeltaMotionVectors);
+
 #if FALCOR_ENABLE_NRD
     Program::DefineList definesRelax;
     definesRelax.add("NRD_USE_OCT_NORMAL_ENCODING", "1");
@@ -362,33 +376,33 @@ void NRDPass::execute(RenderContext* pRenderContext, const RenderData& renderDat
     {
         if (mDenoisingMethod == DenoisingMethod::RelaxDiffuseSpecular || mDenoisingMethod == DenoisingMethod::ReblurDiffuseSpecular)
         {
-            pRenderContext->blit(renderData[kInputDiffuseRadianceHitDist]->asTexture()->getSRV(), renderData[kOutputFilteredDiffuseRadianceHitDist]->asTexture()->getRTV());
-            pRenderContext->blit(renderData[kInputSpecularRadianceHitDist]->asTexture()->getSRV(), renderData[kOutputFilteredSpecularRadianceHitDist]->asTexture()->getRTV());
+            pRenderContext->blit(renderData[mSlotInputDiffuseRadianceHitDist]->asTexture()->getSRV(), renderData[mSlotOutputFilteredDiffuseRadianceHitDist]->asTexture()->getRTV());
+            pRenderContext->blit(renderData[mSlotInputSpecularRadianceHitDist]->asTexture()->getSRV(), renderData[mSlotOutputFilteredSpecularRadianceHitDist]->asTexture()->getRTV());
         }
         else if (mDenoisingMethod == DenoisingMethod::RelaxDiffuse)
         {
-            pRenderContext->blit(renderData[kInputDiffuseRadianceHitDist]->asTexture()->getSRV(), renderData[kOutputFilteredDiffuseRadianceHitDist]->asTexture()->getRTV());
+            pRenderContext->blit(renderData[mSlotInputDiffuseRadianceHitDist]->asTexture()->getSRV(), renderData[mSlotOutputFilteredDiffuseRadianceHitDist]->asTexture()->getRTV());
         }
         else if (mDenoisingMethod == DenoisingMethod::SpecularReflectionMv)
         {
             if (mWorldSpaceMotion)
             {
-                pRenderContext->clearRtv(renderData[kOutputReflectionMotionVectors]->asTexture()->getRTV().get(), float4(0.f));
+                pRenderContext->clearRtv(renderData[mSlotOutputReflectionMotionVectors]->asTexture()->getRTV().get(), float4(0.f));
             }
             else
             {
-                pRenderContext->blit(renderData[kInputMotionVectors]->asTexture()->getSRV(), renderData[kOutputReflectionMotionVectors]->asTexture()->getRTV());
+                pRenderContext->blit(renderData[mSlotInputMotionVectors]->asTexture()->getSRV(), renderData[mSlotOutputReflectionMotionVectors]->asTexture()->getRTV());
             }
         }
         else if (mDenoisingMethod == DenoisingMethod::SpecularDeltaMv)
         {
             if (mWorldSpaceMotion)
             {
-                pRenderContext->clearRtv(renderData[kOutputDeltaMotionVectors]->asTexture()->getRTV().get(), float4(0.f));
+                pRenderContext->clearRtv(renderData[mSlotOutputDeltaMotionVectors]->asTexture()->getRTV().get(), float4(0.f));
             }
             else
             {
-                pRenderContext->blit(renderData[kInputMotionVectors]->asTexture()->getSRV(), renderData[kOutputDeltaMotionVectors]->asTexture()->getRTV());
+                pRenderContext->blit(renderData[mSlotInputMotionVectors]->asTexture()->getSRV(), renderData[mSlotOutputDeltaMotionVectors]->asTexture()->getRTV());
             }
         }
     }
@@ -720,6 +734,26 @@ void NRDPass::createPipelines()
         mpSamplersDescriptorSet->setSampler(0, j, mpSamplers[j].get());
     }
 
+    // Create the programs for all NRD passes up front and request their compilation.
+    // With a background compiler installed (see `Program::setAsyncCompiler()`) they compile in parallel.
+    std::vector<ComputePass::SharedPtr> pPasses;
+    for (uint32_t i = 0; i < denoiserDesc.pipelineNum; i++)
+    {
+        const nrd::PipelineDesc& nrdPipelineDesc = denoiserDesc.pipelines[i];
+        std::string shaderFileName = "nrd/Shaders/Source/" + std::string(nrdPipelineDesc.shaderFileName) + ".hlsl";
+
+        Program::Desc programDesc;
+        programDesc.addShaderLibrary(shaderFileName).csEntry(nrdPipelineDesc.shaderEntryPointName);
+        programDesc.setCompilerFlags(Shader::CompilerFlags::MatrixLayoutColumnMajor);
+        Program::DefineList defines;
+        defines.add("NRD_COMPILER_DXC");
+        defines.add("NRD_USE_OCT_NORMAL_ENCODING", "1");
+        defines.add("NRD_USE_MATERIAL_ID", "0");
+        ComputePass::SharedPtr pPass = ComputePass::create(programDesc, defines, false);
+        pPass->getProgram()->requestActiveVersion();
+        pPasses.push_back(pPass);
+    }
+
     // Go over NRD passes and creating descriptor sets, root signatures and PSOs for each.
     for (uint32_t i = 0; i < denoiserDesc.pipelineNum; i++)
     {
@@ -758,16 +792,8 @@ void NRDPass::createPipelines()
 
         // Create Compute PSO for the NRD pass.
         {
-            std::string shaderFileName = "nrd/Shaders/Source/" + std::string(nrdPipelineDesc.shaderFileName) + ".hlsl";
-
-            Program::Desc programDesc;
-            programDesc.addShaderLibrary(shaderFileName).csEntry(nrdPipelineDesc.shaderEntryPointName);
-            programDesc.setCompilerFlags(Shader::CompilerFlags::MatrixLayoutColumnMajor);
-            Program::DefineList defines;
-            defines.add("NRD_COMPILER_DXC");
-            defines.add("NRD_USE_OCT_NORMAL_ENCODING", "1");
-            defines.add("NRD_USE_MATERIAL_ID", "0");
-            ComputePass::SharedPtr pPass = ComputePass::create(programDesc, defines);
+            ComputePass::SharedPtr pPass = pPasses[i];
+            pPass->setVars(nullptr);
 
             ComputeProgram::SharedPtr pProgram = pPass->getProgram();
             ProgramKernels::SharedConstPtr pProgramKernels = pProgram->getActiveVersion()->getKernels(pPass->getVars().get());
@@ -869,8 +895,8 @@ void NRDPass::executeInternal(RenderContext* pRenderContext, const RenderData& r
             auto perImageCB = mpPackRadiancePassRelax["PerImageCB"];
 
             perImageCB["gMaxIntensity"] = mMaxIntensity;
-            perImageCB["gDiffuseRadianceHitDist"] = renderData[kInputDiffuseRadianceHitDist]->asTexture();
-            perImageCB["gSpecularRadianceHitDist"] = renderData[kInputSpecularRadianceHitDist]->asTexture();
+            perImageCB["gDiffuseRadianceHitDist"] = renderData[mSlotInputDiffuseRadianceHitDist]->asTexture();
+            perImageCB["gSpecularRadianceHitDist"] = renderData[mSlotInputSpecularRadianceHitDist]->asTexture();
             mpPackRadiancePassRelax->execute(pRenderContext, uint3(mScreenSize.x, mScreenSize.y, 1u));
         }
 
@@ -884,7 +910,7 @@ void NRDPass::executeInternal(RenderContext* pRenderContext, const RenderData& r
             auto perImageCB = mpPackRadiancePassRelax["PerImageCB"];
 
             perImageCB["gMaxIntensity"] = mMaxIntensity;
-            perImageCB["gDiffuseRadianceHitDist"] = renderData[kInputDiffuseRadianceHitDist]->asTexture();
+            perImageCB["gDiffuseRadianceHitDist"] = renderData[mSlotInputDiffuseRadianceHitDist]->asTexture();
             mpPackRadiancePassRelax->execute(pRenderContext, uint3(mScreenSize.x, mScreenSize.y, 1u));
         }
 
@@ -899,10 +925,10 @@ void NRDPass::executeInternal(RenderContext* pRenderContext, const RenderData& r
 
             perImageCB["gHitDistParams"].setBlob(mReblurSettings.hitDistanceParameters);
             perImageCB["gMaxIntensity"] = mMaxIntensity;
-            perImageCB["gDiffuseRadianceHitDist"] = renderData[kInputDiffuseRadianceHitDist]->asTexture();
-            perImageCB["gSpecularRadianceHitDist"] = renderData[kInputSpecularRadianceHitDist]->asTexture();
-            perImageCB["gNormalRoughness"] = renderData[kInputNormalRoughnessMaterialID]->asTexture();
-            perImageCB["gViewZ"] = renderData[kInputViewZ]->asTexture();
+            perImageCB["gDiffuseRadianceHitDist"] = renderData[mSlotInputDiffuseRadianceHitDist]->asTexture();
+            perImageCB["gSpecularRadianceHitDist"] = renderData[mSlotInputSpecularRadianceHitDist]->asTexture();
+            perImageCB["gNormalRoughness"] = renderData[mSlotInputNormalRoughnessMaterialID]->asTexture();
+            perImageCB["gViewZ"] = renderData[mSlotInputViewZ]->asTexture();
             mpPackRadiancePassReblur->execute(pRenderContext, uint3(mScreenSize.x, mScreenSize.y, 1u));
         }
 
@@ -1000,40 +1026,40 @@ void NRDPass::dispatch(RenderContext* pRenderContext, const RenderData& renderDa
             switch (resource.type)
             {
             case nrd::ResourceType::IN_MV:
-                texture = renderData[kInputMotionVectors]->asTexture();
+                texture = renderData[mSlotInputMotionVectors]->asTexture();
                 break;
             case nrd::ResourceType::IN_NORMAL_ROUGHNESS:
-                texture = renderData[kInputNormalRoughnessMaterialID]->asTexture();
+                texture = renderData[mSlotInputNormalRoughnessMaterialID]->asTexture();
                 break;
             case nrd::ResourceType::IN_VIEWZ:
-                texture = renderData[kInputViewZ]->asTexture();
+                texture = renderData[mSlotInputViewZ]->asTexture();
                 break;
             case nrd::ResourceType::IN_DIFF_RADIANCE_HITDIST:
-                texture = renderData[kInputDiffuseRadianceHitDist]->asTexture();
+                texture = renderData[mSlotInputDiffuseRadianceHitDist]->asTexture();
                 break;
             case nrd::ResourceType::IN_SPEC_RADIANCE_HITDIST:
-                texture = renderData[kInputSpecularRadianceHitDist]->asTexture();
+                texture = renderData[mSlotInputSpecularRadianceHitDist]->asTexture();
                 break;
             case nrd::ResourceType::IN_SPEC_HITDIST:
-                texture = renderData[kInputSpecularHitDist]->asTexture();
+                texture = renderData[mSlotInputSpecularHitDist]->asTexture();
                 break;
             case nrd::ResourceType::IN_DELTA_PRIMARY_POS:
-                texture = renderData[kInputDeltaPrimaryPosW]->asTexture();
+                texture = renderData[mSlotInputDeltaPrimaryPosW]->asTexture();
                 break;
             case nrd::ResourceType::IN_DELTA_SECONDARY_POS:
-                texture = renderData[kInputDeltaSecondaryPosW]->asTexture();
+                texture = renderData[mSlotInputDeltaSecondaryPosW]->asTexture();
                 break;
             case nrd::ResourceType::OUT_DIFF_RADIANCE_HITDIST:
-                texture = renderData[kOutputFilteredDiffuseRadianceHitDist]->asTexture();
+                texture = renderData[mSlotOutputFilteredDiffuseRadianceHitDist]->asTexture();
                 break;
             case nrd::ResourceType::OUT_SPEC_RADIANCE_HITDIST:
-                texture = renderData[kOutputFilteredSpecularRadianceHitDist]->asTexture();
+                texture = renderData[mSlotOutputFilteredSpecularRadianceHitDist]->asTexture();
                 break;
             case nrd::ResourceType::OUT_REFLECTION_MV:
-                texture = renderData[kOutputReflectionMotionVectors]->asTexture();
+                texture = renderData[mSlotOutputReflectionMotionVectors]->asTexture();
                 break;
             case nrd::ResourceType::OUT_DELTA_MV:
-                texture = renderData[kOutputDeltaMotionVectors]->asTexture();
+                texture = renderData[mSlotOutputDeltaMotionVectors]->asTexture();
                 break;
             case nrd::ResourceType::TRANSIENT_POOL:
                 texture = mpTransientTextures[resource.indexInPool];
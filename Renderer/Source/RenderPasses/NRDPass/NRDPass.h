@@ -58,6 +58,19 @@
         uint2 mScreenSize;
         uint32_t mFrameIndex = 0;
         Scene::SharedPtr mpScene;
+        // Resource slots
+        RenderData::Slot mSlotInputNormalRoughnessMaterialID;
+        RenderData::Slot mSlotInputViewZ;
+        RenderData::Slot mSlotInputDiffuseRadianceHitDist;
+        RenderData::Slot mSlotInputSpecularRadianceHitDist;
+        RenderData::Slot mSlotInputSpecularHitDist;
+        RenderData::Slot mSlotInputMotionVectors;
+        RenderData::Slot mSlotInputDeltaPrimaryPosW;
+        RenderData::Slot mSlotInputDeltaSecondaryPosW;
+        RenderData::Slot mSlotOutputFilteredDiffuseRadianceHitDist;
+        RenderData::Slot mSlotOutputFilteredSpecularRadianceHitDist;
+        RenderData::Slot mSlotOutputReflectionMotionVectors;
+        RenderData::Slot mSlotOutputDeltaMotionVectors;
         // Falcor Settings
         Falcor::Buffer::SharedPtr mpConstantBuffer;
         Falcor::D3D12DescriptorSet::SharedPtr mpSamplersDescriptorSet;
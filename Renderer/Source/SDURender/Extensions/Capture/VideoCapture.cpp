@@ -38,11 +38,17 @@ namespace SDURender
         const std::string kFps = "fps";
         const std::string kBitrate = "bitrate";
         const std::string kGopSize = "gopSize";
+        const std::string kPreset = "preset";
+        const std::string kThreadCount = "threadCount";
         const std::string kRanges = "ranges";
         const std::string kAddRanges = "addRanges";
         const std::string kPrint = "print";
         const std::string kOutputs = "outputs";
 
+        // Number of frames read back asynchronously before waiting for the oldest one.
+        // This avoids stalling the render thread on the GPU for every captured frame.
+        const size_t kMaxPendingReads = 2;
+
         Texture::SharedPtr createTextureForBlit(const Texture* pSource)
         {
             FALCOR_ASSERT(pSource->getType() == Texture::Type::Texture2D);
@@ -80,6 +86,8 @@ namespace SDURender
         d.codec = mpEncoderUI->getCodec();
         d.fps = mpEncoderUI->getFPS();
         d.gopSize = mpEncoderUI->getGopSize();
+        d.preset = mpEncoderUI->getPreset();
+        d.threadCount = mpEncoderUI->getThreadCount();
 
         for (uint32_t i = 0 ; i < pGraph->getOutputCount() ; i++)
         {
@@ -113,13 +121,25 @@ namespace SDURender
 
     void VideoCapture::endRange(RenderGraph* pGraph, const Range& r)
     {
-        for (const auto& e : mEncoders) e.pEncoder->endCapture();
+        for (auto& e : mEncoders)
+        {
+            if (!e.pEncoder) continue;
+            while (!e.pendingReads.empty())
+            {
+                e.pEncoder->appendFrame(e.pendingReads.front()->getData());
+                e.pendingReads.pop_front();
+            }
+            e.pEncoder->endCapture();
+        }
+        mEncoders.clear();
     }
 
     void VideoCapture::triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID)
     {
-        for (const auto& e : mEncoders)
+        for (auto& e : mEncoders)
         {
+            if (!e.pEncoder) continue;
+
             Texture::SharedPtr pTex = std::dynamic_pointer_cast<Texture>(pGraph->getOutput(e.output));
             if (e.pBlitTex)
             {
@@ -127,7 +147,13 @@ namespace SDURender
                 pTex = e.pBlitTex;
             }
 
-            e.pEncoder->appendFrame(pCtx->readTextureSubresource(pTex.get(), 0).data());
+            // Read the frame back asynchronously, and pass the oldest frame to the encoder once enough frames are in flight.
+            e.pendingReads.push_back(pCtx->asyncReadTextureSubresource(pTex.get(), 0));
+            if (e.pendingReads.size() > kMaxPendingReads)
+            {
+                e.pEncoder->appendFrame(e.pendingReads.front()->getData());
+                e.pendingReads.pop_front();
+            }
         }
     }
 
@@ -159,6 +185,14 @@ namespace SDURender
         auto setGopSize = [](VideoCapture* pVC, uint32_t gop) {pVC->mpEncoderUI->setGopSize(gop); return pVC; };
         videoCapture.def_property(kGopSize.c_str(), getGopSize, setGopSize);
 
+        auto getPreset = [](VideoCapture* pVC) {return pVC->mpEncoderUI->getPreset(); };
+        auto setPreset = [](VideoCapture* pVC, VideoEncoder::Preset preset) {pVC->mpEncoderUI->setPreset(preset); return pVC; };
+        videoCapture.def_property(kPreset.c_str(), getPreset, setPreset);
+
+        auto getThreadCount = [](VideoCapture* pVC) {return pVC->mpEncoderUI->getThreadCount(); };
+        auto setThreadCount = [](VideoCapture* pVC, uint32_t threadCount) {pVC->mpEncoderUI->setThreadCount(threadCount); return pVC; };
+        videoCapture.def_property(kThreadCount.c_str(), getThreadCount, setThreadCount);
+
         // Ranges
         videoCapture.def(kAddRanges.c_str(), pybind11::overload_cast<const RenderGraph*, const range_vec&>(&VideoCapture::addRanges), "graph"_a, "ranges"_a);
         videoCapture.def(kAddRanges.c_str(), pybind11::overload_cast<const std::string&, const range_vec&>(&VideoCapture::addRanges), "name"_a, "ranges"_a);
@@ -190,6 +224,8 @@ namespace SDURender
         s += ScriptWriter::makeSetProperty(var, kFps, mpEncoderUI->getFPS());
         s += ScriptWriter::makeSetProperty(var, kBitrate, mpEncoderUI->getBitrate());
         s += ScriptWriter::makeSetProperty(var, kGopSize, mpEncoderUI->getGopSize());
+        s += ScriptWriter::makeSetProperty(var, kPreset, mpEncoderUI->getPreset());
+        s += ScriptWriter::makeSetProperty(var, kThreadCount, mpEncoderUI->getThreadCount());
 
         for (const auto& g : mGraphRanges)
         {
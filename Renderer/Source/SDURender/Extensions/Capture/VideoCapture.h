@@ -59,6 +59,7 @@ namespace SDURender
             std::string output;
             VideoEncoder::UniquePtr pEncoder;
             Texture::SharedPtr pBlitTex;
+            std::deque<CopyContext::ReadTextureTask::SharedPtr> pendingReads; ///< Readbacks of frames not yet passed to the encoder.
         };
         std::vector<EncodeData> mEncoders;
     };
@@ -71,6 +71,13 @@ namespace SDURender
 
     void Renderer::onShutdown()
     {
+        // Finish background compilation and update the prewarm list.
+        if (auto pCompiler = Program::getAsyncCompiler())
+        {
+            Program::setAsyncCompiler(nullptr);
+            if (!mOptions.shaderPrewarmList.empty()) pCompiler->savePrewarmList(mOptions.shaderPrewarmList);
+        }
+
         resetEditor();
         gpDevice->flushAndSync(); // Need to do that because clearing the graphs will try to release some state objects which might be in use
         mGraphs.clear();
@@ -78,6 +85,15 @@ namespace SDURender
 
     void Renderer::onLoad(RenderContext* pRenderContext)
     {
+        // Compile programs in the background. Versions recorded in the prewarm list are compiled as soon as their programs are created.
+        auto pCompiler = AsyncProgramCompiler::create();
+        if (!mOptions.shaderPrewarmList.empty())
+        {
+            if (std::filesystem::exists(mOptions.shaderPrewarmList)) pCompiler->loadPrewarmList(mOptions.shaderPrewarmList);
+            pCompiler->setRecordingEnabled(true);
+        }
+        Program::setAsyncCompiler(pCompiler);
+
         mpExtensions.push_back(SDURenderSettings::create(this));
         if (gExtensions)
         {
@@ -713,6 +729,7 @@ int main(int argc, char** argv)
     args::Flag useSceneCacheFlag(parser, "", "Use scene cache to improve scene load times.", {'c', "use-cache"});
     args::Flag rebuildSceneCacheFlag(parser, "", "Rebuild the scene cache.", {"rebuild-cache"});
     args::Flag generateShaderDebugInfo(parser, "", "Generate shader debug info.", {'d', "debug-shaders"});
+    args::ValueFlag<std::string> shaderPrewarmFlag(parser, "path", "Shader prewarm list. Recorded program versions are compiled in the background at startup and the list is updated on exit.", {"shader-prewarm"});
     args::Flag enableDebugLayer(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
 
     args::CompletionFlag completionFlag(parser, {"complete"});
@@ -768,6 +785,7 @@ int main(int argc, char** argv)
     if (useSceneCacheFlag) options.useSceneCache = true;
     if (rebuildSceneCacheFlag) options.rebuildSceneCache = true;
     if (generateShaderDebugInfo) options.generateShaderDebugInfo = true;
+    if (shaderPrewarmFlag) options.shaderPrewarmList = args::get(shaderPrewarmFlag);
 
     try
     {
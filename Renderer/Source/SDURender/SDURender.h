@@ -76,6 +76,7 @@ namespace SDURender
             bool useSceneCache = false;
             bool rebuildSceneCache = false;
             bool generateShaderDebugInfo = false;
+            std::string shaderPrewarmList;
         };
 
         Renderer(const Options& options);
@@ -214,9 +214,30 @@ namespace SDURender
                 << "Program kernels time (total): " << s.programKernelsTotalTime << " s" << std::endl
                 << "Program version time (max): " << s.programVersionMaxTime << " s" << std::endl
                 << "Program kernels time (max): " << s.programKernelsMaxTime << " s" << std::endl;
+            if (auto pCompiler = Program::getAsyncCompiler())
+            {
+                oss << "Background compile jobs: " << pCompiler->getPendingCount() << " (" << pCompiler->getThreadCount() << " threads)" << std::endl
+                    << "Prewarm list entries: " << pCompiler->getPrewarmEntryCount() << std::endl;
+            }
             g.text(oss.str());
 
             if (g.button("Reset")) Program::resetGlobalCompilationStats();
+
+            bool shaderCacheEnabled = ShaderCache::isEnabled();
+            if (g.checkbox("Shader cache", shaderCacheEnabled)) ShaderCache::setEnabled(shaderCacheEnabled);
+            g.tooltip("Persistent on-disk cache for compiled shader kernels.\nLocation: " + ShaderCache::getDirectory().string());
+
+            const auto cs = ShaderCache::getStats();
+            std::ostringstream css;
+            css << "Shader cache hits: " << cs.hitCount << std::endl
+                << "Shader cache misses: " << cs.missCount << std::endl
+                << "Shader cache writes: " << cs.writeCount << std::endl
+                << "Shader cache evictions: " << cs.evictionCount << std::endl
+                << "Shader cache invalid entries: " << cs.invalidCount << std::endl;
+            g.text(css.str());
+
+            if (g.button("Reset stats##ShaderCache")) ShaderCache::resetStats();
+            if (g.button("Clear cache", true)) ShaderCache::clear();
         }
 
         // Scene UI
@@ -0,0 +1,116 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/AsyncProgramCompiler.h"
+#include <atomic>
+#include <fstream>
+
+namespace Falcor
+{
+    CPU_TEST(AsyncProgramCompiler_Jobs)
+    {
+        auto pCompiler = AsyncProgramCompiler::create(4);
+        EXPECT_EQ(pCompiler->getThreadCount(), 4ull);
+
+        std::atomic<uint32_t> counter = 0;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            pCompiler->enqueue([&counter]() { counter++; });
+        }
+        pCompiler->waitIdle();
+
+        EXPECT_EQ(counter.load(), 256u);
+        EXPECT_EQ(pCompiler->getPendingCount(), 0ull);
+    }
+
+    CPU_TEST(AsyncProgramCompiler_PrewarmList)
+    {
+        auto pCompiler = AsyncProgramCompiler::create(1);
+
+        AsyncProgramCompiler::PrewarmEntry a;
+        a.program = "RenderPasses/Foo.cs.slang";
+        a.defines = { { "USE_FOO", "1" }, { "FOO_COUNT", "16" } };
+
+        AsyncProgramCompiler::PrewarmEntry b;
+        b.program = "RenderPasses/Foo.cs.slang";
+        b.defines = { { "USE_FOO", "0" } };
+        b.typeConformances.add("FooImpl", "IFoo", 3);
+
+        AsyncProgramCompiler::PrewarmEntry c;
+        c.program = "RenderPasses/Bar.rt.slang";
+
+        // Entries are ignored until recording is enabled.
+        pCompiler->record(a);
+        EXPECT_EQ(pCompiler->getPrewarmEntryCount(), 0ull);
+
+        pCompiler->setRecordingEnabled(true);
+        pCompiler->record(a);
+        pCompiler->record(b);
+        pCompiler->record(c);
+        pCompiler->record(a);
+        EXPECT_EQ(pCompiler->getPrewarmEntryCount(), 3ull);
+        EXPECT_EQ(pCompiler->getPrewarmEntries("RenderPasses/Foo.cs.slang").size(), 2ull);
+        EXPECT_EQ(pCompiler->getPrewarmEntries("RenderPasses/Bar.rt.slang").size(), 1ull);
+        EXPECT_EQ(pCompiler->getPrewarmEntries("RenderPasses/Baz.cs.slang").size(), 0ull);
+
+        // Roundtrip through a file.
+        std::filesystem::path path = std::filesystem::temp_directory_path() / "FalcorPrewarmListTest.txt";
+        EXPECT(pCompiler->savePrewarmList(path));
+
+        auto pLoaded = AsyncProgramCompiler::create(1);
+        EXPECT(pLoaded->loadPrewarmList(path));
+        std::filesystem::remove(path);
+
+        EXPECT_EQ(pLoaded->getPrewarmEntryCount(), 3ull);
+        auto entries = pLoaded->getPrewarmEntries("RenderPasses/Foo.cs.slang");
+        auto expected = pCompiler->getPrewarmEntries("RenderPasses/Foo.cs.slang");
+        EXPECT_EQ(entries.size(), expected.size());
+        for (size_t i = 0; i < std::min(entries.size(), expected.size()); i++)
+        {
+            EXPECT(!(entries[i] < expected[i]) && !(expected[i] < entries[i]));
+        }
+
+        EXPECT(!pLoaded->loadPrewarmList(path));
+
+        // A bad type conformance ID skips the line instead of failing the load.
+        {
+            std::ofstream fs(path);
+            fs << "# Falcor shader prewarm list v1\n";
+            fs << "program\tRenderPasses/Baz.cs.slang\n";
+            fs << "conformance\tFooImpl\tIFoo\tnot_a_number\n";
+            fs << "end\n";
+        }
+        auto pCorrupt = AsyncProgramCompiler::create(1);
+        EXPECT(pCorrupt->loadPrewarmList(path));
+        std::filesystem::remove(path);
+
+        entries = pCorrupt->getPrewarmEntries("RenderPasses/Baz.cs.slang");
+        EXPECT_EQ(entries.size(), 1ull);
+        if (!entries.empty()) EXPECT(entries[0].typeConformances.empty());
+    }
+}
@@ -0,0 +1,187 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ShaderCache.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Redirects the shader cache to an empty temporary directory for the duration of a test.
+        */
+        struct ScopedShaderCache
+        {
+            ScopedShaderCache()
+                : prevDirectory(ShaderCache::getDirectory())
+                , prevMaxSize(ShaderCache::getMaxSize())
+                , prevEnabled(ShaderCache::isEnabled())
+            {
+                directory = std::filesystem::temp_directory_path() / "FalcorShaderCacheTest";
+                std::filesystem::remove_all(directory);
+                ShaderCache::setDirectory(directory);
+                ShaderCache::setEnabled(true);
+                ShaderCache::resetStats();
+            }
+
+            ~ScopedShaderCache()
+            {
+                std::filesystem::remove_all(directory);
+                ShaderCache::setDirectory(prevDirectory);
+                ShaderCache::setMaxSize(prevMaxSize);
+                ShaderCache::setEnabled(prevEnabled);
+                ShaderCache::resetStats();
+            }
+
+            std::filesystem::path directory;
+            std::filesystem::path prevDirectory;
+            uint64_t prevMaxSize;
+            bool prevEnabled;
+        };
+
+        ShaderCache::Key makeKey(uint32_t i)
+        {
+            return SHA1::compute(&i, sizeof(i));
+        }
+
+        std::vector<uint8_t> makeData(uint32_t i, size_t size)
+        {
+            std::vector<uint8_t> data(size);
+            for (size_t j = 0; j < size; j++) data[j] = (uint8_t)(i * 31 + j);
+            return data;
+        }
+    }
+
+    CPU_TEST(ShaderCache_ReadWrite)
+    {
+        ScopedShaderCache scope;
+
+        std::vector<uint8_t> result;
+        EXPECT(!ShaderCache::read(makeKey(0), result));
+
+        auto data = makeData(0, 1000);
+        ShaderCache::write(makeKey(0), data.data(), data.size());
+        EXPECT(ShaderCache::read(makeKey(0), result));
+        EXPECT(result == data);
+        EXPECT(!ShaderCache::read(makeKey(1), result));
+
+        // Overwrite an existing entry.
+        data = makeData(1, 500);
+        ShaderCache::write(makeKey(0), data.data(), data.size());
+        EXPECT(ShaderCache::read(makeKey(0), result));
+        EXPECT(result == data);
+
+        // Disabled cache never hits.
+        ShaderCache::setEnabled(false);
+        EXPECT(!ShaderCache::read(makeKey(0), result));
+        ShaderCache::setEnabled(true);
+
+        auto stats = ShaderCache::getStats();
+        EXPECT_EQ(stats.hitCount, 2ull);
+        EXPECT_EQ(stats.missCount, 2ull);
+        EXPECT_EQ(stats.writeCount, 2ull);
+        EXPECT_EQ(stats.invalidCount, 0ull);
+
+        ShaderCache::clear();
+        EXPECT(!ShaderCache::read(makeKey(0), result));
+    }
+
+    CPU_TEST(ShaderCache_Invalidation)
+    {
+        ScopedShaderCache scope;
+
+        auto data = makeData(0, 1000);
+        ShaderCache::write(makeKey(0), data.data(), data.size());
+
+        // Corrupt a byte in the payload of the only entry.
+        std::filesystem::path entryPath;
+        for (const auto& entry : std::filesystem::directory_iterator(scope.directory)) entryPath = entry.path();
+        EXPECT(!entryPath.empty());
+        {
+            std::fstream fs(entryPath, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+            fs.seekp(-10, std::ios_base::end);
+            fs.put(0x55);
+        }
+
+        // The corrupted entry is detected and deleted.
+        std::vector<uint8_t> result;
+        EXPECT(!ShaderCache::read(makeKey(0), result));
+        EXPECT(!std::filesystem::exists(entryPath));
+        EXPECT_EQ(ShaderCache::getStats().invalidCount, 1ull);
+
+        // Truncated entries are detected as well.
+        ShaderCache::write(makeKey(0), data.data(), data.size());
+        std::filesystem::resize_file(entryPath, std::filesystem::file_size(entryPath) - 1);
+        EXPECT(!ShaderCache::read(makeKey(0), result));
+        EXPECT_EQ(ShaderCache::getStats().invalidCount, 2ull);
+    }
+
+    CPU_TEST(ShaderCache_Eviction)
+    {
+        ScopedShaderCache scope;
+
+        const uint64_t maxSize = 16 * 1024;
+        const size_t entrySize = 1000;
+        const uint32_t entryCount = 64;
+        ShaderCache::setMaxSize(maxSize);
+
+        std::vector<uint8_t> result;
+        for (uint32_t i = 0; i < entryCount; i++)
+        {
+            auto data = makeData(i, entrySize);
+            ShaderCache::write(makeKey(i), data.data(), data.size());
+            // Keep the first entry in use, it should never be evicted.
+            EXPECT(ShaderCache::read(makeKey(0), result)) << "i = " << i;
+        }
+
+        uint64_t totalSize = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(scope.directory)) totalSize += entry.file_size();
+        EXPECT_LE(totalSize, maxSize);
+        EXPECT_GT(ShaderCache::getStats().evictionCount, 0ull);
+
+        // The most recently written entry is still present.
+        EXPECT(ShaderCache::read(makeKey(entryCount - 1), result));
+        EXPECT(result == makeData(entryCount - 1, entrySize));
+    }
+
+    CPU_TEST(ShaderCache_HashFile)
+    {
+        ScopedShaderCache scope;
+
+        std::filesystem::create_directories(scope.directory);
+        auto path = scope.directory / "file.slang";
+        std::ofstream(path) << "float4 main() : SV_Target { return 0; }";
+        auto hash0 = ShaderCache::hashFile(path);
+        EXPECT(hash0 == ShaderCache::hashFile(path));
+
+        std::ofstream(path) << "float4 main() : SV_Target { return 1.0; }";
+        EXPECT(hash0 != ShaderCache::hashFile(path));
+
+        EXPECT(ShaderCache::hashFile(scope.directory / "missing.slang") == ShaderCache::Key{});
+    }
+}
@@ -0,0 +1,178 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ShaderVarHandle.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kResultCount = 6;
+
+        void setupProgram(GPUUnitTestContext& ctx)
+        {
+            ctx.createProgram("Tests/Core/ShaderVarHandleTests.cs.slang", "main");
+            ctx.allocateStructuredBuffer("result", kResultCount);
+
+            auto pBlockReflection = ctx.getProgram()->getReflector()->getParameterBlock("gBlock");
+            ctx["gBlock"] = ParameterBlock::create(pBlockReflection);
+        }
+
+        void checkResult(GPUUnitTestContext& ctx, const std::vector<float>& expected)
+        {
+            ctx.runProgram(1, 1, 1);
+
+            const float* result = ctx.mapBuffer<const float>("result");
+            for (uint32_t i = 0; i < kResultCount; i++) EXPECT_EQ(result[i], expected[i]) << "i = " << i;
+            ctx.unmapBuffer("result");
+        }
+
+        struct Handles
+        {
+            ShaderVarHandle dim;
+            ShaderVarHandle scale;
+            ShaderVarHandle c;
+            ShaderVarHandle innerA;
+            ShaderVarHandle innerB;
+
+            Handles(const ShaderVar& var)
+                : dim(var, "CB.dim")
+                , scale(var, "CB.scale")
+                , c(var, "gBlock.c")
+                , innerA(var, "gBlock.inner[1].a")
+                , innerB(var, "gBlock.inner[1].b")
+            {}
+        };
+    }
+
+    GPU_TEST(ShaderVarHandle_Resolve)
+    {
+        setupProgram(ctx);
+        auto var = ctx.vars().getRootVar();
+
+        Handles handles(var);
+        EXPECT(handles.dim.isValidFor(var));
+        EXPECT(handles.innerB.isValidFor(var));
+        EXPECT(!handles.innerB.isValidFor(var["gBlock"]));
+        EXPECT_EQ(handles.c.getSegments().size(), 2ull);
+
+        // Handles point to the same variables as the name lookup.
+        EXPECT_EQ(var[handles.dim].getRawData(), var["CB"]["dim"].getRawData());
+        EXPECT_EQ(var[handles.innerA].getRawData(), var["gBlock"]["inner"][1]["a"].getRawData());
+        EXPECT_EQ(var[handles.innerB].getRawData(), var["gBlock"]["inner"][1]["b"].getRawData());
+
+        // Handles can be resolved relative to a constant buffer variable.
+        auto blockVar = var["gBlock"];
+        ShaderVarHandle innerA(blockVar, "inner[1].a");
+        EXPECT(innerA.isValidFor(blockVar));
+        EXPECT_EQ(blockVar[innerA].getRawData(), var[handles.innerA].getRawData());
+
+        // Invalid paths result in invalid handles.
+        EXPECT(!ShaderVarHandle(var, "gBlock.d").isValid());
+        EXPECT(!ShaderVarHandle(var, "gBlock.inner[2].a").isValid());
+        EXPECT(!ShaderVarHandle(var, "gBlock.c[0]").isValid());
+        EXPECT(!ShaderVarHandle(var, "gBlock.").isValid());
+        EXPECT(!ShaderVarHandle().isValid());
+    }
+
+    GPU_TEST(ShaderVarHandle_Set)
+    {
+        setupProgram(ctx);
+        auto var = ctx.vars().getRootVar();
+        Handles handles(var);
+
+        var[handles.dim] = uint2(3, 5);
+        var[handles.scale] = 0.5f;
+        var[handles.c] = 7.f;
+        var[handles.innerA] = 11.f;
+        var[handles.innerB] = uint2(13, 17);
+        checkResult(ctx, { 3.f, 5.f, 0.5f, 7.f, 11.f, 17.f });
+
+        // Update the values with the batched writer.
+        {
+            ShaderConstantWriter writer(var);
+            writer.set(handles.dim, uint2(19, 23));
+            writer.set(handles.scale, 0.25f);
+            writer.set(handles.c, 29.f);
+            writer.set(handles.innerA, 31.f);
+            writer.set(handles.innerB, uint2(37, 41));
+        }
+        checkResult(ctx, { 19.f, 23.f, 0.25f, 29.f, 31.f, 41.f });
+    }
+
+    GPU_TEST(ShaderVarHandle_Benchmark, "Disabled for performance reasons")
+    {
+        // Mimic per-frame constant updates of a pass.
+        const uint32_t kIterations = 100000;
+
+        setupProgram(ctx);
+        auto var = ctx.vars().getRootVar();
+        Handles handles(var);
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            var["CB"]["dim"] = uint2(i);
+            var["CB"]["scale"] = float(i);
+            var["gBlock"]["c"] = float(i);
+            var["gBlock"]["inner"][1]["a"] = float(i);
+            var["gBlock"]["inner"][1]["b"] = uint2(i);
+        }
+        double stringTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            var[handles.dim] = uint2(i);
+            var[handles.scale] = float(i);
+            var[handles.c] = float(i);
+            var[handles.innerA] = float(i);
+            var[handles.innerB] = uint2(i);
+        }
+        double handleTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            ShaderConstantWriter writer(var);
+            writer.set(handles.dim, uint2(i));
+            writer.set(handles.scale, float(i));
+            writer.set(handles.c, float(i));
+            writer.set(handles.innerA, float(i));
+            writer.set(handles.innerB, uint2(i));
+        }
+        double writerTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        float last = float(kIterations - 1);
+        checkResult(ctx, { last, last, last, last, last, last });
+
+        logInfo("Per-frame binding of 5 constants: string {:.1f} ns, handle {:.1f} ns ({:.1f}x), writer {:.1f} ns ({:.1f}x)",
+            stringTime * 1e6 / kIterations, handleTime * 1e6 / kIterations, stringTime / handleTime, writerTime * 1e6 / kIterations, stringTime / writerTime);
+    }
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBufferSize = 16;
+        const ResourceBindFlags kBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
+
+        /** Pass with an optional 'src' input and a 'dst' output, both raw buffers of the same size.
+            If a clear value is set, 'dst' is cleared to it (only in the first execution if 'clearOnce' is set), otherwise 'src' is copied to 'dst'.
+        */
+        class TestPass : public RenderPass
+        {
+        public:
+            using SharedPtr = std::shared_ptr<TestPass>;
+
+            struct Desc
+            {
+                bool hasInput = false;
+                std::optional<uint32_t> clearValue;
+                bool clearOnce = false;
+                RenderPassReflection::Field::Flags outputFlags = RenderPassReflection::Field::Flags::None;
+            };
+
+            static SharedPtr create(const Desc& desc) { return SharedPtr(new TestPass(desc)); }
+
+            RenderPassReflection reflect(const CompileData& compileData) override
+            {
+                RenderPassReflection reflector;
+                if (mDesc.hasInput) reflector.addInput("src", "").rawBuffer(kBufferSize).bindFlags(kBindFlags);
+                reflector.addOutput("dst", "").rawBuffer(kBufferSize).bindFlags(kBindFlags).flags(mDesc.outputFlags);
+                return reflector;
+            }
+
+            void execute(RenderContext* pRenderContext, const RenderData& renderData) override
+            {
+                const auto& pDst = renderData["dst"]->asBuffer();
+                if (mDesc.clearValue)
+                {
+                    if (!mDesc.clearOnce || mExecutionCount == 0) pRenderContext->clearUAV(pDst->getUAV().get(), uint4(*mDesc.clearValue));
+                }
+                else
+                {
+                    pRenderContext->copyResource(pDst.get(), renderData["src"].get());
+                }
+                mExecutionCount++;
+            }
+
+        private:
+            TestPass(const Desc& desc) : RenderPass({ "TestPass", "" }), mDesc(desc) {}
+
+            Desc mDesc;
+            uint32_t mExecutionCount = 0;
+        };
+
+        /** Builds the chain A -> B -> C -> D and executes it twice.
+            A clears its output to 1 in the first execution only, so B copies the contents A left from the previous execution the second time.
+            C clears its output to 2 every execution. Its lifetime starts after the one of A's output, so they can share a resource if aliasing is enabled.
+            Returns the first value of B's output after the second execution.
+        */
+        uint32_t executeHistoryGraph(RenderContext* pRenderContext, bool enableAliasing, RenderPassReflection::Field::Flags historyFlags)
+        {
+            auto pGraph = RenderGraph::create("History");
+            pGraph->setResourceAliasingEnabled(enableAliasing);
+            pGraph->addPass(TestPass::create({ false, 1, true, historyFlags }), "A");
+            pGraph->addPass(TestPass::create({ true }), "B");
+            pGraph->addPass(TestPass::create({ true, 2 }), "C");
+            pGraph->addPass(TestPass::create({ true }), "D");
+            pGraph->addEdge("A.dst", "B.src");
+            pGraph->addEdge("B.dst", "C.src");
+            pGraph->addEdge("C.dst", "D.src");
+            pGraph->markOutput("B.dst");
+            pGraph->markOutput("D.dst");
+
+            pGraph->execute(pRenderContext);
+            pGraph->execute(pRenderContext);
+
+            auto pHistory = pGraph->getOutput("B.dst")->asBuffer();
+            uint32_t value = *(const uint32_t*)pHistory->map(Buffer::MapType::Read);
+            pHistory->unmap();
+            return value;
+        }
+    }
+
+    GPU_TEST(RenderGraph_OutputContentsKeptAcrossExecutions)
+    {
+        RenderContext* pRenderContext = ctx.getRenderContext();
+
+        // Aliasing is off by default, so a pass can read what it wrote in the previous execution even if the field isn't persistent.
+        EXPECT(!RenderGraph::create("Default")->isResourceAliasingEnabled());
+        EXPECT_EQ(executeHistoryGraph(pRenderContext, false, RenderPassReflection::Field::Flags::None), 1u);
+
+        // With aliasing enabled, C overwrites A's output unless A marks it as persistent.
+        EXPECT_EQ(executeHistoryGraph(pRenderContext, true, RenderPassReflection::Field::Flags::None), 2u);
+        EXPECT_EQ(executeHistoryGraph(pRenderContext, true, RenderPassReflection::Field::Flags::Persistent), 1u);
+    }
+}
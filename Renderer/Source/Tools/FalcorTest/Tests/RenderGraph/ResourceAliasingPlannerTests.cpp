@@ -0,0 +1,179 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/ResourceAliasingPlanner.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using Request = ResourceAliasingPlanner::Request;
+
+        Request createRequest(uint32_t compatibilityClass, uint64_t size, uint32_t firstUse, uint32_t lastUse, bool allowAliasing = true)
+        {
+            Request request;
+            request.compatibilityClass = compatibilityClass;
+            request.size = size;
+            request.firstUse = firstUse;
+            request.lastUse = lastUse;
+            request.allowAliasing = allowAliasing;
+            return request;
+        }
+
+        /** Checks that requests sharing a resource are compatible and have disjoint lifetimes, and that the sizes add up.
+        */
+        void validatePlan(CPUUnitTestContext& ctx, const std::vector<Request>& requests, const ResourceAliasingPlanner::Plan& plan)
+        {
+            EXPECT_EQ(plan.resourceIndices.size(), requests.size());
+
+            uint64_t sizeWithoutAliasing = 0;
+            std::vector<uint64_t> resourceSizes(plan.getResourceCount(), 0);
+            for (size_t i = 0; i < requests.size(); i++)
+            {
+                const uint32_t resourceIndex = plan.resourceIndices[i];
+                EXPECT_LT(resourceIndex, plan.getResourceCount()) << "i = " << i;
+                resourceSizes[resourceIndex] = std::max(resourceSizes[resourceIndex], requests[i].size);
+                sizeWithoutAliasing += requests[i].size;
+
+                for (size_t j = i + 1; j < requests.size(); j++)
+                {
+                    if (plan.resourceIndices[j] != resourceIndex) continue;
+
+                    const bool disjoint = requests[i].lastUse < requests[j].firstUse || requests[j].lastUse < requests[i].firstUse;
+                    EXPECT(disjoint) << "i = " << i << ", j = " << j;
+                    EXPECT_EQ(requests[i].compatibilityClass, requests[j].compatibilityClass) << "i = " << i << ", j = " << j;
+                    EXPECT(requests[i].allowAliasing && requests[j].allowAliasing) << "i = " << i << ", j = " << j;
+                }
+            }
+
+            uint64_t sizeWithAliasing = 0;
+            for (uint32_t r = 0; r < plan.getResourceCount(); r++)
+            {
+                EXPECT_EQ(plan.resourceSizes[r], resourceSizes[r]) << "r = " << r;
+                sizeWithAliasing += resourceSizes[r];
+            }
+
+            EXPECT_EQ(plan.sizeWithoutAliasing, sizeWithoutAliasing);
+            EXPECT_EQ(plan.sizeWithAliasing, sizeWithAliasing);
+            EXPECT_LE(plan.peakLiveSize, plan.sizeWithAliasing);
+            EXPECT_LE(plan.sizeWithAliasing, plan.sizeWithoutAliasing);
+        }
+    }
+
+    CPU_TEST(ResourceAliasingPlanner_Empty)
+    {
+        ResourceAliasingPlanner::Plan plan = ResourceAliasingPlanner::plan({});
+        EXPECT_EQ(plan.getResourceCount(), 0u);
+        EXPECT_EQ(plan.sizeWithoutAliasing, 0ull);
+        EXPECT_EQ(plan.sizeWithAliasing, 0ull);
+        EXPECT_EQ(plan.peakLiveSize, 0ull);
+    }
+
+    CPU_TEST(ResourceAliasingPlanner_Chain)
+    {
+        // A chain of passes where each field is produced by one pass and consumed by the next.
+        // Lifetimes that end and start at the same time point overlap, so the chain needs two resources.
+        std::vector<Request> requests;
+        for (uint32_t i = 0; i < 8; i++) requests.push_back(createRequest(0, 100, i, i + 1));
+
+        ResourceAliasingPlanner::Plan plan = ResourceAliasingPlanner::plan(requests);
+        validatePlan(ctx, requests, plan);
+        EXPECT_EQ(plan.getResourceCount(), 2u);
+        for (uint32_t i = 0; i < 8; i++) EXPECT_EQ(plan.resourceIndices[i], i % 2) << "i = " << i;
+        EXPECT_EQ(plan.sizeWithoutAliasing, 800ull);
+        EXPECT_EQ(plan.sizeWithAliasing, 200ull);
+        EXPECT_EQ(plan.peakLiveSize, 200ull);
+    }
+
+    CPU_TEST(ResourceAliasingPlanner_Classes)
+    {
+        std::vector<Request> requests =
+        {
+            createRequest(0, 100, 0, 1),
+            createRequest(1, 50, 2, 3),                     // Different class, can't reuse the first resource.
+            createRequest(0, 100, 2, 3),                    // Reuses the first resource.
+            createRequest(0, 100, 4, 5, false),             // Not aliasable, needs a dedicated resource.
+            createRequest(1, 50, 4, uint32_t(-1)),          // Reuses the second resource and lives until the end.
+            createRequest(1, 50, 6, 7),                     // The second resource is still live, needs a new resource.
+        };
+
+        ResourceAliasingPlanner::Plan plan = ResourceAliasingPlanner::plan(requests);
+        validatePlan(ctx, requests, plan);
+        EXPECT_EQ(plan.getResourceCount(), 4u);
+        EXPECT_EQ(plan.resourceIndices[0], plan.resourceIndices[2]);
+        EXPECT_EQ(plan.resourceIndices[1], plan.resourceIndices[4]);
+        EXPECT_NE(plan.resourceIndices[3], plan.resourceIndices[0]);
+        EXPECT_NE(plan.resourceIndices[5], plan.resourceIndices[1]);
+        EXPECT_EQ(plan.sizeWithAliasing, 300ull);
+    }
+
+    CPU_TEST(ResourceAliasingPlanner_Random)
+    {
+        std::mt19937 rng;
+
+        for (uint32_t iteration = 0; iteration < 100; iteration++)
+        {
+            const uint32_t classCount = 1 + rng() % 4;
+            const uint32_t timePointCount = 1 + rng() % 32;
+
+            std::vector<Request> requests(rng() % 64);
+            for (auto& request : requests)
+            {
+                uint32_t a = rng() % timePointCount;
+                uint32_t b = rng() % timePointCount;
+                request = createRequest(rng() % classCount, 0, std::min(a, b), std::max(a, b), rng() % 8 != 0);
+                request.size = 1 + request.compatibilityClass;
+            }
+
+            ResourceAliasingPlanner::Plan plan = ResourceAliasingPlanner::plan(requests);
+            validatePlan(ctx, requests, plan);
+
+            // Interval graph coloring is optimal: each class uses as many resources as the largest number of aliasable
+            // requests live at the same time, plus one for each request that is not aliasable.
+            uint32_t expectedResourceCount = 0;
+            for (uint32_t c = 0; c < classCount; c++)
+            {
+                uint32_t maxLiveCount = 0;
+                for (uint32_t t = 0; t < timePointCount; t++)
+                {
+                    uint32_t liveCount = 0;
+                    for (const auto& request : requests)
+                    {
+                        if (request.compatibilityClass == c && request.allowAliasing && request.firstUse <= t && t <= request.lastUse) liveCount++;
+                    }
+                    maxLiveCount = std::max(maxLiveCount, liveCount);
+                }
+                expectedResourceCount += maxLiveCount;
+            }
+            for (const auto& request : requests) expectedResourceCount += request.allowAliasing ? 0 : 1;
+
+            EXPECT_EQ(plan.getResourceCount(), expectedResourceCount) << "iteration = " << iteration;
+        }
+    }
+}
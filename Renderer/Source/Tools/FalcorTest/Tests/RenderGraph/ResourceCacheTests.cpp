@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/ResourceCache.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBufferSize = 256;
+
+        void registerRawBufferField(ResourceCache& cache, const std::string& name, uint32_t timePoint)
+        {
+            RenderPassReflection reflection;
+            const auto& field = reflection.addOutput("output", "").rawBuffer(kBufferSize);
+            cache.registerField(name, field, timePoint);
+        }
+    }
+
+    GPU_TEST(ResourceCache_IndexLookup)
+    {
+        auto pCache = ResourceCache::create();
+        const std::vector<std::string> names = { "PassA.output", "PassB.output", "PassC.output" };
+        for (uint32_t i = 0; i < (uint32_t)names.size(); i++) registerRawBufferField(*pCache, names[i], i);
+        pCache->allocateResources({ uint2(64, 64), ResourceFormat::RGBA32Float });
+
+        for (const auto& name : names)
+        {
+            uint32_t index = pCache->getResourceIndex(name);
+            EXPECT_NE(index, ResourceCache::kInvalidResourceIndex) << "name = " << name;
+            EXPECT(pCache->getResource(index) != nullptr) << "name = " << name;
+            EXPECT(pCache->getResource(index) == pCache->getResource(name)) << "name = " << name;
+        }
+
+        EXPECT_EQ(pCache->getResourceIndex("PassA.missing"), ResourceCache::kInvalidResourceIndex);
+        EXPECT(pCache->getResource(ResourceCache::kInvalidResourceIndex) == nullptr);
+
+        // Adding an external resource changes the version, replacing it doesn't.
+        uint32_t version = pCache->getExternalResourceVersion();
+        auto pExternal = Buffer::create(kBufferSize);
+        pCache->registerExternalResource("PassA.input", pExternal);
+        EXPECT_NE(pCache->getExternalResourceVersion(), version);
+        version = pCache->getExternalResourceVersion();
+
+        uint32_t externalIndex = pCache->getResourceIndex("PassA.input");
+        EXPECT_NE(externalIndex, ResourceCache::kInvalidResourceIndex);
+        EXPECT(pCache->getResource(externalIndex) == pExternal);
+
+        auto pReplacement = Buffer::create(kBufferSize);
+        pCache->registerExternalResource("PassA.input", pReplacement);
+        EXPECT_EQ(pCache->getExternalResourceVersion(), version);
+        EXPECT_EQ(pCache->getResourceIndex("PassA.input"), externalIndex);
+        EXPECT(pCache->getResource(externalIndex) == pReplacement);
+
+        // External resources take precedence over graph resources of the same name.
+        pCache->registerExternalResource(names[0], pExternal);
+        EXPECT(pCache->getResource(pCache->getResourceIndex(names[0])) == pExternal);
+        EXPECT(pCache->getResource(names[0]) == pExternal);
+
+        // Removing an external resource changes the version and releases it from the old index.
+        version = pCache->getExternalResourceVersion();
+        pCache->registerExternalResource("PassA.input", nullptr);
+        EXPECT_NE(pCache->getExternalResourceVersion(), version);
+        EXPECT_EQ(pCache->getResourceIndex("PassA.input"), ResourceCache::kInvalidResourceIndex);
+        EXPECT(pCache->getResource(externalIndex) == nullptr);
+        EXPECT(pCache->getResource(pCache->getResourceIndex(names[0])) == pExternal);
+    }
+
+    CPU_TEST(ResourceCache_LookupBenchmark, "Disabled for performance reasons")
+    {
+        // Mimic a pass with many fields looking up its resources each frame. Resources are not allocated, only the lookup cost is measured.
+        const uint32_t kFieldCount = 32;
+        const uint32_t kIterations = 100000;
+
+        auto pCache = ResourceCache::create();
+        const std::string passName = "DenoisingPass";
+        std::vector<std::string> fieldNames;
+        for (uint32_t i = 0; i < kFieldCount; i++)
+        {
+            fieldNames.push_back("field" + std::to_string(i));
+            registerRawBufferField(*pCache, passName + '.' + fieldNames.back(), i);
+        }
+
+        std::vector<uint32_t> indices;
+        for (const auto& fieldName : fieldNames) indices.push_back(pCache->getResourceIndex(passName + '.' + fieldName));
+
+        size_t count = 0;
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t it = 0; it < kIterations; it++)
+        {
+            for (const auto& fieldName : fieldNames) count += pCache->getResource(passName + '.' + fieldName) == nullptr;
+        }
+        double stringTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t it = 0; it < kIterations; it++)
+        {
+            for (uint32_t index : indices) count += pCache->getResource(index) == nullptr;
+        }
+        double indexTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        EXPECT_EQ(count, size_t(2) * kIterations * kFieldCount);
+        const double lookups = double(kIterations) * kFieldCount;
+        logInfo("ResourceCache lookups: string {:.1f} ns, index {:.1f} ns ({:.1f}x)", stringTime * 1e6 / lookups, indexTime * 1e6 / lookups, stringTime / indexTime);
+    }
+}
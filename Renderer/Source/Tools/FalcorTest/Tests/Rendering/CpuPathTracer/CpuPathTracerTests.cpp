@@ -0,0 +1,153 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/CpuPathTracer/CpuPathTracer.h"
+#include "Scene/SceneBuilder.h"
+#include "glm/gtx/transform.hpp"
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Create a scene with a diffuse floor lit by an emissive quad and optionally a point light.
+        */
+        SceneBuilder::SharedPtr createTestScene(bool addPointLight)
+        {
+            auto pBuilder = SceneBuilder::create();
+
+            auto pFloorMaterial = StandardMaterial::create("Floor");
+            pFloorMaterial->setBaseColor(float4(0.8f, 0.6f, 0.4f, 1.f));
+            pFloorMaterial->setRoughness(0.5f);
+            auto floorMeshID = pBuilder->addTriangleMesh(TriangleMesh::createQuad(float2(4.f)), pFloorMaterial);
+            auto floorNodeID = pBuilder->addNode({ "Floor", glm::identity<glm::mat4>() });
+            pBuilder->addMeshInstance(floorNodeID, floorMeshID);
+
+            // Light quad at y = 1 facing down.
+            auto pLightMaterial = StandardMaterial::create("Light");
+            pLightMaterial->setBaseColor(float4(0.f, 0.f, 0.f, 1.f));
+            pLightMaterial->setEmissiveColor(float3(4.f));
+            auto lightMeshID = pBuilder->addTriangleMesh(TriangleMesh::createQuad(float2(1.f)), pLightMaterial);
+            glm::mat4 lightTransform = glm::translate(float3(0.f, 1.f, 0.f)) * glm::rotate((float)M_PI, float3(1.f, 0.f, 0.f));
+            auto lightNodeID = pBuilder->addNode({ "Light", lightTransform });
+            pBuilder->addMeshInstance(lightNodeID, lightMeshID);
+
+            if (addPointLight)
+            {
+                auto pLight = PointLight::create("PointLight");
+                pLight->setWorldPosition(float3(1.f, 0.5f, 0.f));
+                pLight->setIntensity(float3(2.f));
+                pBuilder->addLight(pLight);
+            }
+
+            auto pCamera = Camera::create("Camera");
+            pCamera->setPosition(float3(0.f, 1.5f, 3.f));
+            pCamera->setTarget(float3(0.f, 0.f, 0.f));
+            pCamera->setUpVector(float3(0.f, 1.f, 0.f));
+            pBuilder->addCamera(pCamera);
+
+            return pBuilder;
+        }
+
+        float3 computeMean(const std::vector<float4>& image)
+        {
+            glm::dvec3 sum = glm::dvec3(0.0);
+            for (const auto& v : image) sum += glm::dvec3(v.x, v.y, v.z);
+            return float3(sum / (double)image.size());
+        }
+    }
+
+    GPU_TEST(CpuPathTracer_Deterministic)
+    {
+        auto pBuilder = createTestScene(true);
+        const Scene::SceneData& sceneData = pBuilder->getSceneData();
+
+        CpuPathTracer::Options options;
+        options.frameDim = uint2(48, 32);
+        options.maxBounces = 2;
+        options.tileSize = 16;
+
+        auto pPathTracer = CpuPathTracer::create(sceneData, options);
+        EXPECT_EQ(pPathTracer->getBVH().getTriangleCount(), 4u);
+        pPathTracer->render(4);
+        EXPECT_EQ(pPathTracer->getSampleCount(), 4u);
+        const std::vector<float4> image = pPathTracer->getImage();
+        EXPECT_EQ(image.size(), 48u * 32u);
+
+        bool isFinite = true;
+        for (const auto& v : image) isFinite &= std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+        EXPECT(isFinite);
+        float3 mean = computeMean(image);
+        EXPECT_GT(mean.x, 0.f);
+        EXPECT_GT(mean.x, mean.z); // Floor is orange.
+
+        // The result must not depend on the tiling (and hence on the thread scheduling).
+        options.tileSize = 7;
+        auto pOtherPathTracer = CpuPathTracer::create(sceneData, options);
+        pOtherPathTracer->render(4);
+        const std::vector<float4> otherImage = pOtherPathTracer->getImage();
+        bool isEqual = otherImage.size() == image.size() && std::equal(image.begin(), image.end(), otherImage.begin());
+        EXPECT(isEqual);
+
+        // Writing the image produces an EXR file.
+        std::filesystem::path path = getTempFilePath();
+        path.replace_extension(".exr");
+        pPathTracer->saveImage(path);
+        EXPECT(std::filesystem::exists(path));
+        std::filesystem::remove(path);
+
+        // The scene data stays usable for creating the scene.
+        EXPECT(pBuilder->getScene() != nullptr);
+    }
+
+    GPU_TEST(CpuPathTracer_LightSampling)
+    {
+        // Direct illumination from the emissive quad must agree with and without light sampling.
+        auto pBuilder = createTestScene(false);
+        const Scene::SceneData& sceneData = pBuilder->getSceneData();
+
+        CpuPathTracer::Options options;
+        options.frameDim = uint2(32, 32);
+        options.maxBounces = 0;
+
+        options.useNEE = true;
+        auto pNEE = CpuPathTracer::create(sceneData, options);
+        pNEE->render(32);
+
+        options.useNEE = false;
+        auto pNoNEE = CpuPathTracer::create(sceneData, options);
+        pNoNEE->render(128);
+
+        float3 meanNEE = computeMean(pNEE->getImage());
+        float3 meanNoNEE = computeMean(pNoNEE->getImage());
+        EXPECT_GT(meanNEE.x, 0.f);
+        for (int i = 0; i < 3; i++)
+        {
+            EXPECT_LT(std::abs(meanNEE[i] - meanNoNEE[i]), 0.05f * meanNEE[i]) << "channel " << i << ": " << meanNEE[i] << " vs " << meanNoNEE[i];
+        }
+    }
+}
@@ -0,0 +1,311 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using MeshLightTriangle = LightCollection::MeshLightTriangle;
+
+        const uint32_t kClusterCount = 8;
+        const uint32_t kTrianglesPerCluster = 64;
+
+        /** Creates small emissive triangles grouped in clusters, similar to a scene with a few emissive objects.
+        */
+        std::vector<MeshLightTriangle> createTriangles()
+        {
+            std::mt19937 rng;
+            std::uniform_real_distribution<float> uniform;
+            auto randomFloat3 = [&]() { return float3(uniform(rng), uniform(rng), uniform(rng)); };
+
+            std::vector<MeshLightTriangle> triangles;
+            for (uint32_t cluster = 0; cluster < kClusterCount; ++cluster)
+            {
+                const float3 clusterCenter = randomFloat3() * 10.f;
+                for (uint32_t i = 0; i < kTrianglesPerCluster; ++i)
+                {
+                    MeshLightTriangle tri;
+                    const float3 p = clusterCenter + randomFloat3() - 0.5f;
+                    tri.vtx[0].pos = p;
+                    tri.vtx[1].pos = p + randomFloat3() * 0.1f;
+                    tri.vtx[2].pos = p + randomFloat3() * 0.1f;
+                    const float3 n = glm::cross(tri.vtx[1].pos - tri.vtx[0].pos, tri.vtx[2].pos - tri.vtx[0].pos);
+                    tri.area = 0.5f * glm::length(n);
+                    tri.normal = glm::normalize(n);
+                    tri.lightIdx = cluster;
+                    tri.flux = 0.1f + uniform(rng);
+                    tri.averageRadiance = float3(tri.flux / tri.area);
+                    triangles.push_back(tri);
+                }
+            }
+            return triangles;
+        }
+
+        void moveCluster(std::vector<MeshLightTriangle>& triangles, uint32_t cluster, const float3& offset)
+        {
+            for (auto& tri : triangles)
+            {
+                if (tri.lightIdx != cluster) continue;
+                for (uint32_t j = 0; j < 3; j++) tri.vtx[j].pos += offset;
+            }
+        }
+
+        /** Returns the node attributes after a roundtrip through the packed node format.
+        */
+        SharedNodeAttributes quantize(const SharedNodeAttributes& attribs)
+        {
+            PackedNode node = {};
+            node.setNodeAttributes(attribs);
+            return node.getNodeAttributes();
+        }
+
+        /** Returns the SAH cost of the whole tree, normalized by the root node area.
+        */
+        float computeTreeCost(const std::vector<PackedNode>& nodes)
+        {
+            auto getArea = [](const PackedNode& node)
+            {
+                const auto attribs = node.getNodeAttributes();
+                return AABB(attribs.origin - attribs.extent, attribs.origin + attribs.extent).area();
+            };
+
+            float cost = 0.f;
+            for (const auto& node : nodes)
+            {
+                cost += getArea(node) * (node.isLeaf() ? (float)node.getLeafNode().triangleCount : 1.f);
+            }
+            return cost / getArea(nodes[0]);
+        }
+
+        /** Validates the hierarchy and compares the node data against a reference computed from scratch for each node.
+        */
+        void validateTree(CPUUnitTestContext& ctx, const std::vector<MeshLightTriangle>& triangles, const LightBVHBuilder::BVHData& data)
+        {
+            std::vector<uint32_t> triangleRefCount(triangles.size(), 0);
+
+            struct StackEntry
+            {
+                uint32_t nodeIndex;
+                uint64_t bitmask;
+                uint32_t depth;
+            };
+            std::vector<StackEntry> stack = { { 0, 0ull, 0 } };
+            uint32_t visitedNodeCount = 0;
+
+            while (!stack.empty())
+            {
+                const StackEntry entry = stack.back();
+                stack.pop_back();
+                visitedNodeCount++;
+
+                // Gather all triangles in the subtree.
+                std::vector<uint32_t> subtreeTriangles;
+                std::vector<uint32_t> subtreeStack = { entry.nodeIndex };
+                while (!subtreeStack.empty())
+                {
+                    const uint32_t nodeIndex = subtreeStack.back();
+                    subtreeStack.pop_back();
+                    if (data.nodes[nodeIndex].isLeaf())
+                    {
+                        const LeafNode leaf = data.nodes[nodeIndex].getLeafNode();
+                        for (uint32_t i = 0; i < leaf.triangleCount; i++) subtreeTriangles.push_back(data.triangleIndices[leaf.triangleOffset + i]);
+                    }
+                    else
+                    {
+                        subtreeStack.push_back(nodeIndex + 1);
+                        subtreeStack.push_back(data.nodes[nodeIndex].getInternalNode().rightChildIdx);
+                    }
+                }
+
+                // Compare bounds and flux against the reference.
+                AABB bounds;
+                float flux = 0.f;
+                for (uint32_t triangleIndex : subtreeTriangles)
+                {
+                    for (uint32_t j = 0; j < 3; j++) bounds |= triangles[triangleIndex].vtx[j].pos;
+                    flux += triangles[triangleIndex].flux;
+                }
+                SharedNodeAttributes expected;
+                expected.setAABB(bounds.minPoint, bounds.maxPoint);
+                expected = quantize(expected);
+
+                const SharedNodeAttributes attribs = data.nodes[entry.nodeIndex].getNodeAttributes();
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    EXPECT_EQ(attribs.origin[i], expected.origin[i]) << "node " << entry.nodeIndex;
+                    EXPECT_EQ(attribs.extent[i], expected.extent[i]) << "node " << entry.nodeIndex;
+                }
+                EXPECT_LE(std::abs(attribs.flux - flux), 1e-5f * flux) << "node " << entry.nodeIndex;
+
+                if (data.nodes[entry.nodeIndex].isLeaf())
+                {
+                    const LeafNode leaf = data.nodes[entry.nodeIndex].getLeafNode();
+                    for (uint32_t i = 0; i < leaf.triangleCount; i++)
+                    {
+                        const uint32_t triangleIndex = data.triangleIndices[leaf.triangleOffset + i];
+                        triangleRefCount[triangleIndex]++;
+                        EXPECT_EQ(data.triangleBitmasks[triangleIndex], entry.bitmask) << "triangle " << triangleIndex;
+                    }
+                }
+                else
+                {
+                    stack.push_back({ entry.nodeIndex + 1, entry.bitmask | (0ull << entry.depth), entry.depth + 1 });
+                    stack.push_back({ data.nodes[entry.nodeIndex].getInternalNode().rightChildIdx, entry.bitmask | (1ull << entry.depth), entry.depth + 1 });
+                }
+            }
+
+            EXPECT_EQ(visitedNodeCount, data.nodes.size());
+            EXPECT_EQ(data.nodeCosts.size(), data.nodes.size());
+            for (size_t i = 0; i < triangles.size(); i++)
+            {
+                EXPECT_EQ(triangleRefCount[i], 1) << "triangle " << i;
+            }
+        }
+
+        LightBVHBuilder::Options getOptions(float maxRefitCostRatio)
+        {
+            LightBVHBuilder::Options options;
+            options.splitHeuristicSelection = LightBVHBuilder::SplitHeuristic::BinnedSAH;
+            options.refitOnCPU = true;
+            options.maxRefitCostRatio = maxRefitCostRatio;
+            return options;
+        }
+    }
+
+    CPU_TEST(LightBVHRefitUnchanged)
+    {
+        // Refitting without any changes should reproduce the built nodes.
+        const auto triangles = createTriangles();
+        auto pBuilder = LightBVHBuilder::create(getOptions(1.5f));
+
+        LightBVHBuilder::BVHData built;
+        pBuilder->buildNodes(triangles, built);
+        EXPECT(!built.nodes.empty());
+
+        LightBVHBuilder::BVHData refitted = built;
+        const auto stats = pBuilder->refitNodes(triangles, refitted);
+        EXPECT_EQ(stats.rebuiltSubtreeCount, 0);
+
+        EXPECT_EQ(refitted.nodes.size(), built.nodes.size());
+        EXPECT(refitted.triangleIndices == built.triangleIndices);
+        EXPECT(refitted.triangleBitmasks == built.triangleBitmasks);
+
+        for (size_t i = 0; i < built.nodes.size(); i++)
+        {
+            EXPECT_EQ(refitted.nodes[i].isLeaf(), built.nodes[i].isLeaf()) << "node " << i;
+            EXPECT_EQ(refitted.nodes[i].data[0].x, built.nodes[i].data[0].x) << "node " << i;
+
+            const auto a = refitted.nodes[i].getNodeAttributes();
+            const auto b = built.nodes[i].getNodeAttributes();
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                EXPECT_EQ(a.origin[j], b.origin[j]) << "node " << i;
+                EXPECT_EQ(a.extent[j], b.extent[j]) << "node " << i;
+                EXPECT_EQ(a.coneDirection[j], b.coneDirection[j]) << "node " << i;
+            }
+            EXPECT_EQ(a.cosConeAngle, b.cosConeAngle) << "node " << i;
+
+            // Internal node flux is summed per child when refitting, so allow for rounding differences.
+            EXPECT_LE(std::abs(a.flux - b.flux), 1e-5f * b.flux) << "node " << i;
+        }
+
+        validateTree(ctx, triangles, refitted);
+    }
+
+    CPU_TEST(LightBVHRefitMoved)
+    {
+        // Move one emissive object and refit without allowing rebuilds.
+        auto triangles = createTriangles();
+        auto pBuilder = LightBVHBuilder::create(getOptions(0.f));
+
+        LightBVHBuilder::BVHData data;
+        pBuilder->buildNodes(triangles, data);
+        const auto topology = data.nodes;
+
+        moveCluster(triangles, 3, float3(0.25f, -0.5f, 0.75f));
+        const auto stats = pBuilder->refitNodes(triangles, data);
+        EXPECT_EQ(stats.rebuiltSubtreeCount, 0);
+        EXPECT_GE(stats.maxCostRatio, 1.f);
+
+        // The hierarchy is unchanged.
+        EXPECT_EQ(data.nodes.size(), topology.size());
+        for (size_t i = 0; i < topology.size(); i++)
+        {
+            EXPECT_EQ(data.nodes[i].data[0].x, topology[i].data[0].x) << "node " << i;
+        }
+
+        validateTree(ctx, triangles, data);
+
+        // The root node covers the same triangles as the root of a full rebuild.
+        LightBVHBuilder::BVHData rebuilt;
+        pBuilder->buildNodes(triangles, rebuilt);
+        const auto a = data.nodes[0].getNodeAttributes();
+        const auto b = rebuilt.nodes[0].getNodeAttributes();
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            EXPECT_EQ(a.origin[j], b.origin[j]);
+            EXPECT_EQ(a.extent[j], b.extent[j]);
+        }
+        EXPECT_LE(std::abs(a.flux - b.flux), 1e-5f * b.flux);
+    }
+
+    CPU_TEST(LightBVHRefitPartialRebuild)
+    {
+        // Move one emissive object far away so that the quality of the refitted tree degrades.
+        auto triangles = createTriangles();
+        auto pRefitBuilder = LightBVHBuilder::create(getOptions(0.f));
+        auto pRebuildBuilder = LightBVHBuilder::create(getOptions(1.5f));
+
+        LightBVHBuilder::BVHData refitOnly;
+        pRefitBuilder->buildNodes(triangles, refitOnly);
+        LightBVHBuilder::BVHData partialRebuild = refitOnly;
+
+        moveCluster(triangles, 5, float3(40.f, 0.f, -40.f));
+        pRefitBuilder->refitNodes(triangles, refitOnly);
+        const auto stats = pRebuildBuilder->refitNodes(triangles, partialRebuild);
+
+        EXPECT_GT(stats.maxCostRatio, 1.5f);
+        EXPECT_GT(stats.rebuiltSubtreeCount, 0);
+        EXPECT_GT(stats.rebuiltTriangleCount, 0);
+        EXPECT_LT(stats.rebuiltTriangleCount, (uint32_t)triangles.size());
+
+        validateTree(ctx, triangles, refitOnly);
+        validateTree(ctx, triangles, partialRebuild);
+
+        // The partially rebuilt tree should be at least as good as the refitted tree.
+        EXPECT_LE(computeTreeCost(partialRebuild.nodes), computeTreeCost(refitOnly.nodes));
+
+        // A second refit without changes should not trigger any more rebuilds.
+        const auto secondStats = pRebuildBuilder->refitNodes(triangles, partialRebuild);
+        EXPECT_EQ(secondStats.rebuiltSubtreeCount, 0);
+        validateTree(ctx, triangles, partialRebuild);
+    }
+}
@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/AssimpImporter.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Write an OBJ file with a number of grid objects next to each other.
+            With the given grid size, the estimated processing memory of each object is above 0.5 MB,
+            so a memory budget of 1 MB puts every object into its own group.
+        */
+        void writeGridsObj(const std::filesystem::path& path, uint32_t gridCount, uint32_t gridSize)
+        {
+            std::ofstream file(path);
+            uint32_t vertexOffset = 1;
+            for (uint32_t g = 0; g < gridCount; g++)
+            {
+                file << "o Grid" << g << "\n";
+                for (uint32_t y = 0; y <= gridSize; y++)
+                {
+                    for (uint32_t x = 0; x <= gridSize; x++)
+                    {
+                        float2 uv = float2(x, y) / float(gridSize);
+                        file << "v " << (g * 3.f + uv.x * 2.f) << " " << std::sin(uv.x * 6.f + g) * 0.1f << " " << uv.y * 2.f << "\n";
+                        file << "vt " << uv.x << " " << uv.y << "\n";
+                    }
+                }
+                for (uint32_t y = 0; y < gridSize; y++)
+                {
+                    for (uint32_t x = 0; x < gridSize; x++)
+                    {
+                        uint32_t i = vertexOffset + y * (gridSize + 1) + x;
+                        uint32_t j = i + gridSize + 1;
+                        file << fmt::format("f {0}/{0} {1}/{1} {2}/{2}\n", i, j, i + 1);
+                        file << fmt::format("f {0}/{0} {1}/{1} {2}/{2}\n", i + 1, j, j + 1);
+                    }
+                }
+                vertexOffset += (gridSize + 1) * (gridSize + 1);
+            }
+        }
+
+        SceneBuilder::SharedPtr importGrids(const std::filesystem::path& path, bool streaming)
+        {
+            Dictionary dict;
+            if (streaming)
+            {
+                dict["streaming"] = true;
+                dict["memoryBudgetMB"] = 1;
+            }
+            auto pBuilder = SceneBuilder::create();
+            AssimpImporter::import(path, *pBuilder, {}, dict);
+            return pBuilder;
+        }
+    }
+
+    GPU_TEST(AssimpImporter_StreamingMatchesDefault)
+    {
+        const uint32_t kGridCount = 4;
+        std::filesystem::path path = getTempFilePath();
+        path.replace_extension(".obj");
+        writeGridsObj(path, kGridCount, 64);
+
+        auto pDefaultBuilder = importGrids(path, false);
+        auto pStreamingBuilder = importGrids(path, true);
+        std::filesystem::remove(path);
+
+        const auto& expected = pDefaultBuilder->getSceneData();
+        const auto& result = pStreamingBuilder->getSceneData();
+
+        // Mesh IDs, order and data are the same.
+        EXPECT_EQ(expected.meshDesc.size(), kGridCount);
+        EXPECT_EQ(result.meshDesc.size(), expected.meshDesc.size());
+        EXPECT(result.meshNames == expected.meshNames);
+        for (size_t i = 0; i < std::min(result.meshDesc.size(), expected.meshDesc.size()); i++)
+        {
+            EXPECT(std::memcmp(&result.meshDesc[i], &expected.meshDesc[i], sizeof(MeshDesc)) == 0) << "mesh = " << i;
+        }
+        EXPECT(result.meshIndexData == expected.meshIndexData);
+        EXPECT_EQ(result.meshStaticData.size(), expected.meshStaticData.size());
+        if (result.meshStaticData.size() == expected.meshStaticData.size())
+        {
+            EXPECT(std::memcmp(result.meshStaticData.data(), expected.meshStaticData.data(), expected.meshStaticData.size() * sizeof(PackedStaticVertexData)) == 0);
+        }
+
+        // Instances reference the same meshes and nodes.
+        EXPECT_EQ(result.sceneGraph.size(), expected.sceneGraph.size());
+        EXPECT_EQ(result.meshInstanceData.size(), expected.meshInstanceData.size());
+        for (size_t i = 0; i < std::min(result.meshInstanceData.size(), expected.meshInstanceData.size()); i++)
+        {
+            EXPECT_EQ(result.meshInstanceData[i].geometryID, expected.meshInstanceData[i].geometryID) << "instance = " << i;
+            EXPECT_EQ(result.meshInstanceData[i].globalMatrixID, expected.meshInstanceData[i].globalMatrixID) << "instance = " << i;
+            EXPECT_EQ(result.meshInstanceData[i].materialID, expected.meshInstanceData[i].materialID) << "instance = " << i;
+        }
+    }
+}
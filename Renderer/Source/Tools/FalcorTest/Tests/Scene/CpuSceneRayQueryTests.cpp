@@ -0,0 +1,440 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/CpuSceneRayQuery.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "glm/gtx/transform.hpp"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct TestScene
+        {
+            Scene::SceneData sceneData;
+            std::vector<std::vector<float3>> meshPositions;     ///< Triangle vertex positions for each mesh, three per triangle.
+        };
+
+        float4x4 createRandomTransform(std::mt19937& rng, float extent)
+        {
+            std::uniform_real_distribution<float> dist(0.f, 1.f);
+            float3 translation = float3(dist(rng), dist(rng), dist(rng)) * extent;
+            float3 axis = glm::normalize(float3(dist(rng), dist(rng), dist(rng)) + 0.1f);
+            return glm::translate(translation) * glm::rotate(dist(rng) * 6.28f, axis) * glm::scale(float3(0.5f + dist(rng)));
+        }
+
+        /** Create a scene with five meshes laid out in mesh groups like SceneBuilder does:
+            - Group 0 is static and holds meshes 3 (16-bit indices) and 4 (32-bit indices) with a single instance.
+            - Group 1 holds meshes 1 (16-bit indices) and 2 (non-indexed) with groupInstanceCount instances.
+            - Group 2 holds the vertex-animated mesh 0 (32-bit indices) with groupInstanceCount instances.
+            The instances are placed under a random node hierarchy. Mesh instances are ordered by group like in the scene.
+            If indexed is false, all meshes are non-indexed and the scene has no index data.
+        */
+        TestScene createTestScene(uint32_t trianglesPerMesh, uint32_t groupInstanceCount, float extent, uint32_t seed, bool indexed = true)
+        {
+            FALCOR_ASSERT(3 * trianglesPerMesh <= 0xffff);
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+            TestScene scene;
+            auto& sceneData = scene.sceneData;
+            for (uint32_t meshID = 0; meshID < 5; meshID++)
+            {
+                const uint32_t vertexCount = 3 * trianglesPerMesh;
+                const bool isIndexed = indexed && meshID != 2;
+                MeshDesc mesh = {};
+                mesh.vbOffset = (uint32_t)sceneData.meshStaticData.size();
+                mesh.ibOffset = (uint32_t)sceneData.meshIndexData.size();
+                mesh.vertexCount = vertexCount;
+
+                // Small triangles scattered in a 10^3 box. Vertices are referenced in reverse order by the indexed meshes.
+                std::vector<float3> positions(vertexCount);
+                for (uint32_t t = 0; t < trianglesPerMesh; t++)
+                {
+                    float3 center = float3(dist(rng), dist(rng), dist(rng)) * 10.f;
+                    for (uint32_t j = 0; j < 3; j++) positions[3 * t + j] = center + float3(dist(rng), dist(rng), dist(rng)) - 0.5f;
+                }
+                for (uint32_t v = 0; v < vertexCount; v++)
+                {
+                    PackedStaticVertexData vertex = {};
+                    vertex.position = isIndexed ? positions[vertexCount - 1 - v] : positions[v];
+                    sceneData.meshStaticData.push_back(vertex);
+                }
+
+                if (meshID == 0) mesh.flags = (uint32_t)MeshFlags::IsAnimated;
+                if (isIndexed && (meshID == 0 || meshID == 4))
+                {
+                    mesh.indexCount = vertexCount;
+                    for (uint32_t i = 0; i < vertexCount; i++) sceneData.meshIndexData.push_back(vertexCount - 1 - i);
+                }
+                else if (isIndexed && (meshID == 1 || meshID == 3))
+                {
+                    mesh.indexCount = vertexCount;
+                    mesh.flags = (uint32_t)MeshFlags::Use16BitIndices;
+                    std::vector<uint16_t> indices(vertexCount + (vertexCount & 1));
+                    for (uint32_t i = 0; i < vertexCount; i++) indices[i] = (uint16_t)(vertexCount - 1 - i);
+                    const uint32_t* pPacked = reinterpret_cast<const uint32_t*>(indices.data());
+                    sceneData.meshIndexData.insert(sceneData.meshIndexData.end(), pPacked, pPacked + indices.size() / 2);
+                }
+
+                sceneData.meshDesc.push_back(mesh);
+                scene.meshPositions.push_back(positions);
+            }
+
+            sceneData.meshGroups = { { { 3, 4 }, true }, { { 1, 2 }, false }, { { 0 }, false } };
+
+            sceneData.sceneGraph.push_back(Scene::Node("root", Scene::kInvalidNode, createRandomTransform(rng, extent), glm::identity<glm::mat4>(), glm::identity<glm::mat4>()));
+            for (const auto& meshGroup : sceneData.meshGroups)
+            {
+                const uint32_t instanceCount = meshGroup.isStatic ? 1 : groupInstanceCount;
+                for (uint32_t i = 0; i < instanceCount; i++)
+                {
+                    // Parents are always stored before their children. The node of the static group is a child of the root.
+                    const uint32_t nodeID = (uint32_t)sceneData.sceneGraph.size();
+                    const uint32_t parent = i % 4 == 0 ? 0 : (uint32_t)(rng() % nodeID);
+                    sceneData.sceneGraph.push_back(Scene::Node("node", parent, createRandomTransform(rng, parent == 0 ? extent : 2.f), glm::identity<glm::mat4>(), glm::identity<glm::mat4>()));
+
+                    for (uint32_t meshID : meshGroup.meshList)
+                    {
+                        GeometryInstanceData instance(GeometryType::TriangleMesh);
+                        instance.globalMatrixID = nodeID;
+                        instance.geometryID = meshID;
+                        sceneData.meshInstanceData.push_back(instance);
+                    }
+                }
+            }
+            return scene;
+        }
+
+        std::vector<float4x4> computeGlobalMatrices(const Scene::SceneData& sceneData)
+        {
+            std::vector<float4x4> globalMatrices(sceneData.sceneGraph.size());
+            for (size_t i = 0; i < globalMatrices.size(); i++)
+            {
+                const auto& node = sceneData.sceneGraph[i];
+                globalMatrices[i] = node.parent == Scene::kInvalidNode ? node.transform : globalMatrices[node.parent] * node.transform;
+            }
+            return globalMatrices;
+        }
+
+        /** Intersect an object-space ray with triangle i of a mesh, using the same test as the ray query.
+        */
+        bool intersectTriangle(const std::vector<float3>& positions, uint32_t i, const float3& origin, const float3& dir, float tMin, float tMax, float& t, float2& barycentrics)
+        {
+            const float3 v0 = positions[3 * i];
+            const float3 e1 = positions[3 * i + 1] - v0;
+            const float3 e2 = positions[3 * i + 2] - v0;
+            float3 p = cross(dir, e2);
+            float det = dot(e1, p);
+            if (det == 0.f) return false;
+            float invDet = 1.f / det;
+            float3 s = origin - v0;
+            float u = dot(s, p) * invDet;
+            if (u < 0.f || u > 1.f) return false;
+            float3 q = cross(s, e1);
+            float v = dot(dir, q) * invDet;
+            if (v < 0.f || u + v > 1.f) return false;
+            t = dot(e2, q) * invDet;
+            if (t < tMin || t > tMax) return false;
+            barycentrics = float2(u, v);
+            return true;
+        }
+
+        /** Brute-force closest hit using the same ray transform and intersection test as the ray query.
+        */
+        CpuSceneRayQuery::Hit intersectBruteForce(const TestScene& scene, const std::vector<float4x4>& globalMatrices, const CpuSceneRayQuery::Ray& ray)
+        {
+            CpuSceneRayQuery::Hit hit;
+            float tMax = ray.tMax;
+            for (uint32_t instanceID = 0; instanceID < (uint32_t)scene.sceneData.meshInstanceData.size(); instanceID++)
+            {
+                const auto& instance = scene.sceneData.meshInstanceData[instanceID];
+                const float4x4 worldToObject = glm::inverse(globalMatrices[instance.globalMatrixID]);
+                const float3 origin = float3(worldToObject * float4(ray.origin, 1.f));
+                const float3 dir = float3(worldToObject * float4(ray.dir, 0.f));
+
+                const auto& positions = scene.meshPositions[instance.geometryID];
+                for (uint32_t i = 0; i < (uint32_t)positions.size() / 3; i++)
+                {
+                    float t;
+                    float2 barycentrics;
+                    if (!intersectTriangle(positions, i, origin, dir, ray.tMin, tMax, t, barycentrics)) continue;
+                    tMax = t;
+                    hit.instanceID.index = instanceID;
+                    hit.primitiveIndex = i;
+                    hit.barycentrics = barycentrics;
+                    hit.t = t;
+                }
+            }
+            return hit;
+        }
+
+        /** Check that a hit reported by the ray query is an actual hit of the ray.
+        */
+        void verifyHit(CPUUnitTestContext& ctx, const TestScene& scene, const std::vector<float4x4>& globalMatrices, const CpuSceneRayQuery::Ray& ray, const CpuSceneRayQuery::Hit& hit, size_t rayIndex)
+        {
+            EXPECT_LT(hit.instanceID.index, (uint32_t)scene.sceneData.meshInstanceData.size()) << "i = " << rayIndex;
+            if (hit.instanceID.index >= (uint32_t)scene.sceneData.meshInstanceData.size()) return;
+
+            const auto& instance = scene.sceneData.meshInstanceData[hit.instanceID.index];
+            const auto& positions = scene.meshPositions[instance.geometryID];
+            EXPECT_LT(hit.primitiveIndex, (uint32_t)positions.size() / 3) << "i = " << rayIndex;
+            if (hit.primitiveIndex >= (uint32_t)positions.size() / 3) return;
+
+            const float4x4 worldToObject = glm::inverse(globalMatrices[instance.globalMatrixID]);
+            const float3 origin = float3(worldToObject * float4(ray.origin, 1.f));
+            const float3 dir = float3(worldToObject * float4(ray.dir, 0.f));
+            float t = 0.f;
+            float2 barycentrics;
+            const bool found = intersectTriangle(positions, hit.primitiveIndex, origin, dir, ray.tMin, ray.tMax, t, barycentrics);
+            EXPECT(found) << "i = " << rayIndex;
+            if (found) EXPECT_LE(std::abs(hit.t - t), 1e-4f * t) << "i = " << rayIndex;
+        }
+
+        /** Get the options to test: the standard mode, and the compact mode with referenced and with copied scene data.
+        */
+        std::vector<CpuSceneRayQuery::Options> getTestOptions(uint32_t width = 4)
+        {
+            std::vector<CpuSceneRayQuery::Options> options(3);
+            for (uint32_t i = 0; i < (uint32_t)options.size(); i++)
+            {
+                options[i].width = width;
+                options[i].compact = i > 0;
+                options[i].copySceneData = i == 2;
+            }
+            return options;
+        }
+
+        std::vector<CpuSceneRayQuery::Ray> createRandomRays(const AABB& bounds, uint32_t count, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> dist(0.f, 1.f);
+            std::vector<CpuSceneRayQuery::Ray> rays(count);
+            for (auto& ray : rays)
+            {
+                float3 origin = bounds.minPoint + float3(dist(rng), dist(rng), dist(rng)) * bounds.extent();
+                float3 dir = glm::normalize(float3(dist(rng), dist(rng), dist(rng)) - 0.5f);
+                ray = CpuSceneRayQuery::Ray(origin, dir);
+            }
+            return rays;
+        }
+
+        void testAgainstBruteForce(CPUUnitTestContext& ctx, const CpuSceneRayQuery& rayQuery, const TestScene& scene, const std::vector<float4x4>& globalMatrices, uint32_t seed)
+        {
+            const std::vector<CpuSceneRayQuery::Ray> rays = createRandomRays(rayQuery.getBounds(), 500, seed);
+            std::vector<CpuSceneRayQuery::Hit> batchHits(rays.size());
+            std::vector<CpuSceneRayQuery::Hit> batchAnyHits(rays.size());
+            std::unique_ptr<bool[]> batchOccluded(new bool[rays.size()]);
+            rayQuery.intersect(rays.data(), batchHits.data(), rays.size());
+            rayQuery.intersectAny(rays.data(), batchAnyHits.data(), rays.size());
+            rayQuery.occluded(rays.data(), batchOccluded.get(), rays.size());
+
+            uint32_t hitCount = 0;
+            for (size_t i = 0; i < rays.size(); i++)
+            {
+                const CpuSceneRayQuery::Hit expected = intersectBruteForce(scene, globalMatrices, rays[i]);
+                CpuSceneRayQuery::Hit hit;
+                const bool found = rayQuery.intersect(rays[i], hit);
+                EXPECT_EQ(found, expected.isValid()) << "i = " << i;
+                EXPECT_EQ(rayQuery.occluded(rays[i]), found) << "i = " << i;
+                EXPECT_EQ(batchOccluded[i], found) << "i = " << i;
+                EXPECT_EQ(batchHits[i].instanceID.index, hit.instanceID.index) << "i = " << i;
+                EXPECT_EQ(batchHits[i].primitiveIndex, hit.primitiveIndex) << "i = " << i;
+                if (found && expected.isValid())
+                {
+                    EXPECT_EQ(hit.instanceID.index, expected.instanceID.index) << "i = " << i;
+                    EXPECT_EQ(hit.primitiveIndex, expected.primitiveIndex) << "i = " << i;
+                    EXPECT_LE(std::abs(hit.t - expected.t), 1e-4f * expected.t) << "i = " << i;
+                }
+
+                // The any-hit query may return any hit along the ray, so it is checked against the geometry instead.
+                CpuSceneRayQuery::Hit anyHit;
+                EXPECT_EQ(rayQuery.intersectAny(rays[i], anyHit), found) << "i = " << i;
+                EXPECT_EQ(anyHit.isValid(), found) << "i = " << i;
+                EXPECT_EQ(batchAnyHits[i].instanceID.index, anyHit.instanceID.index) << "i = " << i;
+                EXPECT_EQ(batchAnyHits[i].primitiveIndex, anyHit.primitiveIndex) << "i = " << i;
+                if (anyHit.isValid()) verifyHit(ctx, scene, globalMatrices, rays[i], anyHit, i);
+                hitCount += found ? 1 : 0;
+            }
+            EXPECT_GT(hitCount, 0u);
+        }
+    }
+
+    CPU_TEST(CpuSceneRayQuery_BruteForce)
+    {
+        for (uint32_t width : { 4u, 8u })
+        {
+            for (const auto& options : getTestOptions(width))
+            {
+                TestScene scene = createTestScene(200, 15, 20.f, width);
+                CpuSceneRayQuery::SharedPtr pRayQuery = CpuSceneRayQuery::create(scene.sceneData, options);
+                EXPECT_EQ(pRayQuery->getMeshCount(), 5u);
+                EXPECT_EQ(pRayQuery->getInstanceCount(), options.compact ? 31u : 47u);
+                EXPECT_EQ(pRayQuery->getTriangleCount(), 47ull * 200);
+
+                std::vector<float4x4> globalMatrices = computeGlobalMatrices(scene.sceneData);
+                testAgainstBruteForce(ctx, *pRayQuery, scene, globalMatrices, 1);
+
+                // Animate some of the nodes and refit the top level. The root and the node of the static group are not animated.
+                std::mt19937 rng(width);
+                for (size_t i = 2; i < scene.sceneData.sceneGraph.size(); i += 3)
+                {
+                    scene.sceneData.sceneGraph[i].transform = createRandomTransform(rng, 20.f);
+                }
+                globalMatrices = computeGlobalMatrices(scene.sceneData);
+                pRayQuery->updateTransforms(globalMatrices);
+                testAgainstBruteForce(ctx, *pRayQuery, scene, globalMatrices, 2);
+
+                // Deform the vertex-animated mesh and refit its bottom level.
+                std::vector<float3>& positions = scene.meshPositions[0];
+                for (auto& p : positions) p = float3(p.x * 1.5f, p.y + std::sin(p.x), p.z);
+                std::vector<float3> vertices(positions.rbegin(), positions.rend());
+                pRayQuery->updateMeshPositions(0, vertices.data());
+                testAgainstBruteForce(ctx, *pRayQuery, scene, globalMatrices, 3);
+
+                // Only dynamic meshes can be refit.
+                bool refitFailed = false;
+                try
+                {
+                    pRayQuery->updateMeshPositions(1, vertices.data());
+                }
+                catch (const ArgumentError&)
+                {
+                    refitFailed = true;
+                }
+                EXPECT(refitFailed);
+            }
+        }
+    }
+
+    CPU_TEST(CpuSceneRayQuery_NonIndexed)
+    {
+        // Scenes without any index data must not read from the (empty) index buffer.
+        for (const auto& options : getTestOptions())
+        {
+            TestScene scene = createTestScene(100, 5, 20.f, 7, false);
+            EXPECT(scene.sceneData.meshIndexData.empty());
+            CpuSceneRayQuery::SharedPtr pRayQuery = CpuSceneRayQuery::create(scene.sceneData, options);
+            EXPECT_EQ(pRayQuery->getTriangleCount(), 17ull * 100);
+
+            std::vector<float4x4> globalMatrices = computeGlobalMatrices(scene.sceneData);
+            testAgainstBruteForce(ctx, *pRayQuery, scene, globalMatrices, 4);
+
+            // Deform the vertex-animated mesh. Non-indexed vertices are in triangle order.
+            std::vector<float3>& positions = scene.meshPositions[0];
+            for (auto& p : positions) p = float3(p.x, p.y * 1.5f + std::cos(p.z), p.z);
+            pRayQuery->updateMeshPositions(0, positions.data());
+            testAgainstBruteForce(ctx, *pRayQuery, scene, globalMatrices, 5);
+        }
+    }
+
+    CPU_TEST(CpuSceneRayQuery_CompactLayout)
+    {
+        // Mesh instances that don't follow the mesh group layout are rejected in compact mode.
+        TestScene scene = createTestScene(10, 4, 20.f, 1);
+        CpuSceneRayQuery::Options options;
+        options.compact = true;
+        std::swap(scene.sceneData.meshInstanceData[2], scene.sceneData.meshInstanceData[3]);
+        bool createFailed = false;
+        try
+        {
+            CpuSceneRayQuery::create(scene.sceneData, options);
+        }
+        catch (const ArgumentError&)
+        {
+            createFailed = true;
+        }
+        EXPECT(createFailed);
+
+        options.compact = false;
+        EXPECT_EQ(CpuSceneRayQuery::create(scene.sceneData, options)->getInstanceCount(), 14u);
+    }
+
+    CPU_TEST(CpuSceneRayQuery_CopySceneData)
+    {
+        TestScene scene = createTestScene(100, 5, 20.f, 3);
+        const std::vector<float4x4> globalMatrices = computeGlobalMatrices(scene.sceneData);
+        CpuSceneRayQuery::Options options;
+        options.compact = true;
+        CpuSceneRayQuery::SharedPtr pReferencing = CpuSceneRayQuery::create(scene.sceneData, options);
+        options.copySceneData = true;
+        CpuSceneRayQuery::SharedPtr pCopying = CpuSceneRayQuery::create(scene.sceneData, options);
+
+        // Referencing the scene data only keeps the positions of the dynamic mesh 0, and the transforms of the meshes 3 and 4 in the static group.
+        const uint64_t copiedSize = scene.sceneData.meshStaticData.size() * sizeof(float3) + scene.sceneData.meshIndexData.size() * sizeof(uint32_t);
+        const uint64_t referencedSize = scene.sceneData.meshDesc[0].vertexCount * sizeof(float3) + 2 * sizeof(float4x4);
+        EXPECT_EQ(pCopying->getMemoryUsageInBytes() - pReferencing->getMemoryUsageInBytes(), copiedSize - referencedSize);
+        testAgainstBruteForce(ctx, *pReferencing, scene, globalMatrices, 6);
+
+        // With copied scene data, the vertex and index data can be released.
+        pReferencing = nullptr;
+        scene.sceneData.meshStaticData = {};
+        scene.sceneData.meshIndexData = {};
+        testAgainstBruteForce(ctx, *pCopying, scene, globalMatrices, 6);
+    }
+
+    CPU_TEST(CpuSceneRayQuery_Benchmark, "Disabled for performance reasons")
+    {
+        const uint32_t kRayCount = 1 << 20;
+        TestScene scene = createTestScene(20000, 333, 200.f, 1);
+
+        uint64_t uniqueTriangleCount = 0;
+        for (const auto& mesh : scene.sceneData.meshDesc) uniqueTriangleCount += mesh.getTriangleCount();
+
+        for (uint32_t width : { 4u, 8u })
+        {
+            for (const auto& options : getTestOptions(width))
+            {
+                auto buildStart = CpuTimer::getCurrentTimePoint();
+                CpuSceneRayQuery::SharedPtr pRayQuery = CpuSceneRayQuery::create(scene.sceneData, options);
+                double buildTime = CpuTimer::calcDuration(buildStart, CpuTimer::getCurrentTimePoint());
+
+                const std::vector<CpuSceneRayQuery::Ray> rays = createRandomRays(pRayQuery->getBounds(), kRayCount, 1);
+                std::vector<CpuSceneRayQuery::Hit> hits(kRayCount);
+                std::unique_ptr<bool[]> occluded(new bool[kRayCount]);
+
+                auto measure = [&](auto func)
+                {
+                    auto startTime = CpuTimer::getCurrentTimePoint();
+                    func();
+                    return kRayCount / (1000.0 * CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()));
+                };
+
+                double closestSingle = measure([&] { for (uint32_t i = 0; i < kRayCount; i++) pRayQuery->intersect(rays[i], hits[i]); });
+                double anySingle = measure([&] { for (uint32_t i = 0; i < kRayCount; i++) occluded[i] = pRayQuery->occluded(rays[i]); });
+                double closestBatch = measure([&] { pRayQuery->intersect(rays.data(), hits.data(), kRayCount); });
+                double anyBatch = measure([&] { pRayQuery->occluded(rays.data(), occluded.get(), kRayCount); });
+
+                logInfo("CpuSceneRayQuery: {}{}-wide, {} triangles, build {:.2f} ms, {:.1f} MB ({:.1f} bytes per unique triangle): closest hit {:.2f} Mrays/s (batch {:.2f} Mrays/s), any hit {:.2f} Mrays/s (batch {:.2f} Mrays/s)",
+                    options.compact ? (options.copySceneData ? "compact copied " : "compact ") : "", width, pRayQuery->getTriangleCount(), buildTime, pRayQuery->getMemoryUsageInBytes() / (1024.0 * 1024.0),
+                    (double)pRayQuery->getMemoryUsageInBytes() / uniqueTriangleCount, closestSingle, closestBatch, anySingle, anyBatch);
+            }
+        }
+    }
+}
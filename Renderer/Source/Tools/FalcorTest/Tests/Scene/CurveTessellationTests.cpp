@@ -0,0 +1,472 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Curves/CurveTessellation.h"
+#include "Utils/Math/MathHelpers.h"
+#include "Utils/Timing/CpuTimer.h"
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Copy of the serial implementation that the parallel tessellator must reproduce exactly.
+
+        const float kMeshCompensationScale = 1.207f;
+
+        float4 transformSphere(const glm::mat4& xform, const float4& sphere)
+        {
+            float3 q = sphere.xyz + float3(sphere.w, 0, 0);
+            float4 xp = xform * float4(sphere.xyz, 1.f);
+            float4 xq = xform * float4(q, 1.f);
+            float xr = glm::length(xq.xyz - xp.xyz);
+            return float4(xp.xyz, xr);
+        }
+
+        CurveTessellation::SweptSphereResult referenceConvertToLinearSweptSphere(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const glm::mat4& xform)
+        {
+            CurveTessellation::SweptSphereResult result;
+
+            // Only support linear tube segments now.
+            // TODO: Add quadratic or cubic tube segments if necessary.
+            FALCOR_ASSERT(degree == 1);
+            result.degree = degree;
+
+            uint32_t pointCounts = 0;
+            uint32_t segCounts = 0;
+            uint32_t maxVertexCountsPerStrand = 0;
+            for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+            {
+                uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
+                pointCounts += tmpPointCount;
+                segCounts += tmpPointCount - 1;
+                maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, static_cast<uint32_t>(vertexCountsPerStrand[i]));
+            }
+            result.indices.reserve(segCounts);
+            result.points.reserve(pointCounts);
+            result.radius.reserve(pointCounts);
+            result.texCrds.reserve(pointCounts);
+
+            uint32_t pointOffset = 0;
+
+            std::vector<float3> strandControlPoints;
+            std::vector<float> strandWidths;
+            std::vector<float2> strandUVs;
+
+            strandControlPoints.reserve(maxVertexCountsPerStrand);
+            strandWidths.reserve(maxVertexCountsPerStrand);
+            strandUVs.reserve(maxVertexCountsPerStrand);
+
+            for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+            {
+                strandControlPoints.clear();
+                strandWidths.clear();
+                strandUVs.clear();
+
+                // Optimize geometry by removing duplicates.
+                for (uint32_t j = 0; j < (uint32_t)vertexCountsPerStrand[i] - 1; j++)
+                {
+                    if (controlPoints[pointOffset + j] != controlPoints[pointOffset + j + 1])
+                    {
+                        strandControlPoints.push_back(controlPoints[pointOffset + j]);
+                        strandWidths.push_back(widths[pointOffset + j]);
+                        if (UVs) strandUVs.push_back(UVs[pointOffset + j]);
+                    }
+                }
+
+                // Add the last control point.
+                strandControlPoints.push_back(controlPoints[pointOffset + vertexCountsPerStrand[i] - 1]);
+                strandWidths.push_back(widths[pointOffset + vertexCountsPerStrand[i] - 1]);
+                if (UVs) strandUVs.push_back(UVs[pointOffset + vertexCountsPerStrand[i] - 1]);
+
+                uint32_t optimizedVertexCount = static_cast<uint32_t>(strandControlPoints.size());
+
+                CubicSpline splinePoints(strandControlPoints.data(), optimizedVertexCount);
+                CubicSpline splineWidths(strandWidths.data(), optimizedVertexCount);
+
+                uint32_t tmpCount = 0;
+                for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
+                {
+                    for (uint32_t k = 0; k < subdivPerSegment; k++)
+                    {
+                        if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
+                        {
+                            float t = (float)k / (float)subdivPerSegment;
+                            result.indices.push_back((uint32_t)result.points.size());
+
+                            // Pre-transform curve points.
+                            float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), splineWidths.interpolate(j, t) * 0.5f * widthScale));
+
+                            result.points.push_back(sph.xyz);
+                            result.radius.push_back(sph.w);
+                        }
+                        tmpCount++;
+                    }
+                }
+
+                // Always keep the last vertex.
+                float4 sph = transformSphere(xform, float4(splinePoints.interpolate(optimizedVertexCount - 2, 1.f), splineWidths.interpolate(optimizedVertexCount - 2, 1.f) * 0.5f * widthScale));
+                result.points.push_back(sph.xyz);
+                result.radius.push_back(sph.w);
+
+                // Texture coordinates.
+                if (UVs)
+                {
+                    CubicSpline splineUVs(strandUVs.data(), optimizedVertexCount);
+                    tmpCount = 0;
+                    for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
+                    {
+                        for (uint32_t k = 0; k < subdivPerSegment; k++)
+                        {
+                            if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
+                            {
+                                float t = (float)k / (float)subdivPerSegment;
+                                result.texCrds.push_back(splineUVs.interpolate(j, t));
+                            }
+                            tmpCount++;
+                        }
+                    }
+
+                    // Always keep the last vertex.
+                    result.texCrds.push_back(splineUVs.interpolate(optimizedVertexCount - 2, 1.f));
+                }
+
+                for (uint32_t j = i; j < std::min((uint32_t)strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+            }
+
+            return result;
+        }
+
+        CurveTessellation::MeshResult referenceConvertToMesh(size_t strandCount, const int* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
+        {
+            CurveTessellation::MeshResult result;
+            uint32_t vertexCounts = 0;
+            uint32_t faceCounts = 0;
+            uint32_t maxVertexCountsPerStrand = 0;
+            for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+            {
+                uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
+                vertexCounts += pointCountPerCrossSection * tmpPointCount;
+                faceCounts += 2 * pointCountPerCrossSection * (tmpPointCount - 1);
+                maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, static_cast<uint32_t>(vertexCountsPerStrand[i]));
+            }
+            result.vertices.reserve(vertexCounts);
+            result.normals.reserve(vertexCounts);
+            result.tangents.reserve(vertexCounts);
+            result.texCrds.reserve(vertexCounts);
+            result.radii.reserve(vertexCounts);
+            result.faceVertexCounts.reserve(faceCounts);
+            result.faceVertexIndices.reserve(faceCounts * 3);
+
+            uint32_t pointOffset = 0;
+            uint32_t meshVertexOffset = 0;
+
+            std::vector<float3> strandControlPoints;
+            std::vector<float> strandWidths;
+            std::vector<float2> strandUVs;
+
+            strandControlPoints.reserve(maxVertexCountsPerStrand);
+            strandWidths.reserve(maxVertexCountsPerStrand);
+            strandUVs.reserve(maxVertexCountsPerStrand);
+
+            for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+            {
+                strandControlPoints.clear();
+                strandWidths.clear();
+                strandUVs.clear();
+
+                // Optimize geometry by removing duplicates.
+                for (uint32_t j = 0; j < (uint32_t)vertexCountsPerStrand[i] - 1; j++)
+                {
+                    if (controlPoints[pointOffset + j] != controlPoints[pointOffset + j + 1])
+                    {
+                        strandControlPoints.push_back(controlPoints[pointOffset + j]);
+                        strandWidths.push_back(widths[pointOffset + j]);
+                        if (UVs) strandUVs.push_back(UVs[pointOffset + j]);
+                    }
+                }
+
+                // Add the last control point.
+                strandControlPoints.push_back(controlPoints[pointOffset + vertexCountsPerStrand[i] - 1]);
+                strandWidths.push_back(widths[pointOffset + vertexCountsPerStrand[i] - 1]);
+                if (UVs) strandUVs.push_back(UVs[pointOffset + vertexCountsPerStrand[i] - 1]);
+
+                uint32_t optimizedVertexCount = static_cast<uint32_t>(strandControlPoints.size());
+
+                CubicSpline splinePoints(strandControlPoints.data(), optimizedVertexCount);
+                CubicSpline splineWidths(strandWidths.data(), optimizedVertexCount);
+
+                std::vector<float3> curvePoints;
+                std::vector<float> curveWidths;
+
+                uint32_t tmpCount = 0;
+                for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
+                {
+                    for (uint32_t k = 0; k < subdivPerSegment; k++)
+                    {
+                        if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
+                        {
+                            float t = (float)k / (float)subdivPerSegment;
+                            curvePoints.push_back(splinePoints.interpolate(j, t));
+                            curveWidths.push_back(kMeshCompensationScale * widthScale * splineWidths.interpolate(j, t));
+                        }
+                        tmpCount++;
+                    }
+                }
+
+                // Always keep the last vertex.
+                curvePoints.push_back(splinePoints.interpolate(optimizedVertexCount - 2, 1.f));
+                curveWidths.push_back(kMeshCompensationScale * widthScale * splineWidths.interpolate(optimizedVertexCount - 2, 1.f));
+
+                std::vector<float2> curveUVs;
+
+                // Texture coordinates.
+                if (UVs)
+                {
+                    CubicSpline splineUVs(strandUVs.data(), optimizedVertexCount);
+                    tmpCount = 0;
+                    for (uint32_t j = 0; j < optimizedVertexCount - 1; j++)
+                    {
+                        for (uint32_t k = 0; k < subdivPerSegment; k++)
+                        {
+                            if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
+                            {
+                                float t = (float)k / (float)subdivPerSegment;
+                                curveUVs.push_back(splineUVs.interpolate(j, t));
+                            }
+                            tmpCount++;
+                        }
+                    }
+
+                    // Always keep the last vertex.
+                    curveUVs.push_back(splineUVs.interpolate(optimizedVertexCount - 2, 1.f));
+                }
+
+                for (uint32_t j = i; j < std::min((uint32_t)strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+
+                // Build the initial frame.
+                float3 prevFwd, s, t;
+                prevFwd = normalize(curvePoints[1] - curvePoints[0]);
+                buildFrame(prevFwd, s, t);
+
+                // Create mesh.
+                for (uint32_t j = 0; j < curvePoints.size(); j++)
+                {
+                    float3 fwd;
+
+                    if (j == 0)
+                    {
+                        fwd = prevFwd;
+                    }
+                    else if (j < curvePoints.size() - 1)
+                    {
+                        fwd = normalize(curvePoints[j + 1] - curvePoints[j]);
+                    }
+                    else
+                    {
+                        fwd = normalize(curvePoints[j] - curvePoints[j - 1]);
+                    }
+
+                    // Use quaternions to smoothly rotate the other vectors.
+                    glm::quat rotQuat = glm::rotation(prevFwd, fwd);
+                    s = glm::rotate(rotQuat, s);
+                    t = glm::rotate(rotQuat, t);
+
+                    // Mesh vertices, normals, tangents, and texCrds (if any).
+                    for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
+                    {
+                        float phi = (float)k / (float)pointCountPerCrossSection * (float)M_PI * 2.f;
+                        float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
+
+                        float curveRadius = 0.5f * curveWidths[j];
+                        result.vertices.push_back(curvePoints[j] + curveRadius * vNormal);
+                        result.normals.push_back(vNormal);
+                        result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
+                        result.radii.push_back(curveRadius);
+
+                        if (UVs)
+                        {
+                            result.texCrds.push_back(curveUVs[j]);
+                        }
+                    }
+
+                    // Mesh faces.
+                    if (j < curvePoints.size() - 1)
+                    {
+                        for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
+                        {
+                            result.faceVertexCounts.push_back(3);
+                            result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + k);
+                            result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
+                            result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
+
+                            result.faceVertexCounts.push_back(3);
+                            result.faceVertexIndices.push_back(meshVertexOffset + j * pointCountPerCrossSection + k);
+                            result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + (k + 1) % pointCountPerCrossSection);
+                            result.faceVertexIndices.push_back(meshVertexOffset + (j + 1) * pointCountPerCrossSection + k);
+                        }
+                    }
+
+                    prevFwd = fwd;
+                }
+
+                meshVertexOffset += pointCountPerCrossSection * (uint32_t)curvePoints.size();
+            }
+            return result;
+        }
+
+        struct Groom
+        {
+            std::vector<int> vertexCountsPerStrand;
+            std::vector<float3> controlPoints;
+            std::vector<float> widths;
+            std::vector<float2> UVs;
+        };
+
+        /** Creates a synthetic hair groom with strands growing out of a sphere.
+            Some control points are duplicated to exercise the duplicate removal.
+        */
+        Groom createGroom(uint32_t strandCount, uint32_t minVertexCount, uint32_t maxVertexCount)
+        {
+            std::mt19937 rng;
+            std::uniform_real_distribution<float> uniform;
+            std::uniform_int_distribution<uint32_t> vertexCountDist(minVertexCount, maxVertexCount);
+
+            Groom groom;
+            groom.vertexCountsPerStrand.reserve(strandCount);
+            for (uint32_t i = 0; i < strandCount; i++)
+            {
+                const uint32_t vertexCount = vertexCountDist(rng);
+                groom.vertexCountsPerStrand.push_back((int)vertexCount);
+
+                const float3 root = glm::normalize(float3(uniform(rng), uniform(rng), uniform(rng)) - 0.5f);
+                const float2 uv = float2(uniform(rng), uniform(rng));
+                float3 p = root;
+                for (uint32_t j = 0; j < vertexCount; j++)
+                {
+                    // Duplicate the previous control point once in a while.
+                    if (j == 0 || j == vertexCount - 1 || uniform(rng) > 0.1f)
+                    {
+                        p += 0.05f * (root + 0.5f * (float3(uniform(rng), uniform(rng), uniform(rng)) - 0.5f));
+                    }
+                    groom.controlPoints.push_back(p);
+                    groom.widths.push_back(0.01f * (1.f - 0.5f * (float)j / (float)vertexCount));
+                    groom.UVs.push_back(uv);
+                }
+            }
+            return groom;
+        }
+
+        template<typename T>
+        void expectIdentical(CPUUnitTestContext& ctx, const std::vector<T>& result, const std::vector<T>& reference, const char* name)
+        {
+            EXPECT_EQ(result.size(), reference.size()) << name;
+            if (result.size() == reference.size() && !result.empty())
+            {
+                EXPECT(std::memcmp(result.data(), reference.data(), result.size() * sizeof(T)) == 0) << name;
+            }
+        }
+
+        void testSweptSphere(CPUUnitTestContext& ctx, const Groom& groom, bool useUVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, const glm::mat4& xform)
+        {
+            const float2* pUVs = useUVs ? groom.UVs.data() : nullptr;
+            const size_t strandCount = groom.vertexCountsPerStrand.size();
+
+            auto result = CurveTessellation::convertToLinearSweptSphere(strandCount, groom.vertexCountsPerStrand.data(), groom.controlPoints.data(), groom.widths.data(), pUVs, 1, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 1.f, xform);
+            auto reference = referenceConvertToLinearSweptSphere(strandCount, groom.vertexCountsPerStrand.data(), groom.controlPoints.data(), groom.widths.data(), pUVs, 1, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 1.f, xform);
+
+            EXPECT_EQ(result.degree, reference.degree);
+            expectIdentical(ctx, result.indices, reference.indices, "indices");
+            expectIdentical(ctx, result.points, reference.points, "points");
+            expectIdentical(ctx, result.radius, reference.radius, "radius");
+            expectIdentical(ctx, result.texCrds, reference.texCrds, "texCrds");
+        }
+
+        void testMesh(CPUUnitTestContext& ctx, const Groom& groom, bool useUVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, uint32_t pointCountPerCrossSection)
+        {
+            const float2* pUVs = useUVs ? groom.UVs.data() : nullptr;
+            const size_t strandCount = groom.vertexCountsPerStrand.size();
+
+            auto result = CurveTessellation::convertToMesh(strandCount, groom.vertexCountsPerStrand.data(), groom.controlPoints.data(), groom.widths.data(), pUVs, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 1.f, pointCountPerCrossSection);
+            auto reference = referenceConvertToMesh(strandCount, groom.vertexCountsPerStrand.data(), groom.controlPoints.data(), groom.widths.data(), pUVs, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 1.f, pointCountPerCrossSection);
+
+            expectIdentical(ctx, result.vertices, reference.vertices, "vertices");
+            expectIdentical(ctx, result.normals, reference.normals, "normals");
+            expectIdentical(ctx, result.tangents, reference.tangents, "tangents");
+            expectIdentical(ctx, result.texCrds, reference.texCrds, "texCrds");
+            expectIdentical(ctx, result.radii, reference.radii, "radii");
+            expectIdentical(ctx, result.faceVertexCounts, reference.faceVertexCounts, "faceVertexCounts");
+            expectIdentical(ctx, result.faceVertexIndices, reference.faceVertexIndices, "faceVertexIndices");
+        }
+    }
+
+    CPU_TEST(CurveTessellation_SweptSphere)
+    {
+        const Groom groom = createGroom(1000, 2, 32);
+        const glm::mat4 xform = glm::scale(glm::translate(glm::identity<glm::mat4>(), float3(1.f, -2.f, 3.f)), float3(2.5f));
+
+        testSweptSphere(ctx, groom, false, 1, 1, 1, glm::identity<glm::mat4>());
+        testSweptSphere(ctx, groom, true, 4, 1, 1, glm::identity<glm::mat4>());
+        testSweptSphere(ctx, groom, true, 3, 3, 2, xform);
+        testSweptSphere(ctx, groom, false, 5, 7, 4, xform);
+    }
+
+    CPU_TEST(CurveTessellation_Mesh)
+    {
+        const Groom groom = createGroom(1000, 2, 32);
+
+        testMesh(ctx, groom, false, 1, 1, 1, 4);
+        testMesh(ctx, groom, true, 4, 1, 1, 4);
+        testMesh(ctx, groom, true, 3, 3, 2, 6);
+        testMesh(ctx, groom, false, 5, 7, 4, 3);
+    }
+
+    CPU_TEST(CurveTessellation_Benchmark, "Disabled for performance reasons")
+    {
+        const Groom groom = createGroom(200000, 8, 64);
+        const size_t strandCount = groom.vertexCountsPerStrand.size();
+        const glm::mat4 xform = glm::identity<glm::mat4>();
+
+        auto measure = [](auto func)
+        {
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            func();
+            return CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        };
+
+        double referenceTime = measure([&]() { referenceConvertToLinearSweptSphere(strandCount, groom.vertexCountsPerStrand.data(), groom.controlPoints.data(), groom.widths.data(), groom.UVs.data(), 1, 4, 1, 1, 1.f, xform); });
+        double time = measure([&]() { CurveTessellation::convertToLinearSweptSphere(strandCount, groom.vertexCountsPerStrand.data(), groom.controlPoints.data(), groom.widths.data(), groom.UVs.data(), 1, 4, 1, 1, 1.f, xform); });
+        logInfo("convertToLinearSweptSphere: {} strands, serial {:.1f} ms, parallel {:.1f} ms ({:.2f}x)", strandCount, referenceTime, time, referenceTime / time);
+
+        referenceTime = measure([&]() { referenceConvertToMesh(strandCount, groom.vertexCountsPerStrand.data(), groom.controlPoints.data(), groom.widths.data(), groom.UVs.data(), 4, 1, 1, 1.f, 4); });
+        time = measure([&]() { CurveTessellation::convertToMesh(strandCount, groom.vertexCountsPerStrand.data(), groom.controlPoints.data(), groom.widths.data(), groom.UVs.data(), 4, 1, 1, 1.f, 4); });
+        logInfo("convertToMesh: {} strands, serial {:.1f} ms, parallel {:.1f} ms ({:.2f}x)", strandCount, referenceTime, time, referenceTime / time);
+    }
+}
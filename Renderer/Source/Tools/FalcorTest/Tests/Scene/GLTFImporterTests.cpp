@@ -0,0 +1,275 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/GLTFImporter.h"
+#include "Scene/Importers/AssimpImporter.h"
+#include "Utils/StringUtils.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Write a GLB file containing a single mesh with a grid of quads in the xz-plane.
+        */
+        void writeGridGlb(const std::filesystem::path& path, uint32_t gridSize, bool shortIndices)
+        {
+            const uint32_t vertexCount = (gridSize + 1) * (gridSize + 1);
+            const uint32_t indexCount = gridSize * gridSize * 6;
+
+            std::vector<float3> positions;
+            std::vector<float3> normals;
+            std::vector<float2> texCrds;
+            for (uint32_t y = 0; y <= gridSize; y++)
+            {
+                for (uint32_t x = 0; x <= gridSize; x++)
+                {
+                    float2 uv = float2(x, y) / float(gridSize);
+                    positions.push_back(float3(uv.x * 2.f - 1.f, 0.f, uv.y * 2.f - 1.f));
+                    normals.push_back(float3(0.f, 1.f, 0.f));
+                    texCrds.push_back(uv);
+                }
+            }
+
+            std::vector<uint32_t> indices;
+            for (uint32_t y = 0; y < gridSize; y++)
+            {
+                for (uint32_t x = 0; x < gridSize; x++)
+                {
+                    uint32_t i = y * (gridSize + 1) + x;
+                    uint32_t quad[6] = { i, i + gridSize + 1, i + 1, i + 1, i + gridSize + 1, i + gridSize + 2 };
+                    indices.insert(indices.end(), quad, quad + 6);
+                }
+            }
+
+            std::vector<uint8_t> bin;
+            auto append = [&bin](const void* pData, size_t size)
+            {
+                size_t offset = bin.size();
+                bin.insert(bin.end(), (const uint8_t*)pData, (const uint8_t*)pData + size);
+                bin.resize((bin.size() + 3) & ~size_t(3), 0);
+                return offset;
+            };
+
+            size_t positionOffset = append(positions.data(), positions.size() * sizeof(float3));
+            size_t normalOffset = append(normals.data(), normals.size() * sizeof(float3));
+            size_t texCrdOffset = append(texCrds.data(), texCrds.size() * sizeof(float2));
+            size_t indexOffset;
+            if (shortIndices)
+            {
+                std::vector<uint16_t> shortIndexData(indices.begin(), indices.end());
+                indexOffset = append(shortIndexData.data(), shortIndexData.size() * sizeof(uint16_t));
+            }
+            else
+            {
+                indexOffset = append(indices.data(), indices.size() * sizeof(uint32_t));
+            }
+            const size_t indexSize = indexCount * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+
+            std::string json = fmt::format(
+                R"({{"asset":{{"version":"2.0"}},"scene":0,"scenes":[{{"nodes":[0]}}],"nodes":[{{"mesh":0}}],)"
+                R"("meshes":[{{"primitives":[{{"attributes":{{"POSITION":0,"NORMAL":1,"TEXCOORD_0":2}},"indices":3}}]}}],)"
+                R"("buffers":[{{"byteLength":{}}}],"bufferViews":[)"
+                R"({{"buffer":0,"byteOffset":{},"byteLength":{}}},{{"buffer":0,"byteOffset":{},"byteLength":{}}},)"
+                R"({{"buffer":0,"byteOffset":{},"byteLength":{}}},{{"buffer":0,"byteOffset":{},"byteLength":{}}}],"accessors":[)"
+                R"({{"bufferView":0,"componentType":5126,"count":{},"type":"VEC3","min":[-1,0,-1],"max":[1,0,1]}},)"
+                R"({{"bufferView":1,"componentType":5126,"count":{},"type":"VEC3"}},)"
+                R"({{"bufferView":2,"componentType":5126,"count":{},"type":"VEC2"}},)"
+                R"({{"bufferView":3,"componentType":{},"count":{},"type":"SCALAR"}}]}})",
+                bin.size(),
+                positionOffset, positions.size() * sizeof(float3),
+                normalOffset, normals.size() * sizeof(float3),
+                texCrdOffset, texCrds.size() * sizeof(float2),
+                indexOffset, indexSize,
+                vertexCount, vertexCount, vertexCount,
+                shortIndices ? 5123 : 5125, indexCount);
+            json.resize((json.size() + 3) & ~size_t(3), ' ');
+
+            auto writeUint = [](std::ofstream& file, uint32_t value) { file.write((const char*)&value, sizeof(value)); };
+
+            std::ofstream file(path, std::ios::binary);
+            writeUint(file, 0x46546C67);
+            writeUint(file, 2);
+            writeUint(file, uint32_t(12 + 8 + json.size() + 8 + bin.size()));
+            writeUint(file, (uint32_t)json.size());
+            writeUint(file, 0x4E4F534A);
+            file.write(json.data(), json.size());
+            writeUint(file, (uint32_t)bin.size());
+            writeUint(file, 0x004E4942);
+            file.write((const char*)bin.data(), bin.size());
+        }
+
+        struct TriangleGltfDesc
+        {
+            uint32_t normalCount = 3;                       ///< Count of the NORMAL accessor.
+            uint32_t indexComponentType = 5125;             ///< Component type of the index accessor.
+            std::vector<uint32_t> indices = { 0, 1, 2 };    ///< Index values, stored with 4 bytes each.
+            std::string bufferUri;                          ///< Buffer URI, or empty to embed the data as base64.
+        };
+
+        /** Write a glTF file with a single triangle. The description allows to make the file malformed.
+        */
+        void writeTriangleGltf(const std::filesystem::path& path, const TriangleGltfDesc& desc)
+        {
+            const float3 positions[3] = { float3(0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f) };
+            const float3 normals[3] = { float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 1.f) };
+
+            std::vector<uint8_t> bin;
+            bin.insert(bin.end(), (const uint8_t*)positions, (const uint8_t*)positions + sizeof(positions));
+            bin.insert(bin.end(), (const uint8_t*)normals, (const uint8_t*)normals + sizeof(normals));
+            bin.insert(bin.end(), (const uint8_t*)desc.indices.data(), (const uint8_t*)desc.indices.data() + desc.indices.size() * sizeof(uint32_t));
+
+            std::string uri = desc.bufferUri.empty() ? "data:application/octet-stream;base64," + encodeBase64(bin) : desc.bufferUri;
+
+            std::string json = fmt::format(
+                R"({{"asset":{{"version":"2.0"}},"scene":0,"scenes":[{{"nodes":[0]}}],"nodes":[{{"mesh":0}}],)"
+                R"("meshes":[{{"primitives":[{{"attributes":{{"POSITION":0,"NORMAL":1}},"indices":2}}]}}],)"
+                R"("buffers":[{{"uri":"{}","byteLength":{}}}],"bufferViews":[)"
+                R"({{"buffer":0,"byteOffset":0,"byteLength":36}},{{"buffer":0,"byteOffset":36,"byteLength":36}},)"
+                R"({{"buffer":0,"byteOffset":72,"byteLength":{}}}],"accessors":[)"
+                R"({{"bufferView":0,"componentType":5126,"count":3,"type":"VEC3","min":[0,0,0],"max":[1,1,0]}},)"
+                R"({{"bufferView":1,"componentType":5126,"count":{},"type":"VEC3"}},)"
+                R"({{"bufferView":2,"componentType":{},"count":{},"type":"SCALAR"}}]}})",
+                uri, bin.size(), desc.indices.size() * sizeof(uint32_t), desc.normalCount, desc.indexComponentType, desc.indices.size());
+
+            std::ofstream file(path, std::ios::binary);
+            file.write(json.data(), json.size());
+        }
+
+        uint64_t getTriangleCount(const Scene::SharedPtr& pScene)
+        {
+            uint64_t triangleCount = 0;
+            for (uint32_t i = 0; i < pScene->getMeshCount(); i++) triangleCount += pScene->getMesh(i).getTriangleCount();
+            return triangleCount;
+        }
+    }
+
+    GPU_TEST(GLTFImporter_MatchesAssimp)
+    {
+        std::filesystem::path path = getTempFilePath();
+        path.replace_extension(".glb");
+        writeGridGlb(path, 16, true);
+
+        auto pGltfBuilder = SceneBuilder::create();
+        GLTFImporter::import(path, *pGltfBuilder, {}, Dictionary());
+        auto pGltfScene = pGltfBuilder->getScene();
+
+        auto pAssimpBuilder = SceneBuilder::create();
+        AssimpImporter::import(path, *pAssimpBuilder, {}, Dictionary());
+        auto pAssimpScene = pAssimpBuilder->getScene();
+
+        std::filesystem::remove(path);
+
+        EXPECT(pGltfScene != nullptr);
+        EXPECT(pAssimpScene != nullptr);
+        if (!pGltfScene || !pAssimpScene) return;
+
+        EXPECT_EQ(pGltfScene->getMeshCount(), 1u);
+        EXPECT_EQ(getTriangleCount(pGltfScene), 16ull * 16ull * 2ull);
+        EXPECT_EQ(getTriangleCount(pGltfScene), getTriangleCount(pAssimpScene));
+
+        const AABB& gltfBounds = pGltfScene->getSceneBounds();
+        const AABB& assimpBounds = pAssimpScene->getSceneBounds();
+        for (int i = 0; i < 3; i++)
+        {
+            EXPECT_EQ(gltfBounds.minPoint[i], assimpBounds.minPoint[i]);
+            EXPECT_EQ(gltfBounds.maxPoint[i], assimpBounds.maxPoint[i]);
+        }
+    }
+
+    GPU_TEST(GLTFImporter_MalformedFiles)
+    {
+        std::filesystem::path path = getTempFilePath();
+        path.replace_extension(".gltf");
+
+        auto importFails = [&](const TriangleGltfDesc& desc)
+        {
+            writeTriangleGltf(path, desc);
+            bool caught = false;
+            try
+            {
+                auto pBuilder = SceneBuilder::create();
+                GLTFImporter::import(path, *pBuilder, {}, Dictionary());
+            }
+            catch (const ImporterError&)
+            {
+                caught = true;
+            }
+            std::filesystem::remove(path);
+            return caught;
+        };
+
+        EXPECT(!importFails({}));
+
+        TriangleGltfDesc desc;
+        desc.normalCount = 2;
+        EXPECT(importFails(desc)) << "attribute count mismatch";
+
+        desc = {};
+        desc.indices = { 0, 1, 3 };
+        EXPECT(importFails(desc)) << "index out of range";
+
+        desc = {};
+        desc.indexComponentType = 5126;
+        EXPECT(importFails(desc)) << "float indices";
+
+        desc = {};
+        desc.indexComponentType = 1234;
+        EXPECT(importFails(desc)) << "unknown component type";
+
+        for (const char* uri : { "data:application/octet-stream;base64,@@@@", "data:application/octet-stream;base64,\xC3\xA9" "AA", "data:application/octet-stream;base64,AAA",
+            "buffer%zz.bin", "buffer%4" })
+        {
+            desc = {};
+            desc.bufferUri = uri;
+            EXPECT(importFails(desc)) << "buffer URI " << uri;
+        }
+    }
+
+    GPU_TEST(GLTFImporter_Benchmark, "Disabled for performance reasons")
+    {
+        std::filesystem::path path = getTempFilePath();
+        path.replace_extension(".glb");
+        writeGridGlb(path, 1024, false);
+
+        auto measure = [&](auto importFunc)
+        {
+            auto pBuilder = SceneBuilder::create();
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            importFunc(path, *pBuilder, SceneBuilder::InstanceMatrices(), Dictionary());
+            return CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        };
+
+        double gltfTime = measure(GLTFImporter::import);
+        double assimpTime = measure(AssimpImporter::import);
+        std::filesystem::remove(path);
+
+        logInfo("GLTFImporter: {:.1f} ms, AssimpImporter: {:.1f} ms ({:.2f}x)", gltfTime, assimpTime, assimpTime / gltfTime);
+        EXPECT_LT(gltfTime, assimpTime);
+    }
+}
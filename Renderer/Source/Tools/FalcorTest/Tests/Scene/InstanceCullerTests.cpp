@@ -0,0 +1,197 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Culling/InstanceCuller.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        glm::mat4 createViewProj()
+        {
+            glm::mat4 view = glm::lookAt(float3(0.f), float3(0.f, 0.f, -1.f), float3(0.f, 1.f, 0.f));
+            glm::mat4 proj = glm::perspective(glm::radians(60.f), 2.f, 0.1f, 100.f);
+            return proj * view;
+        }
+
+        /** Scalar reference of the frustum test, one box and plane at a time (see Camera::isObjectCulled()).
+        */
+        bool referenceIsVisible(const glm::mat4& viewProj, const AABB& box)
+        {
+            if (!box.valid()) return true;
+
+            glm::mat4 tempMat = glm::transpose(viewProj);
+            for (int i = 0; i < 6; i++)
+            {
+                float4 plane = (i & 1) ? tempMat[i >> 1] : -tempMat[i >> 1];
+                if (i != 5) plane += tempMat[3];
+                float3 p = glm::mix(box.minPoint, box.maxPoint, glm::greaterThanEqual(float3(plane), float3(0.f)));
+                if (p.x * plane.x + p.y * plane.y + p.z * plane.z + plane.w <= 0.f) return false;
+            }
+            return true;
+        }
+
+        std::vector<AABB> createRandomBoxes(uint32_t count, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> posDist(-50.f, 50.f);
+            std::uniform_real_distribution<float> sizeDist(0.f, 4.f);
+
+            std::vector<AABB> boxes(count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                // Leave some boxes invalid, these are never culled.
+                if (i % 97 == 0) continue;
+                float3 p = float3(posDist(rng), posDist(rng), posDist(rng));
+                boxes[i] = AABB(p, p + float3(sizeDist(rng), sizeDist(rng), sizeDist(rng)));
+            }
+            return boxes;
+        }
+    }
+
+    CPU_TEST(InstanceCuller_Frustum)
+    {
+        const glm::mat4 viewProj = createViewProj();
+
+        // Use a count that is not a multiple of the block size.
+        const std::vector<AABB> boxes = createRandomBoxes(10003, 1);
+        InstanceCuller culler;
+        culler.setBounds(boxes);
+        EXPECT_EQ(culler.getBoundsCount(), boxes.size());
+
+        std::vector<uint8_t> visible;
+        uint32_t visibleCount = culler.cull(viewProj, visible);
+        EXPECT_EQ(visible.size(), boxes.size());
+
+        uint32_t referenceCount = 0;
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            bool referenceVisible = referenceIsVisible(viewProj, boxes[i]);
+            EXPECT_EQ(visible[i] != 0, referenceVisible) << "i = " << i;
+            referenceCount += referenceVisible ? 1 : 0;
+        }
+        EXPECT_EQ(visibleCount, referenceCount);
+        EXPECT_GT(visibleCount, 0u);
+        EXPECT_LT(visibleCount, (uint32_t)boxes.size());
+
+        culler.setBounds({});
+        EXPECT_EQ(culler.cull(viewProj, visible), 0u);
+        EXPECT(visible.empty());
+    }
+
+    CPU_TEST(InstanceCuller_Occlusion)
+    {
+        const glm::mat4 viewProj = createViewProj();
+
+        // Wall covering the whole view at z = -5.
+        const std::vector<float3> positions = { float3(-20.f, -20.f, -5.f), float3(20.f, -20.f, -5.f), float3(20.f, 20.f, -5.f), float3(-20.f, 20.f, -5.f) };
+        const std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
+
+        OcclusionBuffer occlusionBuffer(64, 32);
+        occlusionBuffer.reset(viewProj);
+
+        const AABB behind(float3(-1.f, -1.f, -12.f), float3(1.f, 1.f, -10.f));
+        const AABB inFront(float3(-1.f, -1.f, -3.f), float3(1.f, 1.f, -2.f));
+        const AABB intersecting(float3(-1.f, -1.f, -6.f), float3(1.f, 1.f, -4.f));
+        const AABB crossingNearPlane(float3(-1.f, -1.f, -12.f), float3(1.f, 1.f, 1.f));
+
+        // Nothing is occluded by an empty buffer.
+        EXPECT(!occlusionBuffer.isOccluded(behind));
+
+        occlusionBuffer.rasterizeTriangles(positions.data(), indices.data(), 2, glm::mat4(1.f));
+        EXPECT(occlusionBuffer.isOccluded(behind));
+        EXPECT(!occlusionBuffer.isOccluded(inFront));
+        EXPECT(!occlusionBuffer.isOccluded(intersecting));
+        EXPECT(!occlusionBuffer.isOccluded(crossingNearPlane));
+        EXPECT(!occlusionBuffer.isOccluded(AABB()));
+
+        // A half-width wall only occludes boxes behind its half of the screen.
+        const std::vector<float3> halfPositions = { float3(-20.f, -20.f, -5.f), float3(0.f, -20.f, -5.f), float3(0.f, 20.f, -5.f), float3(-20.f, 20.f, -5.f) };
+        occlusionBuffer.reset(viewProj);
+        occlusionBuffer.rasterizeTriangles(halfPositions.data(), indices.data(), 2, glm::mat4(1.f));
+        EXPECT(occlusionBuffer.isOccluded(AABB(float3(-4.f, -1.f, -12.f), float3(-2.f, 1.f, -10.f))));
+        EXPECT(!occlusionBuffer.isOccluded(AABB(float3(2.f, -1.f, -12.f), float3(4.f, 1.f, -10.f))));
+        EXPECT(!occlusionBuffer.isOccluded(AABB(float3(-1.f, -1.f, -12.f), float3(1.f, 1.f, -10.f))));
+
+        // The culler only tests boxes inside the frustum against the occlusion buffer. Invalid boxes are never culled.
+        occlusionBuffer.reset(viewProj);
+        occlusionBuffer.rasterizeTriangles(positions.data(), nullptr, 1, glm::mat4(1.f));
+        occlusionBuffer.rasterizeTriangles(positions.data(), indices.data(), 2, glm::mat4(1.f));
+        InstanceCuller culler;
+        culler.setBounds({ behind, inFront, AABB(), AABB(float3(-1.f, -1.f, 10.f), float3(1.f, 1.f, 12.f)) });
+        std::vector<uint8_t> visible;
+        EXPECT_EQ(culler.cull(viewProj, visible, &occlusionBuffer), 2u);
+        EXPECT_EQ(visible[0], 0);
+        EXPECT_EQ(visible[1], 1);
+        EXPECT_EQ(visible[2], 1);
+        EXPECT_EQ(visible[3], 0);
+    }
+
+    CPU_TEST(InstanceCuller_CompactDrawArgs)
+    {
+        struct Args
+        {
+            uint32_t a, b, c;
+        };
+
+        const std::vector<Args> args = { { 0, 1, 2 }, { 3, 4, 5 }, { 6, 7, 8 }, { 9, 10, 11 } };
+        const std::vector<uint32_t> instanceIDs = { 3, 0, 2, 1 };
+        const std::vector<uint8_t> visible = { 1, 0, 0, 1 };
+
+        std::vector<Args> culledArgs(args.size());
+        uint32_t count = InstanceCuller::compactDrawArgs(args.data(), sizeof(Args), instanceIDs.data(), (uint32_t)args.size(), visible.data(), culledArgs.data());
+        EXPECT_EQ(count, 2u);
+        EXPECT_EQ(culledArgs[0].a, 0u);
+        EXPECT_EQ(culledArgs[1].a, 3u);
+        EXPECT_EQ(culledArgs[1].c, 5u);
+    }
+
+    CPU_TEST(InstanceCuller_Benchmark, "Disabled for performance reasons")
+    {
+        const glm::mat4 viewProj = createViewProj();
+        const std::vector<AABB> boxes = createRandomBoxes(1 << 20, 2);
+
+        InstanceCuller culler;
+        culler.setBounds(boxes);
+        std::vector<uint8_t> visible;
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        uint32_t visibleCount = culler.cull(viewProj, visible);
+        double time = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        startTime = CpuTimer::getCurrentTimePoint();
+        uint32_t referenceCount = 0;
+        for (const auto& box : boxes) referenceCount += referenceIsVisible(viewProj, box) ? 1 : 0;
+        double referenceTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        EXPECT_EQ(visibleCount, referenceCount);
+        logInfo("InstanceCuller: {} boxes, scalar {:.1f} ms, culler {:.1f} ms ({:.2f}x)", boxes.size(), referenceTime, time, referenceTime / time);
+    }
+}
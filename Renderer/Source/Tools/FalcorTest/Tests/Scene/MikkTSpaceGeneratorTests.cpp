@@ -0,0 +1,215 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MikkTSpaceGenerator.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct TestMesh
+        {
+            std::vector<float3> positions;
+            std::vector<float3> normals;
+            std::vector<float2> texCrds;
+
+            MikkTSpaceGenerator::MeshData getMeshData() const
+            {
+                MikkTSpaceGenerator::MeshData data;
+                data.faceCount = (uint32_t)positions.size() / 3;
+                data.pPositions = positions.data();
+                data.pNormals = normals.data();
+                data.pTexCrds = texCrds.data();
+                return data;
+            }
+        };
+
+        struct TestMeshDesc
+        {
+            uint32_t gridSize = 16;             ///< Number of quads along each side of the grid.
+            bool mirrorUVs = false;             ///< Mirror the texture coordinates on half of the grid.
+            float seamFraction = 0.f;           ///< Fraction of the quads with their own texture coordinates (UV seams).
+            float degenerateFraction = 0.f;     ///< Fraction of the triangles that are collapsed to a line.
+            float zeroUVFraction = 0.f;         ///< Fraction of the triangles with zero texture space area.
+            uint32_t extraTriangles = 0;        ///< Number of triangles added at existing edges, making them non-manifold.
+        };
+
+        /** Create a heightfield grid with indexed vertices, expanded to face-varying attributes in random face order.
+        */
+        TestMesh createTestMesh(const TestMeshDesc& desc, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+            const uint32_t n = desc.gridSize;
+            auto vertexIndex = [n](uint32_t x, uint32_t y) { return y * (n + 1) + x; };
+
+            std::vector<float3> positions((n + 1) * (n + 1));
+            std::vector<float2> texCrds(positions.size());
+            for (uint32_t y = 0; y <= n; y++)
+            {
+                for (uint32_t x = 0; x <= n; x++)
+                {
+                    float u = (float)x / n;
+                    float v = (float)y / n;
+                    positions[vertexIndex(x, y)] = float3(u, 0.1f * std::sin(7.f * u) * std::cos(5.f * v) + 0.01f * dist(rng), v);
+                    texCrds[vertexIndex(x, y)] = float2(desc.mirrorUVs && x > n / 2 ? 1.f - u : u, v);
+                }
+            }
+
+            std::vector<uint32_t> indices;
+            for (uint32_t y = 0; y < n; y++)
+            {
+                for (uint32_t x = 0; x < n; x++)
+                {
+                    uint32_t i00 = vertexIndex(x, y), i10 = vertexIndex(x + 1, y), i01 = vertexIndex(x, y + 1), i11 = vertexIndex(x + 1, y + 1);
+                    if (dist(rng) < desc.seamFraction)
+                    {
+                        // Duplicate the vertices with offset texture coordinates.
+                        uint32_t base = (uint32_t)positions.size();
+                        float2 offset(dist(rng), dist(rng));
+                        for (uint32_t i : { i00, i10, i01, i11 })
+                        {
+                            positions.push_back(positions[i]);
+                            texCrds.push_back(float2(texCrds[i].x + offset.x, texCrds[i].y + offset.y));
+                        }
+                        i00 = base; i10 = base + 1; i01 = base + 2; i11 = base + 3;
+                    }
+                    indices.insert(indices.end(), { i00, i10, i11, i00, i11, i01 });
+                }
+            }
+            for (uint32_t i = 0; i < desc.extraTriangles; i++)
+            {
+                uint32_t f = (uint32_t)(dist(rng) * (indices.size() / 3 - 1));
+                uint32_t apex = (uint32_t)positions.size();
+                positions.push_back(positions[indices[3 * f]] + float3(0.f, 0.2f + dist(rng), 0.f));
+                texCrds.push_back(float2(dist(rng), dist(rng)));
+                indices.insert(indices.end(), { indices[3 * f + 1], indices[3 * f], apex });
+            }
+
+            // Smooth vertex normals.
+            std::vector<float3> normals(positions.size(), float3(0.f));
+            for (size_t f = 0; f < indices.size() / 3; f++)
+            {
+                const float3& p0 = positions[indices[3 * f]];
+                float3 faceNormal = glm::cross(positions[indices[3 * f + 1]] - p0, positions[indices[3 * f + 2]] - p0);
+                for (uint32_t i = 0; i < 3; i++) normals[indices[3 * f + i]] = normals[indices[3 * f + i]] + faceNormal;
+            }
+            for (auto& normal : normals) normal = glm::normalize(normal);
+
+            for (size_t f = 0; f < indices.size() / 3; f++)
+            {
+                if (dist(rng) < desc.degenerateFraction) indices[3 * f + 1] = indices[3 * f];
+            }
+
+            std::vector<uint32_t> faces(indices.size() / 3);
+            for (uint32_t f = 0; f < (uint32_t)faces.size(); f++) faces[f] = f;
+            std::shuffle(faces.begin(), faces.end(), rng);
+
+            TestMesh mesh;
+            for (uint32_t f : faces)
+            {
+                const bool zeroUV = dist(rng) < desc.zeroUVFraction;
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    uint32_t index = indices[3 * f + i];
+                    mesh.positions.push_back(positions[index]);
+                    mesh.normals.push_back(normals[index]);
+                    mesh.texCrds.push_back(zeroUV ? texCrds[indices[3 * f]] : texCrds[index]);
+                }
+            }
+            return mesh;
+        }
+
+        uint32_t countMismatches(const std::vector<float4>& a, const std::vector<float4>& b)
+        {
+            FALCOR_ASSERT(a.size() == b.size());
+            uint32_t count = 0;
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                if (std::memcmp(&a[i], &b[i], sizeof(float4)) != 0) count++;
+            }
+            return count;
+        }
+    }
+
+    CPU_TEST(MikkTSpaceGenerator_MatchesReference)
+    {
+        std::vector<TestMeshDesc> descs(7);
+        descs[1].mirrorUVs = true;
+        descs[2].seamFraction = 0.2f;
+        descs[3].degenerateFraction = 0.05f;
+        descs[4].zeroUVFraction = 0.05f;
+        descs[5].extraTriangles = 20;
+        descs[6] = { 300, true, 0.05f, 0.01f, 0.01f, 100 };
+
+        for (size_t i = 0; i < descs.size(); i++)
+        {
+            TestMesh mesh = createTestMesh(descs[i], (uint32_t)i);
+            auto data = mesh.getMeshData();
+
+            std::vector<float4> reference(mesh.positions.size());
+            std::vector<float4> tangents(mesh.positions.size());
+            EXPECT(MikkTSpaceGenerator::generateTangentsReference(data, reference.data()));
+            EXPECT(MikkTSpaceGenerator::generateTangents(data, tangents.data()));
+
+            // The results must be bit-identical.
+            EXPECT_EQ(countMismatches(reference, tangents), 0) << "mesh " << i;
+        }
+    }
+
+    CPU_TEST(MikkTSpaceGenerator_Benchmark, "Disabled for performance reasons")
+    {
+        for (uint32_t gridSize : { 256, 1024 })
+        {
+            TestMeshDesc desc;
+            desc.gridSize = gridSize;
+            desc.mirrorUVs = true;
+            desc.seamFraction = 0.01f;
+            TestMesh mesh = createTestMesh(desc, gridSize);
+            auto data = mesh.getMeshData();
+
+            std::vector<float4> reference(mesh.positions.size());
+            std::vector<float4> tangents(mesh.positions.size());
+
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            MikkTSpaceGenerator::generateTangentsReference(data, reference.data());
+            auto t1 = CpuTimer::getCurrentTimePoint();
+            MikkTSpaceGenerator::generateTangents(data, tangents.data());
+            auto t2 = CpuTimer::getCurrentTimePoint();
+
+            double referenceTime = CpuTimer::calcDuration(t0, t1);
+            double parallelTime = CpuTimer::calcDuration(t1, t2);
+            logInfo("MikkTSpace {} triangles: reference {:.1f} ms, parallel {:.1f} ms ({:.2f}x)", data.faceCount, referenceTime, parallelTime, referenceTime / parallelTime);
+            EXPECT_EQ(countMismatches(reference, tangents), 0);
+        }
+    }
+}
@@ -0,0 +1,176 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDF3DPrimitiveEvaluator.h"
+#include "Scene/SDFs/SDF3DPrimitiveFactory.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Creates random primitives of all shape and operation types inside the SDF grid.
+        */
+        std::vector<SDF3DPrimitive> createPrimitives(uint32_t primitiveCount, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> uniform;
+            auto randomFloat3 = [&]() { return float3(uniform(rng), uniform(rng), uniform(rng)); };
+
+            std::vector<SDF3DPrimitive> primitives;
+            for (uint32_t i = 0; i < primitiveCount; i++)
+            {
+                const SDF3DShapeType shapeType = SDF3DShapeType(i % (uint32_t)SDF3DShapeType::Count);
+                const SDFOperationType operationType = i == 0 ? SDFOperationType::Union : SDFOperationType(rng() % (uint32_t)SDFOperationType::Count);
+
+                float3 shapeData = 0.02f + 0.08f * randomFloat3();
+                if (shapeType == SDF3DShapeType::Cone) shapeData.x = 0.2f + uniform(rng);
+
+                Transform transform;
+                transform.setTranslation(0.8f * randomFloat3() - 0.4f);
+                transform.setRotationEuler(glm::two_pi<float>() * randomFloat3());
+                transform.setScaling(float3(0.5f + uniform(rng)));
+
+                const float blobbing = (shapeType == SDF3DShapeType::Torus || shapeType == SDF3DShapeType::Capsule) ? 0.02f : 0.01f * uniform(rng);
+                primitives.push_back(SDF3DPrimitiveFactory::initCommon(shapeType, shapeData, blobbing, 0.05f * uniform(rng), operationType, transform));
+            }
+            return primitives;
+        }
+
+        /** Evaluates all primitives at every grid value.
+        */
+        std::vector<float> evalReference(const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth)
+        {
+            const uint32_t gridWidthInValues = gridWidth + 1;
+            std::vector<float> values;
+            for (uint32_t z = 0; z < gridWidthInValues; z++)
+            {
+                for (uint32_t y = 0; y < gridWidthInValues; y++)
+                {
+                    for (uint32_t x = 0; x < gridWidthInValues; x++)
+                    {
+                        const float3 p = -0.5f + float3(x, y, z) / (float)gridWidth;
+                        values.push_back(SDF3DPrimitiveEvaluator::eval(primitives, p));
+                    }
+                }
+            }
+            return values;
+        }
+
+        void testGrid(CPUUnitTestContext& ctx, const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth, const SDF3DPrimitiveEvaluator::Options& options)
+        {
+            const std::vector<float> reference = evalReference(primitives, gridWidth);
+
+            SDF3DPrimitiveEvaluator::Stats stats;
+            const std::vector<float> values = SDF3DPrimitiveEvaluator::evalGrid(primitives, gridWidth, options, &stats);
+            EXPECT_EQ(values.size(), reference.size());
+            EXPECT_EQ(stats.evaluatedValueCount + stats.clampedValueCount, (uint64_t)reference.size());
+            EXPECT_LE(stats.primitiveEvaluationCount, (uint64_t)reference.size() * primitives.size());
+            if (values.size() != reference.size()) return;
+
+            const float narrowBand = options.narrowBandWidth / (float)gridWidth;
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                const float expected = narrowBand > 0.f ? glm::clamp(reference[i], -narrowBand, narrowBand) : reference[i];
+                EXPECT_LE(std::abs(values[i] - expected), 1e-5f) << "i = " << i << ", gridWidth = " << gridWidth << ", chunkWidth = " << options.chunkWidth;
+            }
+        }
+    }
+
+    CPU_TEST(SDF3DPrimitiveEvaluator_Grid)
+    {
+        for (uint32_t seed = 0; seed < 4; seed++)
+        {
+            const std::vector<SDF3DPrimitive> primitives = createPrimitives(24, seed);
+
+            SDF3DPrimitiveEvaluator::Options options;
+            options.chunkWidth = 4;
+            testGrid(ctx, primitives, 32, options);
+
+            // The chunk width is clamped to the grid width.
+            options.chunkWidth = 64;
+            testGrid(ctx, primitives, 16, options);
+        }
+    }
+
+    CPU_TEST(SDF3DPrimitiveEvaluator_NarrowBand)
+    {
+        for (uint32_t seed = 0; seed < 4; seed++)
+        {
+            const std::vector<SDF3DPrimitive> primitives = createPrimitives(24, seed);
+
+            SDF3DPrimitiveEvaluator::Options options;
+            options.narrowBandWidth = 2.f;
+            options.chunkWidth = 4;
+            testGrid(ctx, primitives, 64, options);
+        }
+
+        // Most of the grid is far from a single small sphere, so most values should be clamped without evaluation.
+        Transform transform;
+        std::vector<SDF3DPrimitive> primitives = { SDF3DPrimitiveFactory::initCommon(SDF3DShapeType::Sphere, float3(0.1f), 0.f, 0.f, SDFOperationType::Union, transform) };
+
+        SDF3DPrimitiveEvaluator::Options options;
+        options.narrowBandWidth = 2.f;
+        SDF3DPrimitiveEvaluator::Stats stats;
+        SDF3DPrimitiveEvaluator::evalGrid(primitives, 64, options, &stats);
+        EXPECT_GT(stats.clampedValueCount, stats.evaluatedValueCount);
+    }
+
+    CPU_TEST(SDF3DPrimitiveEvaluator_Empty)
+    {
+        // Without primitives, the values are the same as on the GPU.
+        SDF3DPrimitiveEvaluator::Options options;
+        std::vector<float> values = SDF3DPrimitiveEvaluator::evalGrid({}, 4, options);
+        EXPECT_EQ(values.size(), (size_t)125);
+        for (float value : values) EXPECT_EQ(value, FLT_MAX);
+    }
+
+    CPU_TEST(SDF3DPrimitiveEvaluator_Benchmark, "Disabled for performance reasons")
+    {
+        const std::vector<SDF3DPrimitive> primitives = createPrimitives(256, 0);
+
+        for (uint32_t gridWidth = 32; gridWidth <= 512; gridWidth *= 2)
+        {
+            for (float narrowBandWidth : { 0.f, 2.f })
+            {
+                SDF3DPrimitiveEvaluator::Options options;
+                options.narrowBandWidth = narrowBandWidth;
+                SDF3DPrimitiveEvaluator::Stats stats;
+
+                auto startTime = CpuTimer::getCurrentTimePoint();
+                SDF3DPrimitiveEvaluator::evalGrid(primitives, gridWidth, options, &stats);
+                double time = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+                const double averagePrimitiveCount = stats.evaluatedValueCount > 0 ? (double)stats.primitiveEvaluationCount / stats.evaluatedValueCount : 0.0;
+                logInfo("gridWidth {}, narrowBandWidth {}: {:.1f} ms, {} values evaluated, {} values clamped, {:.1f} primitives per value",
+                    gridWidth, narrowBandWidth, time, stats.evaluatedValueCount, stats.clampedValueCount, averagePrimitiveCount);
+            }
+        }
+    }
+}
@@ -0,0 +1,315 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SparseBrickSet/SDFSBSBrickBuilder.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kShaderFile[] = "Tests/Scene/SDFs/SDFSBSBrickBuilderTests.cs.slang";
+
+        /** Reference BC4 snorm decoder, using the same integer interpolation as the encoder.
+        */
+        void decodeBC4Block(uint64_t compressedBlock, int values[16])
+        {
+            const int alpha0 = int8_t(compressedBlock & 0xff);
+            const int alpha1 = int8_t((compressedBlock >> 8) & 0xff);
+
+            int codes[8] = { alpha0, alpha1 };
+            if (alpha0 > alpha1)
+            {
+                for (int i = 1; i < 7; ++i) codes[1 + i] = ((7 - i) * alpha0 + i * alpha1) / 7;
+            }
+            else
+            {
+                for (int i = 1; i < 5; ++i) codes[1 + i] = ((5 - i) * alpha0 + i * alpha1) / 5;
+                codes[6] = -128;
+                codes[7] = 127;
+            }
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                values[i] = codes[(compressedBlock >> (16 + 3 * i)) & 0x7];
+            }
+        }
+
+        /** Creates normalized corner values of a sphere the same way SDFSBS::setValuesInternal() does.
+        */
+        std::vector<int8_t> createSphereValues(uint32_t gridWidth, float radius)
+        {
+            const uint32_t gridWidthInValues = gridWidth + 1;
+            const float normalizationMultiplier = 2.0f * gridWidth / glm::root_three<float>();
+
+            std::vector<int8_t> values(gridWidthInValues * gridWidthInValues * gridWidthInValues);
+            for (uint32_t z = 0; z < gridWidthInValues; z++)
+            {
+                for (uint32_t y = 0; y < gridWidthInValues; y++)
+                {
+                    for (uint32_t x = 0; x < gridWidthInValues; x++)
+                    {
+                        float3 p = float3(x, y, z) / float(gridWidth) - 0.5f;
+                        float normalizedValue = glm::clamp((glm::length(p) - radius) * normalizationMultiplier, -1.0f, 1.0f);
+                        float integerScale = normalizedValue * float(INT8_MAX);
+                        values[x + gridWidthInValues * (y + gridWidthInValues * z)] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+                    }
+                }
+            }
+            return values;
+        }
+
+        /** Reference brick validity, testing every voxel like SDFSBSAssignBrickValidityFromValuesPass.cs.slang.
+        */
+        std::vector<bool> computeReferenceValidity(const std::vector<int8_t>& values, uint32_t gridWidth, uint32_t brickWidth, uint32_t virtualBricksPerAxis)
+        {
+            const uint32_t gridWidthInValues = gridWidth + 1;
+            std::vector<bool> validity(virtualBricksPerAxis * virtualBricksPerAxis * virtualBricksPerAxis, false);
+
+            for (uint32_t z = 0; z < gridWidth; z++)
+            {
+                for (uint32_t y = 0; y < gridWidth; y++)
+                {
+                    for (uint32_t x = 0; x < gridWidth; x++)
+                    {
+                        bool hasInside = false;
+                        bool hasOutside = false;
+                        for (uint32_t c = 0; c < 8; c++)
+                        {
+                            int8_t value = values[(x + (c & 1)) + gridWidthInValues * ((y + ((c >> 1) & 1)) + gridWidthInValues * (z + (c >> 2)))];
+                            hasInside |= value <= 0;
+                            hasOutside |= value >= 0;
+                        }
+
+                        if (hasInside && hasOutside)
+                        {
+                            uint3 brickCoords = uint3(x, y, z) / brickWidth;
+                            validity[brickCoords.x + virtualBricksPerAxis * (brickCoords.y + virtualBricksPerAxis * brickCoords.z)] = true;
+                        }
+                    }
+                }
+            }
+            return validity;
+        }
+
+        /** Returns the value of a brick texel, decoding the containing BC4 block if the brick texture is compressed.
+        */
+        int loadBrickTexel(const SDFSBSBrickBuilder::BrickData& data, uint32_t x, uint32_t y)
+        {
+            const SDFSBSBrickBuilder::Layout& layout = data.layout;
+            if (!layout.compressed) return int8_t(data.brickTexture[y * layout.getBrickTextureRowPitch() + x]);
+
+            uint64_t compressedBlock;
+            std::memcpy(&compressedBlock, data.brickTexture.data() + (y / 4) * layout.getBrickTextureRowPitch() + (x / 4) * sizeof(uint64_t), sizeof(uint64_t));
+
+            int values[16];
+            decodeBC4Block(compressedBlock, values);
+            return values[(y % 4) * 4 + x % 4];
+        }
+
+        void testBuild(CPUUnitTestContext& ctx, uint32_t gridWidth, uint32_t brickWidth, bool compressed)
+        {
+            const std::vector<int8_t> values = createSphereValues(gridWidth, 0.3f);
+            const SDFSBSBrickBuilder::BrickData data = SDFSBSBrickBuilder::build(values, gridWidth, brickWidth, compressed);
+            const SDFSBSBrickBuilder::Layout& layout = data.layout;
+
+            const uint32_t virtualBricksPerAxis = div_round_up(gridWidth, brickWidth);
+            EXPECT_EQ(layout.virtualBricksPerAxis, virtualBricksPerAxis);
+            EXPECT_EQ(data.indirection.size(), (size_t)layout.getVirtualBrickCount());
+            EXPECT_EQ(data.brickAABBs.size(), (size_t)layout.brickCount);
+            EXPECT_EQ(data.brickTexture.size(), layout.getBrickTextureSize());
+            EXPECT_GE(layout.bricksPerAxis.x * layout.bricksPerAxis.y, layout.brickCount);
+
+            // Valid bricks must be numbered consecutively in virtual brick order.
+            const std::vector<bool> validity = computeReferenceValidity(values, gridWidth, brickWidth, virtualBricksPerAxis);
+            uint32_t expectedBrickID = 0;
+            for (uint32_t i = 0; i < (uint32_t)validity.size(); i++)
+            {
+                EXPECT_EQ(data.indirection[i], validity[i] ? expectedBrickID : SDFSBSBrickBuilder::kInvalidBrickID) << "i = " << i;
+                if (validity[i]) expectedBrickID++;
+            }
+            EXPECT_EQ(layout.brickCount, expectedBrickID);
+            EXPECT_GT(layout.brickCount, 0u);
+            EXPECT_LT(layout.brickCount, layout.getVirtualBrickCount());
+
+            // Check brick AABBs and values against the grid.
+            const uint32_t gridWidthInValues = gridWidth + 1;
+            const uint32_t brickWidthInValues = brickWidth + 1;
+            // BC4 quantizes the values of a block to at most eight codes spanning the block's range.
+            const int maxError = compressed ? 32 : 0;
+            for (uint32_t i = 0; i < layout.getVirtualBrickCount(); i++)
+            {
+                const uint32_t brickID = data.indirection[i];
+                if (brickID == SDFSBSBrickBuilder::kInvalidBrickID) continue;
+
+                const uint3 virtualBrickCoords = uint3(i % virtualBricksPerAxis, (i / virtualBricksPerAxis) % virtualBricksPerAxis, i / (virtualBricksPerAxis * virtualBricksPerAxis));
+                const float3 expectedMin = float3(virtualBrickCoords * brickWidth) / float(gridWidth) - 0.5f;
+                EXPECT(glm::all(glm::lessThanEqual(glm::abs(data.brickAABBs[brickID].minPoint - expectedMin), float3(1e-6f)))) << "brickID = " << brickID;
+                EXPECT(glm::all(glm::lessThanEqual(data.brickAABBs[brickID].maxPoint, float3(0.5f)))) << "brickID = " << brickID;
+
+                const uint2 brickTextureCoords = uint2(brickID % layout.bricksPerAxis.x, brickID / layout.bricksPerAxis.x) * uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues);
+                for (uint32_t z = 0; z < brickWidthInValues; z++)
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y++)
+                    {
+                        for (uint32_t x = 0; x < brickWidthInValues; x++)
+                        {
+                            const uint3 gridCoords = virtualBrickCoords * brickWidth + uint3(x, y, z);
+                            const bool inside = glm::all(glm::lessThan(gridCoords, uint3(gridWidth)));
+                            const int expected = inside ? std::max((int)values[gridCoords.x + gridWidthInValues * (gridCoords.y + gridWidthInValues * gridCoords.z)], -127) : 127;
+                            const int value = loadBrickTexel(data, brickTextureCoords.x + x + z * brickWidthInValues, brickTextureCoords.y + y);
+                            EXPECT_LE(std::abs(value - expected), maxError) << "brickID = " << brickID << ", x = " << x << ", y = " << y << ", z = " << z;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    CPU_TEST(SDFSBSBrickBuilder_BC4)
+    {
+        std::mt19937 rng;
+
+        // Blocks with at most two distinct values are encoded exactly.
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            int8_t block[16];
+            const int8_t a = int8_t(rng());
+            const int8_t b = i % 2 == 0 ? a : int8_t(rng());
+            for (uint32_t j = 0; j < 16; j++) block[j] = (rng() & 1) ? a : b;
+
+            int decoded[16];
+            decodeBC4Block(SDFSBSBrickBuilder::compressBC4Block(block), decoded);
+            for (uint32_t j = 0; j < 16; j++) EXPECT_EQ(decoded[j], (int)block[j]) << "i = " << i << ", j = " << j;
+        }
+
+        // Blocks with arbitrary values are encoded with an error no larger than that of evenly spaced codes.
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            int8_t block[16];
+            const int center = int(rng() % 256) - 128;
+            const int range = int(rng() % 256);
+            for (uint32_t j = 0; j < 16; j++) block[j] = (int8_t)glm::clamp(center + int(rng() % (range + 1)) - range / 2, -128, 127);
+
+            int decoded[16];
+            decodeBC4Block(SDFSBSBrickBuilder::compressBC4Block(block), decoded);
+
+            const int minValue = *std::min_element(block, block + 16);
+            const int maxValue = *std::max_element(block, block + 16);
+            const int maxError = (maxValue - minValue) / 14 + 1;
+
+            int error = 0;
+            for (uint32_t j = 0; j < 16; j++) error += (decoded[j] - block[j]) * (decoded[j] - block[j]);
+            EXPECT_LE(error, 16 * maxError * maxError) << "i = " << i;
+        }
+    }
+
+    GPU_TEST(SDFSBSBrickBuilder_BC4MatchesShader)
+    {
+        const uint32_t blockCount = 4096;
+
+        // Mix random blocks with blocks of narrow ranges and saturated values, which exercise the range fixup and the 5-alpha code book.
+        std::mt19937 rng;
+        std::vector<int32_t> values(blockCount * 16);
+        for (uint32_t i = 0; i < blockCount; i++)
+        {
+            const int center = int(rng() % 256) - 128;
+            const int range = i % 4 == 0 ? 255 : int(rng() % 16);
+            for (uint32_t j = 0; j < 16; j++)
+            {
+                int value = i % 8 == 1 && j % 3 == 0 ? (rng() & 1 ? 127 : -128) : center + int(rng() % (range + 1)) - range / 2;
+                values[i * 16 + j] = glm::clamp(value, -128, 127);
+            }
+        }
+
+        ctx.createProgram(kShaderFile, "testCompressBlock", Program::DefineList(), Shader::CompilerFlags::None, "6_5");
+        ctx.allocateStructuredBuffer("values", blockCount * 16, values.data(), values.size() * sizeof(int32_t));
+        ctx.allocateStructuredBuffer("result", blockCount);
+        ctx["CB"]["blockCount"] = blockCount;
+        ctx.runProgram(blockCount);
+
+        const uint2* result = ctx.mapBuffer<const uint2>("result");
+        for (uint32_t i = 0; i < blockCount; i++)
+        {
+            int8_t block[16];
+            for (uint32_t j = 0; j < 16; j++) block[j] = (int8_t)values[i * 16 + j];
+
+            const uint64_t compressedBlock = SDFSBSBrickBuilder::compressBC4Block(block);
+            EXPECT_EQ(result[i].x, uint32_t(compressedBlock & 0xffffffff)) << "i = " << i;
+            EXPECT_EQ(result[i].y, uint32_t(compressedBlock >> 32)) << "i = " << i;
+        }
+        ctx.unmapBuffer("result");
+    }
+
+    CPU_TEST(SDFSBSBrickBuilder_Build)
+    {
+        testBuild(ctx, 32, 7, false);
+        testBuild(ctx, 32, 7, true);
+        testBuild(ctx, 64, 5, false);
+        testBuild(ctx, 64, 15, true);
+    }
+
+    CPU_TEST(SDFSBSBrickBuilder_File)
+    {
+        const uint32_t gridWidth = 128;
+        const std::vector<int8_t> values = createSphereValues(gridWidth, 0.3f);
+        const SDFSBSBrickBuilder::BrickData data = SDFSBSBrickBuilder::build(values, gridWidth, 7, true);
+
+        const std::filesystem::path path = getTempFilePath();
+        EXPECT(SDFSBSBrickBuilder::writeToFile(path, data));
+
+        {
+            MemoryMappedFile file;
+            EXPECT(file.open(path));
+
+            // The file must be much smaller than a dense grid of float corner values.
+            const size_t denseSize = sizeof(uint32_t) + values.size() * sizeof(float);
+            EXPECT_LT(file.getSize() * 10, denseSize);
+
+            SDFSBSBrickBuilder::BrickDataView view;
+            EXPECT(SDFSBSBrickBuilder::parseFile(file.getData(), file.getSize(), view));
+            EXPECT_EQ(view.layout.gridWidth, data.layout.gridWidth);
+            EXPECT_EQ(view.layout.brickWidth, data.layout.brickWidth);
+            EXPECT_EQ(view.layout.virtualBricksPerAxis, data.layout.virtualBricksPerAxis);
+            EXPECT_EQ(view.layout.brickCount, data.layout.brickCount);
+            EXPECT(view.layout.bricksPerAxis == data.layout.bricksPerAxis);
+            EXPECT(view.layout.brickTextureDimensions == data.layout.brickTextureDimensions);
+            EXPECT_EQ(view.layout.compressed, data.layout.compressed);
+            EXPECT_EQ(std::memcmp(view.pIndirection, data.indirection.data(), data.indirection.size() * sizeof(uint32_t)), 0);
+            EXPECT_EQ(std::memcmp(view.pBrickAABBs, data.brickAABBs.data(), data.brickAABBs.size() * sizeof(AABB)), 0);
+            EXPECT_EQ(std::memcmp(view.pBrickTexture, data.brickTexture.data(), data.brickTexture.size()), 0);
+
+            // Truncated files must be rejected.
+            EXPECT(!SDFSBSBrickBuilder::parseFile(file.getData(), file.getSize() - 1, view));
+            EXPECT(!SDFSBSBrickBuilder::parseFile(file.getData(), 16, view));
+        }
+
+        std::filesystem::remove(path);
+    }
+}
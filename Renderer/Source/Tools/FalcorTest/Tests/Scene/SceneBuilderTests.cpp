@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Geometry/MeshOptimizer.h"
+#include <array>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kGridSize = 24;
+
+        /** Triangulated grid with shuffled triangle order.
+            Positions are shared between the triangles through the indices. Texture coordinates are face-varying with a seam
+            in the left half of the grid, so vertex merging keeps some duplicated positions.
+        */
+        struct GridMesh
+        {
+            std::vector<uint32_t> indices;
+            std::vector<float3> positions;
+            std::vector<float3> normals;
+            std::vector<float2> texCrds;
+
+            GridMesh()
+            {
+                std::vector<std::array<uint32_t, 3>> triangles;
+                for (uint32_t y = 0; y < kGridSize; y++)
+                {
+                    for (uint32_t x = 0; x < kGridSize; x++)
+                    {
+                        uint32_t v = y * (kGridSize + 1) + x;
+                        triangles.push_back({ v, v + 1, v + kGridSize + 2 });
+                        triangles.push_back({ v, v + kGridSize + 2, v + kGridSize + 1 });
+                    }
+                }
+                std::mt19937 rng(1);
+                std::shuffle(triangles.begin(), triangles.end(), rng);
+
+                for (uint32_t v = 0; v < (kGridSize + 1) * (kGridSize + 1); v++)
+                {
+                    positions.push_back(float3(v % (kGridSize + 1), v / (kGridSize + 1), 0.f));
+                    normals.push_back(float3(0.f, 0.f, 1.f));
+                }
+
+                for (size_t t = 0; t < triangles.size(); t++)
+                {
+                    bool offset = (t % 2 == 1) && positions[triangles[t][0]].x < kGridSize / 2;
+                    for (uint32_t v : triangles[t])
+                    {
+                        indices.push_back(v);
+                        texCrds.push_back(float2(positions[v]) / float(kGridSize) + (offset ? float2(0.5f, 0.f) : float2(0.f)));
+                    }
+                }
+            }
+
+            SceneBuilder::Mesh getMesh(const Material::SharedPtr& pMaterial, bool mergeDuplicateVertices) const
+            {
+                SceneBuilder::Mesh mesh;
+                mesh.name = "Grid";
+                mesh.faceCount = (uint32_t)indices.size() / 3;
+                mesh.vertexCount = (uint32_t)positions.size();
+                mesh.indexCount = (uint32_t)indices.size();
+                mesh.pIndices = indices.data();
+                mesh.topology = Vao::Topology::TriangleList;
+                mesh.pMaterial = pMaterial;
+                mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                mesh.texCrds = { texCrds.data(), SceneBuilder::Mesh::AttributeFrequency::FaceVarying };
+                mesh.mergeDuplicateVertices = mergeDuplicateVertices;
+                return mesh;
+            }
+        };
+
+        /** Vertex and index data of a mesh in the finalized scene data.
+        */
+        struct SceneMesh
+        {
+            std::vector<float3> positions;
+            std::vector<float2> texCrds;
+            std::vector<uint32_t> indices;  ///< Empty if non-indexed.
+
+            /** Get the position and texture coordinates of the three vertices of every triangle.
+                The result is independent of the triangle and vertex order, but keeps the winding of each triangle.
+            */
+            std::vector<std::array<float, 15>> getTriangles() const
+            {
+                std::vector<std::array<float, 15>> triangles;
+                const size_t vertexCount = indices.empty() ? positions.size() : indices.size();
+                for (size_t i = 0; i < vertexCount; i += 3)
+                {
+                    std::array<float, 15> best;
+                    for (uint32_t rotation = 0; rotation < 3; rotation++)
+                    {
+                        std::array<float, 15> triangle;
+                        for (uint32_t j = 0; j < 3; j++)
+                        {
+                            size_t k = i + (j + rotation) % 3;
+                            uint32_t v = indices.empty() ? (uint32_t)k : indices[k];
+                            const float values[5] = { positions[v].x, positions[v].y, positions[v].z, texCrds[v].x, texCrds[v].y };
+                            std::copy(values, values + 5, triangle.begin() + 5 * j);
+                        }
+                        if (rotation == 0 || triangle < best) best = triangle;
+                    }
+                    triangles.push_back(best);
+                }
+                std::sort(triangles.begin(), triangles.end());
+                return triangles;
+            }
+        };
+
+        SceneMesh buildMesh(const GridMesh& grid, SceneBuilder::Flags flags, bool mergeDuplicateVertices)
+        {
+            auto pBuilder = SceneBuilder::create(flags);
+            uint32_t meshID = pBuilder->addMesh(grid.getMesh(StandardMaterial::create("Grid"), mergeDuplicateVertices));
+            uint32_t nodeID = pBuilder->addNode(SceneBuilder::Node{ "Grid", glm::identity<glm::mat4>(), glm::identity<glm::mat4>() });
+            pBuilder->addMeshInstance(nodeID, meshID);
+
+            const auto& sceneData = pBuilder->getSceneData();
+            FALCOR_ASSERT(sceneData.meshDesc.size() == 1);
+            const MeshDesc& meshDesc = sceneData.meshDesc[0];
+
+            SceneMesh mesh;
+            for (uint32_t i = 0; i < meshDesc.vertexCount; i++)
+            {
+                StaticVertexData vertex = sceneData.meshStaticData[meshDesc.vbOffset + i].unpack();
+                mesh.positions.push_back(vertex.position);
+                mesh.texCrds.push_back(vertex.texCrd);
+            }
+            for (uint32_t i = 0; i < meshDesc.indexCount; i++)
+            {
+                const uint32_t* pIndexData = sceneData.meshIndexData.data() + meshDesc.ibOffset;
+                mesh.indices.push_back(meshDesc.use16BitIndices() ? reinterpret_cast<const uint16_t*>(pIndexData)[i] : pIndexData[i]);
+            }
+            return mesh;
+        }
+    }
+
+    GPU_TEST(SceneBuilder_OptimizeVertexOrder)
+    {
+        GridMesh grid;
+        const auto kOptimize = SceneBuilder::Flags::OptimizeVertexOrder;
+
+        // Merged vertices are reordered, but every triangle references the same vertex attributes.
+        SceneMesh original = buildMesh(grid, SceneBuilder::Flags::None, true);
+        SceneMesh optimized = buildMesh(grid, kOptimize, true);
+        EXPECT_GT(original.positions.size(), grid.positions.size());
+        EXPECT_LT(original.positions.size(), grid.indices.size());
+        EXPECT_EQ(optimized.positions.size(), original.positions.size());
+        EXPECT_EQ(optimized.indices.size(), grid.indices.size());
+        EXPECT(optimized.indices != original.indices);
+        EXPECT(optimized.getTriangles() == original.getTriangles());
+
+        const uint32_t vertexCount = (uint32_t)original.positions.size();
+        const uint32_t vertexStride = (uint32_t)sizeof(PackedStaticVertexData);
+        auto originalStats = MeshOptimizer::analyze(original.indices.data(), original.indices.size(), vertexCount, vertexStride);
+        auto optimizedStats = MeshOptimizer::analyze(optimized.indices.data(), optimized.indices.size(), vertexCount, vertexStride);
+        EXPECT_LT(optimizedStats.acmr, originalStats.acmr);
+        EXPECT_LT(optimizedStats.fetchRatio, originalStats.fetchRatio);
+
+        // Meshes with unmerged vertices and non-indexed meshes are not reordered.
+        auto expectUnchanged = [&](SceneBuilder::Flags flags, bool mergeDuplicateVertices)
+        {
+            SceneMesh expected = buildMesh(grid, flags, mergeDuplicateVertices);
+            SceneMesh result = buildMesh(grid, flags | kOptimize, mergeDuplicateVertices);
+            EXPECT(result.indices == expected.indices);
+            EXPECT(result.positions == expected.positions);
+            EXPECT(result.texCrds == expected.texCrds);
+        };
+        expectUnchanged(SceneBuilder::Flags::None, false);
+        expectUnchanged(SceneBuilder::Flags::NonIndexedVertices, true);
+        EXPECT(buildMesh(grid, SceneBuilder::Flags::NonIndexedVertices | kOptimize, true).indices.empty());
+    }
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/USDImporter/PrototypeCache.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const SceneBuilder::Flags kBuildFlags = SceneBuilder::Flags::DontOptimizeMaterials;
+
+        /** Get a mesh prim with a grid of the given resolution and a display color, so that every mesh has unique geometry and material.
+        */
+        std::string getGridPrim(const std::string& name, uint32_t resolution, float3 color, const std::string& indent)
+        {
+            std::string counts, indices, points;
+            for (uint32_t y = 0; y <= resolution; y++)
+            {
+                for (uint32_t x = 0; x <= resolution; x++)
+                {
+                    points += fmt::format("{}({}, {}, 0)", points.empty() ? "" : ", ", float(x) / resolution, float(y) / resolution);
+                }
+            }
+            for (uint32_t y = 0; y < resolution; y++)
+            {
+                for (uint32_t x = 0; x < resolution; x++)
+                {
+                    uint32_t i = y * (resolution + 1) + x;
+                    counts += fmt::format("{}4", counts.empty() ? "" : ", ");
+                    indices += fmt::format("{}{}, {}, {}, {}", indices.empty() ? "" : ", ", i, i + 1, i + resolution + 2, i + resolution + 1);
+                }
+            }
+            return fmt::format(R"(
+{0}def Mesh "{1}"
+{0}{{
+{0}    int[] faceVertexCounts = [{2}]
+{0}    int[] faceVertexIndices = [{3}]
+{0}    point3f[] points = [{4}]
+{0}    color3f[] primvars:displayColor = [({5}, {6}, {7})]
+{0}}}
+)", indent, name, counts, indices, points, color.x, color.y, color.z);
+        }
+
+        /** Get an Xform prim with a translation, containing a mesh and, down to the given depth, two child Xforms.
+            The hierarchy is deeper than the depth at which the parallel traversal splits the stage into subtrees.
+        */
+        std::string getXformPrim(const std::string& name, uint32_t depth, uint32_t& meshCount, const std::string& indent)
+        {
+            const uint32_t meshID = meshCount++;
+            std::string children = getGridPrim("Mesh", 1 + meshID % 7, float3((meshID % 5) / 4.f, (meshID % 3) / 2.f, (meshID % 2)), indent + "    ");
+            if (depth > 0)
+            {
+                children += getXformPrim("L", depth - 1, meshCount, indent + "    ");
+                children += getXformPrim("R", depth - 1, meshCount, indent + "    ");
+            }
+            return fmt::format(R"(
+{0}def Xform "{1}"
+{0}{{
+{0}    double3 xformOp:translate = ({2}, {3}, 0)
+{0}    uniform token[] xformOpOrder = ["xformOp:translate"]
+{4}{0}}}
+)", indent, name, meshID * 1.5f, (float)depth, children);
+        }
+
+        void writeStage(const std::filesystem::path& path)
+        {
+            uint32_t meshCount = 0;
+            std::ofstream file(path);
+            file << fmt::format(R"(#usda 1.0
+(
+    defaultPrim = "World"
+    upAxis = "Y"
+)
+
+def Xform "World"
+{{
+    def SphereLight "Light"
+    {{
+        float intensity = 10
+        float radius = 0.5
+    }}
+
+    def Camera "Camera"
+    {{
+        double3 xformOp:translate = (0, 0, 10)
+        uniform token[] xformOpOrder = ["xformOp:translate"]
+    }}
+{}}}
+)", getXformPrim("Root", 5, meshCount, "    "));
+        }
+    }
+
+    GPU_TEST(USDImporter_ParallelTraversalMatchesSerial)
+    {
+        std::filesystem::path path = getTempFilePath();
+        path.replace_extension(".usda");
+        writeStage(path);
+
+        // Disable the prototype cache so that both imports process all geometry.
+        const bool prevEnabled = PrototypeCache::isEnabled();
+        PrototypeCache::setEnabled(false);
+
+        auto importStage = [&](bool parallelTraversal)
+        {
+            Dictionary dict;
+            dict["parallelTraversal"] = parallelTraversal;
+            auto pBuilder = SceneBuilder::create(kBuildFlags);
+            pBuilder->import(path, {}, dict);
+            return pBuilder;
+        };
+
+        auto pSerialBuilder = importStage(false);
+        auto pParallelBuilder = importStage(true);
+
+        PrototypeCache::setEnabled(prevEnabled);
+        std::filesystem::remove(path);
+
+        // Lights, cameras and materials are created in the same order.
+        EXPECT_EQ(pParallelBuilder->getLights().size(), pSerialBuilder->getLights().size());
+        EXPECT_EQ(pParallelBuilder->getCameras().size(), pSerialBuilder->getCameras().size());
+        EXPECT_EQ(pParallelBuilder->getMaterials().size(), pSerialBuilder->getMaterials().size());
+        for (size_t i = 0; i < std::min(pParallelBuilder->getMaterials().size(), pSerialBuilder->getMaterials().size()); i++)
+        {
+            EXPECT_EQ(pParallelBuilder->getMaterials()[i]->getName(), pSerialBuilder->getMaterials()[i]->getName()) << "material = " << i;
+        }
+
+        const auto& expected = pSerialBuilder->getSceneData();
+        const auto& result = pParallelBuilder->getSceneData();
+
+        // Nodes have the same IDs, names, parents and transforms.
+        EXPECT_GE(expected.sceneGraph.size(), 63ull);
+        EXPECT_EQ(result.sceneGraph.size(), expected.sceneGraph.size());
+        for (size_t i = 0; i < std::min(result.sceneGraph.size(), expected.sceneGraph.size()); i++)
+        {
+            EXPECT_EQ(result.sceneGraph[i].name, expected.sceneGraph[i].name) << "node = " << i;
+            EXPECT_EQ(result.sceneGraph[i].parent, expected.sceneGraph[i].parent) << "node = " << i;
+            EXPECT(result.sceneGraph[i].transform == expected.sceneGraph[i].transform) << "node = " << i;
+        }
+
+        // Meshes have the same IDs, names and data.
+        EXPECT_GT(expected.meshDesc.size(), 0ull);
+        EXPECT_EQ(result.meshDesc.size(), expected.meshDesc.size());
+        EXPECT(result.meshNames == expected.meshNames);
+        for (size_t i = 0; i < std::min(result.meshDesc.size(), expected.meshDesc.size()); i++)
+        {
+            EXPECT(std::memcmp(&result.meshDesc[i], &expected.meshDesc[i], sizeof(MeshDesc)) == 0) << "mesh = " << i;
+        }
+        EXPECT(result.meshIndexData == expected.meshIndexData);
+        EXPECT_EQ(result.meshStaticData.size(), expected.meshStaticData.size());
+        if (result.meshStaticData.size() == expected.meshStaticData.size())
+        {
+            EXPECT(std::memcmp(result.meshStaticData.data(), expected.meshStaticData.data(), expected.meshStaticData.size() * sizeof(PackedStaticVertexData)) == 0);
+        }
+
+        // Instances reference the same nodes, meshes and materials.
+        EXPECT_EQ(result.meshInstanceData.size(), expected.meshInstanceData.size());
+        for (size_t i = 0; i < std::min(result.meshInstanceData.size(), expected.meshInstanceData.size()); i++)
+        {
+            EXPECT_EQ(result.meshInstanceData[i].geometryID, expected.meshInstanceData[i].geometryID) << "instance = " << i;
+            EXPECT_EQ(result.meshInstanceData[i].globalMatrixID, expected.meshInstanceData[i].globalMatrixID) << "instance = " << i;
+            EXPECT_EQ(result.meshInstanceData[i].materialID, expected.meshInstanceData[i].materialID) << "instance = " << i;
+        }
+    }
+}
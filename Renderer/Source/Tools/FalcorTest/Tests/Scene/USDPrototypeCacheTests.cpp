@@ -0,0 +1,184 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/USDImporter/PrototypeCache.h"
+#include "Scene/Material/BasicMaterial.h"
+#include "Utils/Image/Bitmap.h"
+#include <fstream>
+#include <set>
+
+namespace Falcor
+{
+    namespace
+    {
+        const SceneBuilder::Flags kBuildFlags = SceneBuilder::Flags::DontOptimizeMaterials;
+
+        std::string getMeshPrim(const std::string& name, float offset, float size)
+        {
+            return fmt::format(R"(
+    def Mesh "{0}" (prepend apiSchemas = ["MaterialBindingAPI"])
+    {{
+        rel material:binding = </World/Material>
+        int[] faceVertexCounts = [3, 3]
+        int[] faceVertexIndices = [0, 1, 2, 0, 2, 3]
+        point3f[] points = [(0, 0, 0), ({2}, 0, 0), ({2}, {2}, 0), (0, {2}, 0)]
+        texCoord2f[] primvars:st = [(0, 0), (1, 0), (1, 1), (0, 1)] (interpolation = "vertex")
+        double3 xformOp:translate = ({1}, 0, 0)
+        uniform token[] xformOpOrder = ["xformOp:translate"]
+    }}
+)", name, offset, size);
+        }
+
+        /** Write a stage with three mesh prims bound to the same textured material.
+            Prims A and B have identical geometry at different positions, prim C has different geometry.
+        */
+        void writeStage(const std::filesystem::path& path, const std::filesystem::path& texturePath)
+        {
+            std::ofstream file(path);
+            file << fmt::format(R"(#usda 1.0
+(
+    defaultPrim = "World"
+    upAxis = "Y"
+)
+
+def Xform "World"
+{{
+    def Material "Material"
+    {{
+        token outputs:surface.connect = </World/Material/Surface.outputs:surface>
+
+        def Shader "Surface"
+        {{
+            uniform token info:id = "UsdPreviewSurface"
+            color3f inputs:diffuseColor.connect = </World/Material/Texture.outputs:rgb>
+            token outputs:surface
+        }}
+
+        def Shader "Texture"
+        {{
+            uniform token info:id = "UsdUVTexture"
+            asset inputs:file = @{}@
+            token inputs:sourceColorSpace = "sRGB"
+            float2 inputs:st.connect = </World/Material/Reader.outputs:result>
+            float3 outputs:rgb
+        }}
+
+        def Shader "Reader"
+        {{
+            uniform token info:id = "UsdPrimvarReader_float2"
+            token inputs:varname = "st"
+            float2 outputs:result
+        }}
+    }}
+{}{}{}}}
+)", texturePath.generic_string(), getMeshPrim("A", 0.f, 1.f), getMeshPrim("B", 2.f, 1.f), getMeshPrim("C", 4.f, 2.f));
+        }
+
+        void writeTexture(const std::filesystem::path& path)
+        {
+            const uint32_t kSize = 4;
+            std::vector<uint8_t> pixels(kSize * kSize * 4);
+            for (uint32_t i = 0; i < kSize * kSize; i++)
+            {
+                pixels[4 * i + 0] = (uint8_t)(i * 16);
+                pixels[4 * i + 1] = (uint8_t)(255 - i * 16);
+                pixels[4 * i + 2] = (uint8_t)(i % kSize * 64);
+                pixels[4 * i + 3] = 255;
+            }
+            Bitmap::saveImage(path, kSize, kSize, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, pixels.data());
+        }
+
+        Texture::SharedPtr getBaseColorTexture(const SceneBuilder& builder)
+        {
+            for (const auto& pMaterial : builder.getMaterials())
+            {
+                auto pBasicMaterial = std::dynamic_pointer_cast<BasicMaterial>(pMaterial);
+                if (pBasicMaterial && pBasicMaterial->getBaseColorTexture()) return pBasicMaterial->getBaseColorTexture();
+            }
+            return nullptr;
+        }
+    }
+
+    GPU_TEST(USDPrototypeCache_ImportSharing)
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorUSDPrototypeCacheTest";
+        std::filesystem::create_directories(directory);
+        const std::filesystem::path stagePath = directory / "stage.usda";
+        const std::filesystem::path texturePath = directory / "texture.png";
+        writeTexture(texturePath);
+        writeStage(stagePath, texturePath);
+
+        const bool prevEnabled = PrototypeCache::isEnabled();
+        PrototypeCache::setEnabled(true);
+        PrototypeCache::clear();
+
+        auto importStage = [&](SceneBuilder::Flags flags)
+        {
+            auto pBuilder = SceneBuilder::create(flags);
+            pBuilder->import(stagePath);
+            return pBuilder;
+        };
+
+        // Prims A and B have the same geometry and material, so they become instances of the same mesh.
+        auto pBuilder0 = importStage(kBuildFlags);
+        const auto& sceneData0 = pBuilder0->getSceneData();
+        EXPECT_EQ(sceneData0.meshDesc.size(), 2ull);
+        EXPECT_EQ(sceneData0.meshInstanceData.size(), 3ull);
+        std::set<uint32_t> geometryIDs;
+        for (const auto& instance : sceneData0.meshInstanceData) geometryIDs.insert(instance.geometryID);
+        EXPECT_EQ(geometryIDs.size(), 2ull);
+        Texture::SharedPtr pTexture0 = getBaseColorTexture(*pBuilder0);
+        EXPECT(pTexture0 != nullptr);
+
+        // Importing the stage again reuses the processed geometry of all prims and the texture of the first scene.
+        const auto stats = PrototypeCache::getStats();
+        auto pBuilder1 = importStage(kBuildFlags);
+        const auto& sceneData1 = pBuilder1->getSceneData();
+        EXPECT_EQ(sceneData1.meshDesc.size(), 2ull);
+        EXPECT_EQ(sceneData1.meshInstanceData.size(), 3ull);
+        const auto newStats = PrototypeCache::getStats();
+        EXPECT_EQ(newStats.meshHitCount - stats.meshHitCount, 3ull);
+        EXPECT_EQ(newStats.meshEntryCount, 2ull);
+        EXPECT_GE(newStats.textureHitCount - stats.textureHitCount, 1ull);
+        EXPECT(getBaseColorTexture(*pBuilder1) == pTexture0);
+
+        // With DontMergeMeshes, every prim keeps its own mesh. The geometry is still reused.
+        auto pBuilder2 = importStage(kBuildFlags | SceneBuilder::Flags::DontMergeMeshes);
+        EXPECT_EQ(pBuilder2->getSceneData().meshDesc.size(), 3ull);
+
+        // Without the cache, nothing is shared.
+        PrototypeCache::setEnabled(false);
+        auto pBuilder3 = importStage(kBuildFlags);
+        EXPECT_EQ(pBuilder3->getSceneData().meshDesc.size(), 3ull);
+        EXPECT(getBaseColorTexture(*pBuilder3) != pTexture0);
+
+        PrototypeCache::clear();
+        PrototypeCache::setEnabled(prevEnabled);
+        std::filesystem::remove_all(directory);
+    }
+}
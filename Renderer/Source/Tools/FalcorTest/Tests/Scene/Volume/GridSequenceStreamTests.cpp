@@ -0,0 +1,131 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridSequenceStream.h"
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996)
+#include <nanovdb/util/IO.h>
+#include <nanovdb/util/GridBuilder.h>
+#pragma warning(pop)
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kFrameCount = 8;
+        const std::string kGridname = "density";
+
+        std::vector<std::filesystem::path> writeSequence(const std::filesystem::path& directory)
+        {
+            std::filesystem::create_directories(directory);
+            std::vector<std::filesystem::path> paths;
+            for (uint32_t i = 0; i < kFrameCount; ++i)
+            {
+                // Grow the sphere so each frame has a different voxel count.
+                auto handle = nanovdb::createFogVolumeSphere(10.f + i, nanovdb::Vec3R(0.0), 1.0, 2.0, nanovdb::Vec3R(0.0), kGridname);
+                paths.push_back(directory / fmt::format("frame{}.nvdb", i));
+                nanovdb::io::writeGrid(paths.back().string(), handle);
+            }
+            return paths;
+        }
+    }
+
+    GPU_TEST(GridSequenceStream)
+    {
+        std::filesystem::path directory = getTempFilePath();
+        auto paths = writeSequence(directory);
+
+        // Budget for about two and a half frames of the largest size.
+        auto pLastGrid = Grid::createFromFile(paths.back(), kGridname);
+        EXPECT(pLastGrid != nullptr);
+        if (!pLastGrid) return;
+        const uint64_t frameSize = pLastGrid->getGridHandle().size() + pLastGrid->getGridSizeInBytes();
+
+        GridSequenceStream::Options options;
+        options.memoryBudget = frameSize * 5 / 2;
+        options.prefetchCount = 2;
+        options.threadCount = 1;
+        auto pStream = GridSequenceStream::create(paths, kGridname, options);
+        EXPECT_EQ(pStream->getFrameCount(), kFrameCount);
+
+        // Play the sequence forward twice.
+        uint64_t prevVoxelCount = 0;
+        for (uint32_t i = 0; i < 2 * kFrameCount; ++i)
+        {
+            uint32_t frame = i % kFrameCount;
+            auto pGrid = pStream->getGrid(frame, 1);
+            EXPECT(pGrid != nullptr);
+            EXPECT(pStream->isResident(frame));
+            if (pGrid && frame > 0) EXPECT_GT(pGrid->getVoxelCount(), prevVoxelCount);
+            prevVoxelCount = pGrid ? pGrid->getVoxelCount() : 0;
+
+            const auto& stats = pStream->getStats();
+            EXPECT_LE(stats.memoryUsage, options.memoryBudget);
+            EXPECT_EQ(stats.hitCount + stats.missCount, (uint64_t)i + 1);
+        }
+
+        // The sequence doesn't fit in the budget, so frames must have been evicted and reloaded.
+        auto stats = pStream->getStats();
+        EXPECT_GT(stats.evictionCount, 0ull);
+        EXPECT_LT(stats.residentFrameCount, kFrameCount);
+        EXPECT_GE(stats.missCount + stats.prefetchCount, (uint64_t)kFrameCount + 1);
+
+        // Requesting the current frame again is a hit.
+        uint32_t lastFrame = kFrameCount - 1;
+        pStream->getGrid(lastFrame, 0);
+        EXPECT_EQ(pStream->getStats().hitCount, stats.hitCount + 1);
+
+        // Shrinking the budget evicts everything except the current frame.
+        pStream->setMemoryBudget(0);
+        EXPECT_EQ(pStream->getStats().residentFrameCount, 1u);
+        EXPECT(pStream->isResident(lastFrame));
+
+        pStream = nullptr;
+
+        // A missing frame is loaded on the calling thread without prefetching. It fails without throwing.
+        auto brokenPaths = paths;
+        brokenPaths[1] = directory / "missing.nvdb";
+        options.prefetchCount = 0;
+        auto pBrokenStream = GridSequenceStream::create(brokenPaths, kGridname, options);
+        EXPECT(pBrokenStream->getGrid(0, 0) != nullptr);
+        bool threw = false;
+        try
+        {
+            EXPECT(pBrokenStream->getGrid(1, 0) == nullptr);
+        }
+        catch (const std::exception&)
+        {
+            threw = true;
+        }
+        EXPECT(!threw);
+        EXPECT(!pBrokenStream->isResident(1));
+
+        pBrokenStream = nullptr;
+        std::filesystem::remove_all(directory);
+    }
+}
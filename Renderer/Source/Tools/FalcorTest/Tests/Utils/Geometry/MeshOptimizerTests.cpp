@@ -0,0 +1,186 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/MeshOptimizer.h"
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kVertexStride = 32;
+
+        /** Create a regular grid of gridSize x gridSize quads with shuffled triangles and vertices.
+            The vertices of each triangle are rotated randomly, which keeps the winding.
+        */
+        std::vector<uint32_t> createShuffledGrid(uint32_t gridSize, uint32_t seed, uint32_t& vertexCount)
+        {
+            std::mt19937 rng(seed);
+            vertexCount = (gridSize + 1) * (gridSize + 1);
+
+            std::vector<uint32_t> vertexRemap(vertexCount);
+            std::iota(vertexRemap.begin(), vertexRemap.end(), 0);
+            std::shuffle(vertexRemap.begin(), vertexRemap.end(), rng);
+
+            std::vector<std::array<uint32_t, 3>> triangles;
+            for (uint32_t y = 0; y < gridSize; y++)
+            {
+                for (uint32_t x = 0; x < gridSize; x++)
+                {
+                    uint32_t i0 = vertexRemap[y * (gridSize + 1) + x];
+                    uint32_t i1 = vertexRemap[y * (gridSize + 1) + x + 1];
+                    uint32_t i2 = vertexRemap[(y + 1) * (gridSize + 1) + x];
+                    uint32_t i3 = vertexRemap[(y + 1) * (gridSize + 1) + x + 1];
+                    triangles.push_back({ i0, i1, i2 });
+                    triangles.push_back({ i2, i1, i3 });
+                }
+            }
+            std::shuffle(triangles.begin(), triangles.end(), rng);
+
+            std::vector<uint32_t> indices;
+            for (const auto& t : triangles)
+            {
+                uint32_t r = rng() % 3;
+                for (uint32_t k = 0; k < 3; k++) indices.push_back(t[(k + r) % 3]);
+            }
+            return indices;
+        }
+
+        /** Get the triangles with their vertices rotated so that the smallest index comes first, sorted.
+        */
+        std::vector<std::array<uint32_t, 3>> getCanonicalTriangles(const std::vector<uint32_t>& indices)
+        {
+            std::vector<std::array<uint32_t, 3>> triangles;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                std::array<uint32_t, 3> t = { indices[i], indices[i + 1], indices[i + 2] };
+                std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+                triangles.push_back(t);
+            }
+            std::sort(triangles.begin(), triangles.end());
+            return triangles;
+        }
+    }
+
+    CPU_TEST(MeshOptimizer_VertexCache)
+    {
+        for (uint32_t gridSize : { 1u, 8u, 64u })
+        {
+            uint32_t vertexCount;
+            std::vector<uint32_t> indices = createShuffledGrid(gridSize, gridSize, vertexCount);
+            std::vector<uint32_t> optimized = indices;
+            MeshOptimizer::optimizeVertexCache(optimized.data(), optimized.size(), vertexCount);
+
+            // The same triangles with the same winding must come out.
+            EXPECT(getCanonicalTriangles(indices) == getCanonicalTriangles(optimized)) << "gridSize=" << gridSize;
+
+            auto before = MeshOptimizer::analyze(indices.data(), indices.size(), vertexCount, kVertexStride);
+            auto after = MeshOptimizer::analyze(optimized.data(), optimized.size(), vertexCount, kVertexStride);
+            EXPECT_LE(after.acmr, before.acmr) << "gridSize=" << gridSize;
+            if (gridSize == 64)
+            {
+                // A shuffled grid transforms close to 3 vertices per triangle. Tipsify gets below 0.8 on grids.
+                EXPECT_GT(before.acmr, 2.5f);
+                EXPECT_LT(after.acmr, 0.8f);
+            }
+        }
+
+        // Degenerate triangles and unreferenced vertices.
+        std::vector<uint32_t> indices = { 0, 0, 1, 2, 3, 4, 4, 3, 2, 1, 1, 1 };
+        std::vector<uint32_t> optimized = indices;
+        MeshOptimizer::optimizeVertexCache(optimized.data(), optimized.size(), 8);
+        EXPECT(getCanonicalTriangles(indices) == getCanonicalTriangles(optimized));
+    }
+
+    CPU_TEST(MeshOptimizer_VertexFetch)
+    {
+        uint32_t vertexCount;
+        std::vector<uint32_t> indices = createShuffledGrid(64, 1, vertexCount);
+        MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+
+        // Add unreferenced vertices at the front, which must be moved to the end.
+        const uint32_t unreferencedCount = 5;
+        for (auto& i : indices) i += unreferencedCount;
+        vertexCount += unreferencedCount;
+
+        std::vector<uint32_t> optimized = indices;
+        std::vector<uint32_t> order = MeshOptimizer::optimizeVertexFetch(optimized.data(), optimized.size(), vertexCount);
+
+        EXPECT_EQ(order.size(), vertexCount);
+        std::vector<uint32_t> sortedOrder = order;
+        std::sort(sortedOrder.begin(), sortedOrder.end());
+        for (uint32_t v = 0; v < vertexCount; v++) EXPECT_EQ(sortedOrder[v], v);
+        for (uint32_t v = 0; v < unreferencedCount; v++) EXPECT_EQ(order[vertexCount - unreferencedCount + v], v);
+
+        bool remapped = true;
+        for (size_t i = 0; i < indices.size(); i++) remapped &= order[optimized[i]] == indices[i];
+        EXPECT(remapped);
+
+        // Vertex fetch optimization does not change the vertex cache behavior.
+        auto before = MeshOptimizer::analyze(indices.data(), indices.size(), vertexCount, kVertexStride);
+        auto after = MeshOptimizer::analyze(optimized.data(), optimized.size(), vertexCount, kVertexStride);
+        EXPECT_EQ(after.acmr, before.acmr);
+        EXPECT_GT(before.fetchRatio, 2.f);
+        EXPECT_LT(after.fetchRatio, 1.5f);
+    }
+
+    CPU_TEST(MeshOptimizer_Analyze)
+    {
+        // No triangles.
+        auto stats = MeshOptimizer::analyze(nullptr, 0, 0, kVertexStride);
+        EXPECT_EQ(stats.acmr, 0.f);
+        EXPECT_EQ(stats.fetchRatio, 0.f);
+
+        // Two triangles sharing an edge transform four vertices, which fit in two cache lines.
+        std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3 };
+        stats = MeshOptimizer::analyze(indices.data(), indices.size(), 4, kVertexStride);
+        EXPECT_EQ(stats.acmr, 2.f);
+        EXPECT_EQ(stats.fetchRatio, 1.f);
+
+        // With a cache of three vertices, vertex 0 is evicted before the last triangle.
+        indices = { 0, 1, 2, 1, 2, 3, 3, 2, 0 };
+        stats = MeshOptimizer::analyze(indices.data(), indices.size(), 4, kVertexStride, 3);
+        EXPECT_EQ(stats.acmr, 5.f / 3.f);
+
+        // Out of range indices are rejected.
+        bool caught = false;
+        try
+        {
+            indices = { 0, 1, 4 };
+            MeshOptimizer::analyze(indices.data(), indices.size(), 4, kVertexStride);
+        }
+        catch (const ArgumentError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+    }
+}
@@ -0,0 +1,155 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/QuantizedBVH.h"
+#include "Utils/Geometry/TriangleBVH.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::vector<float3> createRandomTriangles(uint32_t count, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> posDist(0.f, 10.f);
+            std::uniform_real_distribution<float> offsetDist(-0.5f, 0.5f);
+
+            std::vector<float3> positions(3 * count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                float3 center = float3(posDist(rng), posDist(rng), posDist(rng));
+                for (uint32_t j = 0; j < 3; j++) positions[3 * i + j] = center + float3(offsetDist(rng), offsetDist(rng), offsetDist(rng));
+            }
+            return positions;
+        }
+
+        std::vector<AABB> computeTriangleBounds(const std::vector<float3>& positions)
+        {
+            std::vector<AABB> bounds(positions.size() / 3);
+            for (size_t i = 0; i < bounds.size(); i++)
+            {
+                for (uint32_t j = 0; j < 3; j++) bounds[i].include(positions[3 * i + j]);
+            }
+            return bounds;
+        }
+
+        const uint32_t kInvalid = 0xffffffff;
+
+        /** Find the closest or any hit through the BVH. Returns the primitive index, or kInvalid if nothing was hit.
+        */
+        uint32_t intersect(const QuantizedBVH& bvh, const std::vector<float3>& positions, const BVHRay& ray, float& t, bool anyHit = false)
+        {
+            uint32_t hitIndex = kInvalid;
+            auto intersectTriangle = [&](uint32_t primIndex, float& tMax)
+            {
+                const float3 v0 = positions[3 * primIndex];
+                float tHit;
+                float2 barycentrics;
+                if (!TriangleBVH::intersectTriangle(ray, v0, positions[3 * primIndex + 1] - v0, positions[3 * primIndex + 2] - v0, tMax, tHit, barycentrics)) return false;
+                tMax = t = tHit;
+                hitIndex = primIndex;
+                return true;
+            };
+            bool found = anyHit ? bvh.traverse<true>(ray, intersectTriangle) : bvh.traverse<false>(ray, intersectTriangle);
+            FALCOR_ASSERT(found == (hitIndex != kInvalid));
+            return hitIndex;
+        }
+
+        uint32_t intersectBruteForce(const std::vector<float3>& positions, const BVHRay& ray, float& t)
+        {
+            uint32_t hitIndex = kInvalid;
+            float tMax = ray.tMax;
+            for (uint32_t i = 0; i < (uint32_t)positions.size() / 3; i++)
+            {
+                const float3 v0 = positions[3 * i];
+                float tHit;
+                float2 barycentrics;
+                if (!TriangleBVH::intersectTriangle(ray, v0, positions[3 * i + 1] - v0, positions[3 * i + 2] - v0, tMax, tHit, barycentrics)) continue;
+                tMax = t = tHit;
+                hitIndex = i;
+            }
+            return hitIndex;
+        }
+
+        void testAgainstBruteForce(CPUUnitTestContext& ctx, const QuantizedBVH& bvh, const std::vector<float3>& positions, std::mt19937& rng)
+        {
+            std::uniform_real_distribution<float> dist(0.f, 1.f);
+            for (uint32_t i = 0; i < 1000; i++)
+            {
+                BVHRay ray(float3(dist(rng) * 20.f - 1.f, dist(rng) * 12.f - 1.f, -2.f), float3(dist(rng) - 0.5f, dist(rng) - 0.5f, 1.f));
+                float t = 0.f, expectedT = 0.f, anyT = 0.f;
+                uint32_t expected = intersectBruteForce(positions, ray, expectedT);
+                uint32_t hitIndex = intersect(bvh, positions, ray, t);
+                EXPECT_EQ(hitIndex, expected) << "width = " << bvh.getWidth() << ", i = " << i;
+                EXPECT_EQ(intersect(bvh, positions, ray, anyT, true) != kInvalid, expected != kInvalid) << "width = " << bvh.getWidth() << ", i = " << i;
+                if (hitIndex != kInvalid && expected != kInvalid) EXPECT_EQ(t, expectedT);
+            }
+        }
+    }
+
+    CPU_TEST(QuantizedBVH_BruteForce)
+    {
+        std::mt19937 rng(5);
+
+        for (uint32_t width : { 4u, 8u })
+        {
+            for (uint32_t maxLeafSize : { 1u, 4u, 16u })
+            {
+                for (uint32_t triangleCount : { 0u, 1u, 17u, 5000u })
+                {
+                    const std::vector<float3> positions = createRandomTriangles(triangleCount, triangleCount + width);
+                    const std::vector<AABB> bounds = computeTriangleBounds(positions);
+                    QuantizedBVH bvh;
+                    bvh.build(bounds.data(), triangleCount, width, maxLeafSize);
+                    EXPECT_EQ(bvh.getWidth(), width);
+                    EXPECT_EQ(bvh.getPrimitiveCount(), triangleCount);
+                    testAgainstBruteForce(ctx, bvh, positions, rng);
+                }
+            }
+        }
+    }
+
+    CPU_TEST(QuantizedBVH_Refit)
+    {
+        std::mt19937 rng(13);
+
+        for (uint32_t width : { 4u, 8u })
+        {
+            std::vector<float3> positions = createRandomTriangles(2000, width);
+            QuantizedBVH bvh;
+            bvh.build(computeTriangleBounds(positions).data(), 2000, width);
+
+            // Move and deform the triangles, then refit. The quantization grids are recomputed.
+            for (auto& p : positions) p = float3(p.x * 1.5f + 3.f, p.y + std::sin(p.x), p.z);
+            bvh.refit(computeTriangleBounds(positions).data());
+            EXPECT_GE(bvh.getBounds().maxPoint.x, 15.f);
+            testAgainstBruteForce(ctx, bvh, positions, rng);
+        }
+    }
+}
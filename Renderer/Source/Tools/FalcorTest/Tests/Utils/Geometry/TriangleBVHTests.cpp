@@ -0,0 +1,189 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/TriangleBVH.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::vector<float3> createRandomTriangles(uint32_t count, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> posDist(0.f, 10.f);
+            std::uniform_real_distribution<float> offsetDist(-0.5f, 0.5f);
+
+            std::vector<float3> positions(3 * count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                float3 center = float3(posDist(rng), posDist(rng), posDist(rng));
+                for (uint32_t j = 0; j < 3; j++) positions[3 * i + j] = center + float3(offsetDist(rng), offsetDist(rng), offsetDist(rng));
+            }
+            return positions;
+        }
+
+        /** Brute-force closest hit using the same intersection test as the BVH.
+        */
+        TriangleBVH::Hit intersectBruteForce(const std::vector<float3>& positions, const TriangleBVH::Ray& ray)
+        {
+            TriangleBVH::Hit hit;
+            float tMax = ray.tMax;
+            for (uint32_t i = 0; i < (uint32_t)positions.size() / 3; i++)
+            {
+                const float3 v0 = positions[3 * i];
+                const float3 e1 = positions[3 * i + 1] - v0;
+                const float3 e2 = positions[3 * i + 2] - v0;
+                float3 p = cross(ray.dir, e2);
+                float det = dot(e1, p);
+                if (det == 0.f) continue;
+                float invDet = 1.f / det;
+                float3 s = ray.origin - v0;
+                float u = dot(s, p) * invDet;
+                if (u < 0.f || u > 1.f) continue;
+                float3 q = cross(s, e1);
+                float v = dot(ray.dir, q) * invDet;
+                if (v < 0.f || u + v > 1.f) continue;
+                float t = dot(e2, q) * invDet;
+                if (t < ray.tMin || t > tMax) continue;
+                tMax = t;
+                hit.primitiveIndex = i;
+                hit.t = t;
+                hit.barycentrics = float2(u, v);
+            }
+            return hit;
+        }
+    }
+
+    CPU_TEST(TriangleBVH_BruteForce)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+        for (uint32_t width : { 4u, 8u })
+        {
+            for (uint32_t triangleCount : { 0u, 1u, 3u, 17u, 1000u, 5000u })
+            {
+                const std::vector<float3> positions = createRandomTriangles(triangleCount, triangleCount);
+                TriangleBVH bvh;
+                bvh.build(positions.data(), triangleCount, width);
+                EXPECT_EQ(bvh.getWidth(), width);
+                EXPECT_EQ(bvh.getTriangleCount(), triangleCount);
+
+                uint32_t hitCount = 0;
+                for (uint32_t i = 0; i < 1000; i++)
+                {
+                    float3 origin = float3(dist(rng) * 12.f - 1.f, dist(rng) * 12.f - 1.f, -2.f);
+                    float3 dir = float3(dist(rng) - 0.5f, dist(rng) - 0.5f, 1.f);
+                    TriangleBVH::Ray ray(origin, dir);
+
+                    TriangleBVH::Hit expected = intersectBruteForce(positions, ray);
+                    TriangleBVH::Hit hit;
+                    bool found = bvh.intersect(ray, hit);
+                    EXPECT_EQ(found, expected.isValid()) << "width = " << width << ", triangleCount = " << triangleCount << ", i = " << i;
+                    EXPECT_EQ(bvh.occluded(ray), expected.isValid()) << "width = " << width << ", triangleCount = " << triangleCount << ", i = " << i;
+                    if (found && expected.isValid())
+                    {
+                        EXPECT_EQ(hit.primitiveIndex, expected.primitiveIndex);
+                        EXPECT_EQ(hit.t, expected.t);
+                    }
+
+                    // Limiting the ray extent must exclude the closest hit.
+                    if (found)
+                    {
+                        TriangleBVH::Ray shortRay(origin, dir, 0.f, hit.t * 0.5f);
+                        TriangleBVH::Hit shortHit;
+                        EXPECT_EQ(bvh.intersect(shortRay, shortHit), intersectBruteForce(positions, shortRay).isValid());
+                    }
+                    hitCount += found ? 1 : 0;
+                }
+                if (triangleCount >= 1000) EXPECT_GT(hitCount, 0u);
+            }
+        }
+    }
+
+    CPU_TEST(TriangleBVH_Refit)
+    {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+        for (uint32_t width : { 4u, 8u })
+        {
+            std::vector<float3> positions = createRandomTriangles(2000, width);
+            TriangleBVH bvh;
+            bvh.build(positions.data(), 2000, width);
+
+            // Move and deform the triangles, then refit. The hits must match a brute-force search on the new positions.
+            for (auto& p : positions) p = float3(p.x * 1.5f + 3.f, p.y + std::sin(p.x), p.z);
+            bvh.refit(positions.data());
+            EXPECT_EQ(bvh.getTriangleCount(), 2000u);
+            EXPECT_GE(bvh.getBounds().maxPoint.x, 15.f);
+
+            for (uint32_t i = 0; i < 1000; i++)
+            {
+                float3 origin = float3(dist(rng) * 20.f, dist(rng) * 12.f - 1.f, -2.f);
+                float3 dir = float3(dist(rng) - 0.5f, dist(rng) - 0.5f, 1.f);
+                TriangleBVH::Ray ray(origin, dir);
+
+                TriangleBVH::Hit expected = intersectBruteForce(positions, ray);
+                TriangleBVH::Hit hit;
+                EXPECT_EQ(bvh.intersect(ray, hit), expected.isValid()) << "width = " << width << ", i = " << i;
+                EXPECT_EQ(hit.primitiveIndex, expected.primitiveIndex) << "width = " << width << ", i = " << i;
+            }
+        }
+    }
+
+    CPU_TEST(TriangleBVH_HitFilter)
+    {
+        // Two parallel quads facing the ray; the filter rejects the nearest one.
+        const std::vector<float3> positions =
+        {
+            float3(-1.f, -1.f, 1.f), float3(1.f, -1.f, 1.f), float3(1.f, 1.f, 1.f),
+            float3(-1.f, -1.f, 1.f), float3(1.f, 1.f, 1.f), float3(-1.f, 1.f, 1.f),
+            float3(-1.f, -1.f, 2.f), float3(1.f, -1.f, 2.f), float3(1.f, 1.f, 2.f),
+            float3(-1.f, -1.f, 2.f), float3(1.f, 1.f, 2.f), float3(-1.f, 1.f, 2.f),
+        };
+        TriangleBVH bvh;
+        bvh.build(positions.data(), 4);
+
+        TriangleBVH::Ray ray(float3(0.1f, 0.2f, 0.f), float3(0.f, 0.f, 1.f));
+        TriangleBVH::Hit hit;
+        EXPECT(bvh.intersect(ray, hit));
+        EXPECT_LT(hit.primitiveIndex, 2u);
+        EXPECT_EQ(hit.t, 1.f);
+
+        auto rejectFirstQuad = [](const void*, uint32_t primitiveIndex, float2) { return primitiveIndex >= 2; };
+        EXPECT(bvh.intersect(ray, hit, rejectFirstQuad));
+        EXPECT_GE(hit.primitiveIndex, 2u);
+        EXPECT_EQ(hit.t, 2.f);
+
+        auto rejectAll = [](const void*, uint32_t, float2) { return false; };
+        EXPECT(!bvh.intersect(ray, hit, rejectAll));
+        EXPECT(!bvh.occluded(ray, rejectAll));
+    }
+}
@@ -0,0 +1,174 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Routes log messages to the log file only and restores the logger settings on destruction.
+        */
+        class ScopedLoggerSettings
+        {
+        public:
+            ScopedLoggerSettings(uint32_t rateLimit)
+                : mOutputs(Logger::getOutputs())
+                , mVerbosity(Logger::getVerbosity())
+                , mRateLimit(Logger::getRateLimit())
+            {
+                if (!Logger::enabled()) throw SkippingTestException("Logger is disabled");
+                Logger::flush();
+                Logger::setOutputs(Logger::OutputFlags::File);
+                Logger::setVerbosity(Logger::Level::Info);
+                Logger::setRateLimit(rateLimit);
+            }
+
+            ~ScopedLoggerSettings()
+            {
+                Logger::flush();
+                Logger::setOutputs(mOutputs);
+                Logger::setVerbosity(mVerbosity);
+                Logger::setRateLimit(mRateLimit);
+            }
+
+        private:
+            Logger::OutputFlags mOutputs;
+            Logger::Level mVerbosity;
+            uint32_t mRateLimit;
+        };
+
+        /** Create a token that identifies the messages of a single test run in the log file.
+        */
+        std::string createToken(const std::string& name)
+        {
+            return fmt::format("{}-{}", name, std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+
+        /** Read all lines of the log file that contain a token.
+            The log file is only written asynchronously, so this must be called after Logger::flush().
+        */
+        std::vector<std::string> readLogLines(const std::string& token)
+        {
+            std::vector<std::string> lines;
+            std::ifstream file(Logger::getLogFilePath());
+            std::string line;
+            while (std::getline(file, line))
+            {
+                if (line.find(token) != std::string::npos) lines.push_back(line);
+            }
+            return lines;
+        }
+    }
+
+    CPU_TEST(Logger_Flush)
+    {
+        ScopedLoggerSettings settings(0);
+        const std::string token = createToken("Flush");
+
+        logInfo("{} message", token);
+        Logger::flush();
+        auto lines = readLogLines(token);
+        EXPECT_EQ(lines.size(), 1u);
+        if (lines.size() == 1) EXPECT_EQ(lines[0], "(Info) " + token + " message");
+
+        // Shutting down writes pending messages. Logging again restarts the writer.
+        logWarning("{} before shutdown", token);
+        Logger::shutdown();
+        logWarning("{} after shutdown", token);
+        Logger::flush();
+        lines = readLogLines(token);
+        EXPECT_EQ(lines.size(), 3u);
+    }
+
+    CPU_TEST(Logger_Ordering)
+    {
+        ScopedLoggerSettings settings(0);
+        const std::string token = createToken("Ordering");
+        const uint32_t kThreadCount = 8;
+        const uint32_t kMessageCount = 1000;
+
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < kThreadCount; t++)
+        {
+            threads.emplace_back([&token, t]()
+            {
+                for (uint32_t i = 0; i < kMessageCount; i++) logInfo("{} {} {}", token, t, i);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        Logger::flush();
+
+        // All messages must be written exactly once, in submission order for each thread.
+        std::vector<uint32_t> nextIndex(kThreadCount, 0);
+        auto lines = readLogLines(token);
+        EXPECT_EQ(lines.size(), kThreadCount * kMessageCount);
+        for (const auto& line : lines)
+        {
+            uint32_t t = 0, i = 0;
+            std::istringstream(line.substr(line.find(token) + token.size())) >> t >> i;
+            EXPECT_LT(t, kThreadCount) << line;
+            if (t >= kThreadCount) continue;
+            EXPECT_EQ(i, nextIndex[t]) << line;
+            nextIndex[t] = i + 1;
+        }
+    }
+
+    CPU_TEST(Logger_RateLimit)
+    {
+        const uint32_t kRateLimit = 5;
+        ScopedLoggerSettings settings(kRateLimit);
+        const std::string token = createToken("RateLimit");
+
+        // Identical messages are rate limited. Messages that only share the format string are not.
+        for (uint32_t i = 0; i < 20; i++) logWarning("{} repeated", token);
+        for (uint32_t i = 0; i < 20; i++) logWarning("{} distinct {}", token, i);
+        // Errors are never rate limited.
+        for (uint32_t i = 0; i < 20; i++) logError("{} error", token);
+        Logger::flush();
+
+        uint32_t repeatedCount = 0;
+        uint32_t distinctCount = 0;
+        uint32_t errorCount = 0;
+        std::vector<std::string> summaries;
+        for (const auto& line : readLogLines(token))
+        {
+            if (line.find("Suppressed") != std::string::npos) summaries.push_back(line);
+            else if (line == "(Warning) " + token + " repeated") repeatedCount++;
+            else if (line.find(token + " distinct") != std::string::npos) distinctCount++;
+            else if (line == "(Error) " + token + " error") errorCount++;
+        }
+        EXPECT_EQ(repeatedCount, kRateLimit);
+        EXPECT_EQ(distinctCount, 20u);
+        EXPECT_EQ(errorCount, 20u);
+        EXPECT_EQ(summaries.size(), 1u);
+        if (summaries.size() == 1) EXPECT_EQ(summaries[0], "(Warning) Suppressed 15 similar message(s), e.g.: " + token + " repeated");
+    }
+}
@@ -0,0 +1,224 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/ParallelAlgorithms.h"
+#include <random>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kTestSizes[] = { 0, 1, 1000, 16384, 100003, 1 << 20 };
+        const uint32_t kTestThreadCounts[] = { 0, 1, 3 };
+
+        template<typename T>
+        std::vector<T> createRandomData(size_t count, uint64_t maxValue, uint32_t seed)
+        {
+            std::mt19937_64 rng(seed);
+            std::uniform_int_distribution<uint64_t> dist(0, maxValue);
+            std::vector<T> data(count);
+            for (auto& v : data) v = (T)dist(rng);
+            return data;
+        }
+
+        template<typename Key>
+        void testRadixSort(CPUUnitTestContext& ctx, uint64_t maxKey)
+        {
+            for (size_t count : kTestSizes)
+            {
+                for (uint32_t threadCount : kTestThreadCounts)
+                {
+                    std::vector<Key> keys = createRandomData<Key>(count, maxKey, (uint32_t)count);
+                    std::vector<uint32_t> values(count);
+                    std::iota(values.begin(), values.end(), 0);
+
+                    // Reference: stable sort of (key, original index).
+                    std::vector<std::pair<Key, uint32_t>> ref(count);
+                    for (size_t i = 0; i < count; i++) ref[i] = { keys[i], (uint32_t)i };
+                    std::stable_sort(ref.begin(), ref.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+                    std::vector<Key> keysOnly = keys;
+                    parallelRadixSort(keys.data(), values.data(), count, threadCount);
+                    parallelRadixSort(keysOnly.data(), count, threadCount);
+
+                    bool match = true;
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        match = match && keys[i] == ref[i].first && values[i] == ref[i].second && keysOnly[i] == ref[i].first;
+                    }
+                    EXPECT(match) << "count = " << count << " threadCount = " << threadCount;
+                }
+            }
+        }
+
+        template<typename Func>
+        double measure(Func func, uint32_t iterations = 5)
+        {
+            double best = std::numeric_limits<double>::max();
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                auto startTime = CpuTimer::getCurrentTimePoint();
+                func();
+                best = std::min(best, CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()));
+            }
+            return best;
+        }
+    }
+
+    CPU_TEST(ParallelExclusiveScan)
+    {
+        for (size_t count : kTestSizes)
+        {
+            for (uint32_t threadCount : kTestThreadCounts)
+            {
+                std::vector<uint32_t> data = createRandomData<uint32_t>(count, 100, (uint32_t)count);
+                std::vector<uint32_t> ref(count);
+                std::exclusive_scan(data.begin(), data.end(), ref.begin(), 7u);
+                uint32_t refTotal = std::accumulate(data.begin(), data.end(), 7u);
+
+                // Out of place.
+                std::vector<uint32_t> result(count);
+                uint32_t total = parallelExclusiveScan(data.data(), result.data(), count, 7u, threadCount);
+                EXPECT_EQ(total, refTotal) << "count = " << count;
+                EXPECT(result == ref) << "count = " << count << " threadCount = " << threadCount;
+
+                // In place.
+                total = parallelExclusiveScan(data.data(), data.data(), count, 7u, threadCount);
+                EXPECT_EQ(total, refTotal) << "count = " << count;
+                EXPECT(data == ref) << "count = " << count << " threadCount = " << threadCount;
+            }
+        }
+    }
+
+    CPU_TEST(ParallelRadixSort)
+    {
+        testRadixSort<uint32_t>(ctx, std::numeric_limits<uint32_t>::max());
+        testRadixSort<uint32_t>(ctx, 1000); // Exercises skipped passes.
+        testRadixSort<uint64_t>(ctx, std::numeric_limits<uint64_t>::max());
+    }
+
+    CPU_TEST(ParallelSegmentedReduce)
+    {
+        for (size_t count : kTestSizes)
+        {
+            // Random segment sizes, including empty segments and a large one.
+            std::vector<uint32_t> offsets = { 0 };
+            std::mt19937 rng((uint32_t)count);
+            while (offsets.back() < count)
+            {
+                uint32_t size = offsets.size() == 3 ? (uint32_t)count / 2 : rng() % 100;
+                offsets.push_back(std::min((uint32_t)count, offsets.back() + size));
+            }
+            offsets.push_back((uint32_t)count);
+            size_t segmentCount = offsets.size() - 1;
+
+            std::vector<uint64_t> values = createRandomData<uint64_t>(count, 1000, (uint32_t)count);
+            for (uint32_t threadCount : kTestThreadCounts)
+            {
+                std::vector<uint64_t> results(segmentCount, ~0ull);
+                parallelSegmentedReduce(values.data(), offsets.data(), segmentCount, results.data(), (uint64_t)0, std::plus<uint64_t>(), threadCount);
+
+                bool match = true;
+                for (size_t s = 0; s < segmentCount; s++)
+                {
+                    uint64_t ref = std::accumulate(values.begin() + offsets[s], values.begin() + offsets[s + 1], (uint64_t)0);
+                    match = match && results[s] == ref;
+                }
+                EXPECT(match) << "count = " << count << " threadCount = " << threadCount;
+            }
+        }
+    }
+
+    CPU_TEST(ParallelCompactAndPartition)
+    {
+        auto pred = [](uint32_t v) { return v % 3 == 0; };
+        for (size_t count : kTestSizes)
+        {
+            for (uint32_t threadCount : kTestThreadCounts)
+            {
+                std::vector<uint32_t> data = createRandomData<uint32_t>(count, 1 << 20, (uint32_t)count);
+
+                std::vector<uint32_t> ref;
+                std::copy_if(data.begin(), data.end(), std::back_inserter(ref), pred);
+                std::vector<uint32_t> refPartition = data;
+                std::stable_partition(refPartition.begin(), refPartition.end(), pred);
+
+                std::vector<uint32_t> result(count);
+                size_t resultCount = parallelCompact(data.data(), count, result.data(), pred, threadCount);
+                EXPECT_EQ(resultCount, ref.size());
+                result.resize(resultCount);
+                EXPECT(result == ref) << "count = " << count << " threadCount = " << threadCount;
+
+                size_t selectedCount = parallelPartition(data.data(), count, pred, threadCount);
+                EXPECT_EQ(selectedCount, ref.size());
+                EXPECT(data == refPartition) << "count = " << count << " threadCount = " << threadCount;
+            }
+        }
+    }
+
+    CPU_TEST(ParallelAlgorithms_Benchmark, "Disabled for performance reasons")
+    {
+        const size_t kCount = 1 << 24;
+        std::vector<uint32_t> keys32 = createRandomData<uint32_t>(kCount, std::numeric_limits<uint32_t>::max(), 1);
+        std::vector<uint64_t> keys64 = createRandomData<uint64_t>(kCount, std::numeric_limits<uint64_t>::max(), 2);
+        std::vector<uint32_t> values(kCount);
+        std::vector<uint32_t> output(kCount);
+        auto pred = [](uint32_t v) { return (v & 1) == 0; };
+
+        const uint32_t maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t threadCount = 1; ; threadCount = std::min(threadCount * 2, maxThreadCount))
+        {
+            double scanTime = measure([&] { parallelExclusiveScan(keys32.data(), output.data(), kCount, 0u, threadCount); });
+            double sort32Time = measure([&]
+            {
+                std::vector<uint32_t> k = keys32;
+                parallelRadixSort(k.data(), values.data(), kCount, threadCount);
+            });
+            double sort64Time = measure([&]
+            {
+                std::vector<uint64_t> k = keys64;
+                parallelRadixSort(k.data(), kCount, threadCount);
+            });
+            double compactTime = measure([&] { parallelCompact(keys32.data(), kCount, output.data(), pred, threadCount); });
+
+            logInfo("ParallelAlgorithms: {} thread(s), {} elements: scan {:.2f} ms, radix sort 32-bit pairs {:.2f} ms, radix sort 64-bit keys {:.2f} ms, compact {:.2f} ms",
+                threadCount, kCount, scanTime, sort32Time, sort64Time, compactTime);
+
+            if (threadCount == maxThreadCount) break;
+        }
+
+        // Serial references.
+        double stdSortTime = measure([&]
+        {
+            std::vector<uint32_t> k = keys32;
+            std::sort(k.begin(), k.end());
+        });
+        logInfo("ParallelAlgorithms: std::sort 32-bit keys {:.2f} ms", stdSortTime);
+    }
+}
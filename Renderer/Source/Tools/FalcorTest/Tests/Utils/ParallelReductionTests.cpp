@@ -247,6 +247,43 @@ namespace Falcor
                     }
                 }
             }
+
+            // Test asynchronous readback. Issue more operations than there are readback slots.
+            {
+                DataType syncSum, syncMinMax[2];
+                pReduction->execute(ctx.getRenderContext(), pTexture, ComputeParallelReduction::Type::Sum, &syncSum);
+                pReduction->execute(ctx.getRenderContext(), pTexture, ComputeParallelReduction::Type::MinMax, syncMinMax);
+
+                const uint32_t kCount = ComputeParallelReduction::kAsyncSlotCount + 2;
+                for (uint32_t i = 0; i < kCount; i++)
+                {
+                    auto type = (i % 2 == 0) ? ComputeParallelReduction::Type::Sum : ComputeParallelReduction::Type::MinMax;
+                    pReduction->executeAsync<DataType>(ctx.getRenderContext(), pTexture, type, i);
+                }
+                EXPECT_EQ(pReduction->getPendingAsyncResultCount(), kCount);
+
+                ctx.getRenderContext()->flush(true);
+                for (uint32_t i = 0; i < kCount; i++)
+                {
+                    DataType result[2];
+                    uint64_t tag = 0;
+                    EXPECT(pReduction->getAsyncResult(result, &tag));
+                    EXPECT_EQ(tag, (uint64_t)i);
+                    for (uint32_t j = 0; j < 4; j++)
+                    {
+                        if (i % 2 == 0)
+                        {
+                            EXPECT_EQ(result[0][j], syncSum[j]) << "i = " << i << " j = " << j;
+                        }
+                        else
+                        {
+                            EXPECT_EQ(result[0][j], syncMinMax[0][j]) << "i = " << i << " j = " << j;
+                            EXPECT_EQ(result[1][j], syncMinMax[1][j]) << "i = " << i << " j = " << j;
+                        }
+                    }
+                }
+                EXPECT_EQ(pReduction->getPendingAsyncResultCount(), 0u);
+            }
         }
 
         void testReduction(GPUUnitTestContext& ctx, const ComputeParallelReduction::SharedPtr& pReduction, ResourceFormat format, uint32_t width, uint32_t height)
@@ -0,0 +1,101 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/ReadbackRing.h"
+
+namespace Falcor
+{
+    CPU_TEST(ReadbackRing_Basic)
+    {
+        ReadbackRing ring(3);
+        EXPECT_EQ(ring.getSlotCount(), 3u);
+        EXPECT(ring.isEmpty());
+        EXPECT(!ring.pop(100).has_value());
+
+        EXPECT_EQ(ring.push(10, 1), 0u);
+        EXPECT_EQ(ring.push(11, 2), 1u);
+        EXPECT_EQ(ring.push(12, 3), 2u);
+        EXPECT(ring.isFull());
+        EXPECT_EQ(ring.front().tag, 10ull);
+        EXPECT_EQ(ring.back().tag, 12ull);
+
+        // Nothing is returned until the GPU has reached the fence value.
+        EXPECT(!ring.pop(0).has_value());
+
+        auto entry = ring.pop(1);
+        EXPECT(entry.has_value());
+        EXPECT_EQ(entry->tag, 10ull);
+        EXPECT_EQ(entry->slot, 0u);
+        EXPECT(!ring.pop(1).has_value());
+
+        // The freed slot is reused.
+        EXPECT_EQ(ring.getNextSlot(), 0u);
+        EXPECT_EQ(ring.push(13, 4), 0u);
+
+        // Entries are returned in order once complete.
+        uint64_t expectedTag = 11;
+        while (auto e = ring.pop(4))
+        {
+            EXPECT_EQ(e->tag, expectedTag);
+            expectedTag++;
+        }
+        EXPECT_EQ(expectedTag, 14ull);
+        EXPECT(ring.isEmpty());
+    }
+
+    CPU_TEST(ReadbackRing_FrameLatency)
+    {
+        // Simulate a GPU running a fixed number of frames behind the CPU.
+        // Results should arrive exactly that many frames after submission.
+        const uint32_t kLatency = 2;
+        const uint32_t kFrameCount = 20;
+        ReadbackRing ring(kLatency + 1);
+
+        uint64_t fenceValue = 0;
+        uint64_t nextExpectedFrame = 0;
+        for (uint32_t frame = 0; frame < kFrameCount; frame++)
+        {
+            uint64_t completedFenceValue = frame >= kLatency ? frame - kLatency + 1 : 0;
+            while (auto entry = ring.pop(completedFenceValue))
+            {
+                EXPECT_EQ(entry->tag, nextExpectedFrame);
+                EXPECT_EQ(frame - entry->tag, (uint64_t)kLatency);
+                nextExpectedFrame++;
+            }
+
+            EXPECT(!ring.isFull());
+            ring.push(frame, ++fenceValue);
+            EXPECT_LE(ring.getPendingCount(), kLatency + 1);
+        }
+        EXPECT_EQ(nextExpectedFrame, (uint64_t)(kFrameCount - kLatency));
+
+        ring.clear();
+        EXPECT(ring.isEmpty());
+        EXPECT_EQ(ring.getNextSlot(), 0u);
+    }
+}
@@ -0,0 +1,128 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Video/VideoEncoder.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Create a synthetic BGRA frame with a moving gradient.
+        */
+        std::vector<uint8_t> createFrame(uint32_t width, uint32_t height, uint32_t frameIndex)
+        {
+            std::vector<uint8_t> data((size_t)width * height * 4);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint8_t* p = &data[((size_t)y * width + x) * 4];
+                    p[0] = uint8_t(x + frameIndex);
+                    p[1] = uint8_t(y + 2 * frameIndex);
+                    p[2] = uint8_t(x ^ y);
+                    p[3] = 255;
+                }
+            }
+            return data;
+        }
+
+        /** Encode synthetic frames and return the time in ms.
+        */
+        double encodeFrames(const VideoEncoder::Desc& desc, uint32_t frameCount, const std::vector<std::vector<uint8_t>>& frames)
+        {
+            auto pEncoder = VideoEncoder::create(desc);
+            if (!pEncoder) return 0.0;
+
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            for (uint32_t i = 0; i < frameCount; i++) pEncoder->appendFrame(frames[i % frames.size()].data());
+            pEncoder->endCapture();
+            return CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        }
+    }
+
+    CPU_TEST(VideoEncoder_SyncAndAsync)
+    {
+        VideoEncoder::Desc desc;
+        desc.width = 128;
+        desc.height = 64;
+        desc.format = ResourceFormat::BGRA8Unorm;
+        desc.codec = VideoEncoder::Codec::MPEG4;
+
+        std::vector<std::vector<uint8_t>> frames;
+        for (uint32_t i = 0; i < 4; i++) frames.push_back(createFrame(desc.width, desc.height, i));
+
+        std::filesystem::path syncPath = getTempFilePath().replace_extension(".mp4");
+        desc.path = syncPath;
+        desc.maxQueuedFrames = 0;
+        encodeFrames(desc, 30, frames);
+
+        std::filesystem::path asyncPath = getTempFilePath().replace_extension(".mp4");
+        desc.path = asyncPath;
+        desc.maxQueuedFrames = 4;
+        desc.flipY = true;
+        encodeFrames(desc, 30, frames);
+
+        EXPECT(std::filesystem::exists(syncPath));
+        EXPECT(std::filesystem::exists(asyncPath));
+        if (std::filesystem::exists(syncPath)) EXPECT_GT(std::filesystem::file_size(syncPath), 0ull);
+        if (std::filesystem::exists(asyncPath)) EXPECT_GT(std::filesystem::file_size(asyncPath), 0ull);
+
+        std::filesystem::remove(syncPath);
+        std::filesystem::remove(asyncPath);
+    }
+
+    CPU_TEST(VideoEncoder_Benchmark, "Disabled for performance reasons")
+    {
+        VideoEncoder::Desc desc;
+        desc.width = 1920;
+        desc.height = 1080;
+        desc.format = ResourceFormat::BGRA8Unorm;
+        desc.codec = VideoEncoder::Codec::H264;
+        desc.flipY = true;
+
+        const uint32_t kFrameCount = 120;
+        std::vector<std::vector<uint8_t>> frames;
+        for (uint32_t i = 0; i < 8; i++) frames.push_back(createFrame(desc.width, desc.height, i));
+
+        auto measure = [&](VideoEncoder::Preset preset, uint32_t maxQueuedFrames)
+        {
+            desc.path = getTempFilePath().replace_extension(".mp4");
+            desc.preset = preset;
+            desc.maxQueuedFrames = maxQueuedFrames;
+            double time = encodeFrames(desc, kFrameCount, frames);
+            std::filesystem::remove(desc.path);
+            logInfo("VideoEncoder: preset {}, queue {}: {:.1f} ms, {:.1f} fps", (int)preset, maxQueuedFrames, time, kFrameCount * 1000.0 / time);
+            return time;
+        };
+
+        double syncTime = measure(VideoEncoder::Preset::VerySlow, 0);
+        measure(VideoEncoder::Preset::Medium, 0);
+        double asyncTime = measure(VideoEncoder::Preset::Medium, 4);
+        EXPECT_LT(asyncTime, syncTime);
+    }
+}